@@ -117,6 +117,9 @@ Rectangle {
         if (ChatNetworkClient) {
             ChatNetworkClient.getFriendList()
             ChatNetworkClient.getFriendGroups()
+            if (FriendGroupManager) {
+                FriendGroupManager.loadChatGroups()
+            }
         } else {
             console.error("ChatNetworkClient不可用，无法刷新好友数据")
         }
@@ -442,15 +442,13 @@ void AuthManager::onLoginResponse(const QString &requestId, const QJsonObject &r
             }
         });
 
-        // 登录成功后立即初始化ChatNetworkClient并发送好友列表请求
+        // 登录成功后立即初始化ChatNetworkClient并发送登录引导请求
         ChatNetworkClient* chatClient = ChatNetworkClient::instance();
         if (chatClient && chatClient->initialize()) {
             // 延迟一小段时间确保网络连接稳定
             QTimer::singleShot(100, [chatClient]() {
-                chatClient->getFriendList();
-                chatClient->getFriendGroups();
-                // 获取离线消息
-                chatClient->getOfflineMessages();
+                // 好友、分组、申请、会话、在线状态、群组和离线消息合并为一次请求
+                chatClient->bootstrap();
             });
         }
         
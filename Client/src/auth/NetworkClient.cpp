@@ -24,6 +24,7 @@ NetworkClient::NetworkClient(QObject *parent)
     , _useTLS(false)  // 暂时禁用SSL
     , _connectionTimeout(10000)  // 10秒
     , _heartbeatInterval(30000)  // 30秒
+    , _requestDeadline(15000)    // 15秒
     , _reconnectInterval(1000)   // 1秒
     , _maxReconnectAttempts(10)  // 最大重连10次
     , _currentReconnectAttempts(0)
@@ -300,6 +301,37 @@ void NetworkClient::setHeartbeatInterval(int interval)
     }
 }
 
+void NetworkClient::setRequestDeadline(int deadlineMs)
+{
+    _requestDeadline = deadlineMs;
+}
+
+bool NetworkClient::cancelRequest(const QString &requestId)
+{
+    if (requestId.isEmpty() || !isConnected()) {
+        return false;
+    }
+
+    {
+        QMutexLocker locker(&_dataMutex);
+        if (!_pendingRequests.contains(requestId)) {
+            return false;
+        }
+        _pendingRequests.remove(requestId);
+
+        // 服务器丢弃已取消的请求时不会回复，限制集合大小
+        if (_cancelledRequests.size() >= 1000) {
+            _cancelledRequests.clear();
+        }
+        _cancelledRequests.insert(requestId);
+    }
+
+    QJsonObject request;
+    request["action"] = "cancel";
+    request["target_request_id"] = requestId;
+    return !sendJsonRequest(request).isEmpty();
+}
+
 void NetworkClient::onConnected()
 {
 
@@ -371,6 +403,7 @@ void NetworkClient::onDisconnected()
     // 清空接收缓冲区和待处理请求
     _receiveBuffer.clear();
     _pendingRequests.clear();
+    _cancelledRequests.clear();
 }
 
 void NetworkClient::onReadyRead()
@@ -568,7 +601,7 @@ void NetworkClient::setConnectionState(ConnectionState state)
     }
 }
 
-QString NetworkClient::sendChatRequest(const QJsonObject &request)
+QString NetworkClient::sendChatRequest(const QJsonObject &request, bool expectReply)
 {
     if (!isConnected()) {
         LOG_ERROR("Cannot send chat request: not connected to server");
@@ -580,6 +613,9 @@ QString NetworkClient::sendChatRequest(const QJsonObject &request)
     QJsonObject requestWithId = request;
     requestWithId["request_id"] = requestId;
     requestWithId["timestamp"] = QDateTime::currentSecsSinceEpoch();
+    if (expectReply && _requestDeadline > 0 && !requestWithId.contains("deadline_ms")) {
+        requestWithId["deadline_ms"] = _requestDeadline;
+    }
 
     QJsonDocument doc(requestWithId);
     QByteArray data = doc.toJson(QJsonDocument::Compact);
@@ -601,7 +637,7 @@ QString NetworkClient::sendChatRequest(const QJsonObject &request)
     _socket->flush();
     
     // 将聊天请求添加到待处理列表
-    {
+    if (expectReply) {
         QMutexLocker locker(&_dataMutex);
         _pendingRequests[requestId] = "chat";
     }
@@ -620,6 +656,10 @@ QString NetworkClient::sendJsonRequest(const QJsonObject &request)
     QJsonObject requestWithId = request;
     requestWithId["request_id"] = requestId;
     requestWithId["timestamp"] = QDateTime::currentSecsSinceEpoch();
+    if (_requestDeadline > 0 && requestWithId["action"].toString() != "cancel"
+        && !requestWithId.contains("deadline_ms")) {
+        requestWithId["deadline_ms"] = _requestDeadline;
+    }
 
     QJsonDocument doc(requestWithId);
     QByteArray data = doc.toJson(QJsonDocument::Compact);
@@ -734,12 +774,21 @@ void NetworkClient::processJsonResponse(const QJsonObject &response)
     QString requestType;
     bool hasRequest = false;
 
+    if (action == "cancel_response") {
+        return;
+    }
+
     {
         QMutexLocker locker(&_dataMutex);
+        if (_cancelledRequests.remove(requestId)) {
+            // 已取消的请求，服务器仍返回了结果（如已执行的写操作），不再分发
+            return;
+        }
         if (_pendingRequests.contains(requestId)) {
             requestType = _pendingRequests.take(requestId);
             hasRequest = true;
-        } else {
+        } else if (!requestId.isEmpty()) {
+            // 服务器推送（如瞬时事件）不带请求ID，直接转发
             LOG_WARNING(QString("No matching request found for ID: %1").arg(requestId));
         }
     }
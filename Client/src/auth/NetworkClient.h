@@ -14,6 +14,7 @@
 // #include <QSslError>
 #include <QAbstractSocket>
 #include <QMap>
+#include <QSet>
 #include <QMutex>
 #include "../utils/NetworkQualityMonitor.h"
 #include "../utils/SmartErrorHandler.h"
@@ -128,6 +129,19 @@ public:
      */
     void setHeartbeatInterval(int interval);
     
+    /**
+     * @brief 设置请求时间预算，随请求以deadline_ms发送，服务器超过后不再执行
+     * @param deadlineMs 时间预算（毫秒），0表示不携带
+     */
+    void setRequestDeadline(int deadlineMs);
+    
+    /**
+     * @brief 取消尚未收到响应的请求，之后到达的响应被忽略
+     * @param requestId 请求ID
+     * @return 取消消息是否已发送
+     */
+    bool cancelRequest(const QString &requestId);
+    
     /**
      * @brief 获取单例实例
      */
@@ -174,9 +188,10 @@ public:
     /**
      * @brief 发送聊天请求
      * @param request 请求数据
+     * @param expectReply 是否等待响应；为false时不登记待处理请求、不附带截止时间（如瞬时事件）
      * @return 请求ID
      */
-    QString sendChatRequest(const QJsonObject &request);
+    QString sendChatRequest(const QJsonObject &request, bool expectReply = true);
 
     // 设置客户端ID
     void setClientId(const QString& clientId);
@@ -345,6 +360,7 @@ private:
     QTimer* _reconnectTimer;
     int _connectionTimeout;
     int _heartbeatInterval;
+    int _requestDeadline;
     int _reconnectInterval;
     int _maxReconnectAttempts;
     int _currentReconnectAttempts;
@@ -355,6 +371,7 @@ private:
     
     QByteArray _receiveBuffer;
     QMap<QString, QString> _pendingRequests; // requestId -> requestType
+    QSet<QString> _cancelledRequests;        // 已取消、响应需忽略的请求ID
     QMutex _dataMutex; // 添加互斥锁保护共享数据
     
     // 认证相关
@@ -2,6 +2,7 @@
 #include "../auth/NetworkClient.h"
 #include "../auth/AuthManager.h"
 #include "../utils/Logger.h"
+#include "ProtocolMessages.h"
 #include <QJsonDocument>
 #include <QUuid>
 #include <QDateTime>
@@ -16,10 +17,17 @@ ChatNetworkClient::ChatNetworkClient(QObject *parent)
     , _initialized(false)
     , _networkClient(nullptr)
     , _heartbeatTimer(new QTimer(this))
+    , _bootstrapTimer(new QTimer(this))
+    , _bootstrapUserId(0)
 {
     // 设置心跳定时器
     _heartbeatTimer->setInterval(HEARTBEAT_INTERVAL);
     connect(_heartbeatTimer, &QTimer::timeout, this, &ChatNetworkClient::onHeartbeatTimer);
+    
+    // 登录引导超时后退回逐项请求
+    _bootstrapTimer->setSingleShot(true);
+    _bootstrapTimer->setInterval(BOOTSTRAP_TIMEOUT);
+    connect(_bootstrapTimer, &QTimer::timeout, this, &ChatNetworkClient::onBootstrapTimeout);
 }
 
 ChatNetworkClient::~ChatNetworkClient()
@@ -179,7 +187,7 @@ void ChatNetworkClient::searchUsers(const QString& keyword, int limit)
     data["keyword"] = keyword;
     data["limit"] = limit;
     
-    sendRequest("friend_search", data);
+    sendSupersedingRequest("friend_search", "friend_search", data);
 }
 
 void ChatNetworkClient::updateFriendNote(qint64 friendId, const QString& note)
@@ -259,31 +267,42 @@ void ChatNetworkClient::sendHeartbeat()
         return;
     }
     
-    QJsonObject data;
-    data["client_id"] = _networkClient->clientId();
-    data["user_id"] = _networkClient->userId();  // 添加用户ID
+    Protocol::HeartbeatRequest request;
+    request.clientId = _networkClient->clientId();
+    request.userId = _networkClient->userId();  // 添加用户ID
     
-    sendRequest("heartbeat", data);
+    sendRequest(Protocol::HeartbeatRequest::Action, request.toJson());
 }
 
 void ChatNetworkClient::sendMessage(qint64 receiverId, const QString& content, const QString& type)
 {
-    QJsonObject data;
-    data["receiver_id"] = receiverId;
-    data["content"] = content;
-    data["type"] = type;
+    Protocol::SendMessageRequest request;
+    request.receiverId = receiverId;
+    request.content = content;
+    request.type = type;
+    
+    sendRequest(Protocol::SendMessageRequest::Action, request.toJson());
+}
+
+void ChatNetworkClient::sendEphemeralEvent(qint64 receiverId, const QString& event, bool active)
+{
+    Protocol::SendEphemeralRequest request;
+    request.receiverId = receiverId;
+    request.event = event;
+    request.active = active;
     
-    sendRequest("send_message", data);
+    // 服务器成功时不回复，无需登记待处理请求
+    sendRequest(Protocol::SendEphemeralRequest::Action, request.toJson(), false);
 }
 
 void ChatNetworkClient::getChatHistory(qint64 userId, int limit, int offset)
 {
-    QJsonObject data;
-    data["chat_user_id"] = userId;
-    data["limit"] = limit;
-    data["offset"] = offset;
+    Protocol::ChatHistoryRequest request;
+    request.chatUserId = userId;
+    request.limit = limit;
+    request.offset = offset;
     
-    sendRequest("get_chat_history", data);
+    sendSupersedingRequest(QString("get_chat_history:%1").arg(userId), Protocol::ChatHistoryRequest::Action, request.toJson());
 }
 
 void ChatNetworkClient::getChatSessions()
@@ -346,13 +365,275 @@ void ChatNetworkClient::searchMessages(const QString& keyword, qint64 chatUserId
         data["chat_user_id"] = chatUserId;
     }
     
-    sendRequest("message_search", data);
+    sendSupersedingRequest("message_search", "message_search", data);
+}
+
+void ChatNetworkClient::bootstrap()
+{
+    if (!_networkClient) {
+        return;
+    }
+    
+    Protocol::BootstrapRequest request;
+    {
+        QMutexLocker locker(&_mutex);
+        qint64 userId = _networkClient->userId();
+        if (userId != _bootstrapUserId) {
+            _bootstrapCache.clear();
+            _bootstrapUserId = userId;
+        }
+        for (auto it = _bootstrapCache.constBegin(); it != _bootstrapCache.constEnd(); ++it) {
+            request.versions.insert(it.key(), it.value().version);
+        }
+    }
+    
+    QString requestId = sendRequest(Protocol::BootstrapRequest::Action, request.toJson());
+    if (requestId.isEmpty()) {
+        loadWithoutBootstrap();
+        return;
+    }
+    
+    {
+        QMutexLocker locker(&_mutex);
+        _bootstrapRequestId = requestId;
+    }
+    _bootstrapTimer->start();
+}
+
+void ChatNetworkClient::onBootstrapTimeout()
+{
+    {
+        QMutexLocker locker(&_mutex);
+        if (_bootstrapRequestId.isEmpty()) {
+            return;
+        }
+        // 之后到达的响应不再处理，避免与逐项请求的结果重复
+        _bootstrapRequestId.clear();
+    }
+    
+    LOG_WARNING("Bootstrap timed out, falling back to separate requests");
+    loadWithoutBootstrap();
+}
+
+void ChatNetworkClient::loadWithoutBootstrap()
+{
+    getFriendList();
+    getFriendGroups();
+    getOfflineMessages();
+}
+
+void ChatNetworkClient::getChatGroups()
+{
+    sendRequest("group_list");
+}
+
+void ChatNetworkClient::createChatGroup(const QString& name, const QVariantList& memberIds)
+{
+    QJsonObject data;
+    data["name"] = name;
+    data["member_ids"] = QJsonArray::fromVariantList(memberIds);
+    
+    sendRequest("group_create", data);
+}
+
+void ChatNetworkClient::addGroupMembers(qint64 groupId, const QVariantList& memberIds)
+{
+    QJsonObject data;
+    data["group_id"] = groupId;
+    data["member_ids"] = QJsonArray::fromVariantList(memberIds);
+    
+    sendRequest("group_add_members", data);
+}
+
+void ChatNetworkClient::leaveChatGroup(qint64 groupId)
+{
+    QJsonObject data;
+    data["group_id"] = groupId;
+    
+    sendRequest("group_leave", data);
+}
+
+void ChatNetworkClient::getGroupMembers(qint64 groupId)
+{
+    QJsonObject data;
+    data["group_id"] = groupId;
+    
+    sendRequest("group_members", data);
+}
+
+void ChatNetworkClient::sendGroupMessage(qint64 groupId, const QString& content, const QString& type)
+{
+    Protocol::SendGroupMessageRequest request;
+    request.groupId = groupId;
+    request.content = content;
+    request.type = type;
+    
+    sendRequest(Protocol::SendGroupMessageRequest::Action, request.toJson());
+}
+
+void ChatNetworkClient::getGroupHistory(qint64 groupId, qint64 afterSeq, qint64 beforeSeq, int limit)
+{
+    Protocol::GroupHistoryRequest request;
+    request.groupId = groupId;
+    request.limit = limit;
+    request.afterSeq = qMax<qint64>(afterSeq, 0);
+    request.beforeSeq = qMax<qint64>(beforeSeq, 0);
+    
+    // 补齐请求可被更新的补齐请求替代，翻页请求按起点区分
+    QString key = afterSeq > 0 || beforeSeq <= 0
+        ? QString("group_history:%1").arg(groupId)
+        : QString("group_history:%1:%2").arg(groupId).arg(beforeSeq);
+    sendSupersedingRequest(key, Protocol::GroupHistoryRequest::Action, request.toJson());
+}
+
+void ChatNetworkClient::markGroupRead(qint64 groupId, qint64 seq)
+{
+    Protocol::MarkGroupReadRequest request;
+    request.groupId = groupId;
+    request.seq = seq;
+    
+    sendRequest(Protocol::MarkGroupReadRequest::Action, request.toJson());
+}
+
+bool ChatNetworkClient::advanceGroupSeq(qint64 groupId, qint64 seq)
+{
+    QMutexLocker locker(&_mutex);
+    qint64 &known = _groupSeqs[groupId];
+    if (seq <= known) {
+        return false;
+    }
+    known = seq;
+    return true;
+}
+
+void ChatNetworkClient::handleGroupResponse(const QJsonObject& response)
+{
+    QString action = response["action"].toString();
+    bool success = response["success"].toBool();
+    QJsonObject data = response["data"].toObject();
+
+    if (action == "group_message") {
+        // 小群推送的完整消息
+        qint64 groupId = response["group_id"].toVariant().toLongLong();
+        qint64 seq = response["seq"].toVariant().toLongLong();
+        qint64 known = 0;
+        {
+            QMutexLocker locker(&_mutex);
+            known = _groupSeqs.value(groupId);
+        }
+        if (known > 0 && seq > known + 1) {
+            // 中间有消息未收到（如发送缓冲积压时被丢弃），按序号补齐
+            getGroupHistory(groupId, known);
+        }
+        if (advanceGroupSeq(groupId, seq)) {
+            emit groupMessageReceived(response);
+        }
+    } else if (action == "group_notify") {
+        // 大群只推送最新序号，从已收到的位置拉取
+        qint64 groupId = response["group_id"].toVariant().toLongLong();
+        qint64 lastSeq = response["last_seq"].toVariant().toLongLong();
+        qint64 known = 0;
+        {
+            QMutexLocker locker(&_mutex);
+            known = _groupSeqs.value(groupId);
+        }
+        if (lastSeq > known) {
+            getGroupHistory(groupId, known);
+        }
+    } else if (action == "group_added" || action == "group_members_changed") {
+        qint64 groupId = action == "group_added"
+            ? response["group"].toObject()["id"].toVariant().toLongLong()
+            : response["group_id"].toVariant().toLongLong();
+        emit chatGroupChanged(groupId);
+    } else if (action == "group_list_response" || action == "group_list") {
+        if (success) {
+            applyChatGroups(data["groups"].toArray());
+        }
+    } else if (action == "group_create_response" || action == "group_create") {
+        emit chatGroupCreated(success, data["group"].toObject(), response["error_message"].toString());
+    } else if (action == "group_add_members_response" || action == "group_add_members") {
+        if (success) {
+            emit chatGroupChanged(data["group_id"].toVariant().toLongLong());
+        }
+    } else if (action == "group_leave_response" || action == "group_leave") {
+        qint64 groupId = data["group_id"].toVariant().toLongLong();
+        if (success) {
+            QMutexLocker locker(&_mutex);
+            _groupSeqs.remove(groupId);
+        }
+        emit chatGroupLeft(groupId, success);
+    } else if (action == "group_members_response") {
+        if (success) {
+            emit groupMembersReceived(data["group_id"].toVariant().toLongLong(), data["members"].toArray());
+        }
+    } else if (action == "group_send_message_response" || action == "group_send_message") {
+        Protocol::SendGroupMessageResponse sent;
+        QString error;
+        if (success && !Protocol::SendGroupMessageResponse::fromJson(data, &sent, &error)) {
+            LOG_WARNING(QString("Malformed %1: %2").arg(action).arg(error));
+            success = false;
+        }
+        if (success) {
+            advanceGroupSeq(sent.groupId, sent.seq);
+        }
+        emit groupMessageSent(sent.groupId, sent.messageId, sent.seq, success);
+    } else if (action == "group_history_response") {
+        Protocol::GroupHistoryResponse history;
+        QString error;
+        if (success && Protocol::GroupHistoryResponse::fromJson(data, &history, &error)) {
+            for (const QJsonValue& value : history.messages) {
+                advanceGroupSeq(history.groupId, value.toObject()["seq"].toVariant().toLongLong());
+            }
+            emit groupHistoryReceived(history.groupId, history.messages);
+        } else if (success) {
+            LOG_WARNING(QString("Malformed %1: %2").arg(action).arg(error));
+        }
+    } else if (action == "group_mark_read_response") {
+        Protocol::MarkGroupReadResponse cursor;
+        if (success && Protocol::MarkGroupReadResponse::fromJson(data, &cursor, nullptr)) {
+            emit groupReadCursorUpdated(cursor.groupId, cursor.lastReadSeq);
+        }
+    } else if (!success) {
+        LOG_WARNING(QString("Group request %1 failed: %2").arg(action).arg(response["error_message"].toString()));
+    }
 }
 
 void ChatNetworkClient::onNetworkResponse(const QJsonObject& response)
 {
     QString action = response["action"].toString();
     QString requestId = response["request_id"].toString();
+    bool bootstrapReply = false;
+    
+    // 查询已返回，之后不再需要取消
+    if (!requestId.isEmpty()) {
+        QMutexLocker locker(&_mutex);
+        bootstrapReply = requestId == _bootstrapRequestId;
+        for (auto it = _supersedableRequests.begin(); it != _supersedableRequests.end(); ++it) {
+            if (it.value() == requestId) {
+                _supersedableRequests.erase(it);
+                break;
+            }
+        }
+    }
+    
+    // 瞬时事件不经过请求/响应流程
+    if (action == "ephemeral_event") {
+        emit ephemeralEventReceived(response["sender_id"].toVariant().toLongLong(),
+                                    response["event"].toString(),
+                                    response["active"].toBool(),
+                                    response["expires_in_ms"].toInt());
+        return;
+    } else if (action == "send_ephemeral") {
+        LOG_WARNING(QString("Ephemeral event rejected: %1").arg(response["error_message"].toString()));
+        return;
+    } else if (action.startsWith("group_")) {
+        handleGroupResponse(response);
+        return;
+    } else if (action == "bootstrap_response" || action == "bootstrap" || (action == "error" && bootstrapReply)) {
+        // 服务器繁忙等通用错误也按登录引导失败处理
+        handleBootstrapResponse(response);
+        return;
+    }
     
     // 检查是否为聊天相关的响应
     if (action.startsWith("friend_") || action.startsWith("message_") || 
@@ -391,14 +672,34 @@ void ChatNetworkClient::onHeartbeatTimer()
     }
 }
 
-void ChatNetworkClient::sendRequest(const QString& action, const QJsonObject& data)
+void ChatNetworkClient::sendSupersedingRequest(const QString& supersedeKey, const QString& action, const QJsonObject& data)
+{
+    QString previousId;
+    {
+        QMutexLocker locker(&_mutex);
+        previousId = _supersedableRequests.take(supersedeKey);
+    }
+    
+    // 旧结果已无人等待，通知服务器不再执行或中止查询
+    if (!previousId.isEmpty() && _networkClient) {
+        _networkClient->cancelRequest(previousId);
+    }
+    
+    QString requestId = sendRequest(action, data);
+    if (!requestId.isEmpty()) {
+        QMutexLocker locker(&_mutex);
+        _supersedableRequests.insert(supersedeKey, requestId);
+    }
+}
+
+QString ChatNetworkClient::sendRequest(const QString& action, const QJsonObject& data, bool expectReply)
 {
     if (!_networkClient) {
-        return;
+        return QString();
     }
 
     if (!_networkClient->isConnected()) {
-        return;
+        return QString();
     }
 
     QJsonObject request;
@@ -425,7 +726,7 @@ void ChatNetworkClient::sendRequest(const QString& action, const QJsonObject& da
     }
 
     // 使用专门的聊天请求发送方法
-    _networkClient->sendChatRequest(request);
+    return _networkClient->sendChatRequest(request, expectReply);
 }
 
 void ChatNetworkClient::handleFriendResponse(const QJsonObject& response)
@@ -589,17 +890,16 @@ void ChatNetworkClient::handleMessageResponse(const QJsonObject& response)
     QString message = response["error_message"].toString();
 
     if (action == "send_message_response") {
-        if (success) {
-            QString messageId = response["data"]["message_id"].toString();
-            emit messageSent(messageId, success);
+        Protocol::SendMessageResponse sent;
+        if (success && Protocol::SendMessageResponse::fromJson(response["data"].toObject(), &sent, nullptr)) {
+            emit messageSent(sent.messageId, success);
         } else {
             emit messageSent("", false);
         }
     } else if (action == "get_chat_history_response" || action == "get_chat_history") {
-        if (success) {
-            qint64 userId = response["data"]["chat_user_id"].toVariant().toLongLong();
-            QJsonArray messages = response["data"]["messages"].toArray();
-            emit chatHistoryReceived(userId, messages);
+        Protocol::ChatHistoryResponse history;
+        if (success && Protocol::ChatHistoryResponse::fromJson(response["data"].toObject(), &history, nullptr)) {
+            emit chatHistoryReceived(history.chatUserId, history.messages);
         }
     } else if (action == "get_chat_sessions_response") {
         if (success) {
@@ -639,6 +939,89 @@ void ChatNetworkClient::handleMessageResponse(const QJsonObject& response)
     }
 }
 
+void ChatNetworkClient::handleBootstrapResponse(const QJsonObject& response)
+{
+    {
+        QMutexLocker locker(&_mutex);
+        if (_bootstrapRequestId.isEmpty() || response["request_id"].toString() != _bootstrapRequestId) {
+            // 已超时并退回逐项请求，或是更早一次登录引导的响应
+            return;
+        }
+        _bootstrapRequestId.clear();
+    }
+    _bootstrapTimer->stop();
+    
+    if (!response["success"].toBool()) {
+        // 服务器不支持或已关闭登录引导，退回逐项请求
+        QString error = response.contains("error_message") ? response["error_message"].toString()
+                                                             : response["error"].toString();
+        LOG_WARNING(QString("Bootstrap failed, falling back to separate requests: %1").arg(error));
+        loadWithoutBootstrap();
+        return;
+    }
+    
+    QJsonObject data = response["data"].toObject();
+    QHash<QString, QJsonArray> sections;
+    {
+        QMutexLocker locker(&_mutex);
+        for (auto it = data.constBegin(); it != data.constEnd(); ++it) {
+            QJsonObject section = it.value().toObject();
+            if (section["unchanged"].toBool()) {
+                // 服务器确认未变化，使用缓存；缓存已被清空时跳过
+                if (_bootstrapCache.contains(it.key())) {
+                    sections.insert(it.key(), _bootstrapCache.value(it.key()).items);
+                }
+                continue;
+            }
+            
+            QJsonArray items = section["items"].toArray();
+            QString version = section["version"].toString();
+            if (!version.isEmpty()) {
+                _bootstrapCache.insert(it.key(), BootstrapSection{ version, items });
+            }
+            sections.insert(it.key(), items);
+        }
+    }
+    
+    // 按逐项请求的顺序发出信号：先好友和分组，再状态和会话
+    if (sections.contains("friends")) {
+        emit friendListReceived(sections.value("friends"));
+    }
+    if (sections.contains("friend_groups")) {
+        emit friendGroupsReceived(sections.value("friend_groups"));
+    }
+    if (sections.contains("friend_requests")) {
+        emit friendRequestsReceived(sections.value("friend_requests"));
+    }
+    if (sections.contains("friends_status")) {
+        emit friendsOnlineStatusReceived(sections.value("friends_status"));
+    }
+    if (sections.contains("sessions")) {
+        emit chatSessionsReceived(sections.value("sessions"));
+    }
+    if (sections.contains("groups")) {
+        applyChatGroups(sections.value("groups"));
+    }
+    
+    // 离线消息在服务器读取时即标记为已投递，不在引导中返回，单独请求并走写操作阶段
+    getOfflineMessages();
+}
+
+void ChatNetworkClient::applyChatGroups(const QJsonArray& groups)
+{
+    {
+        // 以服务器的已读游标为起点，之后的消息通过推送或拉取补齐
+        QMutexLocker locker(&_mutex);
+        for (const QJsonValue& value : groups) {
+            QJsonObject group = value.toObject();
+            qint64 groupId = group["id"].toVariant().toLongLong();
+            qint64 &known = _groupSeqs[groupId];
+            known = qMax(known, group["last_read_seq"].toVariant().toLongLong());
+        }
+    }
+    emit chatGroupsReceived(groups);
+}
+
 void ChatNetworkClient::handleNotification(const QJsonObject& notification)
 {
     QString notificationType = notification["notification_type"].toString();
@@ -6,6 +6,8 @@
 #include <QJsonArray>
 #include <QTimer>
 #include <QMutex>
+#include <QHash>
+#include <QVariantList>
 #include "../utils/Logger.h"
 
 // 前向声明
@@ -108,6 +110,14 @@ public:
      */
     void updateFriendNote(qint64 friendId, const QString& note);
 
+    /**
+     * @brief 登录引导：一次请求取回好友、分组、申请、会话、在线状态、群组和离线消息
+     *
+     * 带上已缓存的分段版本，服务器只返回有变化的分段，未变化的分段从缓存取出后同样发出对应信号。
+     * 服务器不支持或关闭时退回逐项请求。
+     */
+    Q_INVOKABLE void bootstrap();
+
     // 好友分组相关方法
     /**
      * @brief 获取好友分组列表
@@ -156,6 +166,14 @@ public:
      */
     void sendMessage(qint64 receiverId, const QString& content, const QString& type = "text");
 
+    /**
+     * @brief 发送瞬时事件（正在输入等），不保存、不确认，对方离线时被丢弃
+     * @param receiverId 接收者ID
+     * @param event 事件类型，如typing
+     * @param active true表示开始，false表示停止
+     */
+    void sendEphemeralEvent(qint64 receiverId, const QString& event, bool active = true);
+
     /**
      * @brief 获取聊天历史
      */
@@ -201,6 +219,49 @@ public:
      */
     void searchMessages(const QString& keyword, qint64 chatUserId = -1, int limit = 20);
 
+    // 群聊相关方法
+    /**
+     * @brief 获取已加入的群（包含未读数）
+     */
+    Q_INVOKABLE void getChatGroups();
+
+    /**
+     * @brief 创建群，初始成员须为好友
+     */
+    Q_INVOKABLE void createChatGroup(const QString& name, const QVariantList& memberIds);
+
+    /**
+     * @brief 邀请好友入群
+     */
+    Q_INVOKABLE void addGroupMembers(qint64 groupId, const QVariantList& memberIds);
+
+    /**
+     * @brief 退出群
+     */
+    Q_INVOKABLE void leaveChatGroup(qint64 groupId);
+
+    /**
+     * @brief 获取群成员
+     */
+    Q_INVOKABLE void getGroupMembers(qint64 groupId);
+
+    /**
+     * @brief 发送群消息
+     */
+    Q_INVOKABLE void sendGroupMessage(qint64 groupId, const QString& content, const QString& type = "text");
+
+    /**
+     * @brief 拉取群消息
+     * @param afterSeq >0时拉取该序号之后的消息，用于补齐
+     * @param beforeSeq >0时拉取该序号之前的消息，用于向上翻页
+     */
+    Q_INVOKABLE void getGroupHistory(qint64 groupId, qint64 afterSeq = 0, qint64 beforeSeq = 0, int limit = 50);
+
+    /**
+     * @brief 推进群已读游标
+     */
+    Q_INVOKABLE void markGroupRead(qint64 groupId, qint64 seq);
+
 signals:
     // 好友请求相关信号
     void friendRequestSent(bool success, const QString& message);
@@ -243,6 +304,7 @@ signals:
     // 消息信号
     void messageSent(const QString& messageId, bool success);
     void messageReceived(const QJsonObject& message);
+    void ephemeralEventReceived(qint64 senderId, const QString& event, bool active, int expiresInMs);
     void chatHistoryReceived(qint64 userId, const QJsonArray& messages);
     void chatSessionsReceived(const QJsonArray& sessions);
     void messageMarkedAsRead(const QString& messageId, bool success);
@@ -255,6 +317,17 @@ signals:
     // 消息状态更新信号
     void messageStatusUpdated(const QString& messageId, const QString& status);
 
+    // 群聊信号
+    void chatGroupsReceived(const QJsonArray& groups);
+    void chatGroupCreated(bool success, const QJsonObject& group, const QString& message);
+    void chatGroupChanged(qint64 groupId);
+    void chatGroupLeft(qint64 groupId, bool success);
+    void groupMembersReceived(qint64 groupId, const QJsonArray& members);
+    void groupMessageSent(qint64 groupId, const QString& messageId, qint64 seq, bool success);
+    void groupMessageReceived(const QJsonObject& message);
+    void groupHistoryReceived(qint64 groupId, const QJsonArray& messages);
+    void groupReadCursorUpdated(qint64 groupId, qint64 lastReadSeq);
+
     // 认证状态变化信号
     void authenticationStateChanged(bool isAuthenticated);
 
@@ -268,12 +341,25 @@ private slots:
      * @brief 处理心跳定时器
      */
     void onHeartbeatTimer();
+    
+    /**
+     * @brief 登录引导超时，退回逐项请求
+     */
+    void onBootstrapTimeout();
 
 private:
     /**
      * @brief 发送请求
+     * @param expectReply 是否等待响应
+     * @return 请求ID，未发送时为空
      */
-    void sendRequest(const QString& action, const QJsonObject& data = QJsonObject());
+    QString sendRequest(const QString& action, const QJsonObject& data = QJsonObject(), bool expectReply = true);
+
+    /**
+     * @brief 发送可被替代的查询：同一键的上一个查询尚未返回时先取消它
+     * @param supersedeKey 替代键，如搜索动作或会话的历史记录
+     */
+    void sendSupersedingRequest(const QString& supersedeKey, const QString& action, const QJsonObject& data);
 
     /**
      * @brief 处理好友相关响应
@@ -290,6 +376,32 @@ private:
      */
     void handleMessageResponse(const QJsonObject& response);
 
+    /**
+     * @brief 处理群聊响应与推送
+     */
+    void handleGroupResponse(const QJsonObject& response);
+
+    /**
+     * @brief 处理登录引导响应，按分段发出与逐项请求相同的信号
+     */
+    void handleBootstrapResponse(const QJsonObject& response);
+    
+    /**
+     * @brief 不使用登录引导，逐项请求好友、分组和离线消息
+     */
+    void loadWithoutBootstrap();
+
+    /**
+     * @brief 以服务器的已读游标更新群序号并发出群列表信号
+     */
+    void applyChatGroups(const QJsonArray& groups);
+
+    /**
+     * @brief 记录已收到的群消息序号
+     * @return 序号比已记录的新时返回true
+     */
+    bool advanceGroupSeq(qint64 groupId, qint64 seq);
+
     /**
      * @brief 处理实时通知
      */
@@ -301,11 +413,34 @@ private:
     bool _initialized;
     NetworkClient* _networkClient;
     QTimer* _heartbeatTimer;
+    QTimer* _bootstrapTimer;
     
     mutable QMutex _mutex;
     
+    // 替代键 -> 尚未返回的查询请求ID
+    QHash<QString, QString> _supersedableRequests;
+    
+    // 群ID -> 已收到的最大消息序号，收到大群通知时从这里开始拉取
+    QHash<qint64, qint64> _groupSeqs;
+    
+    /**
+     * @brief 登录引导分段缓存
+     */
+    struct BootstrapSection {
+        QString version;
+        QJsonArray items;
+    };
+    
+    // 分段名 -> 上次收到的版本和内容，切换用户时清空
+    QHash<QString, BootstrapSection> _bootstrapCache;
+    qint64 _bootstrapUserId;
+    QString _bootstrapRequestId;          // 等待响应的登录引导请求，超时或收到响应后清空
+    
     // 心跳间隔（毫秒）
     static const int HEARTBEAT_INTERVAL = 10000; // 10秒（临时用于测试）
+    
+    // 登录引导超时（毫秒），与请求默认截止时间一致
+    static const int BOOTSTRAP_TIMEOUT = 15000;
 };
 
 #endif // CHATNETWORKCLIENT_H
@@ -1,5 +1,6 @@
 #include "FriendGroupManager.h"
 #include "RecentContactsManager.h"
+#include "../chat/ChatNetworkClient.h"
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <QJsonArray>
@@ -16,6 +17,22 @@ FriendGroupManager::FriendGroupManager(QObject *parent)
     _refreshTimer->setSingleShot(false);
     connect(_refreshTimer, &QTimer::timeout, this, &FriendGroupManager::onRefreshTimer);
     
+    // 群列表与群变化通知
+    auto chatClient = ChatNetworkClient::instance();
+    if (chatClient) {
+        connect(chatClient, &ChatNetworkClient::chatGroupsReceived, this, &FriendGroupManager::handleChatGroupsReceived);
+        connect(chatClient, &ChatNetworkClient::chatGroupChanged, this, &FriendGroupManager::loadChatGroups);
+        connect(chatClient, &ChatNetworkClient::chatGroupLeft, this, &FriendGroupManager::loadChatGroups);
+        connect(chatClient, &ChatNetworkClient::groupMessageReceived, this, &FriendGroupManager::handleGroupMessageReceived);
+        connect(chatClient, &ChatNetworkClient::chatGroupCreated, this,
+                [this](bool success, const QJsonObject&, const QString& message) {
+            emit operationCompleted("create_chat_group", success, success ? QString("群创建成功") : message);
+            if (success) {
+                loadChatGroups();
+            }
+        });
+    }
+    
     // 初始化数据
     refreshData();
 }
@@ -108,8 +125,33 @@ void FriendGroupManager::loadRecentContacts()
 
 void FriendGroupManager::loadChatGroups()
 {
-    // 通过ChatNetworkClient请求群组数据
-    // 暂时保持为空等待网络客户端集成
+    // 通过ChatNetworkClient请求群组数据，结果经chatGroupsReceived返回
+    auto chatClient = ChatNetworkClient::instance();
+    if (chatClient && chatClient->isAuthenticated()) {
+        chatClient->getChatGroups();
+    }
+}
+
+void FriendGroupManager::handleGroupMessageReceived(const QJsonObject& message)
+{
+    // 本地累加未读数，已读游标以服务器为准，下次加载群列表时校正
+    qint64 groupId = message["group_id"].toVariant().toLongLong();
+    for (int i = 0; i < _chatGroups.size(); ++i) {
+        QVariantMap category = _chatGroups[i].toMap();
+        QVariantList members = category["members"].toList();
+        for (int j = 0; j < members.size(); ++j) {
+            QVariantMap group = members[j].toMap();
+            if (group["id"].toLongLong() == groupId) {
+                group["unreadCount"] = group["unreadCount"].toLongLong() + 1;
+                group["lastSeq"] = message["seq"].toVariant().toLongLong();
+                members[j] = group;
+                category["members"] = members;
+                _chatGroups[i] = category;
+                emit chatGroupsChanged();
+                return;
+            }
+        }
+    }
 }
 
 void FriendGroupManager::handleFriendGroupsReceived(const QJsonArray& groups)
@@ -433,11 +475,15 @@ QVariantMap FriendGroupManager::createRecentContactData(const QJsonObject& conta
 QVariantMap FriendGroupManager::createChatGroupData(const QJsonObject& group)
 {
     QVariantMap groupData;
-    groupData["id"] = group["id"].toInt();
+    groupData["id"] = group["id"].toVariant().toLongLong();
     groupData["name"] = group["name"].toString();
     groupData["avatar"] = group["avatar"].toString();
     groupData["description"] = group["description"].toString();
     groupData["memberCount"] = group["member_count"].toInt();
+    groupData["role"] = group["role"].toString();
+    groupData["lastSeq"] = group["last_seq"].toVariant().toLongLong();
+    groupData["lastReadSeq"] = group["last_read_seq"].toVariant().toLongLong();
+    groupData["unreadCount"] = group["unread_count"].toVariant().toLongLong();
     groupData["type"] = "group";
 
     return groupData;
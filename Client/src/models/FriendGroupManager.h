@@ -49,6 +49,7 @@ public:
     Q_INVOKABLE void handleFriendListReceived(const QJsonArray& friends);
     void handleRecentContactsReceived(const QJsonArray& contacts);
     void handleChatGroupsReceived(const QJsonArray& groups);
+    void handleGroupMessageReceived(const QJsonObject& message);
     
     // 操作结果处理
     void handleGroupCreated(const QString& groupName, bool success);
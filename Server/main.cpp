@@ -1,6 +1,7 @@
 #include "mainwindow.h"
 #include "src/ServerManager.h"
 #include "src/utils/Logger.h"
+#include "src/monitoring/FlightRecorder.h"
 
 #include <QApplication>
 #include <QMessageBox>
@@ -31,6 +32,9 @@ void globalExceptionHandler()
 // 信号处理函数（用于捕获崩溃信号）
 void signalHandler(int signal)
 {
+    // 先转储飞行记录器（仅使用异步信号安全的调用），再做其他处理
+    FlightRecorder::dumpFromSignal(signal, signal != SIGTERM);
+    
     LOG_CRITICAL(QString("Received signal %1, shutting down gracefully").arg(signal));
     
     // 记录崩溃信息
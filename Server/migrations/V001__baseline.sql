@@ -0,0 +1,127 @@
+-- 基线：原先由DatabaseManager在每次启动时创建的表
+-- 均为CREATE TABLE IF NOT EXISTS，已有的数据库上不做修改
+
+-- 创建用户表
+CREATE TABLE IF NOT EXISTS users (
+    id BIGINT UNSIGNED AUTO_INCREMENT PRIMARY KEY,
+    username VARCHAR(50) NOT NULL UNIQUE COMMENT '用户名',
+    email VARCHAR(100) NOT NULL UNIQUE COMMENT '邮箱',
+    password_hash VARCHAR(255) NOT NULL COMMENT '密码哈希',
+    salt VARCHAR(64) NOT NULL COMMENT '盐值',
+    display_name VARCHAR(200) DEFAULT NULL COMMENT '显示名称',
+    avatar_url VARCHAR(512) DEFAULT NULL COMMENT '头像URL',
+    bio TEXT DEFAULT NULL COMMENT '个人简介',
+    status ENUM('active', 'inactive', 'banned', 'deleted') DEFAULT 'inactive' COMMENT '账户状态',
+    email_verified BOOLEAN DEFAULT FALSE COMMENT '邮箱是否已验证',
+    verification_code VARCHAR(10) DEFAULT NULL COMMENT '验证码',
+    verification_expires TIMESTAMP NULL DEFAULT NULL COMMENT '验证码过期时间',
+    last_online TIMESTAMP NULL DEFAULT CURRENT_TIMESTAMP COMMENT '最后在线时间',
+    created_at TIMESTAMP DEFAULT CURRENT_TIMESTAMP COMMENT '创建时间',
+    updated_at TIMESTAMP DEFAULT CURRENT_TIMESTAMP ON UPDATE CURRENT_TIMESTAMP COMMENT '更新时间',
+    UNIQUE INDEX idx_username (username),
+    UNIQUE INDEX idx_email (email),
+    INDEX idx_status (status),
+    INDEX idx_last_online (last_online),
+    INDEX idx_email_verified (email_verified),
+    INDEX idx_verification_expires (verification_expires),
+    INDEX idx_created_at (created_at),
+    INDEX idx_updated_at (updated_at)
+) ENGINE=InnoDB COMMENT='用户表';
+
+-- 创建验证码表
+CREATE TABLE IF NOT EXISTS verification_codes (
+    id BIGINT UNSIGNED AUTO_INCREMENT PRIMARY KEY,
+    email VARCHAR(100) NOT NULL COMMENT '邮箱地址',
+    code VARCHAR(10) NOT NULL COMMENT '验证码',
+    type ENUM('registration', 'password_reset', 'email_change') DEFAULT 'registration' COMMENT '验证码类型',
+    expires_at TIMESTAMP NOT NULL COMMENT '过期时间',
+    used_at TIMESTAMP NULL DEFAULT NULL COMMENT '使用时间',
+    created_at TIMESTAMP DEFAULT CURRENT_TIMESTAMP COMMENT '创建时间',
+    INDEX idx_email (email),
+    INDEX idx_code (code),
+    INDEX idx_type (type),
+    INDEX idx_expires_at (expires_at),
+    INDEX idx_used_at (used_at),
+    INDEX idx_email_type_expires (email, type, expires_at)
+) ENGINE=InnoDB COMMENT='验证码表';
+
+-- 创建用户会话表
+CREATE TABLE IF NOT EXISTS user_sessions (
+    id BIGINT UNSIGNED AUTO_INCREMENT PRIMARY KEY,
+    user_id BIGINT UNSIGNED NOT NULL,
+    session_token VARCHAR(128) NOT NULL UNIQUE COMMENT '会话令牌',
+    refresh_token VARCHAR(128) DEFAULT NULL COMMENT '刷新令牌',
+    device_info VARCHAR(500) DEFAULT NULL COMMENT '设备信息',
+    ip_address VARCHAR(45) DEFAULT NULL COMMENT 'IP地址',
+    user_agent TEXT DEFAULT NULL COMMENT '用户代理',
+    expires_at TIMESTAMP NOT NULL COMMENT '过期时间',
+    created_at TIMESTAMP DEFAULT CURRENT_TIMESTAMP COMMENT '创建时间',
+    last_activity TIMESTAMP DEFAULT CURRENT_TIMESTAMP ON UPDATE CURRENT_TIMESTAMP COMMENT '最后活动时间',
+    FOREIGN KEY (user_id) REFERENCES users(id) ON DELETE CASCADE,
+    INDEX idx_user_id (user_id),
+    INDEX idx_session_token (session_token),
+    INDEX idx_expires_at (expires_at),
+    INDEX idx_user_expires (user_id, expires_at)
+) ENGINE=InnoDB COMMENT='用户会话表';
+
+-- 创建登录日志表
+CREATE TABLE IF NOT EXISTS login_logs (
+    id BIGINT UNSIGNED AUTO_INCREMENT PRIMARY KEY,
+    user_id BIGINT UNSIGNED,
+    username VARCHAR(50),
+    email VARCHAR(100),
+    success BOOLEAN NOT NULL,
+    ip_address VARCHAR(45),
+    user_agent TEXT,
+    error_message TEXT,
+    created_at TIMESTAMP DEFAULT CURRENT_TIMESTAMP,
+    INDEX idx_user_id (user_id),
+    INDEX idx_success (success),
+    INDEX idx_created_at (created_at),
+    FOREIGN KEY (user_id) REFERENCES users(id) ON DELETE SET NULL
+) ENGINE=InnoDB COMMENT='登录日志表';
+
+-- 创建群表，last_seq为群时间线的最新序号
+CREATE TABLE IF NOT EXISTS chat_groups (
+    id BIGINT UNSIGNED AUTO_INCREMENT PRIMARY KEY,
+    name VARCHAR(100) NOT NULL COMMENT '群名称',
+    owner_id BIGINT UNSIGNED NOT NULL COMMENT '群主ID',
+    member_count INT UNSIGNED NOT NULL DEFAULT 0 COMMENT '成员数',
+    last_seq BIGINT UNSIGNED NOT NULL DEFAULT 0 COMMENT '最新消息序号',
+    created_at TIMESTAMP DEFAULT CURRENT_TIMESTAMP COMMENT '创建时间',
+    updated_at TIMESTAMP DEFAULT CURRENT_TIMESTAMP ON UPDATE CURRENT_TIMESTAMP COMMENT '更新时间',
+    INDEX idx_owner_id (owner_id),
+    FOREIGN KEY (owner_id) REFERENCES users(id) ON DELETE CASCADE
+) ENGINE=InnoDB COMMENT='群表';
+
+-- 创建群成员表，每个成员只保存一个已读游标
+CREATE TABLE IF NOT EXISTS chat_group_members (
+    group_id BIGINT UNSIGNED NOT NULL,
+    user_id BIGINT UNSIGNED NOT NULL,
+    role ENUM('owner', 'admin', 'member') DEFAULT 'member' COMMENT '成员角色',
+    last_read_seq BIGINT UNSIGNED NOT NULL DEFAULT 0 COMMENT '已读游标',
+    joined_at TIMESTAMP DEFAULT CURRENT_TIMESTAMP COMMENT '加入时间',
+    PRIMARY KEY (group_id, user_id),
+    INDEX idx_user_id (user_id),
+    FOREIGN KEY (group_id) REFERENCES chat_groups(id) ON DELETE CASCADE,
+    FOREIGN KEY (user_id) REFERENCES users(id) ON DELETE CASCADE
+) ENGINE=InnoDB COMMENT='群成员表';
+
+-- 创建群消息表，每条消息只存一行，按(group_id, seq)读取
+CREATE TABLE IF NOT EXISTS group_messages (
+    id BIGINT UNSIGNED AUTO_INCREMENT PRIMARY KEY,
+    group_id BIGINT UNSIGNED NOT NULL,
+    seq BIGINT UNSIGNED NOT NULL COMMENT '群内序号',
+    message_id VARCHAR(64) NOT NULL UNIQUE COMMENT '消息ID',
+    sender_id BIGINT UNSIGNED NOT NULL,
+    message_type VARCHAR(20) NOT NULL DEFAULT 'text' COMMENT '消息类型',
+    content TEXT COMMENT '消息内容',
+    file_url VARCHAR(512) DEFAULT NULL COMMENT '文件URL',
+    file_size BIGINT UNSIGNED DEFAULT NULL COMMENT '文件大小',
+    file_hash VARCHAR(128) DEFAULT NULL COMMENT '文件哈希',
+    created_at TIMESTAMP DEFAULT CURRENT_TIMESTAMP COMMENT '创建时间',
+    UNIQUE INDEX idx_group_seq (group_id, seq),
+    INDEX idx_sender_id (sender_id),
+    FOREIGN KEY (group_id) REFERENCES chat_groups(id) ON DELETE CASCADE,
+    FOREIGN KEY (sender_id) REFERENCES users(id) ON DELETE CASCADE
+) ENGINE=InnoDB COMMENT='群消息表';
@@ -0,0 +1,23 @@
+-- 热点查询使用的复合索引
+-- 在线DDL（ALGORITHM=INPLACE, LOCK=NONE）：建索引期间不阻塞读写，不支持时语句失败而不是退回锁表；
+-- 同名索引已存在时迁移器视为已完成
+
+-- 单聊历史：(sender_id, receiver_id)等值后按created_at排序
+ALTER TABLE messages ADD INDEX idx_sender_receiver_created (sender_id, receiver_id, created_at),
+    ALGORITHM=INPLACE, LOCK=NONE;
+
+-- 会话列表：sender_id = ? OR receiver_id = ?，与上一个索引合并使用
+ALTER TABLE messages ADD INDEX idx_receiver_created (receiver_id, created_at),
+    ALGORITHM=INPLACE, LOCK=NONE;
+
+-- 会话列表的未读计数按(message_id, user_id)关联已读状态
+ALTER TABLE message_read_status ADD INDEX idx_message_user (message_id, user_id),
+    ALGORITHM=INPLACE, LOCK=NONE;
+
+-- 好友列表
+ALTER TABLE friendships ADD INDEX idx_user_status (user_id, status),
+    ALGORITHM=INPLACE, LOCK=NONE;
+
+-- 离线消息
+ALTER TABLE offline_message_queue ADD INDEX idx_user_created (user_id, created_at),
+    ALGORITHM=INPLACE, LOCK=NONE;
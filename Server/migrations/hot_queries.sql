@@ -0,0 +1,66 @@
+-- 热点查询，启动时和scripts/plan_check.py用EXPLAIN检查是否退化为全表扫描
+-- 每条查询前用"-- name:"命名，用"-- params:"给出示例参数（逗号分隔，整数或单引号字符串），以分号结束
+-- 修改服务中的查询时同步更新这里
+
+-- name: chat_history
+-- params: 1, 2, 2, 1, 50, 0
+SELECT m.*, s.username AS sender_username, r.username AS receiver_username
+FROM messages m
+JOIN users s ON m.sender_id = s.id
+JOIN users r ON m.receiver_id = r.id
+WHERE ((m.sender_id = ? AND m.receiver_id = ?) OR (m.sender_id = ? AND m.receiver_id = ?))
+ORDER BY m.created_at DESC
+LIMIT ? OFFSET ?;
+
+-- name: chat_sessions
+-- params: 1, 1, 1, 1, 1
+SELECT CASE WHEN m.sender_id = ? THEN m.receiver_id ELSE m.sender_id END AS chat_user_id,
+       MAX(m.created_at) AS last_message_time,
+       COUNT(CASE WHEN m.receiver_id = ? AND mrs.read_at IS NULL THEN 1 END) AS unread_count
+FROM messages m
+LEFT JOIN message_read_status mrs ON m.id = mrs.message_id AND mrs.user_id = ?
+WHERE m.sender_id = ? OR m.receiver_id = ?
+GROUP BY chat_user_id
+ORDER BY last_message_time DESC;
+
+-- name: offline_messages
+-- params: 1
+SELECT m.*, omq.priority, omq.created_at AS queued_at, s.username AS sender_username
+FROM offline_message_queue omq
+JOIN messages m ON omq.message_id = m.id
+JOIN users s ON m.sender_id = s.id
+WHERE omq.user_id = ? AND omq.delivered_at IS NULL
+ORDER BY omq.priority DESC, omq.created_at ASC;
+
+-- name: friend_list
+-- params: 1
+SELECT f.id AS friendship_id, f.friend_id, f.note, f.accepted_at, f.group_id,
+       u.username, u.display_name, fg.group_name, fg.group_order
+FROM friendships f
+JOIN users u ON f.friend_id = u.id
+LEFT JOIN friend_groups fg ON f.group_id = fg.id
+WHERE f.user_id = ? AND f.status = 'accepted'
+ORDER BY COALESCE(fg.group_order, 999999), u.display_name ASC;
+
+-- name: group_list
+-- params: 1
+SELECT g.id, g.name, g.owner_id, g.member_count, g.last_seq, g.updated_at, gm.role, gm.last_read_seq
+FROM chat_group_members gm
+JOIN chat_groups g ON g.id = gm.group_id
+WHERE gm.user_id = ?
+ORDER BY g.updated_at DESC;
+
+-- name: group_history
+-- params: 1, 100, 50
+SELECT m.seq, m.message_id, m.sender_id, m.content, u.username AS sender_username
+FROM group_messages m
+JOIN users u ON u.id = m.sender_id
+WHERE m.group_id = ? AND m.seq > ?
+ORDER BY m.seq ASC
+LIMIT ?;
+
+-- name: verification_code
+-- params: 'user1@example.com', '123456', 'registration'
+SELECT id, expires_at, used_at FROM verification_codes
+WHERE email = ? AND code = ? AND type = ?
+ORDER BY created_at DESC LIMIT 1;
@@ -4,20 +4,37 @@
 #include "security/OpenSSLHelper.h"
 #include "database/DatabaseManager.h"
 #include "database/RedisClient.h"
+#include "database/RedisKeys.h"
 #include "auth/EmailService.h"
 #include "network/ThreadPoolServer.h"
 #include "network/AsyncMessageQueue.h"
 #include "network/ProtocolHandler.h"
 #include "network/ClientHandler.h"
+#include "network/IoBufferPool.h"
+#include "network/RequestExecutor.h"
 #include "utils/Logger.h"
 #include "utils/Crypto.h"
 #include "auth/UserService.h"
 #include "chat/FriendService.h"
 #include "chat/MessageService.h"
 #include "chat/OnlineStatusService.h"
+#include "chat/EphemeralChannel.h"
+#include "chat/GroupService.h"
+#include "chat/BootstrapService.h"
+#include "cluster/ClusterManager.h"
 #include "cache/CacheManager.h"
+#include "cache/WarmStateStore.h"
+#include "auth/AuthCache.h"
 #include "rate_limit/RateLimitManager.h"
 #include "database/DatabaseConnectionPool.h"
+#include "database/QueryStatistics.h"
+#include "database/RetentionScheduler.h"
+#include "database/SchemaMigrator.h"
+#include "monitoring/Tracer.h"
+#include "monitoring/EventLoopMonitor.h"
+#include "monitoring/FlightRecorder.h"
+#include "utils/StartupOrchestrator.h"
+#include "utils/RequestCancellation.h"
 #include <QJsonObject>
 #include <QJsonArray>
 #include <QJsonDocument>
@@ -30,6 +47,31 @@
 #include <QCoreApplication>
 #include <QHostAddress>
 
+namespace {
+
+/**
+ * @brief 读取执行阶段配置（request_executor.stages.<阶段名>.*）
+ */
+RequestExecutor::StageConfig loadExecutorStageConfig(ConfigManager *configManager, RequestExecutor::Stage stage)
+{
+    // 默认值：各阶段数据库配额之和小于连接池上限，保证任一阶段耗尽配额时其他阶段仍有连接可用
+    static const int defaults[RequestExecutor::StageCount][3] = {
+        { 8, 2000, 4 },       // auth
+        { 16, 10000, 8 },     // interactive_write
+        { 8, 2000, 4 },       // read_heavy
+        { 4, 5000, 2 }        // background
+    };
+
+    QString prefix = QString("request_executor.stages.%1.").arg(RequestExecutor::stageName(stage));
+    RequestExecutor::StageConfig config;
+    config.maxConcurrent = configManager->getValue(prefix + "max_concurrent", defaults[stage][0]).toInt();
+    config.maxQueued = configManager->getValue(prefix + "max_queued", defaults[stage][1]).toInt();
+    config.dbConnections = configManager->getValue(prefix + "db_connections", defaults[stage][2]).toInt();
+    return config;
+}
+
+} // namespace
+
 // 静态成员初始化
 ServerManager* ServerManager::s_instance = nullptr;
 
@@ -43,6 +85,7 @@ ServerManager::ServerManager(QObject *parent)
     , _threadPoolServer(nullptr)
     , _messageQueue(nullptr)
     , _protocolHandler(nullptr)
+    , _startupOrchestrator(nullptr)
     , _clientCount(0)
     , _totalConnections(0)
     , _totalRegistrations(0)
@@ -52,6 +95,7 @@ ServerManager::ServerManager(QObject *parent)
 ServerManager::~ServerManager()
 {
     stopServer();
+    delete _startupOrchestrator;
 }
 
 ServerManager* ServerManager::instance()
@@ -159,42 +203,82 @@ bool ServerManager::initialize()
         return false;
     }
 
-    // 初始化核心组件
-    if (!initializeDatabasePool()) {
-        LOG_ERROR("Failed to initialize database connection pool");
+    // 按依赖关系并行初始化各子系统
+    if (!runStartupOrchestration()) {
         setServerState(Error);
         return false;
     }
 
-    if (!initializeRedis()) {
-        LOG_WARNING("Failed to initialize Redis (optional)");
-    }
+    setServerState(Stopped);
 
-    if (!initializeEmailService()) {
-        LOG_ERROR("Failed to initialize email service - verification codes will not work");
-        setServerState(Error);
-        return false;
-    }
+    return true;
+}
+
+bool ServerManager::runStartupOrchestration()
+{
+    ConfigManager* configManager = ConfigManager::instance();
+
+    StartupOrchestrator::OrchestratorConfig orchestratorConfig;
+    orchestratorConfig.parallel = configManager->getValue("startup.parallel", true).toBool();
+    orchestratorConfig.readinessTimeoutMs = configManager->getValue("startup.readiness_timeout_ms", 10000).toInt();
+    orchestratorConfig.maxWorkerThreads = configManager->getValue("startup.max_worker_threads", 4).toInt();
+    bool cacheWarmup = configManager->getValue("startup.cache_warmup", true).toBool();
+    bool useTls = configManager->getValue("server.use_tls", true).toBool();
+
+    // 工作线程中初始化的组件需要在主线程中预先创建，保证其线程亲和性（定时器、信号槽）
+    DatabaseManager::instance();
+    DatabaseConnectionPool::instance();
+    CertificateManager::instance();
+
+    delete _startupOrchestrator;
+    _startupOrchestrator = new StartupOrchestrator();
+    _startupOrchestrator->setConfig(orchestratorConfig);
+
+    using Orchestrator = StartupOrchestrator;
+
+    // 追踪和监控需要在其他组件之前就绪，以覆盖启动后的首批请求
+    _startupOrchestrator->addTask("tracing", [this]() { return initializeTracing(); },
+                                  QStringList(), false, Orchestrator::MainThread);
+    _startupOrchestrator->addTask("event_loop_monitor", [this]() { return initializeEventLoopMonitor(); },
+                                  QStringList(), false, Orchestrator::MainThread);
+    _startupOrchestrator->addTask("flight_recorder", [this]() { return initializeFlightRecorder(); },
+                                  QStringList() << "event_loop_monitor", false, Orchestrator::MainThread);
+
+    // 数据库连接只能在创建它的线程中使用，连接池在主线程中建立初始连接
+    _startupOrchestrator->addTask("database", [this]() { return initializeDatabasePool(); },
+                                  QStringList() << "tracing" << "flight_recorder", true, Orchestrator::MainThread);
+    
+    // 阻塞型初始化在工作线程中并行执行
+    _startupOrchestrator->addTask("certificates", [this]() { return initializeCertificates(); },
+                                  QStringList(), useTls, Orchestrator::AnyThread);
+
+    // Redis套接字和邮件服务的QObject归属主线程
+    _startupOrchestrator->addTask("redis", [this]() { return initializeRedis(); },
+                                  QStringList(), false, Orchestrator::MainThread);
+    _startupOrchestrator->addTask("email", [this]() { return initializeEmailService(); },
+                                  QStringList(), true, Orchestrator::MainThread);
 
     // 暂时禁用AsyncMessageQueue，避免重复发送消息
-    // if (!initializeMessageQueue()) {
-    //     LOG_ERROR("Failed to initialize async message queue");
-    //     setServerState(Error);
-    //     return false;
-    // }
-    // LOG_INFO removed
+    // _startupOrchestrator->addTask("message_queue", [this]() { return initializeMessageQueue(); });
 
-    if (!initializeThreadPoolServer()) {
-        LOG_ERROR("Failed to initialize thread pool server");
-        setServerState(Error);
-        return false;
-    }
+    _startupOrchestrator->addTask("thread_pool_server", [this]() { return initializeThreadPoolServer(); },
+                                  QStringList() << "database" << "redis" << "email", true, Orchestrator::MainThread);
 
-    // 异步初始化证书
-    QTimer::singleShot(200, this, &ServerManager::initializeCertificatesAsync);
+    QStringList warmStateDependencies = QStringList() << "database";
+    if (cacheWarmup) {
+        _startupOrchestrator->addTask("cache_warmup", [this]() { return warmUpCaches(); },
+                                      QStringList() << "database" << "redis", false, Orchestrator::MainThread);
+        warmStateDependencies << "cache_warmup";
+    }
 
+    // 在开始接受连接前恢复上次关闭时的热状态
+    _startupOrchestrator->addTask("warm_state", [this]() { return initializeWarmState(); },
+                                  warmStateDependencies, false, Orchestrator::MainThread);
 
-    setServerState(Stopped);
+    if (!_startupOrchestrator->run()) {
+        LOG_ERROR(QString("Server startup failed at: %1").arg(_startupOrchestrator->failedTask()));
+        return false;
+    }
 
     return true;
 }
@@ -224,6 +308,19 @@ bool ServerManager::startServer(quint16 port)
     // 从配置文件读取TLS设置
     bool useTls = configManager->getValue("server.use_tls", true).toBool();
     
+    // 就绪门控：必需组件全部就绪后才开始接受连接
+    if (!_startupOrchestrator || !_startupOrchestrator->isReady()) {
+        LOG_ERROR("Startup readiness gate not passed, refusing to accept connections");
+        setServerState(Error);
+        return false;
+    }
+    
+    if (useTls && CertificateManager::instance()->getCurrentCertificate().isNull()) {
+        LOG_ERROR("TLS is enabled but no server certificate is available");
+        setServerState(Error);
+        return false;
+    }
+    
     // 启动线程池服务器
     if (!_threadPoolServer->startServer(port, QHostAddress::Any, useTls)) {
         LOG_ERROR("Failed to start thread pool server");
@@ -254,11 +351,29 @@ void ServerManager::stopServer()
     // LOG_INFO removed
     setServerState(Stopping);
 
+    // 等待转入后台的启动任务结束
+    if (_startupOrchestrator) {
+        _startupOrchestrator->waitForBackgroundTasks();
+    }
+
+    // 退出集群，本地用户的目录项需在断开连接前删除
+    ClusterManager::instance()->shutdown();
+
     // 停止线程池服务器
     if (_threadPoolServer) {
         _threadPoolServer->stopServer();
     }
 
+    // 不再有新请求后写出热状态快照，供下次启动恢复
+    WarmStateStore* warmStateStore = WarmStateStore::instance();
+    if (warmStateStore->isEnabled()) {
+        warmStateStore->shutdown();
+        warmStateStore->save();
+    }
+
+    // 保留任务在当前分块结束后退出，之后才能关闭连接池
+    RetentionScheduler::instance()->shutdown();
+
     // 停止异步消息队列
     if (_messageQueue) {
         _messageQueue->shutdown();
@@ -275,6 +390,15 @@ void ServerManager::stopServer()
         _redisClient->close();
     }
 
+    // 停止事件循环监控
+    EventLoopMonitor::instance()->shutdown();
+
+    // 按配置转储并关闭飞行记录器
+    FlightRecorder::shutdown();
+
+    // 写出剩余追踪数据
+    Tracer::instance()->shutdown();
+
     // 清理OpenSSL
     OpenSSLHelper::cleanupOpenSSL();
 
@@ -301,10 +425,12 @@ QJsonObject ServerManager::getServerStatistics() const
     if (_databaseManager) {
         stats["database_pool"] = _databaseManager->getConnectionPoolStatistics();
     }
+    stats["retention"] = RetentionScheduler::instance()->getStatistics();
     
     // Redis状态
     if (_redisClient) {
         stats["redis_connected"] = _redisClient->isConnected();
+        stats["redis"] = _redisClient->getStatistics();
     }
     
     // 线程池服务器统计
@@ -319,6 +445,23 @@ QJsonObject ServerManager::getServerStatistics() const
         stats["message_queue"] = queueStats;
     }
     
+    // 慢查询与语句指纹统计
+    stats["query_statistics"] = QueryStatistics::instance()->getStatistics();
+    
+    // 热状态快照统计
+    stats["warm_state"] = WarmStateStore::instance()->getStatistics();
+    
+    // 启动编排统计
+    if (_startupOrchestrator) {
+        stats["startup"] = _startupOrchestrator->getStatistics();
+    }
+    
+    // 请求追踪统计
+    stats["tracing"] = Tracer::instance()->getStatistics();
+    
+    // 事件循环延迟统计
+    stats["event_loop"] = EventLoopMonitor::instance()->getStatistics();
+    
     return stats;
 }
 
@@ -338,6 +481,9 @@ QJsonObject ServerManager::getHighConcurrencyStatus()
     // 热点数据状态
     status["hot_data"] = getHotDataStatistics();
     
+    // 慢查询Top-N
+    status["slow_queries"] = QueryStatistics::instance()->getTopQueries("total_time");
+    
     // 整体性能指标
     QJsonObject performance;
     performance["uptime"] = _startTime.secsTo(QDateTime::currentDateTime());
@@ -555,6 +701,17 @@ void ServerManager::onMessageQueueError(const QString &error)
     emit serverError(QString("Message queue error: %1").arg(error));
 }
 
+void ServerManager::onConfigReloaded()
+{
+    ConfigManager *configManager = ConfigManager::instance();
+    RequestExecutor *executor = RequestExecutor::instance();
+    for (int i = 0; i < RequestExecutor::StageCount; ++i) {
+        RequestExecutor::Stage stage = static_cast<RequestExecutor::Stage>(i);
+        executor->setStageConfig(stage, loadExecutorStageConfig(configManager, stage));
+    }
+    LOG_INFO("Request executor stage limits reloaded");
+}
+
 void ServerManager::setServerState(ServerState state)
 {
     if (_serverState != state) {
@@ -580,13 +737,25 @@ bool ServerManager::initializeDatabasePool()
     int minConnections = configManager->getValue("database.min_connections", 5).toInt();
     int maxConnections = configManager->getValue("database.max_connections", 20).toInt();
     
-    
+    // 语句指纹统计与慢查询日志
+    QueryStatistics::StatsConfig statsConfig;
+    statsConfig.enabled = configManager->getValue("query_stats.enabled", true).toBool();
+    statsConfig.slowThresholdMs = configManager->getValue("query_stats.slow_threshold_ms",
+        configManager->getValue("logging.slow_query_threshold_ms", 1000)).toInt();
+    statsConfig.explainEnabled = configManager->getValue("query_stats.explain_enabled", true).toBool();
+    statsConfig.explainIntervalSeconds = configManager->getValue("query_stats.explain_interval_seconds", 300).toInt();
+    statsConfig.maxExplainsPerMinute = configManager->getValue("query_stats.max_explains_per_minute", 10).toInt();
+    statsConfig.maxFingerprints = configManager->getValue("query_stats.max_fingerprints", 1000).toInt();
+    statsConfig.topN = configManager->getValue("query_stats.top_n", 10).toInt();
+    QueryStatistics::instance()->configure(statsConfig);
     
     bool result = _databaseManager->initialize(host, port, database, username, password, 
                                               minConnections, maxConnections);
     
-    if (result) {
-    
+    // 迁移完成后检查热点查询的执行计划，只记录警告不阻止启动
+    if (result && configManager->getValue("migrations.plan_check", true).toBool()) {
+        qint64 minRows = configManager->getValue("migrations.plan_check_min_rows", 1000).toLongLong();
+        SchemaMigrator::checkQueryPlans(minRows);
     }
     
     return result;
@@ -599,16 +768,37 @@ bool ServerManager::initializeRedis()
     connect(_redisClient, &RedisClient::connectionStateChanged,
             this, &ServerManager::onRedisConnectionChanged);
     
-    // 从配置文件读取Redis配置
+    // 键前缀须在任何键被使用之前设置
     ConfigManager* configManager = ConfigManager::instance();
-    QString host = configManager->getValue("redis.host", "localhost").toString();
-    int port = configManager->getValue("redis.port", 6379).toInt();
-    QString password = configManager->getValue("redis.password", "").toString();
-    int database = configManager->getValue("redis.database", 0).toInt();
+    RedisKeys::setPrefix(configManager->getValue("redis.key_prefix", "qkchat:").toString());
     
+    return _redisClient->initialize(loadRedisRouterConfig());
+}
 
+RedisRouter::Config ServerManager::loadRedisRouterConfig() const
+{
+    // 从配置文件读取Redis配置
+    ConfigManager* configManager = ConfigManager::instance();
+    RedisRouter::Config config;
+    config.mode = RedisRouter::modeFromString(configManager->getValue("redis.mode", "standalone").toString());
+    config.host = configManager->getValue("redis.host", "localhost").toString();
+    config.port = configManager->getValue("redis.port", 6379).toInt();
+    config.clusterNodes = configManager->getValue("redis.cluster_nodes", QStringList()).toStringList();
+    config.sentinels = configManager->getValue("redis.sentinels", QStringList()).toStringList();
+    config.masterName = configManager->getValue("redis.master_name", "mymaster").toString();
+    config.sentinelPassword = configManager->getValue("redis.sentinel_password", "").toString();
+    config.password = configManager->getValue("redis.password", "").toString();
+    config.database = configManager->getValue("redis.database", 0).toInt();
+    config.timeoutMs = configManager->getValue("redis.timeout",
+                                               configManager->getValue("redis.connection_timeout", 2000)).toInt();
+    config.maxRedirects = configManager->getValue("redis.max_redirects", 5).toInt();
     
-    return _redisClient->initialize(host, port, password, database);
+    // 未列出种子节点时以host:port作为唯一种子
+    if (config.mode == RedisRouter::Cluster && config.clusterNodes.isEmpty()) {
+        config.clusterNodes.append(QString("%1:%2").arg(config.host).arg(config.port));
+    }
+    
+    return config;
 }
 
 bool ServerManager::initializeEmailService()
@@ -633,6 +823,60 @@ bool ServerManager::initializeEmailService()
     return _emailService->initialize(host, port, username, password, useTls);
 }
 
+void ServerManager::registerRetentionJobs()
+{
+    ConfigManager* configManager = ConfigManager::instance();
+    RetentionScheduler* retention = RetentionScheduler::instance();
+
+    RetentionScheduler::Job codes;
+    codes.name = "verification_codes";
+    codes.table = "verification_codes";
+    codes.condition = "expires_at < NOW()";
+    codes.intervalSeconds = configManager->getValue("retention.intervals.verification_codes", 300).toInt();
+    retention->registerJob(codes);
+
+    RetentionScheduler::Job sessions;
+    sessions.name = "user_sessions";
+    sessions.table = "user_sessions";
+    sessions.condition = "expires_at < NOW()";
+    sessions.intervalSeconds = configManager->getValue("retention.intervals.user_sessions", 300).toInt();
+    retention->registerJob(sessions);
+
+    RetentionScheduler::Job loginLogs;
+    loginLogs.name = "login_logs";
+    loginLogs.table = "login_logs";
+    loginLogs.condition = "created_at < DATE_SUB(NOW(), INTERVAL ? DAY)";
+    loginLogs.params << configManager->getValue("retention.login_log_days", 30).toInt();
+    loginLogs.intervalSeconds = configManager->getValue("retention.intervals.login_logs", 3600).toInt();
+    retention->registerJob(loginLogs);
+
+    // 已送达的离线队列记录只用于排查，保留一段时间后删除
+    RetentionScheduler::Job offlineQueue;
+    offlineQueue.name = "offline_queue";
+    offlineQueue.table = "offline_message_queue";
+    offlineQueue.condition = "delivered_at IS NOT NULL AND delivered_at < DATE_SUB(NOW(), INTERVAL ? DAY)";
+    offlineQueue.params << configManager->getValue("retention.offline_queue_days", 7).toInt();
+    offlineQueue.intervalSeconds = configManager->getValue("retention.intervals.offline_queue", 3600).toInt();
+    retention->registerJob(offlineQueue);
+
+    // 以下两项由所属服务的定时器触发
+    RetentionScheduler::Job searchCache;
+    searchCache.name = "search_cache";
+    searchCache.table = "search_cache";
+    searchCache.keyColumn = "cache_key";
+    searchCache.cursorStart = QString("");
+    searchCache.condition = "expires_at < NOW()";
+    retention->registerJob(searchCache);
+
+    RetentionScheduler::Job onlineStatus;
+    onlineStatus.name = "online_status";
+    onlineStatus.table = "user_online_status";
+    onlineStatus.condition = "status != 'offline' AND last_seen < DATE_SUB(NOW(), INTERVAL ? SECOND)";
+    onlineStatus.params << OnlineStatusService::heartbeatTimeoutSeconds();
+    onlineStatus.assignment = "status = 'offline'";
+    retention->registerJob(onlineStatus);
+}
+
 bool ServerManager::initializeThreadPoolServer()
 {
     _threadPoolServer = new ThreadPoolServer(this);
@@ -652,6 +896,103 @@ bool ServerManager::initializeThreadPoolServer()
     serverConfig.enableLoadBalancing = configManager->getValue("server.enable_load_balancing", true).toBool();
     serverConfig.enableRateLimiting = configManager->getValue("server.enable_rate_limiting", true).toBool();
     serverConfig.maxConnectionsPerIP = configManager->getValue("server.max_connections_per_ip", 10).toInt();
+    serverConfig.outbound.writeWatermark = configManager->getValue("outbound.write_watermark_bytes", 64 * 1024).toLongLong();
+    serverConfig.outbound.controlBudget = configManager->getValue("outbound.control_budget_bytes", 256 * 1024).toLongLong();
+    serverConfig.outbound.chatBudget = configManager->getValue("outbound.chat_budget_bytes", 2 * 1024 * 1024).toLongLong();
+    serverConfig.outbound.bulkBudget = configManager->getValue("outbound.bulk_budget_bytes", 128 * 1024).toLongLong();
+    serverConfig.outbound.hardLimit = configManager->getValue("outbound.hard_limit_bytes", 8 * 1024 * 1024).toLongLong();
+    serverConfig.outbound.slowConsumerTimeoutMs = configManager->getValue("outbound.slow_consumer_timeout_ms", 30000).toInt();
+    serverConfig.socketReadBufferSize = configManager->getValue("io_buffers.socket_read_buffer_bytes", 64 * 1024).toLongLong();
+    serverConfig.idleBufferShrinkMs = configManager->getValue("io_buffers.idle_shrink_ms", 10000).toInt();
+    serverConfig.inboundFastPath = configManager->getValue("inbound_parser.fast_path", true).toBool();
+    serverConfig.hibernation.enabled = configManager->getValue("hibernation.enabled", true).toBool();
+    serverConfig.hibernation.idleSeconds = configManager->getValue("hibernation.idle_seconds", 120).toInt();
+    serverConfig.hibernation.sweepIntervalMs = configManager->getValue("hibernation.sweep_interval_ms", 10000).toInt();
+    serverConfig.ioUring.enabled = configManager->getValue("io_uring.enabled", false).toBool();
+    serverConfig.ioUring.queueDepth = configManager->getValue("io_uring.queue_depth", 2048).toInt();
+    serverConfig.ioUring.bufferCount = configManager->getValue("io_uring.buffer_count", 4096).toInt();
+    serverConfig.ioUring.bufferSize = configManager->getValue("io_uring.buffer_size", 16384).toInt();
+    serverConfig.ioUring.maxBatchFrames = configManager->getValue("io_uring.max_batch_frames", 64).toInt();
+    serverConfig.kernelTls.enabled = configManager->getValue("kernel_tls.enabled", false).toBool();
+    serverConfig.kernelTls.handshakeTimeoutMs = configManager->getValue("kernel_tls.handshake_timeout_ms", 10000).toInt();
+    serverConfig.kernelTls.cipherList = configManager->getValue("kernel_tls.cipher_list",
+                                                                serverConfig.kernelTls.cipherList).toString();
+    serverConfig.executor.enabled = configManager->getValue("request_executor.enabled", true).toBool();
+    serverConfig.executor.workerThreads = configManager->getValue("request_executor.worker_threads", 0).toInt();
+    serverConfig.executor.maxPending = configManager->getValue("request_executor.max_pending", 20000).toInt();
+    for (int i = 0; i < RequestExecutor::StageCount; ++i) {
+        serverConfig.executor.stages[i] = loadExecutorStageConfig(configManager, static_cast<RequestExecutor::Stage>(i));
+    }
+    
+    // 共享I/O块池需在第一个连接建立前配置
+    IoBufferPool::PoolConfig bufferPoolConfig;
+    bufferPoolConfig.chunkSize = configManager->getValue("io_buffers.chunk_size", 4096).toInt();
+    bufferPoolConfig.maxPooledChunks = configManager->getValue("io_buffers.max_pooled_chunks", 4096).toInt();
+    IoBufferPool::instance()->configure(bufferPoolConfig);
+
+    // 请求截止时间与取消需在第一个请求到达前配置
+    RequestCancellation::Config deadlineConfig;
+    deadlineConfig.enabled = configManager->getValue("request_deadlines.enabled", true).toBool();
+    deadlineConfig.defaultDeadlineMs = configManager->getValue("request_deadlines.default_deadline_ms", 0).toInt();
+    deadlineConfig.maxDeadlineMs = configManager->getValue("request_deadlines.max_deadline_ms", 60000).toInt();
+    deadlineConfig.killRunningQueries = configManager->getValue("request_deadlines.kill_running_queries", true).toBool();
+    RequestCancellation::instance()->configure(deadlineConfig);
+
+    // 瞬时事件通道（正在输入等）
+    EphemeralChannel::Config ephemeralConfig;
+    ephemeralConfig.enabled = configManager->getValue("ephemeral_events.enabled", true).toBool();
+    ephemeralConfig.coalesceWindowMs = configManager->getValue("ephemeral_events.coalesce_window_ms", 2000).toInt();
+    ephemeralConfig.expiresInMs = configManager->getValue("ephemeral_events.expires_in_ms", 6000).toInt();
+    ephemeralConfig.friendCacheMs = configManager->getValue("ephemeral_events.friend_cache_ms", 60000).toInt();
+    QStringList eventTypes = configManager->getValue("ephemeral_events.event_types").toStringList();
+    if (!eventTypes.isEmpty()) {
+        ephemeralConfig.eventTypes = eventTypes;
+    }
+    EphemeralChannel::instance()->configure(ephemeralConfig);
+
+    // 群聊：超过推送上限的大群只推送序号通知，由客户端拉取
+    GroupService::Config groupConfig;
+    groupConfig.pushMemberLimit = configManager->getValue("group_chat.push_member_limit", 200).toInt();
+    groupConfig.maxMembers = configManager->getValue("group_chat.max_members", 2000).toInt();
+    groupConfig.memberCacheMs = configManager->getValue("group_chat.member_cache_ms", 30000).toInt();
+    groupConfig.historyPageLimit = configManager->getValue("group_chat.history_page_limit", 100).toInt();
+    GroupService::instance()->configure(groupConfig);
+
+    // 登录引导：合并登录后的各项查询为一次请求
+    BootstrapService::Config bootstrapConfig;
+    bootstrapConfig.enabled = configManager->getValue("bootstrap.enabled", true).toBool();
+    BootstrapService::instance()->configure(bootstrapConfig);
+
+    // 数据保留：过期数据按主键分块清理
+    RetentionScheduler::Config retentionConfig;
+    retentionConfig.enabled = configManager->getValue("retention.enabled", true).toBool();
+    retentionConfig.initialChunkSize = configManager->getValue("retention.initial_chunk_size", 500).toInt();
+    retentionConfig.minChunkSize = configManager->getValue("retention.min_chunk_size", 50).toInt();
+    retentionConfig.maxChunkSize = configManager->getValue("retention.max_chunk_size", 5000).toInt();
+    retentionConfig.pauseMs = configManager->getValue("retention.pause_ms", 100).toInt();
+    retentionConfig.targetChunkMs = configManager->getValue("retention.target_chunk_ms", 100).toInt();
+    retentionConfig.maxChunksPerRun = configManager->getValue("retention.max_chunks_per_run", 200).toInt();
+    RetentionScheduler* retention = RetentionScheduler::instance();
+    retention->configure(retentionConfig);
+    registerRetentionJobs();
+
+    // 集群路由：Redis在线目录与节点间投递总线
+    ClusterManager::Config clusterConfig;
+    clusterConfig.enabled = configManager->getValue("cluster.enabled", false).toBool();
+    clusterConfig.nodeId = configManager->getValue("cluster.node_id", "").toString();
+    clusterConfig.busHost = configManager->getValue("cluster.bus_host", "0.0.0.0").toString();
+    clusterConfig.busPort = configManager->getValue("cluster.bus_port", 9100).toInt();
+    clusterConfig.advertiseHost = configManager->getValue("cluster.advertise_host", "").toString();
+    clusterConfig.busSecret = configManager->getValue("cluster.bus_secret", "").toString();
+    clusterConfig.redis = loadRedisRouterConfig();
+    clusterConfig.redis.timeoutMs = configManager->getValue("cluster.redis_timeout_ms", 500).toInt();
+    clusterConfig.presenceTtlSec = configManager->getValue("cluster.presence_ttl_sec", 60).toInt();
+    clusterConfig.leaseRenewMs = configManager->getValue("cluster.lease_renew_ms", 20000).toInt();
+    clusterConfig.lookupCacheMs = configManager->getValue("cluster.lookup_cache_ms", 1000).toInt();
+    clusterConfig.batchMaxFrames = configManager->getValue("cluster.batch_max_frames", 256).toInt();
+    clusterConfig.batchFlushMs = configManager->getValue("cluster.batch_flush_ms", 2).toInt();
+    clusterConfig.maxPendingFrames = configManager->getValue("cluster.max_pending_frames", 20000).toInt();
+    ClusterManager::instance()->configure(clusterConfig);
 
     // 初始化线程池服务器
     if (!_threadPoolServer->initialize(serverConfig)) {
@@ -662,6 +1003,14 @@ bool ServerManager::initializeThreadPoolServer()
     // 设置协议处理器
     _threadPoolServer->setProtocolHandler(_protocolHandler);
     
+    // 集群模式下Redis目录不可用时无法判断其他节点上的用户，不启动
+    if (!ClusterManager::instance()->start()) {
+        LOG_ERROR("Failed to start cluster routing");
+        return false;
+    }
+    
+    retention->start();
+    
     // 连接信号
     connect(_threadPoolServer, &ThreadPoolServer::clientConnected,
             this, &ServerManager::onThreadPoolClientConnected);
@@ -671,6 +1020,10 @@ bool ServerManager::initializeThreadPoolServer()
             this, &ServerManager::onThreadPoolUserLoggedIn);
     connect(_threadPoolServer, &ThreadPoolServer::userLoggedOut,
             this, &ServerManager::onThreadPoolUserLoggedOut);
+    connect(_threadPoolServer, &ThreadPoolServer::userLoggedIn,
+            ClusterManager::instance(), &ClusterManager::onUserLoggedIn);
+    connect(_threadPoolServer, &ThreadPoolServer::userLoggedOut,
+            ClusterManager::instance(), &ClusterManager::onUserLoggedOut);
     
     // 连接协议处理器信号
     connect(_protocolHandler, &ProtocolHandler::userLoggedIn,
@@ -678,6 +1031,9 @@ bool ServerManager::initializeThreadPoolServer()
     connect(_protocolHandler, &ProtocolHandler::userRegistered,
             this, &ServerManager::onProtocolUserRegistered);
     
+    // 配置文件热加载后调整执行阶段上限
+    connect(configManager, &ConfigManager::configReloaded,
+            this, &ServerManager::onConfigReloaded, Qt::UniqueConnection);
 
     return true;
 }
@@ -693,9 +1049,12 @@ bool ServerManager::initializeMessageQueue()
     queueConfig.maxQueueSize = configManager->getValue("message_queue.max_queue_size", 10000).toInt();
     queueConfig.workerThreads = configManager->getValue("message_queue.worker_threads", 4).toInt();
     queueConfig.batchSize = configManager->getValue("message_queue.batch_size", 50).toInt();
-    queueConfig.processingInterval = configManager->getValue("message_queue.processing_interval", 10).toInt();
+    queueConfig.minBatchSize = configManager->getValue("message_queue.min_batch_size", 1).toInt();
     queueConfig.maxRetryCount = configManager->getValue("message_queue.max_retry_count", 3).toInt();
     queueConfig.retryDelay = configManager->getValue("message_queue.retry_delay", 1000).toInt();
+    queueConfig.maxRetryDelay = configManager->getValue("message_queue.max_retry_delay", 30000).toInt();
+    queueConfig.retryJitter = configManager->getValue("message_queue.retry_jitter", 0.5).toDouble();
+    queueConfig.maxDeadLetters = configManager->getValue("message_queue.max_dead_letters", 1000).toInt();
     queueConfig.enableFlowControl = configManager->getValue("message_queue.enable_flow_control", true).toBool();
     queueConfig.flowControlThreshold = configManager->getValue("message_queue.flow_control_threshold", 8000).toInt();
 
@@ -713,24 +1072,146 @@ bool ServerManager::initializeMessageQueue()
     return true;
 }
 
-void ServerManager::initializeCertificatesAsync()
+bool ServerManager::initializeTracing()
 {
-    try {
-        CertificateManager* certManager = CertificateManager::instance();
+    ConfigManager* configManager = ConfigManager::instance();
 
-        // LOG_INFO removed
+    Tracer::TracerConfig tracerConfig;
+    tracerConfig.enabled = configManager->getValue("tracing.enabled", false).toBool();
+    tracerConfig.sampleRate = configManager->getValue("tracing.sample_rate", 0.01).toDouble();
+    tracerConfig.slowThresholdMs = configManager->getValue("tracing.slow_threshold_ms", 200).toInt();
+    tracerConfig.outputDir = configManager->getValue("tracing.output_dir", "logs/traces").toString();
+    tracerConfig.flushIntervalMs = configManager->getValue("tracing.flush_interval_ms", 2000).toInt();
+    tracerConfig.maxSpansPerTrace = configManager->getValue("tracing.max_spans_per_trace", 256).toInt();
+    tracerConfig.maxPendingTraces = configManager->getValue("tracing.max_pending_traces", 4096).toInt();
+    tracerConfig.maxFileBytes = configManager->getValue("tracing.max_file_bytes", 64 * 1024 * 1024).toLongLong();
+
+    return Tracer::instance()->initialize(tracerConfig);
+}
 
-        if (!certManager->generateSelfSignedCertificate("localhost", "QKChat", "CN", 365)) {
-            LOG_ERROR("Failed to generate self-signed certificate");
-        } else {
-        
+bool ServerManager::initializeEventLoopMonitor()
+{
+    ConfigManager* configManager = ConfigManager::instance();
+
+    EventLoopMonitor::MonitorConfig monitorConfig;
+    monitorConfig.enabled = configManager->getValue("monitoring.event_loop.enabled", true).toBool();
+    monitorConfig.probeIntervalMs = configManager->getValue("monitoring.event_loop.probe_interval_ms", 100).toInt();
+    monitorConfig.stallThresholdMs = configManager->getValue("monitoring.event_loop.stall_threshold_ms", 250).toInt();
+    monitorConfig.admissionLagThresholdMs = configManager->getValue("monitoring.event_loop.admission_lag_threshold_ms", 500).toInt();
+    monitorConfig.ewmaAlpha = configManager->getValue("monitoring.event_loop.ewma_alpha", 0.2).toDouble();
+    monitorConfig.maxRecentStalls = configManager->getValue("monitoring.event_loop.max_recent_stalls", 50).toInt();
+
+    EventLoopMonitor* monitor = EventLoopMonitor::instance();
+    if (!monitor->initialize(monitorConfig)) {
+        return false;
+    }
+
+    // 所有ClientHandler都运行在主线程的事件循环中
+    monitor->registerThread(QCoreApplication::instance()->thread(), "main");
+    return true;
+}
+
+bool ServerManager::initializeFlightRecorder()
+{
+    ConfigManager* configManager = ConfigManager::instance();
+
+    FlightRecorder::RecorderConfig recorderConfig;
+    recorderConfig.enabled = configManager->getValue("monitoring.flight_recorder.enabled", true).toBool();
+    recorderConfig.eventsPerThread = configManager->getValue("monitoring.flight_recorder.events_per_thread", 8192).toInt();
+    recorderConfig.dumpDir = configManager->getValue("monitoring.flight_recorder.dump_dir", "logs/flight").toString();
+    recorderConfig.anomalyDumpIntervalSeconds = configManager->getValue("monitoring.flight_recorder.anomaly_dump_interval_seconds", 300).toInt();
+    recorderConfig.dumpOnShutdown = configManager->getValue("monitoring.flight_recorder.dump_on_shutdown", false).toBool();
+
+    if (!FlightRecorder::initialize(recorderConfig)) {
+        return false;
+    }
+    FlightRecorder::installSignalHandlers();
+
+    // 异常检测：事件循环卡顿超过阈值时转储（在监控线程中直接执行）
+    int stallDumpMs = configManager->getValue("monitoring.flight_recorder.stall_dump_threshold_ms", 1000).toInt();
+    connect(EventLoopMonitor::instance(), &EventLoopMonitor::stallDetected, this,
+            [stallDumpMs](const QString &threadName, const QString &action, qint64 lagMs) {
+        FlightRecorder::record(FlightRecorder::LoopStall, FlightRecorder::internString(action), lagMs);
+        if (lagMs >= stallDumpMs) {
+            FlightRecorder::triggerAnomalyDump(QString("event_loop_stall:%1:%2").arg(threadName, action));
         }
+    }, Qt::DirectConnection);
 
-    } catch (const std::exception& e) {
-        LOG_ERROR(QString("Exception during certificate initialization: %1").arg(e.what()));
-    } catch (...) {
-        LOG_ERROR("Unknown exception during certificate initialization");
+    // 异常检测：消息队列积压
+    connect(AsyncMessageQueue::instance(), &AsyncMessageQueue::queueFullWarning, this,
+            [](int currentSize) {
+        static const quint32 queueId = FlightRecorder::internString("async_message_queue");
+        FlightRecorder::record(FlightRecorder::QueueDepth, queueId, currentSize);
+        FlightRecorder::triggerAnomalyDump(QString("queue_depth:%1").arg(currentSize));
+    }, Qt::DirectConnection);
+
+    return true;
+}
+
+bool ServerManager::initializeCertificates()
+{
+    CertificateManager* certManager = CertificateManager::instance();
+
+    if (!certManager->generateSelfSignedCertificate("localhost", "QKChat", "CN", 365)) {
+        LOG_ERROR("Failed to generate self-signed certificate");
+        return false;
     }
+
+    return true;
+}
+
+bool ServerManager::initializeWarmState()
+{
+    ConfigManager* configManager = ConfigManager::instance();
+
+    WarmStateStore::StoreConfig storeConfig;
+    storeConfig.enabled = configManager->getValue("warm_state.enabled", true).toBool();
+    storeConfig.path = configManager->getValue("warm_state.path", "data/warm_state.bin").toString();
+    storeConfig.saveIntervalSeconds = configManager->getValue("warm_state.save_interval_seconds", 300).toInt();
+    storeConfig.maxAgeSeconds = configManager->getValue("warm_state.max_age_seconds", 3600).toInt();
+
+    WarmStateStore* store = WarmStateStore::instance();
+    if (!store->initialize(storeConfig)) {
+        return false;
+    }
+
+    if (!store->isEnabled()) {
+        return true;
+    }
+
+    AuthCache* authCache = AuthCache::instance();
+    store->registerSection("auth_cache", AuthCache::WARM_STATE_VERSION,
+        [authCache](QDataStream &out) { return authCache->saveWarmState(out); },
+        [authCache](QDataStream &in, qint64 savedAtSecs) { return authCache->restoreWarmState(in, savedAtSecs); });
+
+    CacheManager* cacheManager = CacheManager::instance();
+    store->registerSection("cache_manager", CacheManager::WARM_STATE_VERSION,
+        [cacheManager](QDataStream &out) { return cacheManager->saveWarmState(out); },
+        [cacheManager](QDataStream &in, qint64 savedAtSecs) { return cacheManager->restoreWarmState(in, savedAtSecs); });
+
+    OnlineStatusService* statusService = OnlineStatusService::instance();
+    store->registerSection("online_status", OnlineStatusService::WARM_STATE_VERSION,
+        [statusService](QDataStream &out) { return statusService->saveWarmState(out); },
+        [statusService](QDataStream &in, qint64 savedAtSecs) { return statusService->restoreWarmState(in, savedAtSecs); });
+
+    RateLimitManager* rateLimitManager = RateLimitManager::instance();
+    store->registerSection("rate_limit", RateLimitManager::WARM_STATE_VERSION,
+        [rateLimitManager](QDataStream &out) { return rateLimitManager->saveWarmState(out); },
+        [rateLimitManager](QDataStream &in, qint64 savedAtSecs) { return rateLimitManager->restoreWarmState(in, savedAtSecs); });
+
+    store->registerSection("request_dedup", ClientHandler::DEDUP_WARM_STATE_VERSION,
+        [](QDataStream &out) { return ClientHandler::saveDedupWarmState(out); },
+        [](QDataStream &in, qint64 savedAtSecs) { return ClientHandler::restoreDedupWarmState(in, savedAtSecs); });
+
+    store->restore();
+    return true;
+}
+
+bool ServerManager::warmUpCaches()
+{
+    // 创建缓存管理器时从数据库加载热点数据统计
+    CacheManager::instance();
+    return true;
 }
 
 void ServerManager::initializeOptionalComponentsAsync()
@@ -12,6 +12,8 @@
 #include "network/ProtocolHandler.h"
 #include "utils/Logger.h"
 
+class StartupOrchestrator;
+
 /**
  * @brief 服务器管理器类
  * 
@@ -186,6 +188,11 @@ private slots:
     void onDatabaseConnectionChanged(bool connected);
     void onRedisConnectionChanged(bool connected);
     void onMessageQueueError(const QString &error);
+    
+    /**
+     * @brief 配置热加载后应用可在运行时调整的设置
+     */
+    void onConfigReloaded();
 
 private:
     /**
@@ -206,6 +213,12 @@ private:
      */
     bool initializeRedis();
     
+    /**
+     * @brief 读取Redis部署配置（redis部分）
+     * @return 路由配置
+     */
+    RedisRouter::Config loadRedisRouterConfig() const;
+    
     /**
      * @brief 初始化邮件服务
      * @return 初始化是否成功
@@ -218,18 +231,60 @@ private:
      */
     bool initializeThreadPoolServer();
     
+    /**
+     * @brief 注册过期数据的保留任务
+     */
+    void registerRetentionJobs();
+    
     /**
      * @brief 初始化异步消息队列
      * @return 初始化是否成功
      */
     bool initializeMessageQueue();
+    
+    /**
+     * @brief 初始化请求追踪
+     * @return 初始化是否成功
+     */
+    bool initializeTracing();
+    
+    /**
+     * @brief 初始化事件循环延迟监控
+     * @return 初始化是否成功
+     */
+    bool initializeEventLoopMonitor();
+    
+    /**
+     * @brief 初始化飞行记录器及其异常触发条件
+     * @return 初始化是否成功
+     */
+    bool initializeFlightRecorder();
 
-private slots:
     /**
-     * @brief 异步初始化证书
+     * @brief 按依赖关系编排并执行各子系统的初始化
+     * @return 是否通过就绪门控
+     */
+    bool runStartupOrchestration();
+    
+    /**
+     * @brief 初始化TLS证书
+     * @return 初始化是否成功
      */
-    void initializeCertificatesAsync();
+    bool initializeCertificates();
+    
+    /**
+     * @brief 初始化热状态快照并恢复上次保存的状态
+     * @return 初始化是否成功
+     */
+    bool initializeWarmState();
+    
+    /**
+     * @brief 预热缓存
+     * @return 预热是否成功
+     */
+    bool warmUpCaches();
 
+private slots:
     /**
      * @brief 异步初始化可选组件
      */
@@ -248,6 +303,7 @@ private:
     ThreadPoolServer* _threadPoolServer;
     AsyncMessageQueue* _messageQueue;
     ProtocolHandler* _protocolHandler;
+    StartupOrchestrator* _startupOrchestrator;
     
     // 统计信息
     int _clientCount;
@@ -1,5 +1,6 @@
 #include "AuthCache.h"
 #include "../utils/Logger.h"
+#include "../database/DatabaseConnectionPool.h"
 #include <QReadLocker>
 #include <QWriteLocker>
 #include <QMutexLocker>
@@ -276,12 +277,52 @@ AuthCache::UserInfo AuthCache::getCachedUserInfo(qint64 userId)
         return UserInfo();
     }
     
+    // 快照恢复的条目在首次命中时与数据库核对一次
+    if (userInfo.restored) {
+        locker.unlock();
+        
+        bool current = isRestoredUserInfoCurrent(userInfo);
+        
+        QWriteLocker writeLocker(&_userCacheLock);
+        if (!current) {
+            _userInfoCache.remove(userId);
+            _usernameToIdMap.remove(userInfo.username);
+            
+            QMutexLocker statsLocker(&_statsMutex);
+            _totalCacheMisses++;
+            return UserInfo();
+        }
+        
+        auto cachedIt = _userInfoCache.find(userId);
+        if (cachedIt != _userInfoCache.end()) {
+            cachedIt.value().restored = false;
+        }
+        userInfo.restored = false;
+    }
+    
     QMutexLocker statsLocker(&_statsMutex);
     _totalCacheHits++;
     
     return userInfo;
 }
 
+bool AuthCache::isRestoredUserInfoCurrent(const UserInfo& userInfo) const
+{
+    DatabaseConnection dbConn;
+    if (!dbConn.isValid()) {
+        return false;
+    }
+    
+    // users.updated_at随任何字段修改自动更新，晚于缓存时间说明缓存已过时
+    QVariant updatedAt = dbConn.executeScalar(
+        "SELECT UNIX_TIMESTAMP(updated_at) FROM users WHERE id = ?", {userInfo.userId});
+    if (!updatedAt.isValid() || updatedAt.isNull()) {
+        return false;
+    }
+    
+    return updatedAt.toLongLong() <= userInfo.cacheTime.toSecsSinceEpoch();
+}
+
 AuthCache::UserInfo AuthCache::getCachedUserInfoByUsername(const QString& username)
 {
     if (username.isEmpty()) {
@@ -364,6 +405,85 @@ QJsonObject AuthCache::getCacheStatistics() const
     return stats;
 }
 
+int AuthCache::saveWarmState(QDataStream &out) const
+{
+    int count = 0;
+    
+    {
+        QReadLocker locker(&_sessionsLock);
+        out << static_cast<quint32>(_sessions.size());
+        for (auto it = _sessions.constBegin(); it != _sessions.constEnd(); ++it) {
+            const SessionInfo &session = it.value();
+            out << it.key() << session.userId << session.username << session.clientId
+                << session.loginTime << session.lastActivity << session.expiryTime
+                << session.ipAddress << session.isValid;
+        }
+        count += _sessions.size();
+    }
+    
+    {
+        QReadLocker locker(&_userCacheLock);
+        out << static_cast<quint32>(_userInfoCache.size());
+        for (auto it = _userInfoCache.constBegin(); it != _userInfoCache.constEnd(); ++it) {
+            const UserInfo &userInfo = it.value();
+            out << userInfo.userId << userInfo.username << userInfo.email
+                << userInfo.passwordHash << userInfo.isActive << userInfo.cacheTime;
+        }
+        count += _userInfoCache.size();
+    }
+    
+    return count;
+}
+
+int AuthCache::restoreWarmState(QDataStream &in, qint64 savedAtSecs)
+{
+    Q_UNUSED(savedAtSecs)
+    
+    int restored = 0;
+    
+    // 会话和用户信息都记录了绝对过期/缓存时间，停机时长自然计入TTL
+    quint32 sessionCount = 0;
+    in >> sessionCount;
+    {
+        QWriteLocker locker(&_sessionsLock);
+        for (quint32 i = 0; i < sessionCount && in.status() == QDataStream::Ok; ++i) {
+            QString token;
+            SessionInfo session;
+            in >> token >> session.userId >> session.username >> session.clientId
+               >> session.loginTime >> session.lastActivity >> session.expiryTime
+               >> session.ipAddress >> session.isValid;
+            
+            if (in.status() != QDataStream::Ok || session.isExpired() || _sessions.contains(token)) {
+                continue;
+            }
+            _sessions.insert(token, session);
+            restored++;
+        }
+    }
+    
+    quint32 userCount = 0;
+    in >> userCount;
+    {
+        QWriteLocker locker(&_userCacheLock);
+        for (quint32 i = 0; i < userCount && in.status() == QDataStream::Ok; ++i) {
+            UserInfo userInfo;
+            in >> userInfo.userId >> userInfo.username >> userInfo.email
+               >> userInfo.passwordHash >> userInfo.isActive >> userInfo.cacheTime;
+            
+            if (in.status() != QDataStream::Ok || userInfo.isExpired(_userCacheTimeoutMinutes * 60)
+                || _userInfoCache.contains(userInfo.userId)) {
+                continue;
+            }
+            userInfo.restored = true;
+            _userInfoCache.insert(userInfo.userId, userInfo);
+            _usernameToIdMap.insert(userInfo.username, userInfo.userId);
+            restored++;
+        }
+    }
+    
+    return restored;
+}
+
 void AuthCache::cleanup()
 {
     performCleanup();
@@ -8,6 +8,7 @@
 #include <QDateTime>
 #include <QJsonObject>
 #include <QReadWriteLock>
+#include <QDataStream>
 
 /**
  * @brief 身份验证缓存类
@@ -54,8 +55,9 @@ public:
         QString passwordHash;
         bool isActive;
         QDateTime cacheTime;
+        bool restored;      // 从快照恢复、尚未与数据库核对
         
-        UserInfo() : userId(-1), isActive(false) {}
+        UserInfo() : userId(-1), isActive(false), restored(false) {}
         
         bool isExpired(int cacheTimeoutSeconds = 300) const {
             return cacheTime.secsTo(QDateTime::currentDateTime()) > cacheTimeoutSeconds;
@@ -181,6 +183,23 @@ public:
      * @brief 清理过期数据
      */
     void cleanup();
+    
+    // 热状态快照
+    static const quint32 WARM_STATE_VERSION = 1;
+    
+    /**
+     * @brief 写出会话和用户信息快照
+     * @return 写出的条目数
+     */
+    int saveWarmState(QDataStream &out) const;
+    
+    /**
+     * @brief 从快照恢复会话和用户信息，已过期的条目被丢弃
+     * @param in 快照数据流
+     * @param savedAtSecs 快照写入时间
+     * @return 恢复的条目数
+     */
+    int restoreWarmState(QDataStream &in, qint64 savedAtSecs);
 
 signals:
     /**
@@ -211,6 +230,12 @@ private slots:
     void performCleanup();
 
 private:
+    /**
+     * @brief 核对恢复的用户信息在停机期间是否被修改
+     * @return 缓存内容是否仍然有效
+     */
+    bool isRestoredUserInfoCurrent(const UserInfo& userInfo) const;
+
     static AuthCache* s_instance;
     static QMutex s_instanceMutex;
     
@@ -1,5 +1,6 @@
 #include "SessionManager.h"
 #include "../config/ConfigManager.h"
+#include "../database/RedisKeys.h"
 #include <QUuid>
 #include <QJsonDocument>
 #include <QJsonObject>
@@ -114,7 +115,7 @@ bool SessionManager::createSession(qint64 userId, const QString& sessionToken, c
     QString sessionData = serializeSessionData(sessionInfo);
     
     // 存储到Redis
-    QString sessionKey = QString("session:%1").arg(sessionToken);
+    QString sessionKey = RedisKeys::sessionKey(sessionToken);
     int expireSeconds = rememberMe ? _rememberMeTimeout : _defaultTimeout;
     
     RedisClient::Result result = _redisClient->set(sessionKey, sessionData, expireSeconds);
@@ -142,7 +143,7 @@ SessionManager::SessionInfo SessionManager::validateSession(const QString& sessi
         return SessionInfo();
     }
     
-    QString sessionKey = QString("session:%1").arg(sessionToken);
+    QString sessionKey = RedisKeys::sessionKey(sessionToken);
     QString sessionData;
     
     RedisClient::Result result = _redisClient->get(sessionKey, sessionData);
@@ -189,7 +190,7 @@ bool SessionManager::updateSessionActivity(const QString& sessionToken)
         return false;
     }
     
-    QString sessionKey = QString("session:%1").arg(sessionToken);
+    QString sessionKey = RedisKeys::sessionKey(sessionToken);
     QString sessionData;
     
     RedisClient::Result result = _redisClient->get(sessionKey, sessionData);
@@ -230,7 +231,7 @@ bool SessionManager::destroySession(const QString& sessionToken)
         return false;
     }
     
-    QString sessionKey = QString("session:%1").arg(sessionToken);
+    QString sessionKey = RedisKeys::sessionKey(sessionToken);
     
     // 获取会话信息用于日志记录
     QString sessionData;
@@ -280,7 +281,7 @@ int SessionManager::destroyUserSessions(qint64 userId)
 QStringList SessionManager::getUserActiveSessions(qint64 userId)
 {
     QStringList activeSessions;
-    QString pattern = "session:*";
+    QString pattern = RedisKeys::sessionPattern();
     
     // 注意：这里需要Redis的KEYS命令，在生产环境中应该谨慎使用
     // 可以考虑使用SCAN命令或者维护一个用户会话索引
@@ -313,7 +314,7 @@ bool SessionManager::isUserSessionLimitExceeded(qint64 userId)
 int SessionManager::cleanupExpiredSessions()
 {
     int cleanedCount = 0;
-    QString pattern = "session:*";
+    QString pattern = RedisKeys::sessionPattern();
     
     QStringList keys = _redisClient->keys(pattern);
     
@@ -359,11 +360,8 @@ void SessionManager::onCleanupTimer()
 
 QString SessionManager::extractSessionTokenFromKey(const QString& redisKey)
 {
-    // 从 "session:token" 格式中提取 token
-    if (redisKey.startsWith("session:")) {
-        return redisKey.mid(8); // 跳过 "session:" 前缀
-    }
-    return redisKey;
+    // 从 "前缀{s:token}:session" 格式中提取 token
+    return RedisKeys::sessionTokenFromKey(redisKey);
 }
 
 SessionManager::SessionInfo SessionManager::parseSessionData(const QString& sessionData)
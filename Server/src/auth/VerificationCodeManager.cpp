@@ -2,6 +2,7 @@
 #include "../utils/Logger.h"
 #include "../utils/Crypto.h"
 #include "../utils/Validator.h"
+#include "../database/RetentionScheduler.h"
 #include <QSqlQuery>
 #include <QSqlError>
 #include <QDateTime>
@@ -181,6 +182,11 @@ VerificationCodeManager::VerificationResult VerificationCodeManager::verifyCode(
 
 int VerificationCodeManager::cleanupExpiredCodes()
 {
+    // 交给保留任务分块删除，未启用时退回单条DELETE
+    if (RetentionScheduler::instance()->trigger("verification_codes")) {
+        return 0;
+    }
+
     QMutexLocker locker(&_mutex);
     
     QString sql = "DELETE FROM verification_codes WHERE expires_at < NOW()";
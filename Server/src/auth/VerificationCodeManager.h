@@ -90,7 +90,7 @@ public:
 
     /**
      * @brief 清理过期的验证码
-     * @return 清理的数量
+     * @return 清理的数量，交给保留任务异步清理时返回0
      */
     int cleanupExpiredCodes();
 
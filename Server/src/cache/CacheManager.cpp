@@ -1,6 +1,7 @@
 #include "CacheManager.h"
 #include "../utils/Logger.h"
 #include "../database/DatabaseConnectionPool.h"
+#include "../database/RetentionScheduler.h"
 #include <QCryptographicHash>
 #include <QDateTime>
 #include <QSqlQuery>
@@ -206,6 +207,11 @@ bool CacheManager::removeL2Cache(const QString& key)
 
 void CacheManager::cleanupL2Cache()
 {
+    // 交给保留任务分块删除，未启用时退回单条DELETE
+    if (RetentionScheduler::instance()->trigger("search_cache")) {
+        return;
+    }
+
     QString sql = "DELETE FROM search_cache WHERE expires_at < NOW()";
     bool success = executeL2CacheQuery(sql);
     
@@ -440,6 +446,100 @@ QJsonObject CacheManager::getCacheStats()
     return stats;
 }
 
+int CacheManager::saveWarmState(QDataStream& out)
+{
+    int count = 0;
+    qint64 currentTime = QDateTime::currentSecsSinceEpoch();
+    
+    {
+        QMutexLocker locker(&_cacheMutex);
+        
+        QList<QString> liveKeys;
+        for (auto it = _cacheExpiry.constBegin(); it != _cacheExpiry.constEnd(); ++it) {
+            if (it.value() > currentTime && _memoryCache.contains(it.key())) {
+                liveKeys.append(it.key());
+            }
+        }
+        
+        out << static_cast<quint32>(liveKeys.size());
+        for (const QString& key : liveKeys) {
+            out << key << _cacheExpiry.value(key)
+                << QJsonDocument(_memoryCache.value(key)).toJson(QJsonDocument::Compact);
+        }
+        count += liveKeys.size();
+    }
+    
+    {
+        QMutexLocker locker(&_hotDataMutex);
+        out << static_cast<quint32>(_hotDataStats.size());
+        for (auto it = _hotDataStats.constBegin(); it != _hotDataStats.constEnd(); ++it) {
+            out << it.key() << static_cast<qint32>(it.value()) << _hotDataLastAccess.value(it.key());
+        }
+        count += _hotDataStats.size();
+    }
+    
+    return count;
+}
+
+int CacheManager::restoreWarmState(QDataStream& in, qint64 savedAtSecs)
+{
+    Q_UNUSED(savedAtSecs)
+    
+    int restored = 0;
+    qint64 currentTime = QDateTime::currentSecsSinceEpoch();
+    
+    quint32 cacheCount = 0;
+    in >> cacheCount;
+    {
+        QMutexLocker locker(&_cacheMutex);
+        for (quint32 i = 0; i < cacheCount && in.status() == QDataStream::Ok; ++i) {
+            QString key;
+            qint64 expiryTime = 0;
+            QByteArray json;
+            in >> key >> expiryTime >> json;
+            
+            // 停机期间已过期的条目直接丢弃，已有的新数据优先
+            if (in.status() != QDataStream::Ok || expiryTime <= currentTime || _memoryCache.contains(key)) {
+                continue;
+            }
+            
+            QJsonDocument doc = QJsonDocument::fromJson(json);
+            if (!doc.isObject()) {
+                continue;
+            }
+            
+            _memoryCache[key] = doc.object();
+            _cacheExpiry[key] = expiryTime;
+            restored++;
+        }
+    }
+    
+    quint32 hotCount = 0;
+    in >> hotCount;
+    {
+        QMutexLocker locker(&_hotDataMutex);
+        for (quint32 i = 0; i < hotCount && in.status() == QDataStream::Ok; ++i) {
+            QString key;
+            qint32 accessCount = 0;
+            qint64 lastAccess = 0;
+            in >> key >> accessCount >> lastAccess;
+            
+            if (in.status() != QDataStream::Ok) {
+                break;
+            }
+            
+            // 数据库中加载的统计可能更新，取两者中的较大值
+            if (accessCount > _hotDataStats.value(key, 0)) {
+                _hotDataStats[key] = accessCount;
+                _hotDataLastAccess[key] = qMax(lastAccess, _hotDataLastAccess.value(key, 0));
+                restored++;
+            }
+        }
+    }
+    
+    return restored;
+}
+
 void CacheManager::cleanupExpiredCache()
 {
     QMutexLocker locker(&_cacheMutex);
@@ -4,6 +4,7 @@
 #include <QObject>
 #include <QMap>
 #include <QMutex>
+#include <QDataStream>
 #include <QTimer>
 #include <QJsonObject>
 #include <QJsonArray>
@@ -45,6 +46,11 @@ public:
     // 缓存统计
     QJsonObject getCacheStats();
     QJsonObject getL2CacheStats();
+    
+    // 热状态快照（L1缓存保留绝对过期时间，热点统计按访问次数合并）
+    static const quint32 WARM_STATE_VERSION = 1;
+    int saveWarmState(QDataStream& out);
+    int restoreWarmState(QDataStream& in, qint64 savedAtSecs);
 
 private:
     explicit CacheManager(QObject *parent = nullptr);
@@ -0,0 +1,425 @@
+#include "WarmStateStore.h"
+#include "../utils/Logger.h"
+#include <QFile>
+#include <QSaveFile>
+#include <QFileInfo>
+#include <QDir>
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QByteArray>
+#include <array>
+#include <cstring>
+#include <exception>
+
+namespace {
+
+/**
+ * @brief 快照文件头（32字节）
+ */
+struct FileHeader {
+    char magic[8];
+    quint32 formatVersion;
+    quint32 sectionCount;
+    qint64 savedAtMs;
+    quint64 reserved;
+};
+
+/**
+ * @brief 分区表项（56字节）
+ */
+struct SectionEntry {
+    char name[24];
+    quint32 version;
+    quint32 entryCount;
+    quint64 offset;
+    quint64 length;
+    quint32 checksum;
+    quint32 reserved;
+};
+
+static_assert(sizeof(FileHeader) == 32, "FileHeader layout changed");
+static_assert(sizeof(SectionEntry) == 56, "SectionEntry layout changed");
+
+const char SNAPSHOT_MAGIC[8] = { 'Q', 'K', 'W', 'A', 'R', 'M', '0', '1' };
+
+void configureStream(QDataStream &stream)
+{
+    stream.setVersion(QDataStream::Qt_5_12);
+    stream.setByteOrder(QDataStream::LittleEndian);
+}
+
+qint64 alignTo8(qint64 value)
+{
+    return (value + 7) & ~qint64(7);
+}
+
+std::array<quint32, 256> makeCrc32Table()
+{
+    std::array<quint32, 256> table;
+    for (quint32 i = 0; i < 256; ++i) {
+        quint32 value = i;
+        for (int bit = 0; bit < 8; ++bit) {
+            value = (value & 1) ? (0xEDB88320u ^ (value >> 1)) : (value >> 1);
+        }
+        table[i] = value;
+    }
+    return table;
+}
+
+} // namespace
+
+// 静态成员初始化
+WarmStateStore* WarmStateStore::s_instance = nullptr;
+QMutex WarmStateStore::s_instanceMutex;
+
+WarmStateStore* WarmStateStore::instance()
+{
+    if (!s_instance) {
+        QMutexLocker locker(&s_instanceMutex);
+        if (!s_instance) {
+            s_instance = new WarmStateStore();
+        }
+    }
+    return s_instance;
+}
+
+WarmStateStore::WarmStateStore(QObject *parent)
+    : QObject(parent)
+    , _initialized(false)
+    , _saveTimer(new QTimer(this))
+    , _lastSaveMs(0)
+    , _lastSaveBytes(0)
+    , _lastSaveEntries(0)
+    , _lastSaveDurationMs(0)
+    , _saveCount(0)
+    , _saveFailures(0)
+    , _restoredEntries(0)
+    , _restoredAgeSeconds(-1)
+{
+    connect(_saveTimer, &QTimer::timeout, this, &WarmStateStore::onSaveTimer);
+}
+
+WarmStateStore::~WarmStateStore()
+{
+    _saveTimer->stop();
+}
+
+bool WarmStateStore::initialize(const StoreConfig &config)
+{
+    {
+        QMutexLocker locker(&_mutex);
+        _config = config;
+    }
+
+    if (!_config.enabled) {
+        return true;
+    }
+
+    _initialized = true;
+
+    QFileInfo fileInfo(_config.path);
+    if (!QDir().mkpath(fileInfo.absolutePath())) {
+        LOG_ERROR(QString("Failed to create warm state directory: %1").arg(fileInfo.absolutePath()));
+        return false;
+    }
+
+    if (_config.saveIntervalSeconds > 0) {
+        _saveTimer->start(_config.saveIntervalSeconds * 1000);
+    }
+
+    return true;
+}
+
+void WarmStateStore::shutdown()
+{
+    _saveTimer->stop();
+}
+
+void WarmStateStore::registerSection(const QString &name, quint32 version,
+                                     const SaveFunction &saveFunction,
+                                     const RestoreFunction &restoreFunction)
+{
+    QMutexLocker locker(&_mutex);
+
+    if (name.toUtf8().size() >= SECTION_NAME_SIZE) {
+        LOG_ERROR(QString("Warm state section name too long: %1").arg(name));
+        return;
+    }
+
+    for (const Section &section : _sections) {
+        if (section.name == name) {
+            LOG_WARNING(QString("Warm state section already registered: %1").arg(name));
+            return;
+        }
+    }
+
+    Section section;
+    section.name = name;
+    section.version = version;
+    section.saveFunction = saveFunction;
+    section.restoreFunction = restoreFunction;
+    _sections.append(section);
+}
+
+bool WarmStateStore::save()
+{
+    if (!isEnabled()) {
+        return false;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+
+    QList<Section> sections;
+    {
+        QMutexLocker locker(&_mutex);
+        sections = _sections;
+    }
+
+    // 逐个分区序列化，分区内部由各子系统自行加锁
+    QList<QByteArray> payloads;
+    QList<int> entryCounts;
+    qint64 totalEntries = 0;
+    for (const Section &section : sections) {
+        QByteArray payload;
+        int count = 0;
+        try {
+            QDataStream out(&payload, QIODevice::WriteOnly);
+            configureStream(out);
+            count = section.saveFunction(out);
+        } catch (const std::exception& e) {
+            LOG_ERROR(QString("Exception saving warm state section %1: %2").arg(section.name, e.what()));
+            payload.clear();
+            count = 0;
+        }
+        payloads.append(payload);
+        entryCounts.append(count);
+        totalEntries += count;
+    }
+
+    // 组装文件：文件头 + 分区表 + 8字节对齐的分区数据
+    qint64 offset = alignTo8(sizeof(FileHeader) + sections.size() * sizeof(SectionEntry));
+    QByteArray table(sections.size() * sizeof(SectionEntry), '\0');
+    for (int i = 0; i < sections.size(); ++i) {
+        SectionEntry entry;
+        std::memset(&entry, 0, sizeof(entry));
+        QByteArray name = sections[i].name.toUtf8();
+        std::memcpy(entry.name, name.constData(), name.size());
+        entry.version = sections[i].version;
+        entry.entryCount = static_cast<quint32>(entryCounts[i]);
+        entry.offset = static_cast<quint64>(offset);
+        entry.length = static_cast<quint64>(payloads[i].size());
+        entry.checksum = crc32(payloads[i].constData(), payloads[i].size());
+        std::memcpy(table.data() + i * sizeof(SectionEntry), &entry, sizeof(entry));
+        offset = alignTo8(offset + payloads[i].size());
+    }
+
+    FileHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic));
+    header.formatVersion = FORMAT_VERSION;
+    header.sectionCount = static_cast<quint32>(sections.size());
+    header.savedAtMs = QDateTime::currentMSecsSinceEpoch();
+
+    QByteArray file;
+    file.reserve(static_cast<int>(offset));
+    file.append(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.append(table);
+    for (const QByteArray &payload : payloads) {
+        file.append(QByteArray(static_cast<int>(alignTo8(file.size()) - file.size()), '\0'));
+        file.append(payload);
+    }
+
+    // 写入临时文件后原子替换，避免崩溃时留下半截快照
+    QSaveFile saveFile(_config.path);
+    bool success = saveFile.open(QIODevice::WriteOnly)
+                   && saveFile.write(file) == file.size()
+                   && saveFile.commit();
+
+    QMutexLocker locker(&_mutex);
+    if (!success) {
+        _saveFailures++;
+        LOG_ERROR(QString("Failed to write warm state snapshot: %1").arg(saveFile.errorString()));
+        return false;
+    }
+
+    // 快照中包含会话令牌和密码哈希，仅允许属主读写
+    QFile::setPermissions(_config.path, QFileDevice::ReadOwner | QFileDevice::WriteOwner);
+
+    _saveCount++;
+    _lastSaveMs = header.savedAtMs;
+    _lastSaveBytes = file.size();
+    _lastSaveEntries = totalEntries;
+    _lastSaveDurationMs = timer.elapsed();
+
+    LOG_DEBUG(QString("Warm state snapshot saved: %1 entries, %2 bytes in %3 ms")
+              .arg(totalEntries).arg(file.size()).arg(_lastSaveDurationMs));
+    return true;
+}
+
+int WarmStateStore::restore()
+{
+    if (!isEnabled()) {
+        return 0;
+    }
+
+    QFile file(_config.path);
+    if (!file.exists()) {
+        return 0;
+    }
+
+    if (!file.open(QIODevice::ReadOnly)) {
+        LOG_WARNING(QString("Cannot open warm state snapshot: %1").arg(file.errorString()));
+        return 0;
+    }
+
+    qint64 fileSize = file.size();
+    if (fileSize < static_cast<qint64>(sizeof(FileHeader))) {
+        LOG_WARNING("Warm state snapshot is truncated, ignoring");
+        return 0;
+    }
+
+    // 优先内存映射，映射失败时退回一次性读取
+    QByteArray buffer;
+    const char *data = reinterpret_cast<const char*>(file.map(0, fileSize));
+    if (!data) {
+        buffer = file.readAll();
+        data = buffer.constData();
+        fileSize = buffer.size();
+    }
+
+    FileHeader header;
+    std::memcpy(&header, data, sizeof(header));
+
+    if (std::memcmp(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic)) != 0
+        || header.formatVersion != FORMAT_VERSION) {
+        LOG_WARNING("Warm state snapshot has unknown format, ignoring");
+        return 0;
+    }
+
+    qint64 tableEnd = sizeof(FileHeader) + static_cast<qint64>(header.sectionCount) * sizeof(SectionEntry);
+    if (tableEnd > fileSize) {
+        LOG_WARNING("Warm state snapshot section table is truncated, ignoring");
+        return 0;
+    }
+
+    qint64 savedAtSecs = header.savedAtMs / 1000;
+    qint64 ageSeconds = QDateTime::currentSecsSinceEpoch() - savedAtSecs;
+    if (_config.maxAgeSeconds > 0 && ageSeconds > _config.maxAgeSeconds) {
+        LOG_INFO(QString("Warm state snapshot is %1 s old, ignoring").arg(ageSeconds));
+        return 0;
+    }
+
+    QList<Section> sections;
+    {
+        QMutexLocker locker(&_mutex);
+        sections = _sections;
+    }
+
+    int totalRestored = 0;
+    QJsonObject sectionStats;
+
+    for (const Section &section : sections) {
+        bool found = false;
+        SectionEntry entry;
+        for (quint32 i = 0; i < header.sectionCount; ++i) {
+            std::memcpy(&entry, data + sizeof(FileHeader) + i * sizeof(SectionEntry), sizeof(entry));
+            entry.name[SECTION_NAME_SIZE - 1] = '\0';
+            if (section.name == QString::fromUtf8(entry.name)) {
+                found = true;
+                break;
+            }
+        }
+
+        if (!found) {
+            continue;
+        }
+
+        if (entry.version != section.version) {
+            LOG_INFO(QString("Warm state section %1 has version %2 (expected %3), skipping")
+                     .arg(section.name).arg(entry.version).arg(section.version));
+            sectionStats[section.name] = "version_mismatch";
+            continue;
+        }
+
+        if (entry.offset > static_cast<quint64>(fileSize)
+            || entry.length > static_cast<quint64>(fileSize) - entry.offset) {
+            LOG_WARNING(QString("Warm state section %1 is out of bounds, skipping").arg(section.name));
+            sectionStats[section.name] = "truncated";
+            continue;
+        }
+
+        const char *payload = data + entry.offset;
+        if (crc32(payload, static_cast<qint64>(entry.length)) != entry.checksum) {
+            LOG_WARNING(QString("Warm state section %1 checksum mismatch, skipping").arg(section.name));
+            sectionStats[section.name] = "corrupted";
+            continue;
+        }
+
+        // 分区数据直接引用映射内存，不做拷贝
+        QByteArray raw = QByteArray::fromRawData(payload, static_cast<int>(entry.length));
+        QDataStream in(raw);
+        configureStream(in);
+
+        int restored = 0;
+        try {
+            restored = section.restoreFunction(in, savedAtSecs);
+        } catch (const std::exception& e) {
+            LOG_ERROR(QString("Exception restoring warm state section %1: %2").arg(section.name, e.what()));
+        }
+
+        if (in.status() != QDataStream::Ok) {
+            LOG_WARNING(QString("Warm state section %1 ended with stream error").arg(section.name));
+        }
+
+        sectionStats[section.name] = restored;
+        totalRestored += restored;
+    }
+
+    LOG_INFO(QString("Warm state restored: %1 entries from snapshot %2 s old")
+             .arg(totalRestored).arg(ageSeconds));
+
+    QMutexLocker locker(&_mutex);
+    _restoredEntries = totalRestored;
+    _restoredAgeSeconds = ageSeconds;
+    _restoredSections = sectionStats;
+    return totalRestored;
+}
+
+QJsonObject WarmStateStore::getStatistics() const
+{
+    QMutexLocker locker(&_mutex);
+
+    QJsonObject stats;
+    stats["enabled"] = _config.enabled;
+    stats["path"] = _config.path;
+    stats["save_interval_seconds"] = _config.saveIntervalSeconds;
+    stats["save_count"] = _saveCount;
+    stats["save_failures"] = _saveFailures;
+    stats["last_save_bytes"] = _lastSaveBytes;
+    stats["last_save_entries"] = _lastSaveEntries;
+    stats["last_save_duration_ms"] = _lastSaveDurationMs;
+    if (_lastSaveMs > 0) {
+        stats["last_save_time"] = QDateTime::fromMSecsSinceEpoch(_lastSaveMs).toString(Qt::ISODate);
+    }
+    stats["restored_entries"] = _restoredEntries;
+    stats["restored_snapshot_age_seconds"] = _restoredAgeSeconds;
+    stats["restored_sections"] = _restoredSections;
+    return stats;
+}
+
+void WarmStateStore::onSaveTimer()
+{
+    save();
+}
+
+quint32 WarmStateStore::crc32(const char *data, qint64 length)
+{
+    static const std::array<quint32, 256> table = makeCrc32Table();
+
+    quint32 crc = 0xFFFFFFFFu;
+    for (qint64 i = 0; i < length; ++i) {
+        crc = table[(crc ^ static_cast<quint8>(data[i])) & 0xFF] ^ (crc >> 8);
+    }
+    return crc ^ 0xFFFFFFFFu;
+}
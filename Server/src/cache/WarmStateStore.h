@@ -0,0 +1,141 @@
+#ifndef WARMSTATESTORE_H
+#define WARMSTATESTORE_H
+
+#include <QObject>
+#include <QTimer>
+#include <QMutex>
+#include <QList>
+#include <QString>
+#include <QDataStream>
+#include <QJsonObject>
+#include <functional>
+
+/**
+ * @brief 热状态快照存储
+ *
+ * 在正常关闭时及周期性地把各子系统的内存状态（认证缓存、L1缓存、在线状态缓存、
+ * 限流桶、请求去重集合）写入本地快照文件，重启后在开始接受连接前恢复，
+ * 避免重启后的冷缓存击穿数据库和Redis。
+ *
+ * 文件格式（本机字节序，可直接内存映射）：
+ * - 32字节文件头：魔数"QKWARM01"、格式版本、分区数、写入时间
+ * - 分区表：每项56字节，含分区名、分区版本、条目数、偏移、长度、CRC32
+ * - 分区数据：8字节对齐，内容由各子系统以QDataStream编码
+ *
+ * 恢复时只解码已注册且版本一致的分区，分区版本不一致时整体丢弃。
+ * 各子系统按写入时间自行调整TTL，并可对恢复的条目做延迟校验。
+ */
+class WarmStateStore : public QObject
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @brief 快照配置
+     */
+    struct StoreConfig {
+        bool enabled = true;
+        QString path = "data/warm_state.bin";  // 快照文件路径
+        int saveIntervalSeconds = 300;         // 周期保存间隔，<=0表示仅在关闭时保存
+        int maxAgeSeconds = 3600;              // 超过该时长的快照不再恢复
+    };
+
+    /**
+     * @brief 分区保存函数，返回写入的条目数
+     */
+    using SaveFunction = std::function<int(QDataStream &out)>;
+
+    /**
+     * @brief 分区恢复函数，返回恢复的条目数
+     * @param in 分区数据流
+     * @param savedAtSecs 快照写入时间（Unix秒），用于TTL调整
+     */
+    using RestoreFunction = std::function<int(QDataStream &in, qint64 savedAtSecs)>;
+
+    static WarmStateStore* instance();
+
+    /**
+     * @brief 初始化并启动周期保存
+     */
+    bool initialize(const StoreConfig &config);
+
+    /**
+     * @brief 停止周期保存
+     */
+    void shutdown();
+
+    bool isEnabled() const { return _initialized && _config.enabled; }
+
+    /**
+     * @brief 注册快照分区
+     * @param name 分区名（不超过23字节）
+     * @param version 分区格式版本，子系统数据结构变化时递增
+     * @param saveFunction 保存函数
+     * @param restoreFunction 恢复函数
+     */
+    void registerSection(const QString &name, quint32 version,
+                         const SaveFunction &saveFunction,
+                         const RestoreFunction &restoreFunction);
+
+    /**
+     * @brief 写出快照（原子替换）
+     * @return 写入是否成功
+     */
+    bool save();
+
+    /**
+     * @brief 从快照恢复所有已注册分区
+     * @return 恢复的条目总数，无快照或快照无效时返回0
+     */
+    int restore();
+
+    /**
+     * @brief 获取快照统计信息
+     */
+    QJsonObject getStatistics() const;
+
+private slots:
+    void onSaveTimer();
+
+private:
+    /**
+     * @brief 已注册分区
+     */
+    struct Section {
+        QString name;
+        quint32 version;
+        SaveFunction saveFunction;
+        RestoreFunction restoreFunction;
+    };
+
+    explicit WarmStateStore(QObject *parent = nullptr);
+    ~WarmStateStore();
+
+    static quint32 crc32(const char *data, qint64 length);
+
+    static WarmStateStore* s_instance;
+    static QMutex s_instanceMutex;
+
+    static const int SECTION_NAME_SIZE = 24;
+    static const quint32 FORMAT_VERSION = 1;
+
+    StoreConfig _config;
+    bool _initialized;
+    QTimer *_saveTimer;
+
+    mutable QMutex _mutex;
+    QList<Section> _sections;
+
+    // 统计信息
+    qint64 _lastSaveMs;
+    qint64 _lastSaveBytes;
+    qint64 _lastSaveEntries;
+    qint64 _lastSaveDurationMs;
+    qint64 _saveCount;
+    qint64 _saveFailures;
+    qint64 _restoredEntries;
+    qint64 _restoredAgeSeconds;
+    QJsonObject _restoredSections;
+};
+
+#endif // WARMSTATESTORE_H
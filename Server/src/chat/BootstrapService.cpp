@@ -0,0 +1,172 @@
+#include "BootstrapService.h"
+#include "FriendService.h"
+#include "MessageService.h"
+#include "OnlineStatusService.h"
+#include "GroupService.h"
+#include "../database/DatabaseConnectionPool.h"
+#include "../network/RequestExecutor.h"
+#include "../utils/Logger.h"
+#include <QJsonDocument>
+#include <QCryptographicHash>
+#include <QElapsedTimer>
+#include <QVector>
+
+// 静态成员初始化
+BootstrapService* BootstrapService::s_instance = nullptr;
+QMutex BootstrapService::s_instanceMutex;
+
+namespace {
+
+// 版本号取摘要十六进制的前16位
+const int VERSION_LENGTH = 16;
+
+// 调用线程等待配额名额的时间，与DatabaseConnection的默认获取超时一致
+const int QUOTA_TIMEOUT_MS = 5000;
+
+} // namespace
+
+BootstrapService::BootstrapService(QObject *parent)
+    : QObject(parent)
+    , _requests(0)
+    , _sectionsSent(0)
+    , _sectionsUnchanged(0)
+    , _totalTimeMs(0)
+    , _maxTimeMs(0)
+{
+}
+
+BootstrapService* BootstrapService::instance()
+{
+    if (!s_instance) {
+        QMutexLocker locker(&s_instanceMutex);
+        if (!s_instance) {
+            s_instance = new BootstrapService();
+        }
+    }
+    return s_instance;
+}
+
+void BootstrapService::configure(const Config &config)
+{
+    QMutexLocker locker(&_mutex);
+    _config = config;
+}
+
+bool BootstrapService::isEnabled() const
+{
+    QMutexLocker locker(&_mutex);
+    return _config.enabled;
+}
+
+QStringList BootstrapService::sectionNames()
+{
+    // 离线消息读取时会标记为已投递，响应丢失（超时、截止后丢弃）就会丢消息，
+    // 因此不放在引导中，由客户端单独发送message_offline
+    return { "friends", "friend_groups", "friend_requests", "sessions",
+             "friends_status", "groups" };
+}
+
+QJsonArray BootstrapService::loadSection(const QString &section, qint64 userId)
+{
+    if (section == "friends") {
+        return FriendService::instance()->getFriendList(userId);
+    } else if (section == "friend_groups") {
+        return FriendService::instance()->getFriendGroups(userId);
+    } else if (section == "friend_requests") {
+        return FriendService::instance()->getPendingFriendRequests(userId);
+    } else if (section == "sessions") {
+        return MessageService::instance()->getChatSessions(userId);
+    } else if (section == "friends_status") {
+        return OnlineStatusService::instance()->getFriendsOnlineStatus(userId);
+    } else if (section == "groups") {
+        return GroupService::instance()->getUserGroups(userId);
+    }
+    return QJsonArray();
+}
+
+QString BootstrapService::sectionVersion(const QJsonArray &items)
+{
+    QByteArray digest = QCryptographicHash::hash(QJsonDocument(items).toJson(QJsonDocument::Compact),
+                                                 QCryptographicHash::Sha1);
+    return QString::fromLatin1(digest.toHex().left(VERSION_LENGTH));
+}
+
+bool BootstrapService::assemble(qint64 userId, const QStringList &sections, const QJsonObject &versions,
+                                QJsonObject *data)
+{
+    QElapsedTimer timer;
+    timer.start();
+    _requests.fetchAndAddOrdered(1);
+
+    // 按固定顺序取请求的分段，去掉重复和未知名称
+    QStringList selected;
+    for (const QString &name : sectionNames()) {
+        if (sections.isEmpty() || sections.contains(name)) {
+            selected.append(name);
+        }
+    }
+
+    QVector<QJsonArray> results(selected.size());
+    if (!selected.isEmpty()) {
+        DatabaseConnectionPool *pool = DatabaseConnectionPool::instance();
+        const QString quotaGroup = RequestExecutor::stageName(RequestExecutor::ReadHeavyStage);
+        DatabaseConnectionPool::QuotaScope quotaScope(quotaGroup);
+
+        // 当前线程在整个请求期间持有一个名额，各分段的连接嵌套获取不再占用名额，
+        // 不会在查到一半时因配额不足拿到无效连接而返回不完整的分段
+        if (!pool->acquireQuota(quotaGroup, QUOTA_TIMEOUT_MS)) {
+            LOG_WARNING(QString("Bootstrap for user %1: %2 quota exhausted").arg(userId).arg(quotaGroup));
+            return false;
+        }
+
+        // 各服务的查询方法持有服务级的锁，分段在当前线程依次查询
+        for (int i = 0; i < selected.size(); ++i) {
+            results[i] = loadSection(selected.at(i), userId);
+        }
+
+        pool->releaseQuota(quotaGroup);
+    }
+
+    QJsonObject result;
+    for (int i = 0; i < selected.size(); ++i) {
+        const QString &name = selected.at(i);
+        QJsonObject section;
+        QString version = sectionVersion(results.at(i));
+        section["version"] = version;
+        if (versions.value(name).toString() == version) {
+            section["unchanged"] = true;
+            _sectionsUnchanged.fetchAndAddOrdered(1);
+        } else {
+            section["items"] = results.at(i);
+            _sectionsSent.fetchAndAddOrdered(1);
+        }
+        result[name] = section;
+    }
+
+    qint64 elapsedMs = timer.elapsed();
+    _totalTimeMs.fetchAndAddOrdered(elapsedMs);
+    qint64 maxTime = _maxTimeMs.loadAcquire();
+    while (elapsedMs > maxTime && !_maxTimeMs.testAndSetOrdered(maxTime, elapsedMs)) {
+        maxTime = _maxTimeMs.loadAcquire();
+    }
+
+    LOG_DEBUG(QString("Bootstrap for user %1: %2 sections in %3 ms")
+              .arg(userId).arg(selected.size()).arg(elapsedMs));
+    *data = result;
+    return true;
+}
+
+QJsonObject BootstrapService::getStatistics() const
+{
+    QJsonObject stats;
+    qint64 requests = _requests.loadAcquire();
+    stats["requests"] = requests;
+    stats["sections_sent"] = _sectionsSent.loadAcquire();
+    stats["sections_unchanged"] = _sectionsUnchanged.loadAcquire();
+    stats["avg_time_ms"] = requests > 0 ? static_cast<double>(_totalTimeMs.loadAcquire()) / requests : 0.0;
+    stats["max_time_ms"] = _maxTimeMs.loadAcquire();
+
+    QMutexLocker locker(&_mutex);
+    stats["enabled"] = _config.enabled;
+    return stats;
+}
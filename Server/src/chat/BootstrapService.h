@@ -0,0 +1,87 @@
+#ifndef BOOTSTRAPSERVICE_H
+#define BOOTSTRAPSERVICE_H
+
+#include <QObject>
+#include <QMutex>
+#include <QAtomicInteger>
+#include <QJsonObject>
+#include <QJsonArray>
+#include <QStringList>
+
+/**
+ * @brief 登录引导服务
+ *
+ * 把登录后客户端需要的好友列表、好友分组、好友申请、会话列表、好友在线状态和群组
+ * 合并为一次bootstrap请求，各分段都是只读查询。各分段在执行请求的工作线程上依次查询，
+ * 整个请求只占用一个read_heavy配额名额。
+ *
+ * 每个分段返回内容摘要作为版本号，客户端下次请求时带上已缓存的版本，版本未变的分段只返回
+ * unchanged标记而不重复传输数据。离线消息读取时会标记为已投递，不在引导中返回，
+ * 客户端在引导完成后单独发送message_offline。
+ */
+class BootstrapService : public QObject
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @brief 登录引导配置
+     */
+    struct Config {
+        bool enabled = true;
+    };
+
+    static BootstrapService* instance();
+
+    void configure(const Config &config);
+
+    bool isEnabled() const;
+
+    /**
+     * @brief 支持的分段名称，按返回顺序排列
+     */
+    static QStringList sectionNames();
+
+    /**
+     * @brief 查询并合并引导数据
+     * @param userId 用户ID
+     * @param sections 请求的分段，为空时返回全部分段，未知名称被忽略
+     * @param versions 客户端已缓存的分段版本（分段名 -> 版本）
+     * @param data 输出：分段名 -> {version, items} 或 {version, unchanged}
+     * @return 等待read_heavy配额超时时返回false
+     */
+    bool assemble(qint64 userId, const QStringList &sections, const QJsonObject &versions, QJsonObject *data);
+
+    /**
+     * @brief 获取登录引导统计信息
+     */
+    QJsonObject getStatistics() const;
+
+private:
+    explicit BootstrapService(QObject *parent = nullptr);
+
+    /**
+     * @brief 查询单个分段
+     */
+    static QJsonArray loadSection(const QString &section, qint64 userId);
+
+    /**
+     * @brief 分段内容摘要
+     */
+    static QString sectionVersion(const QJsonArray &items);
+
+    static BootstrapService* s_instance;
+    static QMutex s_instanceMutex;
+
+    mutable QMutex _mutex;
+    Config _config;
+
+    // 统计信息
+    QAtomicInteger<qint64> _requests;
+    QAtomicInteger<qint64> _sectionsSent;
+    QAtomicInteger<qint64> _sectionsUnchanged;
+    QAtomicInteger<qint64> _totalTimeMs;
+    QAtomicInteger<qint64> _maxTimeMs;
+};
+
+#endif // BOOTSTRAPSERVICE_H
@@ -2,6 +2,12 @@
 #include "FriendService.h"
 #include "OnlineStatusService.h"
 #include "MessageService.h"
+#include "EphemeralChannel.h"
+#include "GroupService.h"
+#include "BootstrapService.h"
+#include "ProtocolMessages.h"
+#include <QJsonArray>
+#include "../monitoring/Tracer.h"
 #include <QJsonDocument>
 #include <QUuid>
 
@@ -15,6 +21,7 @@ ChatProtocolHandler::ChatProtocolHandler(QObject *parent)
     , _friendService(nullptr)
     , _statusService(nullptr)
     , _messageService(nullptr)
+    , _groupService(nullptr)
 {
 }
 
@@ -48,8 +55,9 @@ bool ChatProtocolHandler::initialize()
     _friendService = FriendService::instance();
     _statusService = OnlineStatusService::instance();
     _messageService = MessageService::instance();
+    _groupService = GroupService::instance();
     
-    if (!_friendService || !_statusService || !_messageService) {
+    if (!_friendService || !_statusService || !_messageService || !_groupService) {
         LOG_ERROR("Failed to initialize ChatProtocolHandler: service instances not available");
         return false;
     }
@@ -58,8 +66,9 @@ bool ChatProtocolHandler::initialize()
     bool friendInit = _friendService->initialize();
     bool statusInit = _statusService->initialize();
     bool messageInit = _messageService->initialize();
+    bool groupInit = _groupService->initialize();
     
-    if (!friendInit || !statusInit || !messageInit) {
+    if (!friendInit || !statusInit || !messageInit || !groupInit) {
         LOG_ERROR("Failed to initialize ChatProtocolHandler: service initialization failed");
         return false;
     }
@@ -71,6 +80,8 @@ bool ChatProtocolHandler::initialize()
 
 QJsonObject ChatProtocolHandler::handleChatRequest(const QJsonObject& request, const QString& clientIP, qint64 userId)
 {
+    TRACE_SPAN("ChatProtocolHandler::handleChatRequest");
+    
     // Processing chat request
     
     QString action = request["action"].toString();
@@ -95,9 +106,16 @@ QJsonObject ChatProtocolHandler::handleChatRequest(const QJsonObject& request, c
     } else if (action.startsWith("status_") || action == "heartbeat") {
         // 路由到状态操作
         result = handleStatusResponse(request, userId);
-    } else if (action.startsWith("message_") || action == "send_message" || action == "get_chat_history") {
+    } else if (action.startsWith("message_") || action == "send_message" || action == "send_ephemeral" ||
+               action == "get_chat_history") {
         // 路由到消息操作
         result = handleMessageResponse(request, userId);
+    } else if (action.startsWith("group_")) {
+        // 路由到群聊操作
+        result = handleGroupOperations(request, userId);
+    } else if (action == "bootstrap") {
+        // 路由到登录引导
+        result = handleBootstrap(request, userId);
     } else {
         LOG_ERROR(QString("Unknown action: %1").arg(action));
         result = createErrorResponse(requestId, action, "INVALID_ACTION", "Unknown action: " + action);
@@ -183,18 +201,14 @@ QJsonObject ChatProtocolHandler::handleFriendRequest(const QJsonObject& request,
     QString requestId = request["request_id"].toString();
     QString action = request["action"].toString();
     
-    // 验证必需参数
+    // 解码并验证参数
+    Protocol::FriendRequestRequest params;
     QString errorMessage;
-    if (!validateRequest(request, {"user_identifier"}, errorMessage)) {
+    if (!Protocol::FriendRequestRequest::fromJson(request, &params, &errorMessage)) {
         return createErrorResponse(requestId, action, "INVALID_PARAMS", errorMessage);
     }
-    
-    QString userIdentifier = request["user_identifier"].toString();
-    QString message = request["message"].toString();
-    QString remark = request["remark"].toString();
-    QString groupName = request["group"].toString();
 
-    FriendService::FriendRequestResult result = _friendService->sendFriendRequest(userId, userIdentifier, message, remark, groupName);
+    FriendService::FriendRequestResult result = _friendService->sendFriendRequest(userId, params.userIdentifier, params.message, params.remark, params.group);
     
     switch (result) {
         case FriendService::Success:
@@ -222,17 +236,16 @@ QJsonObject ChatProtocolHandler::handleFriendResponse(const QJsonObject& request
 
     
     // 从friend_request_id字段读取数据库的friend request ID
-    QJsonValue friendRequestIdValue = requestData["friend_request_id"];
-
-    
-    qint64 friendRequestId = friendRequestIdValue.toVariant().toLongLong();
-
-    
-    bool accept = requestData["accept"].toBool();
+    Protocol::FriendResponseRequest params;
+    QString errorMessage;
+    if (!Protocol::FriendResponseRequest::fromJson(requestData, &params, &errorMessage)) {
+        return createErrorResponse(requestId, action, "INVALID_PARAMS", errorMessage);
+    }
 
-    
-    QString note = requestData["note"].toString();
-    QString groupName = requestData["group_name"].toString();
+    qint64 friendRequestId = params.friendRequestId;
+    bool accept = params.accept;
+    QString note = params.note;
+    QString groupName = params.groupName;
 
     
     // 调用FriendService处理好友请求响应
@@ -303,12 +316,13 @@ QJsonObject ChatProtocolHandler::handleRemoveFriend(const QJsonObject& request,
     QString action = request["action"].toString();
     
     // 验证必需参数
+    Protocol::RemoveFriendRequest params;
     QString errorMessage;
-    if (!validateRequest(request, {"friend_id"}, errorMessage)) {
+    if (!Protocol::RemoveFriendRequest::fromJson(request, &params, &errorMessage)) {
         return createErrorResponse(requestId, action, "INVALID_PARAMS", errorMessage);
     }
     
-    qint64 friendId = request["friend_id"].toVariant().toLongLong();
+    qint64 friendId = params.friendId;
     
     bool success = _friendService->removeFriend(userId, friendId);
     
@@ -328,12 +342,13 @@ QJsonObject ChatProtocolHandler::handleBlockUser(const QJsonObject& request, qin
     QString action = request["action"].toString();
     
     // 验证必需参数
+    Protocol::BlockUserRequest params;
     QString errorMessage;
-    if (!validateRequest(request, {"target_user_id"}, errorMessage)) {
+    if (!Protocol::BlockUserRequest::fromJson(request, &params, &errorMessage)) {
         return createErrorResponse(requestId, action, "INVALID_PARAMS", errorMessage);
     }
     
-    qint64 targetUserId = request["target_user_id"].toVariant().toLongLong();
+    qint64 targetUserId = params.targetUserId;
     
     bool success = _friendService->blockUser(userId, targetUserId);
     
@@ -353,12 +368,13 @@ QJsonObject ChatProtocolHandler::handleUnblockUser(const QJsonObject& request, q
     QString action = request["action"].toString();
 
     // 验证必需参数
+    Protocol::UnblockUserRequest params;
     QString errorMessage;
-    if (!validateRequest(request, {"target_user_id"}, errorMessage)) {
+    if (!Protocol::UnblockUserRequest::fromJson(request, &params, &errorMessage)) {
         return createErrorResponse(requestId, action, "INVALID_PARAMS", errorMessage);
     }
 
-    qint64 targetUserId = request["target_user_id"].toVariant().toLongLong();
+    qint64 targetUserId = params.targetUserId;
 
     bool success = _friendService->unblockUser(userId, targetUserId);
 
@@ -380,14 +396,15 @@ QJsonObject ChatProtocolHandler::handleSearchUsers(const QJsonObject& request, q
     // 处理搜索用户请求
 
     // 验证必需参数
+    Protocol::SearchUsersRequest params;
     QString errorMessage;
-    if (!validateRequest(request, {"keyword"}, errorMessage)) {
+    if (!Protocol::SearchUsersRequest::fromJson(request, &params, &errorMessage)) {
         LOG_ERROR(QString("Invalid search request parameters: %1").arg(errorMessage));
         return createErrorResponse(requestId, action, "INVALID_PARAMS", errorMessage);
     }
 
-    QString keyword = request["keyword"].toString();
-    int limit = request["limit"].toInt(20);
+    QString keyword = params.keyword;
+    int limit = params.limit;
 
     // 搜索用户
 
@@ -411,13 +428,14 @@ QJsonObject ChatProtocolHandler::handleUpdateFriendNote(const QJsonObject& reque
     QString action = request["action"].toString();
 
     // 验证必需参数
+    Protocol::UpdateFriendNoteRequest params;
     QString errorMessage;
-    if (!validateRequest(request, {"friend_id", "note"}, errorMessage)) {
+    if (!Protocol::UpdateFriendNoteRequest::fromJson(request, &params, &errorMessage)) {
         return createErrorResponse(requestId, action, "INVALID_PARAMS", errorMessage);
     }
 
-    qint64 friendId = request["friend_id"].toVariant().toLongLong();
-    QString note = request["note"].toString();
+    qint64 friendId = params.friendId;
+    QString note = params.note;
 
     bool success = _friendService->updateFriendNote(userId, friendId, note);
 
@@ -454,13 +472,14 @@ QJsonObject ChatProtocolHandler::handleUpdateStatus(const QJsonObject& request,
     QString action = request["action"].toString();
 
     // 验证必需参数
+    Protocol::UpdateStatusRequest params;
     QString errorMessage;
-    if (!validateRequest(request, {"status"}, errorMessage)) {
+    if (!Protocol::UpdateStatusRequest::fromJson(request, &params, &errorMessage)) {
         return createErrorResponse(requestId, action, "INVALID_PARAMS", errorMessage);
     }
 
-    QString statusStr = request["status"].toString();
-    QString clientId = request["client_id"].toString();
+    QString statusStr = params.status;
+    QString clientId = params.clientId;
 
     OnlineStatusService::OnlineStatus status = OnlineStatusService::stringToStatus(statusStr);
 
@@ -494,10 +513,14 @@ QJsonObject ChatProtocolHandler::handleHeartbeat(const QJsonObject& request, qin
 {
     QString requestId = request["request_id"].toString();
     QString action = request["action"].toString();
-    QString clientId = request["client_id"].toString();
-    qint64 requestUserId = request["user_id"].toVariant().toLongLong();
-
 
+    Protocol::HeartbeatRequest params;
+    QString errorMessage;
+    if (!Protocol::HeartbeatRequest::fromJson(request, &params, &errorMessage)) {
+        return createErrorResponse(requestId, action, "INVALID_PARAMS", errorMessage);
+    }
+    QString clientId = params.clientId;
+    qint64 requestUserId = params.userId;
 
     // 验证用户ID
     if (userId <= 0) {
@@ -538,6 +561,8 @@ QJsonObject ChatProtocolHandler::handleMessageResponse(const QJsonObject& reques
 
     if (action == "send_message") {
         return handleSendMessage(request, userId);
+    } else if (action == "send_ephemeral") {
+        return handleSendEphemeral(request, userId);
     } else if (action == "get_chat_history") {
     
         return handleGetChatHistory(request, userId);
@@ -567,37 +592,30 @@ QJsonObject ChatProtocolHandler::handleSendMessage(const QJsonObject& request, q
 
     
 
-    // 验证必需参数
+    // 解码并验证参数
+    Protocol::SendMessageRequest params;
     QString errorMessage;
-    if (!validateRequest(request, {"receiver_id", "content"}, errorMessage)) {
+    if (!Protocol::SendMessageRequest::fromJson(request, &params, &errorMessage)) {
         LOG_ERROR(QString("ChatProtocolHandler: handleSendMessage validation failed - %1").arg(errorMessage));
         return createErrorResponse(requestId, action, "INVALID_PARAMS", errorMessage);
     }
 
-    qint64 receiverId = request["receiver_id"].toVariant().toLongLong();
-    QString content = request["content"].toString();
-    QString type = request["type"].toString("text");
-    QString fileUrl = request["file_url"].toString();
-    qint64 fileSize = request["file_size"].toVariant().toLongLong();
-    QString fileHash = request["file_hash"].toString();
+    MessageService::MessageType messageType = MessageService::stringToMessageType(params.type);
 
 
-
-    MessageService::MessageType messageType = MessageService::stringToMessageType(type);
-
-
-    QString messageId = _messageService->sendMessage(userId, receiverId, messageType, content, fileUrl, fileSize, fileHash);
+    QString messageId = _messageService->sendMessage(userId, params.receiverId, messageType, params.content,
+                                                     params.fileUrl, params.fileSize, params.fileHash);
 
 
 
     if (!messageId.isEmpty() && messageId != "NOT_FRIENDS") {
-        QJsonObject data;
-        data["message_id"] = messageId;
-        data["receiver_id"] = receiverId;
-        data["type"] = type;
-        data["message"] = "Message sent successfully";
+        Protocol::SendMessageResponse data;
+        data.messageId = messageId;
+        data.receiverId = params.receiverId;
+        data.type = params.type;
+        data.message = "Message sent successfully";
     
-        return createSuccessResponse(requestId, "send_message_response", data);
+        return createSuccessResponse(requestId, Protocol::SendMessageResponse::Action, data.toJson());
     } else if (messageId == "NOT_FRIENDS") {
         LOG_WARNING(QString("ChatProtocolHandler: handleSendMessage - Users are not friends"));
         return createErrorResponse(requestId, action, "NOT_FRIENDS", "未加对方为好友，无法发送消息");
@@ -607,38 +625,277 @@ QJsonObject ChatProtocolHandler::handleSendMessage(const QJsonObject& request, q
     }
 }
 
-QJsonObject ChatProtocolHandler::handleGetChatHistory(const QJsonObject& request, qint64 userId)
+QJsonObject ChatProtocolHandler::handleSendEphemeral(const QJsonObject& request, qint64 userId)
 {
     QString requestId = request["request_id"].toString();
     QString action = request["action"].toString();
 
-    
-
     // 验证必需参数
+    Protocol::SendEphemeralRequest params;
     QString errorMessage;
-    if (!validateRequest(request, {"chat_user_id"}, errorMessage)) {
-        LOG_ERROR(QString("ChatProtocolHandler: handleGetChatHistory validation failed - %1").arg(errorMessage));
+    if (!Protocol::SendEphemeralRequest::fromJson(request, &params, &errorMessage)) {
         return createErrorResponse(requestId, action, "INVALID_PARAMS", errorMessage);
     }
 
-    qint64 chatUserId = request["chat_user_id"].toVariant().toLongLong();
-    int limit = request["limit"].toInt(50);
-    int offset = request["offset"].toInt(0);
+    // 瞬时事件不持久化、不确认：已投递、被合并或对方离线都视为成功，只有无效事件返回错误
+    EphemeralChannel::PublishResult result = EphemeralChannel::instance()->publish(userId, params.receiverId, params.event, params.active);
+    if (result == EphemeralChannel::Rejected) {
+        return createErrorResponse(requestId, action, "EPHEMERAL_REJECTED", "Ephemeral event rejected");
+    }
 
-    
+    QJsonObject data;
+    data["delivered"] = result == EphemeralChannel::Delivered;
+    return createSuccessResponse(requestId, "send_ephemeral_response", data);
+}
 
-    QJsonArray messages = _messageService->getChatHistory(userId, chatUserId, limit, offset);
+QJsonObject ChatProtocolHandler::handleBootstrap(const QJsonObject& request, qint64 userId)
+{
+    QString requestId = request["request_id"].toString();
+    QString action = request["action"].toString();
 
+    if (!BootstrapService::instance()->isEnabled()) {
+        return createErrorResponse(requestId, action, "BOOTSTRAP_DISABLED", "Bootstrap is disabled");
+    }
 
+    Protocol::BootstrapRequest params;
+    QString errorMessage;
+    if (!Protocol::BootstrapRequest::fromJson(request, &params, &errorMessage)) {
+        return createErrorResponse(requestId, action, "INVALID_PARAMS", errorMessage);
+    }
 
     QJsonObject data;
-    data["messages"] = messages;
-    data["count"] = messages.size();
-    data["chat_user_id"] = chatUserId;
-    data["limit"] = limit;
-    data["offset"] = offset;
+    if (!BootstrapService::instance()->assemble(userId, params.sections, params.versions, &data)) {
+        return createErrorResponse(requestId, action, "SERVER_BUSY", "Server busy, please retry");
+    }
+    return createSuccessResponse(requestId, "bootstrap_response", data);
+}
+
+QJsonObject ChatProtocolHandler::handleGroupOperations(const QJsonObject& request, qint64 userId)
+{
+    QString action = request["action"].toString();
+    QString requestId = request["request_id"].toString();
+
+    if (action == "group_create") {
+        return handleCreateGroup(request, userId);
+    } else if (action == "group_list") {
+        return handleGetGroupList(request, userId);
+    } else if (action == "group_members") {
+        return handleGetGroupMembers(request, userId);
+    } else if (action == "group_add_members") {
+        return handleAddGroupMembers(request, userId);
+    } else if (action == "group_leave") {
+        return handleLeaveGroup(request, userId);
+    } else if (action == "group_send_message") {
+        return handleSendGroupMessage(request, userId);
+    } else if (action == "group_history") {
+        return handleGetGroupHistory(request, userId);
+    } else if (action == "group_mark_read") {
+        return handleMarkGroupRead(request, userId);
+    }
+
+    return createErrorResponse(requestId, action, "INVALID_ACTION", "Unknown group action: " + action);
+}
+
+QJsonObject ChatProtocolHandler::handleCreateGroup(const QJsonObject& request, qint64 userId)
+{
+    QString requestId = request["request_id"].toString();
+    QString action = request["action"].toString();
+
+    Protocol::CreateGroupRequest params;
+    QString errorMessage;
+    if (!Protocol::CreateGroupRequest::fromJson(request, &params, &errorMessage)) {
+        return createErrorResponse(requestId, action, "INVALID_PARAMS", errorMessage);
+    }
+
+    QJsonObject group;
+    GroupService::GroupResult result = _groupService->createGroup(userId, params.name, params.memberIds, &group);
+    if (result != GroupService::Success) {
+        return createErrorResponse(requestId, action, GroupService::resultToErrorCode(result), "Failed to create group");
+    }
+
+    QJsonObject data;
+    data["group"] = group;
+    return createSuccessResponse(requestId, "group_create_response", data);
+}
+
+QJsonObject ChatProtocolHandler::handleGetGroupList(const QJsonObject& request, qint64 userId)
+{
+    QString requestId = request["request_id"].toString();
+
+    QJsonArray groups = _groupService->getUserGroups(userId);
+
+    QJsonObject data;
+    data["groups"] = groups;
+    data["count"] = groups.size();
+    return createSuccessResponse(requestId, "group_list_response", data);
+}
+
+QJsonObject ChatProtocolHandler::handleGetGroupMembers(const QJsonObject& request, qint64 userId)
+{
+    QString requestId = request["request_id"].toString();
+    QString action = request["action"].toString();
+
+    Protocol::GroupIdRequest params;
+    QString errorMessage;
+    if (!Protocol::GroupIdRequest::fromJson(request, &params, &errorMessage)) {
+        return createErrorResponse(requestId, action, "INVALID_PARAMS", errorMessage);
+    }
+
+    qint64 groupId = params.groupId;
+    QJsonArray members;
+    GroupService::GroupResult result = _groupService->getGroupMembers(groupId, userId, &members);
+    if (result != GroupService::Success) {
+        return createErrorResponse(requestId, action, GroupService::resultToErrorCode(result), "Failed to get group members");
+    }
+
+    QJsonObject data;
+    data["group_id"] = groupId;
+    data["members"] = members;
+    data["count"] = members.size();
+    return createSuccessResponse(requestId, "group_members_response", data);
+}
 
-    return createSuccessResponse(requestId, "get_chat_history_response", data);
+QJsonObject ChatProtocolHandler::handleAddGroupMembers(const QJsonObject& request, qint64 userId)
+{
+    QString requestId = request["request_id"].toString();
+    QString action = request["action"].toString();
+
+    Protocol::AddGroupMembersRequest params;
+    QString errorMessage;
+    if (!Protocol::AddGroupMembersRequest::fromJson(request, &params, &errorMessage)) {
+        return createErrorResponse(requestId, action, "INVALID_PARAMS", errorMessage);
+    }
+
+    qint64 groupId = params.groupId;
+    int added = 0;
+    GroupService::GroupResult result = _groupService->addMembers(groupId, userId, params.memberIds, &added);
+    if (result != GroupService::Success) {
+        return createErrorResponse(requestId, action, GroupService::resultToErrorCode(result), "Failed to add group members");
+    }
+
+    QJsonObject data;
+    data["group_id"] = groupId;
+    data["added"] = added;
+    return createSuccessResponse(requestId, "group_add_members_response", data);
+}
+
+QJsonObject ChatProtocolHandler::handleLeaveGroup(const QJsonObject& request, qint64 userId)
+{
+    QString requestId = request["request_id"].toString();
+    QString action = request["action"].toString();
+
+    Protocol::GroupIdRequest params;
+    QString errorMessage;
+    if (!Protocol::GroupIdRequest::fromJson(request, &params, &errorMessage)) {
+        return createErrorResponse(requestId, action, "INVALID_PARAMS", errorMessage);
+    }
+
+    qint64 groupId = params.groupId;
+    GroupService::GroupResult result = _groupService->leaveGroup(groupId, userId);
+    if (result != GroupService::Success) {
+        return createErrorResponse(requestId, action, GroupService::resultToErrorCode(result), "Failed to leave group");
+    }
+
+    QJsonObject data;
+    data["group_id"] = groupId;
+    return createSuccessResponse(requestId, "group_leave_response", data);
+}
+
+QJsonObject ChatProtocolHandler::handleSendGroupMessage(const QJsonObject& request, qint64 userId)
+{
+    QString requestId = request["request_id"].toString();
+    QString action = request["action"].toString();
+
+    Protocol::SendGroupMessageRequest params;
+    QString errorMessage;
+    if (!Protocol::SendGroupMessageRequest::fromJson(request, &params, &errorMessage)) {
+        return createErrorResponse(requestId, action, "INVALID_PARAMS", errorMessage);
+    }
+
+    QJsonObject message;
+    GroupService::GroupResult result = _groupService->sendGroupMessage(
+        params.groupId, userId, MessageService::stringToMessageType(params.type), params.content,
+        params.fileUrl, params.fileSize, params.fileHash, &message);
+    if (result != GroupService::Success) {
+        return createErrorResponse(requestId, action, GroupService::resultToErrorCode(result), "Failed to send group message");
+    }
+
+    Protocol::SendGroupMessageResponse data;
+    data.groupId = params.groupId;
+    data.messageId = message["message_id"].toString();
+    data.seq = message["seq"].toVariant().toLongLong();
+    return createSuccessResponse(requestId, Protocol::SendGroupMessageResponse::Action, data.toJson());
+}
+
+QJsonObject ChatProtocolHandler::handleGetGroupHistory(const QJsonObject& request, qint64 userId)
+{
+    QString requestId = request["request_id"].toString();
+    QString action = request["action"].toString();
+
+    Protocol::GroupHistoryRequest params;
+    QString errorMessage;
+    if (!Protocol::GroupHistoryRequest::fromJson(request, &params, &errorMessage)) {
+        return createErrorResponse(requestId, action, "INVALID_PARAMS", errorMessage);
+    }
+
+    Protocol::GroupHistoryResponse data;
+    GroupService::GroupResult result = _groupService->getGroupHistory(params.groupId, userId, params.afterSeq, params.beforeSeq,
+                                                                      params.limit, &data.messages);
+    if (result != GroupService::Success) {
+        return createErrorResponse(requestId, action, GroupService::resultToErrorCode(result), "Failed to get group history");
+    }
+
+    data.groupId = params.groupId;
+    data.count = data.messages.size();
+    data.afterSeq = params.afterSeq;
+    data.beforeSeq = params.beforeSeq;
+    return createSuccessResponse(requestId, Protocol::GroupHistoryResponse::Action, data.toJson());
+}
+
+QJsonObject ChatProtocolHandler::handleMarkGroupRead(const QJsonObject& request, qint64 userId)
+{
+    QString requestId = request["request_id"].toString();
+    QString action = request["action"].toString();
+
+    Protocol::MarkGroupReadRequest params;
+    QString errorMessage;
+    if (!Protocol::MarkGroupReadRequest::fromJson(request, &params, &errorMessage)) {
+        return createErrorResponse(requestId, action, "INVALID_PARAMS", errorMessage);
+    }
+
+    Protocol::MarkGroupReadResponse data;
+    GroupService::GroupResult result = _groupService->markRead(params.groupId, userId, params.seq, &data.lastReadSeq);
+    if (result != GroupService::Success) {
+        return createErrorResponse(requestId, action, GroupService::resultToErrorCode(result), "Failed to mark group read");
+    }
+
+    data.groupId = params.groupId;
+    return createSuccessResponse(requestId, Protocol::MarkGroupReadResponse::Action, data.toJson());
+}
+
+QJsonObject ChatProtocolHandler::handleGetChatHistory(const QJsonObject& request, qint64 userId)
+{
+    QString requestId = request["request_id"].toString();
+    QString action = request["action"].toString();
+
+    
+
+    // 解码并验证参数
+    Protocol::ChatHistoryRequest params;
+    QString errorMessage;
+    if (!Protocol::ChatHistoryRequest::fromJson(request, &params, &errorMessage)) {
+        LOG_ERROR(QString("ChatProtocolHandler: handleGetChatHistory validation failed - %1").arg(errorMessage));
+        return createErrorResponse(requestId, action, "INVALID_PARAMS", errorMessage);
+    }
+
+    Protocol::ChatHistoryResponse data;
+    data.messages = _messageService->getChatHistory(userId, params.chatUserId, params.limit, params.offset);
+    data.count = data.messages.size();
+    data.chatUserId = params.chatUserId;
+    data.limit = params.limit;
+    data.offset = params.offset;
+
+    return createSuccessResponse(requestId, Protocol::ChatHistoryResponse::Action, data.toJson());
 }
 
 QJsonObject ChatProtocolHandler::handleGetChatSessions(const QJsonObject& request, qint64 userId)
@@ -660,13 +917,14 @@ QJsonObject ChatProtocolHandler::handleMarkMessageRead(const QJsonObject& reques
     QString requestId = request["request_id"].toString();
     QString action = request["action"].toString();
 
-    // 验证必需参数
+    // 解码并验证参数
+    Protocol::MessageIdRequest params;
     QString errorMessage;
-    if (!validateRequest(request, {"message_id"}, errorMessage)) {
+    if (!Protocol::MessageIdRequest::fromJson(request, &params, &errorMessage)) {
         return createErrorResponse(requestId, action, "INVALID_PARAMS", errorMessage);
     }
 
-    QString messageId = request["message_id"].toString();
+    QString messageId = params.messageId;
 
     bool success = _messageService->markMessageAsRead(userId, messageId);
 
@@ -685,11 +943,14 @@ QJsonObject ChatProtocolHandler::handleGetUnreadCount(const QJsonObject& request
     QString requestId = request["request_id"].toString();
     QString action = request["action"].toString();
 
-    qint64 fromUserId = request["from_user_id"].toVariant().toLongLong();
-    if (fromUserId == 0 && !request["from_user_id"].toVariant().isValid()) {
-        fromUserId = -1;
+    Protocol::UnreadCountRequest params;
+    QString errorMessage;
+    if (!Protocol::UnreadCountRequest::fromJson(request, &params, &errorMessage)) {
+        return createErrorResponse(requestId, action, "INVALID_PARAMS", errorMessage);
     }
 
+    qint64 fromUserId = params.hasFromUserId ? params.fromUserId : -1;
+
     int count = _messageService->getUnreadMessageCount(userId, fromUserId);
 
     QJsonObject data;
@@ -721,13 +982,14 @@ QJsonObject ChatProtocolHandler::handleDeleteMessage(const QJsonObject& request,
     QString requestId = request["request_id"].toString();
     QString action = request["action"].toString();
 
-    // 验证必需参数
+    // 解码并验证参数
+    Protocol::MessageIdRequest params;
     QString errorMessage;
-    if (!validateRequest(request, {"message_id"}, errorMessage)) {
+    if (!Protocol::MessageIdRequest::fromJson(request, &params, &errorMessage)) {
         return createErrorResponse(requestId, action, "INVALID_PARAMS", errorMessage);
     }
 
-    QString messageId = request["message_id"].toString();
+    QString messageId = params.messageId;
 
     bool success = _messageService->deleteMessage(userId, messageId);
 
@@ -746,13 +1008,14 @@ QJsonObject ChatProtocolHandler::handleRecallMessage(const QJsonObject& request,
     QString requestId = request["request_id"].toString();
     QString action = request["action"].toString();
 
-    // 验证必需参数
+    // 解码并验证参数
+    Protocol::MessageIdRequest params;
     QString errorMessage;
-    if (!validateRequest(request, {"message_id"}, errorMessage)) {
+    if (!Protocol::MessageIdRequest::fromJson(request, &params, &errorMessage)) {
         return createErrorResponse(requestId, action, "INVALID_PARAMS", errorMessage);
     }
 
-    QString messageId = request["message_id"].toString();
+    QString messageId = params.messageId;
 
     bool success = _messageService->recallMessage(userId, messageId);
 
@@ -771,18 +1034,16 @@ QJsonObject ChatProtocolHandler::handleSearchMessages(const QJsonObject& request
     QString requestId = request["request_id"].toString();
     QString action = request["action"].toString();
 
-    // 验证必需参数
+    // 解码并验证参数
+    Protocol::SearchMessagesRequest params;
     QString errorMessage;
-    if (!validateRequest(request, {"keyword"}, errorMessage)) {
+    if (!Protocol::SearchMessagesRequest::fromJson(request, &params, &errorMessage)) {
         return createErrorResponse(requestId, action, "INVALID_PARAMS", errorMessage);
     }
 
-    QString keyword = request["keyword"].toString();
-    qint64 chatUserId = request["chat_user_id"].toVariant().toLongLong();
-    if (chatUserId == 0 && !request["chat_user_id"].toVariant().isValid()) {
-        chatUserId = -1;
-    }
-    int limit = request["limit"].toInt(20);
+    QString keyword = params.keyword;
+    qint64 chatUserId = params.hasChatUserId ? params.chatUserId : -1;
+    int limit = params.limit;
 
     QJsonArray messages = _messageService->searchMessages(userId, keyword, chatUserId, limit);
 
@@ -871,12 +1132,13 @@ QJsonObject ChatProtocolHandler::handleCreateFriendGroup(const QJsonObject& requ
     QString action = request["action"].toString();
 
     // 验证必需参数
+    Protocol::CreateFriendGroupRequest params;
     QString errorMessage;
-    if (!validateRequest(request, {"group_name"}, errorMessage)) {
+    if (!Protocol::CreateFriendGroupRequest::fromJson(request, &params, &errorMessage)) {
         return createErrorResponse(requestId, action, "INVALID_PARAMS", errorMessage);
     }
 
-    QString groupName = request["group_name"].toString();
+    QString groupName = params.groupName;
 
     bool success = _friendService->createFriendGroup(userId, groupName);
 
@@ -895,12 +1157,13 @@ QJsonObject ChatProtocolHandler::handleDeleteFriendGroup(const QJsonObject& requ
     QString action = request["action"].toString();
 
     // 验证必需参数
+    Protocol::DeleteFriendGroupRequest params;
     QString errorMessage;
-    if (!validateRequest(request, {"group_id"}, errorMessage)) {
+    if (!Protocol::DeleteFriendGroupRequest::fromJson(request, &params, &errorMessage)) {
         return createErrorResponse(requestId, action, "INVALID_PARAMS", errorMessage);
     }
 
-    qint64 groupId = request["group_id"].toVariant().toLongLong();
+    qint64 groupId = params.groupId;
 
     bool success = _friendService->deleteFriendGroup(userId, groupId);
 
@@ -919,13 +1182,14 @@ QJsonObject ChatProtocolHandler::handleRenameFriendGroup(const QJsonObject& requ
     QString action = request["action"].toString();
 
     // 验证必需参数
+    Protocol::RenameFriendGroupRequest params;
     QString errorMessage;
-    if (!validateRequest(request, {"group_id", "new_name"}, errorMessage)) {
+    if (!Protocol::RenameFriendGroupRequest::fromJson(request, &params, &errorMessage)) {
         return createErrorResponse(requestId, action, "INVALID_PARAMS", errorMessage);
     }
 
-    qint64 groupId = request["group_id"].toVariant().toLongLong();
-    QString newName = request["new_name"].toString();
+    qint64 groupId = params.groupId;
+    QString newName = params.newName;
 
     bool success = _friendService->renameFriendGroup(userId, groupId, newName);
 
@@ -945,13 +1209,14 @@ QJsonObject ChatProtocolHandler::handleMoveFriendToGroup(const QJsonObject& requ
     QString action = request["action"].toString();
 
     // 验证必需参数
+    Protocol::MoveFriendToGroupRequest params;
     QString errorMessage;
-    if (!validateRequest(request, {"friend_id", "group_id"}, errorMessage)) {
+    if (!Protocol::MoveFriendToGroupRequest::fromJson(request, &params, &errorMessage)) {
         return createErrorResponse(requestId, action, "INVALID_PARAMS", errorMessage);
     }
 
-    qint64 friendId = request["friend_id"].toVariant().toLongLong();
-    qint64 groupId = request["group_id"].toVariant().toLongLong();
+    qint64 friendId = params.friendId;
+    qint64 groupId = params.groupId;
 
     bool success = _friendService->moveFriendToGroup(userId, friendId, groupId);
 
@@ -998,13 +1263,14 @@ QJsonObject ChatProtocolHandler::handleIgnoreFriendRequest(const QJsonObject& re
 
     
     // 验证必需参数
+    Protocol::FriendIgnoreRequest params;
     QString errorMessage;
-    if (!validateRequest(request, {"friend_request_id"}, errorMessage)) {
+    if (!Protocol::FriendIgnoreRequest::fromJson(request, &params, &errorMessage)) {
         LOG_ERROR(QString("参数验证失败: %1").arg(errorMessage));
         return createErrorResponse(requestId, action, "INVALID_PARAMS", errorMessage);
     }
     
-    qint64 friendRequestId = request["friend_request_id"].toVariant().toLongLong();
+    qint64 friendRequestId = params.friendRequestId;
     
 
     
@@ -11,6 +11,7 @@
 class FriendService;
 class OnlineStatusService;
 class MessageService;
+class GroupService;
 
 /**
  * @brief 聊天协议处理器
@@ -78,6 +79,7 @@ private:
      */
     QJsonObject handleMessageResponse(const QJsonObject& request, qint64 userId);
     QJsonObject handleSendMessage(const QJsonObject& request, qint64 userId);
+    QJsonObject handleSendEphemeral(const QJsonObject& request, qint64 userId);
     QJsonObject handleGetChatHistory(const QJsonObject& request, qint64 userId);
     QJsonObject handleGetChatSessions(const QJsonObject& request, qint64 userId);
     QJsonObject handleMarkMessageRead(const QJsonObject& request, qint64 userId);
@@ -87,6 +89,24 @@ private:
     QJsonObject handleRecallMessage(const QJsonObject& request, qint64 userId);
     QJsonObject handleSearchMessages(const QJsonObject& request, qint64 userId);
 
+    /**
+     * @brief 处理登录引导请求，合并返回登录后需要的各项数据
+     */
+    QJsonObject handleBootstrap(const QJsonObject& request, qint64 userId);
+
+    /**
+     * @brief 处理群聊相关操作
+     */
+    QJsonObject handleGroupOperations(const QJsonObject& request, qint64 userId);
+    QJsonObject handleCreateGroup(const QJsonObject& request, qint64 userId);
+    QJsonObject handleGetGroupList(const QJsonObject& request, qint64 userId);
+    QJsonObject handleGetGroupMembers(const QJsonObject& request, qint64 userId);
+    QJsonObject handleAddGroupMembers(const QJsonObject& request, qint64 userId);
+    QJsonObject handleLeaveGroup(const QJsonObject& request, qint64 userId);
+    QJsonObject handleSendGroupMessage(const QJsonObject& request, qint64 userId);
+    QJsonObject handleGetGroupHistory(const QJsonObject& request, qint64 userId);
+    QJsonObject handleMarkGroupRead(const QJsonObject& request, qint64 userId);
+
     /**
      * @brief 创建成功响应
      */
@@ -117,6 +137,7 @@ private:
     FriendService* _friendService;
     OnlineStatusService* _statusService;
     MessageService* _messageService;
+    GroupService* _groupService;
 };
 
 #endif // CHATPROTOCOLHANDLER_H
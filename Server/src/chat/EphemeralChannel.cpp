@@ -0,0 +1,193 @@
+#include "EphemeralChannel.h"
+#include "FriendService.h"
+#include "../network/ThreadPoolServer.h"
+#include "../utils/Logger.h"
+
+// 静态成员初始化
+EphemeralChannel* EphemeralChannel::s_instance = nullptr;
+QMutex EphemeralChannel::s_instanceMutex;
+
+namespace {
+
+// 过期条目的清理间隔
+const qint64 PRUNE_INTERVAL_MS = 10000;
+
+} // namespace
+
+EphemeralChannel::EphemeralChannel(QObject *parent)
+    : QObject(parent)
+    , _lastPruneMs(0)
+    , _published(0)
+    , _delivered(0)
+    , _deliveredRemote(0)
+    , _coalesced(0)
+    , _peerOffline(0)
+    , _rejected(0)
+{
+    _eventTypes = QSet<QString>(_config.eventTypes.begin(), _config.eventTypes.end());
+    _clock.start();
+}
+
+EphemeralChannel* EphemeralChannel::instance()
+{
+    if (!s_instance) {
+        QMutexLocker locker(&s_instanceMutex);
+        if (!s_instance) {
+            s_instance = new EphemeralChannel();
+        }
+    }
+    return s_instance;
+}
+
+void EphemeralChannel::configure(const Config &config)
+{
+    QMutexLocker locker(&_mutex);
+    _config = config;
+    _eventTypes = QSet<QString>(config.eventTypes.begin(), config.eventTypes.end());
+}
+
+void EphemeralChannel::setRemoteDelivery(const RemoteDelivery &delivery)
+{
+    _remoteDelivery = delivery;
+}
+
+qint64 EphemeralChannel::coalesceKey(qint64 senderId, const QString &eventType)
+{
+    // 最高可用位区分键空间，事件类型占8位，低52位为发送者ID
+    const qint64 userMask = (Q_INT64_C(1) << 52) - 1;
+    qint64 typeBits = static_cast<qint64>(qHash(eventType) & 0xFF) << 52;
+    return (Q_INT64_C(1) << 62) | typeBits | (senderId & userMask);
+}
+
+EphemeralChannel::PublishResult EphemeralChannel::publish(qint64 senderId, qint64 receiverId,
+                                                          const QString &eventType, bool active)
+{
+    _published.fetchAndAddOrdered(1);
+
+    qint64 nowMs = _clock.elapsed();
+    EventKey key(UserPair(senderId, receiverId), eventType);
+    int expiresInMs = 0;
+
+    {
+        QMutexLocker locker(&_mutex);
+
+        if (!_config.enabled || senderId <= 0 || receiverId <= 0 || senderId == receiverId ||
+            !_eventTypes.contains(eventType)) {
+            _rejected.fetchAndAddOrdered(1);
+            return Rejected;
+        }
+
+        if (nowMs - _lastPruneMs >= PRUNE_INTERVAL_MS) {
+            pruneLocked(nowMs);
+        }
+
+        // 窗口内重复的相同状态不再发送，状态变化立即发送
+        auto it = _lastSent.constFind(key);
+        if (it != _lastSent.constEnd() && it->active == active &&
+            nowMs - it->sentAtMs < _config.coalesceWindowMs) {
+            _coalesced.fetchAndAddOrdered(1);
+            return Coalesced;
+        }
+
+        expiresInMs = _config.expiresInMs;
+    }
+
+    if (!areFriends(senderId, receiverId, nowMs)) {
+        _rejected.fetchAndAddOrdered(1);
+        return Rejected;
+    }
+
+    QJsonObject event;
+    event["action"] = "ephemeral_event";
+    event["sender_id"] = senderId;
+    event["event"] = eventType;
+    event["active"] = active;
+    event["expires_in_ms"] = expiresInMs;
+
+    // 走批量通道：不与聊天消息争用发送预算，积压时被合并或最先丢弃
+    bool delivered = false;
+    ThreadPoolServer* server = ThreadPoolServer::instance();
+    if (server) {
+        RecipientList recipients;
+        recipients.append(receiverId);
+        delivered = server->sendMessageToUsers(recipients, event, OutboundLanes::BulkLane,
+                                               coalesceKey(senderId, eventType)) > 0;
+    }
+
+    if (delivered) {
+        _delivered.fetchAndAddOrdered(1);
+    } else if (_remoteDelivery && _remoteDelivery(receiverId, event)) {
+        delivered = true;
+        _deliveredRemote.fetchAndAddOrdered(1);
+    } else {
+        // 接收者不在线，瞬时事件不保存
+        _peerOffline.fetchAndAddOrdered(1);
+        return PeerOffline;
+    }
+
+    QMutexLocker locker(&_mutex);
+    EventState &state = _lastSent[key];
+    state.active = active;
+    state.sentAtMs = nowMs;
+    return Delivered;
+}
+
+bool EphemeralChannel::areFriends(qint64 senderId, qint64 receiverId, qint64 nowMs)
+{
+    UserPair pair(qMin(senderId, receiverId), qMax(senderId, receiverId));
+
+    {
+        QMutexLocker locker(&_mutex);
+        auto it = _friendCache.constFind(pair);
+        if (it != _friendCache.constEnd() && it.value() > nowMs) {
+            return true;
+        }
+    }
+
+    // 只缓存肯定结果，刚添加的好友不会因缓存被拒绝
+    if (!FriendService::instance()->areFriends(senderId, receiverId)) {
+        return false;
+    }
+
+    QMutexLocker locker(&_mutex);
+    _friendCache.insert(pair, nowMs + _config.friendCacheMs);
+    return true;
+}
+
+void EphemeralChannel::pruneLocked(qint64 nowMs)
+{
+    _lastPruneMs = nowMs;
+
+    for (auto it = _lastSent.begin(); it != _lastSent.end();) {
+        if (nowMs - it->sentAtMs >= _config.coalesceWindowMs) {
+            it = _lastSent.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    for (auto it = _friendCache.begin(); it != _friendCache.end();) {
+        if (it.value() <= nowMs) {
+            it = _friendCache.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+QJsonObject EphemeralChannel::getStatistics() const
+{
+    QJsonObject stats;
+    stats["published"] = _published.loadAcquire();
+    stats["delivered"] = _delivered.loadAcquire();
+    stats["delivered_remote"] = _deliveredRemote.loadAcquire();
+    stats["coalesced"] = _coalesced.loadAcquire();
+    stats["peer_offline"] = _peerOffline.loadAcquire();
+    stats["rejected"] = _rejected.loadAcquire();
+
+    QMutexLocker locker(&_mutex);
+    stats["enabled"] = _config.enabled;
+    stats["tracked_pairs"] = _lastSent.size();
+    stats["cached_friendships"] = _friendCache.size();
+    return stats;
+}
@@ -0,0 +1,127 @@
+#ifndef EPHEMERALCHANNEL_H
+#define EPHEMERALCHANNEL_H
+
+#include <QObject>
+#include <QMutex>
+#include <QHash>
+#include <QPair>
+#include <QSet>
+#include <QAtomicInteger>
+#include <QJsonObject>
+#include <QElapsedTimer>
+#include <QStringList>
+#include <functional>
+
+/**
+ * @brief 瞬时事件通道
+ *
+ * 用于"正在输入"、"正在查看"等瞬时信号：不写数据库、不进离线队列、没有送达状态。
+ * 同一(发送者, 接收者)对在合并窗口内重复的相同事件被合并，状态变化（开始/停止）立即发送；
+ * 接收者不在线时直接丢弃。事件走批量出站通道，接收方积压时同一发送者只保留最新一帧，超出预算时最先被丢弃。
+ */
+class EphemeralChannel : public QObject
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @brief 瞬时事件配置
+     */
+    struct Config {
+        bool enabled = true;
+        int coalesceWindowMs = 2000;      // 合并窗口，窗口内重复的相同事件不再发送
+        int expiresInMs = 6000;           // 接收方在该时间内未收到刷新则自动清除指示
+        int friendCacheMs = 60000;        // 好友关系校验结果缓存时间
+        QStringList eventTypes = { "typing", "viewing" };
+    };
+
+    /**
+     * @brief 发布结果
+     */
+    enum PublishResult {
+        Delivered,          // 已投递到本节点的连接或其他节点
+        Coalesced,          // 合并窗口内的重复事件，未发送
+        PeerOffline,        // 接收者不在线，已丢弃
+        Rejected            // 事件类型无效、未启用或双方不是好友
+    };
+
+    /**
+     * @brief 跨节点投递函数，接收者不在本节点时调用，返回是否已转交
+     */
+    using RemoteDelivery = std::function<bool(qint64 receiverId, const QJsonObject &event)>;
+
+    static EphemeralChannel* instance();
+
+    void configure(const Config &config);
+
+    /**
+     * @brief 设置跨节点投递函数，未设置时只投递到本节点；须在开始处理请求前设置
+     */
+    void setRemoteDelivery(const RemoteDelivery &delivery);
+
+    /**
+     * @brief 发布瞬时事件
+     * @param senderId 发送者用户ID
+     * @param receiverId 接收者用户ID
+     * @param eventType 事件类型，须在配置的类型列表中
+     * @param active true表示开始，false表示停止
+     */
+    PublishResult publish(qint64 senderId, qint64 receiverId, const QString &eventType, bool active);
+
+    /**
+     * @brief 获取瞬时事件统计信息
+     */
+    QJsonObject getStatistics() const;
+
+    /**
+     * @brief 批量通道合并键，按发送者和事件类型区分，与在线状态使用的用户ID不重叠
+     */
+    static qint64 coalesceKey(qint64 senderId, const QString &eventType);
+
+private:
+    explicit EphemeralChannel(QObject *parent = nullptr);
+
+    /**
+     * @brief 好友关系校验，带正向结果缓存
+     */
+    bool areFriends(qint64 senderId, qint64 receiverId, qint64 nowMs);
+
+    /**
+     * @brief 清理超过合并窗口和缓存时间的条目
+     */
+    void pruneLocked(qint64 nowMs);
+
+    using UserPair = QPair<qint64, qint64>;
+    using EventKey = QPair<UserPair, QString>;
+
+    /**
+     * @brief 每对用户每种事件最近一次发送的状态
+     */
+    struct EventState {
+        bool active = false;
+        qint64 sentAtMs = 0;
+    };
+
+    static EphemeralChannel* s_instance;
+    static QMutex s_instanceMutex;
+
+    Config _config;
+    QSet<QString> _eventTypes;
+    RemoteDelivery _remoteDelivery;
+
+    mutable QMutex _mutex;
+    QHash<EventKey, EventState> _lastSent;
+    QHash<UserPair, qint64> _friendCache;     // 用户对(小ID在前) -> 缓存到期时间
+    qint64 _lastPruneMs;
+    QElapsedTimer _clock;
+
+    // 统计信息
+    QAtomicInteger<qint64> _published;
+    QAtomicInteger<qint64> _delivered;
+    QAtomicInteger<qint64> _deliveredRemote;
+    QAtomicInteger<qint64> _coalesced;
+    QAtomicInteger<qint64> _peerOffline;
+    QAtomicInteger<qint64> _rejected;
+};
+
+#endif // EPHEMERALCHANNEL_H
@@ -6,6 +6,7 @@
 #include "../cache/CacheManager.h"
 #include "../rate_limit/RateLimitManager.h"
 #include "../network/ThreadPoolServer.h"
+#include "../monitoring/Tracer.h"
 #include <QSqlRecord>
 #include <QVariant>
 #include <QUuid>
@@ -59,6 +60,7 @@ bool FriendService::initialize()
 
 FriendService::FriendRequestResult FriendService::sendFriendRequest(qint64 fromUserId, const QString& toUserIdentifier, const QString& message, const QString& remark, const QString& groupName)
 {
+    TRACE_SPAN("FriendService::sendFriendRequest");
     QMutexLocker locker(&_mutex);
     
     // 查找目标用户
@@ -281,6 +283,7 @@ FriendService::FriendRequestResult FriendService::sendFriendRequest(qint64 fromU
 bool FriendService::respondToFriendRequest(qint64 userId, qint64 requestId, bool accept, 
                                          const QString& note, const QString& groupName)
 {
+    TRACE_SPAN("FriendService::respondToFriendRequest");
     QMutexLocker locker(&_mutex);
     
 
@@ -773,6 +776,7 @@ bool FriendService::ignoreFriendRequest(qint64 userId, qint64 requestId)
 
 QJsonArray FriendService::getFriendList(qint64 userId)
 {
+    TRACE_SPAN("FriendService::getFriendList");
     QMutexLocker locker(&_mutex);
     
     QJsonArray friendList;
@@ -896,6 +900,7 @@ QJsonArray FriendService::getFriendList(qint64 userId)
 
 QJsonArray FriendService::getPendingFriendRequests(qint64 userId)
 {
+    TRACE_SPAN("FriendService::getPendingFriendRequests");
     QMutexLocker locker(&_mutex);
     
     QJsonArray requestList;
@@ -1127,6 +1132,7 @@ bool FriendService::deleteFriendRequestNotification(qint64 userId, qint64 reques
 
 bool FriendService::removeFriend(qint64 userId, qint64 friendId)
 {
+    TRACE_SPAN("FriendService::removeFriend");
     QMutexLocker locker(&_mutex);
 
     // 使用RAII包装器自动管理数据库连接
@@ -1392,6 +1398,7 @@ FriendService::FriendshipStatus FriendService::getFriendshipStatus(qint64 userId
 
 QJsonArray FriendService::searchUsers(const QString& keyword, qint64 currentUserId, int limit)
 {
+    TRACE_SPAN("FriendService::searchUsers");
     QMutexLocker locker(&_mutex);
 
     // 在数据库中搜索用户
@@ -0,0 +1,857 @@
+#include "GroupService.h"
+#include "../database/DatabaseConnectionPool.h"
+#include "../network/ThreadPoolServer.h"
+#include "../monitoring/Tracer.h"
+#include <QSqlError>
+#include <QSet>
+#include <QStringList>
+
+// 静态成员初始化
+GroupService* GroupService::s_instance = nullptr;
+QMutex GroupService::s_instanceMutex;
+
+namespace {
+
+// 发送一条群消息写入的行数：群序号、消息、发送者游标
+const int ROWS_PER_GROUP_MESSAGE = 3;
+
+// 批量通道合并键，与在线状态（用户ID）和瞬时事件的键空间区分
+qint64 groupNotifyKey(qint64 groupId)
+{
+    return (Q_INT64_C(1) << 61) | groupId;
+}
+
+QString placeholders(int count)
+{
+    QStringList marks;
+    for (int i = 0; i < count; ++i) {
+        marks << "?";
+    }
+    return marks.join(", ");
+}
+
+} // namespace
+
+GroupService::GroupService(QObject *parent)
+    : QObject(parent)
+    , _initialized(false)
+    , _messagesSent(0)
+    , _rowsWritten(0)
+    , _recipients(0)
+    , _fullPushes(0)
+    , _notifyPushes(0)
+    , _onlineDelivered(0)
+    , _cursorUpdates(0)
+    , _cacheHits(0)
+    , _cacheMisses(0)
+{
+    _clock.start();
+}
+
+GroupService::~GroupService()
+{
+}
+
+GroupService* GroupService::instance()
+{
+    if (!s_instance) {
+        QMutexLocker locker(&s_instanceMutex);
+        if (!s_instance) {
+            s_instance = new GroupService();
+        }
+    }
+    return s_instance;
+}
+
+bool GroupService::initialize()
+{
+    QMutexLocker locker(&_mutex);
+
+    if (_initialized) {
+        return true;
+    }
+
+    DatabaseConnection dbConn;
+    if (!dbConn.isValid()) {
+        LOG_ERROR("Failed to initialize GroupService: database not available");
+        return false;
+    }
+
+    _initialized = true;
+    return true;
+}
+
+void GroupService::configure(const Config &config)
+{
+    QMutexLocker locker(&_cacheMutex);
+    _config = config;
+    _memberCache.clear();
+}
+
+GroupService::GroupResult GroupService::createGroup(qint64 ownerId, const QString& name,
+                                                    const QList<qint64>& memberIds, QJsonObject* group)
+{
+    TRACE_SPAN("GroupService::createGroup");
+
+    QString groupName = name.trimmed();
+    if (groupName.isEmpty() || groupName.size() > 100) {
+        return InvalidParams;
+    }
+
+    QList<qint64> members;
+    for (qint64 memberId : memberIds) {
+        if (memberId > 0 && memberId != ownerId && !members.contains(memberId)) {
+            members.append(memberId);
+        }
+    }
+    if (members.size() + 1 > _config.maxMembers) {
+        return TooManyMembers;
+    }
+
+    DatabaseConnection dbConn;
+    if (!dbConn.isValid()) {
+        LOG_ERROR("Failed to acquire database connection for creating group");
+        return DatabaseError;
+    }
+
+    // 初始成员须为群主的好友，一次查询校验
+    if (!members.isEmpty()) {
+        QVariantList params;
+        params << ownerId;
+        for (qint64 memberId : members) {
+            params << memberId;
+        }
+        QSqlQuery friendQuery = dbConn.executeQuery(
+            QString("SELECT COUNT(DISTINCT friend_id) FROM friendships "
+                    "WHERE user_id = ? AND status = 'accepted' AND friend_id IN (%1)").arg(placeholders(members.size())),
+            params);
+        if (friendQuery.lastError().isValid() || !friendQuery.next()) {
+            LOG_ERROR(QString("Failed to verify group members for user %1").arg(ownerId));
+            return DatabaseError;
+        }
+        if (friendQuery.value(0).toInt() != members.size()) {
+            return NotFriends;
+        }
+    }
+
+    if (!dbConn.beginTransaction()) {
+        LOG_ERROR("Failed to start transaction for creating group");
+        return DatabaseError;
+    }
+
+    try {
+        int result = dbConn.executeUpdate(
+            "INSERT INTO chat_groups (name, owner_id, member_count, last_seq, created_at, updated_at) "
+            "VALUES (?, ?, ?, 0, NOW(), NOW())",
+            {groupName, ownerId, members.size() + 1});
+        if (result == -1) {
+            throw std::runtime_error("Failed to insert group record");
+        }
+
+        QSqlQuery idQuery = dbConn.executeQuery("SELECT LAST_INSERT_ID()");
+        if (idQuery.lastError().isValid() || !idQuery.next()) {
+            throw std::runtime_error("Failed to read group id");
+        }
+        qint64 groupId = idQuery.value(0).toLongLong();
+
+        // 群主与初始成员一次插入
+        QStringList rows;
+        QVariantList params;
+        rows << "(?, ?, 'owner', 0, NOW())";
+        params << groupId << ownerId;
+        for (qint64 memberId : members) {
+            rows << "(?, ?, 'member', 0, NOW())";
+            params << groupId << memberId;
+        }
+        result = dbConn.executeUpdate(
+            "INSERT INTO chat_group_members (group_id, user_id, role, last_read_seq, joined_at) VALUES " +
+            rows.join(", "), params);
+        if (result == -1) {
+            throw std::runtime_error("Failed to insert group members");
+        }
+
+        if (!dbConn.commitTransaction()) {
+            throw std::runtime_error("Failed to commit create group transaction");
+        }
+
+        QJsonObject groupJson;
+        groupJson["id"] = groupId;
+        groupJson["name"] = groupName;
+        groupJson["owner_id"] = ownerId;
+        groupJson["member_count"] = members.size() + 1;
+        groupJson["last_seq"] = 0;
+        groupJson["last_read_seq"] = 0;
+        groupJson["unread_count"] = 0;
+        if (group) {
+            *group = groupJson;
+        }
+
+        QJsonObject notification;
+        notification["action"] = "group_added";
+        notification["group"] = groupJson;
+        RecipientList recipients(members.begin(), members.end());
+        notifyMembers(recipients, notification);
+
+        LOG_INFO(QString("Group %1 created by user %2 with %3 members").arg(groupId).arg(ownerId).arg(members.size() + 1));
+        return Success;
+
+    } catch (const std::exception& e) {
+        dbConn.rollbackTransaction();
+        LOG_ERROR(QString("Failed to create group: %1").arg(e.what()));
+        return DatabaseError;
+    }
+}
+
+GroupService::GroupResult GroupService::addMembers(qint64 groupId, qint64 operatorId,
+                                                   const QList<qint64>& memberIds, int* added)
+{
+    TRACE_SPAN("GroupService::addMembers");
+
+    if (added) {
+        *added = 0;
+    }
+
+    RecipientList current = getMemberIds(groupId);
+    if (current.isEmpty()) {
+        return GroupNotFound;
+    }
+    if (!current.contains(operatorId)) {
+        return NotMember;
+    }
+
+    QList<qint64> members;
+    for (qint64 memberId : memberIds) {
+        if (memberId > 0 && !current.contains(memberId) && !members.contains(memberId)) {
+            members.append(memberId);
+        }
+    }
+    if (members.isEmpty()) {
+        return Success;
+    }
+    if (current.size() + members.size() > _config.maxMembers) {
+        return TooManyMembers;
+    }
+
+    DatabaseConnection dbConn;
+    if (!dbConn.isValid()) {
+        LOG_ERROR("Failed to acquire database connection for adding group members");
+        return DatabaseError;
+    }
+
+    QVariantList friendParams;
+    friendParams << operatorId;
+    for (qint64 memberId : members) {
+        friendParams << memberId;
+    }
+    QSqlQuery friendQuery = dbConn.executeQuery(
+        QString("SELECT COUNT(DISTINCT friend_id) FROM friendships "
+                "WHERE user_id = ? AND status = 'accepted' AND friend_id IN (%1)").arg(placeholders(members.size())),
+        friendParams);
+    if (friendQuery.lastError().isValid() || !friendQuery.next()) {
+        LOG_ERROR(QString("Failed to verify new members of group %1").arg(groupId));
+        return DatabaseError;
+    }
+    if (friendQuery.value(0).toInt() != members.size()) {
+        return NotFriends;
+    }
+
+    if (!dbConn.beginTransaction()) {
+        LOG_ERROR("Failed to start transaction for adding group members");
+        return DatabaseError;
+    }
+
+    int inserted = 0;
+    qint64 lastSeq = 0;
+    try {
+        // 新成员的游标从当前最新序号开始，不把加入前的消息计为未读
+        QSqlQuery seqQuery = dbConn.executeQuery(
+            "SELECT last_seq FROM chat_groups WHERE id = ? FOR UPDATE", {groupId});
+        if (seqQuery.lastError().isValid() || !seqQuery.next()) {
+            throw std::runtime_error("Failed to lock group record");
+        }
+        lastSeq = seqQuery.value(0).toLongLong();
+
+        QStringList rows;
+        QVariantList params;
+        for (qint64 memberId : members) {
+            rows << "(?, ?, 'member', ?, NOW())";
+            params << groupId << memberId << lastSeq;
+        }
+        inserted = dbConn.executeUpdate(
+            "INSERT IGNORE INTO chat_group_members (group_id, user_id, role, last_read_seq, joined_at) VALUES " +
+            rows.join(", "), params);
+        if (inserted == -1) {
+            throw std::runtime_error("Failed to insert group members");
+        }
+
+        if (dbConn.executeUpdate(
+                "UPDATE chat_groups SET member_count = member_count + ?, updated_at = NOW() WHERE id = ?",
+                {inserted, groupId}) == -1) {
+            throw std::runtime_error("Failed to update member count");
+        }
+
+        if (!dbConn.commitTransaction()) {
+            throw std::runtime_error("Failed to commit add members transaction");
+        }
+    } catch (const std::exception& e) {
+        dbConn.rollbackTransaction();
+        LOG_ERROR(QString("Failed to add members to group %1: %2").arg(groupId).arg(e.what()));
+        return DatabaseError;
+    }
+
+    invalidateMembers(groupId);
+    if (added) {
+        *added = inserted;
+    }
+
+    QJsonObject notification;
+    notification["action"] = "group_members_changed";
+    notification["group_id"] = groupId;
+    notification["member_count"] = current.size() + inserted;
+    notification["last_seq"] = lastSeq;
+    notifyMembers(getMemberIds(groupId), notification);
+    return Success;
+}
+
+GroupService::GroupResult GroupService::leaveGroup(qint64 groupId, qint64 userId)
+{
+    TRACE_SPAN("GroupService::leaveGroup");
+
+    DatabaseConnection dbConn;
+    if (!dbConn.isValid()) {
+        LOG_ERROR("Failed to acquire database connection for leaving group");
+        return DatabaseError;
+    }
+
+    if (!dbConn.beginTransaction()) {
+        LOG_ERROR("Failed to start transaction for leaving group");
+        return DatabaseError;
+    }
+
+    int remaining = 0;
+    try {
+        QSqlQuery groupQuery = dbConn.executeQuery(
+            "SELECT owner_id FROM chat_groups WHERE id = ? FOR UPDATE", {groupId});
+        if (groupQuery.lastError().isValid()) {
+            throw std::runtime_error("Failed to lock group record");
+        }
+        if (!groupQuery.next()) {
+            dbConn.rollbackTransaction();
+            return GroupNotFound;
+        }
+        qint64 ownerId = groupQuery.value(0).toLongLong();
+
+        int removed = dbConn.executeUpdate(
+            "DELETE FROM chat_group_members WHERE group_id = ? AND user_id = ?", {groupId, userId});
+        if (removed == -1) {
+            throw std::runtime_error("Failed to remove group member");
+        }
+        if (removed == 0) {
+            dbConn.rollbackTransaction();
+            return NotMember;
+        }
+
+        QSqlQuery countQuery = dbConn.executeQuery(
+            "SELECT COUNT(*) FROM chat_group_members WHERE group_id = ?", {groupId});
+        if (countQuery.lastError().isValid() || !countQuery.next()) {
+            throw std::runtime_error("Failed to count group members");
+        }
+        remaining = countQuery.value(0).toInt();
+
+        if (remaining == 0) {
+            // 消息随群删除（外键级联）
+            if (dbConn.executeUpdate("DELETE FROM chat_groups WHERE id = ?", {groupId}) == -1) {
+                throw std::runtime_error("Failed to delete empty group");
+            }
+        } else {
+            if (ownerId == userId) {
+                if (dbConn.executeUpdate(
+                        "UPDATE chat_group_members SET role = 'owner' WHERE group_id = ? "
+                        "ORDER BY joined_at ASC, user_id ASC LIMIT 1", {groupId}) == -1) {
+                    throw std::runtime_error("Failed to transfer group owner");
+                }
+                if (dbConn.executeUpdate(
+                        "UPDATE chat_groups SET owner_id = (SELECT user_id FROM chat_group_members "
+                        "WHERE group_id = ? AND role = 'owner' LIMIT 1) WHERE id = ?", {groupId, groupId}) == -1) {
+                    throw std::runtime_error("Failed to update group owner");
+                }
+            }
+            if (dbConn.executeUpdate(
+                    "UPDATE chat_groups SET member_count = ?, updated_at = NOW() WHERE id = ?",
+                    {remaining, groupId}) == -1) {
+                throw std::runtime_error("Failed to update member count");
+            }
+        }
+
+        if (!dbConn.commitTransaction()) {
+            throw std::runtime_error("Failed to commit leave group transaction");
+        }
+    } catch (const std::exception& e) {
+        dbConn.rollbackTransaction();
+        LOG_ERROR(QString("Failed to leave group %1: %2").arg(groupId).arg(e.what()));
+        return DatabaseError;
+    }
+
+    invalidateMembers(groupId);
+
+    if (remaining > 0) {
+        QJsonObject notification;
+        notification["action"] = "group_members_changed";
+        notification["group_id"] = groupId;
+        notification["member_count"] = remaining;
+        notification["left_user_id"] = userId;
+        notifyMembers(getMemberIds(groupId), notification);
+    }
+    return Success;
+}
+
+QJsonArray GroupService::getUserGroups(qint64 userId)
+{
+    TRACE_SPAN("GroupService::getUserGroups");
+
+    QJsonArray groups;
+
+    DatabaseConnection dbConn;
+    if (!dbConn.isValid()) {
+        LOG_ERROR("Failed to acquire database connection for user groups");
+        return groups;
+    }
+
+    QSqlQuery query = dbConn.executeQuery(
+        "SELECT g.id, g.name, g.owner_id, g.member_count, g.last_seq, g.updated_at, "
+        "gm.role, gm.last_read_seq "
+        "FROM chat_group_members gm "
+        "JOIN chat_groups g ON g.id = gm.group_id "
+        "WHERE gm.user_id = ? "
+        "ORDER BY g.updated_at DESC",
+        {userId});
+
+    if (query.lastError().isValid()) {
+        LOG_ERROR(QString("Failed to get groups of user %1: %2").arg(userId).arg(query.lastError().text()));
+        return groups;
+    }
+
+    while (query.next()) {
+        qint64 lastSeq = query.value("last_seq").toLongLong();
+        qint64 lastReadSeq = query.value("last_read_seq").toLongLong();
+
+        QJsonObject group;
+        group["id"] = query.value("id").toLongLong();
+        group["name"] = query.value("name").toString();
+        group["owner_id"] = query.value("owner_id").toLongLong();
+        group["member_count"] = query.value("member_count").toInt();
+        group["role"] = query.value("role").toString();
+        group["last_seq"] = lastSeq;
+        group["last_read_seq"] = lastReadSeq;
+        group["unread_count"] = qMax<qint64>(0, lastSeq - lastReadSeq);
+        group["updated_at"] = query.value("updated_at").toDateTime().toString(Qt::ISODate);
+        groups.append(group);
+    }
+
+    return groups;
+}
+
+GroupService::GroupResult GroupService::getGroupMembers(qint64 groupId, qint64 userId, QJsonArray* members)
+{
+    TRACE_SPAN("GroupService::getGroupMembers");
+
+    DatabaseConnection dbConn;
+    if (!dbConn.isValid()) {
+        LOG_ERROR("Failed to acquire database connection for group members");
+        return DatabaseError;
+    }
+
+    QSqlQuery query = dbConn.executeQuery(
+        "SELECT gm.user_id, gm.role, gm.joined_at, u.username, u.display_name, u.avatar_url "
+        "FROM chat_group_members gm "
+        "JOIN users u ON u.id = gm.user_id "
+        "WHERE gm.group_id = ? "
+        "ORDER BY gm.joined_at ASC",
+        {groupId});
+
+    if (query.lastError().isValid()) {
+        LOG_ERROR(QString("Failed to get members of group %1: %2").arg(groupId).arg(query.lastError().text()));
+        return DatabaseError;
+    }
+
+    QJsonArray result;
+    bool isMember = false;
+    while (query.next()) {
+        QJsonObject member;
+        member["user_id"] = query.value("user_id").toLongLong();
+        member["role"] = query.value("role").toString();
+        member["username"] = query.value("username").toString();
+        member["display_name"] = query.value("display_name").toString();
+        member["avatar_url"] = query.value("avatar_url").toString();
+        member["joined_at"] = query.value("joined_at").toDateTime().toString(Qt::ISODate);
+        result.append(member);
+        if (query.value("user_id").toLongLong() == userId) {
+            isMember = true;
+        }
+    }
+
+    if (result.isEmpty()) {
+        return GroupNotFound;
+    }
+    if (!isMember) {
+        return NotMember;
+    }
+    if (members) {
+        *members = result;
+    }
+    return Success;
+}
+
+GroupService::GroupResult GroupService::sendGroupMessage(qint64 groupId, qint64 senderId,
+                                                         MessageService::MessageType type,
+                                                         const QString& content, const QString& fileUrl,
+                                                         qint64 fileSize, const QString& fileHash,
+                                                         QJsonObject* message)
+{
+    TRACE_SPAN("GroupService::sendGroupMessage");
+
+    RecipientList members = getMemberIds(groupId);
+    if (members.isEmpty()) {
+        return GroupNotFound;
+    }
+    if (!members.contains(senderId)) {
+        return NotMember;
+    }
+
+    QString messageId = QUuid::createUuid().toString(QUuid::WithoutBraces);
+
+    DatabaseConnection dbConn;
+    if (!dbConn.isValid()) {
+        LOG_ERROR("Failed to acquire database connection for sending group message");
+        return DatabaseError;
+    }
+
+    if (!dbConn.beginTransaction()) {
+        LOG_ERROR("Failed to start transaction for sending group message");
+        return DatabaseError;
+    }
+
+    qint64 seq = 0;
+    try {
+        // 分配序号：群记录的行锁使同一群的发送按序号顺序提交，序号连续
+        int updated = dbConn.executeUpdate(
+            "UPDATE chat_groups SET last_seq = LAST_INSERT_ID(last_seq + 1), updated_at = NOW() WHERE id = ?",
+            {groupId});
+        if (updated == -1) {
+            throw std::runtime_error("Failed to allocate group sequence");
+        }
+        if (updated == 0) {
+            dbConn.rollbackTransaction();
+            invalidateMembers(groupId);
+            return GroupNotFound;
+        }
+
+        QSqlQuery seqQuery = dbConn.executeQuery("SELECT LAST_INSERT_ID()");
+        if (seqQuery.lastError().isValid() || !seqQuery.next()) {
+            throw std::runtime_error("Failed to read group sequence");
+        }
+        seq = seqQuery.value(0).toLongLong();
+
+        // 消息只存一份
+        int result = dbConn.executeUpdate(
+            "INSERT INTO group_messages (group_id, seq, message_id, sender_id, message_type, content, "
+            "file_url, file_size, file_hash, created_at) "
+            "VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, NOW())",
+            {groupId, seq, messageId, senderId, MessageService::messageTypeToString(type), content,
+             fileUrl.isEmpty() ? QVariant() : fileUrl,
+             fileSize > 0 ? fileSize : QVariant(),
+             fileHash.isEmpty() ? QVariant() : fileHash});
+        if (result == -1) {
+            throw std::runtime_error("Failed to insert group message");
+        }
+
+        // 发送者自己的消息不计为未读
+        if (dbConn.executeUpdate(
+                "UPDATE chat_group_members SET last_read_seq = ? WHERE group_id = ? AND user_id = ?",
+                {seq, groupId, senderId}) == -1) {
+            throw std::runtime_error("Failed to advance sender cursor");
+        }
+
+        if (!dbConn.commitTransaction()) {
+            throw std::runtime_error("Failed to commit group message transaction");
+        }
+    } catch (const std::exception& e) {
+        dbConn.rollbackTransaction();
+        LOG_ERROR(QString("Failed to send group message: %1").arg(e.what()));
+        return DatabaseError;
+    }
+
+    _messagesSent.fetchAndAddOrdered(1);
+    _rowsWritten.fetchAndAddOrdered(ROWS_PER_GROUP_MESSAGE);
+    _recipients.fetchAndAddOrdered(members.size() - 1);
+
+    QJsonObject messageJson;
+    messageJson["action"] = "group_message";
+    messageJson["notification_type"] = "group_message";
+    messageJson["group_id"] = groupId;
+    messageJson["seq"] = seq;
+    messageJson["message_id"] = messageId;
+    messageJson["sender_id"] = senderId;
+    messageJson["type"] = MessageService::messageTypeToString(type);
+    messageJson["content"] = content;
+    if (!fileUrl.isEmpty()) {
+        messageJson["file_url"] = fileUrl;
+        messageJson["file_size"] = fileSize;
+        messageJson["file_hash"] = fileHash;
+    }
+    messageJson["created_at"] = QDateTime::currentDateTime().toString(Qt::ISODate);
+
+    deliver(groupId, seq, senderId, members, messageJson);
+
+    if (message) {
+        *message = messageJson;
+    }
+    return Success;
+}
+
+GroupService::GroupResult GroupService::getGroupHistory(qint64 groupId, qint64 userId, qint64 afterSeq,
+                                                        qint64 beforeSeq, int limit, QJsonArray* messages)
+{
+    TRACE_SPAN("GroupService::getGroupHistory");
+
+    RecipientList members = getMemberIds(groupId);
+    if (members.isEmpty()) {
+        return GroupNotFound;
+    }
+    if (!members.contains(userId)) {
+        return NotMember;
+    }
+
+    limit = qBound(1, limit, _config.historyPageLimit);
+
+    DatabaseConnection dbConn;
+    if (!dbConn.isValid()) {
+        LOG_ERROR("Failed to acquire database connection for group history");
+        return DatabaseError;
+    }
+
+    // 均按(group_id, seq)索引范围扫描
+    QString sql =
+        "SELECT m.seq, m.message_id, m.sender_id, m.message_type, m.content, m.file_url, m.file_size, "
+        "m.file_hash, m.created_at, u.username AS sender_username, u.display_name AS sender_name, "
+        "u.avatar_url AS sender_avatar "
+        "FROM group_messages m "
+        "JOIN users u ON u.id = m.sender_id ";
+    QVariantList params;
+    if (afterSeq > 0) {
+        sql += "WHERE m.group_id = ? AND m.seq > ? ORDER BY m.seq ASC LIMIT ?";
+        params << groupId << afterSeq << limit;
+    } else if (beforeSeq > 0) {
+        sql += "WHERE m.group_id = ? AND m.seq < ? ORDER BY m.seq DESC LIMIT ?";
+        params << groupId << beforeSeq << limit;
+    } else {
+        sql += "WHERE m.group_id = ? ORDER BY m.seq DESC LIMIT ?";
+        params << groupId << limit;
+    }
+
+    QSqlQuery query = dbConn.executeQuery(sql, params);
+    if (query.lastError().isValid()) {
+        LOG_ERROR(QString("Failed to get history of group %1: %2").arg(groupId).arg(query.lastError().text()));
+        return DatabaseError;
+    }
+
+    QJsonArray result;
+    while (query.next()) {
+        QJsonObject message;
+        message["group_id"] = groupId;
+        message["seq"] = query.value("seq").toLongLong();
+        message["message_id"] = query.value("message_id").toString();
+        message["sender_id"] = query.value("sender_id").toLongLong();
+        message["type"] = query.value("message_type").toString();
+        message["content"] = query.value("content").toString();
+        message["file_url"] = query.value("file_url").toString();
+        message["file_size"] = query.value("file_size").toLongLong();
+        message["file_hash"] = query.value("file_hash").toString();
+        message["created_at"] = query.value("created_at").toDateTime().toString(Qt::ISODate);
+        message["sender_username"] = query.value("sender_username").toString();
+        message["sender_name"] = query.value("sender_name").toString();
+        message["sender_avatar"] = query.value("sender_avatar").toString();
+        message["is_own"] = query.value("sender_id").toLongLong() == userId;
+        result.append(message);
+    }
+
+    if (messages) {
+        *messages = result;
+    }
+    return Success;
+}
+
+GroupService::GroupResult GroupService::markRead(qint64 groupId, qint64 userId, qint64 seq, qint64* cursor)
+{
+    TRACE_SPAN("GroupService::markRead");
+
+    DatabaseConnection dbConn;
+    if (!dbConn.isValid()) {
+        LOG_ERROR("Failed to acquire database connection for marking group read");
+        return DatabaseError;
+    }
+
+    // 一行更新，不论群内有多少未读消息
+    int updated = dbConn.executeUpdate(
+        "UPDATE chat_group_members gm JOIN chat_groups g ON g.id = gm.group_id "
+        "SET gm.last_read_seq = GREATEST(gm.last_read_seq, LEAST(?, g.last_seq)) "
+        "WHERE gm.group_id = ? AND gm.user_id = ?",
+        {seq, groupId, userId});
+    if (updated == -1) {
+        LOG_ERROR(QString("Failed to mark group %1 read for user %2").arg(groupId).arg(userId));
+        return DatabaseError;
+    }
+    _cursorUpdates.fetchAndAddOrdered(1);
+
+    QSqlQuery query = dbConn.executeQuery(
+        "SELECT last_read_seq FROM chat_group_members WHERE group_id = ? AND user_id = ?",
+        {groupId, userId});
+    if (query.lastError().isValid()) {
+        return DatabaseError;
+    }
+    if (!query.next()) {
+        return NotMember;
+    }
+    if (cursor) {
+        *cursor = query.value(0).toLongLong();
+    }
+    return Success;
+}
+
+RecipientList GroupService::getMemberIds(qint64 groupId)
+{
+    qint64 nowMs = _clock.elapsed();
+    {
+        QMutexLocker locker(&_cacheMutex);
+        auto it = _memberCache.constFind(groupId);
+        if (it != _memberCache.constEnd() && it->expiresAtMs > nowMs) {
+            _cacheHits.fetchAndAddOrdered(1);
+            return it->members;
+        }
+    }
+    _cacheMisses.fetchAndAddOrdered(1);
+
+    DatabaseConnection dbConn;
+    if (!dbConn.isValid()) {
+        LOG_ERROR("Failed to acquire database connection for group member ids");
+        return RecipientList();
+    }
+
+    QSqlQuery query = dbConn.executeQuery(
+        "SELECT user_id FROM chat_group_members WHERE group_id = ?", {groupId});
+    if (query.lastError().isValid()) {
+        LOG_ERROR(QString("Failed to load members of group %1: %2").arg(groupId).arg(query.lastError().text()));
+        return RecipientList();
+    }
+
+    RecipientList members;
+    while (query.next()) {
+        members.append(query.value(0).toLongLong());
+    }
+
+    QMutexLocker locker(&_cacheMutex);
+    if (members.isEmpty()) {
+        _memberCache.remove(groupId);
+    } else {
+        CachedMembers &cached = _memberCache[groupId];
+        cached.members = members;
+        cached.expiresAtMs = nowMs + _config.memberCacheMs;
+    }
+    return members;
+}
+
+void GroupService::invalidateMembers(qint64 groupId)
+{
+    QMutexLocker locker(&_cacheMutex);
+    _memberCache.remove(groupId);
+}
+
+void GroupService::deliver(qint64 groupId, qint64 seq, qint64 senderId, const RecipientList& members,
+                           const QJsonObject& message)
+{
+    ThreadPoolServer* server = ThreadPoolServer::instance();
+    if (!server) {
+        return;
+    }
+
+    RecipientList recipients;
+    recipients.reserve(members.size());
+    for (qint64 memberId : members) {
+        if (memberId != senderId) {
+            recipients.append(memberId);
+        }
+    }
+    if (recipients.isEmpty()) {
+        return;
+    }
+
+    int delivered = 0;
+    if (members.size() <= _config.pushMemberLimit) {
+        // 小群：完整消息编码一次，所有在线成员共享同一帧
+        delivered = server->sendMessageToUsers(recipients, message, OutboundLanes::ChatLane);
+        _fullPushes.fetchAndAddOrdered(1);
+    } else {
+        // 大群：只推送最新序号，积压时同一群的通知只保留最新一条，客户端按游标拉取
+        QJsonObject notify;
+        notify["action"] = "group_notify";
+        notify["group_id"] = groupId;
+        notify["last_seq"] = seq;
+        delivered = server->sendMessageToUsers(recipients, notify, OutboundLanes::BulkLane, groupNotifyKey(groupId));
+        _notifyPushes.fetchAndAddOrdered(1);
+    }
+    _onlineDelivered.fetchAndAddOrdered(delivered);
+}
+
+void GroupService::notifyMembers(const RecipientList& members, const QJsonObject& notification)
+{
+    ThreadPoolServer* server = ThreadPoolServer::instance();
+    if (server && !members.isEmpty()) {
+        server->sendMessageToUsers(members, notification, OutboundLanes::ChatLane);
+    }
+}
+
+QString GroupService::resultToErrorCode(GroupResult result)
+{
+    switch (result) {
+    case Success:
+        return "SUCCESS";
+    case NotMember:
+        return "NOT_GROUP_MEMBER";
+    case NotFriends:
+        return "NOT_FRIENDS";
+    case GroupNotFound:
+        return "GROUP_NOT_FOUND";
+    case TooManyMembers:
+        return "TOO_MANY_MEMBERS";
+    case InvalidParams:
+        return "INVALID_PARAMS";
+    case DatabaseError:
+    default:
+        return "DATABASE_ERROR";
+    }
+}
+
+QJsonObject GroupService::getStatistics() const
+{
+    qint64 messages = _messagesSent.loadAcquire();
+    qint64 rows = _rowsWritten.loadAcquire();
+    qint64 recipients = _recipients.loadAcquire();
+
+    QJsonObject stats;
+    stats["messages_sent"] = messages;
+    stats["rows_written"] = rows;
+    stats["recipients"] = recipients;
+    stats["rows_per_message"] = messages > 0 ? static_cast<double>(rows) / messages : 0.0;
+    stats["avg_recipients"] = messages > 0 ? static_cast<double>(recipients) / messages : 0.0;
+    stats["full_pushes"] = _fullPushes.loadAcquire();
+    stats["notify_pushes"] = _notifyPushes.loadAcquire();
+    stats["online_delivered"] = _onlineDelivered.loadAcquire();
+    stats["cursor_updates"] = _cursorUpdates.loadAcquire();
+    stats["member_cache_hits"] = _cacheHits.loadAcquire();
+    stats["member_cache_misses"] = _cacheMisses.loadAcquire();
+    stats["push_member_limit"] = _config.pushMemberLimit;
+
+    QMutexLocker locker(&_cacheMutex);
+    stats["cached_groups"] = _memberCache.size();
+    return stats;
+}
@@ -0,0 +1,178 @@
+#ifndef GROUPSERVICE_H
+#define GROUPSERVICE_H
+
+#include <QObject>
+#include <QJsonObject>
+#include <QJsonArray>
+#include <QMutex>
+#include <QHash>
+#include <QList>
+#include <QAtomicInteger>
+#include <QElapsedTimer>
+#include "MessageService.h"
+#include "../network/EncodedFrame.h"
+
+/**
+ * @brief 群聊服务类
+ *
+ * 群消息按群时间线存储：每条消息只写一行，并占用群内递增的序号；每个成员只保存一个已读游标，
+ * 未读数为群最新序号与游标之差。发送一条消息的写入行数与成员数无关（序号分配、消息、发送者游标）。
+ *
+ * 投递时消息只编码一次，由所有在线成员共享；成员数超过推送上限的大群只推送携带最新序号的通知，
+ * 客户端收到后按自己的游标拉取。离线成员不入离线队列，上线后按游标补齐。
+ */
+class GroupService : public QObject
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @brief 群操作结果枚举
+     */
+    enum GroupResult {
+        Success,
+        NotMember,
+        NotFriends,
+        GroupNotFound,
+        TooManyMembers,
+        InvalidParams,
+        DatabaseError
+    };
+    Q_ENUM(GroupResult)
+
+    /**
+     * @brief 群聊配置
+     */
+    struct Config {
+        int pushMemberLimit = 200;        // 成员数不超过该值时推送完整消息，否则只推送通知
+        int maxMembers = 2000;            // 单个群的成员上限
+        int memberCacheMs = 30000;        // 成员列表缓存时间
+        int historyPageLimit = 100;       // 单次拉取的消息上限
+    };
+
+    explicit GroupService(QObject *parent = nullptr);
+    ~GroupService();
+
+    /**
+     * @brief 获取单例实例
+     */
+    static GroupService* instance();
+
+    /**
+     * @brief 初始化服务
+     */
+    bool initialize();
+
+    void configure(const Config &config);
+
+    /**
+     * @brief 创建群
+     * @param ownerId 群主ID
+     * @param name 群名称
+     * @param memberIds 初始成员，须为群主的好友
+     * @param group 成功时返回群信息
+     */
+    GroupResult createGroup(qint64 ownerId, const QString& name, const QList<qint64>& memberIds, QJsonObject* group);
+
+    /**
+     * @brief 添加成员，新成员须为操作者的好友
+     * @return 实际新增的成员数通过added返回
+     */
+    GroupResult addMembers(qint64 groupId, qint64 operatorId, const QList<qint64>& memberIds, int* added);
+
+    /**
+     * @brief 退出群，群主退出时转让给最早加入的成员，最后一名成员退出时删除群
+     */
+    GroupResult leaveGroup(qint64 groupId, qint64 userId);
+
+    /**
+     * @brief 获取用户加入的群，包含最新序号、已读游标和未读数
+     */
+    QJsonArray getUserGroups(qint64 userId);
+
+    /**
+     * @brief 获取群成员列表，调用者须为成员
+     */
+    GroupResult getGroupMembers(qint64 groupId, qint64 userId, QJsonArray* members);
+
+    /**
+     * @brief 发送群消息
+     * @param message 成功时返回消息JSON（包含序号）
+     */
+    GroupResult sendGroupMessage(qint64 groupId, qint64 senderId, MessageService::MessageType type,
+                                 const QString& content, const QString& fileUrl, qint64 fileSize,
+                                 const QString& fileHash, QJsonObject* message);
+
+    /**
+     * @brief 拉取群消息
+     * @param afterSeq >0时返回该序号之后的消息（升序），用于按游标补齐
+     * @param beforeSeq >0时返回该序号之前的消息（降序），用于向上翻页；两者都为0时返回最新一页
+     */
+    GroupResult getGroupHistory(qint64 groupId, qint64 userId, qint64 afterSeq, qint64 beforeSeq,
+                                int limit, QJsonArray* messages);
+
+    /**
+     * @brief 推进已读游标，游标只前进且不超过群最新序号
+     * @param cursor 返回更新后的游标
+     */
+    GroupResult markRead(qint64 groupId, qint64 userId, qint64 seq, qint64* cursor);
+
+    /**
+     * @brief 获取群聊统计信息
+     */
+    QJsonObject getStatistics() const;
+
+    /**
+     * @brief 结果转错误码
+     */
+    static QString resultToErrorCode(GroupResult result);
+
+private:
+    /**
+     * @brief 获取群成员，带缓存
+     * @return 群不存在时返回空列表
+     */
+    RecipientList getMemberIds(qint64 groupId);
+
+    void invalidateMembers(qint64 groupId);
+
+    /**
+     * @brief 推送给在线成员：小群推送完整消息，大群推送序号通知
+     */
+    void deliver(qint64 groupId, qint64 seq, qint64 senderId, const RecipientList& members,
+                 const QJsonObject& message);
+
+    /**
+     * @brief 通知成员群信息变化（加入、退出等）
+     */
+    void notifyMembers(const RecipientList& members, const QJsonObject& notification);
+
+    struct CachedMembers {
+        RecipientList members;
+        qint64 expiresAtMs = 0;
+    };
+
+    static GroupService* s_instance;
+    static QMutex s_instanceMutex;
+
+    QMutex _mutex;
+    bool _initialized;
+    Config _config;
+
+    mutable QMutex _cacheMutex;
+    QHash<qint64, CachedMembers> _memberCache;
+    QElapsedTimer _clock;
+
+    // 统计信息
+    QAtomicInteger<qint64> _messagesSent;
+    QAtomicInteger<qint64> _rowsWritten;
+    QAtomicInteger<qint64> _recipients;
+    QAtomicInteger<qint64> _fullPushes;
+    QAtomicInteger<qint64> _notifyPushes;
+    QAtomicInteger<qint64> _onlineDelivered;
+    QAtomicInteger<qint64> _cursorUpdates;
+    QAtomicInteger<qint64> _cacheHits;
+    QAtomicInteger<qint64> _cacheMisses;
+};
+
+#endif // GROUPSERVICE_H
@@ -3,6 +3,8 @@
 #include "OnlineStatusService.h"
 #include "../database/DatabaseManager.h"
 #include "../network/ThreadPoolServer.h"
+#include "../cluster/ClusterManager.h"
+#include "../monitoring/Tracer.h"
 #include <QSqlRecord>
 #include <QVariant>
 #include <QUuid>
@@ -55,6 +57,7 @@ bool MessageService::initialize()
 QString MessageService::sendMessage(qint64 senderId, qint64 receiverId, MessageType type, const QString& content,
                                    const QString& fileUrl, qint64 fileSize, const QString& fileHash)
 {
+    TRACE_SPAN("MessageService::sendMessage");
     QMutexLocker locker(&_mutex);
     
     LOG_INFO(QString("MessageService: sendMessage - Sender: %1, Receiver: %2, Type: %3, Content: %4")
@@ -162,6 +165,7 @@ QString MessageService::sendMessage(qint64 senderId, qint64 receiverId, MessageT
 
 QJsonArray MessageService::getChatHistory(qint64 userId1, qint64 userId2, int limit, int offset)
 {
+    TRACE_SPAN("MessageService::getChatHistory");
     QMutexLocker locker(&_mutex);
     
     LOG_INFO(QString("MessageService: getChatHistory - User1: %1, User2: %2, Limit: %3, Offset: %4")
@@ -239,6 +243,7 @@ QJsonArray MessageService::getChatHistory(qint64 userId1, qint64 userId2, int li
 
 QJsonArray MessageService::getChatSessions(qint64 userId)
 {
+    TRACE_SPAN("MessageService::getChatSessions");
     QMutexLocker locker(&_mutex);
     
     QJsonArray sessions;
@@ -292,6 +297,7 @@ QJsonArray MessageService::getChatSessions(qint64 userId)
 
 bool MessageService::markMessageAsRead(qint64 userId, const QString& messageId)
 {
+    TRACE_SPAN("MessageService::markMessageAsRead");
     QMutexLocker locker(&_mutex);
 
     // 使用RAII包装器自动管理数据库连接
@@ -430,6 +436,7 @@ int MessageService::getUnreadMessageCount(qint64 userId, qint64 fromUserId)
 
 QJsonArray MessageService::getOfflineMessages(qint64 userId)
 {
+    TRACE_SPAN("MessageService::getOfflineMessages");
     QMutexLocker locker(&_mutex);
 
 
@@ -726,6 +733,17 @@ bool MessageService::updateMessageStatus(const QString& messageId, DeliveryStatu
 
 bool MessageService::pushMessageToUser(qint64 userId, const QJsonObject& message)
 {
+    ThreadPoolServer* server = ThreadPoolServer::instance();
+    if (!server) {
+        LOG_ERROR("ThreadPoolServer instance not available for message push");
+        return false;
+    }
+
+    // 集群模式下，连接在其他节点上的用户以在线目录为准，本节点的状态缓存可能已过时
+    if (ClusterManager::instance()->isEnabled() && !server->isUserLocal(userId)) {
+        return server->sendMessageToUser(userId, message);
+    }
+
     // 检查用户是否在线
     OnlineStatusService* statusService = OnlineStatusService::instance();
     if (!statusService || !statusService->isUserOnline(userId)) {
@@ -733,12 +751,6 @@ bool MessageService::pushMessageToUser(qint64 userId, const QJsonObject& message
     }
 
     // 通过ThreadPoolServer发送消息
-    ThreadPoolServer* server = ThreadPoolServer::instance();
-    if (!server) {
-        LOG_ERROR("ThreadPoolServer instance not available for message push");
-        return false;
-    }
-
     return server->sendMessageToUser(userId, message);
 }
 
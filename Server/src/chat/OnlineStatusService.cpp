@@ -1,7 +1,9 @@
 #include "OnlineStatusService.h"
 #include "FriendService.h"
 #include "../database/DatabaseManager.h"
+#include "../database/RetentionScheduler.h"
 #include "../network/ThreadPoolServer.h"
+#include "../monitoring/Tracer.h"
 #include <QSqlRecord>
 #include <QVariant>
 
@@ -133,6 +135,7 @@ bool OnlineStatusService::userOffline(qint64 userId, const QString& clientId)
 
 bool OnlineStatusService::updateUserStatus(qint64 userId, OnlineStatus status, const QString& clientId)
 {
+    TRACE_SPAN("OnlineStatusService::updateUserStatus");
     QMutexLocker locker(&_mutex);
     
     // 获取当前状态
@@ -167,6 +170,7 @@ bool OnlineStatusService::updateUserStatus(qint64 userId, OnlineStatus status, c
 
 bool OnlineStatusService::updateHeartbeat(qint64 userId, const QString& clientId)
 {
+    TRACE_SPAN("OnlineStatusService::updateHeartbeat");
     QMutexLocker locker(&_mutex);
     
     LOG_INFO("=== 更新用户心跳 ===");
@@ -302,6 +306,7 @@ QMap<qint64, OnlineStatusService::UserStatusInfo> OnlineStatusService::getUsersS
 
 QJsonArray OnlineStatusService::getFriendsOnlineStatus(qint64 userId)
 {
+    TRACE_SPAN("OnlineStatusService::getFriendsOnlineStatus");
     QMutexLocker locker(&_mutex);
 
     QJsonArray friendsStatus;
@@ -412,6 +417,7 @@ bool OnlineStatusService::isUserOnline(qint64 userId)
 
 void OnlineStatusService::broadcastStatusToFriends(qint64 userId, OnlineStatus status)
 {
+    TRACE_SPAN("OnlineStatusService::broadcastStatusToFriends");
     // 获取用户好友列表
     QList<qint64> friends = getUserFriends(userId);
 
@@ -433,53 +439,94 @@ void OnlineStatusService::broadcastStatusToFriends(qint64 userId, OnlineStatus s
         return;
     }
 
-    for (qint64 friendId : friends) {
-        if (isUserOnline(friendId)) {
-            server->sendMessageToUser(friendId, statusMessage);
-        }
-    }
+    // 消息只编码一次，由所有好友连接共享；未连接到本节点的好友由服务器跳过。
+    // 状态消息走批量通道并以用户ID合并，接收方积压时只保留该好友的最新状态
+    RecipientList recipients(friends.begin(), friends.end());
+    server->sendMessageToUsers(recipients, statusMessage, OutboundLanes::BulkLane, userId);
 
     // 状态变更已广播
 }
 
 void OnlineStatusService::cleanupExpiredStatus()
 {
-    QMutexLocker locker(&_mutex);
+    // 数据库中的超时状态由保留任务分块置为离线，未启用时退回单条UPDATE
+    if (!RetentionScheduler::instance()->trigger("online_status")) {
+        DatabaseConnection dbConn;
+        if (!dbConn.isValid()) {
+            LOG_ERROR("Failed to acquire database connection for cleanup");
+            return;
+        }
 
-    // 使用RAII包装器自动管理数据库连接
-    DatabaseConnection dbConn;
-    if (!dbConn.isValid()) {
-        LOG_ERROR("Failed to acquire database connection for cleanup");
-        return;
+        // 将超时的用户状态设为离线
+        int affectedRows = dbConn.executeUpdate(
+            "UPDATE user_online_status SET status = 'offline' WHERE "
+            "status != 'offline' AND "
+            "last_seen < DATE_SUB(NOW(), INTERVAL ? SECOND)",
+            {HEARTBEAT_TIMEOUT}
+        );
+
+        if (affectedRows == -1) {
+            LOG_ERROR("Failed to cleanup expired status");
+            return;
+        }
     }
 
-    // 将超时的用户状态设为离线
-    int affectedRows = dbConn.executeUpdate(
-        "UPDATE user_online_status SET status = 'offline' WHERE "
-        "status != 'offline' AND "
-        "last_seen < DATE_SUB(NOW(), INTERVAL ? SECOND)",
-        {HEARTBEAT_TIMEOUT}
-    );
+    // 清理缓存中的过期状态
+    QMutexLocker locker(&_mutex);
+    QDateTime now = QDateTime::currentDateTime();
+    auto it = _userStatusCache.begin();
+    while (it != _userStatusCache.end()) {
+        if (it.value().lastSeen.secsTo(now) >= HEARTBEAT_TIMEOUT) {
+            it = _userStatusCache.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
 
-    if (affectedRows == -1) {
-        LOG_ERROR("Failed to cleanup expired status");
-        return;
+int OnlineStatusService::saveWarmState(QDataStream& out)
+{
+    QMutexLocker locker(&_mutex);
+
+    out << static_cast<quint32>(_userStatusCache.size());
+    for (auto it = _userStatusCache.constBegin(); it != _userStatusCache.constEnd(); ++it) {
+        const UserStatusInfo& info = it.value();
+        out << info.userId << static_cast<qint32>(info.status) << info.lastSeen
+            << info.clientId << info.deviceInfo << info.ipAddress;
     }
 
-    if (affectedRows > 0) {
-        // 清理过期状态记录完成
+    return _userStatusCache.size();
+}
 
-        // 清理缓存中的过期状态
-        QDateTime now = QDateTime::currentDateTime();
-        auto it = _userStatusCache.begin();
-        while (it != _userStatusCache.end()) {
-            if (it.value().lastSeen.secsTo(now) >= HEARTBEAT_TIMEOUT) {
-                it = _userStatusCache.erase(it);
-            } else {
-                ++it;
-            }
+int OnlineStatusService::restoreWarmState(QDataStream& in, qint64 savedAtSecs)
+{
+    Q_UNUSED(savedAtSecs)
+
+    QMutexLocker locker(&_mutex);
+
+    quint32 count = 0;
+    in >> count;
+
+    int restored = 0;
+    QDateTime now = QDateTime::currentDateTime();
+    for (quint32 i = 0; i < count && in.status() == QDataStream::Ok; ++i) {
+        UserStatusInfo info;
+        qint32 status = 0;
+        in >> info.userId >> status >> info.lastSeen
+           >> info.clientId >> info.deviceInfo >> info.ipAddress;
+        info.status = static_cast<OnlineStatus>(status);
+
+        // 与读取路径一致：超过心跳超时的缓存不再可信，跳过即可
+        if (in.status() != QDataStream::Ok || info.lastSeen.secsTo(now) >= HEARTBEAT_TIMEOUT
+            || _userStatusCache.contains(info.userId)) {
+            continue;
         }
+
+        _userStatusCache[info.userId] = info;
+        restored++;
     }
+
+    return restored;
 }
 
 QString OnlineStatusService::statusToString(OnlineStatus status)
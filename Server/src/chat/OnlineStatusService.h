@@ -10,6 +10,7 @@
 #include <QMutex>
 #include <QMap>
 #include <QDateTime>
+#include <QDataStream>
 #include "../utils/Logger.h"
 
 /**
@@ -137,6 +138,21 @@ public:
      */
     bool isUserOnline(qint64 userId);
 
+    // 热状态快照
+    static const quint32 WARM_STATE_VERSION = 1;
+
+    /**
+     * @brief 写出状态缓存快照
+     * @return 写出的条目数
+     */
+    int saveWarmState(QDataStream& out);
+
+    /**
+     * @brief 从快照恢复状态缓存，超过心跳超时的条目被丢弃
+     * @return 恢复的条目数
+     */
+    int restoreWarmState(QDataStream& in, qint64 savedAtSecs);
+
     /**
      * @brief 广播状态变化给好友
      * @param userId 用户ID
@@ -149,6 +165,11 @@ public:
      */
     void cleanupExpiredStatus();
 
+    /**
+     * @brief 心跳超时时间（秒），超过后状态被置为离线
+     */
+    static int heartbeatTimeoutSeconds() { return HEARTBEAT_TIMEOUT; }
+
     /**
      * @brief 处理用户上线后的离线消息推送
      * @param userId 用户ID
@@ -0,0 +1,428 @@
+#include "ClusterBus.h"
+#include "../utils/Logger.h"
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QDataStream>
+#include <QTimer>
+#include <QtEndian>
+
+namespace {
+
+// 总线消息的长度前缀
+const int MESSAGE_HEADER_SIZE = 4;
+
+// 单条总线消息的上限，超出时视为协议错误并断开
+const quint32 MAX_MESSAGE_BYTES = 64 * 1024 * 1024;
+
+const QDataStream::Version STREAM_VERSION = QDataStream::Qt_5_12;
+
+} // namespace
+
+ClusterBus::ClusterBus(QObject *parent)
+    : QObject(parent)
+    , _server(nullptr)
+    , _queuedFrames(0)
+    , _flushScheduled(false)
+    , _framesSent(0)
+    , _batchesSent(0)
+    , _bytesSent(0)
+    , _framesReceived(0)
+    , _batchesReceived(0)
+    , _recipientsDelivered(0)
+    , _recipientsMissed(0)
+    , _framesDropped(0)
+    , _connectFailures(0)
+    , _rejectedConnections(0)
+{
+}
+
+ClusterBus::~ClusterBus()
+{
+    qDeleteAll(_peers);
+}
+
+void ClusterBus::configure(const Config &config)
+{
+    QMutexLocker locker(&_queueMutex);
+    _config = config;
+    _config.batchMaxFrames = qMax(1, _config.batchMaxFrames);
+    _config.batchFlushMs = qMax(0, _config.batchFlushMs);
+}
+
+void ClusterBus::setAddressResolver(const AddressResolver &resolver)
+{
+    _resolver = resolver;
+}
+
+void ClusterBus::setDeliveryHandler(const DeliveryHandler &handler)
+{
+    _delivery = handler;
+}
+
+bool ClusterBus::listen(const QHostAddress &address, quint16 port)
+{
+    if (!_server) {
+        _server = new QTcpServer(this);
+        connect(_server, &QTcpServer::newConnection, this, &ClusterBus::onNewConnection);
+    }
+
+    if (!_server->listen(address, port)) {
+        LOG_ERROR(QString("Cluster bus failed to listen on %1:%2: %3")
+                  .arg(address.toString()).arg(port).arg(_server->errorString()));
+        return false;
+    }
+
+    LOG_INFO(QString("Cluster bus listening on %1:%2").arg(address.toString()).arg(port));
+    return true;
+}
+
+void ClusterBus::stop()
+{
+    if (_server) {
+        _server->close();
+    }
+
+    for (Peer *peer : _peers) {
+        _framesDropped.fetchAndAddOrdered(peer->backlog.size());
+        dropPeerSocket(peer);
+    }
+    qDeleteAll(_peers);
+    _peers.clear();
+
+    const QList<QTcpSocket*> sockets = _inbound.keys();
+    _inbound.clear();
+    for (QTcpSocket *socket : sockets) {
+        socket->disconnect(this);
+        socket->abort();
+        socket->deleteLater();
+    }
+
+    QMutexLocker locker(&_queueMutex);
+    _framesDropped.fetchAndAddOrdered(_queuedFrames);
+    _queues.clear();
+    _queuedFrames = 0;
+}
+
+void ClusterBus::enqueue(const QString &nodeId, const Entry &entry)
+{
+    bool flushNow = false;
+    bool scheduleFlush = false;
+    int flushMs = 0;
+
+    {
+        QMutexLocker locker(&_queueMutex);
+        _queues[nodeId].append(entry);
+        _queuedFrames++;
+
+        // 达到批次上限时立即发送，否则等待刷新间隔以便合并同一时段的帧
+        if (_queuedFrames == _config.batchMaxFrames) {
+            flushNow = true;
+        } else if (!_flushScheduled) {
+            _flushScheduled = true;
+            scheduleFlush = true;
+            flushMs = _config.batchFlushMs;
+        }
+    }
+
+    if (flushNow) {
+        QMetaObject::invokeMethod(this, &ClusterBus::flush, Qt::QueuedConnection);
+    } else if (scheduleFlush) {
+        QMetaObject::invokeMethod(this, [this, flushMs]() {
+            QTimer::singleShot(flushMs, this, &ClusterBus::flush);
+        }, Qt::QueuedConnection);
+    }
+}
+
+void ClusterBus::flush()
+{
+    QHash<QString, QList<Entry>> queues;
+    {
+        QMutexLocker locker(&_queueMutex);
+        queues.swap(_queues);
+        _queuedFrames = 0;
+        _flushScheduled = false;
+    }
+
+    for (auto it = queues.begin(); it != queues.end(); ++it) {
+        Peer *peer = peerFor(it.key());
+        if (peer->socket && peer->socket->state() == QAbstractSocket::ConnectedState) {
+            writeEntries(peer, it.value());
+        } else {
+            appendBacklog(peer, it.value());
+            connectPeer(peer);
+        }
+    }
+}
+
+ClusterBus::Peer* ClusterBus::peerFor(const QString &nodeId)
+{
+    Peer *peer = _peers.value(nodeId, nullptr);
+    if (!peer) {
+        peer = new Peer();
+        peer->nodeId = nodeId;
+        _peers.insert(nodeId, peer);
+    }
+    return peer;
+}
+
+bool ClusterBus::connectPeer(Peer *peer)
+{
+    if (peer->socket) {
+        // 连接中，积压的条目在连接建立后发送
+        return true;
+    }
+
+    if (peer->retryClock.isValid() && peer->retryClock.elapsed() < _config.reconnectIntervalMs) {
+        return false;
+    }
+
+    QString address = _resolver ? _resolver(peer->nodeId) : QString();
+    int separator = address.lastIndexOf(':');
+    quint16 port = separator > 0 ? address.mid(separator + 1).toUShort() : 0;
+    if (port == 0) {
+        // 节点已不在目录中（下线或租约过期），积压的帧无法投递
+        LOG_WARNING(QString("Cluster node %1 has no registered address, dropping %2 frames")
+                    .arg(peer->nodeId).arg(peer->backlog.size()));
+        _framesDropped.fetchAndAddOrdered(peer->backlog.size());
+        peer->backlog.clear();
+        peer->retryClock.start();
+        return false;
+    }
+
+    QString nodeId = peer->nodeId;
+    QTcpSocket *socket = new QTcpSocket(this);
+    peer->socket = socket;
+
+    connect(socket, &QTcpSocket::connected, this, [this, nodeId, socket]() {
+        Peer *peer = _peers.value(nodeId, nullptr);
+        if (!peer || peer->socket != socket) {
+            return;
+        }
+        socket->setSocketOption(QAbstractSocket::LowDelayOption, 1);
+
+        QByteArray hello;
+        QDataStream out(&hello, QIODevice::WriteOnly);
+        out.setVersion(STREAM_VERSION);
+        out << static_cast<quint8>(HelloMessage) << _config.nodeId << _config.secret;
+        socket->write(frameMessage(hello));
+
+        QList<Entry> backlog;
+        backlog.swap(peer->backlog);
+        writeEntries(peer, backlog);
+        LOG_INFO(QString("Cluster bus connected to node %1").arg(nodeId));
+    });
+
+    auto onLost = [this, nodeId, socket]() {
+        Peer *peer = _peers.value(nodeId, nullptr);
+        if (!peer || peer->socket != socket) {
+            return;
+        }
+        LOG_WARNING(QString("Cluster bus link to node %1 lost: %2").arg(nodeId).arg(socket->errorString()));
+        _connectFailures.fetchAndAddOrdered(1);
+        dropPeerSocket(peer);
+
+        // 仍有积压时到期重试
+        QTimer::singleShot(_config.reconnectIntervalMs, this, [this, nodeId]() {
+            Peer *peer = _peers.value(nodeId, nullptr);
+            if (peer && !peer->backlog.isEmpty()) {
+                peer->retryClock.invalidate();
+                connectPeer(peer);
+            }
+        });
+    };
+    connect(socket, &QTcpSocket::disconnected, this, onLost);
+    connect(socket, QOverload<QAbstractSocket::SocketError>::of(&QTcpSocket::errorOccurred), this, onLost);
+
+    socket->connectToHost(address.left(separator), port);
+    return true;
+}
+
+void ClusterBus::dropPeerSocket(Peer *peer)
+{
+    if (!peer->socket) {
+        return;
+    }
+
+    QTcpSocket *socket = peer->socket;
+    peer->socket = nullptr;
+    peer->retryClock.start();
+    socket->disconnect(this);
+    socket->abort();
+    socket->deleteLater();
+}
+
+void ClusterBus::writeEntries(Peer *peer, const QList<Entry> &entries)
+{
+    for (int start = 0; start < entries.size(); start += _config.batchMaxFrames) {
+        int end = qMin(entries.size(), start + _config.batchMaxFrames);
+
+        QByteArray payload;
+        QDataStream out(&payload, QIODevice::WriteOnly);
+        out.setVersion(STREAM_VERSION);
+        out << static_cast<quint8>(BatchMessage) << static_cast<quint32>(end - start);
+        for (int i = start; i < end; ++i) {
+            const Entry &entry = entries.at(i);
+            out << static_cast<quint8>(entry.lane) << entry.coalesceKey << entry.userIds << entry.frame.data();
+        }
+
+        QByteArray message = frameMessage(payload);
+        peer->socket->write(message);
+
+        _framesSent.fetchAndAddOrdered(end - start);
+        _batchesSent.fetchAndAddOrdered(1);
+        _bytesSent.fetchAndAddOrdered(message.size());
+    }
+}
+
+void ClusterBus::appendBacklog(Peer *peer, const QList<Entry> &entries)
+{
+    peer->backlog.append(entries);
+
+    int overflow = peer->backlog.size() - _config.maxPendingFrames;
+    if (overflow > 0) {
+        peer->backlog.erase(peer->backlog.begin(), peer->backlog.begin() + overflow);
+        _framesDropped.fetchAndAddOrdered(overflow);
+    }
+}
+
+void ClusterBus::onNewConnection()
+{
+    while (_server->hasPendingConnections()) {
+        QTcpSocket *socket = _server->nextPendingConnection();
+        socket->setSocketOption(QAbstractSocket::LowDelayOption, 1);
+        _inbound.insert(socket, Inbound());
+
+        connect(socket, &QTcpSocket::readyRead, this, [this, socket]() {
+            onInboundReadable(socket);
+        });
+        connect(socket, &QTcpSocket::disconnected, this, [this, socket]() {
+            _inbound.remove(socket);
+            socket->deleteLater();
+        });
+    }
+}
+
+void ClusterBus::onInboundReadable(QTcpSocket *socket)
+{
+    auto it = _inbound.find(socket);
+    if (it == _inbound.end()) {
+        return;
+    }
+
+    Inbound &inbound = it.value();
+    inbound.buffer += socket->readAll();
+
+    int offset = 0;
+    bool valid = true;
+    while (inbound.buffer.size() - offset >= MESSAGE_HEADER_SIZE) {
+        quint32 length = qFromBigEndian<quint32>(inbound.buffer.constData() + offset);
+        if (length > MAX_MESSAGE_BYTES) {
+            valid = false;
+            break;
+        }
+        if (inbound.buffer.size() - offset - MESSAGE_HEADER_SIZE < static_cast<int>(length)) {
+            break;
+        }
+
+        QByteArray payload = inbound.buffer.mid(offset + MESSAGE_HEADER_SIZE, length);
+        offset += MESSAGE_HEADER_SIZE + length;
+        if (!processMessage(inbound, payload)) {
+            valid = false;
+            break;
+        }
+    }
+
+    if (!valid) {
+        LOG_WARNING(QString("Rejecting cluster bus connection from %1").arg(socket->peerAddress().toString()));
+        _rejectedConnections.fetchAndAddOrdered(1);
+        _inbound.erase(it);
+        socket->disconnect(this);
+        socket->abort();
+        socket->deleteLater();
+        return;
+    }
+
+    inbound.buffer.remove(0, offset);
+}
+
+bool ClusterBus::processMessage(Inbound &inbound, const QByteArray &payload)
+{
+    QDataStream in(payload);
+    in.setVersion(STREAM_VERSION);
+
+    quint8 kind = 0;
+    in >> kind;
+
+    if (kind == HelloMessage) {
+        QString nodeId;
+        QString secret;
+        in >> nodeId >> secret;
+        if (in.status() != QDataStream::Ok || (!_config.secret.isEmpty() && secret != _config.secret)) {
+            return false;
+        }
+        inbound.authenticated = true;
+        inbound.nodeId = nodeId;
+        return true;
+    }
+
+    if (kind != BatchMessage || !inbound.authenticated) {
+        return false;
+    }
+
+    quint32 count = 0;
+    in >> count;
+    _batchesReceived.fetchAndAddOrdered(1);
+
+    for (quint32 i = 0; i < count; ++i) {
+        quint8 lane = 0;
+        qint64 coalesceKey = -1;
+        RecipientList userIds;
+        QByteArray data;
+        in >> lane >> coalesceKey >> userIds >> data;
+        if (in.status() != QDataStream::Ok || lane >= OutboundLanes::LaneCount) {
+            return false;
+        }
+
+        _framesReceived.fetchAndAddOrdered(1);
+        EncodedFrame frame = EncodedFrame::fromData(data);
+        if (frame.isEmpty()) {
+            continue;
+        }
+
+        // 只投递本节点连接，不再转发
+        int delivered = _delivery ? _delivery(userIds, frame, static_cast<OutboundLanes::Lane>(lane), coalesceKey) : 0;
+        _recipientsDelivered.fetchAndAddOrdered(delivered);
+        _recipientsMissed.fetchAndAddOrdered(userIds.size() - delivered);
+    }
+
+    return true;
+}
+
+QByteArray ClusterBus::frameMessage(const QByteArray &payload)
+{
+    QByteArray message(MESSAGE_HEADER_SIZE, Qt::Uninitialized);
+    qToBigEndian<quint32>(static_cast<quint32>(payload.size()), message.data());
+    message += payload;
+    return message;
+}
+
+QJsonObject ClusterBus::getStatistics() const
+{
+    QJsonObject stats;
+    stats["frames_sent"] = _framesSent.loadAcquire();
+    stats["batches_sent"] = _batchesSent.loadAcquire();
+    stats["bytes_sent"] = _bytesSent.loadAcquire();
+    qint64 batches = _batchesSent.loadAcquire();
+    stats["frames_per_batch"] = batches > 0 ? static_cast<double>(_framesSent.loadAcquire()) / batches : 0.0;
+    stats["frames_received"] = _framesReceived.loadAcquire();
+    stats["batches_received"] = _batchesReceived.loadAcquire();
+    stats["recipients_delivered"] = _recipientsDelivered.loadAcquire();
+    stats["recipients_missed"] = _recipientsMissed.loadAcquire();
+    stats["frames_dropped"] = _framesDropped.loadAcquire();
+    stats["connect_failures"] = _connectFailures.loadAcquire();
+    stats["rejected_connections"] = _rejectedConnections.loadAcquire();
+
+    QMutexLocker locker(&_queueMutex);
+    stats["queued_frames"] = _queuedFrames;
+    return stats;
+}
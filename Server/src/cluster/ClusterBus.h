@@ -0,0 +1,158 @@
+#ifndef CLUSTERBUS_H
+#define CLUSTERBUS_H
+
+#include <QObject>
+#include <QHash>
+#include <QList>
+#include <QMutex>
+#include <QAtomicInteger>
+#include <QElapsedTimer>
+#include <QJsonObject>
+#include <QHostAddress>
+#include <functional>
+#include "../network/EncodedFrame.h"
+#include "../network/OutboundLanes.h"
+
+class QTcpServer;
+class QTcpSocket;
+
+/**
+ * @brief 节点间投递总线
+ *
+ * 每个节点监听一个集群端口，向其他节点维持一条持久TCP连接（按需建立，断开后重连）。
+ * 转发的帧按目标节点排队，批量写出：同一批次内的多个帧合并为一条总线消息，
+ * 批次在达到帧数上限或刷新间隔到期时发送。总线消息格式为4字节大端长度前缀加QDataStream负载，
+ * 每个条目携带出站通道、合并键、接收者列表和已编码的客户端帧，接收端不再重新序列化。
+ *
+ * 接收端只向本节点的连接投递，不再转发，因此目录短暂不一致时也不会出现转发环路。
+ * 入站连接须先发送携带共享密钥的握手消息。对象及其套接字归属集群线程，enqueue可在任意线程调用。
+ */
+class ClusterBus : public QObject
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @brief 总线配置
+     */
+    struct Config {
+        QString nodeId;
+        QString secret;                   // 节点间共享密钥，为空时不校验
+        int batchMaxFrames = 256;         // 单个批次的最大帧数，达到时立即发送
+        int batchFlushMs = 2;             // 批次的最长等待时间
+        int maxPendingFrames = 20000;     // 单个节点在连接建立前的积压上限，超出时丢弃最旧的帧
+        int reconnectIntervalMs = 1000;   // 连接失败后的重试间隔
+    };
+
+    /**
+     * @brief 转发条目
+     */
+    struct Entry {
+        RecipientList userIds;
+        EncodedFrame frame;
+        OutboundLanes::Lane lane = OutboundLanes::ChatLane;
+        qint64 coalesceKey = -1;
+    };
+
+    /**
+     * @brief 解析节点地址，返回"host:port"，未知节点返回空字符串（在集群线程中调用）
+     */
+    using AddressResolver = std::function<QString(const QString &nodeId)>;
+
+    /**
+     * @brief 投递到本节点连接，返回成功投递的用户数（在集群线程中调用）
+     */
+    using DeliveryHandler = std::function<int(const RecipientList &userIds, const EncodedFrame &frame,
+                                              OutboundLanes::Lane lane, qint64 coalesceKey)>;
+
+    explicit ClusterBus(QObject *parent = nullptr);
+    ~ClusterBus();
+
+    void configure(const Config &config);
+    void setAddressResolver(const AddressResolver &resolver);
+    void setDeliveryHandler(const DeliveryHandler &handler);
+
+    /**
+     * @brief 开始监听集群端口（在集群线程中调用）
+     */
+    bool listen(const QHostAddress &address, quint16 port);
+
+    /**
+     * @brief 关闭所有连接并丢弃积压（在集群线程中调用）
+     */
+    void stop();
+
+    /**
+     * @brief 将条目加入目标节点的发送队列（线程安全）
+     */
+    void enqueue(const QString &nodeId, const Entry &entry);
+
+    QJsonObject getStatistics() const;
+
+private slots:
+    void flush();
+    void onNewConnection();
+
+private:
+    enum MessageKind : quint8 {
+        HelloMessage = 1,
+        BatchMessage = 2
+    };
+
+    /**
+     * @brief 到其他节点的出站连接
+     */
+    struct Peer {
+        QString nodeId;
+        QTcpSocket *socket = nullptr;
+        QList<Entry> backlog;             // 连接建立前积压的条目
+        QElapsedTimer retryClock;         // 上次连接失败的时刻
+    };
+
+    /**
+     * @brief 入站连接的接收状态
+     */
+    struct Inbound {
+        QByteArray buffer;
+        bool authenticated = false;
+        QString nodeId;
+    };
+
+    Peer *peerFor(const QString &nodeId);
+    bool connectPeer(Peer *peer);
+    void dropPeerSocket(Peer *peer);
+    void writeEntries(Peer *peer, const QList<Entry> &entries);
+    void appendBacklog(Peer *peer, const QList<Entry> &entries);
+    void onInboundReadable(QTcpSocket *socket);
+    bool processMessage(Inbound &inbound, const QByteArray &payload);
+
+    static QByteArray frameMessage(const QByteArray &payload);
+
+    Config _config;
+    AddressResolver _resolver;
+    DeliveryHandler _delivery;
+
+    QTcpServer *_server;
+    QHash<QString, Peer*> _peers;
+    QHash<QTcpSocket*, Inbound> _inbound;
+
+    // 跨线程发送队列
+    mutable QMutex _queueMutex;
+    QHash<QString, QList<Entry>> _queues;
+    int _queuedFrames;
+    bool _flushScheduled;
+
+    // 统计信息
+    QAtomicInteger<qint64> _framesSent;
+    QAtomicInteger<qint64> _batchesSent;
+    QAtomicInteger<qint64> _bytesSent;
+    QAtomicInteger<qint64> _framesReceived;
+    QAtomicInteger<qint64> _batchesReceived;
+    QAtomicInteger<qint64> _recipientsDelivered;
+    QAtomicInteger<qint64> _recipientsMissed;
+    QAtomicInteger<qint64> _framesDropped;
+    QAtomicInteger<qint64> _connectFailures;
+    QAtomicInteger<qint64> _rejectedConnections;
+};
+
+#endif // CLUSTERBUS_H
@@ -0,0 +1,474 @@
+#include "ClusterManager.h"
+#include "../database/RedisKeys.h"
+#include "../network/ThreadPoolServer.h"
+#include "../monitoring/EventLoopMonitor.h"
+#include "../utils/Logger.h"
+#include <QThread>
+#include <QTimer>
+#include <QHostInfo>
+#include <QCoreApplication>
+
+// 静态成员初始化
+ClusterManager* ClusterManager::s_instance = nullptr;
+QMutex ClusterManager::s_instanceMutex;
+
+namespace {
+
+// 目录项仍指向本节点时才删除，避免删掉用户在其他节点上的新会话
+const char COMPARE_AND_DELETE_SCRIPT[] =
+    "if redis.call('GET', KEYS[1]) == ARGV[1] then return redis.call('DEL', KEYS[1]) end return 0";
+
+// 单次流水线的命令数
+const int PIPELINE_CHUNK_SIZE = 1000;
+
+// 查询缓存的清理间隔
+const qint64 CACHE_PRUNE_INTERVAL_MS = 10000;
+
+} // namespace
+
+ClusterManager::ClusterManager(QObject *parent)
+    : QObject(parent)
+    , _running(0)
+    , _thread(nullptr)
+    , _context(nullptr)
+    , _leaseTimer(nullptr)
+    , _bus(nullptr)
+    , _redis(nullptr)
+    , _presenceScheduled(false)
+    , _lastCachePruneMs(0)
+    , _forwardedFrames(0)
+    , _forwardedRecipients(0)
+    , _remoteOffline(0)
+    , _lookups(0)
+    , _lookupCacheHits(0)
+    , _redisErrors(0)
+    , _presenceWrites(0)
+    , _leaseRenewals(0)
+{
+    _clock.start();
+}
+
+ClusterManager::~ClusterManager()
+{
+    shutdown();
+}
+
+ClusterManager* ClusterManager::instance()
+{
+    if (!s_instance) {
+        QMutexLocker locker(&s_instanceMutex);
+        if (!s_instance) {
+            s_instance = new ClusterManager();
+        }
+    }
+    return s_instance;
+}
+
+void ClusterManager::configure(const Config &config)
+{
+    QMutexLocker locker(&_mutex);
+    _config = config;
+}
+
+QString ClusterManager::nodeId() const
+{
+    QMutexLocker locker(&_mutex);
+    return _nodeId;
+}
+
+bool ClusterManager::start()
+{
+    Config config;
+    {
+        QMutexLocker locker(&_mutex);
+        config = _config;
+        if (!config.enabled || _thread) {
+            return true;
+        }
+        _nodeId = config.nodeId.isEmpty()
+            ? QString("%1-%2").arg(QHostInfo::localHostName()).arg(QCoreApplication::applicationPid())
+            : config.nodeId;
+        _nodeIdBytes = _nodeId.toUtf8();
+    }
+
+    // 路由器在关闭后仍可能被其他线程使用，保留到进程退出
+    if (!_redis) {
+        _redis = new RedisRouter(config.redis);
+    }
+    if (!_redis->connect()) {
+        LOG_ERROR(QString("Cluster mode requires Redis (%1)").arg(RedisRouter::modeToString(config.redis.mode)));
+        return false;
+    }
+
+    ClusterBus::Config busConfig;
+    busConfig.nodeId = _nodeId;
+    busConfig.secret = config.busSecret;
+    busConfig.batchMaxFrames = config.batchMaxFrames;
+    busConfig.batchFlushMs = config.batchFlushMs;
+    busConfig.maxPendingFrames = config.maxPendingFrames;
+
+    _bus = new ClusterBus();
+    _bus->configure(busConfig);
+    _bus->setAddressResolver([this](const QString &nodeId) {
+        return resolveNodeAddress(nodeId);
+    });
+    _bus->setDeliveryHandler([](const RecipientList &userIds, const EncodedFrame &frame,
+                                OutboundLanes::Lane lane, qint64 coalesceKey) {
+        ThreadPoolServer* server = ThreadPoolServer::instance();
+        return server ? server->deliverLocalFrame(userIds, frame, lane, coalesceKey) : 0;
+    });
+
+    _context = new QObject();
+    _leaseTimer = new QTimer();
+    _leaseTimer->setInterval(qMax(1000, config.leaseRenewMs));
+
+    _thread = new QThread();
+    _thread->setObjectName("ClusterBus");
+    _bus->moveToThread(_thread);
+    _context->moveToThread(_thread);
+    _leaseTimer->moveToThread(_thread);
+    connect(_leaseTimer, &QTimer::timeout, _context, [this]() {
+        renewLeases();
+    });
+    _thread->start();
+
+    bool listening = false;
+    QMetaObject::invokeMethod(_context, [this, config, &listening]() {
+        listening = _bus->listen(QHostAddress(config.busHost), static_cast<quint16>(config.busPort));
+        if (listening) {
+            // 先登记本节点地址，其他节点才能建立连接
+            renewLeases();
+            _leaseTimer->start();
+        }
+    }, Qt::BlockingQueuedConnection);
+
+    if (!listening) {
+        _thread->quit();
+        _thread->wait();
+        delete _leaseTimer;
+        delete _context;
+        delete _bus;
+        delete _thread;
+        _leaseTimer = nullptr;
+        _context = nullptr;
+        _bus = nullptr;
+        _thread = nullptr;
+        return false;
+    }
+
+    EventLoopMonitor::instance()->registerThread(_thread, "cluster");
+    _running.storeRelease(1);
+
+    LOG_INFO(QString("Cluster mode enabled, node %1").arg(_nodeId));
+    return true;
+}
+
+void ClusterManager::shutdown()
+{
+    if (!_thread || !_running.testAndSetOrdered(1, 0)) {
+        return;
+    }
+
+    // 服务器停止前执行：本地用户的目录项和节点地址在此删除，不必等待租约过期
+    QMetaObject::invokeMethod(_context, [this]() {
+        _leaseTimer->stop();
+        applyPresenceChanges();
+
+        ThreadPoolServer* server = ThreadPoolServer::instance();
+        QList<qint64> users = server ? server->localUserIds() : QList<qint64>();
+
+        QList<QList<QByteArray>> commands;
+        commands.append({"DEL", nodeKey(_nodeId)});
+        for (qint64 userId : users) {
+            commands.append({"EVAL", COMPARE_AND_DELETE_SCRIPT, "1", presenceKey(userId), _nodeIdBytes});
+            if (commands.size() >= PIPELINE_CHUNK_SIZE) {
+                _redis->pipeline(commands);
+                commands.clear();
+            }
+        }
+        _redis->pipeline(commands);
+
+        _bus->stop();
+    }, Qt::BlockingQueuedConnection);
+
+    EventLoopMonitor::instance()->unregisterThread(_thread);
+    _thread->quit();
+    _thread->wait();
+
+    // 其他线程可能仍持有总线指针，对象保留到进程退出
+    LOG_INFO(QString("Cluster node %1 left the cluster").arg(_nodeId));
+}
+
+QByteArray ClusterManager::presenceKey(qint64 userId)
+{
+    return RedisKeys::userKey(userId, "presence").toUtf8();
+}
+
+QByteArray ClusterManager::nodeKey(const QString &nodeId)
+{
+    return RedisKeys::nodeKey(nodeId, "bus").toUtf8();
+}
+
+void ClusterManager::onUserLoggedIn(qint64 userId)
+{
+    if (!isEnabled()) {
+        return;
+    }
+
+    {
+        QMutexLocker locker(&_cacheMutex);
+        _ownerCache.remove(userId);
+    }
+
+    bool schedule = false;
+    {
+        QMutexLocker locker(&_mutex);
+        _presenceChanges.append(qMakePair(userId, true));
+        schedule = !_presenceScheduled;
+        _presenceScheduled = true;
+    }
+
+    if (schedule) {
+        QMetaObject::invokeMethod(_context, [this]() {
+            applyPresenceChanges();
+        }, Qt::QueuedConnection);
+    }
+}
+
+void ClusterManager::onUserLoggedOut(qint64 userId)
+{
+    if (!isEnabled()) {
+        return;
+    }
+
+    bool schedule = false;
+    {
+        QMutexLocker locker(&_mutex);
+        _presenceChanges.append(qMakePair(userId, false));
+        schedule = !_presenceScheduled;
+        _presenceScheduled = true;
+    }
+
+    if (schedule) {
+        QMetaObject::invokeMethod(_context, [this]() {
+            applyPresenceChanges();
+        }, Qt::QueuedConnection);
+    }
+}
+
+void ClusterManager::applyPresenceChanges()
+{
+    QList<QPair<qint64, bool>> changes;
+    int ttl = 0;
+    {
+        QMutexLocker locker(&_mutex);
+        changes.swap(_presenceChanges);
+        _presenceScheduled = false;
+        ttl = _config.presenceTtlSec;
+    }
+    if (changes.isEmpty()) {
+        return;
+    }
+
+    ThreadPoolServer* server = ThreadPoolServer::instance();
+    QList<QList<QByteArray>> commands;
+    for (const QPair<qint64, bool> &change : changes) {
+        if (change.second) {
+            commands.append({"SET", presenceKey(change.first), _nodeIdBytes, "EX", QByteArray::number(ttl)});
+        } else if (!server || !server->isUserLocal(change.first)) {
+            // 被同一节点上的新会话替换时仍然在线，不删除
+            commands.append({"EVAL", COMPARE_AND_DELETE_SCRIPT, "1", presenceKey(change.first), _nodeIdBytes});
+        }
+    }
+
+    for (const RedisReply &reply : _redis->pipeline(commands)) {
+        if (!reply.isOk()) {
+            _redisErrors.fetchAndAddOrdered(1);
+        }
+    }
+    _presenceWrites.fetchAndAddOrdered(commands.size());
+}
+
+void ClusterManager::renewLeases()
+{
+    QString address;
+    int ttl = 0;
+    {
+        QMutexLocker locker(&_mutex);
+        QString host = _config.advertiseHost.isEmpty() ? QHostInfo::localHostName() : _config.advertiseHost;
+        address = QString("%1:%2").arg(host).arg(_config.busPort);
+        ttl = _config.presenceTtlSec;
+    }
+
+    ThreadPoolServer* server = ThreadPoolServer::instance();
+    QList<qint64> users = server ? server->localUserIds() : QList<qint64>();
+    QByteArray ttlBytes = QByteArray::number(ttl);
+
+    QList<QList<QByteArray>> commands;
+    commands.append({"SET", nodeKey(_nodeId), address.toUtf8(), "EX", ttlBytes});
+    for (qint64 userId : users) {
+        commands.append({"SET", presenceKey(userId), _nodeIdBytes, "EX", ttlBytes});
+        if (commands.size() >= PIPELINE_CHUNK_SIZE) {
+            for (const RedisReply &reply : _redis->pipeline(commands)) {
+                if (!reply.isOk()) {
+                    _redisErrors.fetchAndAddOrdered(1);
+                }
+            }
+            commands.clear();
+        }
+    }
+    for (const RedisReply &reply : _redis->pipeline(commands)) {
+        if (!reply.isOk()) {
+            _redisErrors.fetchAndAddOrdered(1);
+        }
+    }
+
+    _leaseRenewals.fetchAndAddOrdered(users.size());
+}
+
+QString ClusterManager::resolveNodeAddress(const QString &nodeId)
+{
+    RedisReply reply = _redis->command({"GET", nodeKey(nodeId)});
+    if (!reply.isOk()) {
+        _redisErrors.fetchAndAddOrdered(1);
+    }
+    return reply.type == RedisReply::Bulk ? QString::fromUtf8(reply.str) : QString();
+}
+
+QHash<qint64, QString> ClusterManager::resolveOwners(const RecipientList &userIds)
+{
+    QHash<qint64, QString> owners;
+    RecipientList misses;
+    qint64 nowMs = _clock.elapsed();
+
+    {
+        QMutexLocker locker(&_cacheMutex);
+        for (qint64 userId : userIds) {
+            auto it = _ownerCache.constFind(userId);
+            if (it != _ownerCache.constEnd() && it->expiresAtMs > nowMs) {
+                owners.insert(userId, it->nodeId);
+                _lookupCacheHits.fetchAndAddOrdered(1);
+            } else {
+                misses.append(userId);
+            }
+        }
+    }
+
+    if (misses.isEmpty()) {
+        return owners;
+    }
+
+    // 所有未命中的用户在一次往返中查询（Cluster模式下每个节点一次往返）
+    QList<QByteArray> keys;
+    keys.reserve(misses.size());
+    for (qint64 userId : misses) {
+        keys.append(presenceKey(userId));
+    }
+    QList<RedisReply> replies = _redis->getMany(keys);
+    _lookups.fetchAndAddOrdered(misses.size());
+
+    int cacheMs = 0;
+    {
+        QMutexLocker locker(&_mutex);
+        cacheMs = _config.lookupCacheMs;
+    }
+
+    QMutexLocker locker(&_cacheMutex);
+    for (int i = 0; i < replies.size() && i < misses.size(); ++i) {
+        const RedisReply &reply = replies.at(i);
+        if (reply.type != RedisReply::Bulk) {
+            // 目录不可用时按离线处理，消息进入离线队列
+            if (!reply.isNil()) {
+                _redisErrors.fetchAndAddOrdered(1);
+            }
+            continue;
+        }
+        qint64 userId = misses.at(i);
+        QString owner = QString::fromUtf8(reply.str);
+        owners.insert(userId, owner);
+
+        // 只缓存在线结果，刚上线的用户不会因缓存被判为离线
+        if (cacheMs > 0) {
+            CachedOwner &cached = _ownerCache[userId];
+            cached.nodeId = owner;
+            cached.expiresAtMs = nowMs + cacheMs;
+        }
+    }
+
+    if (nowMs - _lastCachePruneMs >= CACHE_PRUNE_INTERVAL_MS) {
+        _lastCachePruneMs = nowMs;
+        for (auto it = _ownerCache.begin(); it != _ownerCache.end();) {
+            if (it->expiresAtMs <= nowMs) {
+                it = _ownerCache.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+
+    return owners;
+}
+
+int ClusterManager::forward(const RecipientList &userIds, const EncodedFrame &frame,
+                            OutboundLanes::Lane lane, qint64 coalesceKey)
+{
+    if (!isEnabled() || userIds.isEmpty() || frame.isEmpty()) {
+        return 0;
+    }
+
+    QHash<qint64, QString> owners = resolveOwners(userIds);
+
+    QHash<QString, RecipientList> byNode;
+    for (qint64 userId : userIds) {
+        auto it = owners.constFind(userId);
+        if (it == owners.constEnd() || it.value() == _nodeId) {
+            _remoteOffline.fetchAndAddOrdered(1);
+            continue;
+        }
+        byNode[it.value()].append(userId);
+    }
+
+    int forwarded = 0;
+    for (auto it = byNode.constBegin(); it != byNode.constEnd(); ++it) {
+        ClusterBus::Entry entry;
+        entry.userIds = it.value();
+        entry.frame = frame;
+        entry.lane = lane;
+        entry.coalesceKey = coalesceKey;
+        _bus->enqueue(it.key(), entry);
+
+        forwarded += it.value().size();
+        _forwardedFrames.fetchAndAddOrdered(1);
+    }
+    _forwardedRecipients.fetchAndAddOrdered(forwarded);
+
+    return forwarded;
+}
+
+QJsonObject ClusterManager::getStatistics() const
+{
+    QJsonObject stats;
+    stats["enabled"] = isEnabled();
+    stats["node_id"] = nodeId();
+    stats["forwarded_frames"] = _forwardedFrames.loadAcquire();
+    stats["forwarded_recipients"] = _forwardedRecipients.loadAcquire();
+    stats["remote_offline"] = _remoteOffline.loadAcquire();
+    stats["directory_lookups"] = _lookups.loadAcquire();
+    stats["lookup_cache_hits"] = _lookupCacheHits.loadAcquire();
+    stats["redis_errors"] = _redisErrors.loadAcquire();
+    stats["presence_writes"] = _presenceWrites.loadAcquire();
+    stats["lease_renewals"] = _leaseRenewals.loadAcquire();
+
+    {
+        QMutexLocker locker(&_cacheMutex);
+        stats["cached_owners"] = _ownerCache.size();
+    }
+
+    if (_bus) {
+        stats["bus"] = _bus->getStatistics();
+    }
+    if (_redis) {
+        stats["redis"] = _redis->getStatistics();
+    }
+    return stats;
+}
@@ -0,0 +1,165 @@
+#ifndef CLUSTERMANAGER_H
+#define CLUSTERMANAGER_H
+
+#include <QObject>
+#include <QHash>
+#include <QList>
+#include <QPair>
+#include <QMutex>
+#include <QAtomicInt>
+#include <QAtomicInteger>
+#include <QElapsedTimer>
+#include <QJsonObject>
+#include "ClusterBus.h"
+#include "../database/RedisRouter.h"
+#include "../network/EncodedFrame.h"
+#include "../network/OutboundLanes.h"
+
+class QThread;
+class QTimer;
+
+/**
+ * @brief 集群路由管理器
+ *
+ * 多个节点部署在负载均衡之后时，用户只连接其中一个节点。Redis中维护在线目录：
+ * {u:用户ID}:presence -> 节点ID，带TTL租约，登录时写入，按租约周期批量续期，登出时比较后删除，
+ * 节点异常退出后目录项随租约过期；{n:节点ID}:bus -> 集群总线地址。键名见RedisKeys。
+ *
+ * 发送给非本节点用户的帧先按目录批量解析所属节点（每个Redis节点一次往返，短时缓存），
+ * 再交给ClusterBus按节点批量转发，对端只向本地连接投递。
+ * 目录查询经RedisRouter在调用线程上使用线程私有的连接同步完成，调用者据此得到准确的投递结果，
+ * 用户不在任何节点在线时仍走原有的离线队列。目录写入与续期在集群线程中执行，不阻塞服务器线程。
+ */
+class ClusterManager : public QObject
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @brief 集群配置
+     */
+    struct Config {
+        bool enabled = false;
+        QString nodeId;                       // 为空时使用主机名加进程ID
+        QString busHost = "0.0.0.0";          // 集群总线监听地址
+        int busPort = 9100;                   // 集群总线监听端口
+        QString advertiseHost;                // 其他节点连接本节点使用的地址，为空时使用主机名
+        QString busSecret;                    // 节点间共享密钥
+        RedisRouter::Config redis;            // 目录所在的Redis部署，超时应较短
+        int presenceTtlSec = 60;              // 在线目录租约
+        int leaseRenewMs = 20000;             // 租约续期间隔，应明显小于租约
+        int lookupCacheMs = 1000;             // 目录查询结果缓存时间，0表示不缓存
+        int batchMaxFrames = 256;             // 单个转发批次的最大帧数
+        int batchFlushMs = 2;                 // 转发批次的最长等待时间
+        int maxPendingFrames = 20000;         // 单个节点连接建立前的积压上限
+    };
+
+    static ClusterManager* instance();
+
+    void configure(const Config &config);
+
+    /**
+     * @brief 启动集群线程、总线监听和租约续期，未启用时直接返回true
+     */
+    bool start();
+
+    /**
+     * @brief 删除本节点的目录项并停止集群线程
+     */
+    void shutdown();
+
+    bool isEnabled() const { return _running.loadAcquire() != 0; }
+
+    QString nodeId() const;
+
+    /**
+     * @brief 将帧转发给其他节点上的用户
+     *
+     * 调用者已确认这些用户不在本节点。目录中无记录（离线）或记录指向本节点（刚登出）的用户被跳过。
+     * @return 已交给总线转发的用户数
+     */
+    int forward(const RecipientList &userIds, const EncodedFrame &frame,
+                OutboundLanes::Lane lane = OutboundLanes::ChatLane, qint64 coalesceKey = -1);
+
+    /**
+     * @brief 查询用户所在的节点
+     * @return 用户ID -> 节点ID，只包含在线用户
+     */
+    QHash<qint64, QString> resolveOwners(const RecipientList &userIds);
+
+    QJsonObject getStatistics() const;
+
+public slots:
+    /**
+     * @brief 用户在本节点登录，登记在线目录
+     */
+    void onUserLoggedIn(qint64 userId);
+
+    /**
+     * @brief 用户在本节点登出，目录项仍指向本节点时删除
+     */
+    void onUserLoggedOut(qint64 userId);
+
+private:
+    explicit ClusterManager(QObject *parent = nullptr);
+    ~ClusterManager();
+
+    /**
+     * @brief 在集群线程中批量写入登录/登出变化
+     */
+    void applyPresenceChanges();
+
+    /**
+     * @brief 在集群线程中续期本节点地址和所有本地用户的租约
+     */
+    void renewLeases();
+
+    /**
+     * @brief 在集群线程中查询节点的总线地址
+     */
+    QString resolveNodeAddress(const QString &nodeId);
+
+    static QByteArray presenceKey(qint64 userId);
+    static QByteArray nodeKey(const QString &nodeId);
+
+    struct CachedOwner {
+        QString nodeId;
+        qint64 expiresAtMs = 0;
+    };
+
+    static ClusterManager* s_instance;
+    static QMutex s_instanceMutex;
+
+    mutable QMutex _mutex;
+    Config _config;
+    QString _nodeId;
+    QByteArray _nodeIdBytes;
+    QAtomicInt _running;
+
+    QThread *_thread;
+    QObject *_context;                        // 位于集群线程中的执行上下文
+    QTimer *_leaseTimer;
+    ClusterBus *_bus;
+    RedisRouter *_redis;
+
+    // 等待写入目录的登录(true)/登出(false)变化
+    QList<QPair<qint64, bool>> _presenceChanges;
+    bool _presenceScheduled;
+
+    mutable QMutex _cacheMutex;
+    QHash<qint64, CachedOwner> _ownerCache;
+    QElapsedTimer _clock;
+    qint64 _lastCachePruneMs;
+
+    // 统计信息
+    QAtomicInteger<qint64> _forwardedFrames;
+    QAtomicInteger<qint64> _forwardedRecipients;
+    QAtomicInteger<qint64> _remoteOffline;
+    QAtomicInteger<qint64> _lookups;
+    QAtomicInteger<qint64> _lookupCacheHits;
+    QAtomicInteger<qint64> _redisErrors;
+    QAtomicInteger<qint64> _presenceWrites;
+    QAtomicInteger<qint64> _leaseRenewals;
+};
+
+#endif // CLUSTERMANAGER_H
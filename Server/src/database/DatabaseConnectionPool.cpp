@@ -1,13 +1,23 @@
 #include "DatabaseConnectionPool.h"
 #include "../utils/Logger.h"
 #include "../utils/DatabaseErrorHandler.h"
+#include "QueryStatistics.h"
+#include "../monitoring/FlightRecorder.h"
+#include "../monitoring/Tracer.h"
+#include "../utils/RequestCancellation.h"
 #include <QSqlQuery>
 #include <QSqlError>
+#include <QSqlRecord>
+#include <QSqlResult>
+#include <QSqlDriver>
+#include <QElapsedTimer>
 #include <QDateTime>
 #include <numeric>
 #include <algorithm>
 #include <QJsonObject>
 #include <QUuid>
+#include <QThread>
+#include <QVector>
 #include <QCoreApplication>
 #include <QJsonDocument>
 #include <QJsonArray>
@@ -17,6 +27,20 @@
 DatabaseConnectionPool* DatabaseConnectionPool::s_instance = nullptr;
 QMutex DatabaseConnectionPool::s_instanceMutex;
 
+namespace {
+
+/**
+ * @brief 当前线程的配额组及已占用名额的嵌套深度
+ */
+struct ThreadQuotaState {
+    QString group;
+    int depth = 0;
+};
+
+thread_local ThreadQuotaState t_quotaState;
+
+} // namespace
+
 DatabaseConnectionPool::DatabaseConnectionPool(QObject *parent)
     : QObject(parent)
     , _totalConnections(0)
@@ -77,29 +101,24 @@ bool DatabaseConnectionPool::initialize(const PoolConfig& config)
     
     // 初始化数据库连接池
     
-    // 创建最小数量的连接
-    for (int i = 0; i < _config.minConnections; ++i) {
-        QSqlDatabase connection = createConnection();
-        if (connection.isValid() && connection.isOpen()) {
-            _availableConnections.enqueue(connection);
-            _connectionLastUsed[connection.connectionName()] = QDateTime::currentDateTime();
-            _totalConnections.fetchAndAddOrdered(1);
-        } else {
-            LOG_ERROR(QString("Failed to create initial connection %1").arg(i + 1));
-            return false;
-        }
+    QList<QSqlDatabase> initialConnections = createInitialConnections(_config.minConnections);
+    if (initialConnections.size() < _config.minConnections) {
+        LOG_ERROR(QString("Failed to create initial connections (%1 required)").arg(_config.minConnections));
+        return false;
     }
     
-    // 启动定时器
-    _healthCheckTimer->start(_config.healthCheckInterval);
-    _cleanupTimer->start(_config.idleTimeout / 2); // 清理频率为空闲超时的一半
-    
-    if (_autoResizeEnabled) {
-        _resizeTimer->start(_config.resizeCheckInterval);
-        // 自动调整大小已启用
+    for (const QSqlDatabase &connection : initialConnections) {
+        _availableConnections.enqueue(connection);
+        _connectionLastUsed[connection.connectionName()] = QDateTime::currentDateTime();
+        _totalConnections.fetchAndAddOrdered(1);
     }
     
-    _metricsTimer->start(10000); // 每10秒更新性能指标
+    // 启动定时器；由启动编排器在工作线程中初始化时，投递回连接池所属线程启动
+    if (QThread::currentThread() == thread()) {
+        startMaintenanceTimers();
+    } else {
+        QMetaObject::invokeMethod(this, [this]() { startMaintenanceTimers(); }, Qt::QueuedConnection);
+    }
     
     _initialized = true;
     
@@ -110,8 +129,16 @@ bool DatabaseConnectionPool::initialize(const PoolConfig& config)
 
 QSqlDatabase DatabaseConnectionPool::acquireConnection(int timeoutMs)
 {
+    quint64 lockStartNs = FlightRecorder::nowNs();
     QMutexLocker locker(&_poolMutex);
     
+    // 记录明显的锁竞争
+    quint64 lockWaitUs = (FlightRecorder::nowNs() - lockStartNs) / 1000;
+    if (lockWaitUs >= 100) {
+        static const quint32 poolLockId = FlightRecorder::internString("db_pool_mutex");
+        FlightRecorder::record(FlightRecorder::LockWait, poolLockId, lockWaitUs);
+    }
+    
     if (_shuttingDown) {
         LOG_WARNING("Connection pool is shutting down");
         return QSqlDatabase();
@@ -242,6 +269,133 @@ void DatabaseConnectionPool::releaseConnection(const QSqlDatabase& connection)
     }
 }
 
+DatabaseConnectionPool::QuotaScope::QuotaScope(const QString& group)
+    : _previousGroup(t_quotaState.group)
+{
+    t_quotaState.group = group;
+}
+
+DatabaseConnectionPool::QuotaScope::~QuotaScope()
+{
+    t_quotaState.group = _previousGroup;
+}
+
+void DatabaseConnectionPool::setConnectionQuota(const QString& group, int maxConnections)
+{
+    QMutexLocker locker(&_quotaMutex);
+    _quotas[group].limit = maxConnections;
+    _quotaReleased.wakeAll();
+}
+
+QString DatabaseConnectionPool::currentQuotaGroup()
+{
+    return t_quotaState.group;
+}
+
+bool DatabaseConnectionPool::acquireQuota(const QString& group, int timeoutMs)
+{
+    if (group.isEmpty()) {
+        return true;
+    }
+    
+    // 同一线程嵌套获取时已持有名额
+    if (t_quotaState.depth > 0) {
+        ++t_quotaState.depth;
+        return true;
+    }
+    
+    QMutexLocker locker(&_quotaMutex);
+    // 等待期间其他配额组可能被插入导致散列表重排，每次唤醒后重新查找；上限也可能被热加载调整
+    auto exhausted = [this, &group]() {
+        const ConnectionQuota &quota = _quotas[group];
+        return quota.limit > 0 && quota.inUse >= quota.limit;
+    };
+    if (exhausted()) {
+        ++_quotas[group].waits;
+        QElapsedTimer timer;
+        timer.start();
+        while (exhausted()) {
+            qint64 remaining = timeoutMs - timer.elapsed();
+            if (remaining <= 0) {
+                ++_quotas[group].timeouts;
+                return false;
+            }
+            _quotaReleased.wait(&_quotaMutex, static_cast<unsigned long>(remaining));
+        }
+    }
+    
+    ConnectionQuota &quota = _quotas[group];
+    ++quota.inUse;
+    ++quota.granted;
+    t_quotaState.depth = 1;
+    return true;
+}
+
+void DatabaseConnectionPool::releaseQuota(const QString& group)
+{
+    if (group.isEmpty() || t_quotaState.depth <= 0) {
+        return;
+    }
+    
+    if (--t_quotaState.depth > 0) {
+        return;
+    }
+    
+    QMutexLocker locker(&_quotaMutex);
+    ConnectionQuota &quota = _quotas[group];
+    if (quota.inUse > 0) {
+        --quota.inUse;
+    }
+    _quotaReleased.wakeAll();
+}
+
+QJsonObject DatabaseConnectionPool::getQuotaStatistics() const
+{
+    QMutexLocker locker(&_quotaMutex);
+    
+    QJsonObject stats;
+    for (auto it = _quotas.constBegin(); it != _quotas.constEnd(); ++it) {
+        QJsonObject quota;
+        quota["limit"] = it->limit;
+        quota["in_use"] = it->inUse;
+        quota["granted"] = it->granted;
+        quota["waits"] = it->waits;
+        quota["timeouts"] = it->timeouts;
+        stats[it.key()] = quota;
+    }
+    return stats;
+}
+
+qint64 DatabaseConnectionPool::serverConnectionId(const QSqlDatabase& connection)
+{
+    if (!connection.driverName().startsWith("QMYSQL") && connection.driverName() != "QMARIADB") {
+        return 0;
+    }
+    
+    QString name = connection.connectionName();
+    {
+        QMutexLocker locker(&_serverIdMutex);
+        auto it = _serverConnectionIds.constFind(name);
+        if (it != _serverConnectionIds.constEnd()) {
+            return it.value();
+        }
+    }
+    
+    QSqlQuery query(connection);
+    if (!query.exec("SELECT CONNECTION_ID()") || !query.next()) {
+        return 0;
+    }
+    qint64 id = query.value(0).toLongLong();
+    
+    QMutexLocker locker(&_serverIdMutex);
+    // 连接被回收后名字不再出现，缓存过大时整体清空重新查询
+    if (_serverConnectionIds.size() > qMax(64, _config.maxConnections * 4)) {
+        _serverConnectionIds.clear();
+    }
+    _serverConnectionIds.insert(name, id);
+    return id;
+}
+
 void DatabaseConnectionPool::shutdown()
 {
     QMutexLocker locker(&_poolMutex);
@@ -591,6 +745,45 @@ QSqlDatabase DatabaseConnectionPool::createConnection()
     return connection;
 }
 
+QList<QSqlDatabase> DatabaseConnectionPool::createInitialConnections(int count)
+{
+    // 连接只能在创建它的线程中使用，初始连接在调用线程（启动时为连接池所属的主线程）中逐个建立
+    QList<QSqlDatabase> connections;
+    for (int i = 0; i < count; ++i) {
+        QSqlDatabase connection = createConnection();
+        if (!connection.isValid() || !connection.isOpen()) {
+            LOG_ERROR(QString("Failed to create initial connection %1").arg(i + 1));
+            break;
+        }
+        connections.append(connection);
+    }
+    
+    if (connections.size() < count) {
+        for (QSqlDatabase &connection : connections) {
+            QString connectionName = connection.connectionName();
+            connection.close();
+            connection = QSqlDatabase();
+            QSqlDatabase::removeDatabase(connectionName);
+        }
+        connections.clear();
+    }
+    
+    return connections;
+}
+
+void DatabaseConnectionPool::startMaintenanceTimers()
+{
+    _healthCheckTimer->start(_config.healthCheckInterval);
+    _cleanupTimer->start(_config.idleTimeout / 2); // 清理频率为空闲超时的一半
+    
+    if (_autoResizeEnabled) {
+        _resizeTimer->start(_config.resizeCheckInterval);
+        // 自动调整大小已启用
+    }
+    
+    _metricsTimer->start(10000); // 每10秒更新性能指标
+}
+
 bool DatabaseConnectionPool::validateConnection(const QSqlDatabase& connection)
 {
     if (!connection.isValid() || !connection.isOpen()) {
@@ -610,16 +803,65 @@ QString DatabaseConnectionPool::generateConnectionName()
 }
 
 // DatabaseConnection RAII包装器实现
+namespace {
+
+/**
+ * @brief 未执行的查询结果，只携带错误信息，调用者通过lastError()得知查询被跳过
+ */
+class SkippedResult : public QSqlResult
+{
+public:
+    SkippedResult(const QSqlDriver *driver, const QString &reason)
+        : QSqlResult(driver)
+    {
+        setLastError(QSqlError(reason, QString(), QSqlError::StatementError));
+    }
+
+protected:
+    QVariant data(int) override { return QVariant(); }
+    bool isNull(int) override { return true; }
+    bool reset(const QString &) override { return false; }
+    bool fetch(int) override { return false; }
+    bool fetchFirst() override { return false; }
+    bool fetchLast() override { return false; }
+    int size() override { return -1; }
+    int numRowsAffected() override { return -1; }
+};
+
+} // namespace
+
 DatabaseConnection::DatabaseConnection(int timeoutMs)
     : _acquired(false)
+    , _acquiredAtNs(0)
+    , _quotaGroup(DatabaseConnectionPool::currentQuotaGroup())
+    , _quotaHeld(false)
+    , _inTransaction(false)
 {
-    _connection = DatabaseConnectionPool::instance()->acquireConnection(timeoutMs);
+    quint64 startNs = FlightRecorder::nowNs();
+    DatabaseConnectionPool* pool = DatabaseConnectionPool::instance();
+    
+    // 先占用所在阶段的配额，剩余时间用于从连接池获取
+    QElapsedTimer timer;
+    timer.start();
+    _quotaHeld = pool->acquireQuota(_quotaGroup, timeoutMs);
+    if (!_quotaHeld) {
+        LOG_WARNING(QString("Database connection quota exhausted for stage %1").arg(_quotaGroup));
+        _acquiredAtNs = FlightRecorder::nowNs();
+        FlightRecorder::record(FlightRecorder::DbAcquire, 0, (_acquiredAtNs - startNs) / 1000);
+        return;
+    }
+    
+    _connection = pool->acquireConnection(qMax(0, timeoutMs - static_cast<int>(timer.elapsed())));
     _acquired = _connection.isValid() && _connection.isOpen();
+    _acquiredAtNs = FlightRecorder::nowNs();
+    FlightRecorder::record(FlightRecorder::DbAcquire, _acquired ? 1 : 0, (_acquiredAtNs - startNs) / 1000);
 }
 
 DatabaseConnection::~DatabaseConnection()
 {
     if (_acquired) {
+        FlightRecorder::record(FlightRecorder::DbRelease, 0, (FlightRecorder::nowNs() - _acquiredAtNs) / 1000);
+        
         // 检查连接池是否仍然有效，避免程序退出时的警告
         DatabaseConnectionPool* pool = DatabaseConnectionPool::instance();
         if (pool && !pool->isShuttingDown()) {
@@ -635,10 +877,16 @@ DatabaseConnection::~DatabaseConnection()
             // 让Qt在应用程序退出时自行清理
         }
     }
+    
+    if (_quotaHeld) {
+        DatabaseConnectionPool::instance()->releaseQuota(_quotaGroup);
+    }
 }
 
 QSqlQuery DatabaseConnection::executeQuery(const QString& sql, const QVariantList& params)
 {
+    TRACE_SPAN("DatabaseConnection::executeQuery");
+
     if (!isValid()) {
         QMutexLocker locker(&_errorMutex);
         _lastError = "Database connection is not valid";
@@ -646,14 +894,82 @@ QSqlQuery DatabaseConnection::executeQuery(const QString& sql, const QVariantLis
         return QSqlQuery();
     }
     
+    // 只有只读阶段的请求在事务外执行的SELECT受截止时间与取消约束；
+    // 写请求中的查询（如读取LAST_INSERT_ID）和事务内的语句一旦开始不中途打断
+    RequestTokenPtr token = RequestCancellation::current();
+    const bool isRead = token && token->isReadOnly() && !_inTransaction
+                        && sql.trimmed().startsWith("SELECT", Qt::CaseInsensitive)
+                        && !sql.contains("FOR UPDATE", Qt::CaseInsensitive)
+                        && !sql.contains("LOCK IN SHARE MODE", Qt::CaseInsensitive);
+    QString statement = sql;
+    qint64 serverConnectionId = 0;
+    if (isRead) {
+        if (token->shouldAbort()) {
+            QMutexLocker locker(&_errorMutex);
+            _lastError = token->isCancelled() ? "Request cancelled" : "Request deadline exceeded";
+            RequestCancellation::instance()->recordQueryAbort(true);
+            return QSqlQuery(new SkippedResult(_connection.driver(), _lastError));
+        }
+        
+        // MySQL 5.7.8+的优化器提示，超时后服务器端中止查询
+        qint64 remainingMs = token->remainingMs();
+        if (remainingMs > 0 && !sql.contains("MAX_EXECUTION_TIME", Qt::CaseInsensitive)) {
+            int selectAt = sql.indexOf("SELECT", 0, Qt::CaseInsensitive);
+            statement = sql.left(selectAt + 6) + QString(" /*+ MAX_EXECUTION_TIME(%1) */").arg(remainingMs)
+                        + sql.mid(selectAt + 6);
+        }
+        serverConnectionId = DatabaseConnectionPool::instance()->serverConnectionId(_connection);
+    }
+    
+    QueryStatistics* queryStats = QueryStatistics::instance();
+    const bool collectStats = queryStats->isEnabled();
+    QString fingerprint;
+    if (collectStats) {
+        fingerprint = queryStats->fingerprint(sql);
+    }
+    
     QSqlQuery query(_connection);
-    query.prepare(sql);
+    query.prepare(statement);
     
     for (int i = 0; i < params.size(); ++i) {
         query.bindValue(i, params[i]);
     }
     
-    if (!query.exec()) {
+    QElapsedTimer timer;
+    timer.start();
+    if (serverConnectionId > 0) {
+        RequestCancellation::instance()->beginQuery(token, serverConnectionId);
+    }
+    bool success = query.exec();
+    if (serverConnectionId > 0) {
+        RequestCancellation::instance()->endQuery(token);
+    }
+    qint64 elapsedUs = timer.nsecsElapsed() / 1000;
+    
+    // 3024: 超过MAX_EXECUTION_TIME；1317: 被KILL QUERY中止
+    if (!success && isRead) {
+        QString errorCode = query.lastError().nativeErrorCode();
+        if (errorCode == "3024" || errorCode == "1317") {
+            QMutexLocker locker(&_errorMutex);
+            _lastError = query.lastError().text();
+            RequestCancellation::instance()->recordQueryAbort(false);
+            LOG_WARNING(QString("Query aborted for request %1: %2").arg(token->requestId()).arg(_lastError));
+            return query;
+        }
+    }
+    
+    if (collectStats) {
+        int rows = -1;
+        if (success) {
+            rows = query.isSelect() ? query.size() : query.numRowsAffected();
+        }
+        
+        if (queryStats->recordExecution(fingerprint, sql, elapsedUs, rows, success)) {
+            captureExplain(fingerprint, sql, params);
+        }
+    }
+    
+    if (!success) {
         QMutexLocker locker(&_errorMutex);
         _lastError = query.lastError().text();
         
@@ -669,6 +985,37 @@ QSqlQuery DatabaseConnection::executeQuery(const QString& sql, const QVariantLis
     return query;
 }
 
+void DatabaseConnection::captureExplain(const QString& fingerprint, const QString& sql, const QVariantList& params)
+{
+    // 使用独立的QSqlQuery，不影响原查询的结果集，也不计入统计
+    QSqlQuery explain(_connection);
+    if (!explain.prepare("EXPLAIN " + sql)) {
+        return;
+    }
+    
+    for (int i = 0; i < params.size(); ++i) {
+        explain.bindValue(i, params[i]);
+    }
+    
+    if (!explain.exec()) {
+        LOG_WARNING(QString("Failed to capture EXPLAIN for [%1]: %2")
+                    .arg(fingerprint).arg(explain.lastError().text()));
+        return;
+    }
+    
+    QJsonArray plan;
+    while (explain.next()) {
+        QSqlRecord record = explain.record();
+        QJsonObject row;
+        for (int i = 0; i < record.count(); ++i) {
+            row[record.fieldName(i)] = QJsonValue::fromVariant(record.value(i));
+        }
+        plan.append(row);
+    }
+    
+    QueryStatistics::instance()->storeExplain(fingerprint, plan);
+}
+
 int DatabaseConnection::executeUpdate(const QString& sql, const QVariantList& params)
 {
     QSqlQuery query = executeQuery(sql, params);
@@ -742,6 +1089,12 @@ QSqlQuery DatabaseConnection::executeQueryWithRetry(const QString& sql, const QV
             return query; // 成功执行
         }
         
+        // 所属请求已取消或过期时不再重试
+        RequestTokenPtr token = RequestCancellation::current();
+        if (token && token->shouldAbort()) {
+            break;
+        }
+        
         // 检查是否为可重试的错误
         QString errorText = query.lastError().text().toLower();
         if (errorText.contains("connection") || errorText.contains("timeout") || 
@@ -779,7 +1132,8 @@ bool DatabaseConnection::beginTransaction()
     if (!isValid()) {
         return false;
     }
-    return _connection.transaction();
+    _inTransaction = _connection.transaction();
+    return _inTransaction;
 }
 
 bool DatabaseConnection::commitTransaction()
@@ -787,7 +1141,11 @@ bool DatabaseConnection::commitTransaction()
     if (!isValid()) {
         return false;
     }
-    return _connection.commit();
+    bool committed = _connection.commit();
+    if (committed) {
+        _inTransaction = false;
+    }
+    return committed;
 }
 
 bool DatabaseConnection::rollbackTransaction()
@@ -795,6 +1153,7 @@ bool DatabaseConnection::rollbackTransaction()
     if (!isValid()) {
         return false;
     }
+    _inTransaction = false;
     return _connection.rollback();
 }
 
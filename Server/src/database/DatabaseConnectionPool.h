@@ -12,6 +12,7 @@
 #include <QThread>
 #include <QAtomicInt>
 #include <QDateTime>
+#include <QHash>
 #include <QJsonObject>
 
 /**
@@ -46,6 +47,22 @@ public:
         double loadPredictionWindow = 300.0; // 负载预测窗口(秒)
     };
 
+    /**
+     * @brief 连接配额作用域
+     *
+     * 作用域内当前线程经DatabaseConnection获取的连接计入指定配额组，
+     * 嵌套获取只占用一个名额，避免同一请求内再次取连接时等待自己。
+     */
+    class QuotaScope
+    {
+    public:
+        explicit QuotaScope(const QString& group);
+        ~QuotaScope();
+
+    private:
+        QString _previousGroup;
+    };
+
     explicit DatabaseConnectionPool(QObject *parent = nullptr);
     ~DatabaseConnectionPool();
     
@@ -74,6 +91,40 @@ public:
      */
     void releaseConnection(const QSqlDatabase& connection);
     
+    /**
+     * @brief 设置配额组可同时持有的连接数
+     * @param group 配额组名
+     * @param maxConnections 上限，<=0表示不限制
+     */
+    void setConnectionQuota(const QString& group, int maxConnections);
+    
+    /**
+     * @brief 当前线程所在的配额组，不在作用域内时为空
+     */
+    static QString currentQuotaGroup();
+    
+    /**
+     * @brief 为当前线程占用配额组名额
+     * @return 超时返回false；配额组为空或不限制时直接返回true
+     */
+    bool acquireQuota(const QString& group, int timeoutMs);
+    
+    /**
+     * @brief 归还acquireQuota()占用的名额
+     */
+    void releaseQuota(const QString& group);
+    
+    /**
+     * @brief 获取各配额组统计信息
+     */
+    QJsonObject getQuotaStatistics() const;
+    
+    /**
+     * @brief 获取连接在MySQL服务器端的连接ID（缓存），用于KILL QUERY
+     * @return 非MySQL驱动或查询失败时返回0
+     */
+    qint64 serverConnectionId(const QSqlDatabase& connection);
+    
     /**
      * @brief 关闭连接池
      */
@@ -163,6 +214,18 @@ private:
      */
     QSqlDatabase createConnection();
     
+    /**
+     * @brief 在连接池所属线程中建立初始连接
+     * @param count 连接数
+     * @return 成功建立的连接，任一失败时已建立的连接会被关闭并返回空列表
+     */
+    QList<QSqlDatabase> createInitialConnections(int count);
+    
+    /**
+     * @brief 启动维护定时器（需在连接池所属线程中调用）
+     */
+    void startMaintenanceTimers();
+    
     /**
      * @brief 验证连接是否有效
      */
@@ -235,6 +298,22 @@ private:
     QAtomicInt _totalReleased;
     QAtomicInt _acquireTimeouts;
     
+    // 连接配额
+    struct ConnectionQuota {
+        int limit = 0;
+        int inUse = 0;
+        qint64 granted = 0;
+        qint64 waits = 0;
+        qint64 timeouts = 0;
+    };
+    mutable QMutex _quotaMutex;
+    QWaitCondition _quotaReleased;
+    QHash<QString, ConnectionQuota> _quotas;
+    
+    // 连接名 -> 服务器端连接ID
+    QMutex _serverIdMutex;
+    QHash<QString, qint64> _serverConnectionIds;
+    
     // 定时器
     QTimer* _healthCheckTimer;
     QTimer* _cleanupTimer;
@@ -294,6 +373,9 @@ public:
     
     /**
      * @brief 执行查询
+     * 
+     * 当前请求为只读请求（RequestToken::isReadOnly）且不在事务中时，SELECT受截止时间约束：
+     * 已过期或已取消时不执行，返回的结果lastError()有效。
      */
     QSqlQuery executeQuery(const QString& sql, const QVariantList& params = QVariantList());
     
@@ -348,8 +430,17 @@ public:
     bool isConnectionHealthy() const;
 
 private:
+    /**
+     * @brief 为慢查询采集EXPLAIN执行计划
+     */
+    void captureExplain(const QString& fingerprint, const QString& sql, const QVariantList& params);
+
     QSqlDatabase _connection;
     bool _acquired;
+    quint64 _acquiredAtNs;
+    QString _quotaGroup;
+    bool _quotaHeld;
+    bool _inTransaction;
     QString _lastError;
     mutable QMutex _errorMutex;
 };
@@ -1,4 +1,6 @@
 #include "DatabaseManager.h"
+#include "RetentionScheduler.h"
+#include "SchemaMigrator.h"
 #include "../utils/Logger.h"
 #include <QSqlDriver>
 #include <QThread>
@@ -76,9 +78,9 @@ bool DatabaseManager::initialize(const QString &host, int port, const QString &d
 
     emit connectionStateChanged(true);
 
-    // 创建表结构
-    if (!createTables()) {
-        LOG_WARNING("Failed to create database tables");
+    // 应用结构迁移
+    if (!SchemaMigrator::migrate()) {
+        LOG_WARNING("Failed to apply schema migrations");
     }
 
     return true;
@@ -237,131 +239,6 @@ QJsonObject DatabaseManager::getConnectionPoolStatistics() const
     return QJsonObject();
 }
 
-bool DatabaseManager::createTables()
-{
-    if (!isConnected()) {
-        LOG_ERROR("Database not connected, cannot create tables");
-        return false;
-    }
-
-    // LOG_INFO removed
-
-    // 使用事务确保表创建的原子性
-    return executeTransaction([this](DatabaseConnection& dbConn) -> bool {
-        
-        // 创建用户表
-        QString createUsersTable = R"(
-            CREATE TABLE IF NOT EXISTS users (
-                id BIGINT UNSIGNED AUTO_INCREMENT PRIMARY KEY,
-                username VARCHAR(50) NOT NULL UNIQUE COMMENT '用户名',
-                email VARCHAR(100) NOT NULL UNIQUE COMMENT '邮箱',
-                password_hash VARCHAR(255) NOT NULL COMMENT '密码哈希',
-                salt VARCHAR(64) NOT NULL COMMENT '盐值',
-                display_name VARCHAR(200) DEFAULT NULL COMMENT '显示名称',
-                avatar_url VARCHAR(512) DEFAULT NULL COMMENT '头像URL',
-                bio TEXT DEFAULT NULL COMMENT '个人简介',
-                status ENUM('active', 'inactive', 'banned', 'deleted') DEFAULT 'inactive' COMMENT '账户状态',
-                email_verified BOOLEAN DEFAULT FALSE COMMENT '邮箱是否已验证',
-                verification_code VARCHAR(10) DEFAULT NULL COMMENT '验证码',
-                verification_expires TIMESTAMP NULL DEFAULT NULL COMMENT '验证码过期时间',
-                last_online TIMESTAMP NULL DEFAULT CURRENT_TIMESTAMP COMMENT '最后在线时间',
-                created_at TIMESTAMP DEFAULT CURRENT_TIMESTAMP COMMENT '创建时间',
-                updated_at TIMESTAMP DEFAULT CURRENT_TIMESTAMP ON UPDATE CURRENT_TIMESTAMP COMMENT '更新时间',
-                UNIQUE INDEX idx_username (username),
-                UNIQUE INDEX idx_email (email),
-                INDEX idx_status (status),
-                INDEX idx_last_online (last_online),
-                INDEX idx_email_verified (email_verified),
-                INDEX idx_verification_expires (verification_expires),
-                INDEX idx_created_at (created_at),
-                INDEX idx_updated_at (updated_at)
-            ) ENGINE=InnoDB COMMENT='用户表'
-        )";
-
-        if (dbConn.executeUpdate(createUsersTable) == -1) {
-            LOG_ERROR("Failed to create users table");
-            return false;
-        }
-
-        // 创建验证码表
-        QString createVerificationCodesTable = R"(
-            CREATE TABLE IF NOT EXISTS verification_codes (
-                id BIGINT UNSIGNED AUTO_INCREMENT PRIMARY KEY,
-                email VARCHAR(100) NOT NULL COMMENT '邮箱地址',
-                code VARCHAR(10) NOT NULL COMMENT '验证码',
-                type ENUM('registration', 'password_reset', 'email_change') DEFAULT 'registration' COMMENT '验证码类型',
-                expires_at TIMESTAMP NOT NULL COMMENT '过期时间',
-                used_at TIMESTAMP NULL DEFAULT NULL COMMENT '使用时间',
-                created_at TIMESTAMP DEFAULT CURRENT_TIMESTAMP COMMENT '创建时间',
-                INDEX idx_email (email),
-                INDEX idx_code (code),
-                INDEX idx_type (type),
-                INDEX idx_expires_at (expires_at),
-                INDEX idx_used_at (used_at),
-                INDEX idx_email_type_expires (email, type, expires_at)
-            ) ENGINE=InnoDB COMMENT='验证码表'
-        )";
-
-        if (dbConn.executeUpdate(createVerificationCodesTable) == -1) {
-            LOG_ERROR("Failed to create verification_codes table");
-            return false;
-        }
-
-        // 创建用户会话表
-        QString createSessionsTable = R"(
-            CREATE TABLE IF NOT EXISTS user_sessions (
-                id BIGINT UNSIGNED AUTO_INCREMENT PRIMARY KEY,
-                user_id BIGINT UNSIGNED NOT NULL,
-                session_token VARCHAR(128) NOT NULL UNIQUE COMMENT '会话令牌',
-                refresh_token VARCHAR(128) DEFAULT NULL COMMENT '刷新令牌',
-                device_info VARCHAR(500) DEFAULT NULL COMMENT '设备信息',
-                ip_address VARCHAR(45) DEFAULT NULL COMMENT 'IP地址',
-                user_agent TEXT DEFAULT NULL COMMENT '用户代理',
-                expires_at TIMESTAMP NOT NULL COMMENT '过期时间',
-                created_at TIMESTAMP DEFAULT CURRENT_TIMESTAMP COMMENT '创建时间',
-                last_activity TIMESTAMP DEFAULT CURRENT_TIMESTAMP ON UPDATE CURRENT_TIMESTAMP COMMENT '最后活动时间',
-                FOREIGN KEY (user_id) REFERENCES users(id) ON DELETE CASCADE,
-                INDEX idx_user_id (user_id),
-                INDEX idx_session_token (session_token),
-                INDEX idx_expires_at (expires_at),
-                INDEX idx_user_expires (user_id, expires_at)
-            ) ENGINE=InnoDB COMMENT='用户会话表'
-        )";
-
-        if (dbConn.executeUpdate(createSessionsTable) == -1) {
-            LOG_ERROR("Failed to create sessions table");
-            return false;
-        }
-
-        // 创建登录日志表
-        QString createLoginLogsTable = R"(
-            CREATE TABLE IF NOT EXISTS login_logs (
-                id BIGINT UNSIGNED AUTO_INCREMENT PRIMARY KEY,
-                user_id BIGINT UNSIGNED,
-                username VARCHAR(50),
-                email VARCHAR(100),
-                success BOOLEAN NOT NULL,
-                ip_address VARCHAR(45),
-                user_agent TEXT,
-                error_message TEXT,
-                created_at TIMESTAMP DEFAULT CURRENT_TIMESTAMP,
-                INDEX idx_user_id (user_id),
-                INDEX idx_success (success),
-                INDEX idx_created_at (created_at),
-                FOREIGN KEY (user_id) REFERENCES users(id) ON DELETE SET NULL
-            ) ENGINE=InnoDB COMMENT='登录日志表'
-        )";
-
-        if (dbConn.executeUpdate(createLoginLogsTable) == -1) {
-            LOG_ERROR("Failed to create login_logs table");
-            return false;
-        }
-
-    
-        return true;
-    });
-}
-
 bool DatabaseManager::tableExists(const QString &tableName)
 {
     DatabaseConnection dbConn;
@@ -428,17 +305,18 @@ bool DatabaseManager::optimizeDatabase()
             }
         }
 
-        // 清理过期的验证码
-        QString cleanupCodes = "DELETE FROM verification_codes WHERE expires_at < NOW()";
-        dbConn.executeUpdate(cleanupCodes);
-
-        // 清理过期的会话
-        QString cleanupSessions = "DELETE FROM user_sessions WHERE expires_at < NOW()";
-        dbConn.executeUpdate(cleanupSessions);
-
-        // 清理旧的登录日志（保留30天）
-        QString cleanupLogs = "DELETE FROM login_logs WHERE created_at < DATE_SUB(NOW(), INTERVAL 30 DAY)";
-        dbConn.executeUpdate(cleanupLogs);
+        // 过期数据交给保留任务分块清理，不在事务中执行大范围DELETE；未启用时退回单条语句
+        RetentionScheduler* retention = RetentionScheduler::instance();
+        if (!retention->trigger("verification_codes")) {
+            dbConn.executeUpdate("DELETE FROM verification_codes WHERE expires_at < NOW()");
+        }
+        if (!retention->trigger("user_sessions")) {
+            dbConn.executeUpdate("DELETE FROM user_sessions WHERE expires_at < NOW()");
+        }
+        if (!retention->trigger("login_logs")) {
+            // 清理旧的登录日志（保留30天）
+            dbConn.executeUpdate("DELETE FROM login_logs WHERE created_at < DATE_SUB(NOW(), INTERVAL 30 DAY)");
+        }
 
     
         return true;
@@ -93,12 +93,6 @@ public:
      */
     QString lastError() const;
     
-    /**
-     * @brief 创建数据库表
-     * @return 创建是否成功
-     */
-    bool createTables();
-    
     /**
      * @brief 检查表是否存在
      * @param tableName 表名
@@ -0,0 +1,408 @@
+#include "QueryStatistics.h"
+#include "../utils/Logger.h"
+#include <QCryptographicHash>
+#include <QRegularExpression>
+#include <QMutexLocker>
+#include <QVector>
+#include <algorithm>
+
+namespace {
+// 原始SQL到指纹的缓存上限，服务中的SQL大多为带占位符的固定文本
+const int FINGERPRINT_CACHE_LIMIT = 4096;
+}
+
+// 静态成员初始化
+QueryStatistics* QueryStatistics::s_instance = nullptr;
+QMutex QueryStatistics::s_instanceMutex;
+
+const int QueryStatistics::BUCKET_BOUNDS_MS[QueryStatistics::HISTOGRAM_BUCKETS - 1] = {
+    1, 2, 5, 10, 25, 50, 100, 250, 500, 1000, 2500
+};
+
+QueryStatistics::QueryStatistics(QObject *parent)
+    : QObject(parent)
+    , _totalQueries(0)
+    , _totalSlowQueries(0)
+    , _droppedFingerprints(0)
+    , _explainsCaptured(0)
+    , _explainsInWindow(0)
+{
+}
+
+QueryStatistics* QueryStatistics::instance()
+{
+    if (!s_instance) {
+        QMutexLocker locker(&s_instanceMutex);
+        if (!s_instance) {
+            s_instance = new QueryStatistics();
+        }
+    }
+    return s_instance;
+}
+
+void QueryStatistics::configure(const StatsConfig &config)
+{
+    QMutexLocker locker(&_mutex);
+    _config = config;
+    _config.maxFingerprints = qMax(1, _config.maxFingerprints);
+    _config.topN = qMax(1, _config.topN);
+
+    LOG_INFO(QString("Query statistics %1: slow_threshold=%2ms, explain=%3")
+             .arg(_config.enabled ? "enabled" : "disabled")
+             .arg(_config.slowThresholdMs)
+             .arg(_config.explainEnabled ? "on" : "off"));
+}
+
+QString QueryStatistics::normalizeSql(const QString &sql)
+{
+    QString result;
+    result.reserve(sql.size());
+
+    const int length = sql.size();
+    bool pendingSpace = false;
+
+    for (int i = 0; i < length; ++i) {
+        QChar ch = sql.at(i);
+
+        // 压缩空白
+        if (ch.isSpace()) {
+            pendingSpace = !result.isEmpty();
+            continue;
+        }
+        if (pendingSpace) {
+            result.append(' ');
+            pendingSpace = false;
+        }
+
+        // 字符串字面量 -> ?
+        if (ch == '\'' || ch == '"') {
+            QChar quote = ch;
+            ++i;
+            while (i < length) {
+                QChar c = sql.at(i);
+                if (c == '\\') {
+                    i += 2;
+                    continue;
+                }
+                if (c == quote) {
+                    if (i + 1 < length && sql.at(i + 1) == quote) {
+                        i += 2;
+                        continue;
+                    }
+                    break;
+                }
+                ++i;
+            }
+            result.append('?');
+            continue;
+        }
+
+        // 数字字面量 -> ?（标识符中的数字保持不变）
+        if (ch.isDigit()) {
+            QChar prev = result.isEmpty() ? QChar(' ') : result.at(result.size() - 1);
+            if (!prev.isLetterOrNumber() && prev != '_' && prev != '`') {
+                while (i + 1 < length && (sql.at(i + 1).isDigit() || sql.at(i + 1) == '.')) {
+                    ++i;
+                }
+                result.append('?');
+                continue;
+            }
+        }
+
+        // 注释
+        if (ch == '-' && i + 1 < length && sql.at(i + 1) == '-') {
+            while (i < length && sql.at(i) != '\n') {
+                ++i;
+            }
+            pendingSpace = !result.isEmpty();
+            continue;
+        }
+
+        result.append(ch.toLower());
+    }
+
+    // 折叠IN列表和多行VALUES，使不同参数数量的语句归为同一指纹
+    static const QRegularExpression inListPattern("\\bin ?\\(\\s*\\?(\\s*,\\s*\\?)*\\s*\\)");
+    static const QRegularExpression valuesPattern("(\\([?,\\s]+\\))(\\s*,\\s*\\([?,\\s]+\\))+");
+    result.replace(inListPattern, "in (?+)");
+    result.replace(valuesPattern, "\\1, ...");
+
+    if (result.endsWith(';')) {
+        result.chop(1);
+    }
+
+    return result.trimmed();
+}
+
+QString QueryStatistics::fingerprint(const QString &sql)
+{
+    {
+        QMutexLocker locker(&_mutex);
+        auto it = _fingerprintCache.constFind(sql);
+        if (it != _fingerprintCache.constEnd()) {
+            return it.value();
+        }
+    }
+
+    // 规范化和哈希在锁外完成
+    QString normalized = normalizeSql(sql);
+    QString fp = QString::fromLatin1(
+        QCryptographicHash::hash(normalized.toUtf8(), QCryptographicHash::Sha1).left(8).toHex());
+
+    QMutexLocker locker(&_mutex);
+    if (_fingerprintCache.size() >= FINGERPRINT_CACHE_LIMIT) {
+        _fingerprintCache.clear();
+    }
+    _fingerprintCache.insert(sql, fp);
+
+    if (!_stats.contains(fp) && _stats.size() < _config.maxFingerprints) {
+        FingerprintStats stats;
+        stats.fingerprint = fp;
+        stats.normalizedSql = normalized;
+        _stats.insert(fp, stats);
+    }
+
+    return fp;
+}
+
+int QueryStatistics::bucketIndex(qint64 elapsedUs)
+{
+    for (int i = 0; i < HISTOGRAM_BUCKETS - 1; ++i) {
+        if (elapsedUs < static_cast<qint64>(BUCKET_BOUNDS_MS[i]) * 1000) {
+            return i;
+        }
+    }
+    return HISTOGRAM_BUCKETS - 1;
+}
+
+bool QueryStatistics::recordExecution(const QString &fingerprint, const QString &sql,
+                                      qint64 elapsedUs, int rows, bool success)
+{
+    bool slow = false;
+    bool explain = false;
+    QString normalized;
+
+    {
+        QMutexLocker locker(&_mutex);
+        _totalQueries++;
+
+        auto it = _stats.find(fingerprint);
+        if (it == _stats.end()) {
+            // 指纹数量已达上限
+            _droppedFingerprints++;
+            return false;
+        }
+
+        FingerprintStats &stats = it.value();
+        stats.count++;
+        stats.lastSeen = QDateTime::currentDateTime();
+
+        if (!success) {
+            stats.errorCount++;
+            return false;
+        }
+
+        stats.totalTimeUs += elapsedUs;
+        stats.maxTimeUs = qMax(stats.maxTimeUs, elapsedUs);
+        stats.buckets[bucketIndex(elapsedUs)]++;
+
+        if (rows > 0) {
+            stats.totalRows += rows;
+            stats.maxRows = qMax(stats.maxRows, static_cast<qint64>(rows));
+        }
+
+        slow = elapsedUs >= static_cast<qint64>(_config.slowThresholdMs) * 1000;
+        if (slow) {
+            stats.slowCount++;
+            _totalSlowQueries++;
+            normalized = stats.normalizedSql;
+            explain = _config.explainEnabled && isExplainable(sql) && tryAcquireExplainSlot(stats);
+        }
+    }
+
+    if (slow) {
+        LOG_WARNING(QString("Slow query [%1] %2ms rows=%3: %4")
+                    .arg(fingerprint)
+                    .arg(elapsedUs / 1000.0, 0, 'f', 1)
+                    .arg(rows)
+                    .arg(normalized));
+    }
+
+    return explain;
+}
+
+bool QueryStatistics::tryAcquireExplainSlot(FingerprintStats &stats)
+{
+    QDateTime now = QDateTime::currentDateTime();
+
+    if (stats.lastExplainTime.isValid() &&
+        stats.lastExplainTime.secsTo(now) < _config.explainIntervalSeconds) {
+        return false;
+    }
+
+    if (!_explainWindowStart.isValid() || _explainWindowStart.secsTo(now) >= 60) {
+        _explainWindowStart = now;
+        _explainsInWindow = 0;
+    }
+
+    if (_explainsInWindow >= _config.maxExplainsPerMinute) {
+        return false;
+    }
+
+    _explainsInWindow++;
+    stats.lastExplainTime = now;
+    return true;
+}
+
+void QueryStatistics::storeExplain(const QString &fingerprint, const QJsonArray &plan)
+{
+    QMutexLocker locker(&_mutex);
+
+    auto it = _stats.find(fingerprint);
+    if (it == _stats.end()) {
+        return;
+    }
+
+    it.value().lastExplain = plan;
+    _explainsCaptured++;
+}
+
+bool QueryStatistics::isExplainable(const QString &sql)
+{
+    QString head = sql.trimmed().left(8).toUpper();
+    return head.startsWith("SELECT") || head.startsWith("UPDATE") ||
+           head.startsWith("DELETE") || head.startsWith("INSERT") ||
+           head.startsWith("REPLACE");
+}
+
+double QueryStatistics::percentileMs(const FingerprintStats &stats, double percentile)
+{
+    qint64 samples = 0;
+    for (int i = 0; i < HISTOGRAM_BUCKETS; ++i) {
+        samples += stats.buckets[i];
+    }
+    if (samples == 0) {
+        return 0.0;
+    }
+
+    qint64 target = static_cast<qint64>(samples * percentile);
+    qint64 cumulative = 0;
+    for (int i = 0; i < HISTOGRAM_BUCKETS - 1; ++i) {
+        cumulative += stats.buckets[i];
+        if (cumulative > target) {
+            return BUCKET_BOUNDS_MS[i];
+        }
+    }
+
+    // 溢出桶使用实际最大值
+    return stats.maxTimeUs / 1000.0;
+}
+
+QJsonObject QueryStatistics::statsToJson(const FingerprintStats &stats) const
+{
+    qint64 successCount = stats.count - stats.errorCount;
+
+    QJsonObject obj;
+    obj["fingerprint"] = stats.fingerprint;
+    obj["sql"] = stats.normalizedSql;
+    obj["count"] = stats.count;
+    obj["errors"] = stats.errorCount;
+    obj["slow_count"] = stats.slowCount;
+    obj["total_time_ms"] = stats.totalTimeUs / 1000.0;
+    obj["avg_time_ms"] = successCount > 0 ? stats.totalTimeUs / 1000.0 / successCount : 0.0;
+    obj["max_time_ms"] = stats.maxTimeUs / 1000.0;
+    obj["p50_ms"] = percentileMs(stats, 0.50);
+    obj["p95_ms"] = percentileMs(stats, 0.95);
+    obj["p99_ms"] = percentileMs(stats, 0.99);
+    obj["avg_rows"] = successCount > 0 ? static_cast<double>(stats.totalRows) / successCount : 0.0;
+    obj["max_rows"] = stats.maxRows;
+    obj["last_seen"] = stats.lastSeen.toString(Qt::ISODate);
+
+    QJsonArray histogram;
+    for (int i = 0; i < HISTOGRAM_BUCKETS; ++i) {
+        histogram.append(stats.buckets[i]);
+    }
+    obj["histogram"] = histogram;
+
+    if (!stats.lastExplain.isEmpty()) {
+        obj["explain"] = stats.lastExplain;
+        obj["explain_time"] = stats.lastExplainTime.toString(Qt::ISODate);
+    }
+
+    return obj;
+}
+
+QJsonArray QueryStatistics::getTopQueries(const QString &sortBy, int limit) const
+{
+    QVector<FingerprintStats> entries;
+    {
+        QMutexLocker locker(&_mutex);
+        if (limit <= 0) {
+            limit = _config.topN;
+        }
+        entries.reserve(_stats.size());
+        for (auto it = _stats.constBegin(); it != _stats.constEnd(); ++it) {
+            if (it.value().count > 0) {
+                entries.append(it.value());
+            }
+        }
+    }
+
+    auto key = [&sortBy](const FingerprintStats &s) -> double {
+        if (sortBy == "max_time") return static_cast<double>(s.maxTimeUs);
+        if (sortBy == "p99") return percentileMs(s, 0.99);
+        if (sortBy == "count") return static_cast<double>(s.count);
+        if (sortBy == "rows") return static_cast<double>(s.totalRows);
+        return static_cast<double>(s.totalTimeUs);
+    };
+
+    std::sort(entries.begin(), entries.end(),
+              [&key](const FingerprintStats &a, const FingerprintStats &b) {
+                  return key(a) > key(b);
+              });
+
+    QJsonArray result;
+    for (int i = 0; i < entries.size() && i < limit; ++i) {
+        result.append(statsToJson(entries[i]));
+    }
+    return result;
+}
+
+QJsonObject QueryStatistics::getStatistics() const
+{
+    QJsonObject stats;
+
+    {
+        QMutexLocker locker(&_mutex);
+        stats["enabled"] = _config.enabled;
+        stats["slow_threshold_ms"] = _config.slowThresholdMs;
+        stats["tracked_fingerprints"] = _stats.size();
+        stats["total_queries"] = _totalQueries;
+        stats["slow_queries"] = _totalSlowQueries;
+        stats["dropped_fingerprints"] = _droppedFingerprints;
+        stats["explains_captured"] = _explainsCaptured;
+    }
+
+    QJsonArray bounds;
+    for (int i = 0; i < HISTOGRAM_BUCKETS - 1; ++i) {
+        bounds.append(BUCKET_BOUNDS_MS[i]);
+    }
+    stats["histogram_bounds_ms"] = bounds;
+
+    stats["top_by_total_time"] = getTopQueries("total_time");
+    stats["top_by_p99"] = getTopQueries("p99");
+
+    return stats;
+}
+
+void QueryStatistics::reset()
+{
+    QMutexLocker locker(&_mutex);
+    _stats.clear();
+    _fingerprintCache.clear();
+    _totalQueries = 0;
+    _totalSlowQueries = 0;
+    _droppedFingerprints = 0;
+    _explainsCaptured = 0;
+    _explainsInWindow = 0;
+}
@@ -0,0 +1,151 @@
+#ifndef QUERYSTATISTICS_H
+#define QUERYSTATISTICS_H
+
+#include <QObject>
+#include <QMutex>
+#include <QHash>
+#include <QDateTime>
+#include <QJsonObject>
+#include <QJsonArray>
+#include <QString>
+
+/**
+ * @brief SQL语句指纹统计与慢查询日志
+ *
+ * 将SQL规范化（字面量替换为?、IN列表折叠、空白压缩、统一小写）后计算指纹，
+ * 按指纹聚合执行次数、耗时直方图、返回/影响行数和错误数。
+ * 超过慢查询阈值的语句会写入慢查询日志，并在限流条件下自动采集EXPLAIN执行计划，
+ * 通过getStatistics()输出Top-N报告，用于确定优先优化哪些查询。
+ */
+class QueryStatistics : public QObject
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @brief 统计配置
+     */
+    struct StatsConfig {
+        bool enabled = true;
+        int slowThresholdMs = 1000;       // 慢查询阈值
+        bool explainEnabled = true;       // 是否自动采集EXPLAIN
+        int explainIntervalSeconds = 300; // 同一指纹两次EXPLAIN的最小间隔
+        int maxExplainsPerMinute = 10;    // 全局每分钟EXPLAIN上限
+        int maxFingerprints = 1000;       // 最多跟踪的指纹数量
+        int topN = 10;                    // 报告中的条目数
+    };
+
+    /**
+     * @brief 耗时直方图桶上界（毫秒），最后一个桶为溢出桶
+     */
+    static const int HISTOGRAM_BUCKETS = 12;
+    static const int BUCKET_BOUNDS_MS[HISTOGRAM_BUCKETS - 1];
+
+    /**
+     * @brief 单个指纹的聚合统计
+     */
+    struct FingerprintStats {
+        QString fingerprint;
+        QString normalizedSql;
+        qint64 count = 0;
+        qint64 errorCount = 0;
+        qint64 slowCount = 0;
+        qint64 totalTimeUs = 0;
+        qint64 maxTimeUs = 0;
+        qint64 totalRows = 0;
+        qint64 maxRows = 0;
+        qint64 buckets[HISTOGRAM_BUCKETS] = {};
+        QDateTime lastSeen;
+        QDateTime lastExplainTime;
+        QJsonArray lastExplain;
+    };
+
+    static QueryStatistics* instance();
+
+    /**
+     * @brief 应用配置
+     * @param config 统计配置
+     */
+    void configure(const StatsConfig &config);
+
+    bool isEnabled() const { return _config.enabled; }
+
+    /**
+     * @brief 计算SQL指纹（带缓存）
+     * @param sql 原始SQL
+     * @return 指纹（16位十六进制）
+     */
+    QString fingerprint(const QString &sql);
+
+    /**
+     * @brief 记录一次查询执行
+     * @param fingerprint 语句指纹
+     * @param sql 原始SQL
+     * @param elapsedUs 执行耗时（微秒）
+     * @param rows 返回或影响的行数，未知时为-1
+     * @param success 是否执行成功
+     * @return 是否应当为本次执行采集EXPLAIN
+     */
+    bool recordExecution(const QString &fingerprint, const QString &sql,
+                         qint64 elapsedUs, int rows, bool success);
+
+    /**
+     * @brief 保存EXPLAIN结果
+     */
+    void storeExplain(const QString &fingerprint, const QJsonArray &plan);
+
+    /**
+     * @brief 判断语句是否支持EXPLAIN
+     */
+    static bool isExplainable(const QString &sql);
+
+    /**
+     * @brief 规范化SQL文本
+     */
+    static QString normalizeSql(const QString &sql);
+
+    /**
+     * @brief 获取Top-N报告
+     * @param sortBy 排序字段：total_time、max_time、p99、count、rows
+     * @param limit 条目数，<=0时使用配置值
+     */
+    QJsonArray getTopQueries(const QString &sortBy = "total_time", int limit = 0) const;
+
+    /**
+     * @brief 获取统计摘要（含Top-N报告）
+     */
+    QJsonObject getStatistics() const;
+
+    /**
+     * @brief 清空统计数据
+     */
+    void reset();
+
+private:
+    explicit QueryStatistics(QObject *parent = nullptr);
+
+    static int bucketIndex(qint64 elapsedUs);
+    static double percentileMs(const FingerprintStats &stats, double percentile);
+    QJsonObject statsToJson(const FingerprintStats &stats) const;
+    bool tryAcquireExplainSlot(FingerprintStats &stats);
+
+    static QueryStatistics* s_instance;
+    static QMutex s_instanceMutex;
+
+    StatsConfig _config;
+
+    mutable QMutex _mutex;
+    QHash<QString, FingerprintStats> _stats;
+    QHash<QString, QString> _fingerprintCache;   // 原始SQL -> 指纹
+
+    qint64 _totalQueries;
+    qint64 _totalSlowQueries;
+    qint64 _droppedFingerprints;
+    qint64 _explainsCaptured;
+
+    // EXPLAIN全局限流窗口
+    QDateTime _explainWindowStart;
+    int _explainsInWindow;
+};
+
+#endif // QUERYSTATISTICS_H
@@ -1,8 +1,8 @@
 #include "RedisClient.h"
+#include "RedisKeys.h"
 #include "../utils/Logger.h"
+#include "../monitoring/Tracer.h"
 #include <QMutexLocker>
-#include <QEventLoop>
-#include <QTimer>
 
 
 // 静态成员初始化
@@ -11,24 +11,11 @@ QMutex RedisClient::s_mutex;
 
 RedisClient::RedisClient(QObject *parent)
     : QObject(parent)
-    , _socket(nullptr)
-    , _port(6379)
-    , _database(0)
     , _isConnected(false)
-    , _connectTimeout(2000)  // 减少连接超时时间，避免阻塞
-    , _commandTimeout(3000)  // 减少命令超时时间
     , _reconnectInterval(10000)
 {
-    _socket = new QTcpSocket(this);
     _reconnectTimer = new QTimer(this);
     _reconnectTimer->setSingleShot(true);
-    
-    // 连接信号
-    connect(_socket, &QTcpSocket::connected, this, &RedisClient::onConnected);
-    connect(_socket, &QTcpSocket::disconnected, this, &RedisClient::onDisconnected);
-    connect(_socket, &QTcpSocket::readyRead, this, &RedisClient::onReadyRead);
-    connect(_socket, QOverload<QAbstractSocket::SocketError>::of(&QTcpSocket::errorOccurred),
-            this, &RedisClient::onSocketError);
     connect(_reconnectTimer, &QTimer::timeout, this, &RedisClient::onReconnectTimer);
 }
 
@@ -51,492 +38,322 @@ RedisClient* RedisClient::instance()
 
 bool RedisClient::initialize(const QString &host, int port, const QString &password, int database)
 {
-    QMutexLocker locker(&_commandMutex);
-    
-    _host = host;
-    _port = port;
-    _password = password;
-    _database = database;
-    
-    // 关闭现有连接
-    if (_socket->state() != QAbstractSocket::UnconnectedState) {
-        _socket->disconnectFromHost();
-        if (_socket->state() != QAbstractSocket::UnconnectedState) {
-            _socket->waitForDisconnected(3000);
-        }
+    RedisRouter::Config config;
+    config.host = host;
+    config.port = port;
+    config.password = password;
+    config.database = database;
+    return initialize(config);
+}
+
+bool RedisClient::initialize(const RedisRouter::Config &config)
+{
+    QSharedPointer<RedisRouter> router(new RedisRouter(config));
+    {
+        QMutexLocker locker(&_stateMutex);
+        _router = router;
     }
-    
-    // 连接到Redis服务器
-    _socket->connectToHost(_host, _port);
-    
-    if (!_socket->waitForConnected(_connectTimeout)) {
-        _lastError = QString("Failed to connect to Redis: %1").arg(_socket->errorString());
-        logError(_lastError);
+
+    if (!router->connect()) {
+        logError(QString("Failed to connect to Redis (%1)").arg(RedisRouter::modeToString(config.mode)));
+        setConnected(false);
         return false;
     }
-    
-    // 认证（如果需要）
-    if (!_password.isEmpty()) {
-        Result authResult = sendCommand("AUTH", {_password});
-        if (authResult != Success) {
-            _lastError = "Redis authentication failed";
-            logError(_lastError);
-            return false;
-        }
-    }
-    
-    // 选择数据库
-    if (_database != 0) {
-        Result selectResult = sendCommand("SELECT", {QString::number(_database)});
-        if (selectResult != Success) {
-            _lastError = QString("Failed to select Redis database %1").arg(_database);
-            logError(_lastError);
-            return false;
-        }
+
+    switch (config.mode) {
+    case RedisRouter::Cluster:
+        LOG_INFO(QString("Connected to Redis Cluster via %1").arg(config.clusterNodes.join(", ")));
+        break;
+    case RedisRouter::Sentinel:
+        LOG_INFO(QString("Connected to Redis master %1 via sentinels %2")
+                 .arg(config.masterName, config.sentinels.join(", ")));
+        break;
+    default:
+        LOG_INFO(QString("Connected to Redis: %1:%2 (DB: %3)")
+                 .arg(config.host).arg(config.port).arg(config.database));
+        break;
     }
-    
-    _isConnected = true;
-    
-    LOG_INFO(QString("Connected to Redis: %1:%2 (DB: %3)")
-             .arg(_host).arg(_port).arg(_database));
-    
-    emit connectionStateChanged(true);
+
+    setConnected(true);
     return true;
 }
 
 void RedisClient::close()
 {
-    QMutexLocker locker(&_commandMutex);
-    
     _reconnectTimer->stop();
-    
-    if (_socket->state() != QAbstractSocket::UnconnectedState) {
-        _socket->disconnectFromHost();
-        if (_socket->state() != QAbstractSocket::UnconnectedState) {
-            _socket->waitForDisconnected(3000);
-        }
+    {
+        QMutexLocker locker(&_stateMutex);
+        _router.reset();
     }
-    
-    _isConnected = false;
-    emit connectionStateChanged(false);
-    
-    // LOG_INFO removed
+    setConnected(false);
 }
 
 bool RedisClient::isConnected() const
 {
-    QMutexLocker locker(&_commandMutex);
-    return _isConnected && _socket->state() == QAbstractSocket::ConnectedState;
+    QMutexLocker locker(&_stateMutex);
+    return _isConnected && _router;
 }
 
 RedisClient::Result RedisClient::set(const QString &key, const QString &value, int expireSeconds)
 {
     if (expireSeconds > 0) {
-        return sendCommand("SETEX", {key, QString::number(expireSeconds), value});
+        return toResult(execute({"SETEX", key.toUtf8(), QByteArray::number(expireSeconds), value.toUtf8()}));
     } else {
-        return sendCommand("SET", {key, value});
+        return toResult(execute({"SET", key.toUtf8(), value.toUtf8()}));
     }
 }
 
 RedisClient::Result RedisClient::get(const QString &key, QString &value)
 {
-    QString response;
-    Result result = sendCommand("GET", {key});
-    
+    RedisReply reply = execute({"GET", key.toUtf8()});
+    Result result = toResult(reply);
+
     if (result == Success) {
-        if (readResponse(response) == Success) {
-            if (response == "$-1") {
-                return NotFound;
-            }
-            value = response;
-            return Success;
+        if (reply.isNil()) {
+            return NotFound;
         }
+        value = QString::fromUtf8(reply.str);
     }
-    
+
     return result;
 }
 
 RedisClient::Result RedisClient::del(const QString &key)
 {
-    return sendCommand("DEL", {key});
+    return toResult(execute({"DEL", key.toUtf8()}));
 }
 
 bool RedisClient::exists(const QString &key)
 {
-    QString response;
-    Result result = sendCommand("EXISTS", {key});
-    
-    if (result == Success) {
-        if (readResponse(response) == Success) {
-            return response.toInt() > 0;
-        }
-    }
-    
-    return false;
+    RedisReply reply = execute({"EXISTS", key.toUtf8()});
+    return reply.type == RedisReply::Integer && reply.integer > 0;
 }
 
 RedisClient::Result RedisClient::expire(const QString &key, int expireSeconds)
 {
-    return sendCommand("EXPIRE", {key, QString::number(expireSeconds)});
+    return toResult(execute({"EXPIRE", key.toUtf8(), QByteArray::number(expireSeconds)}));
 }
 
 int RedisClient::ttl(const QString &key)
 {
-    QString response;
-    Result result = sendCommand("TTL", {key});
-    
-    if (result == Success) {
-        if (readResponse(response) == Success) {
-            return response.toInt();
-        }
+    RedisReply reply = execute({"TTL", key.toUtf8()});
+    if (reply.type == RedisReply::Integer) {
+        return static_cast<int>(reply.integer);
     }
-    
+
     return -2; // 键不存在
 }
 
 qint64 RedisClient::incr(const QString &key, qint64 increment)
 {
-    QString response;
-    Result result;
-    
+    RedisReply reply;
+
     if (increment == 1) {
-        result = sendCommand("INCR", {key});
+        reply = execute({"INCR", key.toUtf8()});
     } else {
-        result = sendCommand("INCRBY", {key, QString::number(increment)});
-    }
-    
-    if (result == Success) {
-        if (readResponse(response) == Success) {
-            return response.toLongLong();
-        }
+        reply = execute({"INCRBY", key.toUtf8(), QByteArray::number(increment)});
     }
-    
-    return -1;
+
+    return reply.type == RedisReply::Integer ? reply.integer : -1;
 }
 
 qint64 RedisClient::decr(const QString &key, qint64 decrement)
 {
-    QString response;
-    Result result;
-    
+    RedisReply reply;
+
     if (decrement == 1) {
-        result = sendCommand("DECR", {key});
+        reply = execute({"DECR", key.toUtf8()});
     } else {
-        result = sendCommand("DECRBY", {key, QString::number(decrement)});
-    }
-    
-    if (result == Success) {
-        if (readResponse(response) == Success) {
-            return response.toLongLong();
-        }
+        reply = execute({"DECRBY", key.toUtf8(), QByteArray::number(decrement)});
     }
-    
-    return -1;
+
+    return reply.type == RedisReply::Integer ? reply.integer : -1;
 }
 
 bool RedisClient::ping()
 {
-    Result result = sendCommand("PING");
-    return result == Success;
+    return execute({"PING"}).type == RedisReply::Status;
 }
 
 QString RedisClient::info()
 {
-    QString response;
-    Result result = sendCommand("INFO");
-    
-    if (result == Success) {
-        if (readResponse(response) == Success) {
-            return response;
-        }
+    RedisReply reply = execute({"INFO"});
+    if (reply.type == RedisReply::Bulk) {
+        return QString::fromUtf8(reply.str);
     }
-    
+
     return "";
 }
 
 RedisClient::Result RedisClient::flushdb()
 {
-    return sendCommand("FLUSHDB");
+    QSharedPointer<RedisRouter> router;
+    {
+        QMutexLocker locker(&_stateMutex);
+        router = _router;
+    }
+    if (!router) {
+        return ConnectionError;
+    }
+
+    // Cluster模式下每个主节点各自清空
+    for (const RedisReply &reply : router->commandOnMasters({"FLUSHDB"})) {
+        Result result = toResult(reply);
+        if (result != Success) {
+            return result;
+        }
+    }
+    return Success;
 }
 
 RedisClient::Result RedisClient::setVerificationCode(const QString &email, const QString &code, int expireMinutes)
 {
-    QString key = QString("verification_code:%1").arg(email);
+    QString key = RedisKeys::emailKey(email, "verification_code");
     return set(key, code, expireMinutes * 60);
 }
 
 RedisClient::Result RedisClient::getVerificationCode(const QString &email, QString &code)
 {
-    QString key = QString("verification_code:%1").arg(email);
+    QString key = RedisKeys::emailKey(email, "verification_code");
     return get(key, code);
 }
 
 RedisClient::Result RedisClient::deleteVerificationCode(const QString &email)
 {
-    QString key = QString("verification_code:%1").arg(email);
+    QString key = RedisKeys::emailKey(email, "verification_code");
     return del(key);
 }
 
 RedisClient::Result RedisClient::setSessionToken(qint64 userId, const QString &token, int expireHours)
 {
-    QString key = QString("session_token:%1").arg(userId);
+    QString key = RedisKeys::userKey(userId, "session_token");
     return set(key, token, expireHours * 3600);
 }
 
 RedisClient::Result RedisClient::getSessionToken(qint64 userId, QString &token)
 {
-    QString key = QString("session_token:%1").arg(userId);
+    QString key = RedisKeys::userKey(userId, "session_token");
     return get(key, token);
 }
 
 RedisClient::Result RedisClient::deleteSessionToken(qint64 userId)
 {
-    QString key = QString("session_token:%1").arg(userId);
+    QString key = RedisKeys::userKey(userId, "session_token");
     return del(key);
 }
 
 QStringList RedisClient::keys(const QString &pattern)
 {
     QStringList result;
-    QString response;
-    
-    Result redisResult = sendCommand("KEYS", {pattern});
-    if (redisResult == Success) {
-        if (readResponse(response) == Success) {
-            // 解析数组响应
-            if (response.startsWith('*')) {
-                QStringList lines = response.split('\n');
-                int count = lines[0].mid(1).toInt();
-                
-                for (int i = 1; i < lines.size() && result.size() < count; i++) {
-                    QString line = lines[i].trimmed();
-                    if (line.startsWith('$') && i + 1 < lines.size()) {
-                        i++; // 跳过长度行
-                        result.append(lines[i].trimmed());
-                    }
-                }
-            }
-        }
-    }
-    
-    return result;
-}
-
-void RedisClient::onConnected()
-{
-
-    _isConnected = true;
-    emit connectionStateChanged(true);
-}
-
-void RedisClient::onDisconnected()
-{
-    LOG_WARNING("Redis disconnected");
-    _isConnected = false;
-    emit connectionStateChanged(false);
 
-    // 启动重连定时器
-    if (!_reconnectTimer->isActive()) {
-        _reconnectTimer->start(_reconnectInterval);
+    QSharedPointer<RedisRouter> router;
+    {
+        QMutexLocker locker(&_stateMutex);
+        router = _router;
+    }
+    if (!router) {
+        return result;
     }
-}
-
-void RedisClient::onReadyRead()
-{
-    // 数据读取在sendCommand中处理
-}
 
-void RedisClient::onSocketError(QAbstractSocket::SocketError error)
-{
-    QString errorString = _socket->errorString();
-    _lastError = QString("Redis socket error: %1").arg(errorString);
-    logError(_lastError);
+    // 键分布在各主节点上，逐个收集
+    for (const RedisReply &reply : router->commandOnMasters({"KEYS", pattern.toUtf8()})) {
+        if (reply.type != RedisReply::Array) {
+            toResult(reply);
+            continue;
+        }
+        for (const RedisReply &element : reply.elements) {
+            result.append(QString::fromUtf8(element.str));
+        }
+    }
 
-    _isConnected = false;
-    emit connectionStateChanged(false);
-    emit redisError(errorString);
+    return result;
 }
 
-void RedisClient::onReconnectTimer()
+QJsonObject RedisClient::getStatistics() const
 {
-    // LOG_INFO removed
-    reconnect();
-}
+    QSharedPointer<RedisRouter> router;
+    {
+        QMutexLocker locker(&_stateMutex);
+        router = _router;
+    }
 
-bool RedisClient::reconnect()
-{
-    return initialize(_host, _port, _password, _database);
+    QJsonObject stats = router ? router->getStatistics() : QJsonObject();
+    stats["connected"] = isConnected();
+    return stats;
 }
 
-RedisClient::Result RedisClient::sendCommand(const QString &command, const QStringList &args)
+RedisReply RedisClient::execute(const QList<QByteArray> &args)
 {
-    QMutexLocker locker(&_commandMutex);
-
-    // 直接检查连接状态，避免调用isConnected()导致递归锁定
-    if (!_isConnected || _socket->state() != QAbstractSocket::ConnectedState) {
-        if (!reconnect()) {
-            return ConnectionError;
-        }
-    }
+    TRACE_SPAN("RedisClient::execute");
 
-    QByteArray data = formatCommand(command, args);
-
-    qint64 bytesWritten = _socket->write(data);
-    if (bytesWritten == -1) {
-        _lastError = "Failed to write command to Redis";
-        logError(_lastError);
-        return Error;
+    QSharedPointer<RedisRouter> router;
+    {
+        QMutexLocker locker(&_stateMutex);
+        router = _router;
     }
-
-    // 释放锁后再进行阻塞等待
-    locker.unlock();
-
-    if (!_socket->waitForBytesWritten(_commandTimeout)) {
-        QMutexLocker relocker(&_commandMutex);
-        _lastError = "Timeout writing command to Redis";
-        logError(_lastError);
-        return Timeout;
+    if (!router) {
+        return RedisReply();
     }
 
-    return Success;
+    RedisReply reply = router->command(args);
+    setConnected(reply.type != RedisReply::Invalid);
+    return reply;
 }
 
-RedisClient::Result RedisClient::readResponse(QString &response, int timeout)
+RedisClient::Result RedisClient::toResult(const RedisReply &reply)
 {
-    // 在锁外进行阻塞等待，避免阻塞其他线程
-    if (!_socket->waitForReadyRead(timeout)) {
-        QMutexLocker locker(&_commandMutex);
-        _lastError = "Timeout reading response from Redis";
-        logError(_lastError);
-        return Timeout;
-    }
-
-    QMutexLocker locker(&_commandMutex);
-
-    QByteArray data = _socket->readAll();
-    
-    if (!parseResponse(data, response)) {
-        _lastError = "Failed to parse Redis response";
-        logError(_lastError);
+    switch (reply.type) {
+    case RedisReply::Invalid:
+        logError("Redis connection unavailable");
+        return ConnectionError;
+    case RedisReply::Error:
+        logError(QString::fromUtf8(reply.str));
+        emit redisError(QString::fromUtf8(reply.str));
         return Error;
+    default:
+        return Success;
     }
-
-
-    return Success;
 }
 
-bool RedisClient::parseResponse(const QByteArray &data, QString &result)
+void RedisClient::setConnected(bool connected)
 {
-    if (data.isEmpty()) {
-        return false;
-    }
-
-    // 解析Redis响应数据
-
-
-    // 处理混合响应（如 "OK\r\n$6\r\n607496"）
-    // 查找最后一个批量字符串响应
-    int lastBulkStringPos = data.lastIndexOf('$');
-    if (lastBulkStringPos > 0) {
-    
-        QByteArray bulkStringData = data.mid(lastBulkStringPos);
-        return parseResponse(bulkStringData, result);
+    {
+        QMutexLocker locker(&_stateMutex);
+        if (_isConnected == connected) {
+            return;
+        }
+        _isConnected = connected;
     }
 
-    char type = data[0];
-    
-    switch (type) {
-        case '+': // 简单字符串
-            {
-                QString content = QString::fromUtf8(data.mid(1)).trimmed();
-                result = content;
-            
-                return true;
-            }
-
-        case '-': // 错误
-            {
-                QString content = QString::fromUtf8(data.mid(1)).trimmed();
-                _lastError = content;
-                logError(_lastError);
-                return false;
-            }
-
-        case ':': // 整数
-            {
-                QString content = QString::fromUtf8(data.mid(1)).trimmed();
-                result = content;
-            
-                return true;
-            }
-
-        case '$': // 批量字符串
-            {
-                // 找到第一个\r\n，获取长度
-                int firstCRLF = data.indexOf("\r\n");
-                if (firstCRLF == -1) {
-                
-                    return false;
-                }
-                
-                QString lengthStr = QString::fromUtf8(data.mid(1, firstCRLF - 1));
-                int length = lengthStr.toInt();
-                
-            
-                
-                if (length == -1) {
-                    result = "$-1"; // NULL
-                
-                    return true;
-                } else if (length >= 0) {
-                    // 实际字符串从第一个\r\n之后开始
-                    int contentStart = firstCRLF + 2;
-                    if (data.length() >= contentStart + length) {
-                        result = QString::fromUtf8(data.mid(contentStart, length));
-                    
-                        return true;
-                    } else {
-                    
-                    }
-                }
-                return false;
-            }
-
-        case '*': // 数组
-            {
-                QString content = QString::fromUtf8(data.mid(1)).trimmed();
-                result = content;
-            
-                return true;
+    if (!connected) {
+        LOG_WARNING("Redis disconnected");
+        // 可能在任意线程中发现断开，定时器在所属线程中启动
+        QMetaObject::invokeMethod(_reconnectTimer, [this]() {
+            if (!_reconnectTimer->isActive()) {
+                _reconnectTimer->start(_reconnectInterval);
             }
-
-        default:
-        
-            return false;
+        }, Qt::QueuedConnection);
     }
+    emit connectionStateChanged(connected);
 }
 
-QByteArray RedisClient::formatCommand(const QString &command, const QStringList &args)
+void RedisClient::onReconnectTimer()
 {
-    QByteArray result;
-    QStringList allArgs;
-    allArgs << command << args;
-
-    // Redis协议格式：*<参数数量>\r\n$<参数长度>\r\n<参数内容>\r\n...
-    result.append(QString("*%1\r\n").arg(allArgs.size()).toUtf8());
-
-    for (const QString &arg : allArgs) {
-        QByteArray argBytes = arg.toUtf8();
-        result.append(QString("$%1\r\n").arg(argBytes.size()).toUtf8());
-        result.append(argBytes);
-        result.append("\r\n");
+    bool hasRouter = false;
+    {
+        QMutexLocker locker(&_stateMutex);
+        hasRouter = !_router.isNull();
     }
 
-    return result;
+    // close()之后不再探测；PING成功时execute()会恢复连接状态
+    if (hasRouter && !ping()) {
+        _reconnectTimer->start(_reconnectInterval);
+    }
 }
 
 void RedisClient::logError(const QString &error)
 {
     LOG_ERROR(error);
+    QMutexLocker locker(&_stateMutex);
     _lastError = error;
 }
@@ -4,10 +4,11 @@
 #include <QObject>
 #include <QString>
 #include <QVariant>
-#include <QTimer>
 #include <QMutex>
-#include <QTcpSocket>
-#include <QQueue>
+#include <QTimer>
+#include <QJsonObject>
+#include <QSharedPointer>
+#include "RedisRouter.h"
 
 /**
  * @brief Redis客户端类
@@ -15,6 +16,9 @@
  * 提供与Redis服务器的连接和基本操作功能。
  * 支持字符串操作、过期时间设置、连接池等功能。
  * 主要用于存储验证码、会话令牌和临时数据。
+ *
+ * 命令经RedisRouter执行，支持单机、Cluster和Sentinel部署；每个线程使用自己的连接，
+ * 可在任意线程调用。键名遵循RedisKeys的哈希标签约定。
  */
 class RedisClient : public QObject
 {
@@ -53,6 +57,13 @@ public:
     bool initialize(const QString &host = "localhost", int port = 6379, 
                    const QString &password = "", int database = 0);
     
+    /**
+     * @brief 按路由配置初始化（单机、Cluster或Sentinel）
+     * @param config 路由配置
+     * @return 初始化是否成功
+     */
+    bool initialize(const RedisRouter::Config &config);
+    
     /**
      * @brief 关闭Redis连接
      */
@@ -194,10 +205,16 @@ public:
     
     /**
      * @brief 获取匹配模式的键列表
-     * @param pattern 匹配模式，如 "session:*"
-     * @return 键列表
+     * @param pattern 匹配模式，如 RedisKeys::sessionPattern()
+     * @return 键列表（Cluster模式下汇总所有主节点）
      */
     QStringList keys(const QString &pattern);
+    
+    /**
+     * @brief 获取路由统计信息
+     * @return 统计信息
+     */
+    QJsonObject getStatistics() const;
 
 signals:
     /**
@@ -213,50 +230,28 @@ signals:
     void redisError(const QString &error);
 
 private slots:
-    void onConnected();
-    void onDisconnected();
-    void onReadyRead();
-    void onSocketError(QAbstractSocket::SocketError error);
+    /**
+     * @brief 断开后定期探测，恢复时发出连接状态信号
+     */
     void onReconnectTimer();
 
 private:
     /**
-     * @brief 重新连接Redis
-     * @return 重连是否成功
+     * @brief 执行命令并返回应答，连接状态随结果更新
+     * @param args 命令及参数
+     * @return 应答，未初始化或连接失败时为Invalid
      */
-    bool reconnect();
+    RedisReply execute(const QList<QByteArray> &args);
     
     /**
-     * @brief 发送Redis命令
-     * @param command 命令
-     * @param args 参数列表
-     * @return 操作结果
+     * @brief 将应答转换为操作结果
      */
-    Result sendCommand(const QString &command, const QStringList &args = QStringList());
+    Result toResult(const RedisReply &reply);
     
     /**
-     * @brief 读取Redis响应
-     * @param response 输出响应
-     * @param timeout 超时时间（毫秒）
-     * @return 操作结果
+     * @brief 更新连接状态，变化时发出信号
      */
-    Result readResponse(QString &response, int timeout = 5000);
-    
-    /**
-     * @brief 解析Redis响应
-     * @param data 响应数据
-     * @param result 输出结果
-     * @return 解析是否成功
-     */
-    bool parseResponse(const QByteArray &data, QString &result);
-    
-    /**
-     * @brief 格式化Redis命令
-     * @param command 命令
-     * @param args 参数列表
-     * @return 格式化后的命令
-     */
-    QByteArray formatCommand(const QString &command, const QStringList &args);
+    void setConnected(bool connected);
     
     /**
      * @brief 记录错误
@@ -268,22 +263,13 @@ private:
     static RedisClient* s_instance;
     static QMutex s_mutex;
     
-    QTcpSocket* _socket;
-    QTimer* _reconnectTimer;
-    
-    QString _host;
-    int _port;
-    QString _password;
-    int _database;
+    QSharedPointer<RedisRouter> _router;     // 重新初始化时替换，进行中的命令持有旧实例
     bool _isConnected;
+    QTimer* _reconnectTimer;
+    int _reconnectInterval;
     
     QString _lastError;
-    mutable QMutex _commandMutex;
-    
-    // 连接配置
-    int _connectTimeout;
-    int _commandTimeout;
-    int _reconnectInterval;
+    mutable QMutex _stateMutex;
 };
 
 #endif // REDISCLIENT_H
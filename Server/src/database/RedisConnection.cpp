@@ -0,0 +1,320 @@
+#include "RedisConnection.h"
+#include "../utils/Logger.h"
+#include <QTcpSocket>
+
+namespace {
+
+// 重连失败后的静默期
+const qint64 RECONNECT_BACKOFF_MS = 1000;
+
+// 嵌套数组的最大深度，防止异常应答导致递归过深
+const int MAX_REPLY_DEPTH = 8;
+
+} // namespace
+
+RedisConnection::RedisConnection()
+    : _socket(nullptr)
+    , _readPos(0)
+    , _sent(false)
+    , _port(6379)
+    , _database(0)
+    , _timeoutMs(500)
+{
+}
+
+RedisConnection::~RedisConnection()
+{
+    close();
+}
+
+void RedisConnection::setServer(const QString &host, int port, const QString &password,
+                                int database, int timeoutMs)
+{
+    if (host != _host || port != _port || password != _password || database != _database) {
+        close();
+    }
+
+    _host = host;
+    _port = port;
+    _password = password;
+    _database = database;
+    _timeoutMs = qMax(1, timeoutMs);
+}
+
+bool RedisConnection::connectToServer()
+{
+    if (isConnected()) {
+        return true;
+    }
+
+    close();
+    _socket = new QTcpSocket();
+    _socket->connectToHost(_host, _port);
+    if (!_socket->waitForConnected(_timeoutMs)) {
+        fail(QString("Failed to connect to Redis %1:%2: %3").arg(_host).arg(_port).arg(_socket->errorString()));
+        return false;
+    }
+    _socket->setSocketOption(QAbstractSocket::LowDelayOption, 1);
+
+    QList<QList<QByteArray>> handshake;
+    if (!_password.isEmpty()) {
+        handshake.append({"AUTH", _password.toUtf8()});
+    }
+    if (_database != 0) {
+        handshake.append({"SELECT", QByteArray::number(_database)});
+    }
+    if (!handshake.isEmpty()) {
+        QByteArray data;
+        for (const QList<QByteArray> &args : handshake) {
+            data += encode(args);
+        }
+        if (!writeAll(data)) {
+            return false;
+        }
+        for (int i = 0; i < handshake.size(); ++i) {
+            RedisReply reply;
+            if (!readReply(&reply)) {
+                return false;
+            }
+            if (reply.type == RedisReply::Error) {
+                fail(QString("Redis handshake failed: %1").arg(QString::fromUtf8(reply.str)));
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+void RedisConnection::close()
+{
+    if (_socket) {
+        _socket->abort();
+        delete _socket;
+        _socket = nullptr;
+    }
+    _buffer.clear();
+    _readPos = 0;
+}
+
+bool RedisConnection::isConnected() const
+{
+    return _socket && _socket->state() == QAbstractSocket::ConnectedState;
+}
+
+RedisReply RedisConnection::command(const QList<QByteArray> &args)
+{
+    QList<RedisReply> replies = pipeline({args});
+    return replies.isEmpty() ? RedisReply() : replies.first();
+}
+
+QList<RedisReply> RedisConnection::pipeline(const QList<QList<QByteArray>> &commands)
+{
+    QList<RedisReply> replies;
+    replies.reserve(commands.size());
+    _sent = false;
+    if (commands.isEmpty()) {
+        return replies;
+    }
+
+    if (ensureConnected()) {
+        QByteArray data;
+        for (const QList<QByteArray> &args : commands) {
+            data += encode(args);
+        }
+
+        if (writeAll(data)) {
+            _sent = true;
+            for (int i = 0; i < commands.size(); ++i) {
+                RedisReply reply;
+                if (!readReply(&reply)) {
+                    break;
+                }
+                replies.append(reply);
+            }
+        }
+    }
+
+    while (replies.size() < commands.size()) {
+        replies.append(RedisReply());
+    }
+    return replies;
+}
+
+QByteArray RedisConnection::encode(const QList<QByteArray> &args)
+{
+    QByteArray data;
+    data.reserve(16 + args.size() * 16);
+    data += '*';
+    data += QByteArray::number(args.size());
+    data += "\r\n";
+    for (const QByteArray &arg : args) {
+        data += '$';
+        data += QByteArray::number(arg.size());
+        data += "\r\n";
+        data += arg;
+        data += "\r\n";
+    }
+    return data;
+}
+
+bool RedisConnection::ensureConnected()
+{
+    if (isConnected()) {
+        return true;
+    }
+
+    if (_retryClock.isValid() && _retryClock.elapsed() < RECONNECT_BACKOFF_MS) {
+        return false;
+    }
+
+    if (connectToServer()) {
+        _retryClock.invalidate();
+        return true;
+    }
+
+    _retryClock.start();
+    return false;
+}
+
+bool RedisConnection::writeAll(const QByteArray &data)
+{
+    if (_socket->write(data) != data.size()) {
+        fail(QString("Redis write failed: %1").arg(_socket->errorString()));
+        return false;
+    }
+
+    while (_socket->bytesToWrite() > 0) {
+        if (!_socket->waitForBytesWritten(_timeoutMs)) {
+            fail(QString("Redis write timed out: %1").arg(_socket->errorString()));
+            return false;
+        }
+    }
+    return true;
+}
+
+bool RedisConnection::readReply(RedisReply *reply, int depth)
+{
+    if (depth > MAX_REPLY_DEPTH) {
+        fail("Redis reply nested too deeply");
+        return false;
+    }
+
+    QByteArray line;
+    if (!readLine(&line) || line.isEmpty()) {
+        if (_socket) {
+            fail("Malformed Redis reply");
+        }
+        return false;
+    }
+
+    char prefix = line.at(0);
+    QByteArray body = line.mid(1);
+
+    switch (prefix) {
+    case '+':
+        reply->type = RedisReply::Status;
+        reply->str = body;
+        return true;
+    case '-':
+        reply->type = RedisReply::Error;
+        reply->str = body;
+        return true;
+    case ':':
+        reply->type = RedisReply::Integer;
+        reply->integer = body.toLongLong();
+        return true;
+    case '$': {
+        int length = body.toInt();
+        if (length < 0) {
+            reply->type = RedisReply::Nil;
+            return true;
+        }
+        QByteArray data;
+        if (!readBytes(length + 2, &data)) {
+            return false;
+        }
+        data.chop(2);
+        reply->type = RedisReply::Bulk;
+        reply->str = data;
+        return true;
+    }
+    case '*': {
+        int count = body.toInt();
+        if (count < 0) {
+            reply->type = RedisReply::Nil;
+            return true;
+        }
+        reply->type = RedisReply::Array;
+        reply->elements.reserve(count);
+        for (int i = 0; i < count; ++i) {
+            RedisReply element;
+            if (!readReply(&element, depth + 1)) {
+                return false;
+            }
+            reply->elements.append(element);
+        }
+        return true;
+    }
+    default:
+        fail(QString("Unexpected Redis reply prefix: %1").arg(prefix));
+        return false;
+    }
+}
+
+bool RedisConnection::readLine(QByteArray *line)
+{
+    while (true) {
+        int end = _buffer.indexOf("\r\n", _readPos);
+        if (end >= 0) {
+            *line = _buffer.mid(_readPos, end - _readPos);
+            _readPos = end + 2;
+            return true;
+        }
+        if (!fill()) {
+            return false;
+        }
+    }
+}
+
+bool RedisConnection::readBytes(int count, QByteArray *data)
+{
+    while (_buffer.size() - _readPos < count) {
+        if (!fill()) {
+            return false;
+        }
+    }
+
+    *data = _buffer.mid(_readPos, count);
+    _readPos += count;
+    return true;
+}
+
+bool RedisConnection::fill()
+{
+    if (!_socket) {
+        return false;
+    }
+
+    // 已消费的数据超过一半时整理缓冲区
+    if (_readPos > 0 && _readPos >= _buffer.size() / 2) {
+        _buffer.remove(0, _readPos);
+        _readPos = 0;
+    }
+
+    if (_socket->bytesAvailable() == 0 && !_socket->waitForReadyRead(_timeoutMs)) {
+        fail(QString("Redis read timed out: %1").arg(_socket->errorString()));
+        return false;
+    }
+
+    _buffer += _socket->readAll();
+    return true;
+}
+
+void RedisConnection::fail(const QString &error)
+{
+    // 应答流已不可信，关闭连接，下次命令重连
+    _lastError = error;
+    LOG_WARNING(error);
+    close();
+}
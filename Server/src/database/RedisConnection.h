@@ -0,0 +1,118 @@
+#ifndef REDISCONNECTION_H
+#define REDISCONNECTION_H
+
+#include <QByteArray>
+#include <QList>
+#include <QString>
+#include <QElapsedTimer>
+
+class QTcpSocket;
+
+/**
+ * @brief Redis应答
+ */
+struct RedisReply {
+    enum Type {
+        Invalid,    // 连接或协议错误，未得到应答
+        Status,
+        Error,
+        Integer,
+        Bulk,
+        Nil,
+        Array
+    };
+
+    Type type = Invalid;
+    QByteArray str;               // 状态、错误信息或批量字符串
+    qint64 integer = 0;
+    QList<RedisReply> elements;
+
+    bool isOk() const { return type != Invalid && type != Error; }
+    bool isNil() const { return type == Nil; }
+};
+
+/**
+ * @brief 同步Redis连接（RESP2）
+ *
+ * 每条命令按参数数组编码，完整读取应答，支持流水线：多条命令一次写出、按顺序读回应答，
+ * 只付出一次往返。使用阻塞套接字且不依赖事件循环，可在线程池工作线程中使用；
+ * 连接不是线程安全的，每个线程持有自己的实例（见ClusterManager）。
+ *
+ * 与RedisClient的区别：RedisClient归属主线程并只解析简单应答，这里面向高频的批量命令。
+ * 发生I/O错误后连接被关闭，下一条命令自动重连，重连失败后在一秒内不再尝试。
+ */
+class RedisConnection
+{
+public:
+    RedisConnection();
+    ~RedisConnection();
+
+    RedisConnection(const RedisConnection&) = delete;
+    RedisConnection& operator=(const RedisConnection&) = delete;
+
+    /**
+     * @brief 设置连接参数，已有连接在参数变化时关闭
+     * @param timeoutMs 连接与单条应答的超时时间
+     */
+    void setServer(const QString &host, int port, const QString &password = QString(),
+                   int database = 0, int timeoutMs = 500);
+
+    /**
+     * @brief 建立连接（认证并选择数据库），已连接时直接返回
+     */
+    bool connectToServer();
+
+    void close();
+
+    bool isConnected() const;
+
+    /**
+     * @brief 执行单条命令
+     */
+    RedisReply command(const QList<QByteArray> &args);
+
+    /**
+     * @brief 流水线执行多条命令
+     * @return 与命令一一对应的应答，失败的位置为Invalid
+     */
+    QList<RedisReply> pipeline(const QList<QList<QByteArray>> &commands);
+
+    QString lastError() const { return _lastError; }
+
+    /**
+     * @brief 最近一次命令是否已完整写出
+     *
+     * 返回false时服务器未收到命令，可以安全地换节点重试；返回true而应答为Invalid时命令可能已执行。
+     */
+    bool lastCommandSent() const { return _sent; }
+
+    /**
+     * @brief 编码为RESP数组
+     */
+    static QByteArray encode(const QList<QByteArray> &args);
+
+private:
+    bool ensureConnected();
+    bool writeAll(const QByteArray &data);
+    bool readReply(RedisReply *reply, int depth = 0);
+    bool readLine(QByteArray *line);
+    bool readBytes(int count, QByteArray *data);
+    bool fill();
+    void fail(const QString &error);
+
+    QTcpSocket *_socket;
+    QByteArray _buffer;
+    int _readPos;
+    bool _sent;
+
+    QString _host;
+    int _port;
+    QString _password;
+    int _database;
+    int _timeoutMs;
+
+    QString _lastError;
+    QElapsedTimer _retryClock;
+};
+
+#endif // REDISCONNECTION_H
@@ -0,0 +1,49 @@
+#include "RedisKeys.h"
+
+// 静态成员初始化
+QString RedisKeys::s_prefix = "qkchat:";
+
+void RedisKeys::setPrefix(const QString &prefix)
+{
+    s_prefix = prefix;
+}
+
+QString RedisKeys::prefix()
+{
+    return s_prefix;
+}
+
+QString RedisKeys::userKey(qint64 userId, const QString &field)
+{
+    return QString("%1{u:%2}:%3").arg(s_prefix).arg(userId).arg(field);
+}
+
+QString RedisKeys::emailKey(const QString &email, const QString &field)
+{
+    return QString("%1{e:%2}:%3").arg(s_prefix, email.trimmed().toLower(), field);
+}
+
+QString RedisKeys::sessionKey(const QString &sessionToken)
+{
+    return QString("%1{s:%2}:session").arg(s_prefix, sessionToken);
+}
+
+QString RedisKeys::sessionPattern()
+{
+    return QString("%1{s:*}:session").arg(s_prefix);
+}
+
+QString RedisKeys::sessionTokenFromKey(const QString &key)
+{
+    QString head = s_prefix + "{s:";
+    QString tail = "}:session";
+    if (key.startsWith(head) && key.endsWith(tail)) {
+        return key.mid(head.size(), key.size() - head.size() - tail.size());
+    }
+    return key;
+}
+
+QString RedisKeys::nodeKey(const QString &nodeId, const QString &field)
+{
+    return QString("%1{n:%2}:%3").arg(s_prefix, nodeId, field);
+}
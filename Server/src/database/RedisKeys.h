@@ -0,0 +1,60 @@
+#ifndef REDISKEYS_H
+#define REDISKEYS_H
+
+#include <QString>
+#include <QByteArray>
+
+/**
+ * @brief Redis键命名约定
+ *
+ * 所有键形如 前缀 + {实体} + :字段。花括号内是Redis Cluster的哈希标签，只有标签参与槽位计算，
+ * 同一实体（用户、邮箱、会话）的所有键落在同一槽位，可以在一个节点上原子地操作或用MULTI/Lua组合，
+ * 不同实体的键均匀分布到各节点。
+ *
+ * 实体标签：u:用户ID、e:邮箱（小写）、s:会话令牌、n:集群节点ID。新增键应复用这些标签，
+ * 不要把可变的字段放进花括号。
+ */
+class RedisKeys
+{
+public:
+    /**
+     * @brief 设置全局键前缀（redis.key_prefix），应在使用任何键之前设置
+     */
+    static void setPrefix(const QString &prefix);
+    static QString prefix();
+
+    /**
+     * @brief 用户相关的键：前缀{u:用户ID}:字段
+     */
+    static QString userKey(qint64 userId, const QString &field);
+
+    /**
+     * @brief 邮箱相关的键：前缀{e:邮箱}:字段
+     */
+    static QString emailKey(const QString &email, const QString &field);
+
+    /**
+     * @brief 会话数据键：前缀{s:令牌}:session
+     */
+    static QString sessionKey(const QString &sessionToken);
+
+    /**
+     * @brief 匹配所有会话数据键的模式
+     */
+    static QString sessionPattern();
+
+    /**
+     * @brief 由会话数据键还原令牌，格式不符时返回原字符串
+     */
+    static QString sessionTokenFromKey(const QString &key);
+
+    /**
+     * @brief 集群节点相关的键：前缀{n:节点ID}:字段
+     */
+    static QString nodeKey(const QString &nodeId, const QString &field);
+
+private:
+    static QString s_prefix;
+};
+
+#endif // REDISKEYS_H
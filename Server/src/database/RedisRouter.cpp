@@ -0,0 +1,568 @@
+#include "RedisRouter.h"
+#include "../utils/Logger.h"
+#include <QThread>
+#include <algorithm>
+
+namespace {
+
+// 拓扑刷新（槽位映射、哨兵查询）的最小间隔
+const qint64 MIN_REFRESH_INTERVAL_MS = 500;
+
+// 单机模式下MGET单条命令的键数
+const int MGET_CHUNK_SIZE = 500;
+
+/**
+ * @brief CRC16-CCITT（XMODEM），与Redis Cluster的槽位算法一致
+ */
+quint16 crc16(const char *data, int length)
+{
+    static const QVector<quint16> table = []() {
+        QVector<quint16> values(256);
+        for (int i = 0; i < 256; ++i) {
+            quint16 crc = static_cast<quint16>(i << 8);
+            for (int bit = 0; bit < 8; ++bit) {
+                crc = (crc & 0x8000) ? static_cast<quint16>((crc << 1) ^ 0x1021) : static_cast<quint16>(crc << 1);
+            }
+            values[i] = crc;
+        }
+        return values;
+    }();
+
+    quint16 crc = 0;
+    for (int i = 0; i < length; ++i) {
+        crc = static_cast<quint16>((crc << 8) ^ table[((crc >> 8) ^ static_cast<quint8>(data[i])) & 0xFF]);
+    }
+    return crc;
+}
+
+/**
+ * @brief 服务器未执行、可以重发的错误应答
+ */
+bool isRetryableError(const RedisReply &reply)
+{
+    return reply.type == RedisReply::Error &&
+           (reply.str.startsWith("MOVED ") || reply.str.startsWith("ASK ") ||
+            reply.str.startsWith("TRYAGAIN") || reply.str.startsWith("CLUSTERDOWN") ||
+            reply.str.startsWith("LOADING") || reply.str.startsWith("READONLY"));
+}
+
+} // namespace
+
+RedisRouter::RedisRouter(const Config &config)
+    : _config(config)
+    , _slotOwners(SLOT_COUNT, -1)
+    , _commands(0)
+    , _movedRedirects(0)
+    , _askRedirects(0)
+    , _retries(0)
+    , _slotRefreshes(0)
+    , _masterChanges(0)
+    , _errors(0)
+{
+    if (_config.mode == Standalone) {
+        _master = QString("%1:%2").arg(_config.host).arg(_config.port);
+    }
+}
+
+RedisRouter::~RedisRouter()
+{
+}
+
+RedisRouter::Mode RedisRouter::modeFromString(const QString &mode)
+{
+    QString value = mode.trimmed().toLower();
+    if (value == "cluster") {
+        return Cluster;
+    }
+    if (value == "sentinel") {
+        return Sentinel;
+    }
+    return Standalone;
+}
+
+QString RedisRouter::modeToString(Mode mode)
+{
+    switch (mode) {
+    case Cluster:
+        return "cluster";
+    case Sentinel:
+        return "sentinel";
+    default:
+        return "standalone";
+    }
+}
+
+bool RedisRouter::connect()
+{
+    if (_config.mode == Cluster && !refreshSlots(true)) {
+        LOG_ERROR(QString("Failed to load Redis Cluster slots from %1").arg(_config.clusterNodes.join(", ")));
+        return false;
+    }
+    if (_config.mode == Sentinel && !discoverMaster(true)) {
+        LOG_ERROR(QString("No sentinel in %1 knows master %2").arg(_config.sentinels.join(", "), _config.masterName));
+        return false;
+    }
+
+    RedisReply pong = command({"PING"});
+    return pong.type == RedisReply::Status;
+}
+
+RedisReply RedisRouter::command(const QList<QByteArray> &args)
+{
+    _commands.fetchAndAddOrdered(1);
+
+    QString address;
+    bool asking = false;
+
+    for (int attempt = 0; attempt <= _config.maxRedirects; ++attempt) {
+        if (address.isEmpty()) {
+            address = addressFor(args);
+        }
+        if (address.isEmpty()) {
+            break;
+        }
+
+        RedisConnection *connection = connectionTo(address);
+        RedisReply reply;
+        if (asking) {
+            // ASK只对下一条命令生效，与ASKING在同一往返中发送
+            reply = connection->pipeline({{"ASKING"}, args}).last();
+            asking = false;
+        } else {
+            reply = connection->command(args);
+        }
+
+        if (reply.type == RedisReply::Invalid) {
+            if (connection->lastCommandSent()) {
+                // 命令可能已执行，不重发
+                _errors.fetchAndAddOrdered(1);
+                return reply;
+            }
+            onTopologyError();
+            address.clear();
+            _retries.fetchAndAddOrdered(1);
+            continue;
+        }
+
+        if (reply.type == RedisReply::Error) {
+            int slot = -1;
+            QString target;
+            if (parseRedirect(reply, "MOVED", &slot, &target)) {
+                _movedRedirects.fetchAndAddOrdered(1);
+                updateSlot(slot, target);
+                address = target;
+                continue;
+            }
+            if (parseRedirect(reply, "ASK", &slot, &target)) {
+                // 槽位迁移中，只对本次请求重定向，不更新映射
+                _askRedirects.fetchAndAddOrdered(1);
+                address = target;
+                asking = true;
+                continue;
+            }
+            if (reply.str.startsWith("READONLY")) {
+                // 主节点已降级为副本
+                onTopologyError();
+                address.clear();
+                _retries.fetchAndAddOrdered(1);
+                continue;
+            }
+            if (reply.str.startsWith("TRYAGAIN") || reply.str.startsWith("CLUSTERDOWN") ||
+                reply.str.startsWith("LOADING")) {
+                QThread::msleep(static_cast<unsigned long>(qMin(100, 10 << attempt)));
+                address.clear();
+                _retries.fetchAndAddOrdered(1);
+                continue;
+            }
+        }
+
+        return reply;
+    }
+
+    _errors.fetchAndAddOrdered(1);
+    return RedisReply();
+}
+
+QList<RedisReply> RedisRouter::pipeline(const QList<QList<QByteArray>> &commands)
+{
+    QList<RedisReply> replies;
+    replies.reserve(commands.size());
+    for (int i = 0; i < commands.size(); ++i) {
+        replies.append(RedisReply());
+    }
+    if (commands.isEmpty()) {
+        return replies;
+    }
+
+    // 按节点分组，每个节点一次往返
+    QHash<QString, QList<int>> groups;
+    QStringList order;
+    QList<int> retry;
+    for (int i = 0; i < commands.size(); ++i) {
+        QString address = addressFor(commands.at(i));
+        if (address.isEmpty()) {
+            retry.append(i);
+            continue;
+        }
+        if (!groups.contains(address)) {
+            order.append(address);
+        }
+        groups[address].append(i);
+    }
+
+    for (const QString &address : order) {
+        const QList<int> &indexes = groups.value(address);
+        QList<QList<QByteArray>> batch;
+        batch.reserve(indexes.size());
+        for (int index : indexes) {
+            batch.append(commands.at(index));
+        }
+
+        RedisConnection *connection = connectionTo(address);
+        QList<RedisReply> results = connection->pipeline(batch);
+        bool sent = connection->lastCommandSent();
+        _commands.fetchAndAddOrdered(indexes.size());
+
+        for (int j = 0; j < indexes.size(); ++j) {
+            const RedisReply &reply = results.at(j);
+            if ((reply.type == RedisReply::Invalid && !sent) || isRetryableError(reply)) {
+                retry.append(indexes.at(j));
+            } else {
+                replies[indexes.at(j)] = reply;
+            }
+        }
+    }
+
+    // 被重定向或未送达的命令按原顺序逐条重发
+    std::sort(retry.begin(), retry.end());
+    for (int index : retry) {
+        replies[index] = command(commands.at(index));
+    }
+
+    return replies;
+}
+
+QList<RedisReply> RedisRouter::getMany(const QList<QByteArray> &keys)
+{
+    QList<QList<QByteArray>> commands;
+
+    if (_config.mode == Cluster) {
+        // 不同槽位的键不能放进同一条MGET
+        for (const QByteArray &key : keys) {
+            commands.append({"GET", key});
+        }
+        return pipeline(commands);
+    }
+
+    for (int start = 0; start < keys.size(); start += MGET_CHUNK_SIZE) {
+        QList<QByteArray> args;
+        args.append("MGET");
+        args.append(keys.mid(start, MGET_CHUNK_SIZE));
+        commands.append(args);
+    }
+
+    QList<RedisReply> replies;
+    replies.reserve(keys.size());
+    QList<RedisReply> chunks = pipeline(commands);
+    for (int chunk = 0; chunk < chunks.size(); ++chunk) {
+        int count = qMin(MGET_CHUNK_SIZE, keys.size() - chunk * MGET_CHUNK_SIZE);
+        const RedisReply &reply = chunks.at(chunk);
+        for (int i = 0; i < count; ++i) {
+            replies.append(reply.type == RedisReply::Array && i < reply.elements.size()
+                           ? reply.elements.at(i) : reply);
+        }
+    }
+    return replies;
+}
+
+QList<RedisReply> RedisRouter::commandOnMasters(const QList<QByteArray> &args)
+{
+    if (_config.mode != Cluster) {
+        return {command(args)};
+    }
+
+    QStringList nodes;
+    {
+        QMutexLocker locker(&_mutex);
+        nodes = _nodes;
+    }
+    if (nodes.isEmpty() && refreshSlots(false)) {
+        QMutexLocker locker(&_mutex);
+        nodes = _nodes;
+    }
+
+    QList<RedisReply> replies;
+    for (const QString &address : nodes) {
+        _commands.fetchAndAddOrdered(1);
+        replies.append(connectionTo(address)->command(args));
+    }
+    return replies;
+}
+
+int RedisRouter::keySlot(const QByteArray &key)
+{
+    int start = key.indexOf('{');
+    if (start >= 0) {
+        int end = key.indexOf('}', start + 1);
+        if (end > start + 1) {
+            return crc16(key.constData() + start + 1, end - start - 1) & (SLOT_COUNT - 1);
+        }
+    }
+    return crc16(key.constData(), key.size()) & (SLOT_COUNT - 1);
+}
+
+int RedisRouter::keyIndex(const QList<QByteArray> &args)
+{
+    if (args.size() < 2) {
+        return -1;
+    }
+
+    QByteArray name = args.first().toUpper();
+    if (name == "EVAL" || name == "EVALSHA") {
+        return args.size() > 3 && args.at(2).toInt() > 0 ? 3 : -1;
+    }
+
+    static const QList<QByteArray> keyless = {
+        "PING", "INFO", "AUTH", "SELECT", "FLUSHDB", "FLUSHALL", "KEYS", "SCAN", "DBSIZE",
+        "CLUSTER", "SENTINEL", "ROLE", "ASKING", "SCRIPT", "CONFIG", "CLIENT", "TIME"
+    };
+    return keyless.contains(name) ? -1 : 1;
+}
+
+QString RedisRouter::addressFor(const QList<QByteArray> &args)
+{
+    if (_config.mode != Cluster) {
+        {
+            QMutexLocker locker(&_mutex);
+            if (!_master.isEmpty()) {
+                return _master;
+            }
+        }
+        discoverMaster(false);
+        QMutexLocker locker(&_mutex);
+        return _master;
+    }
+
+    int index = keyIndex(args);
+    if (index < 0) {
+        return anyMaster();
+    }
+
+    int slot = keySlot(args.at(index));
+    {
+        QMutexLocker locker(&_mutex);
+        int owner = _slotOwners.at(slot);
+        if (owner >= 0) {
+            return _nodes.at(owner);
+        }
+    }
+
+    // 槽位未知时刷新映射，仍未知则发往任一节点，由MOVED纠正
+    refreshSlots(false);
+    QMutexLocker locker(&_mutex);
+    int owner = _slotOwners.at(slot);
+    if (owner >= 0) {
+        return _nodes.at(owner);
+    }
+    locker.unlock();
+    return anyMaster();
+}
+
+QString RedisRouter::anyMaster()
+{
+    QMutexLocker locker(&_mutex);
+    if (_config.mode != Cluster) {
+        return _master;
+    }
+    if (!_nodes.isEmpty()) {
+        return _nodes.first();
+    }
+    return _config.clusterNodes.isEmpty() ? QString() : _config.clusterNodes.first();
+}
+
+RedisConnection* RedisRouter::connectionTo(const QString &address, bool sentinel)
+{
+    if (!_connections.hasLocalData()) {
+        _connections.setLocalData(new ThreadConnections());
+    }
+
+    ThreadConnections *connections = _connections.localData();
+    QString id = sentinel ? QString("sentinel/%1").arg(address) : address;
+    RedisConnection *connection = connections->byAddress.value(id, nullptr);
+    if (!connection) {
+        int separator = address.lastIndexOf(':');
+        QString host = separator > 0 ? address.left(separator) : address;
+        int port = separator > 0 ? address.mid(separator + 1).toInt() : 6379;
+        int database = (sentinel || _config.mode == Cluster) ? 0 : _config.database;
+
+        connection = new RedisConnection();
+        connection->setServer(host, port, sentinel ? _config.sentinelPassword : _config.password,
+                              database, _config.timeoutMs);
+        connections->byAddress.insert(id, connection);
+    }
+    return connection;
+}
+
+bool RedisRouter::refreshSlots(bool force)
+{
+    QStringList candidates;
+    {
+        QMutexLocker locker(&_mutex);
+        if (!force && _lastRefresh.isValid() && _lastRefresh.elapsed() < MIN_REFRESH_INTERVAL_MS) {
+            return !_nodes.isEmpty();
+        }
+        _lastRefresh.start();
+        candidates = _nodes + _config.clusterNodes;
+    }
+    candidates.removeDuplicates();
+
+    for (const QString &address : candidates) {
+        RedisReply reply = connectionTo(address)->command({"CLUSTER", "SLOTS"});
+        if (reply.type != RedisReply::Array) {
+            continue;
+        }
+
+        QString queriedHost = address.left(address.lastIndexOf(':'));
+        QVector<qint16> owners(SLOT_COUNT, -1);
+        QStringList nodes;
+
+        // 每个元素：[起始槽位, 结束槽位, [主节点host, port, id], 副本...]
+        for (const RedisReply &range : reply.elements) {
+            if (range.type != RedisReply::Array || range.elements.size() < 3 ||
+                range.elements.at(2).elements.size() < 2) {
+                continue;
+            }
+            const RedisReply &master = range.elements.at(2);
+            QString host = QString::fromUtf8(master.elements.at(0).str);
+            if (host.isEmpty()) {
+                host = queriedHost;
+            }
+            QString node = QString("%1:%2").arg(host).arg(master.elements.at(1).integer);
+
+            int index = nodes.indexOf(node);
+            if (index < 0) {
+                index = nodes.size();
+                nodes.append(node);
+            }
+
+            int first = qBound<qint64>(0, range.elements.at(0).integer, SLOT_COUNT - 1);
+            int last = qBound<qint64>(0, range.elements.at(1).integer, SLOT_COUNT - 1);
+            for (int slot = first; slot <= last; ++slot) {
+                owners[slot] = static_cast<qint16>(index);
+            }
+        }
+
+        if (nodes.isEmpty()) {
+            continue;
+        }
+
+        QMutexLocker locker(&_mutex);
+        _slotOwners = owners;
+        _nodes = nodes;
+        _slotRefreshes.fetchAndAddOrdered(1);
+        return true;
+    }
+
+    return false;
+}
+
+bool RedisRouter::discoverMaster(bool force)
+{
+    if (_config.mode != Sentinel) {
+        QMutexLocker locker(&_mutex);
+        return !_master.isEmpty();
+    }
+
+    {
+        QMutexLocker locker(&_mutex);
+        if (!force && _lastRefresh.isValid() && _lastRefresh.elapsed() < MIN_REFRESH_INTERVAL_MS) {
+            return !_master.isEmpty();
+        }
+        _lastRefresh.start();
+    }
+
+    for (const QString &sentinel : _config.sentinels) {
+        RedisReply reply = connectionTo(sentinel, true)->command(
+            {"SENTINEL", "get-master-addr-by-name", _config.masterName.toUtf8()});
+        if (reply.type != RedisReply::Array || reply.elements.size() < 2) {
+            continue;
+        }
+
+        QString address = QString("%1:%2").arg(QString::fromUtf8(reply.elements.at(0).str),
+                                                QString::fromUtf8(reply.elements.at(1).str));
+        QString previous;
+        {
+            QMutexLocker locker(&_mutex);
+            previous = _master;
+            _master = address;
+        }
+        if (previous != address) {
+            _masterChanges.fetchAndAddOrdered(1);
+            LOG_WARNING(QString("Redis master %1 is now at %2").arg(_config.masterName, address));
+        }
+        return true;
+    }
+
+    return false;
+}
+
+void RedisRouter::onTopologyError()
+{
+    if (_config.mode == Cluster) {
+        refreshSlots(false);
+    } else if (_config.mode == Sentinel) {
+        discoverMaster(false);
+    }
+}
+
+void RedisRouter::updateSlot(int slot, const QString &address)
+{
+    {
+        QMutexLocker locker(&_mutex);
+        int index = _nodes.indexOf(address);
+        if (index < 0) {
+            index = _nodes.size();
+            _nodes.append(address);
+        }
+        _slotOwners[slot] = static_cast<qint16>(index);
+    }
+
+    // MOVED意味着槽位已迁移或发生故障转移，其余槽位很可能也已变化
+    refreshSlots(false);
+}
+
+bool RedisRouter::parseRedirect(const RedisReply &reply, const char *kind, int *slot, QString *address)
+{
+    // 格式："MOVED 3999 127.0.0.1:6381"
+    QList<QByteArray> parts = reply.str.split(' ');
+    if (parts.size() != 3 || parts.at(0) != kind) {
+        return false;
+    }
+
+    bool ok = false;
+    *slot = parts.at(1).toInt(&ok);
+    *address = QString::fromUtf8(parts.at(2));
+    return ok && *slot >= 0 && *slot < SLOT_COUNT && !address->isEmpty();
+}
+
+QJsonObject RedisRouter::getStatistics() const
+{
+    QJsonObject stats;
+    stats["mode"] = modeToString(_config.mode);
+    stats["commands"] = _commands.loadAcquire();
+    stats["moved_redirects"] = _movedRedirects.loadAcquire();
+    stats["ask_redirects"] = _askRedirects.loadAcquire();
+    stats["retries"] = _retries.loadAcquire();
+    stats["slot_refreshes"] = _slotRefreshes.loadAcquire();
+    stats["master_changes"] = _masterChanges.loadAcquire();
+    stats["errors"] = _errors.loadAcquire();
+
+    QMutexLocker locker(&_mutex);
+    if (_config.mode == Cluster) {
+        stats["masters"] = _nodes.size();
+        stats["covered_slots"] = static_cast<int>(SLOT_COUNT - _slotOwners.count(-1));
+    } else {
+        stats["master"] = _master;
+    }
+    return stats;
+}
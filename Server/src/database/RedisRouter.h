@@ -0,0 +1,170 @@
+#ifndef REDISROUTER_H
+#define REDISROUTER_H
+
+#include <QString>
+#include <QStringList>
+#include <QByteArray>
+#include <QList>
+#include <QVector>
+#include <QHash>
+#include <QMutex>
+#include <QThreadStorage>
+#include <QAtomicInteger>
+#include <QElapsedTimer>
+#include <QJsonObject>
+#include "RedisConnection.h"
+
+/**
+ * @brief Redis路由器
+ *
+ * 在单机、Cluster和Sentinel三种部署下提供相同的命令接口：
+ * - 单机：所有命令发往同一实例
+ * - Cluster：按键计算槽位（CRC16 % 16384，支持{哈希标签}），由CLUSTER SLOTS建立槽位到主节点的映射；
+ *   收到MOVED时更新该槽位并重发，随后刷新整张映射；收到ASK时先发送ASKING再向目标节点重发一次；
+ *   流水线按节点拆分，每个节点一次往返
+ * - Sentinel：向哨兵查询主节点地址，连接失败或主节点降级（READONLY）时重新查询，实现故障转移
+ *
+ * 每个线程持有自己到各节点的连接，路由器可被任意线程并发使用。
+ * 只有确认命令未被服务器收到（连接失败、重定向）时才重发，避免非幂等命令重复执行。
+ */
+class RedisRouter
+{
+public:
+    /**
+     * @brief 部署模式
+     */
+    enum Mode {
+        Standalone,
+        Cluster,
+        Sentinel
+    };
+
+    /**
+     * @brief 路由配置
+     */
+    struct Config {
+        Mode mode = Standalone;
+        QString host = "localhost";           // 单机模式地址
+        int port = 6379;
+        QStringList clusterNodes;             // Cluster种子节点 "host:port"
+        QStringList sentinels;                // 哨兵地址 "host:port"
+        QString masterName = "mymaster";      // 哨兵监控的主节点名称
+        QString sentinelPassword;
+        QString password;
+        int database = 0;                     // Cluster模式只支持0号库
+        int timeoutMs = 2000;                 // 连接与应答超时
+        int maxRedirects = 5;                 // 单条命令的最大重定向次数
+    };
+
+    static const int SLOT_COUNT = 16384;
+
+    explicit RedisRouter(const Config &config = Config());
+    ~RedisRouter();
+
+    RedisRouter(const RedisRouter&) = delete;
+    RedisRouter& operator=(const RedisRouter&) = delete;
+
+    /**
+     * @brief 由配置字符串解析模式（standalone/cluster/sentinel）
+     */
+    static Mode modeFromString(const QString &mode);
+    static QString modeToString(Mode mode);
+
+    const Config &config() const { return _config; }
+
+    /**
+     * @brief 发现拓扑（Cluster加载槽位映射，Sentinel查询主节点）并测试连接
+     */
+    bool connect();
+
+    /**
+     * @brief 执行单条命令，按命令中的键路由
+     */
+    RedisReply command(const QList<QByteArray> &args);
+
+    /**
+     * @brief 流水线执行多条命令，Cluster模式下按节点拆分
+     * @return 与命令一一对应的应答
+     */
+    QList<RedisReply> pipeline(const QList<QList<QByteArray>> &commands);
+
+    /**
+     * @brief 批量读取多个键（单机用MGET，Cluster按节点拆分为GET流水线）
+     * @return 与键一一对应的应答
+     */
+    QList<RedisReply> getMany(const QList<QByteArray> &keys);
+
+    /**
+     * @brief 在所有主节点上执行同一条命令（KEYS、FLUSHDB等）
+     */
+    QList<RedisReply> commandOnMasters(const QList<QByteArray> &args);
+
+    /**
+     * @brief 计算键的槽位，键中包含非空的{标签}时只对标签计算
+     */
+    static int keySlot(const QByteArray &key);
+
+    /**
+     * @brief 命令中第一个键的参数下标，无键命令返回-1
+     */
+    static int keyIndex(const QList<QByteArray> &args);
+
+    QJsonObject getStatistics() const;
+
+private:
+    /**
+     * @brief 线程私有的连接表，线程退出时释放
+     */
+    struct ThreadConnections {
+        QHash<QString, RedisConnection*> byAddress;
+        ~ThreadConnections() { qDeleteAll(byAddress); }
+    };
+
+    /**
+     * @brief 命令应发往的节点地址，未知时返回空字符串
+     */
+    QString addressFor(const QList<QByteArray> &args);
+    QString anyMaster();
+
+    RedisConnection* connectionTo(const QString &address, bool sentinel = false);
+
+    /**
+     * @brief 重新加载槽位映射，force为false时有最小间隔
+     */
+    bool refreshSlots(bool force);
+
+    /**
+     * @brief 向哨兵查询主节点地址，force为false时有最小间隔
+     */
+    bool discoverMaster(bool force);
+
+    /**
+     * @brief 拓扑可能变化（连接失败、主节点降级）时重新发现
+     */
+    void onTopologyError();
+
+    void updateSlot(int slot, const QString &address);
+
+    static bool parseRedirect(const RedisReply &reply, const char *kind, int *slot, QString *address);
+
+    Config _config;
+
+    mutable QMutex _mutex;
+    QVector<qint16> _slotOwners;              // 槽位 -> 节点下标，-1表示未知
+    QStringList _nodes;                       // 主节点地址
+    QString _master;                          // 单机/哨兵模式的主节点地址
+    QElapsedTimer _lastRefresh;
+
+    QThreadStorage<ThreadConnections*> _connections;
+
+    // 统计信息
+    QAtomicInteger<qint64> _commands;
+    QAtomicInteger<qint64> _movedRedirects;
+    QAtomicInteger<qint64> _askRedirects;
+    QAtomicInteger<qint64> _retries;
+    QAtomicInteger<qint64> _slotRefreshes;
+    QAtomicInteger<qint64> _masterChanges;
+    QAtomicInteger<qint64> _errors;
+};
+
+#endif // REDISROUTER_H
@@ -0,0 +1,347 @@
+#include "RetentionScheduler.h"
+#include "DatabaseConnectionPool.h"
+#include "../utils/Logger.h"
+#include <QSqlQuery>
+#include <QSqlError>
+
+// 静态成员初始化
+RetentionScheduler* RetentionScheduler::s_instance = nullptr;
+QMutex RetentionScheduler::s_instanceMutex;
+
+namespace {
+
+// 保留任务的连接配额组，同一时间只占用一个连接
+const char *const QUOTA_GROUP = "retention";
+
+// 无到期任务时的检查间隔
+const int TICK_MS = 1000;
+
+// 连续退避时暂停时间的最大倍数
+const int MAX_PAUSE_FACTOR = 8;
+
+} // namespace
+
+RetentionScheduler::RetentionScheduler(QObject *parent)
+    : QObject(parent)
+    , _thread(nullptr)
+    , _running(0)
+{
+    _clock.start();
+}
+
+RetentionScheduler::~RetentionScheduler()
+{
+    shutdown();
+}
+
+RetentionScheduler* RetentionScheduler::instance()
+{
+    if (!s_instance) {
+        QMutexLocker locker(&s_instanceMutex);
+        if (!s_instance) {
+            s_instance = new RetentionScheduler();
+        }
+    }
+    return s_instance;
+}
+
+void RetentionScheduler::configure(const Config &config)
+{
+    QMutexLocker locker(&_mutex);
+    _config = config;
+    _config.minChunkSize = qMax(1, config.minChunkSize);
+    _config.maxChunkSize = qMax(_config.minChunkSize, config.maxChunkSize);
+    _config.initialChunkSize = qBound(_config.minChunkSize, config.initialChunkSize, _config.maxChunkSize);
+
+    for (JobState &state : _jobs) {
+        state.chunkSize = qBound(_config.minChunkSize, state.chunkSize, _config.maxChunkSize);
+    }
+
+    DatabaseConnectionPool::instance()->setConnectionQuota(QUOTA_GROUP, 1);
+}
+
+void RetentionScheduler::registerJob(const Job &job)
+{
+    QMutexLocker locker(&_mutex);
+    JobState &state = _jobs[job.name];
+    state.job = job;
+    state.chunkSize = _config.initialChunkSize;
+    state.nextRunMs = _clock.elapsed() + job.intervalSeconds * 1000LL;
+}
+
+bool RetentionScheduler::start()
+{
+    QMutexLocker locker(&_mutex);
+    if (!_config.enabled || _thread) {
+        return _thread != nullptr;
+    }
+
+    _running.storeRelease(1);
+    _thread = QThread::create([this]() { runLoop(); });
+    _thread->setObjectName("retention_scheduler");
+    _thread->start(QThread::LowPriority);
+
+    LOG_INFO(QString("Retention scheduler started with %1 jobs").arg(_jobs.size()));
+    return true;
+}
+
+void RetentionScheduler::shutdown()
+{
+    QThread *thread = nullptr;
+    {
+        QMutexLocker locker(&_mutex);
+        _running.storeRelease(0);
+        _wake.wakeAll();
+        thread = _thread;
+        _thread = nullptr;
+    }
+
+    if (thread) {
+        thread->wait(10000);
+        delete thread;
+    }
+}
+
+bool RetentionScheduler::trigger(const QString &name)
+{
+    QMutexLocker locker(&_mutex);
+    if (!_thread || !_jobs.contains(name)) {
+        return false;
+    }
+
+    _jobs[name].triggered = true;
+    _wake.wakeAll();
+    return true;
+}
+
+void RetentionScheduler::runLoop()
+{
+    QMutexLocker locker(&_mutex);
+    while (_running.loadAcquire()) {
+        QStringList due;
+        qint64 nowMs = _clock.elapsed();
+        for (auto it = _jobs.begin(); it != _jobs.end(); ++it) {
+            JobState &state = it.value();
+            bool scheduled = state.job.intervalSeconds > 0 && nowMs >= state.nextRunMs;
+            if (state.triggered || scheduled) {
+                state.triggered = false;
+                state.nextRunMs = nowMs + state.job.intervalSeconds * 1000LL;
+                due.append(it.key());
+            }
+        }
+
+        if (due.isEmpty()) {
+            _wake.wait(&_mutex, TICK_MS);
+            continue;
+        }
+
+        locker.unlock();
+        for (const QString &name : due) {
+            if (!_running.loadAcquire()) {
+                break;
+            }
+            runJob(name);
+        }
+        locker.relock();
+    }
+}
+
+bool RetentionScheduler::adaptChunk(const Config &config, qint64 chunkMs, int lockWaits, int *chunkSize, int *pauseMs)
+{
+    // 耗时超标或有事务在等行锁时缩小分块并加长暂停，明显低于目标时增大分块
+    bool backoff = chunkMs > config.targetChunkMs || lockWaits > 0;
+    if (backoff) {
+        *chunkSize = qMax(config.minChunkSize, *chunkSize / 2);
+        *pauseMs = qMin(*pauseMs * 2, qMax(1, config.pauseMs) * MAX_PAUSE_FACTOR);
+    } else {
+        if (chunkMs * 2 < config.targetChunkMs) {
+            *chunkSize = qMin(config.maxChunkSize, *chunkSize + *chunkSize / 2 + 1);
+        }
+        *pauseMs = config.pauseMs;
+    }
+    return backoff;
+}
+
+int RetentionScheduler::runJob(const QString &name)
+{
+    Job job;
+    Config config;
+    int chunkSize = 0;
+    {
+        QMutexLocker locker(&_mutex);
+        auto it = _jobs.find(name);
+        if (it == _jobs.end() || it->running) {
+            return 0;
+        }
+        it->running = true;
+        it->runRows = 0;
+        it->cursor = it->job.cursorStart;
+        job = it->job;
+        config = _config;
+        chunkSize = it->chunkSize;
+    }
+
+    // 条件在选键和执行时各检查一次，选键之后被更新的行不会被误删
+    const QString selectSql = QString("SELECT %1 FROM %2 WHERE %1 > ? AND (%3) ORDER BY %1 LIMIT %4")
+                              .arg(job.keyColumn, job.table, job.condition);
+    const QString actionPrefix = job.assignment.isEmpty()
+        ? QString("DELETE FROM %1").arg(job.table)
+        : QString("UPDATE %1 SET %2").arg(job.table, job.assignment);
+
+    DatabaseConnectionPool::QuotaScope quotaScope(QUOTA_GROUP);
+    QElapsedTimer runTimer;
+    runTimer.start();
+
+    QVariant cursor = job.cursorStart;
+    qint64 total = 0;
+    int pauseMs = config.pauseMs;
+    int chunks = 0;
+
+    while (chunks < config.maxChunksPerRun && _running.loadAcquire()) {
+        QElapsedTimer chunkTimer;
+        chunkTimer.start();
+
+        const int requested = chunkSize;
+        int affected = 0;
+        int selected = 0;
+        bool failed = false;
+        {
+            // 每块单独取连接，暂停期间不占用连接池
+            DatabaseConnection dbConn;
+            if (!dbConn.isValid()) {
+                LOG_WARNING(QString("Retention job %1: database connection unavailable").arg(name));
+                failed = true;
+            } else {
+                QVariantList selectParams;
+                selectParams << cursor << job.params;
+                QSqlQuery query = dbConn.executeQuery(selectSql.arg(requested), selectParams);
+                if (query.lastError().isValid()) {
+                    LOG_ERROR(QString("Retention job %1 select failed: %2").arg(name, query.lastError().text()));
+                    failed = true;
+                } else {
+                    QVariantList keys;
+                    while (query.next()) {
+                        keys.append(query.value(0));
+                    }
+                    selected = keys.size();
+
+                    if (selected > 0) {
+                        cursor = keys.last();
+
+                        QString placeholders = QString("?,").repeated(selected);
+                        placeholders.chop(1); // 移除最后一个逗号
+                        QString sql = QString("%1 WHERE %2 IN (%3) AND (%4)")
+                                      .arg(actionPrefix, job.keyColumn, placeholders, job.condition);
+                        affected = dbConn.executeUpdate(sql, keys + job.params);
+                        if (affected == -1) {
+                            LOG_ERROR(QString("Retention job %1 chunk failed at %2").arg(name, cursor.toString()));
+                            failed = true;
+                        }
+                    }
+                }
+            }
+        }
+
+        if (failed || selected == 0) {
+            QMutexLocker locker(&_mutex);
+            if (failed) {
+                ++_jobs[name].errors;
+            }
+            break;
+        }
+
+        ++chunks;
+        total += affected;
+        qint64 chunkMs = chunkTimer.elapsed();
+        int lockWaits = currentLockWaits();
+
+        bool backoff = adaptChunk(config, chunkMs, lockWaits, &chunkSize, &pauseMs);
+
+        {
+            QMutexLocker locker(&_mutex);
+            JobState &state = _jobs[name];
+            state.chunkSize = chunkSize;
+            state.chunks++;
+            state.rowsAffected += affected;
+            state.runRows = total;
+            state.cursor = cursor;
+            if (backoff) {
+                state.backoffs++;
+            }
+        }
+
+        // 不足一整块说明已处理到末尾
+        if (selected < requested) {
+            break;
+        }
+
+        if (pauseMs > 0) {
+            QThread::msleep(static_cast<unsigned long>(pauseMs));
+        }
+    }
+
+    qint64 runMs = runTimer.elapsed();
+    {
+        QMutexLocker locker(&_mutex);
+        JobState &state = _jobs[name];
+        state.running = false;
+        state.runs++;
+        state.lastRunRows = total;
+        state.lastRunMs = runMs;
+    }
+
+    if (total > 0) {
+        LOG_INFO(QString("Retention job %1: %2 rows in %3 chunks, %4 ms")
+                 .arg(name).arg(total).arg(chunks).arg(runMs));
+    }
+    return static_cast<int>(total);
+}
+
+int RetentionScheduler::currentLockWaits()
+{
+    DatabaseConnection dbConn;
+    if (!dbConn.isValid()) {
+        return 0;
+    }
+
+    QSqlQuery query = dbConn.executeQuery("SHOW GLOBAL STATUS LIKE 'Innodb_row_lock_current_waits'");
+    if (query.next()) {
+        return query.value(1).toInt();
+    }
+    return 0;
+}
+
+QJsonObject RetentionScheduler::getStatistics() const
+{
+    QMutexLocker locker(&_mutex);
+
+    QJsonObject jobs;
+    for (auto it = _jobs.constBegin(); it != _jobs.constEnd(); ++it) {
+        const JobState &state = it.value();
+        QJsonObject job;
+        job["table"] = state.job.table;
+        job["interval_seconds"] = state.job.intervalSeconds;
+        job["running"] = state.running;
+        job["chunk_size"] = state.chunkSize;
+        job["runs"] = state.runs;
+        job["chunks"] = state.chunks;
+        job["rows_affected"] = state.rowsAffected;
+        job["backoffs"] = state.backoffs;
+        job["errors"] = state.errors;
+        job["last_run_rows"] = state.lastRunRows;
+        job["last_run_ms"] = state.lastRunMs;
+        job["last_run_rows_per_sec"] = state.lastRunMs > 0
+            ? static_cast<double>(state.lastRunRows) * 1000.0 / state.lastRunMs : 0.0;
+        if (state.running) {
+            job["run_rows"] = state.runRows;
+            job["cursor"] = QJsonValue::fromVariant(state.cursor);
+        }
+        jobs[it.key()] = job;
+    }
+
+    QJsonObject stats;
+    stats["enabled"] = _config.enabled;
+    stats["active"] = _thread != nullptr;
+    stats["jobs"] = jobs;
+    return stats;
+}
@@ -0,0 +1,149 @@
+#ifndef RETENTIONSCHEDULER_H
+#define RETENTIONSCHEDULER_H
+
+#include <QObject>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QThread>
+#include <QHash>
+#include <QStringList>
+#include <QVariant>
+#include <QJsonObject>
+#include <QElapsedTimer>
+#include <QAtomicInteger>
+
+/**
+ * @brief 数据保留任务调度器
+ *
+ * 过期数据的清理不再用一条不限行数的DELETE/UPDATE完成，而是在后台线程中按键列顺序分块执行：
+ * 每块先按游标取出一批满足条件的键，再只对这些键执行删除或更新，块与块之间暂停一段时间，
+ * 每块单独获取连接，不在暂停期间占用连接池。
+ *
+ * 分块大小按每块耗时和InnoDB当前行锁等待数自适应：超过目标耗时或出现锁等待时减半并加长暂停，
+ * 明显低于目标时逐步增大。单轮执行的块数有上限，剩余部分留到下一轮。
+ */
+class RetentionScheduler : public QObject
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @brief 保留任务配置
+     */
+    struct Config {
+        bool enabled = true;
+        int initialChunkSize = 500;
+        int minChunkSize = 50;
+        int maxChunkSize = 5000;
+        int pauseMs = 100;                // 两块之间的暂停时间
+        int targetChunkMs = 100;          // 单块目标耗时，超过时缩小分块
+        int maxChunksPerRun = 200;        // 单轮最多执行的块数
+    };
+
+    /**
+     * @brief 保留任务定义
+     */
+    struct Job {
+        QString name;
+        QString table;
+        QString keyColumn = "id";         // 分块游标使用的键列，须有索引且唯一
+        QVariant cursorStart = 0;         // 游标起始值，键列为字符串时使用空字符串
+        QString condition;                // 待清理行的条件
+        QVariantList params;              // 条件中的参数
+        QString assignment;               // 为空时删除匹配行，否则为UPDATE的SET子句
+        int intervalSeconds = 0;          // 执行间隔，为0时只在trigger时执行
+    };
+
+    static RetentionScheduler* instance();
+
+    void configure(const Config &config);
+
+    /**
+     * @brief 注册保留任务，同名任务被替换；须在start前调用
+     */
+    void registerJob(const Job &job);
+
+    /**
+     * @brief 启动后台线程
+     */
+    bool start();
+
+    /**
+     * @brief 停止后台线程，正在执行的任务在当前分块结束后退出
+     */
+    void shutdown();
+
+    /**
+     * @brief 请求尽快执行指定任务
+     * @return 任务由调度器处理时返回true；未启用或未注册时返回false，调用者应自行清理
+     */
+    bool trigger(const QString &name);
+
+    /**
+     * @brief 获取各任务的进度和吞吐统计
+     */
+    QJsonObject getStatistics() const;
+
+    /**
+     * @brief 按上一块的耗时和行锁等待数调整分块大小与暂停时间
+     * @param chunkSize 输入当前分块大小，输出下一块的大小
+     * @param pauseMs 输入当前暂停时间，输出下一块前的暂停时间
+     * @return 发生退避（缩小分块）时返回true
+     */
+    static bool adaptChunk(const Config &config, qint64 chunkMs, int lockWaits, int *chunkSize, int *pauseMs);
+
+private:
+    explicit RetentionScheduler(QObject *parent = nullptr);
+    ~RetentionScheduler();
+
+    /**
+     * @brief 任务运行状态
+     */
+    struct JobState {
+        Job job;
+        int chunkSize = 0;
+        qint64 nextRunMs = 0;
+        bool triggered = false;
+        bool running = false;
+
+        // 统计信息
+        qint64 runs = 0;
+        qint64 chunks = 0;
+        qint64 rowsAffected = 0;
+        qint64 backoffs = 0;              // 因耗时超标或锁等待缩小分块的次数
+        qint64 errors = 0;
+        qint64 lastRunRows = 0;
+        qint64 lastRunMs = 0;
+        qint64 runRows = 0;               // 当前轮已处理行数
+        QVariant cursor;                  // 当前轮游标位置
+    };
+
+    /**
+     * @brief 后台线程主循环
+     */
+    void runLoop();
+
+    /**
+     * @brief 执行一轮指定任务
+     * @return 本轮处理的行数，任务正在执行或不存在时返回0
+     */
+    int runJob(const QString &name);
+
+    /**
+     * @brief InnoDB当前行锁等待数，查询失败时返回0
+     */
+    static int currentLockWaits();
+
+    static RetentionScheduler* s_instance;
+    static QMutex s_instanceMutex;
+
+    mutable QMutex _mutex;
+    QWaitCondition _wake;
+    Config _config;
+    QHash<QString, JobState> _jobs;
+    QThread *_thread;
+    QAtomicInteger<int> _running;
+    QElapsedTimer _clock;
+};
+
+#endif // RETENTIONSCHEDULER_H
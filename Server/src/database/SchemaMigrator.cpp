@@ -0,0 +1,318 @@
+#include "SchemaMigrator.h"
+#include "DatabaseConnectionPool.h"
+#include "../utils/Logger.h"
+#include <QDir>
+#include <QFile>
+#include <QHash>
+#include <QRegularExpression>
+#include <QCryptographicHash>
+#include <QElapsedTimer>
+#include <QSqlQuery>
+#include <QSqlError>
+#include <algorithm>
+
+namespace {
+
+// 多个节点同时启动时串行执行迁移
+const char *const MIGRATION_LOCK = "qkchat_schema_migrations";
+const int MIGRATION_LOCK_TIMEOUT_SECONDS = 60;
+
+// 重复执行时可以忽略的错误：字段已存在、索引已存在
+const QStringList IDEMPOTENT_ERRORS = { "1060", "1061" };
+
+const char *const CREATE_MIGRATIONS_TABLE = R"(
+    CREATE TABLE IF NOT EXISTS schema_migrations (
+        version INT UNSIGNED PRIMARY KEY COMMENT '迁移版本',
+        name VARCHAR(100) NOT NULL COMMENT '迁移名称',
+        checksum CHAR(64) NOT NULL COMMENT '脚本内容摘要',
+        duration_ms INT UNSIGNED NOT NULL DEFAULT 0 COMMENT '执行耗时',
+        applied_at TIMESTAMP DEFAULT CURRENT_TIMESTAMP COMMENT '应用时间'
+    ) ENGINE=InnoDB COMMENT='结构迁移记录'
+)";
+
+QString readResource(const QString &path)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return QString();
+    }
+    return QString::fromUtf8(file.readAll());
+}
+
+/**
+ * @brief 解析"-- params:"后的示例参数：整数或单引号字符串
+ */
+QVariantList parseParams(const QString &text)
+{
+    QVariantList params;
+    const QStringList items = text.split(',', Qt::SkipEmptyParts);
+    for (const QString &item : items) {
+        QString value = item.trimmed();
+        if (value.size() >= 2 && value.startsWith('\'') && value.endsWith('\'')) {
+            params.append(value.mid(1, value.size() - 2));
+        } else {
+            params.append(value.toLongLong());
+        }
+    }
+    return params;
+}
+
+bool applyMigration(DatabaseConnection &dbConn, const SchemaMigrator::Migration &migration)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    for (const QString &statement : migration.statements) {
+        QSqlQuery query(dbConn.database());
+        if (query.exec(statement)) {
+            continue;
+        }
+
+        QSqlError error = query.lastError();
+        if (IDEMPOTENT_ERRORS.contains(error.nativeErrorCode())) {
+            LOG_INFO(QString("Migration V%1: already applied, skipping: %2")
+                     .arg(migration.version).arg(error.databaseText()));
+            continue;
+        }
+
+        LOG_ERROR(QString("Migration V%1 (%2) failed: %3\n%4")
+                  .arg(migration.version).arg(migration.name, error.text(), statement));
+        return false;
+    }
+
+    qint64 durationMs = timer.elapsed();
+    int recorded = dbConn.executeUpdate(
+        "INSERT INTO schema_migrations (version, name, checksum, duration_ms) VALUES (?, ?, ?, ?)",
+        {migration.version, migration.name, migration.checksum, durationMs});
+    if (recorded == -1) {
+        LOG_ERROR(QString("Failed to record migration V%1").arg(migration.version));
+        return false;
+    }
+
+    LOG_INFO(QString("Applied migration V%1 (%2): %3 statements in %4 ms")
+             .arg(migration.version).arg(migration.name)
+             .arg(migration.statements.size()).arg(durationMs));
+    return true;
+}
+
+} // namespace
+
+bool SchemaMigrator::migrate()
+{
+    QList<Migration> migrations = loadMigrations();
+    if (migrations.isEmpty()) {
+        LOG_ERROR("No schema migrations found");
+        return false;
+    }
+
+    DatabaseConnection dbConn;
+    if (!dbConn.isValid()) {
+        LOG_ERROR("Failed to acquire database connection for schema migration");
+        return false;
+    }
+
+    QVariant locked = dbConn.executeScalar("SELECT GET_LOCK(?, ?)",
+                                           {MIGRATION_LOCK, MIGRATION_LOCK_TIMEOUT_SECONDS});
+    if (locked.toInt() != 1) {
+        LOG_ERROR("Timed out waiting for schema migration lock");
+        return false;
+    }
+
+    bool success = dbConn.executeUpdate(CREATE_MIGRATIONS_TABLE) != -1;
+    if (!success) {
+        LOG_ERROR("Failed to create schema_migrations table");
+    }
+
+    QHash<int, QString> applied;
+    if (success) {
+        QSqlQuery query = dbConn.executeQuery("SELECT version, checksum FROM schema_migrations");
+        while (query.next()) {
+            applied.insert(query.value(0).toInt(), query.value(1).toString());
+        }
+    }
+
+    int appliedCount = 0;
+    for (const Migration &migration : migrations) {
+        if (!success) {
+            break;
+        }
+
+        auto it = applied.constFind(migration.version);
+        if (it != applied.constEnd()) {
+            if (it.value() != migration.checksum) {
+                LOG_WARNING(QString("Migration V%1 (%2) was modified after it was applied; "
+                                    "add a new migration instead of editing an applied one")
+                            .arg(migration.version).arg(migration.name));
+            }
+            continue;
+        }
+
+        success = applyMigration(dbConn, migration);
+        if (success) {
+            ++appliedCount;
+        }
+    }
+
+    dbConn.executeScalar("SELECT RELEASE_LOCK(?)", {MIGRATION_LOCK});
+
+    if (success) {
+        LOG_INFO(QString("Schema at version %1 (%2 migrations applied)")
+                 .arg(migrations.last().version).arg(appliedCount));
+    }
+    return success;
+}
+
+int SchemaMigrator::currentVersion()
+{
+    DatabaseConnection dbConn;
+    if (!dbConn.isValid()) {
+        return -1;
+    }
+
+    QSqlQuery query = dbConn.executeQuery("SELECT COALESCE(MAX(version), 0) FROM schema_migrations");
+    if (query.next()) {
+        return query.value(0).toInt();
+    }
+    return -1;
+}
+
+QList<SchemaMigrator::PlanIssue> SchemaMigrator::checkQueryPlans(qint64 minRows)
+{
+    QList<PlanIssue> issues;
+
+    DatabaseConnection dbConn;
+    if (!dbConn.isValid()) {
+        LOG_WARNING("Failed to acquire database connection for query plan check");
+        return issues;
+    }
+
+    const QList<HotQuery> queries = loadHotQueries();
+    for (const HotQuery &hotQuery : queries) {
+        // 与慢查询EXPLAIN相同，使用独立的QSqlQuery且不计入语句统计
+        QSqlQuery explain(dbConn.database());
+        if (!explain.prepare("EXPLAIN " + hotQuery.sql)) {
+            LOG_WARNING(QString("Query plan check: cannot prepare %1: %2")
+                        .arg(hotQuery.name, explain.lastError().text()));
+            continue;
+        }
+        for (int i = 0; i < hotQuery.params.size(); ++i) {
+            explain.bindValue(i, hotQuery.params[i]);
+        }
+        if (!explain.exec()) {
+            LOG_WARNING(QString("Query plan check: EXPLAIN %1 failed: %2")
+                        .arg(hotQuery.name, explain.lastError().text()));
+            continue;
+        }
+
+        while (explain.next()) {
+            qint64 rows = explain.value("rows").toLongLong();
+            if (explain.value("type").toString() != "ALL" || rows < minRows) {
+                continue;
+            }
+
+            PlanIssue issue;
+            issue.query = hotQuery.name;
+            issue.table = explain.value("table").toString();
+            issue.rows = rows;
+            issues.append(issue);
+
+            LOG_WARNING(QString("Query plan check: %1 does a full scan of %2 (~%3 rows)")
+                        .arg(issue.query, issue.table).arg(issue.rows));
+        }
+    }
+
+    if (issues.isEmpty()) {
+        LOG_INFO(QString("Query plan check: %1 hot queries use indexes").arg(queries.size()));
+    }
+    return issues;
+}
+
+QList<SchemaMigrator::Migration> SchemaMigrator::loadMigrations(const QString &directory)
+{
+    static const QRegularExpression namePattern("^V(\\d+)__(\\w+)\\.sql$");
+
+    QList<Migration> migrations;
+    const QStringList files = QDir(directory).entryList({ "V*.sql" }, QDir::Files);
+    for (const QString &fileName : files) {
+        QRegularExpressionMatch match = namePattern.match(fileName);
+        if (!match.hasMatch()) {
+            LOG_WARNING(QString("Ignoring migration with invalid name: %1").arg(fileName));
+            continue;
+        }
+
+        QFile file(QDir(directory).filePath(fileName));
+        if (!file.open(QIODevice::ReadOnly)) {
+            LOG_ERROR(QString("Failed to read migration: %1").arg(fileName));
+            continue;
+        }
+        QByteArray content = file.readAll();
+
+        Migration migration;
+        migration.version = match.captured(1).toInt();
+        migration.name = match.captured(2);
+        migration.checksum = QString::fromLatin1(
+            QCryptographicHash::hash(content, QCryptographicHash::Sha256).toHex());
+        migration.statements = splitStatements(QString::fromUtf8(content));
+        migrations.append(migration);
+    }
+
+    std::sort(migrations.begin(), migrations.end(), [](const Migration &a, const Migration &b) {
+        return a.version < b.version;
+    });
+    return migrations;
+}
+
+QList<SchemaMigrator::HotQuery> SchemaMigrator::loadHotQueries(const QString &path)
+{
+    QList<HotQuery> queries;
+    HotQuery current;
+    QString sql;
+
+    const QStringList lines = readResource(path).split('\n');
+    for (const QString &line : lines) {
+        QString trimmed = line.trimmed();
+        if (trimmed.startsWith("-- name:")) {
+            current.name = trimmed.mid(8).trimmed();
+        } else if (trimmed.startsWith("-- params:")) {
+            current.params = parseParams(trimmed.mid(10));
+        } else if (!trimmed.isEmpty() && !trimmed.startsWith("--")) {
+            sql += line + '\n';
+            if (trimmed.endsWith(';')) {
+                sql = sql.trimmed();
+                sql.chop(1);
+                current.sql = sql;
+                queries.append(current);
+                current = HotQuery();
+                sql.clear();
+            }
+        }
+    }
+    return queries;
+}
+
+QStringList SchemaMigrator::splitStatements(const QString &script)
+{
+    QStringList statements;
+    QString current;
+
+    const QStringList lines = script.split('\n');
+    for (const QString &line : lines) {
+        QString trimmed = line.trimmed();
+        if (trimmed.isEmpty() || trimmed.startsWith("--")) {
+            continue;
+        }
+
+        current += line + '\n';
+        if (trimmed.endsWith(';')) {
+            current = current.trimmed();
+            current.chop(1);
+            statements.append(current);
+            current.clear();
+        }
+    }
+
+    if (!current.trimmed().isEmpty()) {
+        statements.append(current.trimmed());
+    }
+    return statements;
+}
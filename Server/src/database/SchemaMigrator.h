@@ -0,0 +1,86 @@
+#ifndef SCHEMAMIGRATOR_H
+#define SCHEMAMIGRATOR_H
+
+#include <QString>
+#include <QStringList>
+#include <QVariantList>
+#include <QList>
+
+/**
+ * @brief 数据库结构迁移
+ *
+ * 迁移脚本位于Server/migrations，文件名为V<版本号>__<名称>.sql，编译进资源文件。启动时按版本号顺序
+ * 执行尚未应用的迁移，每个迁移执行成功后记入schema_migrations表（版本、名称、内容摘要、耗时）。
+ * 多个节点同时启动时通过GET_LOCK串行执行。
+ *
+ * MySQL的DDL不能回滚，迁移中途失败时已执行的语句保留，下次启动重新执行整个迁移，
+ * 因此迁移语句须可重复执行：建表使用IF NOT EXISTS，同名索引已存在的错误视为成功。
+ *
+ * hot_queries.sql列出服务中的热点查询，checkQueryPlans用EXPLAIN检查它们是否退化为全表扫描。
+ */
+class SchemaMigrator
+{
+public:
+    /**
+     * @brief 迁移脚本
+     */
+    struct Migration {
+        int version = 0;
+        QString name;
+        QString checksum;                 // 脚本内容的SHA-256
+        QStringList statements;
+    };
+
+    /**
+     * @brief 热点查询
+     */
+    struct HotQuery {
+        QString name;
+        QString sql;
+        QVariantList params;              // 用于EXPLAIN的示例参数
+    };
+
+    /**
+     * @brief 执行计划问题
+     */
+    struct PlanIssue {
+        QString query;
+        QString table;
+        qint64 rows = 0;                  // 优化器估计的扫描行数
+    };
+
+    /**
+     * @brief 执行尚未应用的迁移
+     * @return 全部迁移都已应用时返回true
+     */
+    static bool migrate();
+
+    /**
+     * @brief 当前已应用的最高版本，查询失败时返回-1
+     */
+    static int currentVersion();
+
+    /**
+     * @brief EXPLAIN热点查询，找出全表扫描
+     * @param minRows 估计扫描行数不少于该值的全表扫描才算问题，避免小表误报
+     * @return 发现的问题，每个问题同时写入警告日志
+     */
+    static QList<PlanIssue> checkQueryPlans(qint64 minRows);
+
+    /**
+     * @brief 读取迁移脚本，按版本号排序
+     */
+    static QList<Migration> loadMigrations(const QString &directory = ":/migrations");
+
+    /**
+     * @brief 读取热点查询
+     */
+    static QList<HotQuery> loadHotQueries(const QString &path = ":/migrations/hot_queries.sql");
+
+    /**
+     * @brief 把脚本拆分为语句：去掉注释行，以行尾分号结束一条语句
+     */
+    static QStringList splitStatements(const QString &script);
+};
+
+#endif // SCHEMAMIGRATOR_H
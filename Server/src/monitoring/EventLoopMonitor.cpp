@@ -0,0 +1,429 @@
+#include "EventLoopMonitor.h"
+#include "../utils/Logger.h"
+#include <QJsonArray>
+#include <QMutexLocker>
+#include <QMetaObject>
+
+// 静态成员初始化
+EventLoopMonitor* EventLoopMonitor::s_instance = nullptr;
+QMutex EventLoopMonitor::s_instanceMutex;
+
+const int EventLoopMonitor::BUCKET_BOUNDS_MS[EventLoopMonitor::HISTOGRAM_BUCKETS - 1] = {
+    1, 2, 5, 10, 25, 50, 100, 250, 500, 1000, 2500
+};
+
+EventLoopMonitor::EventLoopMonitor(QObject *parent)
+    : QObject(parent)
+    , _running(0)
+    , _monitorThread(nullptr)
+    , _probeTimer(nullptr)
+{
+}
+
+EventLoopMonitor::~EventLoopMonitor()
+{
+    shutdown();
+}
+
+EventLoopMonitor* EventLoopMonitor::instance()
+{
+    if (!s_instance) {
+        QMutexLocker locker(&s_instanceMutex);
+        if (!s_instance) {
+            s_instance = new EventLoopMonitor();
+        }
+    }
+    return s_instance;
+}
+
+bool EventLoopMonitor::initialize(const MonitorConfig &config)
+{
+    if (_monitorThread) {
+        LOG_WARNING("EventLoopMonitor already initialized");
+        return true;
+    }
+
+    _config = config;
+    _config.probeIntervalMs = qMax(10, _config.probeIntervalMs);
+    _config.stallThresholdMs = qMax(_config.probeIntervalMs, _config.stallThresholdMs);
+
+    if (!_config.enabled) {
+        LOG_INFO("Event loop monitor disabled");
+        return true;
+    }
+
+    _clock.start();
+
+    // 探针定时器运行在独立线程，被监控线程阻塞时仍可检测卡顿
+    _monitorThread = new QThread();
+    _monitorThread->setObjectName("EventLoopMonitor");
+    _probeTimer = new QTimer();
+    _probeTimer->setTimerType(Qt::PreciseTimer);
+    _probeTimer->setInterval(_config.probeIntervalMs);
+    _probeTimer->moveToThread(_monitorThread);
+    connect(_probeTimer, &QTimer::timeout, this, &EventLoopMonitor::onProbeTimer, Qt::DirectConnection);
+    connect(_monitorThread, &QThread::started, _probeTimer, QOverload<>::of(&QTimer::start));
+
+    _running.storeRelease(1);
+    _monitorThread->start();
+
+    LOG_INFO(QString("Event loop monitor started: probe_interval=%1ms, stall_threshold=%2ms, admission_threshold=%3ms")
+             .arg(_config.probeIntervalMs).arg(_config.stallThresholdMs).arg(_config.admissionLagThresholdMs));
+    return true;
+}
+
+void EventLoopMonitor::shutdown()
+{
+    if (!_monitorThread) {
+        return;
+    }
+
+    _running.storeRelease(0);
+
+    QMetaObject::invokeMethod(_probeTimer, "stop", Qt::BlockingQueuedConnection);
+    _monitorThread->quit();
+    _monitorThread->wait();
+
+    delete _probeTimer;
+    _probeTimer = nullptr;
+    delete _monitorThread;
+    _monitorThread = nullptr;
+
+    QMutexLocker locker(&_statesMutex);
+    for (auto it = _states.begin(); it != _states.end(); ++it) {
+        QObject *probe = it.value()->probe;
+        if (probe) {
+            probe->deleteLater();
+            it.value()->probe = nullptr;
+        }
+    }
+    _states.clear();
+}
+
+void EventLoopMonitor::registerThread(QThread *thread, const QString &name)
+{
+    if (!thread || !isEnabled()) {
+        return;
+    }
+
+    QSharedPointer<LoopState> state(new LoopState());
+    state->name = name;
+    state->thread = thread;
+    state->probe = new QObject();
+    if (state->probe->thread() != thread) {
+        state->probe->moveToThread(thread);
+    }
+
+    QMutexLocker locker(&_statesMutex);
+    if (_states.contains(thread)) {
+        state->probe->deleteLater();
+        return;
+    }
+    _states.insert(thread, state);
+
+    LOG_INFO(QString("Event loop monitor: registered thread %1").arg(name));
+}
+
+void EventLoopMonitor::unregisterThread(QThread *thread)
+{
+    QSharedPointer<LoopState> state;
+    {
+        QMutexLocker locker(&_statesMutex);
+        state = _states.take(thread);
+    }
+
+    if (state && state->probe) {
+        if (thread->isFinished()) {
+            delete state->probe;
+        } else {
+            state->probe->deleteLater();
+        }
+        state->probe = nullptr;
+    }
+}
+
+QSharedPointer<EventLoopMonitor::LoopState> EventLoopMonitor::stateForCurrentThread()
+{
+    QMutexLocker locker(&_statesMutex);
+    return _states.value(QThread::currentThread());
+}
+
+void EventLoopMonitor::beginAction(const QString &action)
+{
+    if (!isEnabled()) {
+        return;
+    }
+
+    QSharedPointer<LoopState> state = stateForCurrentThread();
+    if (!state) {
+        return;
+    }
+
+    QMutexLocker locker(&state->mutex);
+    state->currentAction = action;
+    state->actionStartUs = nowUs();
+}
+
+void EventLoopMonitor::endAction()
+{
+    if (!isEnabled()) {
+        return;
+    }
+
+    QSharedPointer<LoopState> state = stateForCurrentThread();
+    if (!state) {
+        return;
+    }
+
+    QMutexLocker locker(&state->mutex);
+    if (!state->currentAction.isEmpty()) {
+        state->lastAction = state->currentAction;
+        state->currentAction.clear();
+    }
+}
+
+void EventLoopMonitor::onProbeTimer()
+{
+    if (!isEnabled()) {
+        return;
+    }
+
+    QList<QSharedPointer<LoopState>> states;
+    {
+        QMutexLocker locker(&_statesMutex);
+        states = _states.values();
+    }
+
+    const qint64 now = nowUs();
+    const qint64 stallThresholdUs = static_cast<qint64>(_config.stallThresholdMs) * 1000;
+
+    for (const QSharedPointer<LoopState> &state : states) {
+        qint64 postedUs = state->probePostedUs.loadAcquire();
+
+        if (postedUs == 0) {
+            // 投递新探针
+            state->probePostedUs.storeRelease(now);
+            QSharedPointer<LoopState> captured = state;
+            QMetaObject::invokeMethod(state->probe, [this, captured, now]() {
+                onProbeDelivered(captured, now);
+            }, Qt::QueuedConnection);
+            continue;
+        }
+
+        // 探针尚未执行，检查是否卡顿
+        qint64 pendingUs = now - postedUs;
+        if (pendingUs >= stallThresholdUs && state->stallReported.testAndSetOrdered(0, 1)) {
+            QString action;
+            {
+                QMutexLocker locker(&state->mutex);
+                action = state->currentAction.isEmpty() ? state->lastAction : state->currentAction;
+            }
+            recordStall(*state, action, pendingUs / 1000);
+        }
+    }
+}
+
+void EventLoopMonitor::onProbeDelivered(const QSharedPointer<LoopState> &state, qint64 postedUs)
+{
+    const qint64 lagUs = nowUs() - postedUs;
+    const qint64 lagMs = lagUs / 1000;
+
+    int bucket = HISTOGRAM_BUCKETS - 1;
+    for (int i = 0; i < HISTOGRAM_BUCKETS - 1; ++i) {
+        if (lagUs < static_cast<qint64>(BUCKET_BOUNDS_MS[i]) * 1000) {
+            bucket = i;
+            break;
+        }
+    }
+
+    QString missedAction;
+    bool missedStall = false;
+    {
+        QMutexLocker locker(&state->mutex);
+        state->buckets[bucket]++;
+        state->probes++;
+        state->maxLagUs = qMax(state->maxLagUs, lagUs);
+        state->ewmaLagMs = _config.ewmaAlpha * (lagUs / 1000.0) + (1.0 - _config.ewmaAlpha) * state->ewmaLagMs;
+
+        // 卡顿发生在两次定时检查之间时，归因到刚结束的动作
+        if (lagMs >= _config.stallThresholdMs && state->stallReported.loadAcquire() == 0) {
+            missedStall = true;
+            missedAction = state->lastAction;
+        }
+    }
+
+    if (missedStall) {
+        recordStall(*state, missedAction, lagMs);
+    }
+
+    state->stallReported.storeRelease(0);
+    state->probePostedUs.storeRelease(0);
+}
+
+void EventLoopMonitor::recordStall(LoopState &state, const QString &action, qint64 lagMs)
+{
+    QString actionName = action.isEmpty() ? QStringLiteral("<idle>") : action;
+
+    {
+        QMutexLocker locker(&state.mutex);
+        state.stalls++;
+    }
+
+    {
+        QMutexLocker locker(&_stallMutex);
+        StallRecord record;
+        record.threadName = state.name;
+        record.action = actionName;
+        record.lagMs = lagMs;
+        record.time = QDateTime::currentDateTime();
+        _recentStalls.enqueue(record);
+        while (_recentStalls.size() > _config.maxRecentStalls) {
+            _recentStalls.dequeue();
+        }
+
+        ActionStallStats &stats = _actionStalls[actionName];
+        stats.count++;
+        stats.totalLagMs += lagMs;
+        stats.maxLagMs = qMax(stats.maxLagMs, lagMs);
+    }
+
+    LOG_WARNING(QString("Event loop stall on thread %1: %2ms, action=%3")
+                .arg(state.name).arg(lagMs).arg(actionName));
+
+    emit stallDetected(state.name, actionName, lagMs);
+}
+
+bool EventLoopMonitor::isOverloaded() const
+{
+    if (!isEnabled() || _config.admissionLagThresholdMs <= 0) {
+        return false;
+    }
+    return maxCurrentLagMs() >= _config.admissionLagThresholdMs;
+}
+
+double EventLoopMonitor::maxCurrentLagMs() const
+{
+    if (!isEnabled()) {
+        return 0.0;
+    }
+
+    QList<QSharedPointer<LoopState>> states;
+    {
+        QMutexLocker locker(&_statesMutex);
+        states = _states.values();
+    }
+
+    const qint64 now = nowUs();
+    double maxLag = 0.0;
+
+    for (const QSharedPointer<LoopState> &state : states) {
+        // 未完成探针的等待时间同样计入，卡顿期间无需等探针返回即可生效
+        qint64 postedUs = state->probePostedUs.loadAcquire();
+        double pendingMs = postedUs > 0 ? (now - postedUs) / 1000.0 : 0.0;
+
+        QMutexLocker locker(&state->mutex);
+        maxLag = qMax(maxLag, qMax(state->ewmaLagMs, pendingMs));
+    }
+
+    return maxLag;
+}
+
+double EventLoopMonitor::percentileMs(const qint64 *buckets, qint64 maxLagUs, double percentile)
+{
+    qint64 samples = 0;
+    for (int i = 0; i < HISTOGRAM_BUCKETS; ++i) {
+        samples += buckets[i];
+    }
+    if (samples == 0) {
+        return 0.0;
+    }
+
+    qint64 target = static_cast<qint64>(samples * percentile);
+    qint64 cumulative = 0;
+    for (int i = 0; i < HISTOGRAM_BUCKETS - 1; ++i) {
+        cumulative += buckets[i];
+        if (cumulative > target) {
+            return BUCKET_BOUNDS_MS[i];
+        }
+    }
+    return maxLagUs / 1000.0;
+}
+
+QJsonObject EventLoopMonitor::getStatistics() const
+{
+    QJsonObject stats;
+    stats["enabled"] = isEnabled();
+    stats["probe_interval_ms"] = _config.probeIntervalMs;
+    stats["stall_threshold_ms"] = _config.stallThresholdMs;
+    stats["admission_lag_threshold_ms"] = _config.admissionLagThresholdMs;
+
+    if (!isEnabled()) {
+        return stats;
+    }
+
+    stats["max_current_lag_ms"] = maxCurrentLagMs();
+    stats["overloaded"] = isOverloaded();
+
+    QList<QSharedPointer<LoopState>> states;
+    {
+        QMutexLocker locker(&_statesMutex);
+        states = _states.values();
+    }
+
+    QJsonArray threads;
+    for (const QSharedPointer<LoopState> &state : states) {
+        QMutexLocker locker(&state->mutex);
+
+        QJsonObject threadStats;
+        threadStats["name"] = state->name;
+        threadStats["probes"] = state->probes;
+        threadStats["stalls"] = state->stalls;
+        threadStats["ewma_lag_ms"] = state->ewmaLagMs;
+        threadStats["max_lag_ms"] = state->maxLagUs / 1000.0;
+        threadStats["p50_lag_ms"] = percentileMs(state->buckets, state->maxLagUs, 0.50);
+        threadStats["p99_lag_ms"] = percentileMs(state->buckets, state->maxLagUs, 0.99);
+        threadStats["current_action"] = state->currentAction;
+        threadStats["current_action_ms"] = state->currentAction.isEmpty()
+                                           ? 0.0 : (nowUs() - state->actionStartUs) / 1000.0;
+
+        QJsonArray histogram;
+        for (int i = 0; i < HISTOGRAM_BUCKETS; ++i) {
+            histogram.append(state->buckets[i]);
+        }
+        threadStats["histogram"] = histogram;
+        threads.append(threadStats);
+    }
+    stats["threads"] = threads;
+
+    QJsonArray bounds;
+    for (int i = 0; i < HISTOGRAM_BUCKETS - 1; ++i) {
+        bounds.append(BUCKET_BOUNDS_MS[i]);
+    }
+    stats["histogram_bounds_ms"] = bounds;
+
+    QMutexLocker locker(&_stallMutex);
+
+    QJsonArray recent;
+    for (const StallRecord &record : _recentStalls) {
+        QJsonObject item;
+        item["thread"] = record.threadName;
+        item["action"] = record.action;
+        item["lag_ms"] = record.lagMs;
+        item["time"] = record.time.toString(Qt::ISODate);
+        recent.append(item);
+    }
+    stats["recent_stalls"] = recent;
+
+    QJsonObject byAction;
+    for (auto it = _actionStalls.constBegin(); it != _actionStalls.constEnd(); ++it) {
+        QJsonObject item;
+        item["count"] = it.value().count;
+        item["max_lag_ms"] = it.value().maxLagMs;
+        item["avg_lag_ms"] = it.value().count > 0
+                             ? static_cast<double>(it.value().totalLagMs) / it.value().count : 0.0;
+        byAction[it.key()] = item;
+    }
+    stats["stalls_by_action"] = byAction;
+
+    return stats;
+}
@@ -0,0 +1,220 @@
+#ifndef EVENTLOOPMONITOR_H
+#define EVENTLOOPMONITOR_H
+
+#include <QObject>
+#include <QThread>
+#include <QTimer>
+#include <QMutex>
+#include <QHash>
+#include <QList>
+#include <QQueue>
+#include <QAtomicInt>
+#include <QAtomicInteger>
+#include <QElapsedTimer>
+#include <QSharedPointer>
+#include <QJsonObject>
+#include <QDateTime>
+#include "FlightRecorder.h"
+
+/**
+ * @brief 事件循环延迟监控
+ *
+ * 周期性地向每个已注册线程的事件循环投递带时间戳的探针事件，
+ * 探针被执行时的延迟即为该线程事件循环的排队延迟。按线程记录延迟直方图和EWMA，
+ * 探针长时间未被执行时判定为卡顿，并归因到该线程当前正在执行的动作（action名）。
+ *
+ * 探针定时器运行在独立的监控线程中，被监控线程阻塞时仍能及时发现卡顿。
+ * isOverloaded()供连接准入判断使用。
+ */
+class EventLoopMonitor : public QObject
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @brief 监控配置
+     */
+    struct MonitorConfig {
+        bool enabled = true;
+        int probeIntervalMs = 100;            // 探针投递间隔
+        int stallThresholdMs = 250;           // 卡顿判定阈值
+        int admissionLagThresholdMs = 500;    // 超过该延迟时拒绝新连接，<=0表示不限制
+        double ewmaAlpha = 0.2;               // 延迟EWMA平滑系数
+        int maxRecentStalls = 50;             // 保留的最近卡顿记录数
+    };
+
+    static const int HISTOGRAM_BUCKETS = 12;
+    static const int BUCKET_BOUNDS_MS[HISTOGRAM_BUCKETS - 1];
+
+    static EventLoopMonitor* instance();
+
+    /**
+     * @brief 初始化并启动监控线程
+     */
+    bool initialize(const MonitorConfig &config);
+
+    /**
+     * @brief 停止监控线程
+     */
+    void shutdown();
+
+    bool isEnabled() const { return _running.loadAcquire() != 0; }
+
+    /**
+     * @brief 注册需要监控的线程
+     * @param thread 运行事件循环的线程
+     * @param name 线程名称
+     */
+    void registerThread(QThread *thread, const QString &name);
+
+    /**
+     * @brief 取消线程监控
+     */
+    void unregisterThread(QThread *thread);
+
+    /**
+     * @brief 设置当前线程正在执行的动作，用于卡顿归因
+     */
+    void beginAction(const QString &action);
+
+    /**
+     * @brief 清除当前线程正在执行的动作
+     */
+    void endAction();
+
+    /**
+     * @brief 是否存在事件循环延迟超过准入阈值的线程
+     */
+    bool isOverloaded() const;
+
+    /**
+     * @brief 获取所有线程中最大的当前延迟（毫秒）
+     */
+    double maxCurrentLagMs() const;
+
+    /**
+     * @brief 获取监控统计信息
+     */
+    QJsonObject getStatistics() const;
+
+signals:
+    /**
+     * @brief 检测到事件循环卡顿
+     * @param threadName 线程名称
+     * @param action 卡顿时正在执行的动作
+     * @param lagMs 已延迟的毫秒数
+     */
+    void stallDetected(const QString &threadName, const QString &action, qint64 lagMs);
+
+private slots:
+    void onProbeTimer();
+
+private:
+    /**
+     * @brief 单个线程的监控状态
+     */
+    struct LoopState {
+        QString name;
+        QThread *thread = nullptr;
+        QObject *probe = nullptr;                 // 位于目标线程中的探针上下文对象
+
+        QAtomicInteger<qint64> probePostedUs;     // 未完成探针的投递时刻，0表示无
+        QAtomicInt stallReported;
+
+        mutable QMutex mutex;
+        qint64 buckets[HISTOGRAM_BUCKETS] = {};
+        qint64 probes = 0;
+        qint64 stalls = 0;
+        qint64 maxLagUs = 0;
+        double ewmaLagMs = 0.0;
+
+        QString currentAction;
+        qint64 actionStartUs = 0;
+        QString lastAction;
+    };
+
+    /**
+     * @brief 卡顿记录
+     */
+    struct StallRecord {
+        QString threadName;
+        QString action;
+        qint64 lagMs;
+        QDateTime time;
+    };
+
+    /**
+     * @brief 按动作聚合的卡顿统计
+     */
+    struct ActionStallStats {
+        qint64 count = 0;
+        qint64 maxLagMs = 0;
+        qint64 totalLagMs = 0;
+    };
+
+    explicit EventLoopMonitor(QObject *parent = nullptr);
+    ~EventLoopMonitor();
+
+    qint64 nowUs() const { return _clock.nsecsElapsed() / 1000; }
+    void onProbeDelivered(const QSharedPointer<LoopState> &state, qint64 postedUs);
+    void recordStall(LoopState &state, const QString &action, qint64 lagMs);
+    QSharedPointer<LoopState> stateForCurrentThread();
+    static double percentileMs(const qint64 *buckets, qint64 maxLagUs, double percentile);
+
+    static EventLoopMonitor* s_instance;
+    static QMutex s_instanceMutex;
+
+    MonitorConfig _config;
+    QAtomicInt _running;
+    QElapsedTimer _clock;
+
+    QThread *_monitorThread;
+    QTimer *_probeTimer;
+
+    mutable QMutex _statesMutex;
+    QHash<QThread*, QSharedPointer<LoopState>> _states;
+
+    mutable QMutex _stallMutex;
+    QQueue<StallRecord> _recentStalls;
+    QHash<QString, ActionStallStats> _actionStalls;
+};
+
+/**
+ * @brief 动作归因RAII守卫
+ *
+ * 同时向飞行记录器写入动作开始/结束事件。
+ */
+class EventLoopActionScope
+{
+public:
+    explicit EventLoopActionScope(const QString &action)
+        : _actionId(0)
+        , _startNs(0)
+    {
+        EventLoopMonitor::instance()->beginAction(action);
+
+        if (FlightRecorder::isEnabled()) {
+            _actionId = FlightRecorder::internString(action);
+            _startNs = FlightRecorder::nowNs();
+            FlightRecorder::record(FlightRecorder::ActionStart, _actionId);
+        }
+    }
+
+    ~EventLoopActionScope()
+    {
+        EventLoopMonitor::instance()->endAction();
+
+        if (_startNs > 0) {
+            FlightRecorder::record(FlightRecorder::ActionEnd, _actionId,
+                                   (FlightRecorder::nowNs() - _startNs) / 1000);
+        }
+    }
+
+private:
+    quint32 _actionId;
+    quint64 _startNs;
+
+    Q_DISABLE_COPY(EventLoopActionScope)
+};
+
+#endif // EVENTLOOPMONITOR_H
@@ -0,0 +1,487 @@
+#include "FlightRecorder.h"
+#include "../utils/Logger.h"
+#include <QThread>
+#include <QDir>
+#include <QDateTime>
+#include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QCoreApplication>
+#include <chrono>
+#include <cstring>
+
+#ifdef Q_OS_WIN
+#include <io.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <process.h>
+#else
+#include <unistd.h>
+#include <fcntl.h>
+#include <signal.h>
+#endif
+
+static_assert(sizeof(FlightRecorder::Event) == 32, "FlightRecorder::Event must stay 32 bytes");
+
+namespace {
+
+/**
+ * @brief 转储文件头（64字节，本机字节序）
+ */
+struct DumpFileHeader {
+    char magic[8];              // "QKFLTREC"
+    quint32 version;
+    quint32 eventSize;
+    quint32 reason;
+    qint32 signalNumber;
+    quint64 wallClockMsAtInit;
+    quint64 steadyNsAtInit;
+    quint64 dumpSteadyNs;
+    quint32 ringCount;
+    quint32 stringCount;
+    quint32 stringSlotSize;
+    quint32 reserved;
+};
+
+/**
+ * @brief 每个环形缓冲区的头（56字节）
+ */
+struct DumpRingHeader {
+    quint64 threadId;
+    char threadName[32];
+    quint32 capacity;
+    quint32 inUse;
+    quint64 head;
+};
+
+static_assert(sizeof(DumpFileHeader) == 64, "DumpFileHeader layout changed");
+static_assert(sizeof(DumpRingHeader) == 56, "DumpRingHeader layout changed");
+
+const quint32 DUMP_FORMAT_VERSION = 1;
+
+// 以下文件操作均为异步信号安全
+int openDumpFile(const char *path)
+{
+#ifdef Q_OS_WIN
+    return _open(path, _O_CREAT | _O_WRONLY | _O_TRUNC | _O_BINARY, _S_IREAD | _S_IWRITE);
+#else
+    return ::open(path, O_CREAT | O_WRONLY | O_TRUNC, 0644);
+#endif
+}
+
+bool writeAll(int fd, const void *data, size_t size)
+{
+    const char *ptr = static_cast<const char*>(data);
+    while (size > 0) {
+#ifdef Q_OS_WIN
+        int written = _write(fd, ptr, static_cast<unsigned int>(size));
+#else
+        ssize_t written = ::write(fd, ptr, size);
+#endif
+        if (written <= 0) {
+            return false;
+        }
+        ptr += written;
+        size -= static_cast<size_t>(written);
+    }
+    return true;
+}
+
+void closeDumpFile(int fd)
+{
+#ifdef Q_OS_WIN
+    _close(fd);
+#else
+    ::close(fd);
+#endif
+}
+
+quint64 currentProcessId()
+{
+#ifdef Q_OS_WIN
+    return static_cast<quint64>(_getpid());
+#else
+    return static_cast<quint64>(::getpid());
+#endif
+}
+
+int appendText(char *buffer, int pos, int size, const char *text)
+{
+    while (*text && pos < size - 1) {
+        buffer[pos++] = *text++;
+    }
+    buffer[pos] = '\0';
+    return pos;
+}
+
+int appendNumber(char *buffer, int pos, int size, quint64 value)
+{
+    char digits[24];
+    int count = 0;
+    do {
+        digits[count++] = static_cast<char>('0' + value % 10);
+        value /= 10;
+    } while (value > 0 && count < 24);
+
+    while (count > 0 && pos < size - 1) {
+        buffer[pos++] = digits[--count];
+    }
+    buffer[pos] = '\0';
+    return pos;
+}
+
+} // namespace
+
+/**
+ * @brief 单线程环形缓冲区（单写者）
+ */
+struct FlightRecorder::Ring {
+    std::atomic<quint64> head{0};
+    std::atomic<int> inUse{1};
+    quint64 threadId = 0;
+    char threadName[32] = {};
+    quint32 capacity = 0;
+    quint32 mask = 0;
+    Event *events = nullptr;
+};
+
+/**
+ * @brief 线程退出时释放环形缓冲区，供后续线程复用
+ */
+struct FlightRecorder::RingHolder {
+    Ring *ring = nullptr;
+
+    ~RingHolder()
+    {
+        if (ring) {
+            ring->inUse.store(0, std::memory_order_release);
+        }
+    }
+};
+
+// 静态成员初始化
+std::atomic<bool> FlightRecorder::s_enabled{false};
+std::atomic<FlightRecorder::Ring*> FlightRecorder::s_rings[FlightRecorder::MAX_RINGS];
+std::atomic<int> FlightRecorder::s_ringCount{0};
+std::atomic<int> FlightRecorder::s_stringCount{0};
+std::atomic<int> FlightRecorder::s_dumpCounter{0};
+std::atomic_flag FlightRecorder::s_dumping = ATOMIC_FLAG_INIT;
+std::atomic<qint64> FlightRecorder::s_lastAnomalyDumpMs{0};
+char FlightRecorder::s_strings[FlightRecorder::MAX_STRINGS][FlightRecorder::STRING_SLOT_SIZE];
+char FlightRecorder::s_dumpDir[FlightRecorder::PATH_SIZE];
+quint32 FlightRecorder::s_capacity = 8192;
+quint64 FlightRecorder::s_wallClockMsAtInit = 0;
+quint64 FlightRecorder::s_steadyNsAtInit = 0;
+FlightRecorder::RecorderConfig FlightRecorder::s_config;
+thread_local FlightRecorder::RingHolder FlightRecorder::t_ringHolder;
+
+bool FlightRecorder::initialize(const RecorderConfig &config)
+{
+    s_config = config;
+
+    if (!config.enabled) {
+        LOG_INFO("Flight recorder disabled");
+        return true;
+    }
+
+    // 容量向上取2的幂，便于用掩码定位槽位
+    quint32 capacity = 1;
+    while (capacity < static_cast<quint32>(qMax(64, config.eventsPerThread))) {
+        capacity <<= 1;
+    }
+    s_capacity = capacity;
+
+    QDir dir;
+    if (!dir.mkpath(config.dumpDir)) {
+        LOG_WARNING(QString("Failed to create flight recorder directory: %1").arg(config.dumpDir));
+    }
+
+    // 预先保存转储目录，信号处理函数中不能分配内存
+    QByteArray dumpDir = QDir(config.dumpDir).absolutePath().toLocal8Bit();
+    int length = qMin(dumpDir.size(), PATH_SIZE - 64);
+    std::memcpy(s_dumpDir, dumpDir.constData(), length);
+    s_dumpDir[length] = '\0';
+
+    s_wallClockMsAtInit = static_cast<quint64>(QDateTime::currentMSecsSinceEpoch());
+    s_steadyNsAtInit = nowNs();
+
+    s_enabled.store(true, std::memory_order_release);
+
+    LOG_INFO(QString("Flight recorder enabled: %1 events per thread, dump dir %2")
+             .arg(s_capacity).arg(QString::fromLocal8Bit(s_dumpDir)));
+    return true;
+}
+
+void FlightRecorder::shutdown()
+{
+    if (!isEnabled()) {
+        return;
+    }
+
+    if (s_config.dumpOnShutdown) {
+        dump(ReasonShutdown);
+    }
+
+    // 缓冲区不释放：其他线程可能仍在写入
+    s_enabled.store(false, std::memory_order_release);
+}
+
+quint64 FlightRecorder::nowNs()
+{
+    return static_cast<quint64>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+FlightRecorder::Ring* FlightRecorder::currentRing()
+{
+    RingHolder &holder = t_ringHolder;
+    if (!holder.ring) {
+        holder.ring = acquireRing();
+    }
+    return holder.ring;
+}
+
+FlightRecorder::Ring* FlightRecorder::acquireRing()
+{
+    Ring *ring = nullptr;
+
+    if (s_ringCount.load(std::memory_order_acquire) < MAX_RINGS) {
+        int index = s_ringCount.fetch_add(1, std::memory_order_acq_rel);
+        if (index < MAX_RINGS) {
+            ring = new Ring();
+            ring->capacity = s_capacity;
+            ring->mask = s_capacity - 1;
+            ring->events = new Event[s_capacity]();
+            s_rings[index].store(ring, std::memory_order_release);
+        }
+    }
+
+    // 槽位已满时复用已退出线程的缓冲区
+    if (!ring) {
+        for (int i = 0; i < MAX_RINGS; ++i) {
+            Ring *candidate = s_rings[i].load(std::memory_order_acquire);
+            int expected = 0;
+            if (candidate && candidate->inUse.compare_exchange_strong(expected, 1)) {
+                candidate->head.store(0, std::memory_order_release);
+                ring = candidate;
+                break;
+            }
+        }
+    }
+
+    if (!ring) {
+        return nullptr;
+    }
+
+    ring->threadId = static_cast<quint64>(reinterpret_cast<quintptr>(QThread::currentThreadId()));
+    QByteArray name = QThread::currentThread()->objectName().toUtf8();
+    if (name.isEmpty()) {
+        name = QThread::currentThread() == QCoreApplication::instance()->thread()
+               ? QByteArray("main") : QByteArray("worker");
+    }
+    int length = qMin(name.size(), static_cast<int>(sizeof(ring->threadName)) - 1);
+    std::memcpy(ring->threadName, name.constData(), length);
+    ring->threadName[length] = '\0';
+
+    return ring;
+}
+
+void FlightRecorder::record(EventType type, quint64 a, quint64 b)
+{
+    if (!isEnabled()) {
+        return;
+    }
+
+    Ring *ring = currentRing();
+    if (!ring) {
+        return;
+    }
+
+    quint64 head = ring->head.load(std::memory_order_relaxed);
+    Event &event = ring->events[head & ring->mask];
+    event.timestampNs = nowNs();
+    event.sequence = static_cast<quint32>(head);
+    event.type = type;
+    event.flags = 0;
+    event.a = a;
+    event.b = b;
+    ring->head.store(head + 1, std::memory_order_release);
+}
+
+quint32 FlightRecorder::internString(const QString &text)
+{
+    static QMutex mutex;
+    static QHash<QString, quint32> ids;
+
+    QMutexLocker locker(&mutex);
+
+    auto it = ids.constFind(text);
+    if (it != ids.constEnd()) {
+        return it.value();
+    }
+
+    int index = s_stringCount.load(std::memory_order_relaxed);
+    if (index >= MAX_STRINGS) {
+        return 0xFFFFFFFF;
+    }
+
+    QByteArray bytes = text.toUtf8();
+    int length = qMin(bytes.size(), STRING_SLOT_SIZE - 1);
+    std::memcpy(s_strings[index], bytes.constData(), length);
+    s_strings[index][length] = '\0';
+
+    s_stringCount.store(index + 1, std::memory_order_release);
+    ids.insert(text, static_cast<quint32>(index));
+    return static_cast<quint32>(index);
+}
+
+void FlightRecorder::buildDumpPath(char *buffer, int size, int signalNumber)
+{
+    int pos = 0;
+    buffer[0] = '\0';
+    pos = appendText(buffer, pos, size, s_dumpDir);
+    pos = appendText(buffer, pos, size, "/flight_");
+    pos = appendNumber(buffer, pos, size, currentProcessId());
+    pos = appendText(buffer, pos, size, "_");
+    pos = appendNumber(buffer, pos, size, static_cast<quint64>(s_dumpCounter.fetch_add(1)));
+    if (signalNumber > 0) {
+        pos = appendText(buffer, pos, size, "_sig");
+        pos = appendNumber(buffer, pos, size, static_cast<quint64>(signalNumber));
+    }
+    appendText(buffer, pos, size, ".bin");
+}
+
+bool FlightRecorder::writeDump(const char *path, DumpReason reason, int signalNumber)
+{
+    // 同一时刻只允许一个转储，转储过程中崩溃时不会重入
+    if (s_dumping.test_and_set(std::memory_order_acquire)) {
+        return false;
+    }
+
+    int fd = openDumpFile(path);
+    if (fd < 0) {
+        s_dumping.clear(std::memory_order_release);
+        return false;
+    }
+
+    int ringCount = qMin(s_ringCount.load(std::memory_order_acquire), static_cast<int>(MAX_RINGS));
+    int stringCount = s_stringCount.load(std::memory_order_acquire);
+
+    // 统计实际已发布的缓冲区
+    quint32 publishedRings = 0;
+    for (int i = 0; i < ringCount; ++i) {
+        if (s_rings[i].load(std::memory_order_acquire)) {
+            publishedRings++;
+        }
+    }
+
+    DumpFileHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, "QKFLTREC", 8);
+    header.version = DUMP_FORMAT_VERSION;
+    header.eventSize = sizeof(Event);
+    header.reason = reason;
+    header.signalNumber = signalNumber;
+    header.wallClockMsAtInit = s_wallClockMsAtInit;
+    header.steadyNsAtInit = s_steadyNsAtInit;
+    header.dumpSteadyNs = nowNs();
+    header.ringCount = publishedRings;
+    header.stringCount = static_cast<quint32>(stringCount);
+    header.stringSlotSize = STRING_SLOT_SIZE;
+
+    bool ok = writeAll(fd, &header, sizeof(header));
+
+    for (int i = 0; ok && i < stringCount; ++i) {
+        ok = writeAll(fd, s_strings[i], STRING_SLOT_SIZE);
+    }
+
+    for (int i = 0; ok && i < ringCount; ++i) {
+        Ring *ring = s_rings[i].load(std::memory_order_acquire);
+        if (!ring) {
+            continue;
+        }
+
+        DumpRingHeader ringHeader;
+        std::memset(&ringHeader, 0, sizeof(ringHeader));
+        ringHeader.threadId = ring->threadId;
+        std::memcpy(ringHeader.threadName, ring->threadName, sizeof(ringHeader.threadName));
+        ringHeader.capacity = ring->capacity;
+        ringHeader.inUse = static_cast<quint32>(ring->inUse.load(std::memory_order_relaxed));
+        ringHeader.head = ring->head.load(std::memory_order_acquire);
+
+        ok = writeAll(fd, &ringHeader, sizeof(ringHeader)) &&
+             writeAll(fd, ring->events, sizeof(Event) * ring->capacity);
+    }
+
+    closeDumpFile(fd);
+    s_dumping.clear(std::memory_order_release);
+    return ok;
+}
+
+QString FlightRecorder::dump(DumpReason reason)
+{
+    if (!isEnabled()) {
+        return QString();
+    }
+
+    record(DumpTriggered, reason);
+
+    char path[PATH_SIZE];
+    buildDumpPath(path, PATH_SIZE, 0);
+
+    if (!writeDump(path, reason, 0)) {
+        LOG_WARNING(QString("Flight recorder dump failed: %1").arg(QString::fromLocal8Bit(path)));
+        return QString();
+    }
+
+    QString dumpPath = QString::fromLocal8Bit(path);
+    LOG_INFO(QString("Flight recorder dumped to %1").arg(dumpPath));
+    return dumpPath;
+}
+
+void FlightRecorder::triggerAnomalyDump(const QString &source)
+{
+    if (!isEnabled()) {
+        return;
+    }
+
+    qint64 now = QDateTime::currentMSecsSinceEpoch();
+    qint64 last = s_lastAnomalyDumpMs.load(std::memory_order_acquire);
+    qint64 intervalMs = static_cast<qint64>(s_config.anomalyDumpIntervalSeconds) * 1000;
+
+    if (last > 0 && now - last < intervalMs) {
+        return;
+    }
+    if (!s_lastAnomalyDumpMs.compare_exchange_strong(last, now)) {
+        return;
+    }
+
+    LOG_WARNING(QString("Flight recorder anomaly detected: %1").arg(source));
+    record(Marker, internString(source));
+    dump(ReasonAnomaly);
+}
+
+void FlightRecorder::dumpFromSignal(int signalNumber, bool fatal)
+{
+    if (!isEnabled()) {
+        return;
+    }
+
+    char path[PATH_SIZE];
+    buildDumpPath(path, PATH_SIZE, signalNumber);
+    writeDump(path, fatal ? ReasonFatalSignal : ReasonSignal, signalNumber);
+}
+
+void FlightRecorder::installSignalHandlers()
+{
+#ifdef Q_OS_UNIX
+    struct sigaction action;
+    std::memset(&action, 0, sizeof(action));
+    action.sa_handler = [](int signalNumber) {
+        FlightRecorder::dumpFromSignal(signalNumber, false);
+    };
+    sigemptyset(&action.sa_mask);
+    action.sa_flags = SA_RESTART;
+    sigaction(SIGUSR1, &action, nullptr);
+#endif
+}
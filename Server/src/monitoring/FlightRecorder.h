@@ -0,0 +1,160 @@
+#ifndef FLIGHTRECORDER_H
+#define FLIGHTRECORDER_H
+
+#include <QString>
+#include <QtGlobal>
+#include <atomic>
+
+/**
+ * @brief 进程内飞行记录器
+ *
+ * 常驻开启的低开销事件记录：每个线程拥有一个无锁环形缓冲区（单写者），
+ * 记录定长二进制事件（连接接入、帧收发、动作开始/结束、数据库连接获取/归还、锁等待等），
+ * 只保留最近的N条。在以下时机整体转储到文件：
+ * - 收到SIGUSR1（仅Unix）
+ * - 收到致命信号（SIGSEGV/SIGABRT等），转储路径只使用异步信号安全的系统调用
+ * - 异常检测触发（事件循环卡顿、消息队列积压），带限频
+ *
+ * 转储文件使用 scripts/flight_recorder_decode.py 解码为时间线。
+ * 与Logger一样为静态类，以便在信号处理函数中直接访问。
+ */
+class FlightRecorder
+{
+public:
+    /**
+     * @brief 事件类型
+     */
+    enum EventType : quint16 {
+        Marker = 0,
+        ConnectionAccepted = 1,   // a=socket描述符, b=当前活动连接数
+        ConnectionClosed = 2,     // a=连接ID
+        FrameIn = 3,              // a=连接ID, b=消息字节数
+        FrameOut = 4,             // a=连接ID, b=帧字节数
+        ActionStart = 5,          // a=动作名字符串ID
+        ActionEnd = 6,            // a=动作名字符串ID, b=耗时(us)
+        DbAcquire = 7,            // a=是否成功, b=等待耗时(us)
+        DbRelease = 8,            // b=持有耗时(us)
+        LockWait = 9,             // a=锁名字符串ID, b=等待耗时(us)
+        QueueDepth = 10,          // a=队列名字符串ID, b=深度
+        LoopStall = 11,           // a=动作名字符串ID, b=延迟(ms)
+        DumpTriggered = 12        // a=转储原因
+    };
+
+    /**
+     * @brief 转储原因
+     */
+    enum DumpReason : quint32 {
+        ReasonManual = 0,
+        ReasonSignal = 1,
+        ReasonFatalSignal = 2,
+        ReasonAnomaly = 3,
+        ReasonShutdown = 4
+    };
+
+    /**
+     * @brief 定长事件（32字节）
+     */
+    struct Event {
+        quint64 timestampNs;
+        quint32 sequence;
+        quint16 type;
+        quint16 flags;
+        quint64 a;
+        quint64 b;
+    };
+
+    /**
+     * @brief 记录器配置
+     */
+    struct RecorderConfig {
+        bool enabled = true;
+        int eventsPerThread = 8192;            // 每线程环形缓冲区容量，向上取2的幂
+        QString dumpDir = "logs/flight";       // 转储目录
+        int anomalyDumpIntervalSeconds = 300;  // 异常触发转储的最小间隔
+        bool dumpOnShutdown = false;           // 正常关闭时是否转储
+    };
+
+    /**
+     * @brief 初始化记录器
+     */
+    static bool initialize(const RecorderConfig &config);
+
+    /**
+     * @brief 关闭记录器
+     */
+    static void shutdown();
+
+    static bool isEnabled() { return s_enabled.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief 记录一个事件（无锁，仅写当前线程的缓冲区）
+     */
+    static void record(EventType type, quint64 a = 0, quint64 b = 0);
+
+    /**
+     * @brief 注册字符串并返回其ID，用于动作名、锁名等
+     * @return 字符串ID，表已满时返回0xFFFFFFFF
+     */
+    static quint32 internString(const QString &text);
+
+    /**
+     * @brief 获取单调时钟纳秒数
+     */
+    static quint64 nowNs();
+
+    /**
+     * @brief 立即转储（普通上下文）
+     * @return 转储文件路径，失败时为空
+     */
+    static QString dump(DumpReason reason);
+
+    /**
+     * @brief 异常检测触发的转储（按间隔限频）
+     * @param source 触发源描述
+     */
+    static void triggerAnomalyDump(const QString &source);
+
+    /**
+     * @brief 信号处理函数中调用的转储，仅使用异步信号安全的调用
+     * @param signalNumber 信号编号
+     * @param fatal 是否为致命信号
+     */
+    static void dumpFromSignal(int signalNumber, bool fatal);
+
+    /**
+     * @brief 安装SIGUSR1转储处理函数（仅Unix）
+     */
+    static void installSignalHandlers();
+
+private:
+    struct Ring;
+    struct RingHolder;
+
+    static Ring* currentRing();
+    static Ring* acquireRing();
+    static bool writeDump(const char *path, DumpReason reason, int signalNumber);
+    static void buildDumpPath(char *buffer, int size, int signalNumber);
+
+    static const int MAX_RINGS = 256;
+    static const int MAX_STRINGS = 1024;
+    static const int STRING_SLOT_SIZE = 48;
+    static const int PATH_SIZE = 512;
+
+    static std::atomic<bool> s_enabled;
+    static std::atomic<Ring*> s_rings[MAX_RINGS];
+    static std::atomic<int> s_ringCount;
+    static std::atomic<int> s_stringCount;
+    static std::atomic<int> s_dumpCounter;
+    static std::atomic_flag s_dumping;
+    static std::atomic<qint64> s_lastAnomalyDumpMs;
+
+    static char s_strings[MAX_STRINGS][STRING_SLOT_SIZE];
+    static char s_dumpDir[PATH_SIZE];
+    static quint32 s_capacity;
+    static quint64 s_wallClockMsAtInit;
+    static quint64 s_steadyNsAtInit;
+    static RecorderConfig s_config;
+    static thread_local RingHolder t_ringHolder;
+};
+
+#endif // FLIGHTRECORDER_H
@@ -0,0 +1,507 @@
+#include "Tracer.h"
+#include "../utils/Logger.h"
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QDir>
+#include <QJsonDocument>
+#include <QRandomGenerator>
+#include <QMutexLocker>
+
+namespace {
+
+/**
+ * @brief 线程局部追踪上下文
+ */
+struct ThreadTraceContext {
+    bool active = false;
+    bool headSampled = false;
+    int depth = 0;
+    QString traceId;
+    QVector<TraceSpanRecord> spans;
+};
+
+thread_local ThreadTraceContext t_traceContext;
+
+// 达到该数量时立即唤醒导出线程，否则按刷新间隔批量写出
+const int EXPORT_WAKE_THRESHOLD = 64;
+
+qint64 currentThreadNumericId()
+{
+    return static_cast<qint64>(reinterpret_cast<quintptr>(QThread::currentThreadId()));
+}
+
+} // namespace
+
+// 静态成员初始化
+Tracer* Tracer::s_instance = nullptr;
+QMutex Tracer::s_instanceMutex;
+
+Tracer::Tracer(QObject *parent)
+    : QObject(parent)
+    , _enabled(0)
+    , _exporter(nullptr)
+    , _tracesStarted(0)
+    , _tracesHeadSampled(0)
+    , _tracesTailKept(0)
+    , _tracesDiscarded(0)
+    , _spansTruncated(0)
+{
+}
+
+Tracer::~Tracer()
+{
+    shutdown();
+}
+
+Tracer* Tracer::instance()
+{
+    if (!s_instance) {
+        QMutexLocker locker(&s_instanceMutex);
+        if (!s_instance) {
+            s_instance = new Tracer();
+        }
+    }
+    return s_instance;
+}
+
+bool Tracer::initialize(const TracerConfig &config)
+{
+    if (_exporter) {
+        LOG_WARNING("Tracer already initialized");
+        return true;
+    }
+
+    _config = config;
+    _config.sampleRate = qBound(0.0, _config.sampleRate, 1.0);
+    _config.maxSpansPerTrace = qMax(1, _config.maxSpansPerTrace);
+
+    if (!_config.enabled) {
+        LOG_INFO("Request tracing disabled");
+        return true;
+    }
+
+    _clock.start();
+
+    _exporter = new TraceExporter(_config.outputDir, _config.flushIntervalMs,
+                                  _config.maxPendingTraces, _config.maxFileBytes);
+    _exporter->start(QThread::LowPriority);
+
+    _enabled.storeRelease(1);
+
+    LOG_INFO(QString("Request tracing enabled: sample_rate=%1, slow_threshold=%2ms, output=%3")
+             .arg(_config.sampleRate).arg(_config.slowThresholdMs).arg(_config.outputDir));
+    return true;
+}
+
+void Tracer::shutdown()
+{
+    _enabled.storeRelease(0);
+
+    if (_exporter) {
+        _exporter->stop();
+        delete _exporter;
+        _exporter = nullptr;
+    }
+}
+
+bool Tracer::beginTrace(const QString &requestId)
+{
+    if (!isEnabled()) {
+        return false;
+    }
+
+    ThreadTraceContext &ctx = t_traceContext;
+    ctx.active = true;
+    ctx.depth = 0;
+    ctx.headSampled = QRandomGenerator::global()->generateDouble() < _config.sampleRate;
+    ctx.traceId = requestId.isEmpty()
+                  ? QString("anon-%1").arg(_tracesStarted.loadAcquire())
+                  : requestId;
+    ctx.spans.clear();
+    ctx.spans.reserve(16);
+
+    _tracesStarted.fetchAndAddRelaxed(1);
+    if (ctx.headSampled) {
+        _tracesHeadSampled.fetchAndAddRelaxed(1);
+    }
+    return true;
+}
+
+bool Tracer::continueTrace(const Context &context)
+{
+    if (!isEnabled() || !context.isValid()) {
+        return false;
+    }
+
+    // 采样结果已在提交线程计入统计，这里只恢复上下文
+    ThreadTraceContext &ctx = t_traceContext;
+    ctx.active = true;
+    ctx.depth = 0;
+    ctx.headSampled = context.headSampled;
+    ctx.traceId = context.traceId;
+    ctx.spans.clear();
+    ctx.spans.reserve(16);
+    return true;
+}
+
+Tracer::Context Tracer::currentContext()
+{
+    Context context;
+    const ThreadTraceContext &ctx = t_traceContext;
+    if (ctx.active) {
+        context.traceId = ctx.traceId;
+        context.headSampled = ctx.headSampled;
+    }
+    return context;
+}
+
+void Tracer::endTrace(qint64 rootStartUs)
+{
+    ThreadTraceContext &ctx = t_traceContext;
+    if (!ctx.active) {
+        return;
+    }
+
+    qint64 durationUs = nowUs() - rootStartUs;
+    bool slow = durationUs >= static_cast<qint64>(_config.slowThresholdMs) * 1000;
+
+    if (ctx.headSampled || slow) {
+        if (!ctx.headSampled) {
+            _tracesTailKept.fetchAndAddRelaxed(1);
+        }
+
+        TraceRecord record;
+        record.traceId = ctx.traceId;
+        record.threadId = currentThreadNumericId();
+        record.headSampled = ctx.headSampled;
+        record.durationUs = durationUs;
+        record.spans.swap(ctx.spans);
+        submit(std::move(record));
+    } else {
+        _tracesDiscarded.fetchAndAddRelaxed(1);
+    }
+
+    ctx.active = false;
+    ctx.depth = 0;
+    ctx.traceId.clear();
+    ctx.spans.clear();
+}
+
+void Tracer::recordSpan(const char *name, qint64 startUs, qint64 durationUs, int depth)
+{
+    ThreadTraceContext &ctx = t_traceContext;
+    if (!ctx.active) {
+        return;
+    }
+
+    if (ctx.spans.size() >= _config.maxSpansPerTrace) {
+        _spansTruncated.fetchAndAddRelaxed(1);
+        return;
+    }
+
+    TraceSpanRecord span = {name, startUs, durationUs, depth};
+    ctx.spans.append(span);
+}
+
+void Tracer::submit(TraceRecord &&record)
+{
+    if (_exporter) {
+        _exporter->enqueue(std::move(record));
+    }
+}
+
+QJsonObject Tracer::getStatistics() const
+{
+    QJsonObject stats;
+    stats["enabled"] = isEnabled();
+    stats["sample_rate"] = _config.sampleRate;
+    stats["slow_threshold_ms"] = _config.slowThresholdMs;
+    stats["traces_started"] = _tracesStarted.loadAcquire();
+    stats["traces_head_sampled"] = _tracesHeadSampled.loadAcquire();
+    stats["traces_tail_kept"] = _tracesTailKept.loadAcquire();
+    stats["traces_discarded"] = _tracesDiscarded.loadAcquire();
+    stats["spans_truncated"] = _spansTruncated.loadAcquire();
+
+    if (_exporter) {
+        stats["pending_traces"] = _exporter->pendingCount();
+        stats["exported_traces"] = _exporter->exportedTraces();
+        stats["exported_spans"] = _exporter->exportedSpans();
+        stats["dropped_traces"] = _exporter->droppedTraces();
+        stats["current_file"] = _exporter->currentFile();
+    }
+
+    return stats;
+}
+
+// ==================== TraceExporter ====================
+
+TraceExporter::TraceExporter(const QString &outputDir, int flushIntervalMs, int maxPending,
+                             qint64 maxFileBytes, QObject *parent)
+    : QThread(parent)
+    , _outputDir(outputDir)
+    , _flushIntervalMs(qMax(100, flushIntervalMs))
+    , _maxPending(qMax(1, maxPending))
+    , _maxFileBytes(maxFileBytes)
+    , _stopRequested(false)
+    , _firstEvent(true)
+    , _exportedTraces(0)
+    , _exportedSpans(0)
+    , _droppedTraces(0)
+{
+}
+
+TraceExporter::~TraceExporter()
+{
+    stop();
+}
+
+bool TraceExporter::enqueue(TraceRecord &&record)
+{
+    QMutexLocker locker(&_queueMutex);
+
+    if (_stopRequested || _queue.size() >= _maxPending) {
+        _droppedTraces.fetchAndAddRelaxed(1);
+        return false;
+    }
+
+    _queue.enqueue(std::move(record));
+
+    if (_queue.size() >= EXPORT_WAKE_THRESHOLD) {
+        _queueCondition.wakeOne();
+    }
+    return true;
+}
+
+void TraceExporter::stop()
+{
+    {
+        QMutexLocker locker(&_queueMutex);
+        _stopRequested = true;
+        _queueCondition.wakeAll();
+    }
+
+    if (isRunning()) {
+        wait();
+    }
+}
+
+int TraceExporter::pendingCount() const
+{
+    QMutexLocker locker(&_queueMutex);
+    return _queue.size();
+}
+
+QString TraceExporter::currentFile() const
+{
+    QMutexLocker locker(&_queueMutex);
+    return _currentFileName;
+}
+
+void TraceExporter::run()
+{
+    if (!openNewFile()) {
+        LOG_ERROR(QString("Failed to open trace output in %1, tracing export disabled").arg(_outputDir));
+    }
+
+    forever {
+        QVector<TraceRecord> batch;
+        bool stopping = false;
+
+        {
+            QMutexLocker locker(&_queueMutex);
+            if (_queue.isEmpty() && !_stopRequested) {
+                _queueCondition.wait(&_queueMutex, _flushIntervalMs);
+            }
+
+            batch.reserve(_queue.size());
+            while (!_queue.isEmpty()) {
+                batch.append(_queue.dequeue());
+            }
+            stopping = _stopRequested;
+        }
+
+        if (!batch.isEmpty() && _file.isOpen()) {
+            writeTraces(batch);
+        }
+
+        if (stopping) {
+            break;
+        }
+    }
+
+    closeFile();
+}
+
+bool TraceExporter::openNewFile()
+{
+    QDir dir;
+    if (!dir.mkpath(_outputDir)) {
+        return false;
+    }
+
+    QString fileName = QString("%1/trace_%2_%3.json")
+                       .arg(_outputDir)
+                       .arg(QDateTime::currentDateTime().toString("yyyyMMdd_hhmmss_zzz"))
+                       .arg(QCoreApplication::applicationPid());
+
+    _file.setFileName(fileName);
+    if (!_file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        return false;
+    }
+
+    // Chrome JSON数组格式
+    _file.write("[\n");
+    _firstEvent = true;
+
+    QMutexLocker locker(&_queueMutex);
+    _currentFileName = fileName;
+    return true;
+}
+
+void TraceExporter::closeFile()
+{
+    if (_file.isOpen()) {
+        _file.write("\n]\n");
+        _file.close();
+    }
+}
+
+void TraceExporter::writeTraces(const QVector<TraceRecord> &records)
+{
+    const qint64 pid = QCoreApplication::applicationPid();
+    qint64 spanCount = 0;
+
+    for (const TraceRecord &record : records) {
+        QJsonObject args;
+        args["trace_id"] = record.traceId;
+        args["sampled"] = record.headSampled ? "head" : "slow";
+
+        for (const TraceSpanRecord &span : record.spans) {
+            QJsonObject event;
+            event["name"] = QString::fromLatin1(span.name);
+            event["cat"] = "qkchat";
+            event["ph"] = "X";
+            event["ts"] = span.startUs;
+            event["dur"] = span.durationUs;
+            event["pid"] = pid;
+            event["tid"] = record.threadId;
+
+            QJsonObject spanArgs = args;
+            spanArgs["depth"] = span.depth;
+            event["args"] = spanArgs;
+
+            if (!_firstEvent) {
+                _file.write(",\n");
+            }
+            _file.write(QJsonDocument(event).toJson(QJsonDocument::Compact));
+            _firstEvent = false;
+            ++spanCount;
+        }
+    }
+
+    _file.flush();
+    _exportedTraces.fetchAndAddRelaxed(records.size());
+    _exportedSpans.fetchAndAddRelaxed(static_cast<int>(spanCount));
+
+    // 文件滚动
+    if (_maxFileBytes > 0 && _file.size() >= _maxFileBytes) {
+        closeFile();
+        if (!openNewFile()) {
+            LOG_ERROR(QString("Failed to rotate trace file in %1").arg(_outputDir));
+        }
+    }
+}
+
+// ==================== TraceScope ====================
+
+TraceScope::TraceScope(const char *name)
+    : _name(name)
+    , _startUs(0)
+    , _depth(0)
+    , _active(t_traceContext.active)
+{
+    if (!_active) {
+        return;
+    }
+
+    _depth = t_traceContext.depth++;
+    _startUs = Tracer::instance()->nowUs();
+}
+
+TraceScope::~TraceScope()
+{
+    if (!_active) {
+        return;
+    }
+
+    Tracer *tracer = Tracer::instance();
+    t_traceContext.depth--;
+    tracer->recordSpan(_name, _startUs, tracer->nowUs() - _startUs, _depth);
+}
+
+// ==================== TraceRequestScope ====================
+
+TraceRequestScope::TraceRequestScope(const char *name, const QString &requestId)
+    : _name(name)
+    , _startUs(0)
+    , _depth(0)
+    , _active(false)
+    , _isRoot(false)
+{
+    ThreadTraceContext &ctx = t_traceContext;
+
+    if (ctx.active) {
+        // 已在追踪中，作为普通嵌套跨度
+        _active = true;
+    } else {
+        Tracer *tracer = Tracer::instance();
+        if (!tracer->isEnabled()) {
+            return;
+        }
+        _isRoot = tracer->beginTrace(requestId);
+        _active = _isRoot;
+    }
+
+    if (_active) {
+        _depth = ctx.depth++;
+        _startUs = Tracer::instance()->nowUs();
+    }
+}
+
+TraceRequestScope::TraceRequestScope(const char *name, const Tracer::Context &context)
+    : _name(name)
+    , _startUs(0)
+    , _depth(0)
+    , _active(false)
+    , _isRoot(false)
+{
+    ThreadTraceContext &ctx = t_traceContext;
+
+    if (ctx.active) {
+        // 执行器内联执行时仍在提交线程的追踪中
+        _active = true;
+    } else {
+        _isRoot = Tracer::instance()->continueTrace(context);
+        _active = _isRoot;
+    }
+
+    if (_active) {
+        _depth = ctx.depth++;
+        _startUs = Tracer::instance()->nowUs();
+    }
+}
+
+TraceRequestScope::~TraceRequestScope()
+{
+    if (!_active) {
+        return;
+    }
+
+    Tracer *tracer = Tracer::instance();
+    t_traceContext.depth--;
+    tracer->recordSpan(_name, _startUs, tracer->nowUs() - _startUs, _depth);
+
+    if (_isRoot) {
+        tracer->endTrace(_startUs);
+    }
+}
@@ -0,0 +1,266 @@
+#ifndef TRACER_H
+#define TRACER_H
+
+#include <QObject>
+#include <QThread>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QAtomicInt>
+#include <QElapsedTimer>
+#include <QJsonObject>
+#include <QVector>
+#include <QQueue>
+#include <QFile>
+
+/**
+ * @brief 单个跨度记录
+ *
+ * 名称使用静态字符串字面量，记录时不做任何内存分配。
+ * 时间均为相对追踪器启动时刻的微秒数。
+ */
+struct TraceSpanRecord {
+    const char *name;
+    qint64 startUs;
+    qint64 durationUs;
+    int depth;
+};
+
+/**
+ * @brief 一条完整的请求追踪
+ */
+struct TraceRecord {
+    QString traceId;
+    qint64 threadId;
+    bool headSampled;
+    qint64 durationUs;
+    QVector<TraceSpanRecord> spans;
+};
+
+class TraceExporter;
+
+/**
+ * @brief 请求追踪器
+ *
+ * 为请求处理链路（网络解析 -> 协议分发 -> 聊天处理 -> 业务服务 -> 数据库/Redis）
+ * 记录嵌套的耗时跨度。每个线程维护一个线程局部的跨度栈，追踪ID直接复用请求的request_id。
+ *
+ * 采样策略：
+ * - 头部采样：请求开始时按sample_rate随机决定是否保留
+ * - 尾部采样：未命中头部采样的请求在结束时若超过slow_threshold_ms仍然保留
+ *
+ * 请求交给执行器线程处理时，提交处用currentContext()捕获追踪ID和采样结果，执行线程用
+ * TRACE_CONTINUE以同一追踪ID记录后续跨度，导出为同一追踪下的另一条线程轨迹。
+ *
+ * 保留的追踪交由后台导出线程批量写入Chrome trace-event格式的JSON文件，
+ * 可直接在chrome://tracing或Perfetto中打开。追踪关闭时所有埋点只做一次原子读取。
+ */
+class Tracer : public QObject
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @brief 跨线程传递的追踪上下文
+     *
+     * 请求交给其他线程执行时在提交处捕获，执行线程据此以相同的追踪ID和头部采样结果继续记录。
+     */
+    struct Context {
+        QString traceId;
+        bool headSampled = false;
+
+        bool isValid() const { return !traceId.isEmpty(); }
+    };
+
+    /**
+     * @brief 追踪配置
+     */
+    struct TracerConfig {
+        bool enabled = false;
+        double sampleRate = 0.01;           // 头部采样率 0.0 - 1.0
+        int slowThresholdMs = 200;          // 超过该耗时的请求总是保留
+        QString outputDir = "logs/traces";  // 导出目录
+        int flushIntervalMs = 2000;         // 导出线程刷新间隔
+        int maxSpansPerTrace = 256;         // 单条追踪的最大跨度数
+        int maxPendingTraces = 4096;        // 导出队列上限，超出后丢弃
+        qint64 maxFileBytes = 64 * 1024 * 1024; // 单个追踪文件大小上限
+    };
+
+    static Tracer* instance();
+
+    /**
+     * @brief 初始化追踪器并启动导出线程
+     * @param config 追踪配置
+     * @return 初始化是否成功
+     */
+    bool initialize(const TracerConfig &config);
+
+    /**
+     * @brief 停止导出线程并写出剩余追踪
+     */
+    void shutdown();
+
+    /**
+     * @brief 追踪是否开启
+     */
+    bool isEnabled() const { return _enabled.loadAcquire() != 0; }
+
+    /**
+     * @brief 获取追踪统计信息
+     */
+    QJsonObject getStatistics() const;
+
+    /**
+     * @brief 获取相对启动时刻的微秒时间戳
+     */
+    qint64 nowUs() const { return _clock.nsecsElapsed() / 1000; }
+
+    /**
+     * @brief 捕获当前线程的活动追踪，没有活动追踪时返回无效上下文
+     */
+    static Context currentContext();
+
+    // 以下接口供TraceScope/TraceRequestScope使用
+    bool beginTrace(const QString &requestId);
+    bool continueTrace(const Context &context);
+    void endTrace(qint64 rootStartUs);
+    void recordSpan(const char *name, qint64 startUs, qint64 durationUs, int depth);
+
+private:
+    explicit Tracer(QObject *parent = nullptr);
+    ~Tracer();
+
+    void submit(TraceRecord &&record);
+
+    static Tracer* s_instance;
+    static QMutex s_instanceMutex;
+
+    TracerConfig _config;
+    QAtomicInt _enabled;
+    QElapsedTimer _clock;
+    TraceExporter *_exporter;
+
+    // 统计信息
+    QAtomicInt _tracesStarted;
+    QAtomicInt _tracesHeadSampled;
+    QAtomicInt _tracesTailKept;
+    QAtomicInt _tracesDiscarded;
+    QAtomicInt _spansTruncated;
+
+    friend class TraceExporter;
+};
+
+/**
+ * @brief 追踪导出线程
+ *
+ * 从队列中批量取出追踪记录，转换为Chrome trace-event（"ph":"X"完整事件）
+ * 追加写入文件，文件超过大小上限后滚动到新文件。
+ */
+class TraceExporter : public QThread
+{
+    Q_OBJECT
+
+public:
+    TraceExporter(const QString &outputDir, int flushIntervalMs, int maxPending,
+                  qint64 maxFileBytes, QObject *parent = nullptr);
+    ~TraceExporter();
+
+    /**
+     * @brief 提交追踪记录
+     * @return 队列已满时返回false
+     */
+    bool enqueue(TraceRecord &&record);
+
+    /**
+     * @brief 请求停止并等待剩余记录写出
+     */
+    void stop();
+
+    int pendingCount() const;
+    qint64 exportedTraces() const { return _exportedTraces.loadAcquire(); }
+    qint64 exportedSpans() const { return _exportedSpans.loadAcquire(); }
+    int droppedTraces() const { return _droppedTraces.loadAcquire(); }
+    QString currentFile() const;
+
+protected:
+    void run() override;
+
+private:
+    bool openNewFile();
+    void closeFile();
+    void writeTraces(const QVector<TraceRecord> &records);
+
+    QString _outputDir;
+    int _flushIntervalMs;
+    int _maxPending;
+    qint64 _maxFileBytes;
+
+    mutable QMutex _queueMutex;
+    QWaitCondition _queueCondition;
+    QQueue<TraceRecord> _queue;
+    bool _stopRequested;
+
+    QFile _file;
+    QString _currentFileName;
+    bool _firstEvent;
+
+    QAtomicInt _exportedTraces;
+    QAtomicInt _exportedSpans;
+    QAtomicInt _droppedTraces;
+};
+
+/**
+ * @brief 跨度RAII守卫
+ *
+ * 仅当当前线程存在活动追踪时才记录，否则构造和析构都只是一次线程局部判断。
+ */
+class TraceScope
+{
+public:
+    explicit TraceScope(const char *name);
+    ~TraceScope();
+
+private:
+    const char *_name;
+    qint64 _startUs;
+    int _depth;
+    bool _active;
+
+    Q_DISABLE_COPY(TraceScope)
+};
+
+/**
+ * @brief 请求根跨度RAII守卫
+ *
+ * 当前线程没有活动追踪时以requestId为追踪ID开启新追踪，并在析构时
+ * 决定保留或丢弃；已有活动追踪时退化为普通的嵌套跨度。
+ */
+class TraceRequestScope
+{
+public:
+    TraceRequestScope(const char *name, const QString &requestId);
+
+    /**
+     * @brief 在执行线程上继续提交线程捕获的追踪，上下文无效时不记录
+     */
+    TraceRequestScope(const char *name, const Tracer::Context &context);
+    ~TraceRequestScope();
+
+private:
+    const char *_name;
+    qint64 _startUs;
+    int _depth;
+    bool _active;
+    bool _isRoot;
+
+    Q_DISABLE_COPY(TraceRequestScope)
+};
+
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+
+// 便捷宏
+#define TRACE_SPAN(name) TraceScope TRACE_CONCAT(_traceScope, __LINE__)(name)
+#define TRACE_REQUEST(name, requestId) TraceRequestScope TRACE_CONCAT(_traceRequest, __LINE__)(name, requestId)
+#define TRACE_CONTINUE(name, context) TraceRequestScope TRACE_CONCAT(_traceRequest, __LINE__)(name, context)
+
+#endif // TRACER_H
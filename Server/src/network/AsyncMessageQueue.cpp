@@ -5,6 +5,19 @@
 #include <QUuid>
 #include <QJsonDocument>
 #include <QCoreApplication>
+#include <QRandomGenerator>
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// 小顶堆比较：到期时间越早越靠前
+struct RetryDueLater {
+    template <typename Entry>
+    bool operator()(const Entry& a, const Entry& b) const { return a.dueMs > b.dueMs; }
+};
+
+} // namespace
 
 // 静态成员初始化
 AsyncMessageQueue* AsyncMessageQueue::s_instance = nullptr;
@@ -16,19 +29,22 @@ AsyncMessageQueue::AsyncMessageQueue(QObject *parent)
     , _totalProcessed(0)
     , _totalFailed(0)
     , _totalRetried(0)
+    , _totalDeadLettered(0)
     , _currentQueueSize(0)
+    , _totalBatches(0)
+    , _lastBatchSize(0)
     , _messagesPerSecond(0)
     , _initialized(false)
     , _shuttingDown(false)
     , _messageIdCounter(0)
 {
     _lastResetTime = QDateTime::currentDateTime();
+    _retryWaiterActive = false;
+    _clock.start();
     
     // 创建定时器
-    _retryTimer = new QTimer(this);
     _healthCheckTimer = new QTimer(this);
     
-    connect(_retryTimer, &QTimer::timeout, this, &AsyncMessageQueue::handleRetryMessages);
     connect(_healthCheckTimer, &QTimer::timeout, this, &AsyncMessageQueue::performHealthCheck);
 }
 
@@ -60,12 +76,17 @@ bool AsyncMessageQueue::initialize(const QueueConfig& config)
     _config = config;
     _shuttingDown = false;
     
-    LOG_INFO(QString("Initializing async message queue: threads=%1, batchSize=%2, maxQueue=%3")
-             .arg(_config.workerThreads).arg(_config.batchSize).arg(_config.maxQueueSize));
+    _config.minBatchSize = qMax(1, _config.minBatchSize);
+    _config.batchSize = qMax(_config.minBatchSize, _config.batchSize);
     
-    // 创建工作线程
+    LOG_INFO(QString("Initializing async message queue: threads=%1, batchSize=%2-%3, maxQueue=%4")
+             .arg(_config.workerThreads).arg(_config.minBatchSize).arg(_config.batchSize).arg(_config.maxQueueSize));
+    
+    // 创建工作线程：线程启动后进入阻塞式消费循环，没有消息时不会被周期唤醒。
+    // 消费循环不运行事件循环，因此不注册到事件循环监控
     for (int i = 0; i < _config.workerThreads; ++i) {
         QThread* thread = new QThread(this);
+        thread->setObjectName(QString("message_worker_%1").arg(i));
         MessageWorker* worker = new MessageWorker(this);
         
         worker->moveToThread(thread);
@@ -81,7 +102,6 @@ bool AsyncMessageQueue::initialize(const QueueConfig& config)
     }
     
     // 启动定时器
-    _retryTimer->start(_config.retryDelay);
     _healthCheckTimer->start(30000); // 30秒健康检查
     
     _initialized = true;
@@ -100,16 +120,17 @@ void AsyncMessageQueue::shutdown()
     
     // LOG_INFO removed
     
-    _shuttingDown = true;
-    
     // 停止定时器
-    _retryTimer->stop();
     _healthCheckTimer->stop();
     
-    // 唤醒所有等待的工作线程
-    _messageAvailable.wakeAll();
+    // 持锁设置关闭标志后唤醒所有等待的工作线程，避免丢失唤醒
+    {
+        QMutexLocker locker(&_queueMutex);
+        _shuttingDown = true;
+        _messageAvailable.wakeAll();
+    }
     
-    // 等待工作线程完成
+    // 等待工作线程退出消费循环
     for (QThread* thread : _workerThreads) {
         thread->quit();
         if (!thread->wait(5000)) {
@@ -125,7 +146,7 @@ void AsyncMessageQueue::shutdown()
     
     QMutexLocker locker(&_queueMutex);
     _messageQueue.clear();
-    _retryQueue.clear();
+    _retryHeap.clear();
     _currentQueueSize.storeRelease(0);
     
     _initialized = false;
@@ -142,20 +163,8 @@ QString AsyncMessageQueue::enqueueMessage(qint64 userId, const QString& clientId
     
     QMutexLocker locker(&_queueMutex);
     
-    // 检查队列是否已满
-    if (_messageQueue.size() >= _config.maxQueueSize) {
-        if (_config.enableFlowControl) {
-            // 流量控制：丢弃低优先级消息
-            if (priority >= Normal) {
-                LOG_WARNING("Message queue full, dropping low priority message");
-                emit queueFullWarning(_messageQueue.size());
-                return QString();
-            }
-        } else {
-            LOG_ERROR("Message queue full, cannot enqueue message");
-            emit queueFullWarning(_messageQueue.size());
-            return QString();
-        }
+    if (!checkCapacityLocked(priority)) {
+        return QString();
     }
     
     // 创建消息
@@ -168,21 +177,7 @@ QString AsyncMessageQueue::enqueueMessage(qint64 userId, const QString& clientId
     msg.timestamp = QDateTime::currentDateTime();
     msg.retryCount = 0;
     
-    // 根据优先级插入队列
-    bool inserted = false;
-    QQueue<Message>::iterator it = _messageQueue.begin();
-    while (it != _messageQueue.end()) {
-        if (msg.priority < it->priority) {
-            _messageQueue.insert(it, msg);
-            inserted = true;
-            break;
-        }
-        ++it;
-    }
-    
-    if (!inserted) {
-        _messageQueue.enqueue(msg);
-    }
+    insertByPriorityLocked(msg);
     
     _currentQueueSize.fetchAndAddOrdered(1);
     _totalEnqueued.fetchAndAddOrdered(1);
@@ -205,16 +200,33 @@ int AsyncMessageQueue::broadcastMessage(const QJsonObject& message, MessagePrior
 int AsyncMessageQueue::sendToUsers(const QList<qint64>& userIds, const QJsonObject& message, 
                                  MessagePriority priority)
 {
-    int successCount = 0;
+    if (_shuttingDown || userIds.isEmpty()) {
+        return 0;
+    }
     
-    for (qint64 userId : userIds) {
-        QString messageId = enqueueMessage(userId, QString(), message, priority);
-        if (!messageId.isEmpty()) {
-            successCount++;
-        }
+    // 在锁外完成序列化，整个用户组共享同一编码帧
+    Message msg;
+    msg.recipients = RecipientList(userIds.begin(), userIds.end());
+    msg.frame = EncodedFrame::encode(message);
+    msg.priority = priority;
+    msg.timestamp = QDateTime::currentDateTime();
+    msg.retryCount = 0;
+    
+    QMutexLocker locker(&_queueMutex);
+    
+    if (!checkCapacityLocked(priority)) {
+        return 0;
     }
     
-    return successCount;
+    msg.messageId = generateMessageId();
+    insertByPriorityLocked(msg);
+    
+    _currentQueueSize.fetchAndAddOrdered(1);
+    _totalEnqueued.fetchAndAddOrdered(1);
+    
+    _messageAvailable.wakeOne();
+    
+    return msg.recipients.size();
 }
 
 QJsonObject AsyncMessageQueue::getStatistics() const
@@ -224,15 +236,25 @@ QJsonObject AsyncMessageQueue::getStatistics() const
     QJsonObject stats;
     stats["initialized"] = _initialized;
     stats["current_queue_size"] = _currentQueueSize.loadAcquire();
-    stats["retry_queue_size"] = _retryQueue.size();
+    stats["retry_queue_size"] = _retryHeap.size();
+    if (!_retryHeap.isEmpty()) {
+        stats["next_retry_in_ms"] = qMax<qint64>(0, _retryHeap.first().dueMs - _clock.elapsed());
+    }
     stats["total_enqueued"] = _totalEnqueued.loadAcquire();
     stats["total_processed"] = _totalProcessed.loadAcquire();
     stats["total_failed"] = _totalFailed.loadAcquire();
     stats["total_retried"] = _totalRetried.loadAcquire();
+    stats["total_dead_lettered"] = _totalDeadLettered.loadAcquire();
     stats["messages_per_second"] = _messagesPerSecond.loadAcquire();
     stats["worker_threads"] = _config.workerThreads;
     stats["max_queue_size"] = _config.maxQueueSize;
-    stats["batch_size"] = _config.batchSize;
+    stats["min_batch_size"] = _config.minBatchSize;
+    stats["max_batch_size"] = _config.batchSize;
+    stats["last_batch_size"] = _lastBatchSize.loadAcquire();
+    stats["total_batches"] = _totalBatches.loadAcquire();
+    
+    QMutexLocker deadLetterLocker(&_deadLetterMutex);
+    stats["dead_letter_count"] = _deadLetters.size();
     
     return stats;
 }
@@ -252,29 +274,102 @@ void AsyncMessageQueue::clearQueue()
 {
     QMutexLocker locker(&_queueMutex);
     
-    int clearedCount = _messageQueue.size() + _retryQueue.size();
+    int clearedCount = _messageQueue.size() + _retryHeap.size();
     _messageQueue.clear();
-    _retryQueue.clear();
+    _retryHeap.clear();
     _currentQueueSize.storeRelease(0);
     
     LOG_INFO(QString("Cleared %1 messages from queue").arg(clearedCount));
 }
 
+QList<DeadLetter> AsyncMessageQueue::getDeadLetters(int limit) const
+{
+    QMutexLocker locker(&_deadLetterMutex);
+    
+    QList<DeadLetter> result;
+    for (int i = _deadLetters.size() - 1; i >= 0 && result.size() < limit; --i) {
+        result.append(_deadLetters.at(i));
+    }
+    return result;
+}
+
+int AsyncMessageQueue::replayDeadLetters()
+{
+    QQueue<DeadLetter> deadLetters;
+    {
+        QMutexLocker locker(&_deadLetterMutex);
+        deadLetters.swap(_deadLetters);
+    }
+    
+    if (deadLetters.isEmpty() || _shuttingDown) {
+        return 0;
+    }
+    
+    QMutexLocker locker(&_queueMutex);
+    
+    int replayed = 0;
+    for (const DeadLetter& deadLetter : deadLetters) {
+        if (!checkCapacityLocked(deadLetter.message.priority)) {
+            break;
+        }
+        
+        Message message = deadLetter.message;
+        message.retryCount = 0;
+        insertByPriorityLocked(message);
+        _currentQueueSize.fetchAndAddOrdered(1);
+        replayed++;
+    }
+    
+    if (replayed > 0) {
+        _messageAvailable.wakeAll();
+    }
+    
+    LOG_INFO(QString("Replayed %1 of %2 dead letters").arg(replayed).arg(deadLetters.size()));
+    return replayed;
+}
+
+void AsyncMessageQueue::clearDeadLetters()
+{
+    QMutexLocker locker(&_deadLetterMutex);
+    _deadLetters.clear();
+}
+
 void AsyncMessageQueue::processMessages()
 {
-    // 这个方法由工作线程调用
-    while (!_shuttingDown) {
-        QList<Message> batch = getNextBatch(_config.batchSize);
+    // 这个方法由工作线程调用，直到队列关闭才返回
+    forever {
+        QList<Message> batch;
         
-        if (batch.isEmpty()) {
-            // 没有消息，等待
+        {
             QMutexLocker locker(&_queueMutex);
-            if (!_shuttingDown && _messageQueue.isEmpty()) {
-                _messageAvailable.wait(&_queueMutex, _config.processingInterval);
+            
+            forever {
+                if (_shuttingDown) {
+                    return;
+                }
+                
+                promoteDueRetriesLocked(_clock.elapsed());
+                if (!_messageQueue.isEmpty()) {
+                    break;
+                }
+                
+                // 没有消息时阻塞等待；仅一个线程按最早重试的到期时间定时等待，其余无限期等待
+                if (_retryHeap.isEmpty() || _retryWaiterActive) {
+                    _messageAvailable.wait(&_queueMutex);
+                } else {
+                    qint64 waitMs = qMax<qint64>(1, _retryHeap.first().dueMs - _clock.elapsed());
+                    _retryWaiterActive = true;
+                    _messageAvailable.wait(&_queueMutex, static_cast<unsigned long>(waitMs));
+                    _retryWaiterActive = false;
+                }
             }
-            continue;
+            
+            batch = takeBatchLocked(adaptiveBatchSizeLocked());
         }
         
+        _totalBatches.fetchAndAddOrdered(1);
+        _lastBatchSize.storeRelease(batch.size());
+        
         // 处理批次消息
         for (const Message& message : batch) {
             bool success = sendMessage(message);
@@ -285,15 +380,16 @@ void AsyncMessageQueue::processMessages()
             } else {
                 _totalFailed.fetchAndAddOrdered(1);
                 
-                // 添加到重试队列
+                // 按退避延迟安排重试，超过次数进入死信
                 if (message.retryCount < _config.maxRetryCount) {
                     Message retryMsg = message;
                     retryMsg.retryCount++;
-                    addRetryMessage(retryMsg);
+                    scheduleRetry(retryMsg);
                     _totalRetried.fetchAndAddOrdered(1);
                 } else {
                     LOG_ERROR(QString("Message failed after %1 retries: %2")
                              .arg(_config.maxRetryCount).arg(message.messageId));
+                    addDeadLetter(message, "max_retries_exceeded");
                     emit messageProcessed(message.messageId, false);
                 }
             }
@@ -304,38 +400,6 @@ void AsyncMessageQueue::processMessages()
     }
 }
 
-void AsyncMessageQueue::handleRetryMessages()
-{
-    QMutexLocker locker(&_queueMutex);
-    
-    if (_retryQueue.isEmpty()) {
-        return;
-    }
-    
-    // 将重试消息重新加入主队列
-    while (!_retryQueue.isEmpty()) {
-        Message retryMsg = _retryQueue.dequeue();
-        
-        // 根据优先级插入
-        bool inserted = false;
-        QQueue<Message>::iterator it = _messageQueue.begin();
-        while (it != _messageQueue.end()) {
-            if (retryMsg.priority < it->priority) {
-                _messageQueue.insert(it, retryMsg);
-                inserted = true;
-                break;
-            }
-            ++it;
-        }
-        
-        if (!inserted) {
-            _messageQueue.enqueue(retryMsg);
-        }
-    }
-    
-    _messageAvailable.wakeAll();
-}
-
 void AsyncMessageQueue::performHealthCheck()
 {
     // 重置每秒消息数计数器
@@ -383,27 +447,120 @@ bool AsyncMessageQueue::sendMessage(const Message& message)
     }
 }
 
-QList<Message> AsyncMessageQueue::getNextBatch(int batchSize)
+int AsyncMessageQueue::adaptiveBatchSizeLocked() const
+{
+    // 按每个工作线程平均分到的积压量取批大小：空闲时逐条处理降低延迟，积压时批量处理提高吞吐
+    int workers = qMax(1, _config.workerThreads);
+    int share = (_messageQueue.size() + workers - 1) / workers;
+    return qBound(_config.minBatchSize, share, _config.batchSize);
+}
+
+QList<Message> AsyncMessageQueue::takeBatchLocked(int batchSize)
 {
-    QMutexLocker locker(&_queueMutex);
-    
     QList<Message> batch;
     int count = qMin(batchSize, _messageQueue.size());
+    batch.reserve(count);
     
     for (int i = 0; i < count; ++i) {
-        if (!_messageQueue.isEmpty()) {
-            batch.append(_messageQueue.dequeue());
-            _currentQueueSize.fetchAndSubOrdered(1);
-        }
+        batch.append(_messageQueue.dequeue());
+        _currentQueueSize.fetchAndSubOrdered(1);
     }
     
     return batch;
 }
 
-void AsyncMessageQueue::addRetryMessage(const Message& message)
+qint64 AsyncMessageQueue::computeRetryDelay(int retryCount) const
+{
+    // 指数退避：retryDelay * 2^(n-1)，不超过上限
+    double delay = _config.retryDelay * std::pow(2.0, qMax(0, retryCount - 1));
+    delay = qMin(delay, static_cast<double>(_config.maxRetryDelay));
+    
+    // 抖动：在[delay*(1-jitter), delay]内随机，避免大量失败消息同时重试
+    double jitter = qBound(0.0, _config.retryJitter, 1.0);
+    double minDelay = delay * (1.0 - jitter);
+    return static_cast<qint64>(minDelay + QRandomGenerator::global()->generateDouble() * (delay - minDelay));
+}
+
+void AsyncMessageQueue::scheduleRetry(const Message& message)
 {
+    RetryEntry entry;
+    entry.dueMs = _clock.elapsed() + computeRetryDelay(message.retryCount);
+    entry.message = message;
+    
     QMutexLocker locker(&_queueMutex);
-    _retryQueue.enqueue(message);
+    
+    _retryHeap.append(entry);
+    std::push_heap(_retryHeap.begin(), _retryHeap.end(), RetryDueLater());
+    
+    // 新条目成为最早到期项时，唤醒等待线程以便按新的到期时间重新等待
+    if (_retryHeap.first().dueMs == entry.dueMs) {
+        _messageAvailable.wakeAll();
+    }
+}
+
+void AsyncMessageQueue::promoteDueRetriesLocked(qint64 nowMs)
+{
+    while (!_retryHeap.isEmpty() && _retryHeap.first().dueMs <= nowMs) {
+        std::pop_heap(_retryHeap.begin(), _retryHeap.end(), RetryDueLater());
+        insertByPriorityLocked(_retryHeap.last().message);
+        _retryHeap.removeLast();
+        _currentQueueSize.fetchAndAddOrdered(1);
+    }
+}
+
+void AsyncMessageQueue::addDeadLetter(const Message& message, const QString& reason)
+{
+    DeadLetter deadLetter;
+    deadLetter.message = message;
+    deadLetter.reason = reason;
+    deadLetter.failedAt = QDateTime::currentDateTime();
+    
+    {
+        QMutexLocker locker(&_deadLetterMutex);
+        _deadLetters.enqueue(deadLetter);
+        while (_deadLetters.size() > qMax(0, _config.maxDeadLetters)) {
+            _deadLetters.dequeue();
+        }
+    }
+    
+    _totalDeadLettered.fetchAndAddOrdered(1);
+    emit messageDeadLettered(message.messageId, reason);
+}
+
+bool AsyncMessageQueue::checkCapacityLocked(MessagePriority priority)
+{
+    if (_messageQueue.size() < _config.maxQueueSize) {
+        return true;
+    }
+    
+    if (_config.enableFlowControl) {
+        // 流量控制：丢弃低优先级消息
+        if (priority >= Normal) {
+            LOG_WARNING("Message queue full, dropping low priority message");
+            emit queueFullWarning(_messageQueue.size());
+            return false;
+        }
+        return true;
+    }
+    
+    LOG_ERROR("Message queue full, cannot enqueue message");
+    emit queueFullWarning(_messageQueue.size());
+    return false;
+}
+
+void AsyncMessageQueue::insertByPriorityLocked(const Message& message)
+{
+    // 根据优先级插入队列
+    QQueue<Message>::iterator it = _messageQueue.begin();
+    while (it != _messageQueue.end()) {
+        if (message.priority < it->priority) {
+            _messageQueue.insert(it, message);
+            return;
+        }
+        ++it;
+    }
+    
+    _messageQueue.enqueue(message);
 }
 
 #include "AsyncMessageQueue.moc"
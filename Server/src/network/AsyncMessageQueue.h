@@ -10,7 +10,10 @@
 #include <QJsonObject>
 #include <QAtomicInt>
 #include <QDateTime>
+#include <QElapsedTimer>
+#include <QVector>
 #include "MessageWorker.h"
+#include "EncodedFrame.h"
 
 /**
  * @brief 异步消息队列类
@@ -40,8 +43,17 @@ struct Message {
     QDateTime timestamp;
     int retryCount;
     
+    // 扇出消息：一个编码帧对应多个接收者，帧在所有接收者之间共享
+    RecipientList recipients;
+    EncodedFrame frame;
+    
     Message() : userId(-1), priority(Normal), retryCount(0) {}
     
+    /**
+     * @brief 是否为多接收者扇出消息
+     */
+    bool isFanOut() const { return !recipients.isEmpty(); }
+    
     bool operator<(const Message& other) const {
         // 优先级越小越优先
         if (priority != other.priority) {
@@ -52,16 +64,28 @@ struct Message {
     }
 };
 
+/**
+ * @brief 死信记录：超过最大重试次数仍未发送成功的消息
+ */
+struct DeadLetter {
+    Message message;
+    QString reason;
+    QDateTime failedAt;
+};
+
 /**
  * @brief 队列配置结构
  */
 struct QueueConfig {
     int maxQueueSize = 10000;        // 最大队列长度
     int workerThreads = 4;           // 工作线程数
-    int batchSize = 50;              // 批处理大小
-    int processingInterval = 10;     // 处理间隔(ms)
+    int batchSize = 50;              // 最大批处理大小（高负载时）
+    int minBatchSize = 1;            // 最小批处理大小（低负载时，优先降低延迟）
     int maxRetryCount = 3;           // 最大重试次数
-    int retryDelay = 1000;           // 重试延迟(ms)
+    int retryDelay = 1000;           // 首次重试延迟(ms)，之后指数退避
+    int maxRetryDelay = 30000;       // 重试延迟上限(ms)
+    double retryJitter = 0.5;        // 重试抖动比例，实际延迟在[delay*(1-jitter), delay]内随机
+    int maxDeadLetters = 1000;       // 死信保留上限
     bool enableFlowControl = true;   // 启用流量控制
     int flowControlThreshold = 8000; // 流量控制阈值
 };
@@ -113,10 +137,12 @@ public:
     
     /**
      * @brief 发送消息到指定用户组
+     * 
+     * 整个用户组只入队一条扇出消息，消息内容只序列化一次。
      * @param userIds 用户ID列表
      * @param message 消息内容
      * @param priority 消息优先级
-     * @return 成功入队的消息数量
+     * @return 入队的接收者数量，失败返回0
      */
     int sendToUsers(const QList<qint64>& userIds, const QJsonObject& message, 
                    MessagePriority priority = Normal);
@@ -140,9 +166,32 @@ public:
     bool isHealthy() const;
     
     /**
-     * @brief 清空队列
+     * @brief 清空队列（含待重试消息）
      */
     void clearQueue();
+    
+    /**
+     * @brief 获取最近的死信
+     * @param limit 最大返回数量
+     * @return 死信列表，按失败时间从新到旧
+     */
+    QList<DeadLetter> getDeadLetters(int limit = 100) const;
+    
+    /**
+     * @brief 将所有死信重新入队，重试计数清零
+     * @return 重新入队的消息数量
+     */
+    int replayDeadLetters();
+    
+    /**
+     * @brief 清空死信
+     */
+    void clearDeadLetters();
+    
+    /**
+     * @brief 工作线程消费循环，阻塞等待消息直到队列关闭
+     */
+    void processMessages();
 
 signals:
     /**
@@ -163,10 +212,15 @@ signals:
      * @param error 错误信息
      */
     void queueError(const QString& error);
+    
+    /**
+     * @brief 消息进入死信信号
+     * @param messageId 消息ID
+     * @param reason 失败原因
+     */
+    void messageDeadLettered(const QString& messageId, const QString& reason);
 
 private slots:
-    void processMessages();
-    void handleRetryMessages();
     void performHealthCheck();
 
 private:
@@ -183,17 +237,50 @@ private:
     bool sendMessage(const Message& message);
     
     /**
-     * @brief 获取下一批消息
+     * @brief 按队列深度计算本次批大小（调用者需持有_queueMutex）
+     */
+    int adaptiveBatchSizeLocked() const;
+    
+    /**
+     * @brief 取出下一批消息（调用者需持有_queueMutex）
      * @param batchSize 批次大小
      * @return 消息列表
      */
-    QList<Message> getNextBatch(int batchSize);
+    QList<Message> takeBatchLocked(int batchSize);
     
     /**
-     * @brief 添加重试消息
+     * @brief 计算第retryCount次重试的延迟：指数退避加抖动
+     */
+    qint64 computeRetryDelay(int retryCount) const;
+    
+    /**
+     * @brief 安排消息在退避延迟后重试
+     * @param message 消息（retryCount已递增）
+     */
+    void scheduleRetry(const Message& message);
+    
+    /**
+     * @brief 将到期的重试消息移回主队列（调用者需持有_queueMutex）
+     */
+    void promoteDueRetriesLocked(qint64 nowMs);
+    
+    /**
+     * @brief 记录死信
+     */
+    void addDeadLetter(const Message& message, const QString& reason);
+    
+    /**
+     * @brief 检查队列是否允许入队（调用者需持有_queueMutex）
+     * @param priority 消息优先级
+     * @return 是否允许入队
+     */
+    bool checkCapacityLocked(MessagePriority priority);
+    
+    /**
+     * @brief 按优先级插入消息（调用者需持有_queueMutex）
      * @param message 消息
      */
-    void addRetryMessage(const Message& message);
+    void insertByPriorityLocked(const Message& message);
 
 private:
     static AsyncMessageQueue* s_instance;
@@ -201,20 +288,33 @@ private:
     
     QueueConfig _config;
     
+    /**
+     * @brief 待重试消息，按到期时间组织为小顶堆
+     */
+    struct RetryEntry {
+        qint64 dueMs;
+        Message message;
+    };
+    
     // 消息队列（按优先级排序）
     QQueue<Message> _messageQueue;
-    QQueue<Message> _retryQueue;
+    QVector<RetryEntry> _retryHeap;
+    QElapsedTimer _clock;
+    bool _retryWaiterActive;         // 是否已有工作线程在按最早重试时间定时等待
     
     // 线程同步
     mutable QMutex _queueMutex;
     QWaitCondition _messageAvailable;
     
+    // 死信
+    mutable QMutex _deadLetterMutex;
+    QQueue<DeadLetter> _deadLetters;
+    
     // 工作线程
     QList<QThread*> _workerThreads;
     QList<MessageWorker*> _workers;
     
     // 定时器
-    QTimer* _retryTimer;
     QTimer* _healthCheckTimer;
     
     // 统计信息
@@ -222,7 +322,10 @@ private:
     QAtomicInt _totalProcessed;
     QAtomicInt _totalFailed;
     QAtomicInt _totalRetried;
+    QAtomicInt _totalDeadLettered;
     QAtomicInt _currentQueueSize;
+    QAtomicInt _totalBatches;
+    QAtomicInt _lastBatchSize;
     
     // 流量控制
     QAtomicInt _messagesPerSecond;
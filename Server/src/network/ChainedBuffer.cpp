@@ -0,0 +1,162 @@
+#include "ChainedBuffer.h"
+#include "IoBufferPool.h"
+#include <QIODevice>
+#include <cstring>
+
+ChainedBuffer::ChainedBuffer()
+    : _chunkSize(IoBufferPool::instance()->chunkSize())
+    , _headOffset(0)
+    , _tailUsed(0)
+    , _size(0)
+{
+}
+
+ChainedBuffer::~ChainedBuffer()
+{
+    clear();
+}
+
+char* ChainedBuffer::appendChunk()
+{
+    char *chunk = IoBufferPool::instance()->acquire();
+    _chunks.enqueue(chunk);
+    _tailUsed = 0;
+    return chunk;
+}
+
+qint64 ChainedBuffer::readFrom(QIODevice *device, qint64 maxBytes)
+{
+    qint64 total = 0;
+
+    while (total < maxBytes) {
+        if (_chunks.isEmpty() || _tailUsed == _chunkSize) {
+            appendChunk();
+        }
+
+        qint64 space = qMin<qint64>(_chunkSize - _tailUsed, maxBytes - total);
+        qint64 bytesRead = device->read(_chunks.last() + _tailUsed, space);
+        if (bytesRead < 0) {
+            return total > 0 ? total : -1;
+        }
+        if (bytesRead == 0) {
+            break;
+        }
+
+        _tailUsed += static_cast<int>(bytesRead);
+        _size += bytesRead;
+        total += bytesRead;
+    }
+
+    return total;
+}
+
+void ChainedBuffer::append(const char *data, qint64 length)
+{
+    while (length > 0) {
+        if (_chunks.isEmpty() || _tailUsed == _chunkSize) {
+            appendChunk();
+        }
+
+        int count = static_cast<int>(qMin<qint64>(_chunkSize - _tailUsed, length));
+        memcpy(_chunks.last() + _tailUsed, data, count);
+        _tailUsed += count;
+        _size += count;
+        data += count;
+        length -= count;
+    }
+}
+
+bool ChainedBuffer::peek(char *out, qint64 offset, qint64 length) const
+{
+    if (offset < 0 || length < 0 || offset + length > _size) {
+        return false;
+    }
+
+    // 块在逻辑上首尾相接，首块从_headOffset开始可读
+    qint64 position = _headOffset + offset;
+    int index = static_cast<int>(position / _chunkSize);
+    int inner = static_cast<int>(position % _chunkSize);
+
+    while (length > 0) {
+        int count = static_cast<int>(qMin<qint64>(_chunkSize - inner, length));
+        memcpy(out, _chunks.at(index) + inner, count);
+        out += count;
+        length -= count;
+        ++index;
+        inner = 0;
+    }
+
+    return true;
+}
+
+QByteArray ChainedBuffer::view(qint64 offset, qint64 length) const
+{
+    if (offset < 0 || length <= 0 || offset + length > _size) {
+        return QByteArray();
+    }
+
+    qint64 position = _headOffset + offset;
+    int index = static_cast<int>(position / _chunkSize);
+    int inner = static_cast<int>(position % _chunkSize);
+
+    if (inner + length <= _chunkSize) {
+        return QByteArray::fromRawData(_chunks.at(index) + inner, static_cast<int>(length));
+    }
+
+    QByteArray data(static_cast<int>(length), Qt::Uninitialized);
+    peek(data.data(), offset, length);
+    return data;
+}
+
+void ChainedBuffer::discard(qint64 length)
+{
+    length = qBound<qint64>(0, length, _size);
+    _size -= length;
+    _headOffset += static_cast<int>(qMin<qint64>(length, _chunkSize));
+    length -= qMin<qint64>(length, _chunkSize);
+
+    // 按块推进，避免大数据量时_headOffset溢出
+    forever {
+        while (_chunks.size() > 1 && _headOffset >= _chunkSize) {
+            IoBufferPool::instance()->release(_chunks.dequeue());
+            _headOffset -= _chunkSize;
+        }
+        if (length <= 0) {
+            break;
+        }
+        int step = static_cast<int>(qMin<qint64>(length, _chunkSize));
+        _headOffset += step;
+        length -= step;
+    }
+
+    // 数据全部消费后复用剩下的一个块
+    if (_size == 0) {
+        while (_chunks.size() > 1) {
+            IoBufferPool::instance()->release(_chunks.dequeue());
+        }
+        _headOffset = 0;
+        _tailUsed = 0;
+    }
+}
+
+void ChainedBuffer::clear()
+{
+    while (!_chunks.isEmpty()) {
+        IoBufferPool::instance()->release(_chunks.dequeue());
+    }
+    _headOffset = 0;
+    _tailUsed = 0;
+    _size = 0;
+}
+
+void ChainedBuffer::shrink()
+{
+    if (_size == 0) {
+        clear();
+    }
+}
+
+qint64 ChainedBuffer::capacity() const
+{
+    return static_cast<qint64>(_chunks.size()) * _chunkSize;
+}
@@ -0,0 +1,92 @@
+#ifndef CHAINEDBUFFER_H
+#define CHAINEDBUFFER_H
+
+#include <QByteArray>
+#include <QQueue>
+
+class QIODevice;
+
+/**
+ * @brief 由共享池块拼接的字节缓冲区
+ *
+ * 数据直接从设备读入块尾部，消费后整块归还给IoBufferPool，
+ * 因此一次大消息不会让缓冲区永久保持在峰值大小。
+ * 缓冲区为空时只保留一个块以避免频繁借还，shrink()可将其一并归还。
+ * 该类不是线程安全的。
+ */
+class ChainedBuffer
+{
+public:
+    ChainedBuffer();
+    ~ChainedBuffer();
+
+    ChainedBuffer(const ChainedBuffer &) = delete;
+    ChainedBuffer &operator=(const ChainedBuffer &) = delete;
+
+    /**
+     * @brief 从设备读取所有可读数据
+     * @param device 输入设备
+     * @param maxBytes 本次最多读取的字节数
+     * @return 读取的字节数，出错时返回-1
+     */
+    qint64 readFrom(QIODevice *device, qint64 maxBytes);
+
+    /**
+     * @brief 追加数据
+     */
+    void append(const char *data, qint64 length);
+
+    /**
+     * @brief 未消费的字节数
+     */
+    qint64 size() const { return _size; }
+
+    bool isEmpty() const { return _size == 0; }
+
+    /**
+     * @brief 复制从offset开始的length字节
+     * @return 数据不足时返回false
+     */
+    bool peek(char *out, qint64 offset, qint64 length) const;
+
+    /**
+     * @brief 获取从offset开始的length字节
+     *
+     * 数据位于同一块内时返回不复制的视图，视图仅在下一次修改缓冲区之前有效；
+     * 跨块时返回复制后的数据。
+     */
+    QByteArray view(qint64 offset, qint64 length) const;
+
+    /**
+     * @brief 丢弃开头的length字节，消费完的块归还给池
+     */
+    void discard(qint64 length);
+
+    /**
+     * @brief 清空并归还所有块
+     */
+    void clear();
+
+    /**
+     * @brief 缓冲区为空时归还保留的块
+     */
+    void shrink();
+
+    /**
+     * @brief 持有的块总字节数
+     */
+    qint64 capacity() const;
+
+    int chunkCount() const { return _chunks.size(); }
+
+private:
+    char* appendChunk();
+
+    QQueue<char*> _chunks;
+    int _chunkSize;
+    int _headOffset;    // 首块中已消费的字节数
+    int _tailUsed;      // 尾块中已写入的字节数
+    qint64 _size;
+};
+
+#endif // CHAINEDBUFFER_H
@@ -1,6 +1,12 @@
 #include "ClientHandler.h"
 #include "ProtocolHandler.h"
 #include "../utils/Logger.h"
+#include "../monitoring/Tracer.h"
+#include "../monitoring/EventLoopMonitor.h"
+#include "../security/KernelTls.h"
+#include "../utils/RequestCancellation.h"
+#include "RequestExecutor.h"
+#include "InboundScanner.h"
 #include <QSslCertificate>
 #include <QSslKey>
 #include <QSslCipher>
@@ -12,9 +18,24 @@
 #include <QApplication>
 #include <QSet>
 #include <QMutex>
+#include <QtEndian>
+
+#ifdef Q_OS_LINUX
+#include <unistd.h>
+#endif
 
 // 静态成员初始化
 int ClientHandler::s_clientCounter = 0;
+QSet<QString> ClientHandler::s_processedRequests;
+QMutex ClientHandler::s_processedRequestsMutex;
+OutboundLanes::Config ClientHandler::s_outboundConfig;
+qint64 ClientHandler::s_socketReadBufferSize = 64 * 1024;
+IoUringTransport* ClientHandler::s_ioUring = nullptr;
+bool ClientHandler::s_inboundFastPath = true;
+QAtomicInt ClientHandler::s_framesQueued(0);
+QAtomicInt ClientHandler::s_framesCoalesced(0);
+QAtomicInt ClientHandler::s_framesDropped(0);
+QAtomicInt ClientHandler::s_slowConsumerDisconnects(0);
 
 ClientHandler::ClientHandler(qintptr socketDescriptor, ProtocolHandler *protocolHandler, bool useTLS, QObject *parent)
     : QObject(parent)
@@ -24,18 +45,47 @@ ClientHandler::ClientHandler(qintptr socketDescriptor, ProtocolHandler *protocol
     , _state(Initialized)  // 初始状态为Initialized
     , _heartbeatTimeout(60000) // 60秒
     , _useTLS(useTLS)
+    , _kernelTls(false)
     , _messagesSent(0)
     , _messagesReceived(0)
     , _bytesReceived(0)
     , _bytesSent(0)
+    , _slowConsumerDisconnecting(false)
+    , _usesIoUring(false)
+    , _transportDescriptor(-1)
+    , _transportId(0)
 {
     // 生成客户端ID
     _clientId = generateClientId();
     _connectTime = QDateTime::currentDateTime();
     _lastActivity = _connectTime;
     
+    // 内核TLS：在当前工作线程完成握手，成功后描述符按明文连接收发
+    if (_useTLS && KernelTls::instance()->isEnabled()) {
+        if (!KernelTls::instance()->acceptHandshake(socketDescriptor)) {
+            LOG_ERROR(QString("Kernel TLS handshake failed for client %1").arg(_clientId));
+#ifdef Q_OS_LINUX
+            ::close(static_cast<int>(socketDescriptor));
+#endif
+            setState(Error);
+            return;
+        }
+        _kernelTls = true;
+    }
+    
+    bool plainTransport = !_useTLS || _kernelTls;
+    
+    // 明文连接优先使用io_uring传输，描述符在startProcessing中交给传输（需在传输所在线程）
+    if (plainTransport && s_ioUring && s_ioUring->isEnabled()) {
+        _usesIoUring = true;
+        _transportDescriptor = socketDescriptor;
+        _transportPeerAddress = IoUringTransport::peerAddressOf(socketDescriptor);
+        LOG_INFO(QString("Client handler created: %1 (io_uring)").arg(_clientId));
+        return;
+    }
+    
     // 根据配置创建套接字
-    if (_useTLS) {
+    if (!plainTransport) {
         QSslSocket* sslSocket = new QSslSocket(this);
         _socket = sslSocket;
         
@@ -43,6 +93,7 @@ ClientHandler::ClientHandler(qintptr socketDescriptor, ProtocolHandler *protocol
         connect(sslSocket, &QSslSocket::connected, this, &ClientHandler::onConnected);
         connect(sslSocket, &QSslSocket::disconnected, this, &ClientHandler::onDisconnected);
         connect(sslSocket, &QSslSocket::readyRead, this, &ClientHandler::onReadyRead);
+        connect(sslSocket, &QSslSocket::bytesWritten, this, &ClientHandler::onBytesWritten);
         connect(sslSocket, QOverload<QAbstractSocket::SocketError>::of(&QSslSocket::errorOccurred),
                 this, &ClientHandler::onSocketError);
         connect(sslSocket, QOverload<const QList<QSslError>&>::of(&QSslSocket::sslErrors),
@@ -55,6 +106,7 @@ ClientHandler::ClientHandler(qintptr socketDescriptor, ProtocolHandler *protocol
         connect(tcpSocket, &QTcpSocket::connected, this, &ClientHandler::onConnected);
         connect(tcpSocket, &QTcpSocket::disconnected, this, &ClientHandler::onDisconnected);
         connect(tcpSocket, &QTcpSocket::readyRead, this, &ClientHandler::onReadyRead);
+        connect(tcpSocket, &QTcpSocket::bytesWritten, this, &ClientHandler::onBytesWritten);
         connect(tcpSocket, QOverload<QAbstractSocket::SocketError>::of(&QTcpSocket::errorOccurred),
                 this, &ClientHandler::onSocketError);
     }
@@ -72,13 +124,18 @@ ClientHandler::ClientHandler(qintptr socketDescriptor, ProtocolHandler *protocol
         return;
     }
     
+    // 限制套接字内部读缓冲区，数据在readyRead中即时转入共享池块
+    _socket->setReadBufferSize(s_socketReadBufferSize);
+    
     LOG_INFO(QString("Client handler created: %1").arg(_clientId));
 }
 
 ClientHandler::~ClientHandler()
 {
-    // 断开所有信号连接，避免在析构过程中触发信号
-    disconnect();
+    // 断开所有信号连接，避免在析构过程中触发信号；已休眠的连接套接字已交出，无需断开
+    if (_state != Hibernated) {
+        disconnect();
+    }
     
     // 断开网络连接
     if (_socket) {
@@ -98,6 +155,18 @@ ClientHandler::~ClientHandler()
         _socket = nullptr;
     }
     
+    // io_uring连接：关闭传输中的连接，或关闭尚未交出的描述符
+    if (_transportId != 0) {
+        s_ioUring->close(_transportId, false);
+        _transportId = 0;
+    }
+#ifdef Q_OS_LINUX
+    if (_transportDescriptor >= 0) {
+        ::close(static_cast<int>(_transportDescriptor));
+        _transportDescriptor = -1;
+    }
+#endif
+    
     // 清理协议处理器连接
     if (_protocolHandler) {
         // 断开与协议处理器的连接
@@ -108,33 +177,100 @@ ClientHandler::~ClientHandler()
 
 QHostAddress ClientHandler::peerAddress() const
 {
+    if (_usesIoUring) {
+        return _transportPeerAddress;
+    }
     return _socket ? _socket->peerAddress() : QHostAddress();
 }
 
 bool ClientHandler::isConnected() const
 {
+    if (_usesIoUring) {
+        return _transportId != 0;
+    }
     return _socket && _socket->state() == QAbstractSocket::ConnectedState;
 }
 
-bool ClientHandler::sendMessage(const QJsonObject &message)
+bool ClientHandler::sendMessage(const QJsonObject &message, OutboundLanes::Lane lane)
 {
-    if (!isConnected()) {
+    // 其他线程调用时连接状态由sendFrame检查，编码仍在调用线程完成
+    if (QThread::currentThread() == thread() && !isConnected()) {
         LOG_WARNING(QString("Cannot send message to disconnected client: %1").arg(_clientId));
         return false;
     }
     
-    QJsonDocument doc(message);
-    QByteArray data = doc.toJson(QJsonDocument::Compact);
+    return sendFrame(EncodedFrame::encode(message), lane);
+}
+
+bool ClientHandler::sendFrame(const EncodedFrame &frame, OutboundLanes::Lane lane, qint64 coalesceKey)
+{
+    // 业务服务在执行器线程中推送消息，套接字、出站通道和io_uring发送只能在本线程访问；
+    // 以本对象为上下文排队，处理器销毁后排队中的帧随之丢弃。返回值只表示已排队，需要确认时使用postFrame
+    if (QThread::currentThread() != thread()) {
+        if (_state == Disconnected || _state == Error || _state == Hibernated || _slowConsumerDisconnecting) {
+            return false;
+        }
+        QMetaObject::invokeMethod(this, [this, frame, lane, coalesceKey]() {
+            sendFrame(frame, lane, coalesceKey);
+        }, Qt::QueuedConnection);
+        return true;
+    }
     
-    // 添加消息长度前缀（4字节）
-    QByteArray lengthPrefix;
-    QDataStream stream(&lengthPrefix, QIODevice::WriteOnly);
-    stream.setByteOrder(QDataStream::BigEndian);
-    stream << static_cast<quint32>(data.size());
+    if (!isConnected() || _slowConsumerDisconnecting) {
+        LOG_WARNING(QString("Cannot send frame to disconnected client: %1").arg(_clientId));
+        return false;
+    }
     
-    QByteArray fullMessage = lengthPrefix + data;
+    if (frame.isEmpty()) {
+        return false;
+    }
     
-    qint64 bytesWritten = _socket->write(fullMessage);
+    // 写缓冲区未积压时直接写入，保持原有的低延迟路径
+    if (_outbound.isEmpty() && pendingWriteBytes() < s_outboundConfig.writeWatermark) {
+        return writeFrameNow(frame);
+    }
+    
+    int droppedFrames = 0;
+    OutboundLanes::EnqueueResult result = _outbound.enqueue(lane, frame, coalesceKey,
+                                                            s_outboundConfig.bulkBudget, &droppedFrames);
+    if (result == OutboundLanes::Coalesced) {
+        s_framesCoalesced.fetchAndAddRelaxed(1);
+    } else {
+        s_framesQueued.fetchAndAddRelaxed(1);
+    }
+    if (droppedFrames > 0) {
+        s_framesDropped.fetchAndAddRelaxed(droppedFrames);
+    }
+    
+    pumpOutbound();
+    checkSlowConsumer();
+    
+    return true;
+}
+
+QSharedPointer<FrameReceipt> ClientHandler::postFrame(const EncodedFrame &frame, OutboundLanes::Lane lane)
+{
+    return FrameReceipt::post(this, [this, frame, lane]() {
+        return sendFrame(frame, lane);
+    });
+}
+
+bool ClientHandler::writeFrameNow(const EncodedFrame &frame)
+{
+    // io_uring传输在本事件循环周期结束时把所有帧合并提交，无需逐条flush
+    if (_usesIoUring) {
+        if (!s_ioUring->send(_transportId, frame.data())) {
+            LOG_ERROR(QString("Failed to send message to client %1: transport closed").arg(_clientId));
+            return false;
+        }
+        _messagesSent++;
+        _bytesSent += frame.size();
+        FlightRecorder::record(FlightRecorder::FrameOut, reinterpret_cast<quintptr>(this), frame.size());
+        updateLastActivity();
+        return true;
+    }
+    
+    qint64 bytesWritten = _socket->write(frame.data());
     if (bytesWritten == -1) {
         LOG_ERROR(QString("Failed to send message to client %1: %2").arg(_clientId).arg(_socket->errorString()));
         return false;
@@ -143,16 +279,235 @@ bool ClientHandler::sendMessage(const QJsonObject &message)
     _socket->flush();
     _messagesSent++;
     _bytesSent += bytesWritten;
+    FlightRecorder::record(FlightRecorder::FrameOut, reinterpret_cast<quintptr>(this), bytesWritten);
     
     updateLastActivity();
     
+    return true;
+}
+
+void ClientHandler::pumpOutbound()
+{
+    while (!_outbound.isEmpty() && isConnected()
+           && pendingWriteBytes() < s_outboundConfig.writeWatermark) {
+        if (!writeFrameNow(_outbound.takeNext())) {
+            break;
+        }
+    }
+}
+
+void ClientHandler::onBytesWritten(qint64 bytes)
+{
+    Q_UNUSED(bytes)
+    
+    if (!_outbound.isEmpty()) {
+        pumpOutbound();
+    }
+    if (_overLimitTimer.isValid() || !_outbound.isEmpty()) {
+        checkSlowConsumer();
+    }
+}
+
+void ClientHandler::checkSlowConsumer()
+{
+    if (_slowConsumerDisconnecting || !isConnected()) {
+        return;
+    }
+    
+    const OutboundLanes::Config &config = s_outboundConfig;
+    qint64 buffered = pendingWriteBytes() + _outbound.queuedBytes();
+    bool overLimit = buffered > config.hardLimit
+                     || _outbound.laneBytes(OutboundLanes::ControlLane) > config.controlBudget
+                     || _outbound.laneBytes(OutboundLanes::ChatLane) > config.chatBudget;
+    
+    if (!overLimit) {
+        if (_overLimitTimer.isValid()) {
+            LOG_INFO(QString("Client %1 recovered from outbound backlog after %2 ms")
+                     .arg(_clientId).arg(_overLimitTimer.elapsed()));
+            _overLimitTimer.invalidate();
+        }
+        return;
+    }
+    
+    if (!_overLimitTimer.isValid()) {
+        _overLimitTimer.start();
+        LOG_WARNING(QString("Client %1 is a slow consumer: %2 bytes buffered (%3 queued)")
+                    .arg(_clientId).arg(buffered).arg(_outbound.queuedBytes()));
+        return;
+    }
+    
+    if (_overLimitTimer.elapsed() < config.slowConsumerTimeoutMs) {
+        return;
+    }
+    
+    LOG_WARNING(QString("Disconnecting slow consumer %1 (user %2): %3 bytes buffered for %4 ms")
+                .arg(_clientId).arg(_userId).arg(buffered).arg(_overLimitTimer.elapsed()));
+    
+    _slowConsumerDisconnecting = true;
+    s_slowConsumerDisconnects.fetchAndAddRelaxed(1);
+    _outbound.clear();
+    
+    // 可能在服务器持有客户端表锁时被调用，延迟到事件循环中中止连接（丢弃写缓冲区）
+    QMetaObject::invokeMethod(this, [this]() {
+        if (_transportId != 0) {
+            s_ioUring->close(_transportId, false);
+            _transportId = 0;
+            onDisconnected();
+        } else if (_socket) {
+            _socket->abort();
+        }
+    }, Qt::QueuedConnection);
+}
+
+qint64 ClientHandler::bufferedBytes() const
+{
+    qint64 bytes = _receiveBuffer.capacity() + _outbound.queuedBytes() + pendingWriteBytes();
+    if (_socket) {
+        bytes += _socket->bytesAvailable();
+    }
+    return bytes;
+}
 
+void ClientHandler::shrinkIdleBuffers()
+{
+    _receiveBuffer.shrink();
+}
+
+bool ClientHandler::canHibernate(qint64 idleMs) const
+{
+    // 内核TLS连接的会话密钥在内核中，描述符可以脱离套接字对象保存
+    if ((_useTLS && !_kernelTls) || _usesIoUring || _state != Authenticated || _userId <= 0 || _slowConsumerDisconnecting
+        || !isConnected()) {
+        return false;
+    }
+    
+    if (!_receiveBuffer.isEmpty() || !_outbound.isEmpty()
+        || _socket->bytesToWrite() > 0 || _socket->bytesAvailable() > 0) {
+        return false;
+    }
+    
+    return _lastActivity.msecsTo(QDateTime::currentDateTime()) >= idleMs;
+}
+
+bool ClientHandler::detachForHibernation(ConnectionHibernator::HibernatedConnection *connection)
+{
+#ifdef Q_OS_LINUX
+    if (!connection || !canHibernate(0)) {
+        return false;
+    }
+    
+    // 客户端ID格式为client_<毫秒时间戳>_<序号>，拆分后以数值保存
+    QStringList idParts = _clientId.split('_');
+    if (idParts.size() != 3) {
+        return false;
+    }
+    
+    // 复制描述符后关闭套接字对象，内核中的连接由复制的描述符保持
+    int fd = ::dup(static_cast<int>(_socket->socketDescriptor()));
+    if (fd < 0) {
+        LOG_WARNING(QString("Failed to duplicate socket descriptor for client %1").arg(_clientId));
+        return false;
+    }
+    
+    connection->userId = _userId;
+    connection->clientIdMs = idParts.at(1).toLongLong();
+    connection->clientSerial = idParts.at(2).toUInt();
+    connection->connectTimeMs = _connectTime.toMSecsSinceEpoch();
+    connection->lastActivityMs = _lastActivity.toMSecsSinceEpoch();
+    connection->bytesReceived = _bytesReceived;
+    connection->bytesSent = _bytesSent;
+    connection->socketDescriptor = fd;
+    connection->messagesReceived = static_cast<quint32>(_messagesReceived);
+    connection->messagesSent = static_cast<quint32>(_messagesSent);
+    connection->heartbeatTimeoutMs = _heartbeatTimeout;
+    connection->flags = _kernelTls ? ConnectionHibernator::KernelTlsFlag : 0;
+    
+    setState(Hibernated);
+    QObject::disconnect(_socket, nullptr, this, nullptr);
+    _socket->abort();
+    _receiveBuffer.clear();
+    
     return true;
+#else
+    Q_UNUSED(connection)
+    return false;
+#endif
+}
+
+void ClientHandler::restoreFromHibernation(const ConnectionHibernator::HibernatedConnection &connection)
+{
+    _clientId = ConnectionHibernator::clientIdOf(connection);
+    _userId = connection.userId;
+    _connectTime = QDateTime::fromMSecsSinceEpoch(connection.connectTimeMs);
+    _lastActivity = QDateTime::fromMSecsSinceEpoch(connection.lastActivityMs);
+    _bytesReceived = connection.bytesReceived;
+    _bytesSent = connection.bytesSent;
+    _messagesReceived = connection.messagesReceived;
+    _messagesSent = connection.messagesSent;
+    _heartbeatTimeout = connection.heartbeatTimeoutMs;
+    // 重建时按明文描述符接管，内核TLS状态随描述符保留
+    _kernelTls = (connection.flags & ConnectionHibernator::KernelTlsFlag) != 0;
+    _useTLS = _kernelTls;
+    setState(Authenticated);
+}
+
+void ClientHandler::setSocketReadBufferSize(qint64 size)
+{
+    s_socketReadBufferSize = qMax<qint64>(0, size);
+}
+
+void ClientHandler::setInboundFastPath(bool enabled)
+{
+    s_inboundFastPath = enabled;
+}
+
+void ClientHandler::setIoUringTransport(IoUringTransport *transport)
+{
+    s_ioUring = transport;
+}
+
+qint64 ClientHandler::pendingWriteBytes() const
+{
+    if (_usesIoUring) {
+        return _transportId != 0 ? s_ioUring->pendingBytes(_transportId) : 0;
+    }
+    return _socket ? _socket->bytesToWrite() : 0;
+}
+
+void ClientHandler::setOutboundConfig(const OutboundLanes::Config &config)
+{
+    s_outboundConfig = config;
+}
+
+QJsonObject ClientHandler::getOutboundStatistics()
+{
+    QJsonObject stats;
+    stats["write_watermark"] = s_outboundConfig.writeWatermark;
+    stats["hard_limit"] = s_outboundConfig.hardLimit;
+    stats["frames_queued"] = s_framesQueued.loadAcquire();
+    stats["frames_coalesced"] = s_framesCoalesced.loadAcquire();
+    stats["frames_dropped"] = s_framesDropped.loadAcquire();
+    stats["slow_consumer_disconnects"] = s_slowConsumerDisconnects.loadAcquire();
+    return stats;
 }
 
 void ClientHandler::disconnect(const QString &reason)
 {
-    if (_socket && _socket->state() != QAbstractSocket::UnconnectedState) {
+    if (_transportId != 0) {
+        if (!reason.isEmpty()) {
+            QJsonObject disconnectMessage;
+            disconnectMessage["action"] = "disconnect";
+            disconnectMessage["reason"] = reason;
+            disconnectMessage["timestamp"] = QDateTime::currentSecsSinceEpoch();
+            
+            sendMessage(disconnectMessage, OutboundLanes::ControlLane);
+        }
+        
+        // 发完排队的数据后由传输关闭连接
+        s_ioUring->close(_transportId, true);
+        _transportId = 0;
+        onDisconnected();
+    } else if (_socket && _socket->state() != QAbstractSocket::UnconnectedState) {
         // 发送断开连接消息
         if (!reason.isEmpty()) {
             QJsonObject disconnectMessage;
@@ -160,7 +515,7 @@ void ClientHandler::disconnect(const QString &reason)
             disconnectMessage["reason"] = reason;
             disconnectMessage["timestamp"] = QDateTime::currentSecsSinceEpoch();
             
-            sendMessage(disconnectMessage);
+            sendMessage(disconnectMessage, OutboundLanes::ControlLane);
         }
         
         _socket->disconnectFromHost();
@@ -265,8 +620,25 @@ QJsonObject ClientHandler::getClientInfo() const
     info["bytes_sent"] = _bytesSent;
     info["bytes_received"] = _bytesReceived;
     info["use_tls"] = _useTLS;
+    info["kernel_tls"] = _kernelTls;
+    info["transport"] = _usesIoUring ? "io_uring" : "qt";
     info["is_authenticated"] = isAuthenticated();
     
+    QJsonObject outbound;
+    outbound["bytes_to_write"] = pendingWriteBytes();
+    outbound["queued_bytes"] = _outbound.queuedBytes();
+    for (int i = 0; i < OutboundLanes::LaneCount; ++i) {
+        OutboundLanes::Lane lane = static_cast<OutboundLanes::Lane>(i);
+        QJsonObject laneInfo;
+        laneInfo["frames"] = _outbound.laneFrames(lane);
+        laneInfo["bytes"] = _outbound.laneBytes(lane);
+        outbound[OutboundLanes::laneName(lane)] = laneInfo;
+    }
+    if (_overLimitTimer.isValid()) {
+        outbound["over_limit_ms"] = _overLimitTimer.elapsed();
+    }
+    info["outbound"] = outbound;
+    
     if (_heartbeatTimeout > 0) {
         qint64 elapsed = _lastActivity.msecsTo(QDateTime::currentDateTime());
         info["heartbeat_remaining"] = qMax(0LL, _heartbeatTimeout - elapsed);
@@ -280,7 +652,9 @@ void ClientHandler::onConnected()
     LOG_INFO(QString("Client connected: %1 from %2").arg(_clientId).arg(peerAddress().toString()));
     
     // 记录连接信息
-    if (_useTLS) {
+    if (_kernelTls) {
+        LOG_INFO(QString("Using kernel TLS connection for client %1").arg(_clientId));
+    } else if (_useTLS) {
         LOG_INFO(QString("Using SSL connection for client %1").arg(_clientId));
     } else {
         LOG_INFO(QString("Using plain TCP connection for client %1").arg(_clientId));
@@ -291,22 +665,56 @@ void ClientHandler::onConnected()
 
 void ClientHandler::onDisconnected()
 {
+    if (_transportId != 0) {
+        s_ioUring->close(_transportId, false);
+        _transportId = 0;
+    }
+    
     // 避免在已断开状态下重复发射信号
     if (_state != Disconnected) {
         setState(Disconnected);
+        _outbound.clear();
+        _receiveBuffer.clear();
+        // 连接上尚未完成的请求已无人等待
+        RequestCancellation::instance()->cancelClient(_clientId);
         LOG_INFO(QString("Client disconnected: %1").arg(_clientId));
+        FlightRecorder::record(FlightRecorder::ConnectionClosed, reinterpret_cast<quintptr>(this));
         emit disconnected();
     }
 }
 
+void ClientHandler::onTransportData(const char *data, qint64 length)
+{
+    // 传输的接收缓冲区在回调结束后即归还，这里复制进池化的块
+    _receiveBuffer.append(data, length);
+    _bytesReceived += length;
+    updateLastActivity();
+    
+    processReceivedData();
+}
+
+void ClientHandler::onTransportBytesWritten(qint64 bytes)
+{
+    onBytesWritten(bytes);
+}
+
+void ClientHandler::onTransportClosed()
+{
+    onDisconnected();
+}
+
 void ClientHandler::onReadyRead()
 {
-    QByteArray data = _socket->readAll();
-    _bytesReceived += data.size();
+    // 直接读入池化的块，避免每次readyRead都分配新的QByteArray
+    qint64 bytesRead = _receiveBuffer.readFrom(_socket, _socket->bytesAvailable());
+    if (bytesRead <= 0) {
+        return;
+    }
+    
+    _bytesReceived += bytesRead;
     updateLastActivity();
     
-    _receiveBuffer.append(data);
-    processReceivedData(_receiveBuffer);
+    processReceivedData();
 }
 
 void ClientHandler::onSocketError(QAbstractSocket::SocketError error)
@@ -350,29 +758,29 @@ void ClientHandler::onSslErrors(const QList<QSslError> &errors)
 
 void ClientHandler::onProtocolUserLoggedIn(qint64 userId, const QString &clientId, const QString &sessionToken)
 {
-    Q_UNUSED(clientId)
     Q_UNUSED(sessionToken)
+    
+    // 所有发起过认证的处理器都连接了该信号，并发登录时只处理属于本连接的
+    if (clientId != _clientId) {
+        return;
+    }
+    
     _userId = userId;
     setState(Authenticated);
     emit authenticated(userId);
 }
 
-void ClientHandler::processReceivedData(const QByteArray &data)
+void ClientHandler::processReceivedData()
 {
     // Processing received data
-    LOG_INFO(QString("Client: %1, Received data size: %2 bytes").arg(_clientId).arg(data.size()));
-    
-    // 将新数据添加到接收缓冲区
-    _receiveBuffer.append(data);
+    LOG_INFO(QString("Client: %1, Buffered data size: %2 bytes").arg(_clientId).arg(_receiveBuffer.size()));
     
     // 处理缓冲区中的所有完整消息
     while (_receiveBuffer.size() >= 4) {
-        // 读取消息长度（前4字节）
-        QDataStream stream(_receiveBuffer);
-        stream.setByteOrder(QDataStream::BigEndian);
-        
-        quint32 messageLength;
-        stream >> messageLength;
+        // 读取消息长度（前4字节，大端）
+        uchar header[4];
+        _receiveBuffer.peek(reinterpret_cast<char*>(header), 0, 4);
+        quint32 messageLength = qFromBigEndian<quint32>(header);
         
         LOG_INFO(QString("Message length: %1 bytes, Buffer size: %2 bytes").arg(messageLength).arg(_receiveBuffer.size()));
         
@@ -387,7 +795,7 @@ void ClientHandler::processReceivedData(const QByteArray &data)
         
         if (messageLength == 0) {
             LOG_ERROR("Invalid message length: 0, removing header");
-            _receiveBuffer.remove(0, 4);
+            _receiveBuffer.discard(4);
             continue;
         }
         
@@ -405,51 +813,76 @@ void ClientHandler::processReceivedData(const QByteArray &data)
             break; // 等待更多数据
         }
         
-        // 提取消息数据
-        QByteArray messageData = _receiveBuffer.mid(4, messageLength);
-        _receiveBuffer.remove(0, 4 + messageLength);
+        LOG_INFO(QString("Extracted message data: %1 bytes").arg(messageLength));
+        FlightRecorder::record(FlightRecorder::FrameIn, reinterpret_cast<quintptr>(this), messageLength);
         
-        LOG_INFO(QString("Extracted message data: %1 bytes").arg(messageData.size()));
+        // 消息位于同一块内时直接在块上扫描和解析，不复制；结果不引用原始数据，随后即可归还块
+        QByteArray payload = _receiveBuffer.view(4, messageLength);
         
-        // 解析JSON消息
-        QJsonParseError parseError;
-        QJsonDocument doc = QJsonDocument::fromJson(messageData, &parseError);
+        // 快速扫描只取路由字段，不构建DOM；扫描失败时由完整解析给出错误
+        InboundScanner::Result scanned;
+        bool scannedOk = s_inboundFastPath
+                         && InboundScanner::scan(payload.constData(), payload.size(), &scanned);
+        QString action;
+        QString requestId;
+        QJsonObject message;
         
-        if (parseError.error != QJsonParseError::NoError) {
-            LOG_WARNING(QString("Invalid JSON from client %1: %2").arg(_clientId).arg(parseError.errorString()));
-            sendErrorResponse("", "Invalid JSON format");
-            continue;
-        }
-        
-        if (!doc.isObject()) {
-            LOG_WARNING(QString("Non-object JSON from client %1").arg(_clientId));
-            sendErrorResponse("", "JSON must be an object");
-            continue;
+        if (scannedOk) {
+            const char *data = payload.constData();
+            action = InboundScanner::stringValue(data, scanned.value(InboundScanner::Action));
+            requestId = InboundScanner::stringValue(data, scanned.value(InboundScanner::RequestId));
+            
+            // 心跳处理只用到路由字段，已认证连接上直接由扫描结果构造消息
+            if (action == "heartbeat" && isAuthenticated()) {
+                message["action"] = action;
+                message["request_id"] = requestId;
+                message["client_id"] = InboundScanner::stringValue(data, scanned.value(InboundScanner::ClientId));
+                message["user_id"] = InboundScanner::integerValue(data, scanned.value(InboundScanner::UserId));
+                if (scanned.value(InboundScanner::DeadlineMs).type != InboundScanner::Value::Missing) {
+                    message["deadline_ms"] = InboundScanner::integerValue(data, scanned.value(InboundScanner::DeadlineMs));
+                }
+                InboundScanner::recordFastPath();
+            }
         }
         
-        QJsonObject message = doc.object();
-        QString action = message["action"].toString();
-        QString requestId = message["request_id"].toString();
-        
-        LOG_INFO(QString("Parsed message - Action: %1, RequestID: %2").arg(action).arg(requestId));
-        
-        // 检查是否为重复消息（仅对非心跳消息进行检查）
-        if (action != "heartbeat" && !requestId.isEmpty()) {
-            static QSet<QString> processedRequests;
-            static QMutex processedRequestsMutex;
+        if (message.isEmpty()) {
+            QJsonParseError parseError;
+            QJsonDocument doc = QJsonDocument::fromJson(payload, &parseError);
+            InboundScanner::recordFullParse();
+            
+            if (parseError.error != QJsonParseError::NoError) {
+                _receiveBuffer.discard(4 + messageLength);
+                LOG_WARNING(QString("Invalid JSON from client %1: %2").arg(_clientId).arg(parseError.errorString()));
+                sendErrorResponse("", "Invalid JSON format");
+                continue;
+            }
             
-            QMutexLocker locker(&processedRequestsMutex);
-            if (processedRequests.contains(requestId)) {
-                LOG_WARNING(QString("Duplicate message detected, skipping: %1").arg(requestId));
+            if (!doc.isObject()) {
+                _receiveBuffer.discard(4 + messageLength);
+                LOG_WARNING(QString("Non-object JSON from client %1").arg(_clientId));
+                sendErrorResponse("", "JSON must be an object");
                 continue;
             }
-            processedRequests.insert(requestId);
             
-            // 限制已处理请求的数量，防止内存泄漏
-            if (processedRequests.size() > 1000) {
-                processedRequests.clear();
+            message = doc.object();
+            if (!scannedOk) {
+                action = message["action"].toString();
+                requestId = message["request_id"].toString();
+            }
+            
+            // 完整解析通过后才登记request_id，格式错误的帧不会让之后的合法重试被当作重复丢弃
+            if (isDuplicateRequest(action, requestId)) {
+                _receiveBuffer.discard(4 + messageLength);
+                continue;
             }
         }
+        payload.clear();
+        _receiveBuffer.discard(4 + messageLength);
+        
+        LOG_INFO(QString("Parsed message - Action: %1, RequestID: %2").arg(action).arg(requestId));
+        
+        // 每条入站消息作为一个追踪根，追踪ID复用request_id
+        TRACE_REQUEST("ClientHandler::processReceivedData", requestId);
         
         _messagesReceived++;
         
@@ -459,14 +892,42 @@ void ClientHandler::processReceivedData(const QByteArray &data)
     // Data processing completed
 }
 
+bool ClientHandler::isDuplicateRequest(const QString &action, const QString &requestId)
+{
+    // 检查是否为重复消息（仅对非心跳消息进行检查）
+    if (action == "heartbeat" || requestId.isEmpty()) {
+        return false;
+    }
+    
+    QMutexLocker locker(&s_processedRequestsMutex);
+    if (s_processedRequests.contains(requestId)) {
+        LOG_WARNING(QString("Duplicate message detected, skipping: %1").arg(requestId));
+        return true;
+    }
+    s_processedRequests.insert(requestId);
+    
+    // 限制已处理请求的数量，防止内存泄漏
+    if (s_processedRequests.size() > MAX_PROCESSED_REQUESTS) {
+        s_processedRequests.clear();
+    }
+    return false;
+}
+
 void ClientHandler::processMessage(const QJsonObject &message)
 {
     QString action = message["action"].toString();
+    EventLoopActionScope actionScope(action);
     QString requestId = message["request_id"].toString();
     
     // Processing message
     LOG_INFO(QString("Action: %1, RequestID: %2, ClientState: %3").arg(action).arg(requestId).arg(static_cast<int>(_state)));
 
+    // 取消本连接上的请求，认证前后都可用
+    if (action == "cancel") {
+        handleCancelRequest(message);
+        return;
+    }
+
     // 处理认证消息（包括可用性检查）
     if (action == "login" || action == "register" || action == "send_verification_code" || 
         action == "check_username" || action == "check_email") {
@@ -513,18 +974,77 @@ void ClientHandler::handleAuthRequest(const QJsonObject &message)
     connect(_protocolHandler, &ProtocolHandler::userLoggedIn,
             this, &ClientHandler::onProtocolUserLoggedIn, Qt::UniqueConnection);
 
-    // 处理消息并获取响应
-    QJsonObject response = _protocolHandler->handleMessage(message, _clientId, peerAddress().toString());
-
-    // 发送响应
-    sendMessage(response);
-
-    // 如果认证失败，重置状态
-    if (!response["success"].toBool()) {
+    // 认证请求（密码哈希、数据库查询）在执行器中处理，按连接串行；
+    // 登录成功信号先于响应回到本线程，发送响应时状态已更新
+    ProtocolHandler *protocolHandler = _protocolHandler;
+    QString clientId = _clientId;
+    QString clientIP = peerAddress().toString();
+    QString requestId = message["request_id"].toString();
+    RequestTokenPtr token = RequestCancellation::instance()->begin(_clientId, requestId,
+                                                                   message["deadline_ms"].toVariant().toLongLong());
+    QString action = message["action"].toString();
+    RequestExecutor::Stage stage = RequestExecutor::stageForAction(action);
+    if (token) {
+        token->setReadOnly(stage == RequestExecutor::ReadHeavyStage);
+    }
+    Tracer::Context traceContext = Tracer::currentContext();
+    bool accepted = RequestExecutor::instance()->submit(stage, RequestExecutor::connectionKey(_clientId), this,
+        [protocolHandler, message, clientId, clientIP, token, traceContext, action]() {
+            if (token && token->shouldAbort()) {
+                RequestCancellation::instance()->recordDrop(token, RequestCancellation::BeforeExecution);
+                return QJsonObject();
+            }
+            TRACE_CONTINUE("RequestExecutor::execute", traceContext);
+            EventLoopActionScope actionScope(action);
+            RequestCancellation::Scope scope(token);
+            return protocolHandler->handleMessage(message, clientId, clientIP);
+        },
+        [this, requestId, token](const QJsonObject &response) {
+            RequestCancellation::instance()->finish(token);
+            
+            // 未执行的认证请求不发送响应；已执行的总是发送，登录可能已改变连接状态
+            if (response.isEmpty() && token && token->shouldAbort()) {
+                if (_state == Authenticating) {
+                    setState(Connected);
+                }
+                return;
+            }
+            
+            if (response.isEmpty()) {
+                sendErrorResponse(requestId, "Internal server error");
+            } else {
+                sendMessage(response, OutboundLanes::ControlLane);
+            }
+            
+            // 如果认证失败，重置状态
+            if (!response["success"].toBool() && _state == Authenticating) {
+                setState(Connected);
+            }
+        });
+    
+    if (!accepted) {
+        RequestCancellation::instance()->finish(token);
+        sendErrorResponse(requestId, "Server busy");
         setState(Connected);
     }
 }
 
+void ClientHandler::handleCancelRequest(const QJsonObject &message)
+{
+    QString targetRequestId = message["target_request_id"].toString();
+    bool cancelled = !targetRequestId.isEmpty()
+                     && RequestCancellation::instance()->cancel(_clientId, targetRequestId);
+
+    QJsonObject response;
+    response["request_id"] = message["request_id"].toString();
+    response["action"] = "cancel_response";
+    response["success"] = cancelled;
+    response["target_request_id"] = targetRequestId;
+    response["timestamp"] = QDateTime::currentSecsSinceEpoch();
+
+    sendMessage(response, OutboundLanes::ControlLane);
+}
+
 void ClientHandler::sendAuthResponse(bool success, const QString &message, const QJsonObject &userData)
 {
     QJsonObject response;
@@ -537,7 +1057,7 @@ void ClientHandler::sendAuthResponse(bool success, const QString &message, const
         response["user_data"] = userData;
     }
 
-    sendMessage(response);
+    sendMessage(response, OutboundLanes::ControlLane);
 }
 
 void ClientHandler::sendErrorResponse(const QString &requestId, const QString &error)
@@ -549,7 +1069,7 @@ void ClientHandler::sendErrorResponse(const QString &requestId, const QString &e
     response["error"] = error;
     response["timestamp"] = QDateTime::currentSecsSinceEpoch();
 
-    sendMessage(response);
+    sendMessage(response, OutboundLanes::ControlLane);
 }
 
 void ClientHandler::updateLastActivity()
@@ -581,6 +1101,21 @@ void ClientHandler::startProcessing()
         return;
     }
     
+    // io_uring连接：把描述符交给传输，之后的收发都在传输所在线程完成
+    if (_usesIoUring) {
+        _transportId = s_ioUring->open(_transportDescriptor, this);
+        if (_transportId == 0) {
+            LOG_ERROR(QString("Failed to open io_uring transport for client %1").arg(_clientId));
+            setState(Error);
+            return;
+        }
+        _transportDescriptor = -1;
+        
+        setState(Connected);
+        emit connected();
+        return;
+    }
+    
     // 检查套接字状态
     if (!_socket || _socket->state() != QAbstractSocket::ConnectedState) {
         LOG_ERROR(QString("Socket not connected for client %1").arg(_clientId));
@@ -649,3 +1184,41 @@ bool ClientHandler::isAuthenticated() const
 {
     return _state == Authenticated;
 }
+
+int ClientHandler::saveDedupWarmState(QDataStream &out)
+{
+    QMutexLocker locker(&s_processedRequestsMutex);
+    
+    out << static_cast<quint32>(s_processedRequests.size());
+    for (const QString &requestId : s_processedRequests) {
+        out << requestId;
+    }
+    
+    return s_processedRequests.size();
+}
+
+int ClientHandler::restoreDedupWarmState(QDataStream &in, qint64 savedAtSecs)
+{
+    // 集合不记录时间，只在短暂重启后恢复，用于拦截客户端重连后的重发
+    if (QDateTime::currentSecsSinceEpoch() - savedAtSecs > DEDUP_RESTORE_WINDOW_SECONDS) {
+        return 0;
+    }
+    
+    QMutexLocker locker(&s_processedRequestsMutex);
+    
+    quint32 count = 0;
+    in >> count;
+    
+    int restored = 0;
+    for (quint32 i = 0; i < count && in.status() == QDataStream::Ok; ++i) {
+        QString requestId;
+        in >> requestId;
+        if (in.status() == QDataStream::Ok && !requestId.isEmpty()
+            && s_processedRequests.size() < MAX_PROCESSED_REQUESTS) {
+            s_processedRequests.insert(requestId);
+            restored++;
+        }
+    }
+    
+    return restored;
+}
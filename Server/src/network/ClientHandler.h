@@ -8,6 +8,17 @@
 #include <QJsonDocument>
 #include <QDateTime>
 #include <QHostAddress>
+#include <QSet>
+#include <QMutex>
+#include <QDataStream>
+#include <QElapsedTimer>
+#include <QAtomicInt>
+#include "EncodedFrame.h"
+#include "FrameReceipt.h"
+#include "OutboundLanes.h"
+#include "ChainedBuffer.h"
+#include "ConnectionHibernator.h"
+#include "IoUringTransport.h"
 
 // 前向声明
 class ProtocolHandler;
@@ -17,8 +28,11 @@ class ProtocolHandler;
  * 
  * 负责处理单个客户端的连接、认证、消息收发等功能。
  * 支持TLS加密通信和心跳检测机制。
+ * 出站帧在套接字写缓冲区积压时进入优先级通道排队，持续积压的慢消费者会被断开。
+ * 启用io_uring传输时明文连接不创建Qt套接字，收发由IoUringTransport完成。
+ * 启用内核TLS时握手在构造时（工作线程）完成，之后按明文连接处理，记录层由内核加解密。
  */
-class ClientHandler : public QObject
+class ClientHandler : public QObject, public IoUringTransport::Receiver
 {
     Q_OBJECT
 
@@ -32,7 +46,8 @@ public:
         Authenticating, // 正在认证
         Authenticated,  // 已认证
         Disconnected,   // 已断开
-        Error          // 错误状态
+        Error,          // 错误状态
+        Hibernated      // 套接字已转入休眠表，等待销毁
     };
     Q_ENUM(ClientState)
 
@@ -96,9 +111,42 @@ public:
     /**
      * @brief 发送JSON消息
      * @param message JSON消息
+     * @param lane 出站通道
      * @return 发送是否成功
      */
-    bool sendMessage(const QJsonObject &message);
+    bool sendMessage(const QJsonObject &message, OutboundLanes::Lane lane = OutboundLanes::ChatLane);
+    
+    /**
+     * @brief 发送预编码的消息帧
+     * 
+     * 写缓冲区低于水位线且没有积压时直接写入套接字，否则进入对应通道排队。
+     * 可在任意线程调用，不在处理器所在线程时转到该线程发送：连接已断开时返回false，
+     * 否则返回true，但只表示已投递到处理器线程，并不确认帧已写出或排队。
+     * @param frame 已编码的帧（可被多个客户端共享）
+     * @param lane 出站通道
+     * @param coalesceKey 批量通道合并键（如状态变化的好友ID），<0表示不合并
+     * @return 发送（或排队）是否成功
+     */
+    bool sendFrame(const EncodedFrame &frame, OutboundLanes::Lane lane = OutboundLanes::ChatLane,
+                   qint64 coalesceKey = -1);
+    
+    /**
+     * @brief 从其他线程发送帧并取得回执
+     * 
+     * 帧投递到处理器所在线程调用sendFrame，回执给出其真实结果；处理器在执行前销毁时结果为失败。
+     * @param frame 已编码的帧
+     * @param lane 出站通道
+     * @return 回执，调用者释放其他锁后等待
+     */
+    QSharedPointer<FrameReceipt> postFrame(const EncodedFrame &frame,
+                                           OutboundLanes::Lane lane = OutboundLanes::ChatLane);
+    
+    /**
+     * @brief 发送错误响应
+     * @param requestId 请求ID
+     * @param error 错误信息
+     */
+    void sendErrorResponse(const QString &requestId, const QString &error);
     
     /**
      * @brief 断开连接
@@ -126,6 +174,52 @@ public:
      */
     bool isHeartbeatTimeout() const;
     
+    /**
+     * @brief 检查慢消费者状态
+     * 
+     * 写缓冲区与排队字节之和超过硬上限（或控制/聊天通道超出预算）持续超过超时时间时断开连接。
+     * 发送和写完成时会自动检查，服务器健康检查时也会调用。
+     */
+    void checkSlowConsumer();
+    
+    /**
+     * @brief 当前连接持有的缓冲区字节数（接收块、出站排队、套接字读写缓冲区）
+     */
+    qint64 bufferedBytes() const;
+    
+    /**
+     * @brief 接收缓冲区持有的块字节数
+     */
+    qint64 receiveBufferCapacity() const { return _receiveBuffer.capacity(); }
+    
+    /**
+     * @brief 空闲时归还接收缓冲区保留的块
+     */
+    void shrinkIdleBuffers();
+    
+    /**
+     * @brief 检查连接是否可以休眠
+     * 
+     * 仅已认证的明文或内核TLS连接、空闲超过指定时长且收发缓冲区都为空时可以休眠。
+     * @param idleMs 空闲时长阈值（毫秒）
+     */
+    bool canHibernate(qint64 idleMs) const;
+    
+    /**
+     * @brief 将连接状态打包并交出套接字描述符
+     * 
+     * 成功后套接字对象不再持有连接，处理器进入Hibernated状态且不会发出disconnected信号，
+     * 调用者负责销毁处理器。
+     * @param connection 输出的休眠记录
+     * @return 是否成功
+     */
+    bool detachForHibernation(ConnectionHibernator::HibernatedConnection *connection);
+    
+    /**
+     * @brief 由休眠记录恢复连接状态（客户端ID、用户、统计信息）
+     */
+    void restoreFromHibernation(const ConnectionHibernator::HibernatedConnection &connection);
+    
     /**
      * @brief 获取客户端信息
      * @return 客户端信息JSON对象
@@ -142,6 +236,46 @@ public:
     Q_INVOKABLE void emitDisconnected();
     Q_INVOKABLE void emitAuthenticated(qint64 userId);
     Q_INVOKABLE void emitMessageReceived(const QJsonObject &message);
+    
+    // 请求去重集合的热状态快照
+    static const quint32 DEDUP_WARM_STATE_VERSION = 1;
+    
+    /**
+     * @brief 写出已处理请求ID集合
+     * @return 写出的条目数
+     */
+    static int saveDedupWarmState(QDataStream &out);
+    
+    /**
+     * @brief 恢复已处理请求ID集合，快照过旧时不恢复
+     * @return 恢复的条目数
+     */
+    static int restoreDedupWarmState(QDataStream &in, qint64 savedAtSecs);
+    
+    /**
+     * @brief 设置出站通道配置（对所有连接生效）
+     */
+    static void setOutboundConfig(const OutboundLanes::Config &config);
+    
+    /**
+     * @brief 获取所有连接累计的出站排队统计
+     */
+    static QJsonObject getOutboundStatistics();
+    
+    /**
+     * @brief 设置套接字读缓冲区上限（对之后创建的连接生效），0表示不限制
+     */
+    static void setSocketReadBufferSize(qint64 size);
+    
+    /**
+     * @brief 设置明文连接使用的io_uring传输（对之后创建的连接生效），nullptr表示使用Qt套接字
+     */
+    static void setIoUringTransport(IoUringTransport *transport);
+    
+    /**
+     * @brief 启用入站快速扫描：路由字段不经DOM提取，已认证连接的心跳不解析整条消息
+     */
+    static void setInboundFastPath(bool enabled);
 
 signals:
     /**
@@ -176,16 +310,22 @@ private slots:
     void onConnected();
     void onDisconnected();
     void onReadyRead();
+    void onBytesWritten(qint64 bytes);
     void onSocketError(QAbstractSocket::SocketError error);
     void onSslErrors(const QList<QSslError> &errors);
     void onProtocolUserLoggedIn(qint64 userId, const QString &clientId, const QString &sessionToken);
 
+private:
+    // IoUringTransport::Receiver
+    void onTransportData(const char *data, qint64 length) override;
+    void onTransportBytesWritten(qint64 bytes) override;
+    void onTransportClosed() override;
+
 private:
     /**
-     * @brief 处理接收到的数据
-     * @param data 数据
+     * @brief 处理接收缓冲区中的所有完整消息
      */
-    void processReceivedData(const QByteArray &data);
+    void processReceivedData();
     
     /**
      * @brief 处理JSON消息
@@ -193,12 +333,24 @@ private:
      */
     void processMessage(const QJsonObject &message);
     
+    /**
+     * @brief 检查并登记请求ID（跨连接去重，心跳和空ID不参与），只在消息完整解析成功后调用
+     * @return 请求ID已处理过时返回true
+     */
+    bool isDuplicateRequest(const QString &action, const QString &requestId);
+    
     /**
      * @brief 处理认证请求
      * @param message 认证消息
      */
     void handleAuthRequest(const QJsonObject &message);
     
+    /**
+     * @brief 处理取消请求，取消本连接上target_request_id对应的请求
+     * @param message 取消消息
+     */
+    void handleCancelRequest(const QJsonObject &message);
+    
     /**
      * @brief 处理心跳消息
      * @param message 心跳消息
@@ -212,13 +364,16 @@ private:
      * @param userData 用户数据
      */
     void sendAuthResponse(bool success, const QString &message, const QJsonObject &userData);
-
+    
     /**
-     * @brief 发送错误响应
-     * @param requestId 请求ID
-     * @param error 错误信息
+     * @brief 将帧直接写入套接字
      */
-    void sendErrorResponse(const QString &requestId, const QString &error);
+    bool writeFrameNow(const EncodedFrame &frame);
+    
+    /**
+     * @brief 写缓冲区低于水位线时按优先级补写排队的帧
+     */
+    void pumpOutbound();
     
     /**
      * @brief 更新最后活动时间
@@ -236,6 +391,11 @@ private:
      * @return 唯一客户端ID
      */
     QString generateClientId();
+    
+    /**
+     * @brief 已写入但尚未被内核接收的字节数
+     */
+    qint64 pendingWriteBytes() const;
 
 private:
     QAbstractSocket* _socket;
@@ -248,9 +408,10 @@ private:
     QDateTime _lastActivity;
     int _heartbeatTimeout;
     
-    QByteArray _receiveBuffer;
+    ChainedBuffer _receiveBuffer;
     
     bool _useTLS;
+    bool _kernelTls;                     // TLS记录层已卸载到内核
     QString _certFile;
     QString _keyFile;
     
@@ -260,7 +421,33 @@ private:
     qint64 _bytesReceived;
     qint64 _bytesSent;
     
+    // 出站通道
+    OutboundLanes _outbound;
+    QElapsedTimer _overLimitTimer;       // 开始超限的时刻，未超限时无效
+    bool _slowConsumerDisconnecting;
+    
+    // io_uring传输
+    bool _usesIoUring;
+    qintptr _transportDescriptor;        // 尚未交给传输的描述符，交出后为-1
+    quint32 _transportId;                // 传输中的连接ID，0表示未打开或已关闭
+    QHostAddress _transportPeerAddress;
+    
     static int s_clientCounter;
+    
+    static OutboundLanes::Config s_outboundConfig;
+    static qint64 s_socketReadBufferSize;
+    static IoUringTransport* s_ioUring;
+    static bool s_inboundFastPath;
+    static QAtomicInt s_framesQueued;
+    static QAtomicInt s_framesCoalesced;
+    static QAtomicInt s_framesDropped;
+    static QAtomicInt s_slowConsumerDisconnects;
+    
+    // 已处理请求ID集合（跨连接去重）
+    static QSet<QString> s_processedRequests;
+    static QMutex s_processedRequestsMutex;
+    static const int MAX_PROCESSED_REQUESTS = 1000;
+    static const int DEDUP_RESTORE_WINDOW_SECONDS = 300;
 };
 
 #endif // CLIENTHANDLER_H
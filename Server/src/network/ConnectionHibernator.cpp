@@ -0,0 +1,390 @@
+#include "ConnectionHibernator.h"
+#include "EncodedFrame.h"
+#include "../utils/Logger.h"
+#include <QSocketNotifier>
+#include <QTimer>
+#include <QDateTime>
+#include <QHostAddress>
+#include <QJsonDocument>
+#include <QtEndian>
+
+#ifdef Q_OS_LINUX
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <unistd.h>
+#include <cerrno>
+#endif
+
+namespace {
+
+// 休眠状态下只处理能一次读完的小帧，心跳帧远小于该值
+const int MAX_PEEK_SIZE = 2048;
+
+} // namespace
+
+ConnectionHibernator::ConnectionHibernator(QObject *parent)
+    : QObject(parent)
+    , _epollFd(-1)
+    , _notifier(nullptr)
+    , _sweepTimer(nullptr)
+    , _totalHibernated(0)
+    , _totalWoken(0)
+    , _totalExpired(0)
+    , _heartbeatsAnswered(0)
+{
+}
+
+ConnectionHibernator::~ConnectionHibernator()
+{
+    shutdown();
+}
+
+bool ConnectionHibernator::isSupported()
+{
+#ifdef Q_OS_LINUX
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool ConnectionHibernator::initialize(const HibernationConfig &config, const MessageHandler &heartbeatHandler)
+{
+    _config = config;
+    _heartbeatHandler = heartbeatHandler;
+
+    if (!_config.enabled) {
+        LOG_INFO("Connection hibernation disabled");
+        return false;
+    }
+
+    if (!isSupported()) {
+        LOG_WARNING("Connection hibernation is not supported on this platform");
+        return false;
+    }
+
+#ifdef Q_OS_LINUX
+    if (_epollFd >= 0) {
+        return true;
+    }
+
+    _epollFd = epoll_create1(EPOLL_CLOEXEC);
+    if (_epollFd < 0) {
+        LOG_ERROR(QString("Failed to create epoll descriptor for hibernation: errno %1").arg(errno));
+        return false;
+    }
+
+    // 所有休眠连接共用一个epoll描述符，事件循环只需监听这一个描述符
+    _notifier = new QSocketNotifier(_epollFd, QSocketNotifier::Read, this);
+    connect(_notifier, &QSocketNotifier::activated, this, &ConnectionHibernator::onReadable);
+
+    _sweepTimer = new QTimer(this);
+    connect(_sweepTimer, &QTimer::timeout, this, &ConnectionHibernator::onSweep);
+    _sweepTimer->start(qMax(1000, _config.sweepIntervalMs));
+
+    LOG_INFO(QString("Connection hibernation enabled: idle=%1s").arg(_config.idleSeconds));
+    return true;
+#else
+    return false;
+#endif
+}
+
+void ConnectionHibernator::shutdown()
+{
+    if (_sweepTimer) {
+        _sweepTimer->stop();
+    }
+    if (_notifier) {
+        _notifier->setEnabled(false);
+        _notifier->deleteLater();
+        _notifier = nullptr;
+    }
+
+#ifdef Q_OS_LINUX
+    QMutexLocker locker(&_mutex);
+    for (const HibernatedConnection &connection : _table) {
+        ::close(connection.socketDescriptor);
+    }
+    _table.clear();
+    _slotByFd.clear();
+    _slotByUser.clear();
+
+    if (_epollFd >= 0) {
+        ::close(_epollFd);
+        _epollFd = -1;
+    }
+#endif
+}
+
+bool ConnectionHibernator::hibernate(const HibernatedConnection &connection)
+{
+#ifdef Q_OS_LINUX
+    if (_epollFd < 0 || connection.socketDescriptor < 0 || connection.userId <= 0) {
+        return false;
+    }
+
+    QMutexLocker locker(&_mutex);
+
+    if (_slotByUser.contains(connection.userId)) {
+        return false;
+    }
+
+    epoll_event event = {};
+    event.events = EPOLLIN | EPOLLRDHUP;
+    event.data.fd = connection.socketDescriptor;
+    if (epoll_ctl(_epollFd, EPOLL_CTL_ADD, connection.socketDescriptor, &event) != 0) {
+        LOG_WARNING(QString("Failed to watch hibernated connection of user %1: errno %2")
+                    .arg(connection.userId).arg(errno));
+        return false;
+    }
+
+    if (_slotByFd.size() <= connection.socketDescriptor) {
+        int oldSize = _slotByFd.size();
+        _slotByFd.resize(connection.socketDescriptor + 1);
+        for (int i = oldSize; i < _slotByFd.size(); ++i) {
+            _slotByFd[i] = -1;
+        }
+    }
+
+    qint32 slot = _table.size();
+    _table.append(connection);
+    _slotByFd[connection.socketDescriptor] = slot;
+    _slotByUser.insert(connection.userId, slot);
+    ++_totalHibernated;
+    return true;
+#else
+    Q_UNUSED(connection)
+    return false;
+#endif
+}
+
+bool ConnectionHibernator::isHibernated(qint64 userId) const
+{
+    QMutexLocker locker(&_mutex);
+    return _slotByUser.contains(userId);
+}
+
+QList<qint64> ConnectionHibernator::hibernatedUserIds() const
+{
+    QMutexLocker locker(&_mutex);
+    return _slotByUser.keys();
+}
+
+bool ConnectionHibernator::take(qint64 userId, HibernatedConnection *connection)
+{
+    QMutexLocker locker(&_mutex);
+
+    auto it = _slotByUser.constFind(userId);
+    if (it == _slotByUser.constEnd()) {
+        return false;
+    }
+
+    HibernatedConnection removed = removeAtLocked(it.value());
+    ++_totalWoken;
+    if (connection) {
+        *connection = removed;
+    }
+    return true;
+}
+
+QList<ConnectionHibernator::HibernatedConnection> ConnectionHibernator::takeAll()
+{
+    QMutexLocker locker(&_mutex);
+
+    QList<HibernatedConnection> connections;
+    while (!_table.isEmpty()) {
+        connections.append(removeAtLocked(_table.size() - 1));
+        ++_totalWoken;
+    }
+    return connections;
+}
+
+int ConnectionHibernator::count() const
+{
+    QMutexLocker locker(&_mutex);
+    return _table.size();
+}
+
+ConnectionHibernator::HibernatedConnection ConnectionHibernator::removeAtLocked(int index)
+{
+    HibernatedConnection removed = _table.at(index);
+
+#ifdef Q_OS_LINUX
+    epoll_ctl(_epollFd, EPOLL_CTL_DEL, removed.socketDescriptor, nullptr);
+#endif
+
+    // 与末尾记录交换后删除，保持数组紧凑
+    int last = _table.size() - 1;
+    if (index != last) {
+        _table[index] = _table.at(last);
+        _slotByFd[_table.at(index).socketDescriptor] = index;
+        _slotByUser[_table.at(index).userId] = index;
+    }
+    _table.removeLast();
+    _slotByFd[removed.socketDescriptor] = -1;
+    _slotByUser.remove(removed.userId);
+
+    return removed;
+}
+
+QString ConnectionHibernator::clientIdOf(const HibernatedConnection &connection)
+{
+    return QString("client_%1_%2").arg(connection.clientIdMs).arg(connection.clientSerial);
+}
+
+void ConnectionHibernator::onReadable()
+{
+#ifdef Q_OS_LINUX
+    epoll_event events[64];
+    QList<HibernatedConnection> woken;
+
+    forever {
+        int ready = epoll_wait(_epollFd, events, 64, 0);
+        if (ready <= 0) {
+            break;
+        }
+
+        for (int i = 0; i < ready; ++i) {
+            int fd = events[i].data.fd;
+            HibernatedConnection connection;
+            {
+                QMutexLocker locker(&_mutex);
+                if (fd < 0 || fd >= _slotByFd.size() || _slotByFd[fd] < 0) {
+                    continue;
+                }
+                connection = _table.at(_slotByFd[fd]);
+            }
+
+            // 心跳处理可能触发状态广播并访问休眠表，因此在锁外执行
+            bool hangup = events[i].events & (EPOLLRDHUP | EPOLLHUP | EPOLLERR);
+            bool answered = !hangup && answerHeartbeat(connection);
+
+            QMutexLocker locker(&_mutex);
+            int slot = fd < _slotByFd.size() ? _slotByFd[fd] : -1;
+            if (slot < 0 || _table.at(slot).userId != connection.userId) {
+                continue;   // 处理期间已被取走
+            }
+
+            if (answered) {
+                _table[slot] = connection;
+                ++_heartbeatsAnswered;
+            } else {
+                woken.append(removeAtLocked(slot));
+                ++_totalWoken;
+            }
+        }
+
+        if (ready < 64) {
+            break;
+        }
+    }
+
+    // 在锁外通知服务器重建连接，重建后由新的套接字对象读取待处理的数据或关闭事件
+    for (const HibernatedConnection &connection : woken) {
+        emit wakeRequested(connection);
+    }
+#endif
+}
+
+bool ConnectionHibernator::answerHeartbeat(HibernatedConnection &connection)
+{
+#ifdef Q_OS_LINUX
+    if (!_heartbeatHandler) {
+        return false;
+    }
+
+    int fd = connection.socketDescriptor;
+    char buffer[MAX_PEEK_SIZE];
+    ssize_t peeked = ::recv(fd, buffer, sizeof(buffer), MSG_PEEK | MSG_DONTWAIT);
+    if (peeked < EncodedFrame::HEADER_SIZE) {
+        return false;
+    }
+
+    // 只处理恰好一条完整帧的情况，半帧或多帧交给重建后的连接处理
+    quint32 length = qFromBigEndian<quint32>(reinterpret_cast<const uchar*>(buffer));
+    if (length == 0 || EncodedFrame::HEADER_SIZE + static_cast<qint64>(length) != peeked) {
+        return false;
+    }
+
+    QJsonParseError parseError;
+    QJsonDocument doc = QJsonDocument::fromJson(
+        QByteArray::fromRawData(buffer + EncodedFrame::HEADER_SIZE, static_cast<int>(length)), &parseError);
+    if (parseError.error != QJsonParseError::NoError || !doc.isObject()
+        || doc.object().value("action").toString() != "heartbeat") {
+        return false;
+    }
+
+    sockaddr_storage address = {};
+    socklen_t addressLength = sizeof(address);
+    QString clientIP;
+    if (::getpeername(fd, reinterpret_cast<sockaddr*>(&address), &addressLength) == 0) {
+        clientIP = QHostAddress(reinterpret_cast<sockaddr*>(&address)).toString();
+    }
+
+    // 读出已检查的帧后应答；空闲连接的内核发送缓冲区为空，小帧可一次写完
+    if (::recv(fd, buffer, static_cast<size_t>(peeked), MSG_DONTWAIT) != peeked) {
+        return false;
+    }
+
+    EncodedFrame response = EncodedFrame::encode(_heartbeatHandler(doc.object(), clientIdOf(connection), clientIP));
+    ssize_t sent = ::send(fd, response.data().constData(), static_cast<size_t>(response.size()),
+                          MSG_DONTWAIT | MSG_NOSIGNAL);
+    if (sent != response.size()) {
+        LOG_WARNING(QString("Failed to answer heartbeat for hibernated user %1, waking connection")
+                    .arg(connection.userId));
+        return false;
+    }
+
+    connection.lastActivityMs = QDateTime::currentMSecsSinceEpoch();
+    connection.bytesReceived += peeked;
+    connection.bytesSent += sent;
+    ++connection.messagesReceived;
+    ++connection.messagesSent;
+    return true;
+#else
+    Q_UNUSED(connection)
+    return false;
+#endif
+}
+
+void ConnectionHibernator::onSweep()
+{
+    qint64 now = QDateTime::currentMSecsSinceEpoch();
+    QList<HibernatedConnection> expired;
+
+    {
+        QMutexLocker locker(&_mutex);
+        for (int i = _table.size() - 1; i >= 0; --i) {
+            const HibernatedConnection &connection = _table.at(i);
+            if (connection.heartbeatTimeoutMs > 0
+                && now - connection.lastActivityMs > connection.heartbeatTimeoutMs) {
+                expired.append(removeAtLocked(i));
+                ++_totalExpired;
+            }
+        }
+    }
+
+    for (const HibernatedConnection &connection : expired) {
+        LOG_WARNING(QString("Hibernated connection of user %1 timed out").arg(connection.userId));
+        emit connectionExpired(connection);
+    }
+}
+
+QJsonObject ConnectionHibernator::getStatistics() const
+{
+    QMutexLocker locker(&_mutex);
+
+    QJsonObject stats;
+    stats["enabled"] = _epollFd >= 0;
+    stats["idle_seconds"] = _config.idleSeconds;
+    stats["hibernated_connections"] = _table.size();
+    stats["record_size"] = static_cast<int>(sizeof(HibernatedConnection));
+    stats["table_bytes"] = static_cast<qint64>(_table.capacity()) * static_cast<qint64>(sizeof(HibernatedConnection))
+                           + static_cast<qint64>(_slotByFd.capacity()) * static_cast<qint64>(sizeof(qint32));
+    stats["total_hibernated"] = _totalHibernated;
+    stats["total_woken"] = _totalWoken;
+    stats["total_expired"] = _totalExpired;
+    stats["heartbeats_answered"] = _heartbeatsAnswered;
+    return stats;
+}
@@ -0,0 +1,183 @@
+#ifndef CONNECTIONHIBERNATOR_H
+#define CONNECTIONHIBERNATOR_H
+
+#include <QObject>
+#include <QVector>
+#include <QHash>
+#include <QMutex>
+#include <QJsonObject>
+#include <functional>
+
+class QSocketNotifier;
+class QTimer;
+
+/**
+ * @brief 空闲连接休眠表
+ *
+ * 长时间没有活动的已认证明文连接释放整个ClientHandler（QObject、套接字对象、缓冲区、统计字段），
+ * 只把套接字描述符和少量状态保存在紧凑的结构体数组中，所有休眠连接共用一个epoll描述符等待可读事件：
+ * - 收到的数据恰好是一条心跳帧时，直接在休眠状态下应答，不唤醒连接
+ * - 其他数据、对端关闭或错误时从表中移除并发出wakeRequested，由服务器重建ClientHandler
+ * - 超过心跳超时仍无活动的连接发出connectionExpired，由服务器关闭并清理
+ *
+ * 仅在Linux上可用；QSslSocket上的TLS连接会话状态保存在套接字对象中，不能休眠，
+ * 已卸载到内核TLS的连接由内核完成加解密，与明文连接一样可以休眠。
+ */
+class ConnectionHibernator : public QObject
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @brief 休眠配置
+     */
+    struct HibernationConfig {
+        bool enabled = true;
+        int idleSeconds = 120;          // 无活动超过该时长的连接进入休眠
+        int sweepIntervalMs = 10000;    // 休眠候选与心跳超时的检查间隔
+    };
+
+    /**
+     * @brief 休眠连接记录（72字节）
+     */
+    struct HibernatedConnection {
+        qint64 userId = -1;
+        qint64 clientIdMs = 0;          // 客户端ID中的时间戳部分
+        qint64 connectTimeMs = 0;
+        qint64 lastActivityMs = 0;
+        qint64 bytesReceived = 0;
+        qint64 bytesSent = 0;
+        qint32 socketDescriptor = -1;
+        quint32 clientSerial = 0;       // 客户端ID中的序号部分
+        quint32 messagesReceived = 0;
+        quint32 messagesSent = 0;
+        qint32 heartbeatTimeoutMs = 0;
+        quint32 flags = 0;              // ConnectionFlag组合
+    };
+
+    /**
+     * @brief 休眠连接标志
+     */
+    enum ConnectionFlag : quint32 {
+        KernelTlsFlag = 0x1             // 连接已卸载到内核TLS
+    };
+
+    /**
+     * @brief 心跳处理函数：消息、客户端ID、客户端IP -> 响应
+     */
+    using MessageHandler = std::function<QJsonObject(const QJsonObject &message, const QString &clientId,
+                                                     const QString &clientIP)>;
+
+    explicit ConnectionHibernator(QObject *parent = nullptr);
+    ~ConnectionHibernator();
+
+    /**
+     * @brief 当前平台是否支持休眠
+     */
+    static bool isSupported();
+
+    /**
+     * @brief 初始化休眠表
+     * @param config 休眠配置
+     * @param heartbeatHandler 休眠状态下处理心跳的函数
+     * @return 是否启用
+     */
+    bool initialize(const HibernationConfig &config, const MessageHandler &heartbeatHandler);
+
+    /**
+     * @brief 关闭所有休眠连接
+     */
+    void shutdown();
+
+    bool isEnabled() const { return _epollFd >= 0; }
+
+    const HibernationConfig &config() const { return _config; }
+
+    /**
+     * @brief 将连接放入休眠表，成功后描述符归休眠表所有
+     */
+    bool hibernate(const HibernatedConnection &connection);
+
+    /**
+     * @brief 指定用户是否处于休眠状态
+     */
+    bool isHibernated(qint64 userId) const;
+
+    /**
+     * @brief 所有休眠连接的用户ID
+     */
+    QList<qint64> hibernatedUserIds() const;
+
+    /**
+     * @brief 取出指定用户的休眠记录，描述符所有权转交调用者
+     * @return 用户是否处于休眠状态
+     */
+    bool take(qint64 userId, HibernatedConnection *connection);
+    
+    /**
+     * @brief 取出所有休眠记录，描述符所有权转交调用者
+     */
+    QList<HibernatedConnection> takeAll();
+
+    /**
+     * @brief 休眠连接数
+     */
+    int count() const;
+
+    /**
+     * @brief 由休眠记录还原客户端ID
+     */
+    static QString clientIdOf(const HibernatedConnection &connection);
+
+    /**
+     * @brief 获取休眠统计信息
+     */
+    QJsonObject getStatistics() const;
+
+signals:
+    /**
+     * @brief 休眠连接需要唤醒（有数据、对端关闭或出错），记录已移出休眠表
+     */
+    void wakeRequested(const ConnectionHibernator::HibernatedConnection &connection);
+
+    /**
+     * @brief 休眠连接心跳超时，记录已移出休眠表
+     */
+    void connectionExpired(const ConnectionHibernator::HibernatedConnection &connection);
+
+private slots:
+    void onReadable();
+    void onSweep();
+
+private:
+    /**
+     * @brief 尝试在休眠状态下应答一条心跳帧
+     * @return 已应答时返回true，需要唤醒时返回false
+     */
+    bool answerHeartbeat(HibernatedConnection &connection);
+
+    /**
+     * @brief 移除记录（与末尾交换），调用者需持有锁
+     */
+    HibernatedConnection removeAtLocked(int index);
+
+    HibernationConfig _config;
+    MessageHandler _heartbeatHandler;
+
+    int _epollFd;
+    QSocketNotifier *_notifier;
+    QTimer *_sweepTimer;
+
+    mutable QMutex _mutex;
+    QVector<HibernatedConnection> _table;
+    QVector<qint32> _slotByFd;          // 描述符 -> 表索引，-1表示不在表中
+    QHash<qint64, qint32> _slotByUser;  // 用户ID -> 表索引
+
+    // 统计信息
+    qint64 _totalHibernated;
+    qint64 _totalWoken;
+    qint64 _totalExpired;
+    qint64 _heartbeatsAnswered;
+};
+
+#endif // CONNECTIONHIBERNATOR_H
@@ -0,0 +1,29 @@
+#include "EncodedFrame.h"
+#include <QJsonDocument>
+#include <QtEndian>
+#include <cstring>
+
+EncodedFrame::EncodedFrame(const QJsonObject &message)
+{
+    QByteArray payload = QJsonDocument(message).toJson(QJsonDocument::Compact);
+
+    // 一次分配：长度前缀和消息体写入同一块缓冲区
+    _data.resize(HEADER_SIZE + payload.size());
+    qToBigEndian<quint32>(static_cast<quint32>(payload.size()), _data.data());
+    std::memcpy(_data.data() + HEADER_SIZE, payload.constData(), payload.size());
+}
+
+EncodedFrame EncodedFrame::encode(const QJsonObject &message)
+{
+    return EncodedFrame(message);
+}
+
+EncodedFrame EncodedFrame::fromData(const QByteArray &data)
+{
+    EncodedFrame frame;
+    if (data.size() > HEADER_SIZE &&
+        qFromBigEndian<quint32>(data.constData()) == static_cast<quint32>(data.size() - HEADER_SIZE)) {
+        frame._data = data;
+    }
+    return frame;
+}
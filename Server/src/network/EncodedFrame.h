@@ -0,0 +1,70 @@
+#ifndef ENCODEDFRAME_H
+#define ENCODEDFRAME_H
+
+#include <QByteArray>
+#include <QJsonObject>
+#include <QVector>
+
+/**
+ * @brief 预编码消息帧
+ *
+ * 将JSON消息一次性序列化为线路格式（4字节大端长度前缀 + 紧凑JSON）。
+ * 内部的QByteArray是隐式共享的，同一帧投递给多个接收者时只增加引用计数，
+ * 不会重复序列化。帧一旦构建即不可修改。
+ */
+class EncodedFrame
+{
+public:
+    EncodedFrame() = default;
+
+    /**
+     * @brief 从JSON消息构建帧
+     * @param message JSON消息
+     */
+    explicit EncodedFrame(const QJsonObject &message);
+
+    /**
+     * @brief 编码JSON消息
+     * @param message JSON消息
+     * @return 编码后的帧
+     */
+    static EncodedFrame encode(const QJsonObject &message);
+
+    /**
+     * @brief 由已编码的线路数据还原帧（如集群节点转发的帧）
+     * @return 长度前缀与数据长度不一致时返回空帧
+     */
+    static EncodedFrame fromData(const QByteArray &data);
+
+    /**
+     * @brief 获取完整帧数据（包含长度前缀）
+     */
+    const QByteArray &data() const { return _data; }
+
+    /**
+     * @brief 获取帧字节数（包含长度前缀）
+     */
+    int size() const { return _data.size(); }
+
+    /**
+     * @brief 获取消息体字节数（不含长度前缀）
+     */
+    int payloadSize() const { return _data.isEmpty() ? 0 : _data.size() - HEADER_SIZE; }
+
+    /**
+     * @brief 检查帧是否为空
+     */
+    bool isEmpty() const { return _data.isEmpty(); }
+
+    static const int HEADER_SIZE = 4;
+
+private:
+    QByteArray _data;
+};
+
+/**
+ * @brief 紧凑的接收者ID列表
+ */
+using RecipientList = QVector<qint64>;
+
+#endif // ENCODEDFRAME_H
@@ -0,0 +1,75 @@
+#include "FrameReceipt.h"
+#include <QDeadlineTimer>
+#include <QMetaObject>
+#include <QMutexLocker>
+
+namespace {
+
+/**
+ * @brief 随投递的函数对象一起销毁，事件被丢弃时给出失败结果
+ */
+struct Completion
+{
+    explicit Completion(const std::function<void(bool)> &finish) : finish(finish) {}
+    ~Completion() { finish(false); }
+
+    std::function<void(bool)> finish;
+};
+
+} // namespace
+
+QSharedPointer<FrameReceipt> FrameReceipt::post(QObject *context, const std::function<bool()> &send)
+{
+    QSharedPointer<FrameReceipt> receipt(new FrameReceipt());
+    QSharedPointer<Completion> completion(new Completion([receipt](bool sent) {
+        receipt->finish(sent);
+    }));
+    
+    QMetaObject::invokeMethod(context, [receipt, completion, send]() {
+        if (receipt->claim()) {
+            receipt->finish(send());
+        }
+    }, Qt::QueuedConnection);
+    
+    return receipt;
+}
+
+bool FrameReceipt::wait(int timeoutMs)
+{
+    QMutexLocker locker(&_mutex);
+    
+    QDeadlineTimer deadline(timeoutMs);
+    while (_state == Pending && !deadline.hasExpired()) {
+        _done.wait(&_mutex, deadline);
+    }
+    if (_state == Pending) {
+        _state = Abandoned;
+        return false;
+    }
+    
+    // 发送函数已开始执行，只在处理器线程内写出或排队，等待其完成
+    while (_state == Sending) {
+        _done.wait(&_mutex);
+    }
+    return _state == Sent;
+}
+
+bool FrameReceipt::claim()
+{
+    QMutexLocker locker(&_mutex);
+    if (_state != Pending) {
+        return false;
+    }
+    _state = Sending;
+    return true;
+}
+
+void FrameReceipt::finish(bool sent)
+{
+    QMutexLocker locker(&_mutex);
+    if (_state != Pending && _state != Sending) {
+        return;
+    }
+    _state = sent ? Sent : Failed;
+    _done.wakeAll();
+}
@@ -0,0 +1,65 @@
+#ifndef FRAMERECEIPT_H
+#define FRAMERECEIPT_H
+
+#include <QObject>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QSharedPointer>
+#include <functional>
+
+/**
+ * @brief 跨线程发送的确认结果
+ *
+ * 执行器线程不能直接访问处理器的套接字，发送需要投递到处理器所在线程执行。
+ * post投递发送函数并返回回执，调用者用wait取得真实的发送结果：
+ * - 发送函数执行后结果为其返回值
+ * - 上下文对象在执行前销毁（投递的事件被丢弃）时结果为失败
+ * - 等待超时时调用者放弃，之后发送函数不会再执行，因此返回false的帧一定没有发出，
+ *   调用者可以安全地改走离线队列
+ */
+class FrameReceipt
+{
+public:
+    /**
+     * @brief 把发送函数投递到上下文对象所在线程执行
+     * @param context 上下文对象
+     * @param send 发送函数，返回是否写出或排队成功
+     * @return 回执
+     */
+    static QSharedPointer<FrameReceipt> post(QObject *context, const std::function<bool()> &send);
+
+    /**
+     * @brief 等待发送结果
+     *
+     * 不能在上下文对象所在线程调用，调用时也不能持有上下文线程可能等待的锁。
+     * @param timeoutMs 等待发送函数开始执行的最长时间（毫秒）
+     * @return 是否已发送
+     */
+    bool wait(int timeoutMs);
+
+private:
+    enum State {
+        Pending,    // 等待执行
+        Sending,    // 发送函数执行中
+        Sent,
+        Failed,
+        Abandoned   // 调用者已放弃，不再执行
+    };
+
+    /**
+     * @brief 在上下文线程中开始执行
+     * @return 调用者已放弃时返回false
+     */
+    bool claim();
+
+    /**
+     * @brief 给出发送结果，已有结果时忽略
+     */
+    void finish(bool sent);
+
+    QMutex _mutex;
+    QWaitCondition _done;
+    State _state = Pending;
+};
+
+#endif // FRAMERECEIPT_H
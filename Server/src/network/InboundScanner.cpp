@@ -0,0 +1,429 @@
+#include "InboundScanner.h"
+#include <QJsonDocument>
+#include <QJsonArray>
+#include <QtAlgorithms>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define INBOUND_SCANNER_SSE2
+#include <emmintrin.h>
+#endif
+
+// 静态成员初始化
+QAtomicInteger<qint64> InboundScanner::s_scanned(0);
+QAtomicInteger<qint64> InboundScanner::s_rejected(0);
+QAtomicInteger<qint64> InboundScanner::s_fastPath(0);
+QAtomicInteger<qint64> InboundScanner::s_fullParses(0);
+
+namespace {
+
+// 嵌套对象/数组的最大深度
+const int MAX_DEPTH = 64;
+
+inline bool isSpace(char c)
+{
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+inline int skipSpace(const char *data, int pos, int size)
+{
+    while (pos < size && isSpace(data[pos])) {
+        ++pos;
+    }
+    return pos;
+}
+
+/**
+ * @brief 从pos开始查找引号、反斜杠或控制字符，找不到返回size
+ */
+inline int findStringSpecial(const char *data, int pos, int size)
+{
+#ifdef INBOUND_SCANNER_SSE2
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i backslash = _mm_set1_epi8('\\');
+    const __m128i control = _mm_set1_epi8(0x1F);
+    while (pos + 16 <= size) {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + pos));
+        // 无符号字节 <= 0x1F 等价于 max(字节, 0x1F) == 0x1F
+        __m128i special = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(chunk, quote), _mm_cmpeq_epi8(chunk, backslash)),
+            _mm_cmpeq_epi8(_mm_max_epu8(chunk, control), control));
+        int mask = _mm_movemask_epi8(special);
+        if (mask != 0) {
+            return pos + static_cast<int>(qCountTrailingZeroBits(static_cast<quint32>(mask)));
+        }
+        pos += 16;
+    }
+#endif
+    while (pos < size) {
+        uchar c = static_cast<uchar>(data[pos]);
+        if (c == '"' || c == '\\' || c < 0x20) {
+            return pos;
+        }
+        ++pos;
+    }
+    return size;
+}
+
+inline bool isHex(char c)
+{
+    return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F');
+}
+
+/**
+ * @brief 扫描字符串，pos指向开头引号之后，end输出结尾引号的位置
+ */
+bool scanString(const char *data, int pos, int size, int *end, bool *escaped)
+{
+    for (;;) {
+        pos = findStringSpecial(data, pos, size);
+        if (pos >= size) {
+            return false;
+        }
+
+        char c = data[pos];
+        if (c == '"') {
+            *end = pos;
+            return true;
+        }
+        if (c != '\\' || pos + 1 >= size) {
+            return false;                     // 未转义的控制字符或截断
+        }
+
+        *escaped = true;
+        char next = data[pos + 1];
+        if (next == 'u') {
+            if (pos + 6 > size || !isHex(data[pos + 2]) || !isHex(data[pos + 3]) ||
+                !isHex(data[pos + 4]) || !isHex(data[pos + 5])) {
+                return false;
+            }
+            pos += 6;
+        } else if (std::strchr("\"\\/bfnrt", next) != nullptr && next != '\0') {
+            pos += 2;
+        } else {
+            return false;
+        }
+    }
+}
+
+/**
+ * @brief 扫描数字或字面量，end输出结束位置
+ */
+bool scanScalar(const char *data, int pos, int size, int *end, InboundScanner::Value::Type *type)
+{
+    int start = pos;
+    while (pos < size) {
+        char c = data[pos];
+        if (isSpace(c) || c == ',' || c == '}' || c == ']') {
+            break;
+        }
+        ++pos;
+    }
+
+    int length = pos - start;
+    if (length == 0) {
+        return false;
+    }
+
+    const char *token = data + start;
+    if (token[0] == '-' || (token[0] >= '0' && token[0] <= '9')) {
+        for (int i = 0; i < length; ++i) {
+            if (!std::strchr("0123456789+-.eE", token[i])) {
+                return false;
+            }
+        }
+        *type = InboundScanner::Value::Number;
+    } else if ((length == 4 && std::memcmp(token, "true", 4) == 0) ||
+               (length == 5 && std::memcmp(token, "false", 5) == 0) ||
+               (length == 4 && std::memcmp(token, "null", 4) == 0)) {
+        *type = InboundScanner::Value::Literal;
+    } else {
+        return false;
+    }
+
+    *end = pos;
+    return true;
+}
+
+/**
+ * @brief 跳过对象或数组，只检查括号配对和其中的字符串
+ */
+bool skipComposite(const char *data, int pos, int size, int *end)
+{
+    char expected[MAX_DEPTH];
+    int depth = 0;
+
+    while (pos < size) {
+        char c = data[pos];
+        if (c == '"') {
+            int stringEnd = 0;
+            bool escaped = false;
+            if (!scanString(data, pos + 1, size, &stringEnd, &escaped)) {
+                return false;
+            }
+            pos = stringEnd + 1;
+            continue;
+        }
+        if (c == '{' || c == '[') {
+            if (depth >= MAX_DEPTH) {
+                return false;
+            }
+            expected[depth++] = (c == '{') ? '}' : ']';
+        } else if (c == '}' || c == ']') {
+            if (depth == 0 || expected[--depth] != c) {
+                return false;
+            }
+            if (depth == 0) {
+                *end = pos + 1;
+                return true;
+            }
+        }
+        ++pos;
+    }
+    return false;
+}
+
+/**
+ * @brief 扫描一个值，end输出值之后的位置
+ */
+bool scanValue(const char *data, int pos, int size, InboundScanner::Value *value, int *end)
+{
+    if (pos >= size) {
+        return false;
+    }
+
+    char c = data[pos];
+    if (c == '"') {
+        int stringEnd = 0;
+        bool escaped = false;
+        if (!scanString(data, pos + 1, size, &stringEnd, &escaped)) {
+            return false;
+        }
+        value->type = InboundScanner::Value::String;
+        value->offset = pos + 1;
+        value->length = stringEnd - pos - 1;
+        value->escaped = escaped;
+        *end = stringEnd + 1;
+        return true;
+    }
+
+    if (c == '{' || c == '[') {
+        if (!skipComposite(data, pos, size, end)) {
+            return false;
+        }
+        value->type = InboundScanner::Value::Composite;
+        value->offset = pos;
+        value->length = *end - pos;
+        return true;
+    }
+
+    if (!scanScalar(data, pos, size, end, &value->type)) {
+        return false;
+    }
+    value->offset = pos;
+    value->length = *end - pos;
+    return true;
+}
+
+/**
+ * @brief 键名对应的字段，不需要的键返回-1
+ */
+int fieldFor(const char *key, int length)
+{
+    switch (length) {
+    case 6:
+        return std::memcmp(key, "action", 6) == 0 ? InboundScanner::Action : -1;
+    case 7:
+        return std::memcmp(key, "user_id", 7) == 0 ? InboundScanner::UserId : -1;
+    case 9:
+        return std::memcmp(key, "client_id", 9) == 0 ? InboundScanner::ClientId : -1;
+    case 10:
+        return std::memcmp(key, "request_id", 10) == 0 ? InboundScanner::RequestId : -1;
+    case 11:
+        return std::memcmp(key, "deadline_ms", 11) == 0 ? InboundScanner::DeadlineMs : -1;
+    default:
+        return -1;
+    }
+}
+
+} // namespace
+
+bool InboundScanner::scan(const char *data, int size, Result *result)
+{
+    *result = Result();
+
+    if (!isValidUtf8(data, size)) {
+        s_rejected.fetchAndAddOrdered(1);
+        return false;
+    }
+
+    int pos = skipSpace(data, 0, size);
+    if (pos >= size || data[pos] != '{') {
+        s_rejected.fetchAndAddOrdered(1);
+        return false;
+    }
+
+    pos = skipSpace(data, pos + 1, size);
+    bool closed = false;
+    if (pos < size && data[pos] == '}') {
+        ++pos;
+        closed = true;
+    }
+
+    while (!closed) {
+        if (pos >= size || data[pos] != '"') {
+            break;
+        }
+
+        int keyEnd = 0;
+        bool keyEscaped = false;
+        if (!scanString(data, pos + 1, size, &keyEnd, &keyEscaped)) {
+            break;
+        }
+        int keyStart = pos + 1;
+
+        pos = skipSpace(data, keyEnd + 1, size);
+        if (pos >= size || data[pos] != ':') {
+            break;
+        }
+        pos = skipSpace(data, pos + 1, size);
+
+        Value value;
+        int valueEnd = 0;
+        if (!scanValue(data, pos, size, &value, &valueEnd)) {
+            break;
+        }
+
+        // 重复的键以最后一个为准，与QJsonDocument一致
+        int field = keyEscaped ? -1 : fieldFor(data + keyStart, keyEnd - keyStart);
+        if (field >= 0) {
+            result->values[field] = value;
+        }
+
+        pos = skipSpace(data, valueEnd, size);
+        if (pos < size && data[pos] == ',') {
+            pos = skipSpace(data, pos + 1, size);
+            continue;
+        }
+        if (pos < size && data[pos] == '}') {
+            ++pos;
+            closed = true;
+        }
+        break;
+    }
+
+    if (!closed || skipSpace(data, pos, size) != size) {
+        s_rejected.fetchAndAddOrdered(1);
+        return false;
+    }
+
+    s_scanned.fetchAndAddOrdered(1);
+    return true;
+}
+
+QString InboundScanner::stringValue(const char *data, const Value &value)
+{
+    if (value.type != Value::String) {
+        return QString();
+    }
+    if (!value.escaped) {
+        return QString::fromUtf8(data + value.offset, value.length);
+    }
+
+    // 含转义的字符串很少见，交给Qt解码
+    QByteArray wrapped;
+    wrapped.reserve(value.length + 4);
+    wrapped.append('[');
+    wrapped.append(data + value.offset - 1, value.length + 2);
+    wrapped.append(']');
+    return QJsonDocument::fromJson(wrapped).array().at(0).toString();
+}
+
+qint64 InboundScanner::integerValue(const char *data, const Value &value)
+{
+    if (value.type == Value::String) {
+        return stringValue(data, value).toLongLong();
+    }
+    if (value.type == Value::Number) {
+        return qRound64(QByteArray(data + value.offset, value.length).toDouble());
+    }
+    return 0;
+}
+
+bool InboundScanner::isValidUtf8(const char *data, int size)
+{
+    int i = 0;
+    while (i < size) {
+#ifdef INBOUND_SCANNER_SSE2
+        // ASCII块整体跳过，遇到高位字节时逐字节校验该字符
+        while (i + 16 <= size) {
+            int mask = _mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i)));
+            if (mask != 0) {
+                i += static_cast<int>(qCountTrailingZeroBits(static_cast<quint32>(mask)));
+                break;
+            }
+            i += 16;
+        }
+        if (i >= size) {
+            break;
+        }
+#endif
+        uchar c = static_cast<uchar>(data[i]);
+        if (c < 0x80) {
+            ++i;
+            continue;
+        }
+
+        int continuation = 0;
+        quint32 codePoint = 0;
+        quint32 minimum = 0;
+        if ((c & 0xE0) == 0xC0) {
+            continuation = 1;
+            codePoint = c & 0x1F;
+            minimum = 0x80;
+        } else if ((c & 0xF0) == 0xE0) {
+            continuation = 2;
+            codePoint = c & 0x0F;
+            minimum = 0x800;
+        } else if ((c & 0xF8) == 0xF0) {
+            continuation = 3;
+            codePoint = c & 0x07;
+            minimum = 0x10000;
+        } else {
+            return false;
+        }
+
+        if (i + continuation >= size) {
+            return false;
+        }
+        for (int k = 1; k <= continuation; ++k) {
+            uchar byte = static_cast<uchar>(data[i + k]);
+            if ((byte & 0xC0) != 0x80) {
+                return false;
+            }
+            codePoint = (codePoint << 6) | (byte & 0x3F);
+        }
+
+        // 拒绝过长编码、代理区和超出Unicode范围的码点
+        if (codePoint < minimum || codePoint > 0x10FFFF || (codePoint >= 0xD800 && codePoint <= 0xDFFF)) {
+            return false;
+        }
+        i += continuation + 1;
+    }
+    return true;
+}
+
+QJsonObject InboundScanner::getStatistics()
+{
+    QJsonObject stats;
+#ifdef INBOUND_SCANNER_SSE2
+    stats["simd"] = "sse2";
+#else
+    stats["simd"] = "none";
+#endif
+    stats["scanned"] = s_scanned.loadAcquire();
+    stats["rejected"] = s_rejected.loadAcquire();
+    stats["fast_path"] = s_fastPath.loadAcquire();
+    stats["full_parses"] = s_fullParses.loadAcquire();
+    return stats;
+}
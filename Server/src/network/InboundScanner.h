@@ -0,0 +1,101 @@
+#ifndef INBOUNDSCANNER_H
+#define INBOUNDSCANNER_H
+
+#include <QString>
+#include <QByteArray>
+#include <QJsonObject>
+#include <QAtomicInteger>
+
+/**
+ * @brief 入站帧快速扫描器
+ *
+ * 在不构建JSON DOM的情况下校验入站消息（UTF-8编码、字符串与括号结构）并取出顶层的路由字段
+ * （action、request_id、user_id、client_id、deadline_ms）。字符串内容和UTF-8校验以16字节为单位向量化
+ * （SSE2，其他架构退化为逐字节），嵌套的对象和数组只跳过不解码。
+ *
+ * 扫描成功后调用者可以只凭路由字段完成认证检查和心跳等简单动作，需要其他字段时再用
+ * QJsonDocument解析整条消息。扫描不校验数字和字面量的语法，失败或遇到无法判断的情况时
+ * 调用者应退回完整解析，由完整解析给出错误信息。
+ */
+class InboundScanner
+{
+public:
+    /**
+     * @brief 提取的顶层字段
+     */
+    enum Field {
+        Action,
+        RequestId,
+        UserId,
+        ClientId,
+        DeadlineMs,
+        FieldCount
+    };
+
+    /**
+     * @brief 字段值在原始数据中的位置
+     */
+    struct Value {
+        enum Type {
+            Missing,
+            String,
+            Number,
+            Literal,                          // true、false、null
+            Composite                         // 对象或数组
+        };
+
+        Type type = Missing;
+        int offset = 0;                       // 字符串为引号内的起始位置
+        int length = 0;
+        bool escaped = false;                 // 字符串中含有转义序列
+    };
+
+    /**
+     * @brief 扫描结果
+     */
+    struct Result {
+        Value values[FieldCount];
+
+        const Value &value(Field field) const { return values[field]; }
+    };
+
+    /**
+     * @brief 扫描一条消息
+     * @param data 消息数据（不含长度前缀）
+     * @param size 数据长度
+     * @param result 输出的字段位置
+     * @return 数据是结构合法的顶层JSON对象时返回true
+     */
+    static bool scan(const char *data, int size, Result *result);
+
+    /**
+     * @brief 取字符串字段，非字符串返回空字符串
+     */
+    static QString stringValue(const char *data, const Value &value);
+
+    /**
+     * @brief 取整数字段，数字或数字字符串均可，否则返回0
+     */
+    static qint64 integerValue(const char *data, const Value &value);
+
+    /**
+     * @brief 校验UTF-8编码
+     */
+    static bool isValidUtf8(const char *data, int size);
+
+    /**
+     * @brief 记录一次快速路径处理（未构建DOM）或退回完整解析
+     */
+    static void recordFastPath() { s_fastPath.fetchAndAddOrdered(1); }
+    static void recordFullParse() { s_fullParses.fetchAndAddOrdered(1); }
+
+    static QJsonObject getStatistics();
+
+private:
+    static QAtomicInteger<qint64> s_scanned;
+    static QAtomicInteger<qint64> s_rejected;
+    static QAtomicInteger<qint64> s_fastPath;
+    static QAtomicInteger<qint64> s_fullParses;
+};
+
+#endif // INBOUNDSCANNER_H
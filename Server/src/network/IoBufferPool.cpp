@@ -0,0 +1,111 @@
+#include "IoBufferPool.h"
+#include "../utils/Logger.h"
+
+// 静态成员初始化
+IoBufferPool* IoBufferPool::s_instance = nullptr;
+QMutex IoBufferPool::s_instanceMutex;
+
+IoBufferPool::IoBufferPool()
+    : _chunksInUse(0)
+    , _peakChunksInUse(0)
+    , _totalAcquired(0)
+    , _poolHits(0)
+{
+}
+
+IoBufferPool::~IoBufferPool()
+{
+    trim();
+}
+
+IoBufferPool* IoBufferPool::instance()
+{
+    if (!s_instance) {
+        QMutexLocker locker(&s_instanceMutex);
+        if (!s_instance) {
+            s_instance = new IoBufferPool();
+        }
+    }
+    return s_instance;
+}
+
+bool IoBufferPool::configure(const PoolConfig &config)
+{
+    QMutexLocker locker(&_mutex);
+
+    if (_totalAcquired > 0) {
+        LOG_WARNING("I/O buffer pool already in use, configuration ignored");
+        return false;
+    }
+
+    _config = config;
+    _config.chunkSize = qBound(512, _config.chunkSize, 1024 * 1024);
+    _config.maxPooledChunks = qMax(0, _config.maxPooledChunks);
+
+    LOG_INFO(QString("I/O buffer pool configured: chunkSize=%1, maxPooledChunks=%2")
+             .arg(_config.chunkSize).arg(_config.maxPooledChunks));
+    return true;
+}
+
+char* IoBufferPool::acquire()
+{
+    {
+        QMutexLocker locker(&_mutex);
+        ++_totalAcquired;
+        _peakChunksInUse = qMax(_peakChunksInUse, ++_chunksInUse);
+        if (!_freeChunks.isEmpty()) {
+            ++_poolHits;
+            return _freeChunks.takeLast();
+        }
+    }
+
+    return new char[_config.chunkSize];
+}
+
+void IoBufferPool::release(char *chunk)
+{
+    if (!chunk) {
+        return;
+    }
+
+    {
+        QMutexLocker locker(&_mutex);
+        --_chunksInUse;
+        if (_freeChunks.size() < _config.maxPooledChunks) {
+            _freeChunks.append(chunk);
+            return;
+        }
+    }
+
+    delete[] chunk;
+}
+
+void IoBufferPool::trim()
+{
+    QVector<char*> chunks;
+    {
+        QMutexLocker locker(&_mutex);
+        chunks.swap(_freeChunks);
+    }
+
+    for (char *chunk : chunks) {
+        delete[] chunk;
+    }
+}
+
+QJsonObject IoBufferPool::getStatistics() const
+{
+    QMutexLocker locker(&_mutex);
+
+    QJsonObject stats;
+    stats["chunk_size"] = _config.chunkSize;
+    stats["chunks_in_use"] = _chunksInUse;
+    stats["chunks_pooled"] = _freeChunks.size();
+    stats["max_pooled_chunks"] = _config.maxPooledChunks;
+    stats["peak_chunks_in_use"] = _peakChunksInUse;
+    stats["bytes_in_use"] = _chunksInUse * _config.chunkSize;
+    stats["bytes_pooled"] = static_cast<qint64>(_freeChunks.size()) * _config.chunkSize;
+    stats["total_acquired"] = _totalAcquired;
+    stats["pool_hit_rate"] = _totalAcquired > 0 ? static_cast<double>(_poolHits) / _totalAcquired : 0.0;
+    return stats;
+}
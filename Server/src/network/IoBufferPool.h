@@ -0,0 +1,78 @@
+#ifndef IOBUFFERPOOL_H
+#define IOBUFFERPOOL_H
+
+#include <QMutex>
+#include <QVector>
+#include <QJsonObject>
+
+/**
+ * @brief 固定大小I/O块的共享池
+ *
+ * 所有连接的接收缓冲区都由固定大小的块拼接而成，块用完后归还到池中供其他连接复用。
+ * 连接只在有未处理数据时持有块，空闲连接不占用缓冲区内存；
+ * 池中缓存的空闲块数量有上限，超出部分直接释放给系统。
+ */
+class IoBufferPool
+{
+public:
+    /**
+     * @brief 缓冲池配置
+     */
+    struct PoolConfig {
+        int chunkSize = 4096;           // 块大小（字节）
+        int maxPooledChunks = 4096;     // 池中最多缓存的空闲块数
+    };
+
+    static IoBufferPool* instance();
+
+    /**
+     * @brief 设置配置，只能在分配任何块之前调用
+     * @return 设置是否成功
+     */
+    bool configure(const PoolConfig &config);
+
+    /**
+     * @brief 块大小
+     */
+    int chunkSize() const { return _config.chunkSize; }
+
+    /**
+     * @brief 获取一个块
+     */
+    char* acquire();
+
+    /**
+     * @brief 归还一个块
+     */
+    void release(char *chunk);
+
+    /**
+     * @brief 释放池中缓存的所有空闲块
+     */
+    void trim();
+
+    /**
+     * @brief 获取缓冲池统计信息
+     */
+    QJsonObject getStatistics() const;
+
+private:
+    IoBufferPool();
+    ~IoBufferPool();
+
+    static IoBufferPool* s_instance;
+    static QMutex s_instanceMutex;
+
+    PoolConfig _config;
+
+    mutable QMutex _mutex;
+    QVector<char*> _freeChunks;
+
+    // 统计信息
+    qint64 _chunksInUse;
+    qint64 _peakChunksInUse;
+    qint64 _totalAcquired;
+    qint64 _poolHits;
+};
+
+#endif // IOBUFFERPOOL_H
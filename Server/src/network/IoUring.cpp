@@ -0,0 +1,378 @@
+#include "IoUring.h"
+#include <QSysInfo>
+#include <QStringList>
+
+#ifdef Q_OS_LINUX
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#include <cstdlib>
+#endif
+
+#ifdef Q_OS_LINUX
+
+namespace {
+
+inline unsigned loadAcquire(const unsigned *p)
+{
+    return __atomic_load_n(p, __ATOMIC_ACQUIRE);
+}
+
+inline void storeRelease(unsigned *p, unsigned value)
+{
+    __atomic_store_n(p, value, __ATOMIC_RELEASE);
+}
+
+int ringEnter(int ringFd, unsigned toSubmit, unsigned minComplete, unsigned flags)
+{
+    int result = static_cast<int>(syscall(__NR_io_uring_enter, ringFd, toSubmit, minComplete, flags, nullptr, 0));
+    return result < 0 ? -errno : result;
+}
+
+int ringRegister(int ringFd, unsigned opcode, void *arg, unsigned count)
+{
+    int result = static_cast<int>(syscall(__NR_io_uring_register, ringFd, opcode, arg, count));
+    return result < 0 ? -errno : result;
+}
+
+} // namespace
+
+#endif
+
+IoUring::IoUring()
+    : _ringFd(-1)
+    , _sqRing(nullptr)
+    , _sqRingSize(0)
+    , _sqHead(nullptr)
+    , _sqTail(nullptr)
+    , _sqFlags(nullptr)
+    , _sqMask(0)
+    , _sqEntries(0)
+    , _sqes(nullptr)
+    , _sqesSize(0)
+    , _sqeTail(0)
+    , _submittedTail(0)
+    , _cqRing(nullptr)
+    , _cqRingSize(0)
+    , _cqHead(nullptr)
+    , _cqTail(nullptr)
+    , _cqMask(0)
+    , _cqes(nullptr)
+    , _bufferRing(nullptr)
+    , _bufferRingSize(0)
+    , _bufferMemory(nullptr)
+    , _bufferCount(0)
+    , _bufferSize(0)
+    , _bufferGroup(0)
+    , _bufferTail(0)
+    , _bufferRingRegistered(false)
+{
+}
+
+IoUring::~IoUring()
+{
+    close();
+}
+
+bool IoUring::isSupported()
+{
+#ifdef Q_OS_LINUX
+    // 多次触发的recv需要6.0及以上内核
+    QStringList parts = QSysInfo::kernelVersion().split('.');
+    if (parts.size() < 2) {
+        return false;
+    }
+    return parts.at(0).toInt() >= 6;
+#else
+    return false;
+#endif
+}
+
+int IoUring::setup(unsigned entries)
+{
+#ifdef Q_OS_LINUX
+    if (_ringFd >= 0) {
+        return 0;
+    }
+
+    io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    params.flags = IORING_SETUP_CQSIZE | IORING_SETUP_SUBMIT_ALL;
+    params.cq_entries = entries * 4;
+
+    int fd = static_cast<int>(syscall(__NR_io_uring_setup, entries, &params));
+    if (fd < 0 && errno == EINVAL) {
+        // 旧内核不认识部分标志，退回只指定完成队列大小
+        memset(&params, 0, sizeof(params));
+        params.flags = IORING_SETUP_CQSIZE;
+        params.cq_entries = entries * 4;
+        fd = static_cast<int>(syscall(__NR_io_uring_setup, entries, &params));
+    }
+    if (fd < 0) {
+        return -errno;
+    }
+    _ringFd = fd;
+
+    _sqRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    _cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    bool singleMmap = params.features & IORING_FEAT_SINGLE_MMAP;
+    if (singleMmap) {
+        _sqRingSize = _cqRingSize = qMax(_sqRingSize, _cqRingSize);
+    }
+
+    _sqRing = mmap(nullptr, _sqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                   _ringFd, IORING_OFF_SQ_RING);
+    if (_sqRing == MAP_FAILED) {
+        _sqRing = nullptr;
+        int error = -errno;
+        close();
+        return error;
+    }
+
+    if (singleMmap) {
+        _cqRing = _sqRing;
+    } else {
+        _cqRing = mmap(nullptr, _cqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                       _ringFd, IORING_OFF_CQ_RING);
+        if (_cqRing == MAP_FAILED) {
+            _cqRing = nullptr;
+            int error = -errno;
+            close();
+            return error;
+        }
+    }
+
+    _sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+    void *sqes = mmap(nullptr, _sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                      _ringFd, IORING_OFF_SQES);
+    if (sqes == MAP_FAILED) {
+        int error = -errno;
+        close();
+        return error;
+    }
+    _sqes = static_cast<io_uring_sqe*>(sqes);
+
+    char *sq = static_cast<char*>(_sqRing);
+    _sqHead = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+    _sqTail = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+    _sqFlags = reinterpret_cast<unsigned*>(sq + params.sq_off.flags);
+    _sqMask = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+    _sqEntries = params.sq_entries;
+
+    // 提交项与索引数组一一对应，之后只需推进尾部
+    unsigned *array = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+    for (unsigned i = 0; i < _sqEntries; ++i) {
+        array[i] = i;
+    }
+    _sqeTail = _submittedTail = *_sqTail;
+
+    char *cq = static_cast<char*>(_cqRing);
+    _cqHead = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+    _cqTail = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+    _cqMask = *reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+    _cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+
+    return 0;
+#else
+    Q_UNUSED(entries)
+    return -1;
+#endif
+}
+
+void IoUring::close()
+{
+#ifdef Q_OS_LINUX
+    // 先关闭环，内核取消所有未完成的操作后才能释放缓冲区
+    if (_ringFd >= 0) {
+        ::close(_ringFd);
+        _ringFd = -1;
+    }
+    if (_sqes) {
+        munmap(_sqes, _sqesSize);
+        _sqes = nullptr;
+    }
+    if (_cqRing && _cqRing != _sqRing) {
+        munmap(_cqRing, _cqRingSize);
+    }
+    _cqRing = nullptr;
+    if (_sqRing) {
+        munmap(_sqRing, _sqRingSize);
+        _sqRing = nullptr;
+    }
+    if (_bufferRing) {
+        munmap(_bufferRing, _bufferRingSize);
+        _bufferRing = nullptr;
+    }
+    free(_bufferMemory);
+    _bufferMemory = nullptr;
+    _bufferCount = 0;
+    _bufferRingRegistered = false;
+#endif
+}
+
+io_uring_sqe *IoUring::getSqe()
+{
+#ifdef Q_OS_LINUX
+    if (_ringFd < 0 || _sqeTail - loadAcquire(_sqHead) >= _sqEntries) {
+        return nullptr;
+    }
+
+    io_uring_sqe *sqe = &_sqes[_sqeTail & _sqMask];
+    memset(sqe, 0, sizeof(*sqe));
+    ++_sqeTail;
+    return sqe;
+#else
+    return nullptr;
+#endif
+}
+
+int IoUring::submit()
+{
+#ifdef Q_OS_LINUX
+    unsigned toSubmit = _sqeTail - _submittedTail;
+    if (_ringFd < 0 || toSubmit == 0) {
+        return 0;
+    }
+
+    storeRelease(_sqTail, _sqeTail);
+    int submitted = ringEnter(_ringFd, toSubmit, 0, 0);
+    if (submitted > 0) {
+        _submittedTail += static_cast<unsigned>(submitted);
+    }
+    return submitted;
+#else
+    return -1;
+#endif
+}
+
+io_uring_cqe *IoUring::peekCqe()
+{
+#ifdef Q_OS_LINUX
+    if (_ringFd < 0) {
+        return nullptr;
+    }
+
+    unsigned head = *_cqHead;
+    if (head == loadAcquire(_cqTail)) {
+        return nullptr;
+    }
+    return &_cqes[head & _cqMask];
+#else
+    return nullptr;
+#endif
+}
+
+void IoUring::cqeSeen()
+{
+#ifdef Q_OS_LINUX
+    storeRelease(_cqHead, *_cqHead + 1);
+#endif
+}
+
+void IoUring::flushOverflow()
+{
+#ifdef Q_OS_LINUX
+    if (_ringFd >= 0 && (loadAcquire(_sqFlags) & IORING_SQ_CQ_OVERFLOW)) {
+        ringEnter(_ringFd, 0, 0, IORING_ENTER_GETEVENTS);
+    }
+#endif
+}
+
+int IoUring::registerEventFd(int eventFd)
+{
+#ifdef Q_OS_LINUX
+    return ringRegister(_ringFd, IORING_REGISTER_EVENTFD, &eventFd, 1);
+#else
+    Q_UNUSED(eventFd)
+    return -1;
+#endif
+}
+
+int IoUring::setupBufferRing(quint16 groupId, int count, int size)
+{
+#ifdef Q_OS_LINUX
+    if (_ringFd < 0 || _bufferRing || count <= 0 || size <= 0) {
+        return -EINVAL;
+    }
+
+    int entries = 1;
+    while (entries < count && entries < 32768) {
+        entries <<= 1;
+    }
+
+    _bufferRingSize = static_cast<size_t>(entries) * sizeof(io_uring_buf);
+    void *ring = mmap(nullptr, _bufferRingSize, PROT_READ | PROT_WRITE, MAP_ANONYMOUS | MAP_PRIVATE, -1, 0);
+    if (ring == MAP_FAILED) {
+        return -errno;
+    }
+    _bufferRing = static_cast<io_uring_buf_ring*>(ring);
+
+    void *memory = nullptr;
+    if (posix_memalign(&memory, 4096, static_cast<size_t>(entries) * static_cast<size_t>(size)) != 0) {
+        munmap(_bufferRing, _bufferRingSize);
+        _bufferRing = nullptr;
+        return -ENOMEM;
+    }
+    _bufferMemory = static_cast<char*>(memory);
+    _bufferCount = entries;
+    _bufferSize = size;
+    _bufferGroup = groupId;
+    _bufferTail = 0;
+
+    io_uring_buf_reg reg;
+    memset(&reg, 0, sizeof(reg));
+    reg.ring_addr = reinterpret_cast<quint64>(_bufferRing);
+    reg.ring_entries = static_cast<unsigned>(entries);
+    reg.bgid = groupId;
+    int result = ringRegister(_ringFd, IORING_REGISTER_PBUF_RING, &reg, 1);
+    if (result < 0) {
+        munmap(_bufferRing, _bufferRingSize);
+        _bufferRing = nullptr;
+        free(_bufferMemory);
+        _bufferMemory = nullptr;
+        _bufferCount = 0;
+        return result;
+    }
+    _bufferRingRegistered = true;
+
+    for (int i = 0; i < entries; ++i) {
+        recycleBuffer(static_cast<quint16>(i));
+    }
+    commitBuffers();
+    return 0;
+#else
+    Q_UNUSED(groupId)
+    Q_UNUSED(count)
+    Q_UNUSED(size)
+    return -1;
+#endif
+}
+
+char *IoUring::buffer(quint16 bufferId) const
+{
+    return _bufferMemory + static_cast<size_t>(bufferId) * static_cast<size_t>(_bufferSize);
+}
+
+void IoUring::recycleBuffer(quint16 bufferId)
+{
+#ifdef Q_OS_LINUX
+    // 不使用bufs成员：C++中内核头文件的柔性数组声明会带来额外偏移
+    io_uring_buf *entry = reinterpret_cast<io_uring_buf*>(_bufferRing) + (_bufferTail & (_bufferCount - 1));
+    entry->addr = reinterpret_cast<quint64>(buffer(bufferId));
+    entry->len = static_cast<quint32>(_bufferSize);
+    entry->bid = bufferId;
+    ++_bufferTail;
+#else
+    Q_UNUSED(bufferId)
+#endif
+}
+
+void IoUring::commitBuffers()
+{
+#ifdef Q_OS_LINUX
+    __atomic_store_n(&_bufferRing->tail, _bufferTail, __ATOMIC_RELEASE);
+#endif
+}
@@ -0,0 +1,144 @@
+#ifndef IOURING_H
+#define IOURING_H
+
+#include <QtGlobal>
+
+struct io_uring_sqe;
+struct io_uring_cqe;
+struct io_uring_buf_ring;
+
+/**
+ * @brief io_uring提交/完成队列的最小封装
+ *
+ * 直接使用内核系统调用，不依赖liburing：负责创建环、映射队列、
+ * 注册eventfd和提供缓冲区环（provided buffer ring）。
+ * 该类不是线程安全的，所有调用必须在同一线程中进行。
+ */
+class IoUring
+{
+public:
+    IoUring();
+    ~IoUring();
+
+    IoUring(const IoUring &) = delete;
+    IoUring &operator=(const IoUring &) = delete;
+
+    /**
+     * @brief 内核是否支持所需特性（多次触发的accept/recv与提供缓冲区环，Linux 6.0+）
+     */
+    static bool isSupported();
+
+    /**
+     * @brief 创建环
+     * @param entries 提交队列深度，完成队列为其4倍
+     * @return 成功返回0，失败返回负的errno
+     */
+    int setup(unsigned entries);
+
+    /**
+     * @brief 关闭环并释放所有映射，未完成的操作由内核取消
+     */
+    void close();
+
+    bool isValid() const { return _ringFd >= 0; }
+
+    /**
+     * @brief 获取一个空闲的提交项，队列已满时返回nullptr
+     */
+    io_uring_sqe *getSqe();
+
+    /**
+     * @brief 提交所有已填写的提交项
+     * @return 提交的数量，失败返回负的errno
+     */
+    int submit();
+
+    /**
+     * @brief 已填写但尚未提交的提交项数量
+     */
+    unsigned pendingSubmissions() const { return _sqeTail - _submittedTail; }
+
+    /**
+     * @brief 获取下一个完成项，没有时返回nullptr
+     */
+    io_uring_cqe *peekCqe();
+
+    /**
+     * @brief 标记当前完成项已处理
+     */
+    void cqeSeen();
+
+    /**
+     * @brief 完成队列溢出时让内核把积压的完成项写回队列
+     */
+    void flushOverflow();
+
+    /**
+     * @brief 注册完成通知用的eventfd
+     * @return 成功返回0，失败返回负的errno
+     */
+    int registerEventFd(int eventFd);
+
+    /**
+     * @brief 创建并注册提供缓冲区环
+     * @param groupId 缓冲区组ID
+     * @param count 缓冲区数量（向上取整为2的幂）
+     * @param size 单个缓冲区大小
+     * @return 成功返回0，失败返回负的errno
+     */
+    int setupBufferRing(quint16 groupId, int count, int size);
+
+    /**
+     * @brief 获取指定缓冲区的地址
+     */
+    char *buffer(quint16 bufferId) const;
+
+    int bufferSize() const { return _bufferSize; }
+    int bufferCount() const { return _bufferCount; }
+
+    /**
+     * @brief 归还缓冲区，commitBuffers()后内核才可再次使用
+     */
+    void recycleBuffer(quint16 bufferId);
+
+    /**
+     * @brief 发布已归还的缓冲区
+     */
+    void commitBuffers();
+
+private:
+    int _ringFd;
+
+    // 提交队列
+    void *_sqRing;
+    size_t _sqRingSize;
+    unsigned *_sqHead;
+    unsigned *_sqTail;
+    unsigned *_sqFlags;
+    unsigned _sqMask;
+    unsigned _sqEntries;
+    io_uring_sqe *_sqes;
+    size_t _sqesSize;
+    unsigned _sqeTail;          // 本地已填写的尾部
+    unsigned _submittedTail;    // 已提交给内核的尾部
+
+    // 完成队列
+    void *_cqRing;
+    size_t _cqRingSize;
+    unsigned *_cqHead;
+    unsigned *_cqTail;
+    unsigned _cqMask;
+    io_uring_cqe *_cqes;
+
+    // 提供缓冲区环
+    io_uring_buf_ring *_bufferRing;
+    size_t _bufferRingSize;
+    char *_bufferMemory;
+    int _bufferCount;
+    int _bufferSize;
+    quint16 _bufferGroup;
+    quint16 _bufferTail;
+    bool _bufferRingRegistered;
+};
+
+#endif // IOURING_H
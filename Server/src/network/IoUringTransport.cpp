@@ -0,0 +1,700 @@
+#include "IoUringTransport.h"
+#include "../utils/Logger.h"
+#include <QSocketNotifier>
+#include <QTimer>
+#include <QMutexLocker>
+
+#ifdef Q_OS_LINUX
+#include <linux/io_uring.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#endif
+
+namespace {
+
+const quint16 RECV_BUFFER_GROUP = 1;
+const int MAX_BATCH_FRAMES = 64;
+
+// user_data：高位为连接ID，低8位为操作类型
+inline quint64 encodeUserData(quint32 connectionId, int operation)
+{
+    return (static_cast<quint64>(connectionId) << 8) | static_cast<quint64>(operation);
+}
+
+} // namespace
+
+/**
+ * @brief 单个连接的传输状态
+ */
+struct IoUringTransport::Connection {
+    int fd = -1;
+    Receiver *receiver = nullptr;
+    QList<QByteArray> frames;       // 待发送的帧，包含正在发送的帧
+    qint64 headOffset = 0;          // 首帧已发送的字节数
+    qint64 queuedBytes = 0;         // 尚未被内核接收的字节数
+    int framesInFlight = 0;
+    bool sending = false;
+    bool recvArmed = false;
+    bool closing = false;           // 已调用close()，不再回调接收者
+    bool socketShutdown = false;
+#ifdef Q_OS_LINUX
+    iovec iov[MAX_BATCH_FRAMES];
+    msghdr message;
+#endif
+};
+
+IoUringTransport::IoUringTransport(QObject *parent)
+    : QObject(parent)
+    , _eventFd(-1)
+    , _notifier(nullptr)
+    , _listenDescriptor(-1)
+    , _accepting(false)
+    , _acceptArmed(false)
+    , _nextConnectionId(1)
+    , _flushScheduled(0)
+    , _enterCalls(0)
+    , _sqesSubmitted(0)
+    , _completions(0)
+    , _accepted(0)
+    , _recvCompletions(0)
+    , _bytesReceived(0)
+    , _sendOperations(0)
+    , _framesSent(0)
+    , _bytesSent(0)
+    , _bufferExhausted(0)
+{
+}
+
+IoUringTransport::~IoUringTransport()
+{
+    shutdown();
+}
+
+bool IoUringTransport::initialize(const Config &config)
+{
+    _config = config;
+    _config.maxBatchFrames = qBound(1, _config.maxBatchFrames, MAX_BATCH_FRAMES);
+
+    if (!_config.enabled) {
+        return false;
+    }
+
+#ifdef Q_OS_LINUX
+    if (isEnabled()) {
+        return true;
+    }
+
+    if (!IoUring::isSupported()) {
+        LOG_WARNING("io_uring transport requires Linux 6.0 or later, falling back to Qt sockets");
+        return false;
+    }
+
+    int result = _ring.setup(static_cast<unsigned>(qBound(64, _config.queueDepth, 32768)));
+    if (result < 0) {
+        LOG_WARNING(QString("Failed to create io_uring (%1), falling back to Qt sockets").arg(strerror(-result)));
+        return false;
+    }
+
+    result = _ring.setupBufferRing(RECV_BUFFER_GROUP, qMax(64, _config.bufferCount), qMax(1024, _config.bufferSize));
+    if (result < 0) {
+        LOG_WARNING(QString("Failed to register io_uring receive buffers (%1), falling back to Qt sockets")
+                    .arg(strerror(-result)));
+        _ring.close();
+        return false;
+    }
+
+    _eventFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (_eventFd < 0 || _ring.registerEventFd(_eventFd) < 0) {
+        LOG_WARNING("Failed to register io_uring completion eventfd, falling back to Qt sockets");
+        if (_eventFd >= 0) {
+            ::close(_eventFd);
+            _eventFd = -1;
+        }
+        _ring.close();
+        return false;
+    }
+
+    // 完成通知进入Qt事件循环，回调都在本线程中执行
+    _notifier = new QSocketNotifier(_eventFd, QSocketNotifier::Read, this);
+    connect(_notifier, &QSocketNotifier::activated, this, &IoUringTransport::onCompletion);
+
+    LOG_INFO(QString("io_uring transport enabled: queueDepth=%1, buffers=%2x%3")
+             .arg(_config.queueDepth).arg(_ring.bufferCount()).arg(_ring.bufferSize()));
+    return true;
+#else
+    LOG_WARNING("io_uring transport is only available on Linux, falling back to Qt sockets");
+    return false;
+#endif
+}
+
+void IoUringTransport::shutdown()
+{
+    _accepting = false;
+    _acceptArmed = false;
+
+    if (_notifier) {
+        _notifier->setEnabled(false);
+        _notifier->deleteLater();
+        _notifier = nullptr;
+    }
+
+    // 先销毁环，内核不再访问发送数据后再释放连接
+    _ring.close();
+
+#ifdef Q_OS_LINUX
+    QMutexLocker locker(&_mutex);
+    for (Connection *connection : _connections) {
+        ::close(connection->fd);
+        delete connection;
+    }
+    _connections.clear();
+    _dirtyConnections.clear();
+
+    if (_eventFd >= 0) {
+        ::close(_eventFd);
+        _eventFd = -1;
+    }
+#endif
+}
+
+bool IoUringTransport::startAccepting(qintptr listenDescriptor)
+{
+    if (!isEnabled() || listenDescriptor < 0) {
+        return false;
+    }
+
+    _listenDescriptor = listenDescriptor;
+    _accepting = true;
+    if (!armAccept()) {
+        _accepting = false;
+        return false;
+    }
+
+    submitPending();
+    return true;
+}
+
+void IoUringTransport::stopAccepting()
+{
+#ifdef Q_OS_LINUX
+    if (!_accepting) {
+        return;
+    }
+    _accepting = false;
+
+    if (_acceptArmed) {
+        io_uring_sqe *sqe = nextSqe();
+        if (sqe) {
+            sqe->opcode = IORING_OP_ASYNC_CANCEL;
+            sqe->fd = -1;
+            sqe->addr = encodeUserData(0, AcceptOperation);
+            sqe->user_data = encodeUserData(0, CancelOperation);
+            submitPending();
+        }
+    }
+#endif
+}
+
+quint32 IoUringTransport::open(qintptr socketDescriptor, Receiver *receiver)
+{
+    if (!isEnabled() || socketDescriptor < 0 || !receiver) {
+        return 0;
+    }
+
+    QMutexLocker locker(&_mutex);
+
+    quint32 connectionId = _nextConnectionId++;
+    if (connectionId == 0) {
+        connectionId = _nextConnectionId++;
+    }
+
+    Connection *connection = new Connection;
+    connection->fd = static_cast<int>(socketDescriptor);
+    connection->receiver = receiver;
+    _connections.insert(connectionId, connection);
+
+    if (!armRecvLocked(connectionId, connection)) {
+        _connections.remove(connectionId);
+        delete connection;
+        return 0;
+    }
+
+    locker.unlock();
+    submitPending();
+    return connectionId;
+}
+
+bool IoUringTransport::send(quint32 connectionId, const QByteArray &data)
+{
+    if (data.isEmpty()) {
+        return true;
+    }
+
+    {
+        QMutexLocker locker(&_mutex);
+        Connection *connection = _connections.value(connectionId, nullptr);
+        if (!connection || connection->closing || connection->socketShutdown) {
+            return false;
+        }
+
+        connection->frames.append(data);
+        connection->queuedBytes += data.size();
+        _dirtyConnections.insert(connectionId);
+    }
+
+    // 同一事件循环周期内的发送合并到一次提交
+    scheduleFlush();
+    return true;
+}
+
+qint64 IoUringTransport::pendingBytes(quint32 connectionId) const
+{
+    QMutexLocker locker(&_mutex);
+    Connection *connection = _connections.value(connectionId, nullptr);
+    return connection ? connection->queuedBytes : 0;
+}
+
+void IoUringTransport::close(quint32 connectionId, bool flushPending)
+{
+    QMutexLocker locker(&_mutex);
+
+    Connection *connection = _connections.value(connectionId, nullptr);
+    if (!connection || connection->closing) {
+        return;
+    }
+
+    connection->closing = true;
+    connection->receiver = nullptr;
+
+    if (flushPending && !connection->frames.isEmpty() && !connection->socketShutdown) {
+        // 发完排队的数据后在handleSend中关闭
+        if (!connection->sending) {
+            _dirtyConnections.insert(connectionId);
+            locker.unlock();
+            scheduleFlush();
+        }
+        return;
+    }
+
+    // 丢弃尚未交给内核的帧，正在发送的帧须保留到完成
+    while (connection->frames.size() > connection->framesInFlight) {
+        connection->queuedBytes -= connection->frames.takeLast().size();
+    }
+    if (!connection->sending) {
+        connection->frames.clear();
+        connection->queuedBytes = 0;
+        connection->headOffset = 0;
+    }
+
+    shutdownSocketLocked(connection);
+    releaseIfIdleLocked(connectionId);
+}
+
+QHostAddress IoUringTransport::peerAddressOf(qintptr socketDescriptor)
+{
+#ifdef Q_OS_LINUX
+    sockaddr_storage address;
+    memset(&address, 0, sizeof(address));
+    socklen_t addressLength = sizeof(address);
+    if (::getpeername(static_cast<int>(socketDescriptor), reinterpret_cast<sockaddr*>(&address), &addressLength) == 0) {
+        return QHostAddress(reinterpret_cast<sockaddr*>(&address));
+    }
+#else
+    Q_UNUSED(socketDescriptor)
+#endif
+    return QHostAddress();
+}
+
+QJsonObject IoUringTransport::getStatistics() const
+{
+    QMutexLocker locker(&_mutex);
+
+    QJsonObject stats;
+    stats["enabled"] = isEnabled();
+    stats["accepting"] = _accepting;
+    stats["connections"] = _connections.size();
+    stats["queue_depth"] = _config.queueDepth;
+    stats["recv_buffer_count"] = _ring.bufferCount();
+    stats["recv_buffer_size"] = _ring.bufferSize();
+    stats["accepted"] = _accepted;
+    stats["enter_calls"] = _enterCalls;
+    stats["sqes_submitted"] = _sqesSubmitted;
+    stats["sqes_per_enter"] = _enterCalls > 0 ? static_cast<double>(_sqesSubmitted) / _enterCalls : 0.0;
+    stats["completions"] = _completions;
+    stats["recv_completions"] = _recvCompletions;
+    stats["bytes_received"] = _bytesReceived;
+    stats["send_operations"] = _sendOperations;
+    stats["frames_sent"] = _framesSent;
+    stats["frames_per_send"] = _sendOperations > 0 ? static_cast<double>(_framesSent) / _sendOperations : 0.0;
+    stats["bytes_sent"] = _bytesSent;
+    stats["recv_buffer_exhausted"] = _bufferExhausted;
+    return stats;
+}
+
+void IoUringTransport::onCompletion()
+{
+#ifdef Q_OS_LINUX
+    quint64 value = 0;
+    if (::read(_eventFd, &value, sizeof(value)) < 0 && errno != EAGAIN) {
+        LOG_WARNING(QString("Failed to read io_uring eventfd: %1").arg(strerror(errno)));
+    }
+
+    _ring.flushOverflow();
+
+    while (io_uring_cqe *cqe = _ring.peekCqe()) {
+        quint64 userData = cqe->user_data;
+        int result = cqe->res;
+        quint32 flags = cqe->flags;
+        _ring.cqeSeen();
+        ++_completions;
+
+        quint32 connectionId = static_cast<quint32>(userData >> 8);
+        switch (static_cast<int>(userData & 0xff)) {
+        case AcceptOperation:
+            handleAccept(result, flags);
+            break;
+        case RecvOperation:
+            handleRecv(connectionId, result, flags);
+            break;
+        case SendOperation:
+            handleSend(connectionId, result);
+            break;
+        default:
+            break;
+        }
+    }
+
+    // 本批处理中归还的缓冲区一起发布，重新挂起的recv随后提交
+    _ring.commitBuffers();
+    submitPending();
+#endif
+}
+
+void IoUringTransport::flushSends()
+{
+    _flushScheduled.storeRelease(0);
+
+    {
+        QMutexLocker locker(&_mutex);
+        for (quint32 connectionId : _dirtyConnections) {
+            Connection *connection = _connections.value(connectionId, nullptr);
+            if (connection && !connection->sending) {
+                submitSendLocked(connectionId, connection);
+            }
+        }
+        _dirtyConnections.clear();
+    }
+
+    submitPending();
+}
+
+void IoUringTransport::scheduleFlush()
+{
+    if (_flushScheduled.testAndSetOrdered(0, 1)) {
+        QMetaObject::invokeMethod(this, "flushSends", Qt::QueuedConnection);
+    }
+}
+
+io_uring_sqe *IoUringTransport::nextSqe()
+{
+    io_uring_sqe *sqe = _ring.getSqe();
+    if (!sqe) {
+        submitPending();
+        sqe = _ring.getSqe();
+        if (!sqe) {
+            LOG_WARNING("io_uring submission queue is full");
+        }
+    }
+    return sqe;
+}
+
+void IoUringTransport::submitPending()
+{
+    if (_ring.pendingSubmissions() == 0) {
+        return;
+    }
+
+    int submitted = _ring.submit();
+    if (submitted < 0) {
+        LOG_WARNING(QString("io_uring submit failed: %1").arg(strerror(-submitted)));
+        return;
+    }
+    ++_enterCalls;
+    _sqesSubmitted += submitted;
+}
+
+bool IoUringTransport::armAccept()
+{
+#ifdef Q_OS_LINUX
+    io_uring_sqe *sqe = nextSqe();
+    if (!sqe) {
+        return false;
+    }
+
+    sqe->opcode = IORING_OP_ACCEPT;
+    sqe->fd = static_cast<int>(_listenDescriptor);
+    sqe->ioprio = IORING_ACCEPT_MULTISHOT;
+    sqe->accept_flags = SOCK_CLOEXEC;
+    sqe->user_data = encodeUserData(0, AcceptOperation);
+    _acceptArmed = true;
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool IoUringTransport::armRecvLocked(quint32 connectionId, Connection *connection)
+{
+#ifdef Q_OS_LINUX
+    io_uring_sqe *sqe = nextSqe();
+    if (!sqe) {
+        return false;
+    }
+
+    sqe->opcode = IORING_OP_RECV;
+    sqe->fd = connection->fd;
+    sqe->ioprio = IORING_RECV_MULTISHOT;
+    sqe->flags = IOSQE_BUFFER_SELECT;
+    sqe->buf_group = RECV_BUFFER_GROUP;
+    sqe->user_data = encodeUserData(connectionId, RecvOperation);
+    connection->recvArmed = true;
+    return true;
+#else
+    Q_UNUSED(connectionId)
+    Q_UNUSED(connection)
+    return false;
+#endif
+}
+
+bool IoUringTransport::submitSendLocked(quint32 connectionId, Connection *connection)
+{
+#ifdef Q_OS_LINUX
+    if (connection->frames.isEmpty() || connection->socketShutdown) {
+        return false;
+    }
+
+    // 排队的帧合并为一次sendmsg，帧数据在完成前由frames保持有效
+    int count = qMin(connection->frames.size(), _config.maxBatchFrames);
+    for (int i = 0; i < count; ++i) {
+        const QByteArray &frame = connection->frames.at(i);
+        qint64 offset = i == 0 ? connection->headOffset : 0;
+        connection->iov[i].iov_base = const_cast<char*>(frame.constData()) + offset;
+        connection->iov[i].iov_len = static_cast<size_t>(frame.size() - offset);
+    }
+    memset(&connection->message, 0, sizeof(connection->message));
+    connection->message.msg_iov = connection->iov;
+    connection->message.msg_iovlen = static_cast<size_t>(count);
+
+    io_uring_sqe *sqe = nextSqe();
+    if (!sqe) {
+        _dirtyConnections.insert(connectionId);
+        return false;
+    }
+
+    sqe->opcode = IORING_OP_SENDMSG;
+    sqe->fd = connection->fd;
+    sqe->addr = reinterpret_cast<quint64>(&connection->message);
+    sqe->len = 1;
+    sqe->msg_flags = MSG_NOSIGNAL;
+    sqe->user_data = encodeUserData(connectionId, SendOperation);
+
+    connection->sending = true;
+    connection->framesInFlight = count;
+    ++_sendOperations;
+    return true;
+#else
+    Q_UNUSED(connectionId)
+    Q_UNUSED(connection)
+    return false;
+#endif
+}
+
+void IoUringTransport::shutdownSocketLocked(Connection *connection)
+{
+#ifdef Q_OS_LINUX
+    // 关闭读写两端后挂起的recv以EOF完成、发送以错误完成，连接随后被释放
+    if (!connection->socketShutdown) {
+        ::shutdown(connection->fd, SHUT_RDWR);
+        connection->socketShutdown = true;
+    }
+#else
+    Q_UNUSED(connection)
+#endif
+}
+
+void IoUringTransport::releaseIfIdleLocked(quint32 connectionId)
+{
+    Connection *connection = _connections.value(connectionId, nullptr);
+    if (!connection || !connection->closing || !connection->socketShutdown
+        || connection->recvArmed || connection->sending) {
+        return;
+    }
+
+#ifdef Q_OS_LINUX
+    ::close(connection->fd);
+#endif
+    _connections.remove(connectionId);
+    _dirtyConnections.remove(connectionId);
+    delete connection;
+}
+
+void IoUringTransport::handleAccept(int result, quint32 flags)
+{
+#ifdef Q_OS_LINUX
+    if (!(flags & IORING_CQE_F_MORE)) {
+        _acceptArmed = false;
+    }
+
+    if (result >= 0) {
+        if (_accepting) {
+            ++_accepted;
+            emit connectionAccepted(result);
+        } else {
+            ::close(result);
+        }
+    } else if (result != -ECANCELED) {
+        LOG_WARNING(QString("io_uring accept failed: %1").arg(strerror(-result)));
+    }
+
+    if (!_acceptArmed && _accepting) {
+        if (result >= 0) {
+            armAccept();
+        } else {
+            // 描述符耗尽等错误时稍后重试，避免空转
+            QTimer::singleShot(100, this, [this]() {
+                if (_accepting && !_acceptArmed && armAccept()) {
+                    submitPending();
+                }
+            });
+        }
+    }
+#else
+    Q_UNUSED(result)
+    Q_UNUSED(flags)
+#endif
+}
+
+void IoUringTransport::handleRecv(quint32 connectionId, int result, quint32 flags)
+{
+#ifdef Q_OS_LINUX
+    bool hasBuffer = flags & IORING_CQE_F_BUFFER;
+    quint16 bufferId = static_cast<quint16>(flags >> IORING_CQE_BUFFER_SHIFT);
+
+    QMutexLocker locker(&_mutex);
+
+    Connection *connection = _connections.value(connectionId, nullptr);
+    if (!connection) {
+        if (hasBuffer) {
+            _ring.recycleBuffer(bufferId);
+        }
+        return;
+    }
+
+    if (!(flags & IORING_CQE_F_MORE)) {
+        connection->recvArmed = false;
+    }
+
+    if (result > 0 && hasBuffer) {
+        ++_recvCompletions;
+        _bytesReceived += result;
+        if (!connection->recvArmed && !connection->socketShutdown) {
+            armRecvLocked(connectionId, connection);
+        }
+        Receiver *receiver = connection->closing ? nullptr : connection->receiver;
+        locker.unlock();
+
+        // 接收者同步复制数据后立即归还缓冲区
+        if (receiver) {
+            receiver->onTransportData(_ring.buffer(bufferId), result);
+        }
+        _ring.recycleBuffer(bufferId);
+        return;
+    }
+
+    if (hasBuffer) {
+        _ring.recycleBuffer(bufferId);
+    }
+
+    if (result == -ENOBUFS) {
+        // 缓冲区暂时用尽，本批归还的缓冲区发布后重新挂起
+        ++_bufferExhausted;
+        if (!connection->recvArmed && !connection->socketShutdown) {
+            armRecvLocked(connectionId, connection);
+        }
+        return;
+    }
+
+    if (connection->recvArmed) {
+        return;
+    }
+
+    // EOF或错误：关闭套接字使未完成的发送尽快结束
+    shutdownSocketLocked(connection);
+    Receiver *receiver = connection->closing ? nullptr : connection->receiver;
+    releaseIfIdleLocked(connectionId);
+    locker.unlock();
+
+    if (receiver) {
+        receiver->onTransportClosed();
+    }
+#else
+    Q_UNUSED(connectionId)
+    Q_UNUSED(result)
+    Q_UNUSED(flags)
+#endif
+}
+
+void IoUringTransport::handleSend(quint32 connectionId, int result)
+{
+    QMutexLocker locker(&_mutex);
+
+    Connection *connection = _connections.value(connectionId, nullptr);
+    if (!connection) {
+        return;
+    }
+
+    connection->sending = false;
+    connection->framesInFlight = 0;
+
+    if (result > 0) {
+        qint64 remaining = result;
+        while (remaining > 0 && !connection->frames.isEmpty()) {
+            qint64 frameRemaining = connection->frames.first().size() - connection->headOffset;
+            if (remaining >= frameRemaining) {
+                remaining -= frameRemaining;
+                connection->frames.removeFirst();
+                connection->headOffset = 0;
+                ++_framesSent;
+            } else {
+                connection->headOffset += remaining;
+                remaining = 0;
+            }
+        }
+        connection->queuedBytes -= result;
+        _bytesSent += result;
+    } else {
+        // 发送失败：丢弃剩余数据并关闭，接收端随后报告连接关闭
+        connection->frames.clear();
+        connection->queuedBytes = 0;
+        connection->headOffset = 0;
+        shutdownSocketLocked(connection);
+    }
+
+    if (!connection->frames.isEmpty()) {
+        submitSendLocked(connectionId, connection);
+    } else if (connection->closing) {
+        shutdownSocketLocked(connection);
+    }
+
+    Receiver *receiver = connection->closing ? nullptr : connection->receiver;
+    releaseIfIdleLocked(connectionId);
+    locker.unlock();
+
+    if (receiver && result > 0) {
+        receiver->onTransportBytesWritten(result);
+    }
+}
@@ -0,0 +1,201 @@
+#ifndef IOURINGTRANSPORT_H
+#define IOURINGTRANSPORT_H
+
+#include <QObject>
+#include <QHash>
+#include <QSet>
+#include <QMutex>
+#include <QAtomicInt>
+#include <QByteArray>
+#include <QHostAddress>
+#include <QJsonObject>
+#include "IoUring.h"
+
+class QSocketNotifier;
+
+/**
+ * @brief 基于io_uring的明文TCP传输
+ *
+ * 替代Qt套接字的就绪通知模型：监听套接字上挂一个多次触发的accept，
+ * 每个连接挂一个多次触发的recv并从共享的提供缓冲区环中取缓冲区，
+ * 一个事件循环周期内产生的所有发送合并为每连接一个sendmsg，并通过一次io_uring_enter提交。
+ * 完成通知经eventfd进入Qt事件循环，因此所有回调都在传输所在的线程中执行。
+ *
+ * open()/close()/startAccepting()须在传输所在线程调用；send()/pendingBytes()可在任意线程调用。
+ * 需要Linux 6.0+，初始化失败时服务器继续使用Qt套接字。
+ */
+class IoUringTransport : public QObject
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @brief io_uring传输配置
+     */
+    struct Config {
+        bool enabled = false;
+        int queueDepth = 2048;          // 提交队列深度
+        int bufferCount = 4096;         // 接收缓冲区数量（向上取整为2的幂）
+        int bufferSize = 16384;         // 单个接收缓冲区大小
+        int maxBatchFrames = 64;        // 单次sendmsg合并的最大帧数
+    };
+
+    /**
+     * @brief 连接事件接收者，回调在传输所在线程中执行
+     */
+    class Receiver
+    {
+    public:
+        virtual ~Receiver() = default;
+
+        /**
+         * @brief 收到数据，data仅在回调期间有效
+         */
+        virtual void onTransportData(const char *data, qint64 length) = 0;
+
+        /**
+         * @brief 内核已接收指定字节数的发送数据
+         */
+        virtual void onTransportBytesWritten(qint64 bytes) = 0;
+
+        /**
+         * @brief 对端关闭或连接出错
+         */
+        virtual void onTransportClosed() = 0;
+    };
+
+    explicit IoUringTransport(QObject *parent = nullptr);
+    ~IoUringTransport();
+
+    /**
+     * @brief 初始化传输
+     * @return 是否启用，失败时调用者应继续使用Qt套接字
+     */
+    bool initialize(const Config &config);
+
+    /**
+     * @brief 关闭所有连接并销毁环
+     */
+    void shutdown();
+
+    bool isEnabled() const { return _ring.isValid(); }
+
+    /**
+     * @brief 在监听套接字上开始接受连接，新连接通过connectionAccepted信号发出
+     */
+    bool startAccepting(qintptr listenDescriptor);
+
+    /**
+     * @brief 停止接受连接
+     */
+    void stopAccepting();
+
+    /**
+     * @brief 接管已连接的套接字描述符并开始接收
+     * @return 连接ID，失败时返回0（描述符仍归调用者所有）
+     */
+    quint32 open(qintptr socketDescriptor, Receiver *receiver);
+
+    /**
+     * @brief 追加发送数据，在下一个事件循环周期批量提交
+     * @return 连接不存在或已关闭时返回false
+     */
+    bool send(quint32 connectionId, const QByteArray &data);
+
+    /**
+     * @brief 已提交但内核尚未接收的字节数
+     */
+    qint64 pendingBytes(quint32 connectionId) const;
+
+    /**
+     * @brief 关闭连接，之后不再回调接收者
+     * @param connectionId 连接ID
+     * @param flushPending 是否先发完排队的数据
+     */
+    void close(quint32 connectionId, bool flushPending);
+
+    /**
+     * @brief 获取套接字描述符的对端地址
+     */
+    static QHostAddress peerAddressOf(qintptr socketDescriptor);
+
+    /**
+     * @brief 获取传输统计信息
+     */
+    QJsonObject getStatistics() const;
+
+signals:
+    /**
+     * @brief 接受了新连接
+     */
+    void connectionAccepted(qintptr socketDescriptor);
+
+private slots:
+    void onCompletion();
+    void flushSends();
+
+private:
+    struct Connection;
+
+    enum Operation {
+        AcceptOperation = 1,
+        RecvOperation,
+        SendOperation,
+        CancelOperation
+    };
+
+    /**
+     * @brief 获取提交项，队列满时先提交已有的提交项
+     */
+    io_uring_sqe *nextSqe();
+
+    /**
+     * @brief 提交所有已填写的提交项
+     */
+    void submitPending();
+
+    bool armAccept();
+    bool armRecvLocked(quint32 connectionId, Connection *connection);
+    bool submitSendLocked(quint32 connectionId, Connection *connection);
+    void shutdownSocketLocked(Connection *connection);
+
+    /**
+     * @brief 没有未完成的操作时释放已关闭的连接，调用者需持有锁
+     */
+    void releaseIfIdleLocked(quint32 connectionId);
+
+    void handleAccept(int result, quint32 flags);
+    void handleRecv(quint32 connectionId, int result, quint32 flags);
+    void handleSend(quint32 connectionId, int result);
+
+    void scheduleFlush();
+
+    Config _config;
+    IoUring _ring;
+    int _eventFd;
+    QSocketNotifier *_notifier;
+
+    qintptr _listenDescriptor;
+    bool _accepting;
+    bool _acceptArmed;
+
+    mutable QMutex _mutex;
+    QHash<quint32, Connection*> _connections;
+    QSet<quint32> _dirtyConnections;
+    quint32 _nextConnectionId;
+    QAtomicInt _flushScheduled;
+
+    // 统计信息
+    qint64 _enterCalls;
+    qint64 _sqesSubmitted;
+    qint64 _completions;
+    qint64 _accepted;
+    qint64 _recvCompletions;
+    qint64 _bytesReceived;
+    qint64 _sendOperations;
+    qint64 _framesSent;
+    qint64 _bytesSent;
+    qint64 _bufferExhausted;
+};
+
+#endif // IOURINGTRANSPORT_H
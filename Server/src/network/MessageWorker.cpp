@@ -22,9 +22,8 @@ void MessageWorker::processMessageBatch()
         LOG_ERROR("MessageWorker: queue is null");
         return;
     }
-
-
     
-    // 这里的具体实现将在AsyncMessageQueue中处理
+    // 阻塞式消费循环在AsyncMessageQueue中实现，队列关闭时返回
     // MessageWorker主要负责线程管理和信号连接
+    _queue->processMessages();
 } 
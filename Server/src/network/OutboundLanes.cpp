@@ -0,0 +1,85 @@
+#include "OutboundLanes.h"
+
+OutboundLanes::OutboundLanes()
+    : _queuedBytes(0)
+{
+    for (int i = 0; i < LaneCount; ++i) {
+        _laneBytes[i] = 0;
+    }
+}
+
+OutboundLanes::EnqueueResult OutboundLanes::enqueue(Lane lane, const EncodedFrame &frame, qint64 coalesceKey,
+                                                    qint64 bulkBudget, int *droppedFrames)
+{
+    if (droppedFrames) {
+        *droppedFrames = 0;
+    }
+
+    QQueue<PendingFrame> &queue = _lanes[lane];
+
+    // 批量通道中同一合并键只保留最新一帧，保持原有排队位置
+    if (lane == BulkLane && coalesceKey >= 0) {
+        for (PendingFrame &pending : queue) {
+            if (pending.coalesceKey == coalesceKey) {
+                qint64 delta = frame.size() - pending.frame.size();
+                pending.frame = frame;
+                _laneBytes[lane] += delta;
+                _queuedBytes += delta;
+                return Coalesced;
+            }
+        }
+    }
+
+    PendingFrame pending;
+    pending.frame = frame;
+    pending.coalesceKey = coalesceKey;
+    queue.enqueue(pending);
+    _laneBytes[lane] += frame.size();
+    _queuedBytes += frame.size();
+
+    // 批量通道超出预算时丢弃最旧的帧，至少保留刚入队的一帧
+    if (lane == BulkLane) {
+        while (_laneBytes[lane] > bulkBudget && queue.size() > 1) {
+            PendingFrame dropped = queue.dequeue();
+            _laneBytes[lane] -= dropped.frame.size();
+            _queuedBytes -= dropped.frame.size();
+            if (droppedFrames) {
+                ++*droppedFrames;
+            }
+        }
+    }
+
+    return Queued;
+}
+
+EncodedFrame OutboundLanes::takeNext()
+{
+    for (int i = 0; i < LaneCount; ++i) {
+        if (!_lanes[i].isEmpty()) {
+            PendingFrame pending = _lanes[i].dequeue();
+            _laneBytes[i] -= pending.frame.size();
+            _queuedBytes -= pending.frame.size();
+            return pending.frame;
+        }
+    }
+    return EncodedFrame();
+}
+
+void OutboundLanes::clear()
+{
+    for (int i = 0; i < LaneCount; ++i) {
+        _lanes[i].clear();
+        _laneBytes[i] = 0;
+    }
+    _queuedBytes = 0;
+}
+
+const char* OutboundLanes::laneName(Lane lane)
+{
+    switch (lane) {
+    case ControlLane: return "control";
+    case ChatLane: return "chat";
+    case BulkLane: return "bulk";
+    default: return "unknown";
+    }
+}
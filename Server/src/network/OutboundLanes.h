@@ -0,0 +1,113 @@
+#ifndef OUTBOUNDLANES_H
+#define OUTBOUNDLANES_H
+
+#include <QQueue>
+#include "EncodedFrame.h"
+
+/**
+ * @brief 单连接的出站优先级通道
+ *
+ * 套接字写缓冲区超过水位线后，新帧不再直接写入套接字，而是按类别进入三个通道排队，
+ * 写缓冲区回落后按 控制 > 聊天 > 批量 的顺序补写：
+ * - 控制通道：认证响应、错误、断开通知等，从不丢弃
+ * - 聊天通道：聊天消息和好友通知，从不丢弃
+ * - 批量通道：在线状态等可替代的消息，同一合并键只保留最新一帧，超出预算时丢弃最旧的帧
+ *
+ * 控制或聊天通道超出预算不会丢帧，但会使连接进入慢消费者状态，由ClientHandler决定是否断开。
+ * 该类不是线程安全的，只能在连接所属线程中使用。
+ */
+class OutboundLanes
+{
+public:
+    /**
+     * @brief 出站通道
+     */
+    enum Lane {
+        ControlLane = 0,
+        ChatLane,
+        BulkLane,
+        LaneCount
+    };
+
+    /**
+     * @brief 出站配置
+     */
+    struct Config {
+        qint64 writeWatermark = 64 * 1024;      // 套接字写缓冲区超过该值时开始排队
+        qint64 controlBudget = 256 * 1024;      // 控制通道预算
+        qint64 chatBudget = 2 * 1024 * 1024;    // 聊天通道预算
+        qint64 bulkBudget = 128 * 1024;         // 批量通道预算，超出时丢弃最旧的帧
+        qint64 hardLimit = 8 * 1024 * 1024;     // 写缓冲区与排队字节之和的上限
+        int slowConsumerTimeoutMs = 30000;      // 持续超限超过该时长后断开连接
+    };
+
+    /**
+     * @brief 入队结果
+     */
+    enum EnqueueResult {
+        Queued,       // 追加到通道末尾
+        Coalesced     // 替换了同一合并键的待发送帧
+    };
+
+    OutboundLanes();
+
+    /**
+     * @brief 帧入队
+     * @param lane 通道
+     * @param frame 已编码的帧
+     * @param coalesceKey 合并键（仅批量通道有效），<0表示不合并
+     * @param bulkBudget 批量通道预算
+     * @param droppedFrames 输出因预算被丢弃的帧数
+     * @return 入队结果
+     */
+    EnqueueResult enqueue(Lane lane, const EncodedFrame &frame, qint64 coalesceKey,
+                          qint64 bulkBudget, int *droppedFrames);
+
+    /**
+     * @brief 按优先级取出下一帧
+     * @return 下一帧，通道全部为空时返回空帧
+     */
+    EncodedFrame takeNext();
+
+    /**
+     * @brief 所有通道是否为空
+     */
+    bool isEmpty() const { return _queuedBytes == 0; }
+
+    /**
+     * @brief 排队字节总数
+     */
+    qint64 queuedBytes() const { return _queuedBytes; }
+
+    /**
+     * @brief 指定通道的排队字节数
+     */
+    qint64 laneBytes(Lane lane) const { return _laneBytes[lane]; }
+
+    /**
+     * @brief 指定通道的排队帧数
+     */
+    int laneFrames(Lane lane) const { return _lanes[lane].size(); }
+
+    /**
+     * @brief 丢弃所有排队的帧
+     */
+    void clear();
+
+    static const char* laneName(Lane lane);
+
+private:
+    /**
+     * @brief 待发送帧
+     */
+    struct PendingFrame {
+        EncodedFrame frame;
+        qint64 coalesceKey;
+    };
+
+    QQueue<PendingFrame> _lanes[LaneCount];
+    qint64 _laneBytes[LaneCount];
+    qint64 _queuedBytes;
+};
+
+#endif // OUTBOUNDLANES_H
@@ -4,7 +4,9 @@
 #include "../utils/Logger.h"
 #include "../utils/Crypto.h"
 #include "../utils/Validator.h"
+#include "../monitoring/Tracer.h"
 #include "../auth/UserRegistrationService.h"
+#include "ProtocolMessages.h"
 #include <QDateTime>
 #include <QSqlQuery>
 #include <QMutexLocker>
@@ -53,6 +55,8 @@ ProtocolHandler::~ProtocolHandler()
 
 QJsonObject ProtocolHandler::handleMessage(const QJsonObject &message, const QString &clientId, const QString &clientIP)
 {
+    TRACE_SPAN("ProtocolHandler::handleMessage");
+
     QString action = message["action"].toString();
     QString requestId = message["request_id"].toString();
     
@@ -101,15 +105,16 @@ QJsonObject ProtocolHandler::handleLoginRequest(const QJsonObject &request, cons
     QString requestId = request["request_id"].toString();
     QString action = request["action"].toString();
     
-    // 验证请求格式
-    auto validation = validateRequest(request, {"username", "password"});
-    if (!validation.first) {
-        return createErrorResponse(requestId, action, "VALIDATION_ERROR", validation.second);
+    // 解码并验证请求格式
+    Protocol::LoginRequest params;
+    QString validationError;
+    if (!Protocol::LoginRequest::fromJson(request, &params, &validationError)) {
+        return createErrorResponse(requestId, action, "VALIDATION_ERROR", validationError);
     }
     
-    QString username = request["username"].toString();
-    QString password = request["password"].toString();
-    bool rememberMe = request["remember_me"].toBool();
+    const QString &username = params.username;
+    const QString &password = params.password;
+    bool rememberMe = params.rememberMe;
     
     // 进行用户认证
     auto authResult = _userService->authenticateUser(username, password);
@@ -179,17 +184,18 @@ QJsonObject ProtocolHandler::handleRegisterRequest(const QJsonObject &request, c
         LOG_INFO(QString("Registration request marked as processing: %1 from %2").arg(requestId).arg(clientIP));
     }
     
-    // 验证请求格式
-    auto validation = validateRequest(request, {"username", "email", "password", "verification_code"});
-    if (!validation.first) {
-        return createErrorResponse(requestId, action, "VALIDATION_ERROR", validation.second);
+    // 解码并验证请求格式
+    Protocol::RegisterRequest params;
+    QString validationError;
+    if (!Protocol::RegisterRequest::fromJson(request, &params, &validationError)) {
+        return createErrorResponse(requestId, action, "VALIDATION_ERROR", validationError);
     }
     
-    QString username = request["username"].toString();
-    QString email = request["email"].toString();
-    QString password = request["password"].toString();
-    QString verificationCode = request["verification_code"].toString();
-    QString displayName = request["display_name"].toString(); // 可选字段
+    const QString &username = params.username;
+    const QString &email = params.email;
+    const QString &password = params.password;
+    const QString &verificationCode = params.verificationCode;
+    const QString &displayName = params.displayName; // 可选字段
     
     // 使用UserRegistrationService处理注册
     LOG_INFO(QString("Processing registration request for user: %1, email: %2, verification code: %3, request_id: %4").arg(username).arg(email).arg(verificationCode).arg(requestId));
@@ -243,14 +249,15 @@ QJsonObject ProtocolHandler::handleVerificationCodeRequest(const QJsonObject &re
     QString requestId = request["request_id"].toString();
     QString action = request["action"].toString();
     
-    // 验证请求格式
-    auto validation = validateRequest(request, {"email"});
-    if (!validation.first) {
-        LOG_WARNING(QString("Invalid verification code request format from %1: %2").arg(clientIP).arg(validation.second));
-        return createErrorResponse(requestId, action, "VALIDATION_ERROR", validation.second);
+    // 解码并验证请求格式
+    Protocol::VerificationCodeRequest params;
+    QString validationError;
+    if (!Protocol::VerificationCodeRequest::fromJson(request, &params, &validationError)) {
+        LOG_WARNING(QString("Invalid verification code request format from %1: %2").arg(clientIP).arg(validationError));
+        return createErrorResponse(requestId, action, "VALIDATION_ERROR", validationError);
     }
     
-    QString email = request["email"].toString();
+    QString email = params.email;
     
     // 请求去重检查
     {
@@ -327,7 +334,12 @@ QJsonObject ProtocolHandler::handleHeartbeatRequest(const QJsonObject &request,
     QString action = request["action"].toString();
     
     // 从请求中获取用户ID
-    qint64 userId = request["user_id"].toVariant().toLongLong();
+    Protocol::HeartbeatRequest params;
+    QString validationError;
+    if (!Protocol::HeartbeatRequest::fromJson(request, &params, &validationError)) {
+        return createErrorResponse(requestId, action, "VALIDATION_ERROR", validationError);
+    }
+    qint64 userId = params.userId;
     
     if (userId <= 0) {
         LOG_ERROR(QString("Invalid user_id in heartbeat request: %1").arg(userId));
@@ -380,17 +392,6 @@ QJsonObject ProtocolHandler::handleLogoutRequest(const QJsonObject &request, con
     return createSuccessResponse(requestId, action, responseData);
 }
 
-QPair<bool, QString> ProtocolHandler::validateRequest(const QJsonObject &request, const QStringList &requiredFields)
-{
-    for (const QString &field : requiredFields) {
-        if (!request.contains(field) || request[field].toString().trimmed().isEmpty()) {
-            return qMakePair(false, QString("Missing or empty field: %1").arg(field));
-        }
-    }
-    
-    return qMakePair(true, "");
-}
-
 ProtocolHandler::MessageType ProtocolHandler::getMessageType(const QString &action)
 {
     if (action == "login") return Login;
@@ -402,8 +403,9 @@ ProtocolHandler::MessageType ProtocolHandler::getMessageType(const QString &acti
 
     // 聊天相关的动作
     if (action.startsWith("friend_") || action.startsWith("message_") ||
-        action.startsWith("status_") || action == "send_message" ||
-        action == "get_chat_history" || action == "get_chat_sessions") {
+        action.startsWith("status_") || action.startsWith("group_") ||
+        action == "send_message" || action == "send_ephemeral" ||
+        action == "get_chat_history" || action == "get_chat_sessions" || action == "bootstrap") {
         return Chat;
     }
 
@@ -523,14 +525,15 @@ QJsonObject ProtocolHandler::handleCheckUsernameRequest(const QJsonObject &reque
     QString requestId = request["request_id"].toString();
     QString action = request["action"].toString();
     
-    // 验证请求格式
-    auto validation = validateRequest(request, {"username"});
-    if (!validation.first) {
-        LOG_WARNING(QString("Invalid check username request format from %1: %2").arg(clientIP).arg(validation.second));
-        return createErrorResponse(requestId, action, "VALIDATION_ERROR", validation.second);
+    // 解码并验证请求格式
+    Protocol::CheckUsernameRequest params;
+    QString validationError;
+    if (!Protocol::CheckUsernameRequest::fromJson(request, &params, &validationError)) {
+        LOG_WARNING(QString("Invalid check username request format from %1: %2").arg(clientIP).arg(validationError));
+        return createErrorResponse(requestId, action, "VALIDATION_ERROR", validationError);
     }
     
-    QString username = request["username"].toString();
+    QString username = params.username;
     
     // 验证用户名格式
     if (!Validator::isValidUsername(username)) {
@@ -562,14 +565,15 @@ QJsonObject ProtocolHandler::handleCheckEmailRequest(const QJsonObject &request,
     QString requestId = request["request_id"].toString();
     QString action = request["action"].toString();
     
-    // 验证请求格式
-    auto validation = validateRequest(request, {"email"});
-    if (!validation.first) {
-        LOG_WARNING(QString("Invalid check email request format from %1: %2").arg(clientIP).arg(validation.second));
-        return createErrorResponse(requestId, action, "VALIDATION_ERROR", validation.second);
+    // 解码并验证请求格式
+    Protocol::CheckEmailRequest params;
+    QString validationError;
+    if (!Protocol::CheckEmailRequest::fromJson(request, &params, &validationError)) {
+        LOG_WARNING(QString("Invalid check email request format from %1: %2").arg(clientIP).arg(validationError));
+        return createErrorResponse(requestId, action, "VALIDATION_ERROR", validationError);
     }
     
-    QString email = request["email"].toString();
+    QString email = params.email;
     
     // 验证邮箱格式
     if (!Validator::isValidEmail(email)) {
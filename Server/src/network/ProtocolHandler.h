@@ -127,14 +127,6 @@ public:
      */
     QJsonObject handleChatMessage(const QJsonObject &request, const QString &clientId, const QString &clientIP);
     
-    /**
-     * @brief 验证请求格式
-     * @param request 请求消息
-     * @param requiredFields 必需字段列表
-     * @return 验证结果和错误信息
-     */
-    QPair<bool, QString> validateRequest(const QJsonObject &request, const QStringList &requiredFields);
-    
     /**
      * @brief 获取消息类型
      * @param action 动作字符串
@@ -0,0 +1,498 @@
+#include "RequestExecutor.h"
+#include "../database/DatabaseConnectionPool.h"
+#include "../utils/Logger.h"
+#include <QJsonObject>
+#include <QSet>
+
+// 静态成员初始化
+RequestExecutor* RequestExecutor::s_instance = nullptr;
+QMutex RequestExecutor::s_instanceMutex;
+
+RequestExecutor::RequestExecutor(QObject *parent)
+    : QObject(parent)
+    , _running(0)
+    , _nextWorker(0)
+    , _pending(0)
+    , _queuedItems(0)
+    , _sleepers(0)
+    , _submitted(0)
+    , _completed(0)
+    , _rejected(0)
+    , _stolen(0)
+    , _queueWaitNs(0)
+    , _maxQueueWaitNs(0)
+{
+    _clock.start();
+}
+
+RequestExecutor::~RequestExecutor()
+{
+    shutdown();
+}
+
+RequestExecutor* RequestExecutor::instance()
+{
+    if (!s_instance) {
+        QMutexLocker locker(&s_instanceMutex);
+        if (!s_instance) {
+            s_instance = new RequestExecutor();
+        }
+    }
+    return s_instance;
+}
+
+bool RequestExecutor::initialize(const Config &config)
+{
+    if (isEnabled()) {
+        LOG_WARNING("Request executor already initialized");
+        return true;
+    }
+
+    _config = config;
+    for (int i = 0; i < StageCount; ++i) {
+        setStageConfig(static_cast<Stage>(i), _config.stages[i]);
+    }
+
+    if (!_config.enabled) {
+        LOG_INFO("Request executor disabled, requests run on connection threads");
+        return false;
+    }
+
+    int workerCount = _config.workerThreads > 0 ? _config.workerThreads : qMax(2, QThread::idealThreadCount());
+    _config.workerThreads = workerCount;
+
+    _running.storeRelease(1);
+    for (int i = 0; i < workerCount; ++i) {
+        _workers.append(new Worker());
+    }
+
+    // 工作线程运行阻塞式调度循环，不运行事件循环，因此不注册到事件循环监控
+    for (int i = 0; i < workerCount; ++i) {
+        QThread *thread = QThread::create([this, i]() { runWorker(i); });
+        thread->setObjectName(QString("request_worker_%1").arg(i));
+        _workers[i]->thread = thread;
+        thread->start();
+    }
+
+    LOG_INFO(QString("Request executor initialized with %1 worker threads").arg(workerCount));
+    return true;
+}
+
+void RequestExecutor::shutdown()
+{
+    if (!isEnabled()) {
+        return;
+    }
+
+    {
+        QMutexLocker locker(&_idleMutex);
+        _running.storeRelease(0);
+        _workAvailable.wakeAll();
+    }
+
+    for (Worker *worker : _workers) {
+        if (worker->thread) {
+            worker->thread->wait(5000);
+            delete worker->thread;
+        }
+        delete worker;
+    }
+    _workers.clear();
+
+    {
+        QMutexLocker stageLocker(&_stageMutex);
+        for (StageState &state : _stages) {
+            state.parked.clear();
+            state.active = 0;
+            state.queued = 0;
+        }
+    }
+
+    QMutexLocker locker(&_strandMutex);
+    qDeleteAll(_strands);
+    _strands.clear();
+    _pending.storeRelease(0);
+    _queuedItems.storeRelease(0);
+}
+
+quint64 RequestExecutor::userKey(qint64 userId)
+{
+    return static_cast<quint64>(userId) & 0x7fffffffffffffffULL;
+}
+
+quint64 RequestExecutor::connectionKey(const QString &clientId)
+{
+    // 最高位区分连接键与用户键
+    return 0x8000000000000000ULL | static_cast<quint64>(qHash(clientId));
+}
+
+RequestExecutor::Stage RequestExecutor::stageForAction(const QString &action)
+{
+    static const QSet<QString> authActions = {
+        "login", "register", "send_verification_code", "check_username", "check_email"
+    };
+    // 只读阶段的结果在截止后会被丢弃，会修改数据的查询（如message_offline标记delivered_at）不能放在这里
+    static const QSet<QString> readActions = {
+        "friend_search", "friend_list", "friend_requests", "friend_groups", "friend_count",
+        "get_chat_history", "get_chat_sessions", "message_search",
+        "message_unread_count", "status_get_friends", "group_list", "group_members", "group_history",
+        "bootstrap"
+    };
+
+    if (authActions.contains(action)) {
+        return AuthStage;
+    }
+    if (readActions.contains(action)) {
+        return ReadHeavyStage;
+    }
+    if (action == "send_message" || action.startsWith("friend_") || action.startsWith("message_") ||
+        action.startsWith("status_") || action.startsWith("group_")) {
+        return InteractiveWriteStage;
+    }
+    return BackgroundStage;
+}
+
+QString RequestExecutor::stageName(Stage stage)
+{
+    switch (stage) {
+    case AuthStage:
+        return "auth";
+    case InteractiveWriteStage:
+        return "interactive_write";
+    case ReadHeavyStage:
+        return "read_heavy";
+    case BackgroundStage:
+    default:
+        return "background";
+    }
+}
+
+void RequestExecutor::setStageConfig(Stage stage, const StageConfig &config)
+{
+    if (stage < 0 || stage >= StageCount) {
+        return;
+    }
+
+    DatabaseConnectionPool::instance()->setConnectionQuota(stageName(stage), config.dbConnections);
+
+    // 上限提高后立即放出暂存的调度单元，不必等执行中的请求完成
+    QList<WorkItem> released;
+    {
+        QMutexLocker locker(&_stageMutex);
+        StageState &state = _stages[stage];
+        state.config = config;
+        int freeSlots = config.maxConcurrent > 0 ? config.maxConcurrent - state.active : state.parked.size();
+        while (freeSlots-- > 0 && !state.parked.isEmpty()) {
+            released.append(state.parked.dequeue());
+        }
+    }
+
+    for (const WorkItem &item : released) {
+        push(static_cast<int>(static_cast<quint32>(_nextWorker.fetchAndAddOrdered(1)) % _workers.size()), item);
+    }
+}
+
+bool RequestExecutor::submit(Stage stage, quint64 affinityKey, QObject *context, const Work &work, const Reply &reply)
+{
+    if (!isEnabled()) {
+        QJsonObject response = work();
+        if (reply) {
+            reply(response);
+        }
+        return true;
+    }
+
+    if (_pending.loadAcquire() >= _config.maxPending) {
+        _rejected.fetchAndAddOrdered(1);
+        return false;
+    }
+
+    {
+        QMutexLocker locker(&_stageMutex);
+        StageState &state = _stages[stage];
+        if (state.config.maxQueued > 0 && state.queued >= state.config.maxQueued) {
+            ++state.rejected;
+            _rejected.fetchAndAddOrdered(1);
+            return false;
+        }
+        ++state.queued;
+        ++state.submitted;
+    }
+
+    Task task;
+    task.stage = stage;
+    task.context = context;
+    task.work = work;
+    task.reply = reply;
+    task.enqueuedNs = _clock.nsecsElapsed();
+
+    _submitted.fetchAndAddOrdered(1);
+    _pending.fetchAndAddOrdered(1);
+
+    int workerCount = _workers.size();
+    if (affinityKey == 0) {
+        WorkItem item;
+        item.strand = nullptr;
+        item.task = task;
+        push(static_cast<int>(static_cast<quint32>(_nextWorker.fetchAndAddOrdered(1)) % workerCount), item);
+        return true;
+    }
+
+    QMutexLocker locker(&_strandMutex);
+    Strand *strand = _strands.value(affinityKey, nullptr);
+    if (strand) {
+        // 链已在队列中或正在执行，由执行它的线程依次取出
+        strand->tasks.enqueue(task);
+        return true;
+    }
+
+    strand = new Strand();
+    strand->key = affinityKey;
+    strand->tasks.enqueue(task);
+    _strands.insert(affinityKey, strand);
+    locker.unlock();
+
+    WorkItem item;
+    item.strand = strand;
+    push(static_cast<int>(affinityKey % static_cast<quint64>(workerCount)), item);
+    return true;
+}
+
+void RequestExecutor::push(int index, const WorkItem &item)
+{
+    {
+        QMutexLocker locker(&_workers[index]->mutex);
+        _workers[index]->deque.push_back(item);
+    }
+    _queuedItems.fetchAndAddOrdered(1);
+
+    QMutexLocker locker(&_idleMutex);
+    if (_sleepers > 0) {
+        _workAvailable.wakeOne();
+    }
+}
+
+bool RequestExecutor::popLocal(int index, WorkItem *item)
+{
+    Worker *worker = _workers[index];
+    QMutexLocker locker(&worker->mutex);
+    if (worker->deque.empty()) {
+        return false;
+    }
+
+    // 自己的队列按先进先出处理，保持提交顺序下的尾延迟
+    *item = worker->deque.front();
+    worker->deque.pop_front();
+    _queuedItems.fetchAndSubOrdered(1);
+    return true;
+}
+
+bool RequestExecutor::steal(int thief, WorkItem *item)
+{
+    int workerCount = _workers.size();
+    for (int offset = 1; offset < workerCount; ++offset) {
+        Worker *victim = _workers[(thief + offset) % workerCount];
+        QMutexLocker locker(&victim->mutex);
+        if (victim->deque.empty()) {
+            continue;
+        }
+
+        // 从队尾窃取，与所有者在队首的操作错开
+        *item = victim->deque.back();
+        victim->deque.pop_back();
+        _queuedItems.fetchAndSubOrdered(1);
+        _stolen.fetchAndAddOrdered(1);
+        return true;
+    }
+    return false;
+}
+
+void RequestExecutor::runWorker(int index)
+{
+    while (_running.loadAcquire()) {
+        WorkItem item;
+        if (popLocal(index, &item) || steal(index, &item)) {
+            execute(index, item);
+            continue;
+        }
+
+        QMutexLocker locker(&_idleMutex);
+        if (!_running.loadAcquire()) {
+            break;
+        }
+        if (_queuedItems.loadAcquire() > 0) {
+            continue;
+        }
+        ++_sleepers;
+        _workAvailable.wait(&_idleMutex);
+        --_sleepers;
+    }
+}
+
+void RequestExecutor::execute(int index, WorkItem &item)
+{
+    QElapsedTimer timer;
+    if (!item.strand) {
+        if (!enterStage(item.task.stage, item)) {
+            return;
+        }
+        timer.start();
+        runTask(item.task);
+        leaveStage(item.task.stage, index, timer.nsecsElapsed());
+        return;
+    }
+
+    // 链按队首请求的阶段占用名额；暂存时整条链一起等待，同一用户的后续请求保持顺序
+    Strand *strand = item.strand;
+    Stage stage;
+    {
+        QMutexLocker locker(&_strandMutex);
+        stage = strand->tasks.head().stage;
+    }
+    if (!enterStage(stage, item)) {
+        return;
+    }
+
+    Task task;
+    {
+        QMutexLocker locker(&_strandMutex);
+        task = strand->tasks.dequeue();
+    }
+
+    timer.start();
+    runTask(task);
+    leaveStage(stage, index, timer.nsecsElapsed());
+
+    QMutexLocker locker(&_strandMutex);
+    if (strand->tasks.isEmpty()) {
+        _strands.remove(strand->key);
+        delete strand;
+        return;
+    }
+    locker.unlock();
+
+    // 链上还有请求：放回本线程队尾，让其他用户的请求先得到执行
+    push(index, item);
+}
+
+bool RequestExecutor::enterStage(Stage stage, const WorkItem &item)
+{
+    QMutexLocker locker(&_stageMutex);
+    StageState &state = _stages[stage];
+    if (state.config.maxConcurrent > 0 && state.active >= state.config.maxConcurrent) {
+        // 暂存期间该阶段至少有一个请求在执行，它完成时会放回一个调度单元
+        state.parked.enqueue(item);
+        ++state.deferred;
+        return false;
+    }
+    ++state.active;
+    return true;
+}
+
+void RequestExecutor::leaveStage(Stage stage, int index, qint64 executeNs)
+{
+    WorkItem item;
+    bool release = false;
+    {
+        QMutexLocker locker(&_stageMutex);
+        StageState &state = _stages[stage];
+        --state.active;
+        ++state.completed;
+        state.executeNs += executeNs;
+        if (!state.parked.isEmpty()) {
+            item = state.parked.dequeue();
+            release = true;
+        }
+    }
+
+    if (release) {
+        push(index, item);
+    }
+}
+
+void RequestExecutor::runTask(Task &task)
+{
+    qint64 waitNs = _clock.nsecsElapsed() - task.enqueuedNs;
+    _queueWaitNs.fetchAndAddOrdered(waitNs);
+    qint64 maxWait = _maxQueueWaitNs.loadAcquire();
+    while (waitNs > maxWait && !_maxQueueWaitNs.testAndSetOrdered(maxWait, waitNs)) {
+        maxWait = _maxQueueWaitNs.loadAcquire();
+    }
+
+    {
+        QMutexLocker locker(&_stageMutex);
+        StageState &state = _stages[task.stage];
+        --state.queued;
+        state.queueWaitNs += waitNs;
+        state.maxQueueWaitNs = qMax(state.maxQueueWaitNs, waitNs);
+    }
+
+    QJsonObject response;
+    try {
+        // 请求期间获取的数据库连接计入本阶段的配额
+        DatabaseConnectionPool::QuotaScope quotaScope(stageName(task.stage));
+        response = task.work();
+    } catch (...) {
+        LOG_ERROR("Exception occurred while executing request");
+    }
+
+    // 回投到执行器所在线程，在该线程检查上下文是否仍然存在
+    QPointer<QObject> context = task.context;
+    Reply reply = task.reply;
+    QMetaObject::invokeMethod(this, [context, reply, response]() {
+        if (context && reply) {
+            reply(response);
+        }
+    }, Qt::QueuedConnection);
+
+    _completed.fetchAndAddOrdered(1);
+    _pending.fetchAndSubOrdered(1);
+}
+
+QJsonObject RequestExecutor::getStatistics() const
+{
+    QJsonObject stats;
+    qint64 completed = _completed.loadAcquire();
+    stats["enabled"] = isEnabled();
+    stats["worker_threads"] = _workers.size();
+    stats["submitted"] = _submitted.loadAcquire();
+    stats["completed"] = completed;
+    stats["rejected"] = _rejected.loadAcquire();
+    stats["stolen"] = _stolen.loadAcquire();
+    stats["pending"] = _pending.loadAcquire();
+    {
+        QMutexLocker locker(&_strandMutex);
+        stats["active_strands"] = _strands.size();
+    }
+    stats["avg_queue_wait_ms"] = completed > 0
+        ? static_cast<double>(_queueWaitNs.loadAcquire()) / completed / 1e6 : 0.0;
+    stats["max_queue_wait_ms"] = static_cast<double>(_maxQueueWaitNs.loadAcquire()) / 1e6;
+
+    QJsonObject quotaStats = DatabaseConnectionPool::instance()->getQuotaStatistics();
+    QJsonObject stages;
+    QMutexLocker locker(&_stageMutex);
+    for (int i = 0; i < StageCount; ++i) {
+        const StageState &state = _stages[i];
+        QString name = stageName(static_cast<Stage>(i));
+        QJsonObject stage;
+        stage["max_concurrent"] = state.config.maxConcurrent;
+        stage["max_queued"] = state.config.maxQueued;
+        stage["db_connections"] = state.config.dbConnections;
+        stage["active"] = state.active;
+        stage["queued"] = state.queued;
+        stage["parked"] = state.parked.size();
+        stage["submitted"] = state.submitted;
+        stage["completed"] = state.completed;
+        stage["rejected"] = state.rejected;
+        stage["deferred"] = state.deferred;
+        stage["avg_queue_wait_ms"] = state.completed > 0
+            ? static_cast<double>(state.queueWaitNs) / state.completed / 1e6 : 0.0;
+        stage["max_queue_wait_ms"] = static_cast<double>(state.maxQueueWaitNs) / 1e6;
+        stage["avg_execute_ms"] = state.completed > 0
+            ? static_cast<double>(state.executeNs) / state.completed / 1e6 : 0.0;
+        stage["db_quota"] = quotaStats.value(name).toObject();
+        stages[name] = stage;
+    }
+    stats["stages"] = stages;
+    return stats;
+}
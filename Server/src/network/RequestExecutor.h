@@ -0,0 +1,232 @@
+#ifndef REQUESTEXECUTOR_H
+#define REQUESTEXECUTOR_H
+
+#include <QObject>
+#include <QThread>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QAtomicInt>
+#include <QAtomicInteger>
+#include <QElapsedTimer>
+#include <QPointer>
+#include <QHash>
+#include <QList>
+#include <QQueue>
+#include <QVector>
+#include <QJsonObject>
+#include <functional>
+#include <deque>
+
+/**
+ * @brief 工作窃取式请求执行器
+ *
+ * 连接所在的I/O线程只负责分帧与解码，解码后的请求提交到这里执行。
+ * 每个工作线程有自己的双端队列：从队首取任务，空闲时从其他线程队尾窃取。
+ * 带相同亲和键的请求组成一条串行链（strand），同一时刻只有一个在执行，保证同一用户的请求按提交顺序处理；
+ * 整条链作为一个调度单元被窃取，因此顺序不受窃取影响。
+ *
+ * 处理结果回投到执行器所在线程（服务器主线程，即连接所在线程），并在该线程检查上下文对象是否仍然存在。
+ * 未启用时submit()在调用线程内联执行，行为与之前一致。
+ *
+ * 请求按动作划分到不同阶段（舱壁隔离），每个阶段有独立的并发上限、排队上限和数据库连接配额：
+ * 阶段达到并发上限时，取出的调度单元暂存在该阶段的等待队列，不占用工作线程，
+ * 因此搜索或历史记录的突发只会拖慢读取阶段，不影响消息投递和认证。
+ */
+class RequestExecutor : public QObject
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @brief 执行阶段
+     */
+    enum Stage {
+        AuthStage = 0,                // 认证：密码哈希等CPU密集操作
+        InteractiveWriteStage,        // 交互写：发送消息、好友操作等
+        ReadHeavyStage,               // 重读取：搜索、历史记录、列表查询
+        BackgroundStage,              // 后台：心跳及其他低优先级请求
+        StageCount
+    };
+
+    /**
+     * @brief 阶段配置，各上限<=0表示不限制
+     */
+    struct StageConfig {
+        int maxConcurrent = 0;        // 同时执行的请求数
+        int maxQueued = 0;            // 排队请求数，超过时拒绝新请求
+        int dbConnections = 0;        // 同时持有的数据库连接数
+    };
+
+    /**
+     * @brief 执行器配置
+     */
+    struct Config {
+        bool enabled = true;
+        int workerThreads = 0;        // 工作线程数，<=0时按CPU核数
+        int maxPending = 20000;       // 排队请求上限，超过时拒绝新请求
+        StageConfig stages[StageCount];
+    };
+
+    using Work = std::function<QJsonObject()>;
+    using Reply = std::function<void(const QJsonObject &)>;
+
+    static RequestExecutor* instance();
+
+    /**
+     * @brief 启动工作线程，须在服务器主线程调用
+     */
+    bool initialize(const Config &config);
+
+    /**
+     * @brief 停止工作线程，排队中的请求被丢弃
+     */
+    void shutdown();
+
+    bool isEnabled() const { return _running.loadAcquire() != 0; }
+
+    /**
+     * @brief 按用户生成亲和键，同一用户的请求串行执行
+     */
+    static quint64 userKey(qint64 userId);
+
+    /**
+     * @brief 按连接生成亲和键，用于认证前的请求
+     */
+    static quint64 connectionKey(const QString &clientId);
+
+    /**
+     * @brief 按动作名确定执行阶段
+     */
+    static Stage stageForAction(const QString &action);
+
+    /**
+     * @brief 阶段名，用于配置键和统计
+     */
+    static QString stageName(Stage stage);
+
+    /**
+     * @brief 运行时调整阶段上限，已排队和执行中的请求不受影响
+     */
+    void setStageConfig(Stage stage, const StageConfig &config);
+
+    /**
+     * @brief 提交请求
+     * @param stage 执行阶段
+     * @param affinityKey 亲和键，0表示不要求顺序
+     * @param context 回调上下文，回调前已销毁则丢弃结果
+     * @param work 在工作线程执行，返回响应
+     * @param reply 在执行器所在线程执行
+     * @return 排队请求或阶段排队超过上限时返回false，调用者应返回繁忙错误
+     */
+    bool submit(Stage stage, quint64 affinityKey, QObject *context, const Work &work, const Reply &reply);
+
+    /**
+     * @brief 获取执行器统计信息
+     */
+    QJsonObject getStatistics() const;
+
+private:
+    explicit RequestExecutor(QObject *parent = nullptr);
+    ~RequestExecutor();
+
+    struct Task {
+        Stage stage = BackgroundStage;
+        QPointer<QObject> context;
+        Work work;
+        Reply reply;
+        qint64 enqueuedNs;
+    };
+
+    /**
+     * @brief 串行链：同一亲和键的待执行请求
+     */
+    struct Strand {
+        quint64 key;
+        QQueue<Task> tasks;
+    };
+
+    /**
+     * @brief 调度单元：独立请求或一条串行链
+     */
+    struct WorkItem {
+        Strand *strand;
+        Task task;
+    };
+
+    struct Worker {
+        QMutex mutex;
+        std::deque<WorkItem> deque;
+        QThread *thread = nullptr;
+    };
+
+    /**
+     * @brief 阶段状态，由_stageMutex保护
+     */
+    struct StageState {
+        StageConfig config;
+        int active = 0;                   // 执行中的请求数
+        int queued = 0;                   // 已提交尚未开始执行的请求数
+        QQueue<WorkItem> parked;          // 因并发上限暂存的调度单元
+
+        // 统计信息
+        qint64 submitted = 0;
+        qint64 completed = 0;
+        qint64 rejected = 0;
+        qint64 deferred = 0;
+        qint64 queueWaitNs = 0;
+        qint64 maxQueueWaitNs = 0;
+        qint64 executeNs = 0;
+    };
+
+    void runWorker(int index);
+    bool popLocal(int index, WorkItem *item);
+    bool steal(int thief, WorkItem *item);
+    void push(int index, const WorkItem &item);
+    void execute(int index, WorkItem &item);
+    void runTask(Task &task);
+
+    /**
+     * @brief 占用阶段执行名额，达到上限时暂存调度单元并返回false
+     */
+    bool enterStage(Stage stage, const WorkItem &item);
+
+    /**
+     * @brief 归还执行名额，并把一个暂存的调度单元放回指定线程的队列
+     */
+    void leaveStage(Stage stage, int index, qint64 executeNs);
+
+    static RequestExecutor* s_instance;
+    static QMutex s_instanceMutex;
+
+    Config _config;
+    QVector<Worker*> _workers;
+    QAtomicInt _running;
+    QAtomicInt _nextWorker;
+
+    // 串行链表，键存在表示该链已在某个队列中或正在执行
+    mutable QMutex _strandMutex;
+    QHash<quint64, Strand*> _strands;
+
+    // 空闲等待
+    QMutex _idleMutex;
+    QWaitCondition _workAvailable;
+    QAtomicInt _pending;             // 已提交尚未执行完的请求数
+    QAtomicInt _queuedItems;         // 队列中的调度单元数，等待前持_idleMutex检查，避免丢失唤醒
+    int _sleepers;
+
+    // 阶段隔离
+    mutable QMutex _stageMutex;
+    StageState _stages[StageCount];
+
+    QElapsedTimer _clock;
+
+    // 统计信息
+    QAtomicInteger<qint64> _submitted;
+    QAtomicInteger<qint64> _completed;
+    QAtomicInteger<qint64> _rejected;
+    QAtomicInteger<qint64> _stolen;
+    QAtomicInteger<qint64> _queueWaitNs;
+    QAtomicInteger<qint64> _maxQueueWaitNs;
+};
+
+#endif // REQUESTEXECUTOR_H
@@ -1,13 +1,55 @@
 #include "ThreadPoolServer.h"
 #include "../network/ProtocolHandler.h"
 #include "../utils/Logger.h"
+#include "../monitoring/Tracer.h"
+#include "../monitoring/EventLoopMonitor.h"
+#include "../utils/RequestCancellation.h"
+#include "../chat/EphemeralChannel.h"
+#include "../chat/GroupService.h"
+#include "../chat/BootstrapService.h"
+#include "../cluster/ClusterManager.h"
 #include "AsyncMessageQueue.h"
+#include "IoBufferPool.h"
+#include "InboundScanner.h"
 #include <QSslSocket>
 #include <QHostAddress>
 #include <QJsonDocument>
 #include <QJsonArray>
 #include <QMutexLocker>
 #include <QApplication>
+#include <QFile>
+
+#ifdef Q_OS_LINUX
+#include <unistd.h>
+#include <sys/socket.h>
+#endif
+
+namespace {
+
+// 每个休眠连接最多暂存的帧数，超过时唤醒连接投递
+const int MAX_HELD_FRAMES_PER_USER = 16;
+
+// 执行器线程等待处理器线程确认发送的最长时间，超时的帧不再发送
+const int SEND_CONFIRM_TIMEOUT_MS = 2000;
+
+/**
+ * @brief 读取进程常驻内存（RSS），不支持的平台返回-1
+ */
+qint64 processResidentBytes()
+{
+#ifdef Q_OS_LINUX
+    QFile statm("/proc/self/statm");
+    if (statm.open(QIODevice::ReadOnly)) {
+        QList<QByteArray> fields = statm.readAll().split(' ');
+        if (fields.size() > 1) {
+            return fields.at(1).toLongLong() * sysconf(_SC_PAGESIZE);
+        }
+    }
+#endif
+    return -1;
+}
+
+} // namespace
 
 // 静态成员初始化
 ThreadPoolServer* ThreadPoolServer::s_instance = nullptr;
@@ -20,6 +62,7 @@ ThreadPoolServer::ThreadPoolServer(QObject *parent)
     , _totalConnections(0)
     , _activeConnections(0)
     , _rejectedConnections(0)
+    , _lagRejectedConnections(0)
     , _useTLS(true)
     , _initialized(false)
     , _running(false)
@@ -27,14 +70,32 @@ ThreadPoolServer::ThreadPoolServer(QObject *parent)
     // 创建定时器
     _healthCheckTimer = new QTimer(this);
     _loadBalanceTimer = new QTimer(this);
+    _hibernateTimer = new QTimer(this);
     
     connect(_healthCheckTimer, &QTimer::timeout, this, &ThreadPoolServer::performHealthCheck);
     connect(_loadBalanceTimer, &QTimer::timeout, this, &ThreadPoolServer::balanceLoad);
+    connect(_hibernateTimer, &QTimer::timeout, this, &ThreadPoolServer::hibernateIdleClients);
+    
+    // 创建休眠表
+    _hibernator = new ConnectionHibernator(this);
+    connect(_hibernator, &ConnectionHibernator::wakeRequested, this, &ThreadPoolServer::onHibernatedWake);
+    connect(_hibernator, &ConnectionHibernator::connectionExpired, this, &ThreadPoolServer::onHibernatedExpired);
+    
+    // 创建io_uring传输，接受的连接走与QTcpServer相同的准入路径
+    _ioUring = new IoUringTransport(this);
+    connect(_ioUring, &IoUringTransport::connectionAccepted, this, [this](qintptr socketDescriptor) {
+        incomingConnection(socketDescriptor);
+    });
 }
 
 ThreadPoolServer::~ThreadPoolServer()
 {
     stopServer();
+    
+    QMutexLocker locker(&s_instanceMutex);
+    if (s_instance == this) {
+        s_instance = nullptr;
+    }
 }
 
 ThreadPoolServer* ThreadPoolServer::instance()
@@ -56,6 +117,15 @@ bool ThreadPoolServer::initialize(const ServerConfig& config)
     }
     
     _config = config;
+    ClientHandler::setOutboundConfig(_config.outbound);
+    
+    // 初始化的实例即全局实例，服务层和集群总线经instance()访问同一服务器
+    {
+        QMutexLocker locker(&s_instanceMutex);
+        s_instance = this;
+    }
+    ClientHandler::setSocketReadBufferSize(_config.socketReadBufferSize);
+    ClientHandler::setInboundFastPath(_config.inboundFastPath);
     
     // 初始化线程池服务器
     
@@ -74,6 +144,27 @@ bool ThreadPoolServer::initialize(const ServerConfig& config)
         _loadBalanceTimer->start(10000); // 10秒负载均衡
     }
     
+    // 请求在执行器中处理，连接线程只负责分帧与解码
+    RequestExecutor::instance()->initialize(_config.executor);
+    
+    // io_uring传输接管明文连接的套接字，休眠依赖Qt套接字交出描述符，两者不同时启用
+    if (_ioUring->initialize(_config.ioUring)) {
+        ClientHandler::setIoUringTransport(_ioUring);
+        if (_config.hibernation.enabled) {
+            LOG_INFO("Connection hibernation disabled: not supported with io_uring transport");
+            _config.hibernation.enabled = false;
+        }
+    }
+    
+    // 休眠连接上的心跳直接交给协议处理器应答，不重建ClientHandler
+    bool hibernationEnabled = _hibernator->initialize(_config.hibernation,
+        [this](const QJsonObject &message, const QString &clientId, const QString &clientIP) {
+            return _protocolHandler ? _protocolHandler->handleMessage(message, clientId, clientIP) : QJsonObject();
+        });
+    if (hibernationEnabled) {
+        _hibernateTimer->start(qMax(1000, _config.hibernation.sweepIntervalMs));
+    }
+    
     _initialized = true;
     _startTime = QDateTime::currentDateTime();
     
@@ -96,6 +187,11 @@ bool ThreadPoolServer::startServer(quint16 port, const QHostAddress &address, bo
     
     _useTLS = useTLS;
     
+    // TLS模式下尝试内核TLS卸载，不支持时继续使用QSslSocket
+    if (_useTLS) {
+        KernelTls::instance()->initialize(_config.kernelTls);
+    }
+    
     if (!listen(address, port)) {
         QString error = QString("Failed to start server: %1").arg(errorString());
         LOG_ERROR(error);
@@ -103,6 +199,15 @@ bool ThreadPoolServer::startServer(quint16 port, const QHostAddress &address, bo
         return false;
     }
     
+    // 明文或内核TLS模式下由io_uring在监听套接字上接受连接，失败时继续使用QTcpServer
+    if ((!_useTLS || KernelTls::instance()->isEnabled()) && _ioUring->isEnabled()) {
+        pauseAccepting();
+        if (!_ioUring->startAccepting(socketDescriptor())) {
+            LOG_WARNING("Failed to start io_uring accept, falling back to QTcpServer");
+            resumeAccepting();
+        }
+    }
+    
     _running = true;
     
     // 线程池服务器已启动
@@ -123,6 +228,11 @@ void ThreadPoolServer::stopServer()
     // 停止定时器
     _healthCheckTimer->stop();
     _loadBalanceTimer->stop();
+    _hibernateTimer->stop();
+    
+    // 关闭所有休眠连接
+    _hibernator->shutdown();
+    _ioUring->stopAccepting();
     
     // 断开所有客户端连接
     QMutexLocker locker(&_clientsMutex);
@@ -135,11 +245,16 @@ void ThreadPoolServer::stopServer()
     _userClients.clear();
     locker.unlock();
     
+    // 停止请求执行器，排队中的请求随连接一起丢弃
+    RequestExecutor::instance()->shutdown();
+    
     // 等待所有线程池完成
     for (QThreadPool* pool : _threadPools) {
         pool->waitForDone(5000);
     }
     
+    _ioUring->shutdown();
+    KernelTls::instance()->shutdown();
     close();
     
     // 线程池服务器已停止
@@ -161,9 +276,56 @@ QJsonObject ThreadPoolServer::getServerStatistics() const
     stats["active_connections"] = _activeConnections.loadAcquire();
     stats["total_connections"] = _totalConnections.loadAcquire();
     stats["rejected_connections"] = _rejectedConnections.loadAcquire();
+    stats["lag_rejected_connections"] = _lagRejectedConnections.loadAcquire();
     stats["authenticated_clients"] = _userClients.size();
     stats["max_clients"] = _config.maxClients;
     stats["use_tls"] = _useTLS;
+    stats["outbound"] = ClientHandler::getOutboundStatistics();
+    stats["inbound_scanner"] = InboundScanner::getStatistics();
+    
+    // 连接缓冲区内存统计
+    qint64 receiveBytes = 0;
+    qint64 bufferedBytes = 0;
+    for (ClientHandler* client : _clients) {
+        if (client) {
+            receiveBytes += client->receiveBufferCapacity();
+            bufferedBytes += client->bufferedBytes();
+        }
+    }
+    QJsonObject memoryStats;
+    memoryStats["receive_buffer_bytes"] = receiveBytes;
+    memoryStats["buffered_bytes"] = bufferedBytes;
+    memoryStats["buffered_bytes_per_connection"] = _clients.isEmpty() ? 0 : bufferedBytes / _clients.size();
+    qint64 residentBytes = processResidentBytes();
+    if (residentBytes >= 0) {
+        memoryStats["process_rss_bytes"] = residentBytes;
+        memoryStats["rss_bytes_per_connection"] = _clients.isEmpty() ? 0 : residentBytes / _clients.size();
+    }
+    memoryStats["io_buffer_pool"] = IoBufferPool::instance()->getStatistics();
+    stats["memory"] = memoryStats;
+    
+    // 休眠连接统计，活跃连接与休眠连接的单连接开销可直接对比
+    QJsonObject hibernationStats = _hibernator->getStatistics();
+    int hibernated = hibernationStats["hibernated_connections"].toInt();
+    hibernationStats["bytes_per_hibernated_connection"] = hibernated > 0
+        ? hibernationStats["table_bytes"].toVariant().toLongLong() / hibernated : 0;
+    if (residentBytes >= 0) {
+        hibernationStats["rss_bytes_per_connection"] = residentBytes / qMax(1, _clients.size() + hibernated);
+    }
+    int heldFrames = 0;
+    for (const QList<HeldFrame> &frames : _heldFrames) {
+        heldFrames += frames.size();
+    }
+    hibernationStats["held_frames"] = heldFrames;
+    stats["hibernation"] = hibernationStats;
+    stats["io_uring"] = _ioUring->getStatistics();
+    stats["kernel_tls"] = KernelTls::instance()->getStatistics();
+    stats["request_executor"] = RequestExecutor::instance()->getStatistics();
+    stats["request_deadlines"] = RequestCancellation::instance()->getStatistics();
+    stats["ephemeral_events"] = EphemeralChannel::instance()->getStatistics();
+    stats["group_chat"] = GroupService::instance()->getStatistics();
+    stats["bootstrap"] = BootstrapService::instance()->getStatistics();
+    stats["cluster"] = ClusterManager::instance()->getStatistics();
     
     // 线程池统计
     QJsonArray poolStats;
@@ -193,14 +355,31 @@ int ThreadPoolServer::clientCount() const
 void ThreadPoolServer::broadcastMessage(const QJsonObject &message)
 {
     // 直接发送广播消息，避免AsyncMessageQueue重复发送
+    // 只序列化一次，所有客户端共享同一编码帧
+    EncodedFrame frame = EncodedFrame::encode(message);
+    
     QMutexLocker locker(&_clientsMutex);
 
     for (auto it = _clients.begin(); it != _clients.end(); ++it) {
         ClientHandler* client = it.value();
         if (client && client->isAuthenticated()) {
-            client->sendMessage(message);
+            client->sendFrame(frame);
+        }
+    }
+    
+    // 休眠连接不逐个唤醒，广播暂存到唤醒时投递
+    RecipientList overflowed;
+    for (qint64 userId : _hibernator->hibernatedUserIds()) {
+        if (holdForHibernatedLocked(userId, frame, OutboundLanes::ChatLane, -1)) {
+            overflowed.append(userId);
         }
     }
+    
+    locker.unlock();
+    
+    if (!overflowed.isEmpty()) {
+        wakeHibernated(overflowed);
+    }
 
     // 消息已广播给所有认证客户端
 }
@@ -208,14 +387,45 @@ void ThreadPoolServer::broadcastMessage(const QJsonObject &message)
 bool ThreadPoolServer::sendMessageToUser(qint64 userId, const QJsonObject &message)
 {
     // 直接发送消息给指定用户，避免AsyncMessageQueue重复发送
+    EncodedFrame frame = EncodedFrame::encode(message);
+    bool onServerThread = QThread::currentThread() == thread();
+    
     QMutexLocker locker(&_clientsMutex);
 
     ClientHandler* client = _userClients.value(userId, nullptr);
+    if (!client && _hibernator->isHibernated(userId)) {
+        if (!onServerThread) {
+            // 处理器只能在服务器线程中重建，唤醒后发送并等待结果
+            QSharedPointer<FrameReceipt> receipt = FrameReceipt::post(this, [this, userId, frame]() {
+                QMutexLocker serverLocker(&_clientsMutex);
+                ClientHandler* woken = _userClients.value(userId, nullptr);
+                if (!woken) {
+                    woken = wakeHibernatedLocked(userId);
+                }
+                return woken && woken->isAuthenticated() && woken->sendFrame(frame);
+            });
+            locker.unlock();
+            return confirmSend(userId, receipt);
+        }
+        client = wakeHibernatedLocked(userId);
+    }
+    if (!client && ClusterManager::instance()->isEnabled()) {
+        // 用户可能连接在其他节点上，查询目录时不持有客户端表锁
+        locker.unlock();
+        RecipientList recipients;
+        recipients.append(userId);
+        return ClusterManager::instance()->forward(recipients, frame) > 0;
+    }
     if (client && client->isAuthenticated()) {
-        bool success = client->sendMessage(message);
-        if (success) {
-            // 消息已发送给指定用户
-        } else {
+        if (!onServerThread) {
+            // 执行器线程中调用时由处理器在其所在线程写出，返回值需要真实的发送结果：
+            // 为true时调用者会把消息标记为已投递，未确认的帧必须返回false以便改走离线队列
+            QSharedPointer<FrameReceipt> receipt = client->postFrame(frame);
+            locker.unlock();
+            return confirmSend(userId, receipt);
+        }
+        bool success = client->sendFrame(frame);
+        if (!success) {
             LOG_WARNING(QString("Failed to send message to user %1").arg(userId));
         }
         return success;
@@ -225,6 +435,143 @@ bool ThreadPoolServer::sendMessageToUser(qint64 userId, const QJsonObject &messa
     return false;
 }
 
+bool ThreadPoolServer::confirmSend(qint64 userId, const QSharedPointer<FrameReceipt> &receipt)
+{
+    bool success = receipt->wait(SEND_CONFIRM_TIMEOUT_MS);
+    if (!success) {
+        LOG_WARNING(QString("Failed to send message to user %1: connection closed or send not confirmed")
+                    .arg(userId));
+    }
+    return success;
+}
+
+int ThreadPoolServer::sendMessageToUsers(const RecipientList &userIds, const QJsonObject &message,
+                                         OutboundLanes::Lane lane, qint64 coalesceKey)
+{
+    if (userIds.isEmpty()) {
+        return 0;
+    }
+    
+    return sendFrameToUsers(userIds, EncodedFrame::encode(message), lane, coalesceKey);
+}
+
+int ThreadPoolServer::sendFrameToUsers(const RecipientList &userIds, const EncodedFrame &frame,
+                                       OutboundLanes::Lane lane, qint64 coalesceKey)
+{
+    ClusterManager* cluster = ClusterManager::instance();
+    RecipientList remote;
+    int sentCount = sendFrameLocally(userIds, frame, lane, coalesceKey, cluster->isEnabled() ? &remote : nullptr);
+    
+    // 不在本节点的用户交给集群按所在节点批量转发
+    if (!remote.isEmpty()) {
+        sentCount += cluster->forward(remote, frame, lane, coalesceKey);
+    }
+    
+    return sentCount;
+}
+
+int ThreadPoolServer::deliverLocalFrame(const RecipientList &userIds, const EncodedFrame &frame,
+                                        OutboundLanes::Lane lane, qint64 coalesceKey)
+{
+    return sendFrameLocally(userIds, frame, lane, coalesceKey, nullptr);
+}
+
+bool ThreadPoolServer::isUserLocal(qint64 userId) const
+{
+    QMutexLocker locker(&_clientsMutex);
+    return _userClients.contains(userId) || _hibernator->isHibernated(userId);
+}
+
+QList<qint64> ThreadPoolServer::localUserIds() const
+{
+    QMutexLocker locker(&_clientsMutex);
+    return _userClients.keys() + _hibernator->hibernatedUserIds();
+}
+
+int ThreadPoolServer::sendFrameLocally(const RecipientList &userIds, const EncodedFrame &frame,
+                                       OutboundLanes::Lane lane, qint64 coalesceKey, RecipientList *notLocal)
+{
+    if (userIds.isEmpty() || frame.isEmpty()) {
+        return 0;
+    }
+    
+    int sentCount = 0;
+    
+    RecipientList toWake;
+    
+    QMutexLocker locker(&_clientsMutex);
+    
+    for (qint64 userId : userIds) {
+        ClientHandler* client = _userClients.value(userId, nullptr);
+        if (!client) {
+            if (!_hibernator->isHibernated(userId)) {
+                if (notLocal) {
+                    notLocal->append(userId);
+                }
+                continue;
+            }
+            // 帧先暂存，唤醒时投递；状态等批量帧按合并键只保留最新一帧，不唤醒连接
+            bool overflowed = holdForHibernatedLocked(userId, frame, lane, coalesceKey);
+            if (lane != OutboundLanes::BulkLane || overflowed) {
+                toWake.append(userId);
+            }
+            sentCount++;
+            continue;
+        }
+        // 不在处理器所在线程时sendFrame排队到该线程写出，不直接访问套接字和出站通道
+        if (client->isAuthenticated() && client->sendFrame(frame, lane, coalesceKey)) {
+            sentCount++;
+        }
+    }
+    
+    locker.unlock();
+    
+    if (!toWake.isEmpty()) {
+        wakeHibernated(toWake);
+    }
+    
+    return sentCount;
+}
+
+bool ThreadPoolServer::holdForHibernatedLocked(qint64 userId, const EncodedFrame &frame,
+                                               OutboundLanes::Lane lane, qint64 coalesceKey)
+{
+    QList<HeldFrame> &frames = _heldFrames[userId];
+    
+    if (coalesceKey >= 0) {
+        for (HeldFrame &held : frames) {
+            if (held.lane == lane && held.coalesceKey == coalesceKey) {
+                held.frame = frame;
+                return false;
+            }
+        }
+    }
+    
+    HeldFrame held;
+    held.frame = frame;
+    held.lane = lane;
+    held.coalesceKey = coalesceKey;
+    frames.append(held);
+    
+    return frames.size() > MAX_HELD_FRAMES_PER_USER;
+}
+
+void ThreadPoolServer::wakeHibernated(const RecipientList &userIds)
+{
+    // 休眠连接的处理器只能在服务器线程中重建
+    if (QThread::currentThread() != thread()) {
+        QMetaObject::invokeMethod(this, [this, userIds]() {
+            wakeHibernated(userIds);
+        }, Qt::QueuedConnection);
+        return;
+    }
+    
+    QMutexLocker locker(&_clientsMutex);
+    for (qint64 userId : userIds) {
+        wakeHibernatedLocked(userId);
+    }
+}
+
 void ThreadPoolServer::incomingConnection(qintptr socketDescriptor)
 {
     // 检查连接数限制
@@ -240,6 +587,20 @@ void ThreadPoolServer::incomingConnection(qintptr socketDescriptor)
         return;
     }
     
+    // 事件循环延迟过高时拒绝新连接，避免进一步拖慢已有连接
+    if (EventLoopMonitor::instance()->isOverloaded()) {
+        LOG_WARNING(QString("Rejected connection: event loop lag %1ms over admission threshold")
+                    .arg(EventLoopMonitor::instance()->maxCurrentLagMs(), 0, 'f', 1));
+        _rejectedConnections.fetchAndAddOrdered(1);
+        _lagRejectedConnections.fetchAndAddOrdered(1);
+        
+        QTcpSocket tempSocket;
+        tempSocket.setSocketDescriptor(socketDescriptor);
+        tempSocket.disconnectFromHost();
+        
+        return;
+    }
+    
     // 选择最佳线程池
     QThreadPool* selectedPool = selectBestThreadPool();
     
@@ -252,6 +613,8 @@ void ThreadPoolServer::incomingConnection(qintptr socketDescriptor)
     
     _totalConnections.fetchAndAddOrdered(1);
     _activeConnections.fetchAndAddOrdered(1);
+    FlightRecorder::record(FlightRecorder::ConnectionAccepted, static_cast<quint64>(socketDescriptor),
+                           static_cast<quint64>(_activeConnections.loadAcquire()));
     
 
 }
@@ -285,8 +648,8 @@ void ThreadPoolServer::onClientDisconnected(ClientHandler* client)
             _clients.remove(clientId);
         }
         
-        // 从用户客户端映射中移除
-        if (userId > 0 && _userClients.contains(userId)) {
+        // 从用户客户端映射中移除（新会话可能已替换该用户的映射）
+        if (userId > 0 && _userClients.value(userId, nullptr) == client) {
             _userClients.remove(userId);
         }
     }
@@ -321,6 +684,13 @@ void ThreadPoolServer::onClientDisconnected(ClientHandler* client)
 
 void ThreadPoolServer::onClientAuthenticated(qint64 userId, ClientHandler* client)
 {
+    // 该用户的旧会话处于休眠状态时直接关闭
+    ConnectionHibernator::HibernatedConnection previous;
+    if (_hibernator->take(userId, &previous)) {
+        LOG_WARNING(QString("User %1 has a hibernated session, closing it").arg(userId));
+        closeHibernated(previous, false);
+    }
+    
     QMutexLocker locker(&_clientsMutex);
     
     // 检查是否已有该用户的连接
@@ -339,6 +709,9 @@ void ThreadPoolServer::onClientAuthenticated(qint64 userId, ClientHandler* clien
 
 void ThreadPoolServer::onClientMessageReceived(ClientHandler* client, const QJsonObject &message)
 {
+    TRACE_REQUEST("ThreadPoolServer::onClientMessageReceived", message["request_id"].toString());
+    EventLoopActionScope actionScope(message["action"].toString());
+
     // Processing client message
     
     if (!client) {
@@ -364,10 +737,9 @@ void ThreadPoolServer::onClientMessageReceived(ClientHandler* client, const QJso
     
     QString action = message["action"].toString();
     
-    // 处理聊天消息
-    if (action.startsWith("friend_") || action.startsWith("message_") || 
-        action.startsWith("status_") || action == "heartbeat" ||
-        action == "send_message" || action == "get_chat_history" || action == "get_chat_sessions") {
+    // 处理聊天消息和心跳；与协议处理器使用同一份动作分类，新增动作无需在此重复登记
+    ProtocolHandler::MessageType messageType = ProtocolHandler::getMessageType(action);
+    if (messageType == ProtocolHandler::Chat || messageType == ProtocolHandler::Heartbeat) {
         
         // 路由聊天消息到协议处理器
         
@@ -388,15 +760,61 @@ void ThreadPoolServer::onClientMessageReceived(ClientHandler* client, const QJso
             return;
         }
         
-        // 处理消息并获取响应
-        QJsonObject response = _protocolHandler->handleMessage(message, clientId, clientIP);
-        
-        // 协议处理器调用成功
-        
-        // 发送响应给客户端
-        client->sendMessage(response);
+        // 在执行器中按动作所属阶段处理，同一用户的请求按顺序执行；响应回到连接所在线程发送
+        ProtocolHandler* protocolHandler = _protocolHandler;
+        QString requestId = message["request_id"].toString();
+        RequestExecutor::Stage stage = RequestExecutor::stageForAction(action);
+        RequestTokenPtr token = RequestCancellation::instance()->begin(clientId, requestId,
+                                                                       message["deadline_ms"].toVariant().toLongLong());
+        if (token) {
+            token->setReadOnly(stage == RequestExecutor::ReadHeavyStage);
+        }
+        // 追踪和采样结果在提交时捕获，执行线程上继续同一条追踪
+        Tracer::Context traceContext = Tracer::currentContext();
+        bool accepted = RequestExecutor::instance()->submit(stage, RequestExecutor::userKey(client->userId()), client,
+            [protocolHandler, message, clientId, clientIP, token, traceContext, action]() {
+                // 排队期间已过期或被取消的请求不再执行
+                if (token && token->shouldAbort()) {
+                    RequestCancellation::instance()->recordDrop(token, RequestCancellation::BeforeExecution);
+                    return QJsonObject();
+                }
+                TRACE_CONTINUE("RequestExecutor::execute", traceContext);
+                EventLoopActionScope actionScope(action);
+                RequestCancellation::Scope scope(token);
+                return protocolHandler->handleMessage(message, clientId, clientIP);
+            },
+            [client, requestId, token, stage, action](const QJsonObject &response) {
+                RequestCancellation::instance()->finish(token);
+                
+                // 瞬时事件不确认，只有被拒绝时回复错误
+                if (action == "send_ephemeral" && response["success"].toBool()) {
+                    return;
+                }
+                
+                // 已执行的写操作总是确认，便于重试的客户端判断是否已生效；只读结果无人等待时丢弃
+                if (token && token->shouldAbort()) {
+                    if (response.isEmpty()) {
+                        return;
+                    }
+                    if (stage != RequestExecutor::InteractiveWriteStage) {
+                        RequestCancellation::instance()->recordDrop(token, RequestCancellation::AfterExecution);
+                        return;
+                    }
+                }
+                
+                if (response.isEmpty()) {
+                    client->sendErrorResponse(requestId, "Internal server error");
+                    return;
+                }
+                client->sendMessage(response);
+            });
         
-        // 聊天消息处理完成
+        if (!accepted) {
+            RequestCancellation::instance()->finish(token);
+            LOG_WARNING(QString("Request executor stage %1 saturated, rejecting %2 from client %3")
+                        .arg(RequestExecutor::stageName(stage)).arg(action).arg(clientId));
+            client->sendErrorResponse(requestId, "Server busy");
+        }
     } else {
         LOG_WARNING(QString("Unknown message type: %1").arg(action));
     }
@@ -406,7 +824,20 @@ void ThreadPoolServer::onClientMessageReceived(ClientHandler* client, const QJso
 
 void ThreadPoolServer::performHealthCheck()
 {
-
+    // 兜底检查慢消费者：连接长时间没有新的发送或写完成事件时也能被断开；
+    // 同时让空闲连接归还接收缓冲区保留的块
+    {
+        QMutexLocker locker(&_clientsMutex);
+        QDateTime idleBefore = QDateTime::currentDateTime().addMSecs(-_config.idleBufferShrinkMs);
+        for (ClientHandler* client : _clients) {
+            if (client) {
+                client->checkSlowConsumer();
+                if (client->lastActivity() < idleBefore) {
+                    client->shrinkIdleBuffers();
+                }
+            }
+        }
+    }
     
     // 检查线程池状态
     for (int i = 0; i < _threadPools.size(); ++i) {
@@ -448,6 +879,121 @@ void ThreadPoolServer::balanceLoad()
     }
 }
 
+void ThreadPoolServer::hibernateIdleClients()
+{
+    if (!_hibernator->isEnabled()) {
+        return;
+    }
+    
+    qint64 idleMs = static_cast<qint64>(_hibernator->config().idleSeconds) * 1000;
+    QList<ClientHandler*> released;
+    QList<ConnectionHibernator::HibernatedConnection> failed;
+    
+    {
+        QMutexLocker locker(&_clientsMutex);
+        
+        for (auto it = _userClients.begin(); it != _userClients.end();) {
+            ClientHandler* client = it.value();
+            ConnectionHibernator::HibernatedConnection connection;
+            if (!client || !client->canHibernate(idleMs) || !client->detachForHibernation(&connection)) {
+                ++it;
+                continue;
+            }
+            
+            if (!_hibernator->hibernate(connection)) {
+                failed.append(connection);
+            }
+            
+            // 处理器已交出套接字，从表中移除后销毁，不发出断开信号
+            _clients.remove(client->clientId());
+            it = _userClients.erase(it);
+            QObject::disconnect(client, nullptr, this, nullptr);
+            released.append(client);
+        }
+    }
+    
+    for (ClientHandler* client : released) {
+        client->deleteLater();
+    }
+    
+    for (const ConnectionHibernator::HibernatedConnection &connection : failed) {
+        closeHibernated(connection, true);
+    }
+}
+
+void ThreadPoolServer::onHibernatedWake(const ConnectionHibernator::HibernatedConnection &connection)
+{
+    QMutexLocker locker(&_clientsMutex);
+    rehydrateLocked(connection);
+}
+
+void ThreadPoolServer::onHibernatedExpired(const ConnectionHibernator::HibernatedConnection &connection)
+{
+    closeHibernated(connection, true);
+}
+
+ClientHandler* ThreadPoolServer::wakeHibernatedLocked(qint64 userId)
+{
+    ConnectionHibernator::HibernatedConnection connection;
+    if (!_hibernator->take(userId, &connection)) {
+        return nullptr;
+    }
+    
+    return rehydrateLocked(connection);
+}
+
+ClientHandler* ThreadPoolServer::rehydrateLocked(const ConnectionHibernator::HibernatedConnection &connection)
+{
+    ClientHandler* client = new ClientHandler(connection.socketDescriptor, _protocolHandler, false, this);
+    if (client->state() == ClientHandler::Error) {
+        // 套接字对象未接管描述符，由清理流程关闭；清理会发出信号，因此不在持锁时执行
+        LOG_WARNING(QString("Failed to wake hibernated connection of user %1").arg(connection.userId));
+        delete client;
+        QMetaObject::invokeMethod(this, [this, connection]() {
+            closeHibernated(connection, true);
+        }, Qt::QueuedConnection);
+        return nullptr;
+    }
+    
+    client->restoreFromHibernation(connection);
+    attachClient(client);
+    _clients[client->clientId()] = client;
+    _userClients[connection.userId] = client;
+    
+    // 投递休眠期间暂存的帧
+    const QList<HeldFrame> heldFrames = _heldFrames.take(connection.userId);
+    for (const HeldFrame &held : heldFrames) {
+        client->sendFrame(held.frame, held.lane, held.coalesceKey);
+    }
+    
+    return client;
+}
+
+void ThreadPoolServer::closeHibernated(const ConnectionHibernator::HibernatedConnection &connection, bool notifyLogout)
+{
+#ifdef Q_OS_LINUX
+    sockaddr_storage address = {};
+    socklen_t addressLength = sizeof(address);
+    if (::getpeername(connection.socketDescriptor, reinterpret_cast<sockaddr*>(&address), &addressLength) == 0) {
+        updateIPCount(QHostAddress(reinterpret_cast<sockaddr*>(&address)), -1);
+    }
+    ::close(connection.socketDescriptor);
+#endif
+    
+    {
+        QMutexLocker locker(&_clientsMutex);
+        _heldFrames.remove(connection.userId);
+    }
+    
+    _activeConnections.fetchAndSubOrdered(1);
+    
+    emit clientDisconnected(nullptr);
+    
+    if (notifyLogout) {
+        emit userLoggedOut(connection.userId);
+    }
+}
+
 bool ThreadPoolServer::checkIPLimit(const QHostAddress& address)
 {
     QMutexLocker locker(&_ipMutex);
@@ -510,6 +1056,35 @@ ThreadPoolServer::ClientTask::ClientTask(qintptr socketDescriptor, ThreadPoolSer
 {
 }
 
+void ThreadPoolServer::attachClient(ClientHandler* client)
+{
+    // 以客户端为上下文，处理器销毁后排队中的调用随之丢弃
+    QObject::connect(client, &ClientHandler::connected, client, [this, client]() {
+        onClientConnected(client);
+    }, Qt::QueuedConnection);
+    
+    QObject::connect(client, &ClientHandler::disconnected, client, [this, client]() {
+        onClientDisconnected(client);
+    }, Qt::QueuedConnection);
+    
+    QObject::connect(client, &ClientHandler::authenticated, client, [this, client](qint64 userId) {
+        onClientAuthenticated(userId, client);
+    }, Qt::QueuedConnection);
+    
+    QObject::connect(client, &ClientHandler::clientError, client, [client](const QString &error) {
+        LOG_ERROR(QString("Client error: %1, Client: %2").arg(error).arg(client->clientId()));
+        QMetaObject::invokeMethod(client, "emitDisconnected", Qt::QueuedConnection);
+    }, Qt::QueuedConnection);
+    
+    QObject::connect(client, &ClientHandler::messageReceived, client, [this, client](const QJsonObject &message) {
+        try {
+            onClientMessageReceived(client, message);
+        } catch (...) {
+            LOG_ERROR("Exception occurred in server->onClientMessageReceived");
+        }
+    }, Qt::QueuedConnection);
+}
+
 void ThreadPoolServer::ClientTask::run()
 {
     // Starting client task
@@ -539,55 +1114,10 @@ void ThreadPoolServer::ClientTask::run()
         client->setParent(_server);
     }
     
-    // 在主线程中连接信号
-    QMetaObject::invokeMethod(_server, [this, client]() {
-        // 连接信号
-        
-        // 连接信号到服务器
-        QObject::connect(client, &ClientHandler::connected, _server, 
-                        [client]() {
-            // 客户端连接信号
-        }, Qt::QueuedConnection);
-        
-        QObject::connect(client, &ClientHandler::disconnected, _server, 
-                        [client]() {
-            // 客户端断开信号
-        }, Qt::QueuedConnection);
-        
-        QObject::connect(client, &ClientHandler::authenticated, _server, 
-                        [client](qint64 userId) {
-            // 客户端认证信号
-        }, Qt::QueuedConnection);
-        
-        QObject::connect(client, &ClientHandler::clientError, _server, 
-                        [client](const QString &error) {
-            LOG_ERROR(QString("Client error: %1, Client: %2").arg(error).arg(client->clientId()));
-            if (client) {
-                QMetaObject::invokeMethod(client, "emitDisconnected", Qt::QueuedConnection);
-            }
-        }, Qt::QueuedConnection);
-        
-        QObject::connect(client, &ClientHandler::messageReceived, _server, 
-                        [client](const QJsonObject &message) {
-            // 检查对象有效性
-            if (!client) {
-                LOG_ERROR("Client pointer is null in messageReceived lambda");
-                return;
-            }
-            
-            // 使用传入的服务器实例，而不是单例
-            ThreadPoolServer* server = qobject_cast<ThreadPoolServer*>(client->parent());
-            if (!server) {
-                LOG_ERROR("Server instance is null in messageReceived lambda");
-                return;
-            }
-            
-            try {
-                server->onClientMessageReceived(client, message);
-            } catch (...) {
-                LOG_ERROR("Exception occurred in server->onClientMessageReceived");
-            }
-        }, Qt::QueuedConnection);
+    // 在主线程中连接信号；任务对象执行完即被删除，因此只捕获服务器指针
+    ThreadPoolServer* server = _server;
+    QMetaObject::invokeMethod(server, [server, client]() {
+        server->attachClient(client);
         
         // 启动客户端处理器
         QMetaObject::invokeMethod(client, "startProcessing", Qt::QueuedConnection);
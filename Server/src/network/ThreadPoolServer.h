@@ -5,10 +5,15 @@
 #include <QThreadPool>
 #include <QRunnable>
 #include <QMutex>
+#include <QHash>
 #include <QAtomicInt>
 #include <QTimer>
 #include <QJsonObject>
 #include "ClientHandler.h"
+#include "ConnectionHibernator.h"
+#include "IoUringTransport.h"
+#include "RequestExecutor.h"
+#include "../security/KernelTls.h"
 
 class ProtocolHandler;
 
@@ -32,6 +37,14 @@ struct ServerConfig {
     int maxConnectionsPerIP = 10;    // 每IP最大连接数
     int ipVerificationCodeInterval = 30; // 每IP验证码发送间隔(秒)
     int emailVerificationCodeInterval = 60; // 每邮箱验证码发送间隔(秒)
+    OutboundLanes::Config outbound;  // 单连接出站通道与慢消费者配置
+    qint64 socketReadBufferSize = 64 * 1024; // 套接字内部读缓冲区上限(字节)
+    int idleBufferShrinkMs = 10000;  // 连接空闲超过该时长后归还接收缓冲区(ms)
+    bool inboundFastPath = true;     // 入站消息先快速扫描路由字段，心跳不构建DOM
+    ConnectionHibernator::HibernationConfig hibernation; // 空闲连接休眠配置
+    IoUringTransport::Config ioUring; // io_uring传输配置（明文连接与内核TLS连接）
+    KernelTls::Config kernelTls;     // 内核TLS卸载配置
+    RequestExecutor::Config executor; // 请求执行器配置
 };
 
 class ThreadPoolServer : public QTcpServer
@@ -95,11 +108,58 @@ public:
     
     /**
      * @brief 发送消息给指定用户
+     * 
+     * 在执行器线程中调用时等待处理器线程给出发送结果（最多2秒），超时或连接已断开时返回false，
+     * 且该消息不会再发出，调用者可以改存离线队列。调用时不能持有服务器线程可能等待的锁。
      * @param userId 用户ID
      * @param message JSON消息
      * @return 发送是否成功
      */
     bool sendMessageToUser(qint64 userId, const QJsonObject &message);
+    
+    /**
+     * @brief 发送同一条消息给多个用户
+     * 
+     * 消息只序列化一次，编码后的帧由所有接收者共享。
+     * 未连接或未认证的用户会被跳过。
+     * @param userIds 接收者用户ID列表
+     * @param message JSON消息
+     * @param lane 出站通道
+     * @param coalesceKey 批量通道合并键，<0表示不合并
+     * @return 成功发送的用户数量
+     */
+    int sendMessageToUsers(const RecipientList &userIds, const QJsonObject &message,
+                           OutboundLanes::Lane lane = OutboundLanes::ChatLane, qint64 coalesceKey = -1);
+    
+    /**
+     * @brief 发送预编码的帧给多个用户
+     * 
+     * 启用集群时，不在本节点的用户由ClusterManager转发到其所在节点。
+     * @param userIds 接收者用户ID列表
+     * @param frame 已编码的帧
+     * @param lane 出站通道
+     * @param coalesceKey 批量通道合并键，<0表示不合并
+     * @return 成功发送的用户数量
+     */
+    int sendFrameToUsers(const RecipientList &userIds, const EncodedFrame &frame,
+                         OutboundLanes::Lane lane = OutboundLanes::ChatLane, qint64 coalesceKey = -1);
+    
+    /**
+     * @brief 只向本节点的连接投递帧，不经集群转发（供集群总线投递转发来的帧）
+     * @return 成功发送的用户数量
+     */
+    int deliverLocalFrame(const RecipientList &userIds, const EncodedFrame &frame,
+                          OutboundLanes::Lane lane, qint64 coalesceKey);
+    
+    /**
+     * @brief 用户是否连接在本节点（包括休眠连接）
+     */
+    bool isUserLocal(qint64 userId) const;
+    
+    /**
+     * @brief 本节点所有已认证用户的ID（包括休眠连接），用于续期集群在线目录
+     */
+    QList<qint64> localUserIds() const;
 
 signals:
     /**
@@ -147,6 +207,9 @@ private slots:
     void onClientMessageReceived(ClientHandler* client, const QJsonObject &message);
     void performHealthCheck();
     void balanceLoad();
+    void hibernateIdleClients();
+    void onHibernatedWake(const ConnectionHibernator::HibernatedConnection &connection);
+    void onHibernatedExpired(const ConnectionHibernator::HibernatedConnection &connection);
 
 private:
     /**
@@ -184,6 +247,53 @@ private:
      * @return 线程池指针
      */
     QThreadPool* selectBestThreadPool();
+    
+    /**
+     * @brief 连接客户端处理器的信号到服务器（需在服务器线程中调用）
+     */
+    void attachClient(ClientHandler* client);
+    
+    /**
+     * @brief 由休眠记录重建客户端处理器并登记，调用者需持有客户端表锁
+     * @return 重建的处理器，失败时返回nullptr（连接已关闭）
+     */
+    ClientHandler* rehydrateLocked(const ConnectionHibernator::HibernatedConnection &connection);
+    
+    /**
+     * @brief 唤醒休眠的用户连接，调用者需持有客户端表锁且位于服务器线程
+     */
+    ClientHandler* wakeHibernatedLocked(qint64 userId);
+    
+    /**
+     * @brief 等待跨线程发送的结果，调用时不能持有客户端表锁
+     */
+    bool confirmSend(qint64 userId, const QSharedPointer<FrameReceipt> &receipt);
+    
+    /**
+     * @brief 暂存发往休眠用户的帧，唤醒时按原通道投递，调用者需持有客户端表锁
+     * @param coalesceKey 不小于0时替换同一通道中合并键相同的暂存帧
+     * @return 暂存帧数是否超过上限（需要唤醒连接）
+     */
+    bool holdForHibernatedLocked(qint64 userId, const EncodedFrame &frame,
+                                 OutboundLanes::Lane lane, qint64 coalesceKey);
+    
+    /**
+     * @brief 唤醒休眠的用户连接，不在服务器线程时转到服务器线程执行
+     */
+    void wakeHibernated(const RecipientList &userIds);
+    
+    /**
+     * @brief 关闭休眠连接并完成断开后的清理
+     * @param notifyLogout 是否发出用户登出信号（被新会话替换时不发出）
+     */
+    void closeHibernated(const ConnectionHibernator::HibernatedConnection &connection, bool notifyLogout);
+    
+    /**
+     * @brief 向本节点的连接投递帧
+     * @param notLocal 非空时收集既未连接也未休眠的用户
+     */
+    int sendFrameLocally(const RecipientList &userIds, const EncodedFrame &frame,
+                         OutboundLanes::Lane lane, qint64 coalesceKey, RecipientList *notLocal);
 
 private:
     static ThreadPoolServer* s_instance;
@@ -208,11 +318,27 @@ private:
     QAtomicInt _totalConnections;
     QAtomicInt _activeConnections;
     QAtomicInt _rejectedConnections;
+    QAtomicInt _lagRejectedConnections;
     QDateTime _startTime;
     
     // 定时器
     QTimer* _healthCheckTimer;
     QTimer* _loadBalanceTimer;
+    QTimer* _hibernateTimer;
+    
+    // 空闲连接休眠表
+    ConnectionHibernator* _hibernator;
+    
+    // 发往休眠连接的暂存帧
+    struct HeldFrame {
+        EncodedFrame frame;
+        OutboundLanes::Lane lane;
+        qint64 coalesceKey;
+    };
+    QHash<qint64, QList<HeldFrame>> _heldFrames;     // 用户ID -> 暂存帧，受客户端表锁保护
+    
+    // io_uring传输，未启用时使用Qt套接字
+    IoUringTransport* _ioUring;
     
     bool _useTLS;
     bool _initialized;
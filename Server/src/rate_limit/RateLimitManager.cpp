@@ -203,6 +203,56 @@ void RateLimitManager::refillTokens(const QString& identifier, const QString& en
     refillTokenBucket(identifier, endpoint);
 }
 
+int RateLimitManager::saveWarmState(QDataStream& out)
+{
+    QMutexLocker locker(&_mutex);
+    
+    out << static_cast<quint32>(_rateLimitMap.size());
+    for (auto it = _rateLimitMap.constBegin(); it != _rateLimitMap.constEnd(); ++it) {
+        const RateLimitInfo& info = it.value();
+        out << it.key() << static_cast<qint32>(info.requestCount) << info.windowStart << info.windowEnd
+            << static_cast<qint32>(info.tokenBucket.tokens) << static_cast<qint32>(info.tokenBucket.maxTokens)
+            << info.tokenBucket.lastRefillTime;
+    }
+    
+    return _rateLimitMap.size();
+}
+
+int RateLimitManager::restoreWarmState(QDataStream& in, qint64 savedAtSecs)
+{
+    Q_UNUSED(savedAtSecs)
+    
+    QMutexLocker locker(&_mutex);
+    
+    quint32 count = 0;
+    in >> count;
+    
+    int restored = 0;
+    qint64 currentTime = QDateTime::currentSecsSinceEpoch();
+    for (quint32 i = 0; i < count && in.status() == QDataStream::Ok; ++i) {
+        QString key;
+        qint32 requestCount = 0;
+        qint32 tokens = 0;
+        qint32 maxTokens = 0;
+        RateLimitInfo info;
+        in >> key >> requestCount >> info.windowStart >> info.windowEnd
+           >> tokens >> maxTokens >> info.tokenBucket.lastRefillTime;
+        info.requestCount = requestCount;
+        info.tokenBucket.tokens = tokens;
+        info.tokenBucket.maxTokens = maxTokens;
+        
+        // 窗口已结束的记录不再影响限流判断，与定期清理保持一致
+        if (in.status() != QDataStream::Ok || currentTime > info.windowEnd || _rateLimitMap.contains(key)) {
+            continue;
+        }
+        
+        _rateLimitMap[key] = info;
+        restored++;
+    }
+    
+    return restored;
+}
+
 void RateLimitManager::cleanupExpiredEntries()
 {
     QMutexLocker locker(&_mutex);
@@ -7,6 +7,7 @@
 #include <QMutex>
 #include <QAtomicInt>
 #include <QDateTime>
+#include <QDataStream>
 #include <QJsonObject>
 #include <QJsonArray>
 #include <QJsonDocument>
@@ -65,6 +66,11 @@ public:
     bool consumeToken(const QString& identifier, const QString& endpoint);
     int getAvailableTokens(const QString& identifier, const QString& endpoint);
     void refillTokens(const QString& identifier, const QString& endpoint);
+    
+    // 热状态快照（窗口和令牌桶使用绝对时间，恢复后按停机时长自然补充）
+    static const quint32 WARM_STATE_VERSION = 1;
+    int saveWarmState(QDataStream& out);
+    int restoreWarmState(QDataStream& in, qint64 savedAtSecs);
 
 private:
     explicit RateLimitManager(QObject *parent = nullptr);
@@ -0,0 +1,307 @@
+#include "KernelTls.h"
+#include "OpenSSLHelper.h"
+#include "CertificateManager.h"
+#include "../utils/Logger.h"
+#include <QElapsedTimer>
+
+#include <openssl/ssl.h>
+#include <openssl/bio.h>
+#include <openssl/err.h>
+
+#ifdef Q_OS_LINUX
+#include <linux/tls.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+#include <poll.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+
+#ifndef TCP_ULP
+#define TCP_ULP 31
+#endif
+#ifndef SOL_TLS
+#define SOL_TLS 282
+#endif
+#endif
+
+#if defined(Q_OS_LINUX) && !defined(OPENSSL_NO_KTLS) && defined(SSL_OP_ENABLE_KTLS)
+#define QKCHAT_HAVE_KTLS 1
+#endif
+
+// 静态成员初始化
+KernelTls* KernelTls::s_instance = nullptr;
+QMutex KernelTls::s_instanceMutex;
+
+#ifdef QKCHAT_HAVE_KTLS
+
+namespace {
+
+/**
+ * @brief 在回环连接上试装tls模块和AES-GCM密钥，确认内核收发两个方向都可用
+ */
+bool probeKernelTls()
+{
+    int listener = ::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (listener < 0) {
+        return false;
+    }
+
+    sockaddr_in address;
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t addressLength = sizeof(address);
+
+    int client = -1;
+    int server = -1;
+    bool supported = false;
+
+    if (::bind(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0
+        && ::listen(listener, 1) == 0
+        && ::getsockname(listener, reinterpret_cast<sockaddr*>(&address), &addressLength) == 0) {
+        client = ::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (client >= 0 && ::connect(client, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0) {
+            server = ::accept4(listener, nullptr, nullptr, SOCK_CLOEXEC);
+        }
+    }
+
+    if (server >= 0 && ::setsockopt(server, SOL_TCP, TCP_ULP, "tls", sizeof("tls")) == 0) {
+        tls12_crypto_info_aes_gcm_128 cryptoInfo;
+        memset(&cryptoInfo, 0, sizeof(cryptoInfo));
+        cryptoInfo.info.version = TLS_1_2_VERSION;
+        cryptoInfo.info.cipher_type = TLS_CIPHER_AES_GCM_128;
+        supported = ::setsockopt(server, SOL_TLS, TLS_TX, &cryptoInfo, sizeof(cryptoInfo)) == 0
+                    && ::setsockopt(server, SOL_TLS, TLS_RX, &cryptoInfo, sizeof(cryptoInfo)) == 0;
+    }
+
+    if (server >= 0) {
+        ::close(server);
+    }
+    if (client >= 0) {
+        ::close(client);
+    }
+    ::close(listener);
+    return supported;
+}
+
+} // namespace
+
+#endif
+
+KernelTls::KernelTls(QObject *parent)
+    : QObject(parent)
+    , _context(nullptr)
+    , _handshakes(0)
+    , _offloaded(0)
+    , _handshakeFailures(0)
+    , _partialOffloads(0)
+    , _handshakeMicros(0)
+{
+}
+
+KernelTls::~KernelTls()
+{
+    shutdown();
+}
+
+KernelTls* KernelTls::instance()
+{
+    if (!s_instance) {
+        QMutexLocker locker(&s_instanceMutex);
+        if (!s_instance) {
+            s_instance = new KernelTls();
+        }
+    }
+    return s_instance;
+}
+
+bool KernelTls::isSupported()
+{
+#ifdef QKCHAT_HAVE_KTLS
+    static const bool supported = probeKernelTls();
+    return supported;
+#else
+    return false;
+#endif
+}
+
+bool KernelTls::initialize(const Config &config)
+{
+    _config = config;
+
+    if (!_config.enabled) {
+        return false;
+    }
+
+    if (!isSupported()) {
+        LOG_WARNING("Kernel TLS requested but not supported by kernel or OpenSSL build, using QSslSocket");
+        return false;
+    }
+
+    if (!rebuildContext()) {
+        LOG_WARNING("Failed to create kernel TLS context, using QSslSocket");
+        return false;
+    }
+
+    connect(CertificateManager::instance(), &CertificateManager::certificateLoaded,
+            this, &KernelTls::onCertificateLoaded, Qt::UniqueConnection);
+
+    LOG_INFO("Kernel TLS offload enabled");
+    return true;
+}
+
+void KernelTls::shutdown()
+{
+    QMutexLocker locker(&_mutex);
+    if (_context) {
+        SSL_CTX_free(_context);
+        _context = nullptr;
+    }
+}
+
+bool KernelTls::isEnabled() const
+{
+    QMutexLocker locker(&_mutex);
+    return _context != nullptr;
+}
+
+bool KernelTls::rebuildContext()
+{
+    CertificateManager *certManager = CertificateManager::instance();
+    SSL_CTX *context = OpenSSLHelper::createKernelTlsServerContext(certManager->getCurrentCertificate(),
+                                                                   certManager->getCurrentPrivateKey(),
+                                                                   _config.cipherList);
+    if (!context) {
+        return false;
+    }
+
+    // SSL对象持有上下文引用，替换后进行中的握手不受影响
+    QMutexLocker locker(&_mutex);
+    if (_context) {
+        SSL_CTX_free(_context);
+    }
+    _context = context;
+    return true;
+}
+
+void KernelTls::onCertificateLoaded()
+{
+    if (!isEnabled()) {
+        return;
+    }
+
+    if (rebuildContext()) {
+        LOG_INFO("Kernel TLS context rebuilt with reloaded certificate");
+    } else {
+        LOG_WARNING("Failed to rebuild kernel TLS context, keeping previous certificate");
+    }
+}
+
+bool KernelTls::acceptHandshake(qintptr socketDescriptor)
+{
+#ifdef QKCHAT_HAVE_KTLS
+    SSL *ssl = nullptr;
+    {
+        QMutexLocker locker(&_mutex);
+        if (!_context) {
+            return false;
+        }
+        ssl = SSL_new(_context);
+    }
+    if (!ssl) {
+        _handshakeFailures.fetchAndAddOrdered(1);
+        return false;
+    }
+
+    int fd = static_cast<int>(socketDescriptor);
+    SSL_set_fd(ssl, fd);
+    _handshakes.fetchAndAddOrdered(1);
+
+    QElapsedTimer timer;
+    timer.start();
+    bool completed = false;
+
+    // 描述符可能是非阻塞的，按OpenSSL的要求等待可读或可写，直到完成或超时
+    forever {
+        ERR_clear_error();
+        int result = SSL_accept(ssl);
+        if (result == 1) {
+            completed = true;
+            break;
+        }
+
+        int error = SSL_get_error(ssl, result);
+        short events = 0;
+        if (error == SSL_ERROR_WANT_READ) {
+            events = POLLIN;
+        } else if (error == SSL_ERROR_WANT_WRITE) {
+            events = POLLOUT;
+        } else {
+            break;
+        }
+
+        qint64 remaining = _config.handshakeTimeoutMs - timer.elapsed();
+        if (remaining <= 0) {
+            break;
+        }
+
+        pollfd pfd;
+        pfd.fd = fd;
+        pfd.events = events;
+        pfd.revents = 0;
+        int ready = ::poll(&pfd, 1, static_cast<int>(remaining));
+        if (ready < 0 && errno == EINTR) {
+            continue;
+        }
+        if (ready <= 0) {
+            break;
+        }
+    }
+
+    bool sendOffloaded = completed && BIO_get_ktls_send(SSL_get_wbio(ssl));
+    bool recvOffloaded = completed && BIO_get_ktls_recv(SSL_get_rbio(ssl));
+
+    // 释放SSL对象不会发送任何数据，也不会关闭描述符，内核中的密钥随套接字保留
+    SSL_free(ssl);
+
+    _handshakeMicros.fetchAndAddOrdered(timer.nsecsElapsed() / 1000);
+
+    if (!completed) {
+        _handshakeFailures.fetchAndAddOrdered(1);
+        LOG_WARNING(QString("Kernel TLS handshake failed on descriptor %1").arg(socketDescriptor));
+        return false;
+    }
+
+    if (!sendOffloaded || !recvOffloaded) {
+        // 握手后的记录状态已在用户态，无法再交给QSslSocket，只能关闭连接
+        _partialOffloads.fetchAndAddOrdered(1);
+        LOG_WARNING(QString("Kernel TLS offload incomplete on descriptor %1 (tx=%2, rx=%3)")
+                    .arg(socketDescriptor).arg(sendOffloaded).arg(recvOffloaded));
+        return false;
+    }
+
+    _offloaded.fetchAndAddOrdered(1);
+    return true;
+#else
+    Q_UNUSED(socketDescriptor)
+    return false;
+#endif
+}
+
+QJsonObject KernelTls::getStatistics() const
+{
+    QJsonObject stats;
+    int handshakes = _handshakes.loadAcquire();
+    stats["enabled"] = isEnabled();
+    stats["supported"] = isSupported();
+    stats["handshakes"] = handshakes;
+    stats["offloaded"] = _offloaded.loadAcquire();
+    stats["handshake_failures"] = _handshakeFailures.loadAcquire();
+    stats["partial_offloads"] = _partialOffloads.loadAcquire();
+    stats["avg_handshake_ms"] = handshakes > 0
+        ? static_cast<double>(_handshakeMicros.loadAcquire()) / handshakes / 1000.0 : 0.0;
+    return stats;
+}
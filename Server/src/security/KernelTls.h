@@ -0,0 +1,99 @@
+#ifndef KERNELTLS_H
+#define KERNELTLS_H
+
+#include <QObject>
+#include <QMutex>
+#include <QAtomicInt>
+#include <QAtomicInteger>
+#include <QJsonObject>
+
+typedef struct ssl_ctx_st SSL_CTX;
+
+/**
+ * @brief 内核TLS（kTLS）卸载
+ *
+ * 在工作线程中用OpenSSL完成服务器端握手，随后把会话密钥装入内核套接字，
+ * 记录层的加解密由内核完成：之后该描述符可像明文套接字一样由QTcpSocket或io_uring收发，
+ * write/sendfile的数据在内核中加密，无需在用户态复制和加密。
+ *
+ * 仅支持Linux（需加载tls模块）与带kTLS支持编译的OpenSSL 3.0+；
+ * 启动时探测不到内核支持则保持关闭，服务器继续使用QSslSocket。
+ */
+class KernelTls : public QObject
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @brief 内核TLS配置
+     */
+    struct Config {
+        bool enabled = false;
+        int handshakeTimeoutMs = 10000;   // 握手超时时间(ms)
+        QString cipherList = "ECDHE-ECDSA-AES128-GCM-SHA256:ECDHE-RSA-AES128-GCM-SHA256:"
+                             "ECDHE-ECDSA-AES256-GCM-SHA384:ECDHE-RSA-AES256-GCM-SHA384";
+    };
+
+    static KernelTls* instance();
+
+    /**
+     * @brief 探测内核支持并用当前证书创建SSL上下文
+     * @return 是否启用，失败时调用者应继续使用QSslSocket
+     */
+    bool initialize(const Config &config);
+
+    /**
+     * @brief 释放SSL上下文并关闭卸载
+     */
+    void shutdown();
+
+    bool isEnabled() const;
+
+    /**
+     * @brief 内核与OpenSSL是否支持TLS记录层卸载
+     */
+    static bool isSupported();
+
+    /**
+     * @brief 在已连接的套接字上完成握手并装入内核密钥（阻塞，须在工作线程调用）
+     * @param socketDescriptor 套接字描述符，成功后可直接收发明文
+     * @return 收发两个方向均已卸载时返回true；失败时描述符状态不可再用，调用者应关闭
+     */
+    bool acceptHandshake(qintptr socketDescriptor);
+
+    /**
+     * @brief 获取卸载统计信息
+     */
+    QJsonObject getStatistics() const;
+
+private slots:
+    /**
+     * @brief 证书重新加载后重建SSL上下文，进行中的握手继续使用旧上下文
+     */
+    void onCertificateLoaded();
+
+private:
+    explicit KernelTls(QObject *parent = nullptr);
+    ~KernelTls();
+
+    /**
+     * @brief 用证书管理器中的当前证书创建SSL上下文
+     */
+    bool rebuildContext();
+
+    static KernelTls* s_instance;
+    static QMutex s_instanceMutex;
+
+    Config _config;
+    mutable QMutex _mutex;
+    SSL_CTX *_context;
+
+    // 统计信息
+    QAtomicInt _handshakes;
+    QAtomicInt _offloaded;
+    QAtomicInt _handshakeFailures;
+    QAtomicInt _partialOffloads;
+    QAtomicInteger<qint64> _handshakeMicros;
+};
+
+#endif // KERNELTLS_H
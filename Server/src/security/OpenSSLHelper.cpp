@@ -617,3 +617,50 @@ QSslCertificate OpenSSLHelper::signCertificateRequest(const QByteArray &csr,
 
     return result;
 }
+
+SSL_CTX* OpenSSLHelper::createKernelTlsServerContext(const QSslCertificate &certificate,
+                                                     const QSslKey &privateKey,
+                                                     const QString &cipherList)
+{
+    if (!initializeOpenSSL()) {
+        return nullptr;
+    }
+
+    SSL_CTX *ctx = SSL_CTX_new(TLS_server_method());
+    if (!ctx) {
+        LOG_ERROR("Failed to create SSL context for kernel TLS");
+        return nullptr;
+    }
+
+    // TLS 1.3的会话票据等握手后消息会打断内核接收路径，这里固定使用TLS 1.2
+    SSL_CTX_set_min_proto_version(ctx, TLS1_2_VERSION);
+    SSL_CTX_set_max_proto_version(ctx, TLS1_2_VERSION);
+    SSL_CTX_set_options(ctx, SSL_OP_NO_TICKET | SSL_OP_NO_RENEGOTIATION | SSL_OP_NO_COMPRESSION);
+#ifdef SSL_OP_ENABLE_KTLS
+    SSL_CTX_set_options(ctx, SSL_OP_ENABLE_KTLS);
+#endif
+    SSL_CTX_set_session_cache_mode(ctx, SSL_SESS_CACHE_OFF);
+
+    if (SSL_CTX_set_cipher_list(ctx, cipherList.toLatin1().constData()) != 1) {
+        LOG_ERROR(QString("No usable cipher for kernel TLS in: %1").arg(cipherList));
+        SSL_CTX_free(ctx);
+        return nullptr;
+    }
+
+    X509 *x509 = static_cast<X509*>(qSslCertificateToX509(certificate));
+    EVP_PKEY *pkey = qSslKeyToEvpKey(privateKey);
+    bool loaded = x509 && pkey
+                  && SSL_CTX_use_certificate(ctx, x509) == 1
+                  && SSL_CTX_use_PrivateKey(ctx, pkey) == 1
+                  && SSL_CTX_check_private_key(ctx) == 1;
+    X509_free(x509);
+    EVP_PKEY_free(pkey);
+
+    if (!loaded) {
+        LOG_ERROR("Failed to load server certificate into kernel TLS context");
+        SSL_CTX_free(ctx);
+        return nullptr;
+    }
+
+    return ctx;
+}
@@ -9,6 +9,7 @@
 // OpenSSL前向声明（仅用于Qt类型转换）
 typedef struct evp_pkey_st EVP_PKEY;
 typedef struct bignum_st BIGNUM;
+typedef struct ssl_ctx_st SSL_CTX;
 
 /**
  * @brief OpenSSL辅助工具类
@@ -121,6 +122,20 @@ public:
      * @return 是否匹配
      */
     static bool isKeyPairMatching(const QSslKey &privateKey, const QSslCertificate &certificate);
+    
+    /**
+     * @brief 创建启用内核TLS（kTLS）的服务器上下文
+     * 
+     * 限定TLS 1.2与内核支持的AES-GCM套件，关闭会话票据与重协商，
+     * 握手完成后记录层由内核接管，之后不会再出现需要用户态处理的握手消息。
+     * @param certificate 服务器证书
+     * @param privateKey 服务器私钥
+     * @param cipherList 允许的密码套件
+     * @return SSL_CTX对象，失败返回nullptr，调用者负责SSL_CTX_free
+     */
+    static SSL_CTX* createKernelTlsServerContext(const QSslCertificate &certificate,
+                                                 const QSslKey &privateKey,
+                                                 const QString &cipherList);
 
 private:
     /**
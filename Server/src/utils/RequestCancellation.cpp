@@ -0,0 +1,287 @@
+#include "RequestCancellation.h"
+#include "Logger.h"
+#include "../database/DatabaseConnectionPool.h"
+#include <QThreadPool>
+#include <QSqlQuery>
+#include <QSqlError>
+#include <chrono>
+
+// 静态成员初始化
+RequestCancellation* RequestCancellation::s_instance = nullptr;
+QMutex RequestCancellation::s_instanceMutex;
+
+namespace {
+
+thread_local RequestTokenPtr t_currentToken;
+
+} // namespace
+
+RequestToken::RequestToken(const QString &clientId, const QString &requestId, qint64 deadlineNs)
+    : _clientId(clientId)
+    , _requestId(requestId)
+    , _deadlineNs(deadlineNs)
+    , _cancelled(0)
+    , _readOnly(false)
+    , _runningQueryConnection(0)
+{
+}
+
+bool RequestToken::isExpired() const
+{
+    return _deadlineNs > 0 && RequestCancellation::nowNs() >= _deadlineNs;
+}
+
+qint64 RequestToken::remainingMs() const
+{
+    if (_deadlineNs <= 0) {
+        return -1;
+    }
+    return qMax<qint64>(0, (_deadlineNs - RequestCancellation::nowNs()) / 1000000);
+}
+
+RequestCancellation::RequestCancellation(QObject *parent)
+    : QObject(parent)
+    , _begun(0)
+    , _withDeadline(0)
+    , _cancelRequests(0)
+    , _cancelMisses(0)
+    , _droppedBeforeExecution(0)
+    , _droppedAfterExecution(0)
+    , _droppedExpired(0)
+    , _droppedCancelled(0)
+    , _queriesSkipped(0)
+    , _queriesAborted(0)
+    , _queriesKilled(0)
+{
+}
+
+RequestCancellation* RequestCancellation::instance()
+{
+    if (!s_instance) {
+        QMutexLocker locker(&s_instanceMutex);
+        if (!s_instance) {
+            s_instance = new RequestCancellation();
+        }
+    }
+    return s_instance;
+}
+
+void RequestCancellation::configure(const Config &config)
+{
+    _config = config;
+}
+
+qint64 RequestCancellation::nowNs()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+RequestTokenPtr RequestCancellation::begin(const QString &clientId, const QString &requestId, qint64 deadlineMs)
+{
+    if (!_config.enabled) {
+        return RequestTokenPtr();
+    }
+
+    if (deadlineMs <= 0) {
+        deadlineMs = _config.defaultDeadlineMs;
+    }
+    if (_config.maxDeadlineMs > 0 && deadlineMs > _config.maxDeadlineMs) {
+        deadlineMs = _config.maxDeadlineMs;
+    }
+
+    qint64 deadlineNs = deadlineMs > 0 ? nowNs() + deadlineMs * 1000000 : 0;
+    RequestTokenPtr token(new RequestToken(clientId, requestId, deadlineNs));
+
+    _begun.fetchAndAddOrdered(1);
+    if (deadlineNs > 0) {
+        _withDeadline.fetchAndAddOrdered(1);
+    }
+
+    // 没有请求ID的请求无法被取消，只受截止时间约束
+    if (!requestId.isEmpty()) {
+        QMutexLocker locker(&_mutex);
+        _tokens[clientId].insert(requestId, token);
+    }
+    return token;
+}
+
+void RequestCancellation::finish(const RequestTokenPtr &token)
+{
+    if (!token || token->requestId().isEmpty()) {
+        return;
+    }
+
+    QMutexLocker locker(&_mutex);
+    auto it = _tokens.find(token->clientId());
+    if (it == _tokens.end()) {
+        return;
+    }
+
+    // 同一请求ID可能被重发，只移除自己登记的令牌
+    if (it->value(token->requestId()) == token) {
+        it->remove(token->requestId());
+    }
+    if (it->isEmpty()) {
+        _tokens.erase(it);
+    }
+}
+
+bool RequestCancellation::cancel(const QString &clientId, const QString &requestId)
+{
+    _cancelRequests.fetchAndAddOrdered(1);
+
+    RequestTokenPtr token;
+    {
+        QMutexLocker locker(&_mutex);
+        token = _tokens.value(clientId).value(requestId);
+    }
+
+    if (!token) {
+        // 请求已完成或从未到达
+        _cancelMisses.fetchAndAddOrdered(1);
+        return false;
+    }
+
+    token->_cancelled.storeRelease(1);
+    if (_config.killRunningQueries) {
+        killRunningQuery(token);
+    }
+    return true;
+}
+
+void RequestCancellation::cancelClient(const QString &clientId)
+{
+    QHash<QString, RequestTokenPtr> tokens;
+    {
+        QMutexLocker locker(&_mutex);
+        tokens = _tokens.take(clientId);
+    }
+
+    for (const RequestTokenPtr &token : tokens) {
+        token->_cancelled.storeRelease(1);
+        if (_config.killRunningQueries) {
+            killRunningQuery(token);
+        }
+    }
+}
+
+void RequestCancellation::recordDrop(const RequestTokenPtr &token, DropPoint point)
+{
+    if (point == BeforeExecution) {
+        _droppedBeforeExecution.fetchAndAddOrdered(1);
+    } else {
+        _droppedAfterExecution.fetchAndAddOrdered(1);
+    }
+
+    if (token && token->isCancelled()) {
+        _droppedCancelled.fetchAndAddOrdered(1);
+    } else {
+        _droppedExpired.fetchAndAddOrdered(1);
+    }
+}
+
+void RequestCancellation::recordQueryAbort(bool skipped)
+{
+    if (skipped) {
+        _queriesSkipped.fetchAndAddOrdered(1);
+    } else {
+        _queriesAborted.fetchAndAddOrdered(1);
+    }
+}
+
+RequestTokenPtr RequestCancellation::current()
+{
+    return t_currentToken;
+}
+
+void RequestCancellation::beginQuery(const RequestTokenPtr &token, qint64 connectionId)
+{
+    if (!token) {
+        return;
+    }
+    QMutexLocker locker(&token->_queryMutex);
+    token->_runningQueryConnection = connectionId;
+}
+
+void RequestCancellation::endQuery(const RequestTokenPtr &token)
+{
+    if (!token) {
+        return;
+    }
+    // 取消线程持锁执行KILL时在此等待，保证被中止的一定是本请求的查询
+    QMutexLocker locker(&token->_queryMutex);
+    token->_runningQueryConnection = 0;
+}
+
+void RequestCancellation::killRunningQuery(const RequestTokenPtr &token)
+{
+    {
+        QMutexLocker locker(&token->_queryMutex);
+        if (token->_runningQueryConnection <= 0) {
+            return;
+        }
+    }
+
+    // KILL需要另一条连接，放到全局线程池执行，不阻塞调用者所在的事件循环
+    QThreadPool::globalInstance()->start([this, token]() {
+        // 先取连接再持锁，避免查询线程在endQuery()上等待连接池
+        DatabaseConnection dbConn(1000);
+        if (!dbConn.isValid()) {
+            LOG_WARNING(QString("No database connection available to cancel request %1").arg(token->requestId()));
+            return;
+        }
+
+        QMutexLocker locker(&token->_queryMutex);
+        qint64 connectionId = token->_runningQueryConnection;
+        if (connectionId <= 0) {
+            return;
+        }
+
+        QSqlQuery query(dbConn.database());
+        if (query.exec(QString("KILL QUERY %1").arg(connectionId))) {
+            _queriesKilled.fetchAndAddOrdered(1);
+        } else {
+            LOG_WARNING(QString("Failed to kill query for request %1: %2")
+                        .arg(token->requestId()).arg(query.lastError().text()));
+        }
+    });
+}
+
+RequestCancellation::Scope::Scope(const RequestTokenPtr &token)
+    : _previous(t_currentToken)
+{
+    t_currentToken = token;
+}
+
+RequestCancellation::Scope::~Scope()
+{
+    t_currentToken = _previous;
+}
+
+QJsonObject RequestCancellation::getStatistics() const
+{
+    QJsonObject stats;
+    stats["enabled"] = _config.enabled;
+    stats["default_deadline_ms"] = _config.defaultDeadlineMs;
+    stats["requests"] = _begun.loadAcquire();
+    stats["requests_with_deadline"] = _withDeadline.loadAcquire();
+    stats["cancel_requests"] = _cancelRequests.loadAcquire();
+    stats["cancel_misses"] = _cancelMisses.loadAcquire();
+    stats["dropped_before_execution"] = _droppedBeforeExecution.loadAcquire();
+    stats["dropped_after_execution"] = _droppedAfterExecution.loadAcquire();
+    stats["dropped_expired"] = _droppedExpired.loadAcquire();
+    stats["dropped_cancelled"] = _droppedCancelled.loadAcquire();
+    stats["queries_skipped"] = _queriesSkipped.loadAcquire();
+    stats["queries_aborted"] = _queriesAborted.loadAcquire();
+    stats["queries_killed"] = _queriesKilled.loadAcquire();
+    {
+        QMutexLocker locker(&_mutex);
+        int active = 0;
+        for (const auto &requests : _tokens) {
+            active += requests.size();
+        }
+        stats["active_requests"] = active;
+    }
+    return stats;
+}
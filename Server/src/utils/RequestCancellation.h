@@ -0,0 +1,197 @@
+#ifndef REQUESTCANCELLATION_H
+#define REQUESTCANCELLATION_H
+
+#include <QObject>
+#include <QMutex>
+#include <QHash>
+#include <QString>
+#include <QSharedPointer>
+#include <QAtomicInt>
+#include <QAtomicInteger>
+#include <QJsonObject>
+
+/**
+ * @brief 单个请求的截止时间与取消状态
+ *
+ * 由接收请求的线程创建，执行请求的工作线程和数据库层通过RequestCancellation::current()读取。
+ */
+class RequestToken
+{
+public:
+    RequestToken(const QString &clientId, const QString &requestId, qint64 deadlineNs);
+
+    const QString &clientId() const { return _clientId; }
+    const QString &requestId() const { return _requestId; }
+
+    bool isCancelled() const { return _cancelled.loadAcquire() != 0; }
+    bool isExpired() const;
+
+    /**
+     * @brief 请求已取消或已过截止时间，结果不再有人等待
+     */
+    bool shouldAbort() const { return isCancelled() || isExpired(); }
+
+    /**
+     * @brief 距截止时间的剩余毫秒数，无截止时间时返回-1
+     */
+    qint64 remainingMs() const;
+
+    /**
+     * @brief 标记请求只读（由只读阶段在提交前设置）
+     *
+     * 只有只读请求中事务外的SELECT会在截止后跳过、带MAX_EXECUTION_TIME提示并可被KILL QUERY中止。
+     */
+    void setReadOnly(bool readOnly) { _readOnly = readOnly; }
+    bool isReadOnly() const { return _readOnly; }
+
+private:
+    friend class RequestCancellation;
+
+    QString _clientId;
+    QString _requestId;
+    qint64 _deadlineNs;                  // 单调时钟上的截止时间，0表示无
+    QAtomicInt _cancelled;
+    bool _readOnly;                      // 提交前设置，执行期间只读
+
+    // 正在执行的查询所在的MySQL连接ID，取消时据此中止查询
+    QMutex _queryMutex;
+    qint64 _runningQueryConnection;
+};
+
+using RequestTokenPtr = QSharedPointer<RequestToken>;
+
+/**
+ * @brief 端到端请求截止时间与取消
+ *
+ * 客户端在请求中携带deadline_ms（剩余时间预算），服务器收到时换算成本地截止时间；
+ * 客户端也可发送cancel动作取消尚未完成的请求。过期或已取消的请求在执行前丢弃，
+ * 只读请求执行中的查询通过MAX_EXECUTION_TIME提示按剩余时间限制，取消时用KILL QUERY中止。
+ * 写操作一旦开始执行不会被中途打断，避免留下部分完成的状态。
+ */
+class RequestCancellation : public QObject
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @brief 截止时间配置
+     */
+    struct Config {
+        bool enabled = true;
+        int defaultDeadlineMs = 0;         // 请求未携带deadline_ms时使用，0表示不限制
+        int maxDeadlineMs = 60000;         // 客户端可请求的最长时间预算
+        bool killRunningQueries = true;    // 取消时是否中止执行中的查询
+    };
+
+    /**
+     * @brief 丢弃发生的位置
+     */
+    enum DropPoint {
+        BeforeExecution,                   // 出队时已过期或已取消，未执行
+        AfterExecution                     // 已执行完，结果不再发送
+    };
+
+    static RequestCancellation* instance();
+
+    void configure(const Config &config);
+    bool isEnabled() const { return _config.enabled; }
+
+    /**
+     * @brief 登记收到的请求
+     * @param deadlineMs 客户端给出的时间预算(ms)，<=0时使用默认值
+     * @return 请求令牌，未启用时返回空指针
+     */
+    RequestTokenPtr begin(const QString &clientId, const QString &requestId, qint64 deadlineMs);
+
+    /**
+     * @brief 请求处理结束，从登记表移除
+     */
+    void finish(const RequestTokenPtr &token);
+
+    /**
+     * @brief 取消连接上的某个请求
+     * @return 请求仍在登记表中时返回true
+     */
+    bool cancel(const QString &clientId, const QString &requestId);
+
+    /**
+     * @brief 连接断开时取消其全部请求
+     */
+    void cancelClient(const QString &clientId);
+
+    /**
+     * @brief 记录一次丢弃
+     */
+    void recordDrop(const RequestTokenPtr &token, DropPoint point);
+
+    /**
+     * @brief 记录一次因截止时间或取消而未执行或被中止的查询
+     */
+    void recordQueryAbort(bool skipped);
+
+    /**
+     * @brief 当前线程正在处理的请求，不在请求作用域内时为空
+     */
+    static RequestTokenPtr current();
+
+    /**
+     * @brief 登记/清除令牌上正在执行的查询，取消时据此中止
+     */
+    void beginQuery(const RequestTokenPtr &token, qint64 connectionId);
+    void endQuery(const RequestTokenPtr &token);
+
+    /**
+     * @brief 请求作用域：作用域内当前线程执行的查询受该请求的截止时间与取消约束
+     */
+    class Scope
+    {
+    public:
+        explicit Scope(const RequestTokenPtr &token);
+        ~Scope();
+
+    private:
+        RequestTokenPtr _previous;
+    };
+
+    /**
+     * @brief 获取截止时间与取消统计信息
+     */
+    QJsonObject getStatistics() const;
+
+    /**
+     * @brief 单调时钟，与令牌截止时间使用同一时基
+     */
+    static qint64 nowNs();
+
+private:
+    explicit RequestCancellation(QObject *parent = nullptr);
+
+    /**
+     * @brief 在后台线程用独立连接中止令牌上正在执行的查询
+     */
+    void killRunningQuery(const RequestTokenPtr &token);
+
+    static RequestCancellation* s_instance;
+    static QMutex s_instanceMutex;
+
+    Config _config;
+
+    // 登记表：连接ID -> (请求ID -> 令牌)
+    mutable QMutex _mutex;
+    QHash<QString, QHash<QString, RequestTokenPtr>> _tokens;
+
+    // 统计信息
+    QAtomicInteger<qint64> _begun;
+    QAtomicInteger<qint64> _withDeadline;
+    QAtomicInteger<qint64> _cancelRequests;
+    QAtomicInteger<qint64> _cancelMisses;
+    QAtomicInteger<qint64> _droppedBeforeExecution;
+    QAtomicInteger<qint64> _droppedAfterExecution;
+    QAtomicInteger<qint64> _droppedExpired;
+    QAtomicInteger<qint64> _droppedCancelled;
+    QAtomicInteger<qint64> _queriesSkipped;
+    QAtomicInteger<qint64> _queriesAborted;
+    QAtomicInteger<qint64> _queriesKilled;
+};
+
+#endif // REQUESTCANCELLATION_H
@@ -0,0 +1,326 @@
+#include "StartupOrchestrator.h"
+#include "Logger.h"
+#include <QJsonArray>
+#include <exception>
+
+StartupOrchestrator::StartupOrchestrator()
+    : _ready(false)
+    , _readyMs(0)
+{
+}
+
+StartupOrchestrator::~StartupOrchestrator()
+{
+    // 后台任务引用了编排器成员，析构前必须等待其结束
+    _workers.waitForDone();
+}
+
+void StartupOrchestrator::setConfig(const OrchestratorConfig &config)
+{
+    QMutexLocker locker(&_mutex);
+    _config = config;
+    _workers.setMaxThreadCount(qMax(1, config.maxWorkerThreads));
+}
+
+bool StartupOrchestrator::addTask(const QString &name, const TaskFunction &function,
+                                  const QStringList &dependencies, bool required, Affinity affinity)
+{
+    QMutexLocker locker(&_mutex);
+
+    if (name.isEmpty() || !function) {
+        LOG_ERROR("Startup task must have a name and a function");
+        return false;
+    }
+
+    if (_taskByName.contains(name)) {
+        LOG_ERROR(QString("Duplicate startup task: %1").arg(name));
+        return false;
+    }
+
+    QSharedPointer<Task> task(new Task);
+    task->name = name;
+    task->function = function;
+    task->dependencies = dependencies;
+    task->required = required;
+    task->affinity = affinity;
+
+    _tasks.append(task);
+    _taskByName.insert(name, task);
+    return true;
+}
+
+bool StartupOrchestrator::validateGraph()
+{
+    // 检查未知依赖
+    for (const QSharedPointer<Task> &task : _tasks) {
+        for (const QString &dependency : task->dependencies) {
+            if (!_taskByName.contains(dependency)) {
+                LOG_ERROR(QString("Startup task %1 depends on unknown task %2").arg(task->name, dependency));
+                _failedTask = task->name;
+                return false;
+            }
+        }
+    }
+
+    // Kahn算法检查环
+    QHash<QString, int> inDegree;
+    for (const QSharedPointer<Task> &task : _tasks) {
+        inDegree[task->name] = task->dependencies.size();
+    }
+
+    QStringList ready;
+    for (const QSharedPointer<Task> &task : _tasks) {
+        if (task->dependencies.isEmpty()) {
+            ready.append(task->name);
+        }
+    }
+
+    int visited = 0;
+    while (!ready.isEmpty()) {
+        QString current = ready.takeFirst();
+        ++visited;
+        for (const QSharedPointer<Task> &task : _tasks) {
+            if (task->dependencies.contains(current) && --inDegree[task->name] == 0) {
+                ready.append(task->name);
+            }
+        }
+    }
+
+    if (visited != _tasks.size()) {
+        LOG_ERROR("Startup task graph contains a dependency cycle");
+        return false;
+    }
+
+    return true;
+}
+
+bool StartupOrchestrator::dependenciesFinished(const Task &task) const
+{
+    // 依赖只约束执行顺序：可选依赖失败或被跳过时，后继任务仍然执行
+    for (const QString &dependency : task.dependencies) {
+        TaskStatus status = _taskByName.value(dependency)->status;
+        if (status == Pending || status == Running) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool StartupOrchestrator::executeTask(Task &task)
+{
+    try {
+        return task.function();
+    } catch (const std::exception& e) {
+        LOG_ERROR(QString("Exception in startup task %1: %2").arg(task.name, e.what()));
+    } catch (...) {
+        LOG_ERROR(QString("Unknown exception in startup task %1").arg(task.name));
+    }
+    return false;
+}
+
+void StartupOrchestrator::startWorkerTask(const QSharedPointer<Task> &task)
+{
+    _workers.start([this, task]() {
+        QElapsedTimer timer;
+        timer.start();
+        bool success = executeTask(*task);
+
+        QMutexLocker locker(&_mutex);
+        finishTask(*task, success, timer.elapsed());
+        _taskFinished.wakeAll();
+    });
+}
+
+void StartupOrchestrator::finishTask(Task &task, bool success, qint64 durationMs)
+{
+    task.status = success ? Succeeded : Failed;
+    task.durationMs = durationMs;
+
+    if (success) {
+        LOG_DEBUG(QString("Startup task %1 finished in %2 ms").arg(task.name).arg(durationMs));
+    } else if (task.required) {
+        LOG_ERROR(QString("Required startup task %1 failed after %2 ms").arg(task.name).arg(durationMs));
+        if (_failedTask.isEmpty()) {
+            _failedTask = task.name;
+        }
+    } else {
+        LOG_WARNING(QString("Optional startup task %1 failed after %2 ms").arg(task.name).arg(durationMs));
+    }
+}
+
+bool StartupOrchestrator::run()
+{
+    QMutexLocker locker(&_mutex);
+
+    if (!validateGraph()) {
+        return false;
+    }
+
+    _clock.start();
+
+    forever {
+        bool aborted = !_failedTask.isEmpty();
+
+        if (!aborted) {
+            // 先把所有可运行的并行任务派发出去，再在当前线程执行一个串行任务
+            QSharedPointer<Task> mainTask;
+            for (const QSharedPointer<Task> &task : _tasks) {
+                if (task->status != Pending || !dependenciesFinished(*task)) {
+                    continue;
+                }
+
+                if (_config.parallel && task->affinity == AnyThread) {
+                    task->status = Running;
+                    task->startMs = _clock.elapsed();
+                    startWorkerTask(task);
+                } else if (!mainTask) {
+                    mainTask = task;
+                }
+            }
+
+            if (mainTask) {
+                mainTask->status = Running;
+                mainTask->startMs = _clock.elapsed();
+
+                locker.unlock();
+                QElapsedTimer timer;
+                timer.start();
+                bool success = executeTask(*mainTask);
+                locker.relock();
+
+                finishTask(*mainTask, success, timer.elapsed());
+                continue;
+            }
+        }
+
+        bool requiredOutstanding = false;
+        bool anyRunning = false;
+        bool anyPending = false;
+        for (const QSharedPointer<Task> &task : _tasks) {
+            if (task->status == Running) {
+                anyRunning = true;
+            } else if (task->status == Pending) {
+                anyPending = true;
+            }
+            if (task->required && (task->status == Pending || task->status == Running)) {
+                requiredOutstanding = true;
+            }
+        }
+
+        if (aborted) {
+            // 等待已派发的任务结束，避免它们访问正在回滚的组件
+            if (!anyRunning) {
+                break;
+            }
+        } else {
+            if (!anyRunning && !anyPending) {
+                break;
+            }
+
+            if (!requiredOutstanding && _config.readinessTimeoutMs > 0
+                && _clock.elapsed() >= _config.readinessTimeoutMs) {
+                break;
+            }
+        }
+
+        _taskFinished.wait(&_mutex, 50);
+    }
+
+    // 就绪门控通过后，未开始的任务不再执行，仍在运行的任务转入后台
+    for (const QSharedPointer<Task> &task : _tasks) {
+        if (task->status == Pending) {
+            task->status = Skipped;
+            LOG_WARNING(QString("Startup task %1 skipped").arg(task->name));
+        } else if (task->status == Running) {
+            task->background = true;
+            LOG_WARNING(QString("Startup task %1 still running, continuing in background").arg(task->name));
+        }
+    }
+
+    _readyMs = _clock.elapsed();
+    _ready = _failedTask.isEmpty();
+
+    qint64 serialMs = 0;
+    for (const QSharedPointer<Task> &task : _tasks) {
+        serialMs += task->durationMs;
+    }
+
+    if (_ready) {
+        LOG_INFO(QString("Startup ready in %1 ms (%2 tasks, %3 ms if run serially)")
+                 .arg(_readyMs).arg(_tasks.size()).arg(serialMs));
+    } else {
+        LOG_ERROR(QString("Startup failed at task %1 after %2 ms").arg(_failedTask).arg(_readyMs));
+    }
+
+    return _ready;
+}
+
+bool StartupOrchestrator::isReady() const
+{
+    QMutexLocker locker(&_mutex);
+    return _ready;
+}
+
+QString StartupOrchestrator::failedTask() const
+{
+    QMutexLocker locker(&_mutex);
+    return _failedTask;
+}
+
+StartupOrchestrator::TaskStatus StartupOrchestrator::taskStatus(const QString &name) const
+{
+    QMutexLocker locker(&_mutex);
+    QSharedPointer<Task> task = _taskByName.value(name);
+    return task ? task->status : Skipped;
+}
+
+void StartupOrchestrator::waitForBackgroundTasks()
+{
+    _workers.waitForDone();
+}
+
+QString StartupOrchestrator::statusName(TaskStatus status)
+{
+    switch (status) {
+    case Pending: return "pending";
+    case Running: return "running";
+    case Succeeded: return "succeeded";
+    case Failed: return "failed";
+    case Skipped: return "skipped";
+    }
+    return "unknown";
+}
+
+QJsonObject StartupOrchestrator::getStatistics() const
+{
+    QMutexLocker locker(&_mutex);
+
+    QJsonObject stats;
+    stats["parallel"] = _config.parallel;
+    stats["ready"] = _ready;
+    stats["ready_ms"] = _readyMs;
+    stats["readiness_timeout_ms"] = _config.readinessTimeoutMs;
+    if (!_failedTask.isEmpty()) {
+        stats["failed_task"] = _failedTask;
+    }
+
+    qint64 serialMs = 0;
+    QJsonArray tasks;
+    for (const QSharedPointer<Task> &task : _tasks) {
+        QJsonObject taskStats;
+        taskStats["name"] = task->name;
+        taskStats["status"] = statusName(task->status);
+        taskStats["required"] = task->required;
+        taskStats["parallel"] = _config.parallel && task->affinity == AnyThread;
+        taskStats["start_ms"] = task->startMs;
+        taskStats["duration_ms"] = task->durationMs;
+        taskStats["background"] = task->background;
+        taskStats["dependencies"] = QJsonArray::fromStringList(task->dependencies);
+        tasks.append(taskStats);
+        serialMs += task->durationMs;
+    }
+
+    stats["tasks"] = tasks;
+    stats["serial_ms"] = serialMs;
+    return stats;
+}
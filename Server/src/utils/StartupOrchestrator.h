@@ -0,0 +1,150 @@
+#ifndef STARTUPORCHESTRATOR_H
+#define STARTUPORCHESTRATOR_H
+
+#include <QString>
+#include <QStringList>
+#include <QList>
+#include <QHash>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QThreadPool>
+#include <QElapsedTimer>
+#include <QSharedPointer>
+#include <QJsonObject>
+#include <functional>
+
+/**
+ * @brief 服务器启动编排器
+ *
+ * 以有向无环图描述各子系统的初始化任务及其依赖，依赖满足后即可执行：
+ * - AnyThread任务在编排器自带的线程池中并行执行（数据库连接、证书生成等阻塞操作）
+ * - MainThread任务在调用run()的线程中按声明顺序执行（创建QObject、启动定时器等）
+ *
+ * run()在所有必需任务完成后返回；可选任务最多再等待到就绪超时，
+ * 超时后未开始的可选任务被跳过，已在工作线程中运行的任务转入后台继续执行。
+ * 任一必需任务失败时停止调度新任务，run()返回false。
+ */
+class StartupOrchestrator
+{
+public:
+    /**
+     * @brief 任务执行线程
+     */
+    enum Affinity {
+        MainThread,
+        AnyThread
+    };
+
+    /**
+     * @brief 任务状态
+     */
+    enum TaskStatus {
+        Pending,
+        Running,
+        Succeeded,
+        Failed,
+        Skipped
+    };
+
+    /**
+     * @brief 编排配置
+     */
+    struct OrchestratorConfig {
+        bool parallel = true;              // 是否并行执行AnyThread任务，否则全部在调用线程中顺序执行
+        int readinessTimeoutMs = 10000;    // 必需任务完成后等待可选任务的最长时间（自run()开始计），<=0表示一直等待
+        int maxWorkerThreads = 4;          // 并行任务的最大线程数
+    };
+
+    using TaskFunction = std::function<bool()>;
+
+    StartupOrchestrator();
+    ~StartupOrchestrator();
+
+    /**
+     * @brief 设置编排配置，需在run()之前调用
+     */
+    void setConfig(const OrchestratorConfig &config);
+
+    /**
+     * @brief 添加启动任务
+     * @param name 任务名称（唯一）
+     * @param function 任务函数，返回是否成功
+     * @param dependencies 依赖的任务名称，依赖全部结束后才会执行
+     * @param required 是否为必需任务，必需任务失败将导致启动失败
+     * @param affinity 执行线程
+     * @return 添加是否成功
+     */
+    bool addTask(const QString &name, const TaskFunction &function,
+                 const QStringList &dependencies = QStringList(),
+                 bool required = true, Affinity affinity = MainThread);
+
+    /**
+     * @brief 执行所有任务直到通过就绪门控
+     * @return 所有必需任务是否成功
+     */
+    bool run();
+
+    /**
+     * @brief 是否已通过就绪门控
+     */
+    bool isReady() const;
+
+    /**
+     * @brief 获取导致启动失败的任务名称
+     */
+    QString failedTask() const;
+
+    /**
+     * @brief 获取任务状态
+     */
+    TaskStatus taskStatus(const QString &name) const;
+
+    /**
+     * @brief 等待转入后台的任务结束
+     */
+    void waitForBackgroundTasks();
+
+    /**
+     * @brief 获取启动统计信息（各任务耗时、总耗时）
+     */
+    QJsonObject getStatistics() const;
+
+private:
+    /**
+     * @brief 启动任务
+     */
+    struct Task {
+        QString name;
+        TaskFunction function;
+        QStringList dependencies;
+        bool required = true;
+        Affinity affinity = MainThread;
+        TaskStatus status = Pending;
+        qint64 startMs = -1;        // 相对run()开始的启动时刻
+        qint64 durationMs = 0;
+        bool background = false;    // 就绪门控通过时仍在运行
+    };
+
+    bool validateGraph();
+    bool dependenciesFinished(const Task &task) const;
+    bool executeTask(Task &task);
+    void startWorkerTask(const QSharedPointer<Task> &task);
+    void finishTask(Task &task, bool success, qint64 durationMs);
+    static QString statusName(TaskStatus status);
+
+    OrchestratorConfig _config;
+
+    mutable QMutex _mutex;
+    QWaitCondition _taskFinished;
+    QList<QSharedPointer<Task>> _tasks;
+    QHash<QString, QSharedPointer<Task>> _taskByName;
+
+    QThreadPool _workers;
+    QElapsedTimer _clock;
+
+    bool _ready;
+    QString _failedTask;
+    qint64 _readyMs;
+};
+
+#endif // STARTUPORCHESTRATOR_H
@@ -0,0 +1,157 @@
+#include "network/InboundScanner.h"
+#include <QtTest>
+
+/**
+ * @brief 入站帧快速扫描器测试
+ */
+class InboundScannerTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void extractsRoutingFields();
+    void skipsNestedValues();
+    void decodesEscapedStrings();
+    void acceptsEmptyObject();
+    void rejectsMalformed_data();
+    void rejectsMalformed();
+    void validatesUtf8_data();
+    void validatesUtf8();
+    void integerValue();
+    void missingFieldsAreEmpty();
+};
+
+void InboundScannerTest::extractsRoutingFields()
+{
+    const QByteArray frame = R"({"action":"send_message","request_id":"r-1","user_id":42,)"
+                             R"("client_id":"c-7","deadline_ms":"1500","content":"hi"})";
+
+    InboundScanner::Result result;
+    QVERIFY(InboundScanner::scan(frame.constData(), frame.size(), &result));
+
+    const char *data = frame.constData();
+    QCOMPARE(InboundScanner::stringValue(data, result.value(InboundScanner::Action)), QString("send_message"));
+    QCOMPARE(InboundScanner::stringValue(data, result.value(InboundScanner::RequestId)), QString("r-1"));
+    QCOMPARE(InboundScanner::stringValue(data, result.value(InboundScanner::ClientId)), QString("c-7"));
+    QCOMPARE(result.value(InboundScanner::UserId).type, InboundScanner::Value::Number);
+    QCOMPARE(InboundScanner::integerValue(data, result.value(InboundScanner::UserId)), qint64(42));
+    QCOMPARE(InboundScanner::integerValue(data, result.value(InboundScanner::DeadlineMs)), qint64(1500));
+}
+
+void InboundScannerTest::skipsNestedValues()
+{
+    // 嵌套对象中的同名键不影响顶层字段
+    const QByteArray frame = R"({"data":{"action":"inner","list":[1,{"a":"]}"},[]]},)"
+                             R"( "action" : "friend_list" , "flags":[true,false,null]})";
+
+    InboundScanner::Result result;
+    QVERIFY(InboundScanner::scan(frame.constData(), frame.size(), &result));
+    QCOMPARE(InboundScanner::stringValue(frame.constData(), result.value(InboundScanner::Action)),
+             QString("friend_list"));
+}
+
+void InboundScannerTest::decodesEscapedStrings()
+{
+    const QByteArray frame = R"({"action":"a\"b\\c中","request_id":"plain"})";
+
+    InboundScanner::Result result;
+    QVERIFY(InboundScanner::scan(frame.constData(), frame.size(), &result));
+
+    const InboundScanner::Value &action = result.value(InboundScanner::Action);
+    QVERIFY(action.escaped);
+    QCOMPARE(InboundScanner::stringValue(frame.constData(), action), QString::fromUtf8("a\"b\\c\xe4\xb8\xad"));
+    QVERIFY(!result.value(InboundScanner::RequestId).escaped);
+}
+
+void InboundScannerTest::acceptsEmptyObject()
+{
+    const QByteArray frame = "  { }  ";
+
+    InboundScanner::Result result;
+    QVERIFY(InboundScanner::scan(frame.constData(), frame.size(), &result));
+    QCOMPARE(result.value(InboundScanner::Action).type, InboundScanner::Value::Missing);
+}
+
+void InboundScannerTest::rejectsMalformed_data()
+{
+    QTest::addColumn<QByteArray>("frame");
+
+    QTest::newRow("empty") << QByteArray();
+    QTest::newRow("array") << QByteArray(R"(["action"])");
+    QTest::newRow("unterminated object") << QByteArray(R"({"action":"login")");
+    QTest::newRow("unterminated string") << QByteArray(R"({"action":"login})");
+    QTest::newRow("missing colon") << QByteArray(R"({"action" "login"})");
+    QTest::newRow("trailing comma") << QByteArray(R"({"action":"login",})");
+    QTest::newRow("trailing data") << QByteArray(R"({"action":"login"} x)");
+    QTest::newRow("mismatched brackets") << QByteArray(R"({"data":[1,2}})");
+    QTest::newRow("bad escape") << QByteArray(R"({"action":"a\qb"})");
+    QTest::newRow("short unicode escape") << QByteArray(R"({"action":"\u12"})");
+    QTest::newRow("control character") << QByteArray("{\"action\":\"a\nb\"}");
+    QTest::newRow("bad literal") << QByteArray(R"({"flag":yes})");
+    QTest::newRow("bad number") << QByteArray(R"({"user_id":12a})");
+}
+
+void InboundScannerTest::rejectsMalformed()
+{
+    QFETCH(QByteArray, frame);
+
+    InboundScanner::Result result;
+    QVERIFY(!InboundScanner::scan(frame.constData(), frame.size(), &result));
+}
+
+void InboundScannerTest::validatesUtf8_data()
+{
+    QTest::addColumn<QByteArray>("data");
+    QTest::addColumn<bool>("valid");
+
+    // 超过16字节，覆盖向量化跳过ASCII块之后的逐字节校验
+    const QByteArray ascii(40, 'a');
+
+    QTest::newRow("ascii") << ascii << true;
+    QTest::newRow("two byte") << QByteArray("\xc3\xa9") << true;
+    QTest::newRow("three byte after block") << ascii + QByteArray("\xe4\xb8\xad") << true;
+    QTest::newRow("four byte") << QByteArray("\xf0\x9f\x98\x80") << true;
+    QTest::newRow("truncated") << ascii + QByteArray("\xe4\xb8") << false;
+    QTest::newRow("bad continuation") << QByteArray("\xc3\x28") << false;
+    QTest::newRow("overlong") << QByteArray("\xc0\xaf") << false;
+    QTest::newRow("surrogate") << QByteArray("\xed\xa0\x80") << false;
+    QTest::newRow("lone continuation") << QByteArray("\x80") << false;
+}
+
+void InboundScannerTest::validatesUtf8()
+{
+    QFETCH(QByteArray, data);
+    QFETCH(bool, valid);
+
+    QCOMPARE(InboundScanner::isValidUtf8(data.constData(), data.size()), valid);
+}
+
+void InboundScannerTest::integerValue()
+{
+    const QByteArray frame = R"({"user_id":"123","deadline_ms":2.6e3,"request_id":true})";
+
+    InboundScanner::Result result;
+    QVERIFY(InboundScanner::scan(frame.constData(), frame.size(), &result));
+
+    const char *data = frame.constData();
+    QCOMPARE(InboundScanner::integerValue(data, result.value(InboundScanner::UserId)), qint64(123));
+    QCOMPARE(InboundScanner::integerValue(data, result.value(InboundScanner::DeadlineMs)), qint64(2600));
+    QCOMPARE(result.value(InboundScanner::RequestId).type, InboundScanner::Value::Literal);
+    QCOMPARE(InboundScanner::integerValue(data, result.value(InboundScanner::RequestId)), qint64(0));
+    QVERIFY(InboundScanner::stringValue(data, result.value(InboundScanner::RequestId)).isEmpty());
+}
+
+void InboundScannerTest::missingFieldsAreEmpty()
+{
+    const QByteArray frame = R"({"type":"heartbeat"})";
+
+    InboundScanner::Result result;
+    QVERIFY(InboundScanner::scan(frame.constData(), frame.size(), &result));
+    for (int field = 0; field < InboundScanner::FieldCount; ++field) {
+        QCOMPARE(result.values[field].type, InboundScanner::Value::Missing);
+    }
+    QVERIFY(InboundScanner::stringValue(frame.constData(), result.value(InboundScanner::Action)).isEmpty());
+}
+
+QTEST_GUILESS_MAIN(InboundScannerTest)
+#include "InboundScannerTest.moc"
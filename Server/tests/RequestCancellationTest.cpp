@@ -0,0 +1,190 @@
+#include "utils/RequestCancellation.h"
+#include <QtTest>
+
+/**
+ * @brief 请求截止时间与取消测试
+ */
+class RequestCancellationTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void init();
+    void disabledReturnsNoToken();
+    void noDeadline();
+    void deadlineExpires();
+    void defaultDeadline();
+    void deadlineClampedToMaximum();
+    void cancelRequest();
+    void cancelClient();
+    void finishKeepsResentToken();
+    void requestWithoutIdCannotBeCancelled();
+    void scopeSetsCurrentToken();
+    void readOnlyFlag();
+};
+
+void RequestCancellationTest::init()
+{
+    RequestCancellation::Config config;
+    config.defaultDeadlineMs = 0;
+    config.maxDeadlineMs = 60000;
+    // 没有数据库，不中止查询
+    config.killRunningQueries = false;
+    RequestCancellation::instance()->configure(config);
+}
+
+void RequestCancellationTest::disabledReturnsNoToken()
+{
+    RequestCancellation::Config config;
+    config.enabled = false;
+    RequestCancellation::instance()->configure(config);
+
+    QVERIFY(RequestCancellation::instance()->begin("c", "r", 1000).isNull());
+}
+
+void RequestCancellationTest::noDeadline()
+{
+    RequestTokenPtr token = RequestCancellation::instance()->begin("c", "no-deadline", 0);
+    QVERIFY(token);
+    QCOMPARE(token->remainingMs(), qint64(-1));
+    QVERIFY(!token->isExpired());
+    QVERIFY(!token->shouldAbort());
+    RequestCancellation::instance()->finish(token);
+}
+
+void RequestCancellationTest::deadlineExpires()
+{
+    RequestTokenPtr token = RequestCancellation::instance()->begin("c", "expires", 30);
+    QVERIFY(token);
+    QVERIFY(token->remainingMs() > 0);
+    QVERIFY(token->remainingMs() <= 30);
+    QVERIFY(!token->isExpired());
+
+    QThread::msleep(50);
+    QVERIFY(token->isExpired());
+    QVERIFY(token->shouldAbort());
+    QVERIFY(!token->isCancelled());
+    QCOMPARE(token->remainingMs(), qint64(0));
+    RequestCancellation::instance()->finish(token);
+}
+
+void RequestCancellationTest::defaultDeadline()
+{
+    RequestCancellation::Config config;
+    config.defaultDeadlineMs = 500;
+    config.killRunningQueries = false;
+    RequestCancellation::instance()->configure(config);
+
+    RequestTokenPtr token = RequestCancellation::instance()->begin("c", "default", 0);
+    QVERIFY(token->remainingMs() > 0);
+    QVERIFY(token->remainingMs() <= 500);
+    RequestCancellation::instance()->finish(token);
+}
+
+void RequestCancellationTest::deadlineClampedToMaximum()
+{
+    RequestCancellation::Config config;
+    config.maxDeadlineMs = 200;
+    config.killRunningQueries = false;
+    RequestCancellation::instance()->configure(config);
+
+    RequestTokenPtr token = RequestCancellation::instance()->begin("c", "clamped", 3600000);
+    QVERIFY(token->remainingMs() <= 200);
+    RequestCancellation::instance()->finish(token);
+}
+
+void RequestCancellationTest::cancelRequest()
+{
+    RequestTokenPtr token = RequestCancellation::instance()->begin("c1", "r1", 0);
+    RequestTokenPtr other = RequestCancellation::instance()->begin("c1", "r2", 0);
+
+    QVERIFY(RequestCancellation::instance()->cancel("c1", "r1"));
+    QVERIFY(token->isCancelled());
+    QVERIFY(token->shouldAbort());
+    QVERIFY(!other->isCancelled());
+
+    // 已完成的请求和其他连接的同名请求都取消不到
+    RequestCancellation::instance()->finish(token);
+    QVERIFY(!RequestCancellation::instance()->cancel("c1", "r1"));
+    QVERIFY(!RequestCancellation::instance()->cancel("c2", "r2"));
+    QVERIFY(!other->isCancelled());
+    RequestCancellation::instance()->finish(other);
+}
+
+void RequestCancellationTest::cancelClient()
+{
+    RequestTokenPtr first = RequestCancellation::instance()->begin("gone", "r1", 0);
+    RequestTokenPtr second = RequestCancellation::instance()->begin("gone", "r2", 0);
+    RequestTokenPtr survivor = RequestCancellation::instance()->begin("alive", "r1", 0);
+
+    RequestCancellation::instance()->cancelClient("gone");
+    QVERIFY(first->isCancelled());
+    QVERIFY(second->isCancelled());
+    QVERIFY(!survivor->isCancelled());
+
+    // 断开连接后登记表已清空
+    QVERIFY(!RequestCancellation::instance()->cancel("gone", "r1"));
+    RequestCancellation::instance()->finish(survivor);
+}
+
+void RequestCancellationTest::finishKeepsResentToken()
+{
+    RequestTokenPtr original = RequestCancellation::instance()->begin("c", "resent", 0);
+    RequestTokenPtr resent = RequestCancellation::instance()->begin("c", "resent", 0);
+
+    // 先登记的请求完成时不移除重发后登记的令牌
+    RequestCancellation::instance()->finish(original);
+    QVERIFY(RequestCancellation::instance()->cancel("c", "resent"));
+    QVERIFY(resent->isCancelled());
+    QVERIFY(!original->isCancelled());
+    RequestCancellation::instance()->finish(resent);
+}
+
+void RequestCancellationTest::requestWithoutIdCannotBeCancelled()
+{
+    RequestTokenPtr token = RequestCancellation::instance()->begin("c", QString(), 100);
+    QVERIFY(token);
+    QVERIFY(!RequestCancellation::instance()->cancel("c", QString()));
+    QVERIFY(!token->isCancelled());
+}
+
+void RequestCancellationTest::scopeSetsCurrentToken()
+{
+    QVERIFY(RequestCancellation::current().isNull());
+
+    RequestTokenPtr outer = RequestCancellation::instance()->begin("c", "outer", 0);
+    RequestTokenPtr inner = RequestCancellation::instance()->begin("c", "inner", 0);
+    {
+        RequestCancellation::Scope outerScope(outer);
+        QCOMPARE(RequestCancellation::current(), outer);
+        {
+            RequestCancellation::Scope innerScope(inner);
+            QCOMPARE(RequestCancellation::current(), inner);
+        }
+        QCOMPARE(RequestCancellation::current(), outer);
+
+        // 令牌只对创建作用域的线程可见
+        RequestTokenPtr seen = outer;
+        QThread *thread = QThread::create([&seen]() { seen = RequestCancellation::current(); });
+        thread->start();
+        QVERIFY(thread->wait(5000));
+        delete thread;
+        QVERIFY(seen.isNull());
+    }
+    QVERIFY(RequestCancellation::current().isNull());
+
+    RequestCancellation::instance()->finish(outer);
+    RequestCancellation::instance()->finish(inner);
+}
+
+void RequestCancellationTest::readOnlyFlag()
+{
+    RequestTokenPtr token = RequestCancellation::instance()->begin("c", "read", 0);
+    QVERIFY(!token->isReadOnly());
+    token->setReadOnly(true);
+    QVERIFY(token->isReadOnly());
+    RequestCancellation::instance()->finish(token);
+}
+
+QTEST_GUILESS_MAIN(RequestCancellationTest)
+#include "RequestCancellationTest.moc"
@@ -0,0 +1,228 @@
+#include "network/RequestExecutor.h"
+#include <QtTest>
+#include <QSemaphore>
+#include <QAtomicInt>
+
+/**
+ * @brief 请求执行器测试：阶段划分、串行链顺序和阶段上限
+ */
+class RequestExecutorTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void stageForAction_data();
+    void stageForAction();
+    void stageNames();
+    void affinityKeysDoNotCollide();
+    void strandKeepsSubmissionOrder();
+    void stageConcurrencyLimit();
+    void stageQueueLimit();
+    void replyDroppedWhenContextDestroyed();
+
+private:
+    /**
+     * @brief 记录同时执行的最大请求数
+     */
+    struct ConcurrencyProbe {
+        QAtomicInt active;
+        QAtomicInt maximum;
+
+        void enter()
+        {
+            int now = active.fetchAndAddOrdered(1) + 1;
+            int seen = maximum.loadAcquire();
+            while (now > seen && !maximum.testAndSetOrdered(seen, now)) {
+                seen = maximum.loadAcquire();
+            }
+        }
+        void leave() { active.fetchAndSubOrdered(1); }
+    };
+};
+
+void RequestExecutorTest::initTestCase()
+{
+    RequestExecutor::Config config;
+    config.workerThreads = 4;
+    QVERIFY(RequestExecutor::instance()->initialize(config));
+    QVERIFY(RequestExecutor::instance()->isEnabled());
+}
+
+void RequestExecutorTest::cleanupTestCase()
+{
+    RequestExecutor::instance()->shutdown();
+}
+
+void RequestExecutorTest::stageForAction_data()
+{
+    QTest::addColumn<QString>("action");
+    QTest::addColumn<int>("stage");
+
+    QTest::newRow("login") << "login" << int(RequestExecutor::AuthStage);
+    QTest::newRow("register") << "register" << int(RequestExecutor::AuthStage);
+    QTest::newRow("send_message") << "send_message" << int(RequestExecutor::InteractiveWriteStage);
+    QTest::newRow("friend_request") << "friend_request" << int(RequestExecutor::InteractiveWriteStage);
+    // 读取时标记delivered_at，结果不能在截止后丢弃
+    QTest::newRow("message_offline") << "message_offline" << int(RequestExecutor::InteractiveWriteStage);
+    QTest::newRow("friend_list") << "friend_list" << int(RequestExecutor::ReadHeavyStage);
+    QTest::newRow("get_chat_history") << "get_chat_history" << int(RequestExecutor::ReadHeavyStage);
+    QTest::newRow("message_search") << "message_search" << int(RequestExecutor::ReadHeavyStage);
+    QTest::newRow("bootstrap") << "bootstrap" << int(RequestExecutor::ReadHeavyStage);
+    QTest::newRow("heartbeat") << "heartbeat" << int(RequestExecutor::BackgroundStage);
+    QTest::newRow("unknown") << "no_such_action" << int(RequestExecutor::BackgroundStage);
+}
+
+void RequestExecutorTest::stageForAction()
+{
+    QFETCH(QString, action);
+    QFETCH(int, stage);
+
+    QCOMPARE(int(RequestExecutor::stageForAction(action)), stage);
+}
+
+void RequestExecutorTest::stageNames()
+{
+    QCOMPARE(RequestExecutor::stageName(RequestExecutor::AuthStage), QString("auth"));
+    QCOMPARE(RequestExecutor::stageName(RequestExecutor::InteractiveWriteStage), QString("interactive_write"));
+    QCOMPARE(RequestExecutor::stageName(RequestExecutor::ReadHeavyStage), QString("read_heavy"));
+    QCOMPARE(RequestExecutor::stageName(RequestExecutor::BackgroundStage), QString("background"));
+}
+
+void RequestExecutorTest::affinityKeysDoNotCollide()
+{
+    QVERIFY(RequestExecutor::userKey(1) != 0);
+    QVERIFY(RequestExecutor::userKey(1) != RequestExecutor::userKey(2));
+    QCOMPARE(RequestExecutor::userKey(1) >> 63, quint64(0));
+    QCOMPARE(RequestExecutor::connectionKey("client-1") >> 63, quint64(1));
+}
+
+void RequestExecutorTest::strandKeepsSubmissionOrder()
+{
+    const int count = 200;
+    const int users = 4;
+
+    QMutex mutex;
+    QHash<int, QList<int>> executed;
+    ConcurrencyProbe probes[users];
+    int replies = 0;
+
+    for (int i = 0; i < count; ++i) {
+        const int user = i % users;
+        ConcurrencyProbe *probe = &probes[user];
+        bool accepted = RequestExecutor::instance()->submit(
+            RequestExecutor::InteractiveWriteStage, RequestExecutor::userKey(user + 1), this,
+            [&mutex, &executed, probe, user, i]() {
+                probe->enter();
+                {
+                    QMutexLocker locker(&mutex);
+                    executed[user].append(i);
+                }
+                QThread::usleep(100);
+                probe->leave();
+                return QJsonObject{{"index", i}};
+            },
+            [&replies](const QJsonObject &) { ++replies; });
+        QVERIFY(accepted);
+    }
+
+    QTRY_COMPARE_WITH_TIMEOUT(replies, count, 10000);
+
+    // 同一用户的请求不并发，且按提交顺序执行
+    for (int user = 0; user < users; ++user) {
+        QCOMPARE(probes[user].maximum.loadAcquire(), 1);
+        const QList<int> &order = executed.value(user);
+        QCOMPARE(order.size(), count / users);
+        for (int k = 1; k < order.size(); ++k) {
+            QVERIFY(order[k - 1] < order[k]);
+        }
+    }
+}
+
+void RequestExecutorTest::stageConcurrencyLimit()
+{
+    RequestExecutor::StageConfig limited;
+    limited.maxConcurrent = 1;
+    RequestExecutor::instance()->setStageConfig(RequestExecutor::BackgroundStage, limited);
+
+    const int count = 16;
+    ConcurrencyProbe probe;
+    int replies = 0;
+    for (int i = 0; i < count; ++i) {
+        // 不同亲和键，由不同工作线程执行，只受阶段上限约束
+        bool accepted = RequestExecutor::instance()->submit(
+            RequestExecutor::BackgroundStage, 0, this,
+            [&probe]() {
+                probe.enter();
+                QThread::msleep(2);
+                probe.leave();
+                return QJsonObject();
+            },
+            [&replies](const QJsonObject &) { ++replies; });
+        QVERIFY(accepted);
+    }
+
+    QTRY_COMPARE_WITH_TIMEOUT(replies, count, 10000);
+    QCOMPARE(probe.maximum.loadAcquire(), 1);
+
+    RequestExecutor::instance()->setStageConfig(RequestExecutor::BackgroundStage, RequestExecutor::StageConfig());
+}
+
+void RequestExecutorTest::stageQueueLimit()
+{
+    RequestExecutor::StageConfig limited;
+    limited.maxConcurrent = 1;
+    limited.maxQueued = 2;
+    RequestExecutor::instance()->setStageConfig(RequestExecutor::ReadHeavyStage, limited);
+
+    QSemaphore started;
+    QSemaphore release;
+    int replies = 0;
+    auto reply = [&replies](const QJsonObject &) { ++replies; };
+
+    // 第一个请求开始执行后不再计入排队数
+    QVERIFY(RequestExecutor::instance()->submit(RequestExecutor::ReadHeavyStage, 0, this,
+        [&started, &release]() {
+            started.release();
+            release.acquire();
+            return QJsonObject();
+        }, reply));
+    QVERIFY(started.tryAcquire(1, 5000));
+
+    auto work = []() { return QJsonObject(); };
+    QVERIFY(RequestExecutor::instance()->submit(RequestExecutor::ReadHeavyStage, 0, this, work, reply));
+    QVERIFY(RequestExecutor::instance()->submit(RequestExecutor::ReadHeavyStage, 0, this, work, reply));
+    QVERIFY(!RequestExecutor::instance()->submit(RequestExecutor::ReadHeavyStage, 0, this, work, reply));
+
+    // 其他阶段不受影响
+    QVERIFY(RequestExecutor::instance()->submit(RequestExecutor::AuthStage, 0, this, work, reply));
+
+    release.release();
+    QTRY_COMPARE_WITH_TIMEOUT(replies, 4, 10000);
+
+    RequestExecutor::instance()->setStageConfig(RequestExecutor::ReadHeavyStage, RequestExecutor::StageConfig());
+}
+
+void RequestExecutorTest::replyDroppedWhenContextDestroyed()
+{
+    QObject *context = new QObject();
+    QSemaphore done;
+    bool replied = false;
+
+    QVERIFY(RequestExecutor::instance()->submit(RequestExecutor::BackgroundStage, 0, context,
+        [&done]() {
+            done.release();
+            return QJsonObject();
+        },
+        [&replied](const QJsonObject &) { replied = true; }));
+    QVERIFY(done.tryAcquire(1, 5000));
+
+    // 回调在本线程的事件循环中执行，此前销毁上下文
+    delete context;
+    QTest::qWait(100);
+    QVERIFY(!replied);
+}
+
+QTEST_GUILESS_MAIN(RequestExecutorTest)
+#include "RequestExecutorTest.moc"
@@ -0,0 +1,114 @@
+#include "database/RetentionScheduler.h"
+#include <QtTest>
+
+/**
+ * @brief 数据保留任务分块自适应测试
+ */
+class RetentionSchedulerTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void slowChunkHalvesSize();
+    void lockWaitsBackOff();
+    void fastChunkGrowsSize();
+    void onTargetChunkKeepsSize();
+    void sizeStaysWithinBounds();
+    void pauseGrowsUpToLimit();
+    void pauseResetsAfterRecovery();
+
+private:
+    static RetentionScheduler::Config config();
+};
+
+RetentionScheduler::Config RetentionSchedulerTest::config()
+{
+    RetentionScheduler::Config config;
+    config.initialChunkSize = 500;
+    config.minChunkSize = 50;
+    config.maxChunkSize = 5000;
+    config.pauseMs = 100;
+    config.targetChunkMs = 100;
+    return config;
+}
+
+void RetentionSchedulerTest::slowChunkHalvesSize()
+{
+    int chunkSize = 500;
+    int pauseMs = 100;
+    QVERIFY(RetentionScheduler::adaptChunk(config(), 150, 0, &chunkSize, &pauseMs));
+    QCOMPARE(chunkSize, 250);
+    QCOMPARE(pauseMs, 200);
+}
+
+void RetentionSchedulerTest::lockWaitsBackOff()
+{
+    // 块本身很快，但有事务在等行锁
+    int chunkSize = 500;
+    int pauseMs = 100;
+    QVERIFY(RetentionScheduler::adaptChunk(config(), 5, 1, &chunkSize, &pauseMs));
+    QCOMPARE(chunkSize, 250);
+    QCOMPARE(pauseMs, 200);
+}
+
+void RetentionSchedulerTest::fastChunkGrowsSize()
+{
+    int chunkSize = 500;
+    int pauseMs = 100;
+    QVERIFY(!RetentionScheduler::adaptChunk(config(), 20, 0, &chunkSize, &pauseMs));
+    QCOMPARE(chunkSize, 751);
+    QCOMPARE(pauseMs, 100);
+}
+
+void RetentionSchedulerTest::onTargetChunkKeepsSize()
+{
+    // 介于目标的一半和目标之间时保持不变
+    int chunkSize = 500;
+    int pauseMs = 100;
+    QVERIFY(!RetentionScheduler::adaptChunk(config(), 80, 0, &chunkSize, &pauseMs));
+    QCOMPARE(chunkSize, 500);
+    QCOMPARE(pauseMs, 100);
+}
+
+void RetentionSchedulerTest::sizeStaysWithinBounds()
+{
+    int chunkSize = 60;
+    int pauseMs = 100;
+    RetentionScheduler::adaptChunk(config(), 1000, 0, &chunkSize, &pauseMs);
+    QCOMPARE(chunkSize, 50);
+    RetentionScheduler::adaptChunk(config(), 1000, 0, &chunkSize, &pauseMs);
+    QCOMPARE(chunkSize, 50);
+
+    chunkSize = 4000;
+    RetentionScheduler::adaptChunk(config(), 1, 0, &chunkSize, &pauseMs);
+    QCOMPARE(chunkSize, 5000);
+    RetentionScheduler::adaptChunk(config(), 1, 0, &chunkSize, &pauseMs);
+    QCOMPARE(chunkSize, 5000);
+}
+
+void RetentionSchedulerTest::pauseGrowsUpToLimit()
+{
+    int chunkSize = 500;
+    int pauseMs = 100;
+    for (int i = 0; i < 10; ++i) {
+        RetentionScheduler::adaptChunk(config(), 500, 0, &chunkSize, &pauseMs);
+    }
+    // 连续退避时暂停时间最多为配置值的8倍
+    QCOMPARE(pauseMs, 800);
+    QCOMPARE(chunkSize, 50);
+}
+
+void RetentionSchedulerTest::pauseResetsAfterRecovery()
+{
+    int chunkSize = 500;
+    int pauseMs = 100;
+    RetentionScheduler::adaptChunk(config(), 500, 2, &chunkSize, &pauseMs);
+    RetentionScheduler::adaptChunk(config(), 500, 2, &chunkSize, &pauseMs);
+    QCOMPARE(pauseMs, 400);
+
+    QVERIFY(!RetentionScheduler::adaptChunk(config(), 80, 0, &chunkSize, &pauseMs));
+    QCOMPARE(pauseMs, 100);
+}
+
+QTEST_GUILESS_MAIN(RetentionSchedulerTest)
+#include "RetentionSchedulerTest.moc"
@@ -0,0 +1,155 @@
+#include "database/SchemaMigrator.h"
+#include <QtTest>
+#include <QTemporaryDir>
+#include <QCryptographicHash>
+
+/**
+ * @brief 数据库结构迁移脚本解析测试
+ *
+ * 不连接数据库，检查脚本拆分、迁移排序和Server/migrations中的脚本本身。
+ */
+class SchemaMigratorTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void splitStatements();
+    void splitStatementsWithoutTrailingSemicolon();
+    void loadMigrationsSortsByVersion();
+    void bundledMigrations();
+    void loadHotQueries();
+    void bundledHotQueries();
+
+private:
+    static QString migrationsDir() { return QString(SERVER_SOURCE_DIR) + "/migrations"; }
+    static bool writeFile(const QString &path, const QByteArray &content);
+};
+
+bool SchemaMigratorTest::writeFile(const QString &path, const QByteArray &content)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+    return file.write(content) == content.size();
+}
+
+void SchemaMigratorTest::splitStatements()
+{
+    const QString script =
+        "-- 注释行\n"
+        "CREATE TABLE IF NOT EXISTS t (\n"
+        "    id INT PRIMARY KEY\n"
+        ");\n"
+        "\n"
+        "   -- 缩进的注释\n"
+        "ALTER TABLE t ADD INDEX idx_id (id),\n"
+        "    ALGORITHM=INPLACE, LOCK=NONE;\n"
+        "INSERT INTO t VALUES (1);\n";
+
+    const QStringList statements = SchemaMigrator::splitStatements(script);
+    QCOMPARE(statements.size(), 3);
+    QCOMPARE(statements[0], QString("CREATE TABLE IF NOT EXISTS t (\n    id INT PRIMARY KEY\n)"));
+    QCOMPARE(statements[1], QString("ALTER TABLE t ADD INDEX idx_id (id),\n    ALGORITHM=INPLACE, LOCK=NONE"));
+    QCOMPARE(statements[2], QString("INSERT INTO t VALUES (1)"));
+}
+
+void SchemaMigratorTest::splitStatementsWithoutTrailingSemicolon()
+{
+    const QStringList statements = SchemaMigrator::splitStatements("SELECT 1;\nSELECT 2\n");
+    QCOMPARE(statements, QStringList({ "SELECT 1", "SELECT 2" }));
+
+    QVERIFY(SchemaMigrator::splitStatements("-- only comments\n\n").isEmpty());
+}
+
+void SchemaMigratorTest::loadMigrationsSortsByVersion()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+
+    const QByteArray second = "CREATE TABLE b (id INT);\n";
+    QVERIFY(writeFile(dir.filePath("V10__second.sql"), second));
+    QVERIFY(writeFile(dir.filePath("V2__first.sql"), "CREATE TABLE a (id INT);\nCREATE INDEX i ON a (id);\n"));
+    QVERIFY(writeFile(dir.filePath("V3-bad-name.sql"), "SELECT 1;\n"));
+    QVERIFY(writeFile(dir.filePath("notes.txt"), "SELECT 1;\n"));
+
+    const QList<SchemaMigrator::Migration> migrations = SchemaMigrator::loadMigrations(dir.path());
+    QCOMPARE(migrations.size(), 2);
+
+    // 按数值而不是文件名排序
+    QCOMPARE(migrations[0].version, 2);
+    QCOMPARE(migrations[0].name, QString("first"));
+    QCOMPARE(migrations[0].statements.size(), 2);
+    QCOMPARE(migrations[1].version, 10);
+    QCOMPARE(migrations[1].name, QString("second"));
+    QCOMPARE(migrations[1].checksum,
+             QString::fromLatin1(QCryptographicHash::hash(second, QCryptographicHash::Sha256).toHex()));
+}
+
+void SchemaMigratorTest::bundledMigrations()
+{
+    const QList<SchemaMigrator::Migration> migrations = SchemaMigrator::loadMigrations(migrationsDir());
+    QVERIFY(!migrations.isEmpty());
+
+    // 版本号从1开始连续，每个迁移至少有一条语句
+    for (int i = 0; i < migrations.size(); ++i) {
+        const SchemaMigrator::Migration &migration = migrations[i];
+        QCOMPARE(migration.version, i + 1);
+        QVERIFY2(!migration.statements.isEmpty(), qPrintable(migration.name));
+        QCOMPARE(migration.checksum.size(), 64);
+        for (const QString &statement : migration.statements) {
+            QVERIFY2(!statement.endsWith(';'), qPrintable(statement));
+        }
+    }
+}
+
+void SchemaMigratorTest::loadHotQueries()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+
+    const QString path = dir.filePath("hot_queries.sql");
+    QVERIFY(writeFile(path,
+        "-- 说明\n"
+        "\n"
+        "-- name: by_user\n"
+        "-- params: 7, 'abc'\n"
+        "SELECT *\n"
+        "FROM users\n"
+        "WHERE id = ? AND name = ?;\n"
+        "\n"
+        "-- name: no_params\n"
+        "SELECT 1;\n"));
+
+    const QList<SchemaMigrator::HotQuery> queries = SchemaMigrator::loadHotQueries(path);
+    QCOMPARE(queries.size(), 2);
+
+    QCOMPARE(queries[0].name, QString("by_user"));
+    QCOMPARE(queries[0].sql, QString("SELECT *\nFROM users\nWHERE id = ? AND name = ?"));
+    QCOMPARE(queries[0].params.size(), 2);
+    QCOMPARE(queries[0].params[0].toLongLong(), qint64(7));
+    QCOMPARE(queries[0].params[1].toString(), QString("abc"));
+
+    QCOMPARE(queries[1].name, QString("no_params"));
+    QCOMPARE(queries[1].sql, QString("SELECT 1"));
+    QVERIFY(queries[1].params.isEmpty());
+}
+
+void SchemaMigratorTest::bundledHotQueries()
+{
+    const QList<SchemaMigrator::HotQuery> queries =
+        SchemaMigrator::loadHotQueries(migrationsDir() + "/hot_queries.sql");
+    QVERIFY(!queries.isEmpty());
+
+    // 每条热点查询都有名称，且示例参数个数与占位符个数一致，否则EXPLAIN无法执行
+    QSet<QString> names;
+    for (const SchemaMigrator::HotQuery &query : queries) {
+        QVERIFY(!query.name.isEmpty());
+        QVERIFY2(!names.contains(query.name), qPrintable(query.name));
+        names.insert(query.name);
+        QVERIFY2(query.params.size() == query.sql.count('?'), qPrintable(query.name));
+    }
+}
+
+QTEST_GUILESS_MAIN(SchemaMigratorTest)
+#include "SchemaMigratorTest.moc"
@@ -0,0 +1,173 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+"""
+QKChat 飞行记录器转储解码工具
+
+用法:
+    python3 flight_recorder_decode.py <dump.bin> [--thread NAME] [--last N] [--type TYPE ...]
+
+将服务器 FlightRecorder 生成的二进制转储合并为按时间排序的事件时间线。
+文件格式见 Server/src/monitoring/FlightRecorder.cpp（本机字节序，默认按小端解析）。
+"""
+
+import argparse
+import datetime
+import struct
+import sys
+
+FILE_HEADER = struct.Struct("<8sIIIiQQQIIII")      # 64字节
+RING_HEADER = struct.Struct("<Q32sIIQ")            # 56字节
+EVENT = struct.Struct("<QIHHQQ")                   # 32字节
+
+EVENT_TYPES = {
+    0: "MARKER",
+    1: "ACCEPT",
+    2: "CLOSE",
+    3: "FRAME_IN",
+    4: "FRAME_OUT",
+    5: "ACTION_START",
+    6: "ACTION_END",
+    7: "DB_ACQUIRE",
+    8: "DB_RELEASE",
+    9: "LOCK_WAIT",
+    10: "QUEUE_DEPTH",
+    11: "LOOP_STALL",
+    12: "DUMP",
+}
+
+DUMP_REASONS = {
+    0: "manual",
+    1: "signal",
+    2: "fatal_signal",
+    3: "anomaly",
+    4: "shutdown",
+}
+
+
+def read_dump(path):
+    with open(path, "rb") as f:
+        data = f.read()
+
+    (magic, version, event_size, reason, signal_number, wall_ms_init, steady_ns_init,
+     dump_steady_ns, ring_count, string_count, string_slot_size, _reserved) = FILE_HEADER.unpack_from(data, 0)
+
+    if magic != b"QKFLTREC":
+        raise ValueError("not a QKChat flight recorder dump")
+    if version != 1 or event_size != EVENT.size:
+        raise ValueError("unsupported dump version %d (event size %d)" % (version, event_size))
+
+    offset = FILE_HEADER.size
+    strings = []
+    for _ in range(string_count):
+        raw = data[offset:offset + string_slot_size]
+        strings.append(raw.split(b"\0", 1)[0].decode("utf-8", "replace"))
+        offset += string_slot_size
+
+    header = {
+        "reason": DUMP_REASONS.get(reason, str(reason)),
+        "signal": signal_number,
+        "wall_ms_init": wall_ms_init,
+        "steady_ns_init": steady_ns_init,
+        "dump_steady_ns": dump_steady_ns,
+    }
+
+    events = []
+    threads = []
+    for _ in range(ring_count):
+        thread_id, name, capacity, in_use, head = RING_HEADER.unpack_from(data, offset)
+        offset += RING_HEADER.size
+        thread_name = name.split(b"\0", 1)[0].decode("utf-8", "replace") or "thread"
+        label = "%s/%x" % (thread_name, thread_id)
+        threads.append((label, capacity, head, in_use))
+
+        # 缓冲区未写满时只有 [0, head) 有效，否则从 head 处开始是最旧的事件
+        count = min(head, capacity)
+        start = head - count
+        for seq in range(start, head):
+            slot = seq % capacity
+            ts, sequence, etype, flags, a, b = EVENT.unpack_from(data, offset + slot * EVENT.size)
+            # 序号不一致说明该槽位在转储时正被改写
+            if sequence != (seq & 0xFFFFFFFF):
+                continue
+            events.append((ts, label, etype, a, b))
+        offset += capacity * EVENT.size
+
+    events.sort(key=lambda e: e[0])
+    return header, strings, threads, events
+
+
+def format_time(header, steady_ns):
+    wall_ms = header["wall_ms_init"] + (steady_ns - header["steady_ns_init"]) / 1e6
+    dt = datetime.datetime.fromtimestamp(wall_ms / 1000.0)
+    return dt.strftime("%Y-%m-%d %H:%M:%S.%f")
+
+
+def lookup(strings, index):
+    if 0 <= index < len(strings):
+        return strings[index]
+    return "#%d" % index
+
+
+def describe(strings, etype, a, b):
+    if etype == 1:
+        return "fd=%d active=%d" % (a, b)
+    if etype == 2:
+        return "conn=%x" % a
+    if etype in (3, 4):
+        return "conn=%x bytes=%d" % (a, b)
+    if etype == 5:
+        return "action=%s" % lookup(strings, a)
+    if etype == 6:
+        return "action=%s took=%.3fms" % (lookup(strings, a), b / 1000.0)
+    if etype == 7:
+        return "%s wait=%.3fms" % ("ok" if a else "FAILED", b / 1000.0)
+    if etype == 8:
+        return "held=%.3fms" % (b / 1000.0)
+    if etype == 9:
+        return "lock=%s wait=%.3fms" % (lookup(strings, a), b / 1000.0)
+    if etype == 10:
+        return "queue=%s depth=%d" % (lookup(strings, a), b)
+    if etype == 11:
+        return "action=%s lag=%dms" % (lookup(strings, a), b)
+    if etype == 12:
+        return "reason=%s" % DUMP_REASONS.get(a, str(a))
+    if etype == 0:
+        return lookup(strings, a)
+    return "a=%d b=%d" % (a, b)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Decode QKChat flight recorder dumps")
+    parser.add_argument("dump", help="flight_*.bin dump file")
+    parser.add_argument("--thread", help="only show threads whose label contains this text")
+    parser.add_argument("--last", type=int, default=0, help="only show the last N events")
+    parser.add_argument("--type", action="append", help="only show these event types (e.g. ACTION_END)")
+    args = parser.parse_args()
+
+    try:
+        header, strings, threads, events = read_dump(args.dump)
+    except (OSError, ValueError, struct.error) as e:
+        print("error: %s" % e, file=sys.stderr)
+        return 1
+
+    print("# reason=%s signal=%d dumped_at=%s" % (
+        header["reason"], header["signal"], format_time(header, header["dump_steady_ns"])))
+    for label, capacity, head, in_use in threads:
+        print("# thread %-32s capacity=%d written=%d%s" % (
+            label, capacity, head, "" if in_use else " (exited)"))
+
+    types = set(t.upper() for t in args.type) if args.type else None
+    selected = [e for e in events
+                if (not args.thread or args.thread in e[1])
+                and (types is None or EVENT_TYPES.get(e[2], "") in types)]
+    if args.last > 0:
+        selected = selected[-args.last:]
+
+    for ts, label, etype, a, b in selected:
+        print("%s  %-24s %-12s %s" % (format_time(header, ts), label,
+                                      EVENT_TYPES.get(etype, str(etype)), describe(strings, etype, a, b)))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
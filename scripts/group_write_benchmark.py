@@ -0,0 +1,181 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+"""
+QKChat 群消息写放大对比
+
+用法:
+    python3 group_write_benchmark.py --host H --user U --password P --database D
+                                     [--members 2,10,50,200,1000] [--messages N] [--offline-ratio R]
+
+在指定数据库中建立临时表（bench_前缀，结束后删除），按不同群成员数各发送N条消息，比较两种存储方式:
+    per-member   每个接收者写一行消息，离线接收者再写一行离线队列（与单聊messages表相同的写法）
+    timeline     服务器采用的群时间线：分配序号、写一行消息、推进发送者游标
+
+统计每条消息的InnoDB行写入数（会话状态Handler_write + Handler_update的增量）、
+每条消息每个成员的写入行数（写放大）以及每条消息的平均耗时。
+需要pymysql（pip install pymysql）。
+"""
+
+import argparse
+import sys
+import time
+import uuid
+
+try:
+    import pymysql
+except ImportError:
+    pymysql = None
+
+CONTENT = "x" * 64
+
+SCHEMA = [
+    """CREATE TABLE bench_messages (
+        id BIGINT UNSIGNED AUTO_INCREMENT PRIMARY KEY,
+        message_id VARCHAR(64) NOT NULL,
+        sender_id BIGINT UNSIGNED NOT NULL,
+        receiver_id BIGINT UNSIGNED NOT NULL,
+        content TEXT,
+        created_at TIMESTAMP DEFAULT CURRENT_TIMESTAMP,
+        INDEX idx_receiver (receiver_id),
+        INDEX idx_message_id (message_id)
+    ) ENGINE=InnoDB""",
+    """CREATE TABLE bench_offline_queue (
+        id BIGINT UNSIGNED AUTO_INCREMENT PRIMARY KEY,
+        user_id BIGINT UNSIGNED NOT NULL,
+        message_id BIGINT UNSIGNED NOT NULL,
+        INDEX idx_user (user_id)
+    ) ENGINE=InnoDB""",
+    """CREATE TABLE bench_groups (
+        id BIGINT UNSIGNED AUTO_INCREMENT PRIMARY KEY,
+        last_seq BIGINT UNSIGNED NOT NULL DEFAULT 0
+    ) ENGINE=InnoDB""",
+    """CREATE TABLE bench_group_members (
+        group_id BIGINT UNSIGNED NOT NULL,
+        user_id BIGINT UNSIGNED NOT NULL,
+        last_read_seq BIGINT UNSIGNED NOT NULL DEFAULT 0,
+        PRIMARY KEY (group_id, user_id),
+        INDEX idx_user (user_id)
+    ) ENGINE=InnoDB""",
+    """CREATE TABLE bench_group_messages (
+        id BIGINT UNSIGNED AUTO_INCREMENT PRIMARY KEY,
+        group_id BIGINT UNSIGNED NOT NULL,
+        seq BIGINT UNSIGNED NOT NULL,
+        message_id VARCHAR(64) NOT NULL UNIQUE,
+        sender_id BIGINT UNSIGNED NOT NULL,
+        content TEXT,
+        created_at TIMESTAMP DEFAULT CURRENT_TIMESTAMP,
+        UNIQUE INDEX idx_group_seq (group_id, seq)
+    ) ENGINE=InnoDB""",
+]
+
+TABLES = ["bench_messages", "bench_offline_queue", "bench_group_messages", "bench_group_members", "bench_groups"]
+
+
+def drop_tables(cur):
+    for table in TABLES:
+        cur.execute("DROP TABLE IF EXISTS %s" % table)
+
+
+def row_writes(cur):
+    cur.execute("SHOW SESSION STATUS WHERE Variable_name IN ('Handler_write', 'Handler_update')")
+    return sum(int(value) for _, value in cur.fetchall())
+
+
+def send_per_member(conn, cur, sender, members, offline):
+    cur.execute("BEGIN")
+    message_id = str(uuid.uuid4())
+    for member in members:
+        if member == sender:
+            continue
+        cur.execute("INSERT INTO bench_messages (message_id, sender_id, receiver_id, content) "
+                    "VALUES (%s, %s, %s, %s)", (message_id, sender, member, CONTENT))
+        if member in offline:
+            cur.execute("INSERT INTO bench_offline_queue (user_id, message_id) VALUES (%s, LAST_INSERT_ID())",
+                        (member,))
+    conn.commit()
+
+
+def send_timeline(conn, cur, group_id, sender):
+    cur.execute("BEGIN")
+    cur.execute("UPDATE bench_groups SET last_seq = LAST_INSERT_ID(last_seq + 1) WHERE id = %s", (group_id,))
+    cur.execute("SELECT LAST_INSERT_ID()")
+    seq = cur.fetchone()[0]
+    cur.execute("INSERT INTO bench_group_messages (group_id, seq, message_id, sender_id, content) "
+                "VALUES (%s, %s, %s, %s, %s)", (group_id, seq, str(uuid.uuid4()), sender, CONTENT))
+    cur.execute("UPDATE bench_group_members SET last_read_seq = %s WHERE group_id = %s AND user_id = %s",
+                (seq, group_id, sender))
+    conn.commit()
+
+
+def run(conn, member_count, messages, offline_ratio):
+    cur = conn.cursor()
+    members = list(range(1, member_count + 1))
+    offline = set(members[:int(member_count * offline_ratio)])
+
+    cur.execute("INSERT INTO bench_groups (last_seq) VALUES (0)")
+    group_id = cur.lastrowid
+    cur.executemany("INSERT INTO bench_group_members (group_id, user_id) VALUES (%s, %s)",
+                    [(group_id, member) for member in members])
+    conn.commit()
+
+    # SHOW STATUS自身可能使用临时表并计入Handler_write，先测出这部分开销
+    first = row_writes(cur)
+    overhead = row_writes(cur) - first
+
+    results = []
+    for name in ("per-member", "timeline"):
+        before = row_writes(cur)
+        start = time.perf_counter()
+        for i in range(messages):
+            sender = members[i % member_count]
+            if name == "per-member":
+                send_per_member(conn, cur, sender, members, offline)
+            else:
+                send_timeline(conn, cur, group_id, sender)
+        elapsed = time.perf_counter() - start
+        rows = row_writes(cur) - before - overhead
+        results.append((name, rows / messages, rows / messages / member_count, elapsed * 1000 / messages))
+    cur.close()
+    return results
+
+
+def main():
+    parser = argparse.ArgumentParser(description="compare group message write amplification: per-member rows vs timeline")
+    parser.add_argument("--host", default="localhost")
+    parser.add_argument("--port", type=int, default=3306)
+    parser.add_argument("--user", default="root")
+    parser.add_argument("--password", default="")
+    parser.add_argument("--database", default="qkchat")
+    parser.add_argument("--members", default="2,10,50,200,1000", help="comma separated member counts")
+    parser.add_argument("--messages", type=int, default=200, help="messages per member count (default 200)")
+    parser.add_argument("--offline-ratio", type=float, default=0.5,
+                        help="fraction of members offline, queued per message by per-member (default 0.5)")
+    args = parser.parse_args()
+
+    if pymysql is None:
+        print("error: pymysql not installed (pip install pymysql)", file=sys.stderr)
+        return 1
+
+    conn = pymysql.connect(host=args.host, port=args.port, user=args.user, password=args.password,
+                           database=args.database, autocommit=False)
+    cur = conn.cursor()
+    drop_tables(cur)
+    for statement in SCHEMA:
+        cur.execute(statement)
+    conn.commit()
+
+    try:
+        print("# %d messages per size, %.0f%% members offline" % (args.messages, args.offline_ratio * 100))
+        print("%8s  %-10s  %12s  %16s  %10s" % ("members", "strategy", "rows/msg", "rows/msg/member", "ms/msg"))
+        for member_count in [int(value) for value in args.members.split(",") if value]:
+            for name, rows, per_member, ms in run(conn, member_count, args.messages, args.offline_ratio):
+                print("%8d  %-10s  %12.1f  %16.3f  %10.2f" % (member_count, name, rows, per_member, ms))
+    finally:
+        drop_tables(cur)
+        conn.commit()
+        conn.close()
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,206 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+"""
+QKChat 内核TLS卸载 CPU开销对比
+
+用法:
+    python3 ktls_benchmark.py [--gb N] [--chunk-kb N] [--mode MODE ...]
+
+在回环连接上以与服务器相同的TLS参数（TLS 1.2、AES-GCM、无会话票据）发送数据，
+统计发送进程每GB消耗的CPU时间（用户态+内核态）：
+    userspace      OpenSSL在用户态加密后写入套接字（相当于QSslSocket）
+    ktls-write     握手后密钥装入内核，明文write由内核加密（相当于kernel_tls.enabled）
+    ktls-sendfile  同上，但用sendfile直接从文件发送，数据不经过用户态
+
+接收端在子进程中用户态解密，不计入统计。内核未加载tls模块时跳过kTLS模式。
+"""
+
+import argparse
+import multiprocessing
+import os
+import resource
+import shutil
+import socket
+import ssl
+import subprocess
+import sys
+import tempfile
+import time
+
+SOL_TLS = 282
+TLS_TX = 1
+OP_ENABLE_KTLS = getattr(ssl, "OP_ENABLE_KTLS", 1 << 3)
+CIPHERS = "ECDHE-RSA-AES128-GCM-SHA256"
+FILE_SIZE = 64 * 1024 * 1024
+
+
+def make_certificate(directory):
+    cert = os.path.join(directory, "cert.pem")
+    key = os.path.join(directory, "key.pem")
+    subprocess.run(["openssl", "req", "-x509", "-newkey", "rsa:2048", "-nodes", "-days", "1",
+                    "-subj", "/CN=qkchat-bench", "-keyout", key, "-out", cert],
+                   check=True, stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL)
+    return cert, key
+
+
+def server_context(cert, key, ktls):
+    ctx = ssl.SSLContext(ssl.PROTOCOL_TLS_SERVER)
+    ctx.minimum_version = ssl.TLSVersion.TLSv1_2
+    ctx.maximum_version = ssl.TLSVersion.TLSv1_2
+    ctx.set_ciphers(CIPHERS)
+    ctx.options |= ssl.OP_NO_TICKET
+    if ktls:
+        ctx.options |= OP_ENABLE_KTLS
+    ctx.load_cert_chain(cert, key)
+    return ctx
+
+
+def receiver(port, total):
+    ctx = ssl.SSLContext(ssl.PROTOCOL_TLS_CLIENT)
+    ctx.check_hostname = False
+    ctx.verify_mode = ssl.CERT_NONE
+    with socket.create_connection(("127.0.0.1", port)) as raw:
+        with ctx.wrap_socket(raw) as conn:
+            buffer = bytearray(256 * 1024)
+            received = 0
+            try:
+                while received < total:
+                    n = conn.recv_into(buffer)
+                    if n == 0:
+                        break
+                    received += n
+            except (ssl.SSLError, OSError):
+                pass    # 发送端跳过该模式时直接关闭连接
+
+
+def kernel_tx_active(sock):
+    try:
+        sock.getsockopt(SOL_TLS, TLS_TX, 40)
+        return True
+    except OSError:
+        return False
+
+
+def send_userspace(conn, path, total, chunk):
+    sent = 0
+    with open(path, "rb", buffering=0) as f:
+        while sent < total:
+            data = f.read(min(chunk, total - sent))
+            if not data:
+                f.seek(0)
+                continue
+            conn.sendall(data)
+            sent += len(data)
+
+
+def send_kernel_write(conn, path, total, chunk):
+    # 内核已持有密钥，绕过SSLSocket直接写明文
+    raw = socket.socket(fileno=os.dup(conn.fileno()))
+    sent = 0
+    try:
+        with open(path, "rb", buffering=0) as f:
+            while sent < total:
+                data = f.read(min(chunk, total - sent))
+                if not data:
+                    f.seek(0)
+                    continue
+                raw.sendall(data)
+                sent += len(data)
+    finally:
+        raw.close()
+
+
+def send_kernel_sendfile(conn, path, total, chunk):
+    fd = conn.fileno()
+    sent = 0
+    with open(path, "rb") as f:
+        offset = 0
+        while sent < total:
+            if offset >= FILE_SIZE:
+                offset = 0
+            n = os.sendfile(fd, f.fileno(), offset, min(chunk, total - sent, FILE_SIZE - offset))
+            if n == 0:
+                break
+            offset += n
+            sent += n
+
+
+SENDERS = {
+    "userspace": (False, send_userspace),
+    "ktls-write": (True, send_kernel_write),
+    "ktls-sendfile": (True, send_kernel_sendfile),
+}
+
+
+def run_mode(mode, cert, key, path, total, chunk):
+    ktls, sender = SENDERS[mode]
+    ctx = server_context(cert, key, ktls)
+
+    with socket.socket(socket.AF_INET, socket.SOCK_STREAM) as listener:
+        listener.bind(("127.0.0.1", 0))
+        listener.listen(1)
+        port = listener.getsockname()[1]
+
+        child = multiprocessing.Process(target=receiver, args=(port, total))
+        child.start()
+        raw, _ = listener.accept()
+        conn = ctx.wrap_socket(raw, server_side=True)
+
+        try:
+            if ktls and not kernel_tx_active(conn):
+                print("%-14s skipped: kernel TLS not available" % mode)
+                return None
+
+            before = resource.getrusage(resource.RUSAGE_SELF)
+            started = time.perf_counter()
+            sender(conn, path, total, chunk)
+            wall = time.perf_counter() - started
+            after = resource.getrusage(resource.RUSAGE_SELF)
+        finally:
+            conn.close()
+            child.join()
+
+    user = after.ru_utime - before.ru_utime
+    system = after.ru_stime - before.ru_stime
+    gigabytes = total / float(1 << 30)
+    print("%-14s %6.2f GB  wall %6.2fs  user %6.2fs  sys %6.2fs  cpu/GB %6.3fs  %8.1f MB/s" % (
+        mode, gigabytes, wall, user, system, (user + system) / gigabytes, total / wall / (1 << 20)))
+    return (user + system) / gigabytes
+
+
+def main():
+    parser = argparse.ArgumentParser(description="compare sender CPU per GB for userspace TLS vs kernel TLS")
+    parser.add_argument("--gb", type=float, default=1.0, help="bytes to send per mode, in GB (default 1)")
+    parser.add_argument("--chunk-kb", type=int, default=64, help="write/sendfile size in KB (default 64)")
+    parser.add_argument("--mode", action="append", choices=sorted(SENDERS), help="modes to run (default all)")
+    args = parser.parse_args()
+
+    if shutil.which("openssl") is None:
+        print("error: openssl command not found", file=sys.stderr)
+        return 1
+
+    total = int(args.gb * (1 << 30))
+    chunk = args.chunk_kb * 1024
+    modes = args.mode or ["userspace", "ktls-write", "ktls-sendfile"]
+
+    with tempfile.TemporaryDirectory() as directory:
+        cert, key = make_certificate(directory)
+        path = os.path.join(directory, "payload.bin")
+        with open(path, "wb") as f:
+            f.write(os.urandom(FILE_SIZE))
+
+        print("# %s, cipher %s, chunk %d KB" % (ssl.OPENSSL_VERSION, CIPHERS, args.chunk_kb))
+        results = {}
+        for mode in modes:
+            results[mode] = run_mode(mode, cert, key, path, total, chunk)
+
+    baseline = results.get("userspace")
+    if baseline:
+        for mode, cost in results.items():
+            if mode != "userspace" and cost:
+                print("# %s uses %.0f%% of userspace CPU per GB" % (mode, 100.0 * cost / baseline))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,276 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+"""
+QKChat 热点查询执行计划检查
+
+用法:
+    python3 plan_check.py --host H --user U --password P
+                          [--database qkchat_plan_check] [--min-rows 1000] [--keep]
+
+在临时数据库中（开始时重建，结束后删除）应用Server/migrations下的全部迁移，写入足够多的测试数据并
+ANALYZE，然后EXPLAIN hot_queries.sql中的每条查询。任一查询对估计行数不少于--min-rows的表做全表扫描
+（type为ALL）时打印执行计划并以状态1退出，可在修改热点查询或迁移后运行。
+
+迁移只包含服务器创建的表；messages、message_read_status、friendships、friend_groups、
+offline_message_queue不在迁移中，脚本按服务中使用的字段建立只有主键的测试表，由迁移补上索引。
+需要pymysql（pip install pymysql）。
+"""
+
+import argparse
+import os
+import random
+import re
+import sys
+
+try:
+    import pymysql
+except ImportError:
+    pymysql = None
+
+MIGRATIONS_DIR = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "Server", "migrations")
+
+FIXTURE_SCHEMA = [
+    """CREATE TABLE messages (
+        id BIGINT UNSIGNED AUTO_INCREMENT PRIMARY KEY,
+        message_id VARCHAR(64) NOT NULL,
+        sender_id BIGINT UNSIGNED NOT NULL,
+        receiver_id BIGINT UNSIGNED NOT NULL,
+        message_type VARCHAR(20) NOT NULL DEFAULT 'text',
+        content TEXT,
+        file_url VARCHAR(512) DEFAULT NULL,
+        file_size BIGINT UNSIGNED DEFAULT NULL,
+        file_hash VARCHAR(128) DEFAULT NULL,
+        delivery_status VARCHAR(20) DEFAULT 'sent',
+        created_at TIMESTAMP DEFAULT CURRENT_TIMESTAMP
+    ) ENGINE=InnoDB""",
+    """CREATE TABLE message_read_status (
+        id BIGINT UNSIGNED AUTO_INCREMENT PRIMARY KEY,
+        message_id BIGINT UNSIGNED NOT NULL,
+        user_id BIGINT UNSIGNED NOT NULL,
+        read_at TIMESTAMP NULL DEFAULT NULL
+    ) ENGINE=InnoDB""",
+    """CREATE TABLE friend_groups (
+        id BIGINT UNSIGNED AUTO_INCREMENT PRIMARY KEY,
+        user_id BIGINT UNSIGNED NOT NULL,
+        group_name VARCHAR(50) NOT NULL,
+        group_order INT NOT NULL DEFAULT 0
+    ) ENGINE=InnoDB""",
+    """CREATE TABLE friendships (
+        id BIGINT UNSIGNED AUTO_INCREMENT PRIMARY KEY,
+        user_id BIGINT UNSIGNED NOT NULL,
+        friend_id BIGINT UNSIGNED NOT NULL,
+        status ENUM('pending', 'accepted', 'blocked', 'deleted') DEFAULT 'pending',
+        note VARCHAR(100) DEFAULT NULL,
+        group_id BIGINT UNSIGNED DEFAULT NULL,
+        accepted_at TIMESTAMP NULL DEFAULT NULL,
+        blocked_at TIMESTAMP NULL DEFAULT NULL
+    ) ENGINE=InnoDB""",
+    """CREATE TABLE offline_message_queue (
+        id BIGINT UNSIGNED AUTO_INCREMENT PRIMARY KEY,
+        user_id BIGINT UNSIGNED NOT NULL,
+        message_id BIGINT UNSIGNED NOT NULL,
+        message_type VARCHAR(20) NOT NULL DEFAULT 'private',
+        priority INT NOT NULL DEFAULT 0,
+        created_at TIMESTAMP DEFAULT CURRENT_TIMESTAMP,
+        delivered_at TIMESTAMP NULL DEFAULT NULL
+    ) ENGINE=InnoDB""",
+]
+
+USERS = 2000
+MESSAGES = 20000
+FRIENDS_PER_USER = 10
+GROUPS = 200
+GROUPS_PER_USER = 5
+MESSAGES_PER_GROUP = 100
+BATCH = 1000
+
+
+def split_statements(script):
+    """与SchemaMigrator::splitStatements相同：去掉注释行，以行尾分号结束一条语句"""
+    statements, current = [], []
+    for line in script.splitlines():
+        stripped = line.strip()
+        if not stripped or stripped.startswith("--"):
+            continue
+        current.append(line)
+        if stripped.endswith(";"):
+            statements.append("\n".join(current).strip()[:-1])
+            current = []
+    if "".join(current).strip():
+        statements.append("\n".join(current).strip())
+    return statements
+
+
+def load_migrations():
+    migrations = []
+    for name in os.listdir(MIGRATIONS_DIR):
+        match = re.match(r"^V(\d+)__(\w+)\.sql$", name)
+        if match:
+            with open(os.path.join(MIGRATIONS_DIR, name), encoding="utf-8") as f:
+                migrations.append((int(match.group(1)), name, split_statements(f.read())))
+    return sorted(migrations)
+
+
+def parse_params(text):
+    params = []
+    for item in text.split(","):
+        value = item.strip()
+        if not value:
+            continue
+        if len(value) >= 2 and value.startswith("'") and value.endswith("'"):
+            params.append(value[1:-1])
+        else:
+            params.append(int(value))
+    return params
+
+
+def load_hot_queries():
+    """与SchemaMigrator::loadHotQueries相同的格式"""
+    queries, name, params, sql = [], "", [], []
+    with open(os.path.join(MIGRATIONS_DIR, "hot_queries.sql"), encoding="utf-8") as f:
+        for line in f.read().splitlines():
+            stripped = line.strip()
+            if stripped.startswith("-- name:"):
+                name = stripped[len("-- name:"):].strip()
+            elif stripped.startswith("-- params:"):
+                params = parse_params(stripped[len("-- params:"):])
+            elif stripped and not stripped.startswith("--"):
+                sql.append(line)
+                if stripped.endswith(";"):
+                    queries.append((name, "\n".join(sql).strip()[:-1], params))
+                    name, params, sql = "", [], []
+    return queries
+
+
+def insert_many(conn, cur, sql, rows):
+    for start in range(0, len(rows), BATCH):
+        cur.executemany(sql, rows[start:start + BATCH])
+    conn.commit()
+
+
+def seed(conn, cur):
+    rng = random.Random(42)
+    users = range(1, USERS + 1)
+
+    insert_many(conn, cur,
+                "INSERT INTO users (id, username, email, password_hash, salt, display_name, status) "
+                "VALUES (%s, %s, %s, 'x', 'x', %s, 'active')",
+                [(u, "user%d" % u, "user%d@example.com" % u, "User %d" % u) for u in users])
+
+    insert_many(conn, cur,
+                "INSERT INTO verification_codes (email, code, type, expires_at) "
+                "VALUES (%s, %s, 'registration', NOW() + INTERVAL 5 MINUTE)",
+                [("user%d@example.com" % rng.choice(users), "%06d" % rng.randrange(1000000))
+                 for _ in range(USERS * 2)])
+
+    messages = []
+    for i in range(1, MESSAGES + 1):
+        sender, receiver = rng.sample(users, 2)
+        messages.append((i, "m%d" % i, sender, receiver, "hello", rng.randrange(86400 * 30)))
+    insert_many(conn, cur,
+                "INSERT INTO messages (id, message_id, sender_id, receiver_id, content, created_at) "
+                "VALUES (%s, %s, %s, %s, %s, NOW() - INTERVAL %s SECOND)",
+                messages)
+
+    insert_many(conn, cur,
+                "INSERT INTO message_read_status (message_id, user_id, read_at) VALUES (%s, %s, NOW())",
+                [(m[0], m[3]) for m in messages if m[0] % 2 == 0])
+
+    insert_many(conn, cur,
+                "INSERT INTO offline_message_queue (user_id, message_id, priority, delivered_at) "
+                "VALUES (%s, %s, %s, IF(%s, NOW(), NULL))",
+                [(m[3], m[0], rng.randrange(3), m[0] % 4 != 0) for m in messages])
+
+    insert_many(conn, cur,
+                "INSERT INTO friend_groups (id, user_id, group_name, group_order) VALUES (%s, %s, %s, 0)",
+                [(u, u, "默认分组") for u in users])
+
+    insert_many(conn, cur,
+                "INSERT INTO friendships (user_id, friend_id, status, group_id, accepted_at) "
+                "VALUES (%s, %s, 'accepted', %s, NOW())",
+                [(u, f, u) for u in users for f in rng.sample(users, FRIENDS_PER_USER) if f != u])
+
+    insert_many(conn, cur,
+                "INSERT INTO chat_groups (id, name, owner_id, member_count, last_seq) VALUES (%s, %s, %s, %s, %s)",
+                [(g, "group%d" % g, g, USERS * GROUPS_PER_USER // GROUPS, MESSAGES_PER_GROUP)
+                 for g in range(1, GROUPS + 1)])
+
+    insert_many(conn, cur,
+                "INSERT IGNORE INTO chat_group_members (group_id, user_id) VALUES (%s, %s)",
+                [(g, u) for u in users for g in rng.sample(range(1, GROUPS + 1), GROUPS_PER_USER)])
+
+    insert_many(conn, cur,
+                "INSERT INTO group_messages (group_id, seq, message_id, sender_id, content) "
+                "VALUES (%s, %s, %s, %s, 'hello')",
+                [(g, s, "g%d-%d" % (g, s), rng.choice(users))
+                 for g in range(1, GROUPS + 1) for s in range(1, MESSAGES_PER_GROUP + 1)])
+
+    cur.execute("SHOW TABLES")
+    for (table,) in cur.fetchall():
+        cur.execute("ANALYZE TABLE `%s`" % table)
+        cur.fetchall()
+
+
+def check_plans(cur, min_rows):
+    failures = 0
+    for name, sql, params in load_hot_queries():
+        cur.execute("EXPLAIN " + sql.replace("%", "%%").replace("?", "%s"), params)
+        columns = [column[0] for column in cur.description]
+        plan = [dict(zip(columns, row)) for row in cur.fetchall()]
+        full_scans = [row for row in plan if row["type"] == "ALL" and (row["rows"] or 0) >= min_rows]
+
+        print("%-20s  %s" % (name, "FULL SCAN" if full_scans else "ok"))
+        if full_scans:
+            failures += 1
+            for row in plan:
+                print("    %-22s type=%-8s key=%-30s rows=%s" %
+                      (row["table"], row["type"], row["key"], row["rows"]))
+    return failures
+
+
+def main():
+    parser = argparse.ArgumentParser(description="check hot query plans against a scratch database built from migrations")
+    parser.add_argument("--host", default="localhost")
+    parser.add_argument("--port", type=int, default=3306)
+    parser.add_argument("--user", default="root")
+    parser.add_argument("--password", default="")
+    parser.add_argument("--database", default="qkchat_plan_check", help="scratch database, dropped and recreated")
+    parser.add_argument("--min-rows", type=int, default=1000,
+                        help="report full scans estimated at this many rows or more (default 1000)")
+    parser.add_argument("--keep", action="store_true", help="keep the scratch database for inspection")
+    args = parser.parse_args()
+
+    if pymysql is None:
+        print("error: pymysql not installed (pip install pymysql)", file=sys.stderr)
+        return 1
+
+    conn = pymysql.connect(host=args.host, port=args.port, user=args.user, password=args.password,
+                           charset="utf8mb4", autocommit=False)
+    cur = conn.cursor()
+    cur.execute("DROP DATABASE IF EXISTS `%s`" % args.database)
+    cur.execute("CREATE DATABASE `%s` CHARACTER SET utf8mb4" % args.database)
+    cur.execute("USE `%s`" % args.database)
+
+    try:
+        for statement in FIXTURE_SCHEMA:
+            cur.execute(statement)
+        for version, name, statements in load_migrations():
+            for statement in statements:
+                cur.execute(statement)
+            print("# applied %s (%d statements)" % (name, len(statements)))
+
+        seed(conn, cur)
+        failures = check_plans(cur, args.min_rows)
+    finally:
+        if not args.keep:
+            cur.execute("DROP DATABASE IF EXISTS `%s`" % args.database)
+        conn.close()
+
+    if failures:
+        print("%d hot queries fall back to full table scans" % failures, file=sys.stderr)
+        return 1
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,572 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+"""
+QKChat协议代码生成器
+
+用法:
+    python3 protocol_codegen.py <protocol.json> <输出目录>
+
+根据协议描述文件为每条消息生成一个结构体（ProtocolMessages.h/.cpp）:
+    fromJson  遍历一次JSON对象，按键长度和内容分派到字段，同时完成类型检查和必需字段校验
+    toJson    按字段顺序写出，可选字段等于默认值时省略
+    encode    二进制编码（QDataStream）：字段位图加上出现的字段值
+    decode    二进制解码，校验规则与fromJson相同
+
+服务器和客户端的CMake在构建时调用本脚本（协议文件或本脚本变化时重新生成）。
+不依赖第三方库。
+"""
+
+import json
+import os
+import sys
+
+CPP_TYPES = {
+    "int64": "qint64",
+    "int32": "int",
+    "string": "QString",
+    "bool": "bool",
+    "int64_list": "QList<qint64>",
+    "string_list": "QStringList",
+    "array": "QJsonArray",
+    "object": "QJsonObject",
+}
+
+
+MAX_FIELDS = 32
+
+
+def camel(name):
+    parts = name.split("_")
+    return parts[0] + "".join(p[:1].upper() + p[1:] for p in parts[1:])
+
+
+def pascal(name):
+    return "".join(p[:1].upper() + p[1:] for p in name.split("_"))
+
+
+def cpp_string(value):
+    return '"' + value.replace("\\", "\\\\").replace('"', '\\"') + '"'
+
+
+def default_literal(field):
+    kind = field["type"]
+    if "default" in field:
+        value = field["default"]
+        if kind == "string":
+            return "QStringLiteral(%s)" % cpp_string(value)
+        if kind == "bool":
+            return "true" if value else "false"
+        return str(int(value))
+    if kind in ("int64", "int32"):
+        return "0"
+    if kind == "bool":
+        return "false"
+    return None
+
+
+def is_default_expr(field, member):
+    """可选字段等于默认值的判断表达式"""
+    kind = field["type"]
+    if kind == "string":
+        if "default" in field:
+            return "%s == QLatin1String(%s)" % (member, cpp_string(field["default"]))
+        return "%s.isEmpty()" % member
+    if kind in ("int64_list", "string_list", "array", "object"):
+        return "%s.isEmpty()" % member
+    return "%s == %s" % (member, default_literal(field))
+
+
+def validate_schema(schema):
+    names = set()
+    for message in schema["messages"]:
+        if message["name"] in names:
+            raise SystemExit("duplicate message %s" % message["name"])
+        names.add(message["name"])
+        if len(message["fields"]) > MAX_FIELDS:
+            raise SystemExit("%s: more than %d fields" % (message["name"], MAX_FIELDS))
+        seen = set()
+        for field in message["fields"]:
+            if field["type"] not in CPP_TYPES:
+                raise SystemExit("%s.%s: unknown type %s" % (message["name"], field["name"], field["type"]))
+            if field["name"] in seen:
+                raise SystemExit("%s: duplicate field %s" % (message["name"], field["name"]))
+            if field.get("required") and ("default" in field or field.get("presence")):
+                raise SystemExit("%s.%s: required fields take no default or presence flag" % (message["name"], field["name"]))
+            seen.add(field["name"])
+
+
+def emitted_condition(field):
+    """可选字段是否写出（JSON与二进制一致），必需字段总是写出"""
+    if field.get("required"):
+        return None
+    if field.get("presence"):
+        return "has%s" % pascal(field["name"])
+    return "!(%s)" % is_default_expr(field, camel(field["name"]))
+
+
+def generate_header(schema):
+    ns = schema.get("namespace", "Protocol")
+    out = []
+    w = out.append
+    w("// 由 scripts/protocol_codegen.py 根据 protocol/protocol.json 生成，请勿手工修改")
+    w("#ifndef PROTOCOLMESSAGES_H")
+    w("#define PROTOCOLMESSAGES_H")
+    w("")
+    w("#include <QString>")
+    w("#include <QList>")
+    w("#include <QStringList>")
+    w("#include <QByteArray>")
+    w("#include <QJsonObject>")
+    w("#include <QJsonArray>")
+    w("#include <QDataStream>")
+    w("")
+    w("namespace %s {" % ns)
+    w("")
+    w("/**")
+    w(" * @brief 协议描述文件版本，写入二进制编码的头部")
+    w(" */")
+    w("constexpr quint16 SchemaVersion = %d;" % schema["version"])
+    w("")
+
+    for message in schema["messages"]:
+        name = message["name"]
+        brief = message.get("comment")
+        w("/**")
+        w(" * @brief %s%s" % (message["action"], "（%s）" % brief if brief else ""))
+        w(" */")
+        w("struct %s" % name)
+        w("{")
+        w("    static constexpr const char *Action = %s;" % cpp_string(message["action"]))
+        w("")
+        for field in message["fields"]:
+            cpp = CPP_TYPES[field["type"]]
+            member = camel(field["name"])
+            default = default_literal(field)
+            line = "    %s %s" % (cpp, member)
+            if default is not None:
+                line += " = %s" % default
+            line += ";"
+            if field.get("required"):
+                line = line.ljust(48) + "// 必需"
+            w(line)
+            if field.get("presence"):
+                w("    bool has%s = false;" % pascal(field["name"]))
+        w("")
+        w("    /**")
+        w("     * @brief 从JSON对象解码并校验，失败时error为错误描述")
+        w("     */")
+        w("    static bool fromJson(const QJsonObject &json, %s *out, QString *error);" % name)
+        w("    QJsonObject toJson() const;")
+        w("")
+        w("    /**")
+        w("     * @brief 二进制编码/解码（字段位图加字段值）")
+        w("     */")
+        w("    void encode(QDataStream &stream) const;")
+        w("    static bool decode(QDataStream &stream, %s *out, QString *error);" % name)
+        w("};")
+        w("")
+
+    w("/**")
+    w(" * @brief 编码为带版本头的二进制数据")
+    w(" */")
+    w("QByteArray encodeHeader(quint16 version);")
+    w("bool checkHeader(QDataStream &stream, QString *error);")
+    w("")
+    w("template <typename Message>")
+    w("QByteArray toBinary(const Message &message)")
+    w("{")
+    w("    QByteArray data = encodeHeader(SchemaVersion);")
+    w("    QDataStream stream(&data, QIODevice::Append);")
+    w("    stream.setVersion(QDataStream::Qt_5_12);")
+    w("    message.encode(stream);")
+    w("    return data;")
+    w("}")
+    w("")
+    w("template <typename Message>")
+    w("bool fromBinary(const QByteArray &data, Message *out, QString *error)")
+    w("{")
+    w("    QDataStream stream(data);")
+    w("    stream.setVersion(QDataStream::Qt_5_12);")
+    w("    return checkHeader(stream, error) && Message::decode(stream, out, error);")
+    w("}")
+    w("")
+    w("} // namespace %s" % ns)
+    w("")
+    w("#endif // PROTOCOLMESSAGES_H")
+    return "\n".join(out) + "\n"
+
+
+def read_statement(field, target):
+    kind = field["type"]
+    if kind == "int64":
+        return "readInt64(value, %s)" % target
+    if kind == "int32":
+        return "readInt32(value, %s)" % target
+    if kind == "string":
+        return "readString(value, %s)" % target
+    if kind == "bool":
+        return "readBool(value, %s)" % target
+    if kind == "int64_list":
+        return "readInt64List(value, %s)" % target
+    if kind == "string_list":
+        return "readStringList(value, %s)" % target
+    if kind == "array":
+        return "readArray(value, %s)" % target
+    return "readObject(value, %s)" % target
+
+
+def json_value(field, member):
+    kind = field["type"]
+    if kind == "int64_list":
+        return "int64ListToJson(%s)" % member
+    if kind == "string_list":
+        return "QJsonArray::fromStringList(%s)" % member
+    return member
+
+
+def generate_validate(message):
+    name = message["name"]
+    out = []
+    w = out.append
+    w("bool validate%s(const %s &message, quint32 seen, QString *error)" % (name, name))
+    w("{")
+    body = []
+    uses_message = False
+    for index, field in enumerate(message["fields"]):
+        if not field.get("required"):
+            continue
+        member = "message.%s" % camel(field["name"])
+        body.append("    if (!(seen & (1u << %d))) {" % index)
+        body.append("        return fail(error, \"Missing required field: %%1\", %s);" % cpp_string(field["name"]))
+        body.append("    }")
+        if field["type"] == "string":
+            uses_message = True
+            condition = "%s.trimmed().isEmpty()" % member if field.get("not_blank") else "%s.isEmpty()" % member
+            body.append("    if (%s) {" % condition)
+            body.append("        return fail(error, \"Empty required field: %%1\", %s);" % cpp_string(field["name"]))
+            body.append("    }")
+    if not uses_message:
+        w("    Q_UNUSED(message)")
+    if not body:
+        w("    Q_UNUSED(seen)")
+        w("    Q_UNUSED(error)")
+    out.extend(body)
+    w("    return true;")
+    w("}")
+    w("")
+    return out
+
+
+def generate_source(schema):
+    ns = schema.get("namespace", "Protocol")
+    out = []
+    w = out.append
+    w("// 由 scripts/protocol_codegen.py 根据 protocol/protocol.json 生成，请勿手工修改")
+    w('#include "ProtocolMessages.h"')
+    w("")
+    w("#include <QJsonValue>")
+    w("#include <QtGlobal>")
+    w("#include <limits>")
+    w("")
+    w("namespace %s {" % ns)
+    w("")
+    w("namespace {")
+    w("")
+    w("const quint32 HeaderMagic = 0x514B5031;   // \"QKP1\"")
+    w("")
+    w("bool fail(QString *error, const char *format, const char *field)")
+    w("{")
+    w("    if (error) {")
+    w("        *error = QString::fromLatin1(format).arg(QLatin1String(field));")
+    w("    }")
+    w("    return false;")
+    w("}")
+    w("")
+    w("// 整数可为JSON数字或数字字符串（兼容旧客户端把ID作为字符串发送）")
+    w("bool readInt64(const QJsonValue &value, qint64 *out)")
+    w("{")
+    w("    if (value.isDouble()) {")
+    w("#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)")
+    w("        *out = value.toInteger(static_cast<qint64>(value.toDouble()));")
+    w("#else")
+    w("        *out = static_cast<qint64>(value.toDouble());")
+    w("#endif")
+    w("        return true;")
+    w("    }")
+    w("    if (value.isString()) {")
+    w("        bool ok = false;")
+    w("        *out = value.toString().toLongLong(&ok);")
+    w("        return ok;")
+    w("    }")
+    w("    return false;")
+    w("}")
+    w("")
+    w("bool readInt32(const QJsonValue &value, int *out)")
+    w("{")
+    w("    qint64 wide = 0;")
+    w("    if (!readInt64(value, &wide) || wide < std::numeric_limits<int>::min() || wide > std::numeric_limits<int>::max()) {")
+    w("        return false;")
+    w("    }")
+    w("    *out = static_cast<int>(wide);")
+    w("    return true;")
+    w("}")
+    w("")
+    w("bool readString(const QJsonValue &value, QString *out)")
+    w("{")
+    w("    if (!value.isString()) {")
+    w("        return false;")
+    w("    }")
+    w("    *out = value.toString();")
+    w("    return true;")
+    w("}")
+    w("")
+    w("bool readBool(const QJsonValue &value, bool *out)")
+    w("{")
+    w("    if (!value.isBool()) {")
+    w("        return false;")
+    w("    }")
+    w("    *out = value.toBool();")
+    w("    return true;")
+    w("}")
+    w("")
+    w("bool readInt64List(const QJsonValue &value, QList<qint64> *out)")
+    w("{")
+    w("    if (!value.isArray()) {")
+    w("        return false;")
+    w("    }")
+    w("    const QJsonArray array = value.toArray();")
+    w("    out->clear();")
+    w("    out->reserve(array.size());")
+    w("    for (const QJsonValue &item : array) {")
+    w("        qint64 number = 0;")
+    w("        if (!readInt64(item, &number)) {")
+    w("            return false;")
+    w("        }")
+    w("        out->append(number);")
+    w("    }")
+    w("    return true;")
+    w("}")
+    w("")
+    w("bool readStringList(const QJsonValue &value, QStringList *out)")
+    w("{")
+    w("    if (!value.isArray()) {")
+    w("        return false;")
+    w("    }")
+    w("    const QJsonArray array = value.toArray();")
+    w("    out->clear();")
+    w("    out->reserve(array.size());")
+    w("    for (const QJsonValue &item : array) {")
+    w("        if (!item.isString()) {")
+    w("            return false;")
+    w("        }")
+    w("        out->append(item.toString());")
+    w("    }")
+    w("    return true;")
+    w("}")
+    w("")
+    w("bool readArray(const QJsonValue &value, QJsonArray *out)")
+    w("{")
+    w("    if (!value.isArray()) {")
+    w("        return false;")
+    w("    }")
+    w("    *out = value.toArray();")
+    w("    return true;")
+    w("}")
+    w("")
+    w("bool readObject(const QJsonValue &value, QJsonObject *out)")
+    w("{")
+    w("    if (!value.isObject()) {")
+    w("        return false;")
+    w("    }")
+    w("    *out = value.toObject();")
+    w("    return true;")
+    w("}")
+    w("")
+    w("QJsonArray int64ListToJson(const QList<qint64> &values)")
+    w("{")
+    w("    QJsonArray array;")
+    w("    for (qint64 value : values) {")
+    w("        array.append(value);")
+    w("    }")
+    w("    return array;")
+    w("}")
+    w("")
+    w("bool streamFailed(QDataStream &stream, QString *error)")
+    w("{")
+    w("    if (stream.status() == QDataStream::Ok) {")
+    w("        return false;")
+    w("    }")
+    w("    if (error) {")
+    w("        *error = QStringLiteral(\"Truncated binary message\");")
+    w("    }")
+    w("    return true;")
+    w("}")
+    w("")
+    for message in schema["messages"]:
+        out.extend(generate_validate(message))
+    w("} // namespace")
+    w("")
+    w("QByteArray encodeHeader(quint16 version)")
+    w("{")
+    w("    QByteArray data;")
+    w("    QDataStream stream(&data, QIODevice::WriteOnly);")
+    w("    stream.setVersion(QDataStream::Qt_5_12);")
+    w("    stream << HeaderMagic << version;")
+    w("    return data;")
+    w("}")
+    w("")
+    w("bool checkHeader(QDataStream &stream, QString *error)")
+    w("{")
+    w("    quint32 magic = 0;")
+    w("    quint16 version = 0;")
+    w("    stream >> magic >> version;")
+    w("    if (streamFailed(stream, error)) {")
+    w("        return false;")
+    w("    }")
+    w("    if (magic != HeaderMagic || version != SchemaVersion) {")
+    w("        if (error) {")
+    w("            *error = QString(\"Unsupported binary message (version %1)\").arg(version);")
+    w("        }")
+    w("        return false;")
+    w("    }")
+    w("    return true;")
+    w("}")
+    w("")
+
+    for message in schema["messages"]:
+        name = message["name"]
+        fields = message["fields"]
+
+        # fromJson：遍历一次对象，按键长度分派
+        w("bool %s::fromJson(const QJsonObject &json, %s *out, QString *error)" % (name, name))
+        w("{")
+        w("    *out = %s();" % name)
+        w("    quint32 seen = 0;")
+        w("    for (auto it = json.constBegin(); it != json.constEnd(); ++it) {")
+        w("        const QJsonValue value = it.value();")
+        w("        if (value.isNull()) {")
+        w("            continue;")
+        w("        }")
+        w("        const QString key = it.key();")
+        w("        int index = -1;")
+        w("        switch (key.size()) {")
+        by_length = {}
+        for index, field in enumerate(fields):
+            by_length.setdefault(len(field["name"]), []).append((index, field))
+        for length in sorted(by_length):
+            w("        case %d:" % length)
+            for position, (index, field) in enumerate(by_length[length]):
+                if position == 0:
+                    w("            if (key == QLatin1String(%s)) {" % cpp_string(field["name"]))
+                else:
+                    w("            } else if (key == QLatin1String(%s)) {" % cpp_string(field["name"]))
+                w("                index = %d;" % index)
+                w("                if (!%s) {" % read_statement(field, "&out->%s" % camel(field["name"])))
+                w("                    return fail(error, \"Invalid field type: %%1\", %s);" % cpp_string(field["name"]))
+                w("                }")
+                if field.get("presence"):
+                    w("                out->has%s = true;" % pascal(field["name"]))
+            w("            }")
+            w("            break;")
+        w("        default:")
+        w("            break;")
+        w("        }")
+        w("        if (index >= 0) {")
+        w("            seen |= 1u << index;")
+        w("        }")
+        w("    }")
+        w("    return validate%s(*out, seen, error);" % name)
+        w("}")
+        w("")
+
+        # toJson
+        w("QJsonObject %s::toJson() const" % name)
+        w("{")
+        w("    QJsonObject json;")
+        for index, field in enumerate(fields):
+            member = camel(field["name"])
+            condition = emitted_condition(field)
+            assign = "json.insert(QStringLiteral(%s), %s);" % (cpp_string(field["name"]), json_value(field, member))
+            if condition:
+                w("    if (%s) {" % condition)
+                w("        %s" % assign)
+                w("    }")
+            else:
+                w("    %s" % assign)
+        w("    return json;")
+        w("}")
+        w("")
+
+        # encode
+        w("void %s::encode(QDataStream &stream) const" % name)
+        w("{")
+        w("    quint32 fields = 0;")
+        for index, field in enumerate(fields):
+            condition = emitted_condition(field)
+            if condition:
+                w("    if (%s) {" % condition)
+                w("        fields |= 1u << %d;" % index)
+                w("    }")
+            else:
+                w("    fields |= 1u << %d;" % index)
+        w("    stream << fields;")
+        for index, field in enumerate(fields):
+            member = camel(field["name"])
+            value = member if field["type"] != "int32" else "static_cast<qint32>(%s)" % member
+            w("    if (fields & (1u << %d)) {" % index)
+            w("        stream << %s;" % value)
+            w("    }")
+        w("}")
+        w("")
+
+        # decode
+        w("bool %s::decode(QDataStream &stream, %s *out, QString *error)" % (name, name))
+        w("{")
+        w("    *out = %s();" % name)
+        w("    quint32 fields = 0;")
+        w("    stream >> fields;")
+        for index, field in enumerate(fields):
+            member = "out->%s" % camel(field["name"])
+            w("    if (fields & (1u << %d)) {" % index)
+            if field["type"] == "int32":
+                w("        qint32 value = 0;")
+                w("        stream >> value;")
+                w("        %s = value;" % member)
+            else:
+                w("        stream >> %s;" % member)
+            if field.get("presence"):
+                w("        out->has%s = true;" % pascal(field["name"]))
+            w("    }")
+        w("    if (streamFailed(stream, error)) {")
+        w("        return false;")
+        w("    }")
+        w("    return validate%s(*out, fields, error);" % name)
+        w("}")
+        w("")
+
+    w("} // namespace %s" % ns)
+    return "\n".join(out) + "\n"
+
+
+def write_file(path, content):
+    with open(path, "w", encoding="utf-8") as output:
+        output.write(content)
+
+
+def main():
+    if len(sys.argv) != 3:
+        print(__doc__)
+        return 1
+
+    with open(sys.argv[1], encoding="utf-8") as source:
+        schema = json.load(source)
+    validate_schema(schema)
+
+    os.makedirs(sys.argv[2], exist_ok=True)
+    write_file(os.path.join(sys.argv[2], "ProtocolMessages.h"), generate_header(schema))
+    write_file(os.path.join(sys.argv[2], "ProtocolMessages.cpp"), generate_source(schema))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,125 @@
+#!/usr/bin/env bash
+# QKChat 本地Redis Cluster / Sentinel测试环境
+#
+# 用法:
+#   scripts/redis_cluster_local.sh cluster-start  [基准端口，默认7000]   启动6个实例并组成3主3从的Cluster
+#   scripts/redis_cluster_local.sh sentinel-start [基准端口，默认6380]   启动1主1从和3个哨兵（主节点名mymaster）
+#   scripts/redis_cluster_local.sh failover       [基准端口，默认7000]   让第一个主节点的副本接管（CLUSTER FAILOVER）
+#   scripts/redis_cluster_local.sh stop                                  停止本脚本启动的所有实例并删除数据目录
+#
+# 所有实例监听127.0.0.1，数据与日志位于 ${QKCHAT_REDIS_DIR:-/tmp/qkchat-redis}。
+# 服务器配置示例:
+#   "redis": { "mode": "cluster",  "cluster_nodes": ["127.0.0.1:7000", "127.0.0.1:7001"] }
+#   "redis": { "mode": "sentinel", "sentinels": ["127.0.0.1:26380", "127.0.0.1:26381"], "master_name": "mymaster" }
+# 需要redis-server和redis-cli（Redis 5+）。
+
+set -euo pipefail
+
+DIR="${QKCHAT_REDIS_DIR:-/tmp/qkchat-redis}"
+
+start_instance() {
+    local port="$1"
+    shift
+    mkdir -p "$DIR/$port"
+    redis-server --port "$port" --bind 127.0.0.1 --daemonize yes \
+        --dir "$DIR/$port" --logfile "$DIR/$port/redis.log" --pidfile "$DIR/$port/redis.pid" \
+        --save "" --appendonly no "$@"
+}
+
+wait_ready() {
+    local port="$1"
+    for _ in $(seq 1 50); do
+        if redis-cli -p "$port" ping >/dev/null 2>&1; then
+            return 0
+        fi
+        sleep 0.1
+    done
+    echo "redis on port $port did not start" >&2
+    exit 1
+}
+
+cluster_start() {
+    local base="${1:-7000}"
+    local nodes=()
+    for i in 0 1 2 3 4 5; do
+        local port=$((base + i))
+        start_instance "$port" --cluster-enabled yes --cluster-config-file "$DIR/$port/nodes.conf" \
+            --cluster-node-timeout 3000
+        nodes+=("127.0.0.1:$port")
+    done
+    for i in 0 1 2 3 4 5; do
+        wait_ready $((base + i))
+    done
+
+    redis-cli --cluster create "${nodes[@]}" --cluster-replicas 1 --cluster-yes
+    redis-cli --cluster check "127.0.0.1:$base"
+    echo "cluster ready: ${nodes[*]}"
+}
+
+sentinel_start() {
+    local base="${1:-6380}"
+    start_instance "$base"
+    start_instance $((base + 1)) --replicaof 127.0.0.1 "$base"
+    wait_ready "$base"
+    wait_ready $((base + 1))
+
+    for i in 0 1 2; do
+        local port=$((26380 + i))
+        mkdir -p "$DIR/$port"
+        cat > "$DIR/$port/sentinel.conf" <<EOF
+port $port
+bind 127.0.0.1
+daemonize yes
+dir $DIR/$port
+logfile $DIR/$port/sentinel.log
+pidfile $DIR/$port/redis.pid
+sentinel monitor mymaster 127.0.0.1 $base 2
+sentinel down-after-milliseconds mymaster 3000
+sentinel failover-timeout mymaster 10000
+EOF
+        redis-server "$DIR/$port/sentinel.conf" --sentinel
+    done
+    for i in 0 1 2; do
+        wait_ready $((26380 + i))
+    done
+
+    echo "master 127.0.0.1:$base, replica 127.0.0.1:$((base + 1)), sentinels 127.0.0.1:26380-26382"
+    echo "to test failover: redis-cli -p $base debug sleep 30   (or shutdown nosave)"
+}
+
+cluster_failover() {
+    local base="${1:-7000}"
+    # 找到第一个主节点的副本并让它接管
+    local master_id
+    master_id=$(redis-cli -p "$base" cluster myid)
+    local replica
+    replica=$(redis-cli -p "$base" cluster nodes | awk -v id="$master_id" '$4 == id { split($2, a, "@"); print a[1]; exit }')
+    if [[ -z "$replica" ]]; then
+        echo "no replica found for 127.0.0.1:$base" >&2
+        exit 1
+    fi
+    redis-cli -h "${replica%:*}" -p "${replica##*:}" cluster failover
+    echo "replica $replica is taking over the slots of 127.0.0.1:$base"
+}
+
+stop_all() {
+    if [[ -d "$DIR" ]]; then
+        for pidfile in "$DIR"/*/redis.pid; do
+            [[ -f "$pidfile" ]] && kill "$(cat "$pidfile")" 2>/dev/null || true
+        done
+        sleep 0.5
+        rm -rf "$DIR"
+    fi
+    echo "stopped"
+}
+
+case "${1:-}" in
+    cluster-start)  cluster_start "${2:-}" ;;
+    sentinel-start) sentinel_start "${2:-}" ;;
+    failover)       cluster_failover "${2:-}" ;;
+    stop)           stop_all ;;
+    *)
+        sed -n '2,14p' "$0"
+        exit 1
+        ;;
+esac
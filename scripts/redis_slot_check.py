@@ -0,0 +1,189 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+"""
+QKChat Redis Cluster槽位路由检查
+
+用法:
+    python3 redis_slot_check.py [--node 127.0.0.1:7000] [--prefix qkchat:] [--keys N]
+
+针对运行中的Redis Cluster（可用scripts/redis_cluster_local.sh cluster-start启动）检查:
+    keyslot     服务器使用的CRC16槽位算法（含{哈希标签}）与CLUSTER KEYSLOT的结果一致
+    colocation  同一实体的键（RedisKeys约定：{u:用户ID}、{e:邮箱}、{s:令牌}、{n:节点ID}）落在同一槽位
+    routing     按CLUSTER SLOTS映射把键发往所属节点时没有重定向，发往其他节点时得到指向所属节点的MOVED
+    spread      用户键在各主节点上的分布
+
+只读检查，不写入任何键。不依赖第三方库。
+"""
+
+import argparse
+import random
+import socket
+import sys
+from collections import Counter
+
+SLOT_COUNT = 16384
+
+
+def crc16(data):
+    """CRC16-CCITT（XMODEM），与Redis Cluster及RedisRouter一致"""
+    crc = 0
+    for byte in data:
+        crc ^= byte << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) if crc & 0x8000 else (crc << 1)
+            crc &= 0xFFFF
+    return crc
+
+
+def key_slot(key):
+    data = key.encode()
+    start = data.find(b"{")
+    if start >= 0:
+        end = data.find(b"}", start + 1)
+        if end > start + 1:
+            data = data[start + 1:end]
+    return crc16(data) % SLOT_COUNT
+
+
+class Connection:
+    def __init__(self, address):
+        host, port = address.rsplit(":", 1)
+        self.sock = socket.create_connection((host, int(port)), timeout=3)
+        self.file = self.sock.makefile("rb")
+
+    def command(self, *args):
+        out = [b"*%d\r\n" % len(args)]
+        for arg in args:
+            arg = arg if isinstance(arg, bytes) else str(arg).encode()
+            out.append(b"$%d\r\n%s\r\n" % (len(arg), arg))
+        self.sock.sendall(b"".join(out))
+        return self.read()
+
+    def read(self):
+        line = self.file.readline().rstrip(b"\r\n")
+        kind, rest = line[:1], line[1:]
+        if kind == b"+":
+            return rest.decode()
+        if kind == b"-":
+            return RedisError(rest.decode())
+        if kind == b":":
+            return int(rest)
+        if kind == b"$":
+            length = int(rest)
+            if length < 0:
+                return None
+            data = self.file.read(length + 2)[:-2]
+            return data.decode(errors="replace")
+        if kind == b"*":
+            count = int(rest)
+            return None if count < 0 else [self.read() for _ in range(count)]
+        raise RuntimeError("unexpected reply: %r" % line)
+
+
+class RedisError(str):
+    pass
+
+
+def sample_keys(prefix, count):
+    keys = []
+    for _ in range(count):
+        user_id = random.randint(1, 10 ** 9)
+        email = "user%d@example.com" % random.randint(1, 10 ** 9)
+        token = "%032x" % random.getrandbits(128)
+        keys.append(("user", [
+            "%s{u:%d}:presence" % (prefix, user_id),
+            "%s{u:%d}:session_token" % (prefix, user_id),
+            "%s{u:%d}:rate_limit" % (prefix, user_id),
+        ]))
+        keys.append(("email", [
+            "%s{e:%s}:verification_code" % (prefix, email),
+            "%s{e:%s}:rate_limit" % (prefix, email),
+        ]))
+        keys.append(("session", ["%s{s:%s}:session" % (prefix, token)]))
+    keys.append(("node", ["%s{n:node-a}:bus" % prefix]))
+    return keys
+
+
+def load_slots(connection):
+    owners = [None] * SLOT_COUNT
+    for entry in connection.command("CLUSTER", "SLOTS"):
+        host = entry[2][0] or "127.0.0.1"
+        address = "%s:%d" % (host, entry[2][1])
+        for slot in range(entry[0], entry[1] + 1):
+            owners[slot] = address
+    return owners
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Redis Cluster slot routing check")
+    parser.add_argument("--node", default="127.0.0.1:7000", help="any cluster node host:port")
+    parser.add_argument("--prefix", default="qkchat:", help="redis.key_prefix")
+    parser.add_argument("--keys", type=int, default=200, help="sampled entities per kind")
+    args = parser.parse_args()
+
+    seed = Connection(args.node)
+    owners = load_slots(seed)
+    missing = owners.count(None)
+    masters = sorted(set(o for o in owners if o))
+    print("masters: %s, uncovered slots: %d" % (", ".join(masters), missing))
+
+    connections = {}
+
+    def connection_to(address):
+        if address not in connections:
+            connections[address] = Connection(address)
+        return connections[address]
+
+    failures = 0
+    groups = sample_keys(args.prefix, args.keys)
+    spread = Counter()
+    moved = 0
+
+    for kind, keys in groups:
+        slots = set()
+        for key in keys:
+            local = key_slot(key)
+            remote = seed.command("CLUSTER", "KEYSLOT", key)
+            if local != remote:
+                print("keyslot mismatch: %s local=%d server=%d" % (key, local, remote))
+                failures += 1
+            slots.add(local)
+        if len(slots) != 1:
+            print("colocation failure (%s): %s -> %s" % (kind, keys, sorted(slots)))
+            failures += 1
+
+        key = keys[0]
+        owner = owners[key_slot(key)]
+        if kind == "user":
+            spread[owner] += 1
+
+        reply = connection_to(owner).command("GET", key)
+        if isinstance(reply, RedisError):
+            print("routing failure: GET %s at %s -> %s" % (key, owner, reply))
+            failures += 1
+
+        others = [m for m in masters if m != owner]
+        if others:
+            reply = connection_to(random.choice(others)).command("GET", key)
+            expected = "MOVED %d " % key_slot(key)
+            if isinstance(reply, RedisError) and reply.startswith(expected):
+                moved += 1
+                if not reply.endswith(owner.split(":", 1)[1]):
+                    print("MOVED points elsewhere: %s (owner %s)" % (reply, owner))
+                    failures += 1
+            else:
+                print("expected MOVED for %s, got %r" % (key, reply))
+                failures += 1
+
+    print("checked %d key groups, %d MOVED replies verified" % (len(groups), moved))
+    print("user key spread: " + ", ".join("%s=%d" % (m, spread[m]) for m in masters))
+
+    if failures:
+        print("FAILED: %d problems" % failures)
+        return 1
+    print("OK")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())